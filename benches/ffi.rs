@@ -0,0 +1,112 @@
+//! FFI overhead of the wrappers: every case runs the raw C call (allocate in the library, free)
+//! next to the wrapper that copies the result into Rust types.
+//!
+//! `cargo bench` runs all cases, `cargo bench -- <filter>` the cases whose name contains the
+//! filter. No external harness: each case is timed for about half a second after a warm-up and
+//! reported as the mean per call.
+
+use hwinfo_rs::bindings;
+use hwinfo_rs::cgroup::Cgroup;
+use hwinfo_rs::hwinfo;
+use hwinfo_rs::process_stats::{ProcessStats, Processes};
+use hwinfo_rs::topology::Topology;
+use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+const WARM_UP: Duration = Duration::from_millis(100);
+const MEASURE: Duration = Duration::from_millis(500);
+
+/// Runs `f` in batches until `MEASURE` passed and prints the mean time per call.
+fn bench(filter: Option<&str>, name: &str, mut f: impl FnMut()) {
+    if filter.is_some_and(|filter| !name.contains(filter)) {
+        return;
+    }
+    let start = Instant::now();
+    while start.elapsed() < WARM_UP {
+        f();
+    }
+    let mut iterations: u64 = 0;
+    let mut batch: u64 = 1;
+    let start = Instant::now();
+    while start.elapsed() < MEASURE {
+        for _ in 0..batch {
+            f();
+        }
+        iterations += batch;
+        batch = (batch * 2).min(1 << 16);
+    }
+    let ns = start.elapsed().as_nanos() as f64 / iterations as f64;
+    println!("{name:<44} {ns:>14.1} ns/iter {iterations:>12} iterations");
+}
+
+fn main() {
+    // cargo bench passes "--bench"; any other argument is a name filter
+    let filter = std::env::args().skip(1).find(|arg| !arg.starts_with("--"));
+    let filter = filter.as_deref();
+
+    bench(filter, "raw/get_all_cpus", || unsafe {
+        let count = bindings::get_cpu_count();
+        let cpus = bindings::get_all_cpus();
+        black_box(cpus);
+        bindings::free_cpu_info(cpus, count);
+    });
+    bench(filter, "wrapper/cpus", || {
+        black_box(hwinfo::cpus().ok());
+    });
+
+    bench(filter, "raw/get_all_disks", || unsafe {
+        let count = bindings::get_disk_count();
+        let disks = bindings::get_all_disks();
+        black_box(disks);
+        bindings::free_disk_info(disks, count);
+    });
+    bench(filter, "wrapper/disks", || {
+        black_box(hwinfo::disks().ok());
+    });
+
+    bench(filter, "raw/get_all_networks", || unsafe {
+        let count = bindings::get_network_count();
+        let networks = bindings::get_all_networks();
+        black_box(networks);
+        bindings::free_network_info(networks, count);
+    });
+    bench(filter, "wrapper/networks", || {
+        black_box(hwinfo::networks().ok());
+    });
+
+    bench(filter, "wrapper/memory_snapshot", || {
+        black_box(hwinfo::memory_snapshot().ok());
+    });
+
+    let mut utilisations = Vec::new();
+    bench(filter, "wrapper/cpu_thread_utilizations", || {
+        black_box(hwinfo::cpu_thread_utilizations(0).ok());
+    });
+    bench(filter, "wrapper/cpu_thread_utilizations_into", || {
+        black_box(hwinfo::cpu_thread_utilizations_into(0, &mut utilisations).ok());
+    });
+
+    bench(filter, "raw/get_system_snapshot", || unsafe {
+        let snapshot = bindings::get_system_snapshot(hwinfo::Components::ALL.bits());
+        black_box(snapshot);
+        bindings::free_system_snapshot(snapshot);
+    });
+    bench(filter, "wrapper/system_snapshot", || {
+        black_box(hwinfo::system_snapshot(hwinfo::Components::ALL).ok());
+    });
+
+    bench(filter, "wrapper/topology", || {
+        black_box(Topology::new().ok());
+    });
+
+    bench(filter, "wrapper/cgroup", || {
+        black_box(Cgroup::read().ok());
+    });
+
+    if let Ok(mut processes) = Processes::new(&[std::process::id()]) {
+        let mut stats = ProcessStats::default();
+        bench(filter, "wrapper/processes_read", || {
+            black_box(processes.read(&mut stats).ok());
+        });
+    }
+}
@@ -6,6 +6,11 @@ fn main() {
 
     config.define("CMAKE_MSVC_RUNTIME_LIBRARY", "MultiThreadedDLL");
 
+    // per-collector counters of hwinfo::stats
+    if env::var_os("CARGO_FEATURE_TRACE").is_some() {
+        config.define("HWINFO_TRACE", "ON");
+    }
+
     let dst = config.build();
 
     println!("cargo:rustc-link-search=native={}", dst.join("lib").display());
@@ -16,9 +21,18 @@ fn main() {
         println!("cargo:rustc-link-lib=dylib=ole32");
         println!("cargo:rustc-link-lib=dylib=oleaut32");
         println!("cargo:rustc-link-lib=dylib=wbemuuid");
+        println!("cargo:rustc-link-lib=dylib=pdh");
+        println!("cargo:rustc-link-lib=dylib=iphlpapi");
+        println!("cargo:rustc-link-lib=dylib=setupapi");
+        println!("cargo:rustc-link-lib=dylib=powrprof");
     } else if cfg!(target_os = "macos") {
         println!("cargo:rustc-link-lib=framework=IOKit");
         println!("cargo:rustc-link-lib=framework=CoreFoundation");
+    } else {
+        // dlopen() of the optional NVML library
+        println!("cargo:rustc-link-lib=dylib=dl");
+        // shm_open() of the shared frame segments, part of libc since glibc 2.34
+        println!("cargo:rustc-link-lib=dylib=rt");
     }
 
     let header_path = dst.join("include").join("hwinfo").join("hwinfo_c.h");
@@ -26,6 +40,7 @@ fn main() {
         .header(header_path.to_str().expect("Path to header is not valid UTF-8"))
         .allowlist_function("get_.*")
         .allowlist_function("free_.*")
+        .allowlist_function("hwinfo_.*")
         .allowlist_type("C_.*")
         .parse_callbacks(Box::new(bindgen::CargoCallbacks::new()))
         .generate()
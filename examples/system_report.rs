@@ -8,9 +8,22 @@ fn bytes_to_gb(bytes: i64) -> f64 {
 fn run() -> hwinfo::Result<()> {
     println!("--- Hardware Information Report ---");
 
+    // All components are collected concurrently with a single call.
+    let hwinfo::SystemSnapshot {
+        cpus,
+        os,
+        gpus,
+        memory,
+        mainboard,
+        disks,
+        batteries,
+        networks,
+    } = hwinfo::system_snapshot(hwinfo::Components::ALL | hwinfo::Components::PARALLEL)?;
+    let missing = |name: &str| hwinfo::HwinfoError::DataUnavailable(name.into());
+
     // 1. Operating System
     println!("\n[ Operating System ]");
-    let os = hwinfo::os_info()?;
+    let os = os.ok_or_else(|| missing("os"))?;
     println!("  Name: {}", os.name);
     println!("  Version: {}", os.version);
     println!("  Kernel: {}", os.kernel);
@@ -18,7 +31,7 @@ fn run() -> hwinfo::Result<()> {
 
     // 2. Mainboard
     println!("\n[ Mainboard ]");
-    let mainboard = hwinfo::mainboard_info()?;
+    let mainboard = mainboard.ok_or_else(|| missing("mainboard"))?;
     println!("  Vendor: {}", mainboard.vendor);
     println!("  Name: {}", mainboard.name);
     println!("  Version: {}", mainboard.version);
@@ -26,7 +39,7 @@ fn run() -> hwinfo::Result<()> {
 
     // 3. Memory
     println!("\n[ Memory (RAM) ]");
-    let mem = hwinfo::memory_info()?;
+    let mem = memory.ok_or_else(|| missing("memory"))?;
     println!("  Total: {:.2} GB", bytes_to_gb(mem.total_bytes));
     println!("  Available: {:.2} GB", bytes_to_gb(mem.available_bytes));
     println!("  Free: {:.2} GB", bytes_to_gb(mem.free_bytes));
@@ -47,7 +60,6 @@ fn run() -> hwinfo::Result<()> {
 
     // 4. CPU
     println!("\n[ CPUs ]");
-    let cpus = hwinfo::cpus()?;
     println!("  Sockets found: {}", cpus.len());
     for cpu in cpus {
         println!("  - CPU ID {}: {}", cpu.id, cpu.model_name);
@@ -66,14 +78,14 @@ fn run() -> hwinfo::Result<()> {
         let thread_utils = hwinfo::cpu_thread_utilizations(cpu.id)?;
         println!("    Thread Utilizations: {:?}", thread_utils);
 
-        if !cpu.flags.is_empty() {
-            println!("    Flags: {}", cpu.flags.join(", "));
+        if !cpu.features.is_empty() {
+            let names: Vec<&str> = cpu.features.names().collect();
+            println!("    Features: {}", names.join(", "));
         }
     }
 
     // 5. GPUs
     println!("\n[ GPUs ]");
-    let gpus = hwinfo::gpus()?;
     if gpus.is_empty() {
         println!("  No GPUs found.");
     } else {
@@ -90,7 +102,6 @@ fn run() -> hwinfo::Result<()> {
 
     // 6. Disks
     println!("\n[ Disks ]");
-    let disks = hwinfo::disks()?;
     if disks.is_empty() {
         println!("  No disks found.");
     } else {
@@ -105,7 +116,6 @@ fn run() -> hwinfo::Result<()> {
 
     // 7. Batteries
     println!("\n[ Batteries ]");
-    let batteries = hwinfo::batteries()?;
     if batteries.is_empty() {
         println!("  No batteries found.");
     } else {
@@ -121,7 +131,6 @@ fn run() -> hwinfo::Result<()> {
 
     // 8. Network Interfaces
     println!("\n[ Network Interfaces ]");
-    let networks = hwinfo::networks()?;
     if networks.is_empty() {
         println!("  No network interfaces found.");
     } else {
@@ -0,0 +1,128 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+// Marshalling of the C API (hwinfo_c.cpp). Runs with "cached" 0 invalidate the component cache before every call, so
+// they measure enumeration plus marshalling; runs with "cached" 1 measure the copy of the cached list into the Arena.
+
+#include <benchmark/benchmark.h>
+#include <hwinfo/hwinfo_c.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "counters.h"
+
+namespace {
+
+using hwinfo::bench::CallCounters;
+
+// _____________________________________________________________________________________________________________________
+template <typename T>
+void run_list(benchmark::State& state, uint32_t component, int (*count)(), T* (*get_all)(), void (*free_all)(T*, int)) {
+  const bool cached = state.range(0) != 0;
+  hwinfo_invalidate(component);
+  CallCounters counters(state);
+  for (auto _ : state) {
+    if (!cached) {
+      hwinfo_invalidate(component);
+    }
+    const int n = count();
+    T* list = get_all();
+    benchmark::DoNotOptimize(list);
+    free_all(list, n);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void BM_C_get_all_cpus(benchmark::State& state) {
+  run_list(state, C_SNAPSHOT_CPU, get_cpu_count, get_all_cpus, free_cpu_info);
+}
+BENCHMARK(BM_C_get_all_cpus)->ArgName("cached")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+void BM_C_get_all_disks(benchmark::State& state) {
+  run_list(state, C_SNAPSHOT_DISK, get_disk_count, get_all_disks, free_disk_info);
+}
+BENCHMARK(BM_C_get_all_disks)->ArgName("cached")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+void BM_C_get_all_networks(benchmark::State& state) {
+  run_list(state, C_SNAPSHOT_NETWORK, get_network_count, get_all_networks, free_network_info);
+}
+BENCHMARK(BM_C_get_all_networks)->ArgName("cached")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+void BM_C_get_all_gpus(benchmark::State& state) {
+  run_list(state, C_SNAPSHOT_GPU, get_gpu_count, get_all_gpus, free_gpu_info);
+}
+BENCHMARK(BM_C_get_all_gpus)->ArgName("cached")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+void BM_C_get_memory_info(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    C_MemoryInfo* memory = get_memory_info();
+    benchmark::DoNotOptimize(memory);
+    free_memory_info(memory);
+  }
+}
+BENCHMARK(BM_C_get_memory_info);
+
+// _____________________________________________________________________________________________________________________
+void BM_C_get_memory_snapshot_into(benchmark::State& state) {
+  C_MemorySnapshot snapshot{};
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(get_memory_snapshot_into(&snapshot));
+  }
+}
+BENCHMARK(BM_C_get_memory_snapshot_into);
+
+// _____________________________________________________________________________________________________________________
+// Thread utilisation of cpu 0: the allocating variant against the fill variant.
+void BM_C_get_cpu_thread_utilizations(benchmark::State& state) {
+  const bool fill = state.range(0) != 0;
+  const int num_threads = get_cpu_thread_utilizations_into(0, nullptr, 0);
+  if (num_threads < 0) {
+    state.SkipWithError("no cpu");
+    return;
+  }
+  std::vector<double> buffer(static_cast<size_t>(num_threads));
+  CallCounters counters(state);
+  for (auto _ : state) {
+    if (fill) {
+      benchmark::DoNotOptimize(get_cpu_thread_utilizations_into(0, buffer.data(), num_threads));
+    } else {
+      C_DoubleArray* values = get_cpu_thread_utilizations(0);
+      benchmark::DoNotOptimize(values);
+      free_double_array(values);
+    }
+  }
+}
+BENCHMARK(BM_C_get_cpu_thread_utilizations)->ArgName("fill")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+// All components in one allocation, gathered serially (0) and in parallel (1).
+void BM_C_get_system_snapshot(benchmark::State& state) {
+  const uint32_t flags = C_SNAPSHOT_ALL | (state.range(0) != 0 ? C_SNAPSHOT_PARALLEL : 0);
+  CallCounters counters(state);
+  for (auto _ : state) {
+    C_SystemSnapshot* snapshot = get_system_snapshot(flags);
+    benchmark::DoNotOptimize(snapshot);
+    free_system_snapshot(snapshot);
+  }
+}
+BENCHMARK(BM_C_get_system_snapshot)->ArgName("parallel")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// _____________________________________________________________________________________________________________________
+void BM_C_get_topology(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    C_Topology* topology = get_topology();
+    benchmark::DoNotOptimize(topology);
+    free_topology(topology);
+  }
+}
+BENCHMARK(BM_C_get_topology);
+
+}  // namespace
@@ -0,0 +1,208 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+// Collectors of the C++ API on the host. "Cold" runs include everything a first call in a fresh process pays for that
+// is not a one time static (e.g. Topology::read() instead of the cached Topology::get()), "warm" runs reuse state.
+
+#include <benchmark/benchmark.h>
+#include <hwinfo/hwinfo.h>
+#include <hwinfo/utils/PCIMapper.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "counters.h"
+
+namespace {
+
+using hwinfo::bench::CallCounters;
+
+// _____________________________________________________________________________________________________________________
+void BM_getAllCPUs(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::getAllCPUs());
+  }
+}
+BENCHMARK(BM_getAllCPUs);
+
+// _____________________________________________________________________________________________________________________
+void BM_getAllDisks(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::getAllDisks());
+  }
+}
+BENCHMARK(BM_getAllDisks);
+
+// _____________________________________________________________________________________________________________________
+void BM_getAllNetworks(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::getAllNetworks());
+  }
+}
+BENCHMARK(BM_getAllNetworks);
+
+// _____________________________________________________________________________________________________________________
+void BM_getAllGPUs(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::getAllGPUs());
+  }
+}
+BENCHMARK(BM_getAllGPUs);
+
+// _____________________________________________________________________________________________________________________
+void BM_getAllBatteries(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::getAllBatteries());
+  }
+}
+BENCHMARK(BM_getAllBatteries);
+
+// _____________________________________________________________________________________________________________________
+void BM_OS(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    hwinfo::OS os;
+    benchmark::DoNotOptimize(os);
+  }
+}
+BENCHMARK(BM_OS);
+
+// _____________________________________________________________________________________________________________________
+void BM_MainBoard(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    hwinfo::MainBoard mainboard;
+    benchmark::DoNotOptimize(mainboard);
+  }
+}
+BENCHMARK(BM_MainBoard);
+
+// _____________________________________________________________________________________________________________________
+void BM_Memory_construct(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    hwinfo::Memory memory;
+    benchmark::DoNotOptimize(memory);
+  }
+}
+BENCHMARK(BM_Memory_construct);
+
+// _____________________________________________________________________________________________________________________
+void BM_Memory_snapshot(benchmark::State& state) {
+  const hwinfo::Memory memory;
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(memory.snapshot());
+  }
+}
+BENCHMARK(BM_Memory_snapshot);
+
+// _____________________________________________________________________________________________________________________
+void BM_MemorySnapshot_update(benchmark::State& state) {
+  hwinfo::MemorySnapshot snapshot;
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(snapshot.update());
+  }
+}
+BENCHMARK(BM_MemorySnapshot_update);
+
+// _____________________________________________________________________________________________________________________
+void BM_Topology_read(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::Topology::read());
+  }
+}
+BENCHMARK(BM_Topology_read);
+
+// _____________________________________________________________________________________________________________________
+void BM_Topology_get(benchmark::State& state) {
+  benchmark::DoNotOptimize(hwinfo::Topology::get());
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::Topology::get().size());
+  }
+}
+BENCHMARK(BM_Topology_get);
+
+#ifdef HWINFO_UNIX
+// _____________________________________________________________________________________________________________________
+// Construction of a mapper and a vendor and device lookup, as done once per GPU, by hex string (as read from sysfs).
+void BM_PCIMapper(benchmark::State& state) {
+  CallCounters counters(state);
+  for (auto _ : state) {
+    const hwinfo::PCIMapper mapper;
+    benchmark::DoNotOptimize(mapper["0x10de"]["0x2204"].device_name);
+  }
+}
+BENCHMARK(BM_PCIMapper);
+#endif  // HWINFO_UNIX
+
+// _____________________________________________________________________________________________________________________
+// Utilisation of all threads of the first socket: the allocating variant against the fill variant.
+void BM_threadsUtilisation(benchmark::State& state) {
+  const auto cpus = hwinfo::getAllCPUs();
+  if (cpus.empty()) {
+    state.SkipWithError("no cpu");
+    return;
+  }
+  const bool fill = state.range(0) != 0;
+  std::vector<double> buffer(static_cast<size_t>(cpus[0].numLogicalCores()));
+  CallCounters counters(state);
+  for (auto _ : state) {
+    if (fill) {
+      benchmark::DoNotOptimize(cpus[0].threadsUtilisation(buffer.data(), static_cast<int>(buffer.size())));
+    } else {
+      benchmark::DoNotOptimize(cpus[0].threadsUtilisation());
+    }
+  }
+}
+BENCHMARK(BM_threadsUtilisation)->ArgName("fill")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+void BM_currentUtilisation(benchmark::State& state) {
+  const auto cpus = hwinfo::getAllCPUs();
+  if (cpus.empty()) {
+    state.SkipWithError("no cpu");
+    return;
+  }
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cpus[0].currentUtilisation());
+  }
+}
+BENCHMARK(BM_currentUtilisation);
+
+// _____________________________________________________________________________________________________________________
+void BM_currentClockSpeed(benchmark::State& state) {
+  const auto cpus = hwinfo::getAllCPUs();
+  if (cpus.empty()) {
+    state.SkipWithError("no cpu");
+    return;
+  }
+  std::vector<int64_t> buffer(static_cast<size_t>(cpus[0].numLogicalCores()));
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cpus[0].currentClockSpeed_MHz(buffer.data(), static_cast<int>(buffer.size())));
+  }
+}
+BENCHMARK(BM_currentClockSpeed);
+
+// _____________________________________________________________________________________________________________________
+// All components, serially (0) and on one thread per component (1).
+void BM_collectAll(benchmark::State& state) {
+  const hwinfo::Executor executor = state.range(0) != 0 ? hwinfo::Executor{} : hwinfo::inlineExecutor();
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::collectAll(hwinfo::Component::All, executor));
+  }
+}
+BENCHMARK(BM_collectAll)->ArgName("parallel")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,165 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include "counters.h"
+
+#include <hwinfo/platform.h>
+#include <hwinfo/utils/trace.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef HWINFO_UNIX
+#include <fcntl.h>
+#include <hwinfo/utils/parse.h>
+#include <unistd.h>
+
+#include <string_view>
+#endif
+
+#ifndef HWINFO_TRACE
+namespace {
+
+std::atomic<uint64_t> num_allocations{0};
+
+// _____________________________________________________________________________________________________________________
+void* counted_alloc(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+// _____________________________________________________________________________________________________________________
+void* counted_aligned_alloc(size_t size, std::align_val_t alignment) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  const auto align = static_cast<size_t>(alignment);
+#ifdef HWINFO_WINDOWS
+  return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+  // aligned_alloc requires a multiple of the alignment
+  return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+void aligned_free(void* ptr) noexcept {
+#ifdef HWINFO_WINDOWS
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+}  // namespace
+
+// Replacements of the global allocation functions for the whole benchmark binary, the library included (HWINFO_TRACE
+// builds of the library bring their own).
+// _____________________________________________________________________________________________________________________
+void* operator new(size_t size) {
+  if (void* ptr = counted_alloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// _____________________________________________________________________________________________________________________
+void* operator new[](size_t size) { return ::operator new(size); }
+
+// _____________________________________________________________________________________________________________________
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+
+// _____________________________________________________________________________________________________________________
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+
+// _____________________________________________________________________________________________________________________
+void* operator new(size_t size, std::align_val_t alignment) {
+  if (void* ptr = counted_aligned_alloc(size, alignment)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// _____________________________________________________________________________________________________________________
+void* operator new[](size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr, std::align_val_t) noexcept { aligned_free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr, std::align_val_t) noexcept { aligned_free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { aligned_free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { aligned_free(ptr); }
+#endif  // HWINFO_TRACE
+
+namespace hwinfo {
+namespace bench {
+
+// _____________________________________________________________________________________________________________________
+uint64_t allocations() {
+#ifdef HWINFO_TRACE
+  // HWINFO_TRACE builds of the library replace the allocation functions themselves
+  return trace::allocations();
+#else
+  return num_allocations.load(std::memory_order_relaxed);
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t read_syscalls() {
+#ifdef HWINFO_UNIX
+  // opened directly instead of through filesystem::open_path(): the counters are those of this process, also while
+  // the collectors read a fixture root
+  static const int fd = open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+  char buffer[512];
+  const ssize_t n = fd >= 0 ? pread(fd, buffer, sizeof(buffer), 0) : -1;
+  if (n <= 0) {
+    return -1;
+  }
+  const std::string_view content(buffer, static_cast<size_t>(n));
+  const auto pos = content.find("syscr:");
+  if (pos == std::string_view::npos) {
+    return -1;
+  }
+  utils::NumberScanner scanner(content.data() + pos + 6, content.data() + content.size());
+  int64_t value = -1;
+  scanner.next_uint(value);
+  return value;
+#else
+  return -1;
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+CallCounters::CallCounters(benchmark::State& state)
+    : _state(state), _allocations(allocations()), _read_syscalls(read_syscalls()) {}
+
+// _____________________________________________________________________________________________________________________
+CallCounters::~CallCounters() {
+  // the read of the baseline itself is counted by the kernel after its content was generated
+  const int64_t read_syscalls_after = read_syscalls();
+  _state.counters["allocs"] =
+      benchmark::Counter(static_cast<double>(allocations() - _allocations), benchmark::Counter::kAvgIterations);
+  if (_read_syscalls >= 0 && read_syscalls_after >= 0) {
+    _state.counters["reads"] = benchmark::Counter(static_cast<double>(read_syscalls_after - _read_syscalls - 1),
+                                                  benchmark::Counter::kAvgIterations);
+  }
+}
+
+}  // namespace bench
+}  // namespace hwinfo
@@ -0,0 +1,39 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace hwinfo {
+namespace bench {
+
+// Number of operator new calls of the process so far (all threads, including the aligned variants). Allocations of
+// the C API Arena (std::malloc) are not included.
+uint64_t allocations();
+
+// Number of read syscalls (read, pread, readv; "syscr" of /proc/self/io) of the process so far, including those of
+// exited threads. -1 where the kernel does not report it (macOS, Windows).
+int64_t read_syscalls();
+
+/**
+ * Reports the operator new calls and read syscalls per iteration of the benchmark loop as the counters "allocs" and
+ * "reads". Construct right before the loop; the counters are set when the object goes out of scope after it.
+ */
+class CallCounters {
+ public:
+  explicit CallCounters(benchmark::State& state);
+  ~CallCounters();
+  CallCounters(const CallCounters&) = delete;
+  CallCounters& operator=(const CallCounters&) = delete;
+
+ private:
+  benchmark::State& _state;
+  uint64_t _allocations;
+  int64_t _read_syscalls;
+};
+
+}  // namespace bench
+}  // namespace hwinfo
@@ -0,0 +1,166 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include "fixtures.h"
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/cgroup.h>
+#include <hwinfo/topology.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace hwinfo {
+namespace bench {
+
+namespace {
+
+constexpr const char* cpu_flags =
+    "fpu vme de pse tsc msr pae mce cx8 apic sep mtrr pge mca cmov pat pse36 clflush dts acpi mmx fxsr sse sse2 ss ht "
+    "tm pbe syscall nx pdpe1gb rdtscp lm constant_tsc art arch_perfmon pebs bts rep_good nopl xtopology nonstop_tsc "
+    "cpuid aperfmperf pni pclmulqdq dtes64 monitor ds_cpl vmx smx est tm2 ssse3 sdbg fma cx16 xtpr pdcm pcid dca "
+    "sse4_1 sse4_2 x2apic movbe popcnt tsc_deadline_timer aes xsave avx f16c rdrand lahf_lm abm 3dnowprefetch "
+    "cpuid_fault epb cat_l3 cdp_l3 invpcid_single intel_ppin ssbd mba ibrs ibpb stibp ibrs_enhanced tpr_shadow "
+    "flexpriority ept vpid ept_ad fsgsbase tsc_adjust bmi1 avx2 smep bmi2 erms invpcid cqm rdt_a avx512f avx512dq "
+    "rdseed adx smap avx512ifma clflushopt clwb intel_pt avx512cd sha_ni avx512bw avx512vl xsaveopt xsavec xgetbv1 "
+    "xsaves cqm_llc cqm_occup_llc cqm_mbm_total cqm_mbm_local split_lock_detect wbnoinvd dtherm ida arat pln pts "
+    "avx512vbmi umip pku ospke avx512_vbmi2 gfni vaes vpclmulqdq avx512_vnni avx512_bitalg tme avx512_vpopcntdq la57 "
+    "rdpid fsrm md_clear pconfig flush_l1d arch_capabilities";
+
+// _____________________________________________________________________________________________________________________
+template <typename Generate>
+const filesystem::MemoryTree& cached(std::map<int, std::unique_ptr<filesystem::MemoryTree>>& trees, int size,
+                                     Generate generate) {
+  auto& tree = trees[size];
+  if (!tree) {
+    tree = std::make_unique<filesystem::MemoryTree>();
+    generate(*tree);
+  }
+  return *tree;
+}
+
+// _____________________________________________________________________________________________________________________
+std::string range(int first, int last) { return std::to_string(first) + '-' + std::to_string(last) + '\n'; }
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+const filesystem::MemoryTree& cpu_fixture(int num_cpus) {
+  static std::map<int, std::unique_ptr<filesystem::MemoryTree>> trees;
+  return cached(trees, num_cpus, [num_cpus](filesystem::MemoryTree& tree) {
+    const int num_sockets = num_cpus >= 64 ? 2 : 1;
+    const int per_socket = num_cpus / num_sockets;
+    const int cores_per_socket = per_socket / 2 > 0 ? per_socket / 2 : 1;
+
+    std::string stat = "cpu  " + std::to_string(num_cpus * 4711) + " 2 " + std::to_string(num_cpus * 815) + " " +
+                       std::to_string(num_cpus * 100000) + " 42 0 17 0 0 0\n";
+    std::string cpuinfo;
+    const std::string cpu_dir = "/sys/devices/system/cpu/";
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      const int socket = cpu / per_socket;
+      const int local = cpu % per_socket;
+      const int core = local % cores_per_socket;
+      const int sibling = socket * per_socket + (local + cores_per_socket) % per_socket;
+      stat += "cpu" + std::to_string(cpu) + " 4711 2 815 100000 42 0 17 0 0 0\n";
+      cpuinfo += "processor\t: " + std::to_string(cpu) +
+                 "\nvendor_id\t: GenuineIntel\ncpu family\t: 6\nmodel\t\t: 106\n"
+                 "model name\t: Intel(R) Xeon(R) Platinum 8380 CPU @ 2.30GHz\nstepping\t: 6\nmicrocode\t: 0xd0003a5\n"
+                 "cpu MHz\t\t: 2300.000\ncache size\t: 61440 KB\nphysical id\t: " +
+                 std::to_string(socket) + "\nsiblings\t: " + std::to_string(per_socket) +
+                 "\ncore id\t\t: " + std::to_string(core) + "\ncpu cores\t: " + std::to_string(cores_per_socket) +
+                 "\napicid\t\t: " + std::to_string(cpu * 2) +
+                 "\nfpu\t\t: yes\nfpu_exception\t: yes\ncpuid level\t: 27\nwp\t\t: yes\nflags\t\t: " + cpu_flags +
+                 "\nbugs\t\t: spectre_v1 spectre_v2 spec_store_bypass swapgs mmio_stale_data eibrs_pbrsb gds bhi\n"
+                 "bogomips\t: 4600.00\nclflush size\t: 64\ncache_alignment\t: 64\n"
+                 "address sizes\t: 46 bits physical, 57 bits virtual\npower management:\n\n";
+
+      const std::string dir = cpu_dir + "cpu" + std::to_string(cpu) + '/';
+      tree.add_file(dir + "topology/physical_package_id", std::to_string(socket) + '\n');
+      tree.add_file(dir + "topology/die_id", "0\n");
+      tree.add_file(dir + "topology/core_id", std::to_string(core) + '\n');
+      tree.add_file(dir + "topology/package_cpus_list", range(socket * per_socket, (socket + 1) * per_socket - 1));
+      const std::string threads = std::to_string(std::min(cpu, sibling)) + ',' + std::to_string(std::max(cpu, sibling));
+      for (int index = 0; index < 4; ++index) {
+        const std::string cache = dir + "cache/index" + std::to_string(index) + '/';
+        tree.add_file(cache + "level", index < 2 ? "1\n" : std::to_string(index) + '\n');
+        tree.add_file(cache + "shared_cpu_list",
+                      index < 3 ? threads + '\n' : range(socket * per_socket, (socket + 1) * per_socket - 1));
+      }
+      tree.add_file(dir + "cpufreq/scaling_max_freq", "3400000\n");
+      tree.add_file(dir + "cpufreq/base_frequency", "2300000\n");
+      tree.add_file(dir + "cpufreq/scaling_cur_freq", "2300000\n");
+      tree.add_symlink(dir + "node" + std::to_string(socket), "../../node/node" + std::to_string(socket));
+    }
+    stat += "intr 123456789 0 9 0 0 0 0 0 0 1 0 0 0 0\nctxt 987654321\nbtime 1700000000\nprocesses 123456\n"
+            "procs_running 2\nprocs_blocked 0\nsoftirq 1234 0 1 2 3 4 0 5 6 7 8\n";
+    tree.add_file("/proc/stat", stat);
+    tree.add_file("/proc/cpuinfo", cpuinfo);
+  });
+}
+
+// _____________________________________________________________________________________________________________________
+const filesystem::MemoryTree& mount_fixture(int num_mounts) {
+  static std::map<int, std::unique_ptr<filesystem::MemoryTree>> trees;
+  return cached(trees, num_mounts, [num_mounts](filesystem::MemoryTree& tree) {
+    std::string content;
+    content += "22 1 259:2 / / rw,relatime shared:1 - ext4 /dev/nvme0n1p2 rw\n";
+    content += "23 22 0:21 / /proc rw,nosuid,nodev,noexec,relatime shared:12 - proc proc rw\n";
+    content += "24 22 0:22 / /sys rw,nosuid,nodev,noexec,relatime shared:2 - sysfs sysfs rw\n";
+    for (int i = 3; i < num_mounts; ++i) {
+      const std::string id = std::to_string(22 + i);
+      const std::string n = std::to_string(i);
+      switch (i % 3) {
+        case 0:
+          content += id + " 22 8:" + std::to_string(i % 256) + " / /mnt/disk" + n + " rw,relatime shared:" + n +
+                     " - xfs /dev/sd" + static_cast<char>('a' + i % 26) + std::to_string(i % 16) + " rw,attr2\n";
+          break;
+        case 1:
+          content += id + " 22 0:" + std::to_string(100 + i) + " / /var/lib/containers/storage/overlay/" + n +
+                     "/merged rw,relatime - overlay overlay rw,lowerdir=/l/" + n + ",upperdir=/u/" + n +
+                     ",workdir=/w/" + n + "\n";
+          break;
+        default:
+          content += id + " 22 259:2 /srv/volume\\040" + n + " /run/pods/" + n +
+                     "/vol rw,relatime shared:1 - ext4 /dev/nvme0n1p2 rw\n";
+          break;
+      }
+    }
+    tree.add_file("/proc/self/mountinfo", content);
+  });
+}
+
+// _____________________________________________________________________________________________________________________
+const filesystem::MemoryTree& network_fixture(int num_interfaces) {
+  static std::map<int, std::unique_ptr<filesystem::MemoryTree>> trees;
+  return cached(trees, num_interfaces, [num_interfaces](filesystem::MemoryTree& tree) {
+    std::string content =
+        "Inter-|   Receive                                                |  Transmit\n"
+        " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls "
+        "carrier compressed\n"
+        "    lo: 123456789  123456    0    0    0     0          0         0 123456789  123456    0    0    0     0 "
+        "      0          0\n";
+    for (int i = 1; i < num_interfaces; ++i) {
+      content += " veth" + std::to_string(i) + ": 98765432  65432    0    0    0     0          0         0 12345678 "
+                 "  54321    0    0    0     0       0          0\n";
+    }
+    tree.add_file("/proc/net/dev", content);
+  });
+}
+
+// _____________________________________________________________________________________________________________________
+FixtureRoot::FixtureRoot(const filesystem::MemoryTree& tree) {
+  (void)Topology::get();
+  (void)Cgroup::get();
+  _valid = tree.valid() && filesystem::set_root(tree.path());
+}
+
+// _____________________________________________________________________________________________________________________
+FixtureRoot::~FixtureRoot() { filesystem::set_root("/"); }
+
+}  // namespace bench
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
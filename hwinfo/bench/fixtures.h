@@ -0,0 +1,49 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/utils/filesystem.h>
+
+namespace hwinfo {
+namespace bench {
+
+// Synthetic /proc and /sys trees for filesystem::set_root(). Every tree is generated on first use and kept until exit.
+
+// A host with num_cpus logical cpus (two threads per core, two sockets from 64 cpus on): /proc/stat, /proc/cpuinfo
+// and /sys/devices/system/cpu with topology, caches and cpufreq.
+const filesystem::MemoryTree& cpu_fixture(int num_cpus);
+
+// /proc/self/mountinfo with num_mounts mounts: block devices, overlays of containers and bind mounts with escaped
+// blanks in their paths, the mix that makes mount tables of container hosts large.
+const filesystem::MemoryTree& mount_fixture(int num_mounts);
+
+// /proc/net/dev with num_interfaces interfaces (the veth pairs of a container host).
+const filesystem::MemoryTree& network_fixture(int num_interfaces);
+
+/**
+ * Makes the collectors read the tree for the lifetime of the object, then the real root again. The process wide
+ * values that are bound to the root of their first use (Topology::get(), Cgroup::get()) are read from the real root
+ * before.
+ */
+class FixtureRoot {
+ public:
+  explicit FixtureRoot(const filesystem::MemoryTree& tree);
+  ~FixtureRoot();
+  FixtureRoot(const FixtureRoot&) = delete;
+  FixtureRoot& operator=(const FixtureRoot&) = delete;
+
+  HWI_NODISCARD bool valid() const { return _valid; }
+
+ private:
+  bool _valid{false};
+};
+
+}  // namespace bench
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -0,0 +1,131 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+// Scaling runs of the Linux collectors against synthetic trees (see fixtures.h and filesystem::set_root()), so that
+// the behaviour on hosts with 1024 cpus or thousands of mounts and interfaces can be measured without such a host.
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <benchmark/benchmark.h>
+#include <hwinfo/hwinfo.h>
+#include <hwinfo/utils/mountinfo.h>
+#include <hwinfo/utils/proc_stat.h>
+
+#include "counters.h"
+#include "fixtures.h"
+
+namespace {
+
+using hwinfo::bench::CallCounters;
+using hwinfo::bench::FixtureRoot;
+
+// _____________________________________________________________________________________________________________________
+// One /proc/stat read, as done by every utilisation sample.
+void BM_StatSnapshot_cpus(benchmark::State& state) {
+  const FixtureRoot root(hwinfo::bench::cpu_fixture(static_cast<int>(state.range(0))));
+  hwinfo::utils::StatSnapshot snapshot;
+  if (!root.valid() || !snapshot.update()) {
+    state.SkipWithError("fixture");
+    return;
+  }
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(snapshot.update());
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_StatSnapshot_cpus)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// _____________________________________________________________________________________________________________________
+void BM_ThreadMetrics_cpus(benchmark::State& state) {
+  const FixtureRoot root(hwinfo::bench::cpu_fixture(static_cast<int>(state.range(0))));
+  hwinfo::ThreadMetrics metrics;
+  if (!root.valid() || !metrics.update()) {
+    state.SkipWithError("fixture");
+    return;
+  }
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(metrics.update());
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ThreadMetrics_cpus)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// _____________________________________________________________________________________________________________________
+// /proc/cpuinfo up to the first block of the last socket plus the sockets from sysfs.
+void BM_getAllCPUs_cpus(benchmark::State& state) {
+  const FixtureRoot root(hwinfo::bench::cpu_fixture(static_cast<int>(state.range(0))));
+  if (!root.valid() || hwinfo::getAllCPUs().empty()) {
+    state.SkipWithError("fixture");
+    return;
+  }
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::getAllCPUs());
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_getAllCPUs_cpus)->RangeMultiplier(4)->Range(4, 1024)->Complexity();
+
+// _____________________________________________________________________________________________________________________
+void BM_Topology_read_cpus(benchmark::State& state) {
+  const FixtureRoot root(hwinfo::bench::cpu_fixture(static_cast<int>(state.range(0))));
+  if (!root.valid()) {
+    state.SkipWithError("fixture");
+    return;
+  }
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hwinfo::Topology::read());
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_Topology_read_cpus)->RangeMultiplier(4)->Range(4, 1024)->Complexity()->Unit(benchmark::kMicrosecond);
+
+// _____________________________________________________________________________________________________________________
+// Full parse of a mount table, as paid by every change of the mount namespace.
+void BM_MountIndex_parse(benchmark::State& state) {
+  const FixtureRoot root(hwinfo::bench::mount_fixture(static_cast<int>(state.range(0))));
+  CallCounters counters(state);
+  for (auto _ : state) {
+    hwinfo::utils::MountIndex index;
+    index.refresh();
+    benchmark::DoNotOptimize(index.of_source("/dev/nvme0n1p2"));
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_MountIndex_parse)->RangeMultiplier(4)->Range(16, 16384)->Complexity();
+
+// _____________________________________________________________________________________________________________________
+// refresh() of an unchanged mount table: a single poll(), independent of the number of mounts.
+void BM_MountIndex_refresh(benchmark::State& state) {
+  const FixtureRoot root(hwinfo::bench::mount_fixture(static_cast<int>(state.range(0))));
+  hwinfo::utils::MountIndex index;
+  index.refresh();
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.refresh());
+  }
+}
+BENCHMARK(BM_MountIndex_refresh)->Arg(16)->Arg(16384);
+
+// _____________________________________________________________________________________________________________________
+// One /proc/net/dev read for the interfaces of the host, while the file lists state.range(0) interfaces.
+void BM_NetworkStatsSampler_interfaces(benchmark::State& state) {
+  const FixtureRoot root(hwinfo::bench::network_fixture(static_cast<int>(state.range(0))));
+  // the interfaces themselves are enumerated with netlink, not below the root
+  hwinfo::NetworkStatsSampler sampler;
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sampler.update());
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_NetworkStatsSampler_interfaces)->RangeMultiplier(4)->Range(16, 16384)->Complexity();
+
+}  // namespace
+
+#endif  // HWINFO_UNIX
@@ -0,0 +1,91 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+// Samplers: construction plus a first update() (cold, discovers the devices and opens their counters) against
+// update() of an existing sampler (warm, the polling path that is expected to neither allocate nor open files).
+
+#include <benchmark/benchmark.h>
+#include <hwinfo/hwinfo.h>
+
+#include <cstdint>
+#include <vector>
+
+#ifdef HWINFO_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "counters.h"
+
+namespace {
+
+using hwinfo::bench::CallCounters;
+
+// _____________________________________________________________________________________________________________________
+template <typename Sampler>
+void run_sampler(benchmark::State& state) {
+  CallCounters counters(state);
+  if (state.range(0) == 0) {
+    for (auto _ : state) {
+      Sampler sampler;
+      benchmark::DoNotOptimize(sampler.update());
+    }
+  } else {
+    Sampler sampler;
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(sampler.update());
+    }
+  }
+}
+
+BENCHMARK_TEMPLATE(run_sampler, hwinfo::DiskStatsSampler)->ArgName("warm")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(run_sampler, hwinfo::NetworkStatsSampler)->ArgName("warm")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(run_sampler, hwinfo::GPUStatsSampler)->ArgName("warm")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(run_sampler, hwinfo::FrequencySampler)->ArgName("warm")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(run_sampler, hwinfo::SensorSampler)->ArgName("warm")->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(run_sampler, hwinfo::ThreadMetrics)->ArgName("warm")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+void BM_ProcessSampler(benchmark::State& state) {
+#ifdef HWINFO_WINDOWS
+  const std::vector<int64_t> pids{_getpid()};
+#else
+  const std::vector<int64_t> pids{getpid()};
+#endif
+  CallCounters counters(state);
+  if (state.range(0) == 0) {
+    for (auto _ : state) {
+      hwinfo::ProcessSampler sampler(pids);
+      benchmark::DoNotOptimize(sampler.update());
+    }
+  } else {
+    hwinfo::ProcessSampler sampler(pids);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(sampler.update());
+    }
+  }
+}
+BENCHMARK(BM_ProcessSampler)->ArgName("warm")->Arg(0)->Arg(1);
+
+// _____________________________________________________________________________________________________________________
+void BM_UtilisationSampler(benchmark::State& state) {
+  hwinfo::UtilisationSampler sampler;
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sampler.sample());
+  }
+}
+BENCHMARK(BM_UtilisationSampler);
+
+// _____________________________________________________________________________________________________________________
+void BM_CgroupUsageSampler(benchmark::State& state) {
+  hwinfo::CgroupUsageSampler sampler;
+  CallCounters counters(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sampler.sample());
+  }
+}
+BENCHMARK(BM_CgroupUsageSampler);
+
+}  // namespace
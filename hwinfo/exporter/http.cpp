@@ -0,0 +1,337 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include "http.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#ifdef HWINFO_WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+#ifdef HWINFO_EXPORTER_ZLIB
+#include <zlib.h>
+#endif
+
+namespace hwinfo {
+namespace exporter {
+
+namespace {
+
+#ifdef HWINFO_WINDOWS
+using Socket = SOCKET;
+const Socket kInvalidSocket = INVALID_SOCKET;
+#else
+using Socket = int;
+const Socket kInvalidSocket = -1;
+#endif
+
+// requests of scrapers are a few hundred bytes, anything longer is not a scrape
+constexpr size_t kMaxRequestSize = 16 * 1024;
+// a client that does not send its request (or read the response) within this time is dropped
+constexpr int kClientTimeoutMs = 5000;
+
+// _____________________________________________________________________________________________________________________
+void close_socket(Socket socket) {
+#ifdef HWINFO_WINDOWS
+  closesocket(socket);
+#else
+  close(socket);
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+void set_timeouts(Socket socket) {
+#ifdef HWINFO_WINDOWS
+  const DWORD timeout = kClientTimeoutMs;
+#else
+  timeval timeout{};
+  timeout.tv_sec = kClientTimeoutMs / 1000;
+  timeout.tv_usec = (kClientTimeoutMs % 1000) * 1000;
+#endif
+  setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+  setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+// _____________________________________________________________________________________________________________________
+bool send_all(Socket socket, const char* data, size_t size) {
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  // SIGPIPE is ignored by the exporter
+  const int flags = 0;
+#endif
+  while (size > 0) {
+    const int chunk = static_cast<int>(std::min<size_t>(size, 1 << 30));
+    const auto sent = send(socket, data, chunk, flags);
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+bool equals_ignore_case(std::string_view a, std::string_view b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+// _____________________________________________________________________________________________________________________
+const char* status_text(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 400:
+      return "Bad Request";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    default:
+      return "Internal Server Error";
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+// Parses the request line and the headers of a complete request head.
+bool parse_request(std::string_view head, Request& request) {
+  request.accepts_gzip = false;
+  request.accepts_openmetrics = false;
+  size_t line_end = head.find("\r\n");
+  const std::string_view line = head.substr(0, line_end);
+  const size_t method_end = line.find(' ');
+  const size_t path_end = line.find(' ', method_end + 1);
+  if (method_end == std::string_view::npos || path_end == std::string_view::npos) {
+    return false;
+  }
+  request.method.assign(line.substr(0, method_end));
+  std::string_view path = line.substr(method_end + 1, path_end - method_end - 1);
+  path = path.substr(0, path.find('?'));
+  request.path.assign(path);
+
+  while (line_end != std::string_view::npos) {
+    const size_t begin = line_end + 2;
+    line_end = head.find("\r\n", begin);
+    const std::string_view header = head.substr(begin, line_end - begin);
+    const size_t colon = header.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    const std::string_view name = header.substr(0, colon);
+    const std::string_view value = header.substr(colon + 1);
+    if (equals_ignore_case(name, "accept-encoding")) {
+      request.accepts_gzip = value.find("gzip") != std::string_view::npos;
+    } else if (equals_ignore_case(name, "accept")) {
+      request.accepts_openmetrics = value.find("application/openmetrics-text") != std::string_view::npos;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+struct HttpServer::Source {
+  Socket listener{kInvalidSocket};
+  Socket client{kInvalidSocket};
+  std::string request;
+  std::string header;
+  std::string compressed;
+#ifdef HWINFO_WINDOWS
+  bool wsa_started{false};
+#endif
+#ifdef HWINFO_EXPORTER_ZLIB
+  z_stream stream{};
+  bool has_stream{false};
+#endif
+
+  ~Source() {
+    if (client != kInvalidSocket) {
+      close_socket(client);
+    }
+    if (listener != kInvalidSocket) {
+      close_socket(listener);
+    }
+#ifdef HWINFO_WINDOWS
+    if (wsa_started) {
+      WSACleanup();
+    }
+#endif
+#ifdef HWINFO_EXPORTER_ZLIB
+    if (has_stream) {
+      deflateEnd(&stream);
+    }
+#endif
+  }
+
+  // Compresses body into compressed (gzip). false if zlib is not available or failed.
+  bool compress(const std::string& body) {
+#ifdef HWINFO_EXPORTER_ZLIB
+    if (!has_stream) {
+      // fastest level: a scrape is mostly repeated label sets, which compress well regardless
+      if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+      }
+      has_stream = true;
+    } else if (deflateReset(&stream) != Z_OK) {
+      return false;
+    }
+    compressed.resize(deflateBound(&stream, static_cast<uLong>(body.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+    stream.avail_in = static_cast<uInt>(body.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+      return false;
+    }
+    compressed.resize(stream.total_out);
+    return true;
+#else
+    (void)body;
+    return false;
+#endif
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+HttpServer::HttpServer(const std::string& address, const std::string& port) : _source(std::make_unique<Source>()) {
+#ifdef HWINFO_WINDOWS
+  WSADATA data{};
+  if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+    return;
+  }
+  _source->wsa_started = true;
+#endif
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(address.empty() ? nullptr : address.c_str(), port.c_str(), &hints, &addresses) != 0) {
+    return;
+  }
+  for (const addrinfo* it = addresses; it != nullptr; it = it->ai_next) {
+    const Socket listener = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+    if (listener == kInvalidSocket) {
+      continue;
+    }
+    const int enable = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&enable), sizeof(enable));
+    if (bind(listener, it->ai_addr, static_cast<int>(it->ai_addrlen)) == 0 && listen(listener, 64) == 0) {
+      _source->listener = listener;
+      break;
+    }
+    close_socket(listener);
+  }
+  freeaddrinfo(addresses);
+  _source->request.resize(kMaxRequestSize);
+}
+
+// _____________________________________________________________________________________________________________________
+HttpServer::~HttpServer() = default;
+
+// _____________________________________________________________________________________________________________________
+bool HttpServer::valid() const { return _source->listener != kInvalidSocket; }
+
+// _____________________________________________________________________________________________________________________
+bool HttpServer::accept(std::chrono::milliseconds timeout, Request& request) {
+  Source& source = *_source;
+  if (source.listener == kInvalidSocket) {
+    return false;
+  }
+#ifdef HWINFO_WINDOWS
+  WSAPOLLFD descriptor{};
+  descriptor.fd = source.listener;
+  descriptor.events = POLLRDNORM;
+  if (WSAPoll(&descriptor, 1, static_cast<INT>(timeout.count())) <= 0) {
+    return false;
+  }
+#else
+  pollfd descriptor{source.listener, POLLIN, 0};
+  if (poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+    return false;
+  }
+#endif
+  source.client = ::accept(source.listener, nullptr, nullptr);
+  if (source.client == kInvalidSocket) {
+    return false;
+  }
+  set_timeouts(source.client);
+
+  // the request head ends with an empty line, a scrape has no body
+  size_t size = 0;
+  size_t head_end = std::string::npos;
+  while (head_end == std::string::npos && size < source.request.size()) {
+    const auto received = recv(source.client, &source.request[size], static_cast<int>(source.request.size() - size), 0);
+    if (received <= 0) {
+      break;
+    }
+    // the terminator may span two reads
+    const size_t from = size < 3 ? 0 : size - 3;
+    size += static_cast<size_t>(received);
+    head_end = std::string_view(source.request.data(), size).find("\r\n\r\n", from);
+  }
+  if (head_end == std::string::npos) {
+    if (size == 0) {
+      // connection checks without a request
+      close_socket(source.client);
+      source.client = kInvalidSocket;
+      return false;
+    }
+    respond(400, "text/plain; charset=utf-8", std::string(), false);
+    return false;
+  }
+  if (!parse_request(std::string_view(source.request.data(), head_end + 2), request)) {
+    respond(400, "text/plain; charset=utf-8", std::string(), false);
+    return false;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+void HttpServer::respond(int status, const char* content_type, const std::string& body, bool gzip) {
+  Source& source = *_source;
+  if (source.client == kInvalidSocket) {
+    return;
+  }
+  const bool compressed = gzip && !body.empty() && source.compress(body);
+  const std::string& payload = compressed ? source.compressed : body;
+
+  char number[24];
+  std::string& header = source.header;
+  header.assign("HTTP/1.1 ");
+  header.append(number, std::to_chars(number, number + sizeof(number), status).ptr);
+  header.push_back(' ');
+  header += status_text(status);
+  header += "\r\nContent-Type: ";
+  header += content_type;
+  header += "\r\nContent-Length: ";
+  header.append(number, std::to_chars(number, number + sizeof(number), payload.size()).ptr);
+  if (compressed) {
+    header += "\r\nContent-Encoding: gzip";
+  }
+  header += "\r\nVary: Accept-Encoding\r\nConnection: close\r\n\r\n";
+  if (send_all(source.client, header.data(), header.size())) {
+    send_all(source.client, payload.data(), payload.size());
+  }
+  close_socket(source.client);
+  source.client = kInvalidSocket;
+}
+
+}  // namespace exporter
+}  // namespace hwinfo
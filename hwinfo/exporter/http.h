@@ -0,0 +1,60 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace hwinfo {
+namespace exporter {
+
+// The parts of a request the exporter looks at. Reused between requests.
+struct Request {
+  std::string method;
+  std::string path;
+  // "Accept-Encoding: gzip"
+  bool accepts_gzip{false};
+  // "Accept: application/openmetrics-text"
+  bool accepts_openmetrics{false};
+};
+
+/**
+ * Minimal blocking HTTP/1.1 server for scrapes: one connection at a time, one request per connection (answered with
+ * "Connection: close"). Responses are compressed with gzip if the client accepts it and the exporter was built with
+ * zlib. The request, header and compression buffers are kept, so serving a scrape does not allocate once they have
+ * grown to its size.
+ */
+class HttpServer {
+ public:
+  // Listens on address (IPv4 or IPv6, empty for all interfaces) and port.
+  HttpServer(const std::string& address, const std::string& port);
+  ~HttpServer();
+  HttpServer(const HttpServer&) = delete;
+  HttpServer& operator=(const HttpServer&) = delete;
+
+  // false if the socket could not be bound.
+  HWI_NODISCARD bool valid() const;
+
+  /**
+   * Waits up to timeout for a connection and reads its request. Malformed requests are answered and closed here.
+   * @return true if a request was read, respond() must be called next
+   */
+  bool accept(std::chrono::milliseconds timeout, Request& request);
+
+  // Answers the request read by accept() and closes the connection.
+  void respond(int status, const char* content_type, const std::string& body, bool gzip);
+
+ private:
+  // Platform specific state, the sockets and the zlib stream.
+  struct Source;
+
+  std::unique_ptr<Source> _source;
+};
+
+}  // namespace exporter
+}  // namespace hwinfo
@@ -0,0 +1,134 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+// hwinfo_exporter: serves the frames of a Sampler as Prometheus/OpenMetrics metrics on /metrics.
+//
+//   hwinfo_exporter [--listen [ADDRESS:]PORT] [--interval MS]
+
+#include <hwinfo/cpu_times.h>
+#include <hwinfo/platform.h>
+#include <hwinfo/sampler.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "http.h"
+#include "metrics.h"
+
+namespace {
+
+constexpr const char* kDefaultPort = "9183";
+constexpr const char* kPrometheusContentType = "text/plain; version=0.0.4; charset=utf-8";
+constexpr const char* kOpenMetricsContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+volatile std::sig_atomic_t g_stop = 0;
+
+// _____________________________________________________________________________________________________________________
+void handle_stop(int) { g_stop = 1; }
+
+// _____________________________________________________________________________________________________________________
+void usage(const char* program) {
+  std::fprintf(stderr, "usage: %s [--listen [ADDRESS:]PORT] [--interval MS]\n", program);
+  std::fprintf(stderr, "  --listen    address and port of the /metrics endpoint (default :%s)\n", kDefaultPort);
+  std::fprintf(stderr, "  --interval  sampling interval in milliseconds (default 1000)\n");
+}
+
+// _____________________________________________________________________________________________________________________
+// Splits "[ADDRESS:]PORT"; IPv6 addresses are written in brackets, e.g. [::1]:9183.
+void split_listen(const std::string& listen, std::string& address, std::string& port) {
+  const size_t colon = listen.rfind(':');
+  if (colon == std::string::npos) {
+    address.clear();
+    port = listen;
+    return;
+  }
+  address = listen.substr(0, colon);
+  port = listen.substr(colon + 1);
+  if (address.size() >= 2 && address.front() == '[' && address.back() == ']') {
+    address = address.substr(1, address.size() - 2);
+  }
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+int main(int argc, char** argv) {
+  using namespace hwinfo;
+  std::string address;
+  std::string port = kDefaultPort;
+  long interval_ms = 1000;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+      split_listen(argv[++i], address, port);
+    } else if (std::strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+      interval_ms = std::strtol(argv[++i], nullptr, 10);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (interval_ms <= 0 || port.empty()) {
+    usage(argv[0]);
+    return 2;
+  }
+
+#ifndef HWINFO_WINDOWS
+  // a scraper closing the connection early must not terminate the exporter
+  std::signal(SIGPIPE, SIG_IGN);
+#endif
+  std::signal(SIGINT, handle_stop);
+  std::signal(SIGTERM, handle_stop);
+
+  const std::chrono::milliseconds interval(interval_ms);
+  exporter::HttpServer server(address, port);
+  if (!server.valid()) {
+    std::fprintf(stderr, "hwinfo_exporter: cannot listen on %s:%s\n", address.c_str(), port.c_str());
+    return 1;
+  }
+  // the ring only has to bridge one poll timeout: it is drained after every wake-up
+  Sampler sampler(interval, 64);
+  const exporter::MetricsEncoder encoder(exporter::StaticLabels::collect(sampler));
+
+  exporter::Scrape scrape;
+  scrape.thread_utilisation.resize(static_cast<size_t>(sampler.num_threads()));
+  scrape.thread_speed_MHz.resize(static_cast<size_t>(sampler.num_threads()));
+  scrape.disks.resize(static_cast<size_t>(sampler.num_disks()));
+  scrape.networks.resize(static_cast<size_t>(sampler.num_networks()));
+  scrape.gpus.resize(static_cast<size_t>(sampler.num_gpus()));
+  CpuTimes total;
+  exporter::Request request;
+  std::string body;
+
+  while (g_stop == 0) {
+    const bool requested = server.accept(interval, request);
+    // keep only the latest frame, every drain overwrites the values of the previous one
+    while (sampler.drain(&scrape.frame, 1, scrape.thread_utilisation.data(), scrape.thread_speed_MHz.data(),
+                         scrape.disks.data(), scrape.networks.data(), scrape.gpus.data()) == 1) {
+      scrape.has_frame = true;
+    }
+    if (!requested) {
+      continue;
+    }
+    if (request.method != "GET") {
+      server.respond(405, "text/plain; charset=utf-8", std::string(), false);
+      continue;
+    }
+    if (request.path != "/metrics") {
+      server.respond(404, "text/plain; charset=utf-8", std::string(), false);
+      continue;
+    }
+    readCpuTimes(total, scrape.cpu_times);
+    scrape.dropped_frames = sampler.dropped();
+    const exporter::Format format =
+        request.accepts_openmetrics ? exporter::Format::OpenMetrics : exporter::Format::Prometheus;
+    encoder.encode(scrape, format, body);
+    server.respond(200, format == exporter::Format::OpenMetrics ? kOpenMetricsContentType : kPrometheusContentType,
+                   body, request.accepts_gzip);
+  }
+  sampler.stop();
+  return 0;
+}
@@ -0,0 +1,387 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include "metrics.h"
+
+#include <hwinfo/cpu.h>
+#include <hwinfo/disk.h>
+#include <hwinfo/fields.h>
+#include <hwinfo/gpu.h>
+#include <hwinfo/network.h>
+#include <hwinfo/platform.h>
+
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <vector>
+
+#ifndef HWINFO_WINDOWS
+#include <unistd.h>
+#endif
+
+namespace hwinfo {
+namespace exporter {
+
+namespace {
+
+// Label set of the series of a family.
+enum class Labels { CpuInfo, None, Cpu, CpuMode, Disk, Network, GPU };
+
+struct FamilyDefinition {
+  // without the _total suffix of counters
+  const char* name;
+  const char* type;
+  const char* help;
+  Labels labels;
+};
+
+// in the order of the families in the exposition
+enum FamilyId : size_t {
+  kCpuInfo,
+  kCpuSeconds,
+  kCpuBusy,
+  kThreadBusy,
+  kThreadFrequency,
+  kMemoryFree,
+  kMemoryAvailable,
+  kBatteryCharging,
+  kDiskReads,
+  kDiskWrites,
+  kDiskReadBytes,
+  kDiskWrittenBytes,
+  kDiskReadAwait,
+  kDiskWriteAwait,
+  kDiskQueueDepth,
+  kDiskBusy,
+  kDiskInFlight,
+  kNetworkReceiveBytes,
+  kNetworkTransmitBytes,
+  kNetworkReceivePackets,
+  kNetworkTransmitPackets,
+  kNetworkReceiveErrors,
+  kNetworkTransmitErrors,
+  kNetworkReceiveDrops,
+  kNetworkTransmitDrops,
+  kGPUBusy,
+  kGPUMemoryUsed,
+  kGPUMemoryTotal,
+  kGPUCoreFrequency,
+  kGPUMemoryFrequency,
+  kGPUPower,
+  kGPUTemperature,
+  kDroppedFrames,
+  kNumFamilies,
+};
+
+// clang-format off
+const FamilyDefinition kFamilies[] = {
+    {"hwinfo_cpu_info", "gauge", "Vendor and model of the cpu.", Labels::CpuInfo},
+    {"hwinfo_cpu_seconds", "counter", "Time the cpu spent in each mode (guest time is part of user and nice).",
+     Labels::CpuMode},
+    {"hwinfo_cpu_busy_ratio", "gauge", "Share of the sampling period all cpus were busy.", Labels::None},
+    {"hwinfo_cpu_thread_busy_ratio", "gauge", "Share of the sampling period the cpu was busy.", Labels::Cpu},
+    {"hwinfo_cpu_thread_frequency_hertz", "gauge", "Effective clock of the cpu while not halted.", Labels::Cpu},
+    {"hwinfo_memory_free_bytes", "gauge", "Unused memory.", Labels::None},
+    {"hwinfo_memory_available_bytes", "gauge", "Memory available for new allocations without swapping.",
+     Labels::None},
+    {"hwinfo_battery_charging", "gauge", "1 if any battery is charging.", Labels::None},
+    {"hwinfo_disk_reads_per_second", "gauge", "Completed read requests.", Labels::Disk},
+    {"hwinfo_disk_writes_per_second", "gauge", "Completed write requests.", Labels::Disk},
+    {"hwinfo_disk_read_bytes_per_second", "gauge", "Bytes read.", Labels::Disk},
+    {"hwinfo_disk_written_bytes_per_second", "gauge", "Bytes written.", Labels::Disk},
+    {"hwinfo_disk_read_await_seconds", "gauge", "Mean time of the completed read requests, queueing included.",
+     Labels::Disk},
+    {"hwinfo_disk_write_await_seconds", "gauge", "Mean time of the completed write requests, queueing included.",
+     Labels::Disk},
+    {"hwinfo_disk_queue_depth", "gauge", "Mean number of requests in flight.", Labels::Disk},
+    {"hwinfo_disk_busy_ratio", "gauge", "Share of the sampling period with requests in flight.", Labels::Disk},
+    {"hwinfo_disk_in_flight_requests", "gauge", "Requests in flight at the end of the sampling period.",
+     Labels::Disk},
+    {"hwinfo_network_receive_bytes_per_second", "gauge", "Bytes received.", Labels::Network},
+    {"hwinfo_network_transmit_bytes_per_second", "gauge", "Bytes transmitted.", Labels::Network},
+    {"hwinfo_network_receive_packets_per_second", "gauge", "Packets received.", Labels::Network},
+    {"hwinfo_network_transmit_packets_per_second", "gauge", "Packets transmitted.", Labels::Network},
+    {"hwinfo_network_receive_errors_per_second", "gauge", "Receive errors.", Labels::Network},
+    {"hwinfo_network_transmit_errors_per_second", "gauge", "Transmit errors.", Labels::Network},
+    {"hwinfo_network_receive_drops_per_second", "gauge", "Received packets dropped by the host.", Labels::Network},
+    {"hwinfo_network_transmit_drops_per_second", "gauge", "Packets to transmit dropped by the host.",
+     Labels::Network},
+    {"hwinfo_gpu_busy_ratio", "gauge", "Busy share of the graphics/compute engine.", Labels::GPU},
+    {"hwinfo_gpu_memory_used_bytes", "gauge", "Used video memory.", Labels::GPU},
+    {"hwinfo_gpu_memory_total_bytes", "gauge", "Video memory.", Labels::GPU},
+    {"hwinfo_gpu_core_frequency_hertz", "gauge", "Current core clock.", Labels::GPU},
+    {"hwinfo_gpu_memory_frequency_hertz", "gauge", "Current memory clock.", Labels::GPU},
+    {"hwinfo_gpu_power_watts", "gauge", "Board power.", Labels::GPU},
+    {"hwinfo_gpu_temperature_celsius", "gauge", "GPU temperature.", Labels::GPU},
+    {"hwinfo_sampler_dropped_frames", "counter", "Sampler ticks skipped because the ring buffer was full.",
+     Labels::None},
+};
+// clang-format on
+static_assert(sizeof(kFamilies) / sizeof(kFamilies[0]) == kNumFamilies, "a family is missing");
+
+// the modes of hwinfo_cpu_seconds_total, in the order of the CpuTimes members
+const char* const kModeNames[] = {"user", "nice", "system", "idle", "iowait", "irq", "softirq", "steal", "guest",
+                                  "guest_nice"};
+constexpr int64_t CpuTimes::*kModes[] = {
+    &CpuTimes::user, &CpuTimes::nice,    &CpuTimes::system, &CpuTimes::idle,  &CpuTimes::iowait,
+    &CpuTimes::irq,  &CpuTimes::softirq, &CpuTimes::steal,  &CpuTimes::guest, &CpuTimes::guest_nice};
+constexpr size_t kNumModes = sizeof(kModes) / sizeof(kModes[0]);
+
+// _____________________________________________________________________________________________________________________
+void append_label(std::string& out, const char* name, const std::string& value) {
+  if (out.back() != '{') {
+    out.push_back(',');
+  }
+  out += name;
+  out += "=\"";
+  for (char c : value) {
+    if (c == '\\') {
+      out += "\\\\";
+    } else if (c == '"') {
+      out += "\\\"";
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+}
+
+// _____________________________________________________________________________________________________________________
+void append_number(std::string& out, double value) {
+  char buffer[32];
+  const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+  out.push_back('\n');
+}
+
+// _____________________________________________________________________________________________________________________
+// Label sets of the series of a family, e.g. {cpu="3",mode="user"}, without the braces.
+std::vector<std::string> label_sets(Labels labels, const StaticLabels& values) {
+  std::vector<std::string> sets;
+  std::string set;
+  const auto add = [&](const auto& append) {
+    set.assign("{");
+    append();
+    sets.push_back(set.substr(1));
+  };
+  switch (labels) {
+    case Labels::CpuInfo:
+      add([&] {
+        append_label(set, "vendor", values.cpu_vendor);
+        append_label(set, "model", values.cpu_model);
+      });
+      break;
+    case Labels::None:
+      sets.emplace_back();
+      break;
+    case Labels::Cpu:
+      for (int cpu = 0; cpu < values.num_threads; ++cpu) {
+        add([&] { append_label(set, "cpu", std::to_string(cpu)); });
+      }
+      break;
+    case Labels::CpuMode:
+      for (int cpu = 0; cpu < values.num_threads; ++cpu) {
+        for (const char* mode : kModeNames) {
+          add([&] {
+            append_label(set, "cpu", std::to_string(cpu));
+            append_label(set, "mode", mode);
+          });
+        }
+      }
+      break;
+    case Labels::Disk:
+      for (const auto& disk : values.disks) {
+        add([&] {
+          append_label(set, "device", disk.device);
+          append_label(set, "model", disk.model);
+          append_label(set, "serial", disk.serial);
+        });
+      }
+      break;
+    case Labels::Network:
+      for (const auto& network : values.networks) {
+        add([&] {
+          append_label(set, "interface", network.interface);
+          append_label(set, "mac", network.mac);
+        });
+      }
+      break;
+    case Labels::GPU:
+      for (const auto& gpu : values.gpus) {
+        add([&] {
+          append_label(set, "pci_bus_id", gpu.pci_bus_id);
+          append_label(set, "name", gpu.name);
+        });
+      }
+      break;
+  }
+  return sets;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+StaticLabels StaticLabels::collect(const Sampler& sampler) {
+  StaticLabels labels;
+  const auto cpus = getAllCPUs(CPUFields::None);
+  if (!cpus.empty()) {
+    labels.cpu_vendor = cpus.front().vendor();
+    labels.cpu_model = cpus.front().modelName();
+  }
+  CpuTimes total;
+  std::vector<CpuTimes> threads;
+  readCpuTimes(total, threads);
+  labels.num_threads = std::max(sampler.num_threads(), static_cast<int>(threads.size()));
+
+  const auto disks = getAllDisks(DiskFields::Identity);
+  for (const std::string& device : sampler.disk_names()) {
+    Disk disk{device, {}, {}};
+    auto it = std::find_if(disks.begin(), disks.end(), [&](const hwinfo::Disk& d) { return d.deviceName() == device; });
+    if (it != disks.end()) {
+      disk.model = it->model();
+      disk.serial = it->serialNumber();
+    }
+    labels.disks.push_back(std::move(disk));
+  }
+  const auto networks = getAllNetworks(NetworkFields::Mac);
+  for (int index : sampler.network_indices()) {
+    const std::string key = std::to_string(index);
+    Network network{key, {}};
+    auto it = std::find_if(networks.begin(), networks.end(),
+                           [&](const hwinfo::Network& n) { return n.interfaceIndex() == key; });
+    if (it != networks.end()) {
+      network.interface = it->description();
+      network.mac = it->mac();
+    }
+    labels.networks.push_back(std::move(network));
+  }
+  const auto gpus = getAllGPUs(GPUFields::Names);
+  for (const std::string& id : sampler.gpu_pci_bus_ids()) {
+    GPU gpu{id, {}};
+    auto it = std::find_if(gpus.begin(), gpus.end(), [&](const hwinfo::GPU& g) { return g.pciBusId() == id; });
+    if (it != gpus.end()) {
+      gpu.name = it->name();
+    }
+    labels.gpus.push_back(std::move(gpu));
+  }
+  return labels;
+}
+
+// _____________________________________________________________________________________________________________________
+MetricsEncoder::MetricsEncoder(const StaticLabels& labels) {
+#ifdef HWINFO_WINDOWS
+  // the counters of NtQuerySystemInformation are in 100 ns units
+  _tick_seconds = 1e-7;
+#else
+  _tick_seconds = 1.0 / static_cast<double>(std::max<long>(sysconf(_SC_CLK_TCK), 1));
+#endif
+  _families.resize(kNumFamilies);
+  for (size_t i = 0; i < kNumFamilies; ++i) {
+    const FamilyDefinition& definition = kFamilies[i];
+    Family& family = _families[i];
+    const bool counter = std::string(definition.type) == "counter";
+    const std::string sample_name = std::string(definition.name) + (counter ? "_total" : "");
+    // OpenMetrics names the family without the _total suffix of its samples
+    family.prometheus_header = "# HELP " + sample_name + " " + definition.help + "\n# TYPE " + sample_name + " " +
+                               definition.type + "\n";
+    family.openmetrics_header = "# HELP " + std::string(definition.name) + " " + definition.help + "\n# TYPE " +
+                                definition.name + " " + definition.type + "\n";
+    for (const std::string& set : label_sets(definition.labels, labels)) {
+      family.prefixes += sample_name;
+      if (!set.empty()) {
+        family.prefixes += "{" + set + "}";
+      }
+      family.prefixes.push_back(' ');
+      family.ends.push_back(family.prefixes.size());
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Value>
+void MetricsEncoder::append_family(size_t family, size_t count, Format format, std::string& out,
+                                   const Value& value) const {
+  const Family& definition = _families[family];
+  out += format == Format::OpenMetrics ? definition.openmetrics_header : definition.prometheus_header;
+  count = std::min(count, definition.ends.size());
+  size_t begin = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const double sample = value(i);
+    if (sample >= 0) {
+      out.append(definition.prefixes, begin, definition.ends[i] - begin);
+      append_number(out, sample);
+    }
+    begin = definition.ends[i];
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void MetricsEncoder::encode(const Scrape& scrape, Format format, std::string& out) const {
+  out.clear();
+  const MetricFrame& frame = scrape.frame;
+  const size_t frames = scrape.has_frame ? 1 : 0;
+  const size_t threads = scrape.has_frame ? scrape.thread_utilisation.size() : 0;
+  const size_t disks = scrape.has_frame ? scrape.disks.size() : 0;
+  const size_t networks = scrape.has_frame ? scrape.networks.size() : 0;
+  const size_t gpus = scrape.has_frame ? scrape.gpus.size() : 0;
+
+  append_family(kCpuInfo, 1, format, out, [](size_t) { return 1.0; });
+  append_family(kCpuSeconds, scrape.cpu_times.size() * kNumModes, format, out, [&](size_t i) {
+    const int64_t ticks = scrape.cpu_times[i / kNumModes].*kModes[i % kNumModes];
+    return ticks < 0 ? -1.0 : static_cast<double>(ticks) * _tick_seconds;
+  });
+  append_family(kCpuBusy, frames, format, out, [&](size_t) { return frame.cpu_utilisation; });
+  append_family(kThreadBusy, threads, format, out, [&](size_t i) { return scrape.thread_utilisation[i]; });
+  append_family(kThreadFrequency, std::min(threads, scrape.thread_speed_MHz.size()), format, out,
+                [&](size_t i) { return static_cast<double>(scrape.thread_speed_MHz[i]) * 1e6; });
+  append_family(kMemoryFree, frames, format, out,
+                [&](size_t) { return static_cast<double>(frame.memory_free_Bytes); });
+  append_family(kMemoryAvailable, frames, format, out,
+                [&](size_t) { return static_cast<double>(frame.memory_available_Bytes); });
+  append_family(kBatteryCharging, frames, format, out,
+                [&](size_t) { return static_cast<double>(frame.battery_charging); });
+
+  const auto& d = scrape.disks;
+  append_family(kDiskReads, disks, format, out, [&](size_t i) { return d[i].reads_per_s; });
+  append_family(kDiskWrites, disks, format, out, [&](size_t i) { return d[i].writes_per_s; });
+  append_family(kDiskReadBytes, disks, format, out, [&](size_t i) { return d[i].read_Bytes_per_s; });
+  append_family(kDiskWrittenBytes, disks, format, out, [&](size_t i) { return d[i].written_Bytes_per_s; });
+  append_family(kDiskReadAwait, disks, format, out, [&](size_t i) { return d[i].read_await_ms / 1000.0; });
+  append_family(kDiskWriteAwait, disks, format, out, [&](size_t i) { return d[i].write_await_ms / 1000.0; });
+  append_family(kDiskQueueDepth, disks, format, out, [&](size_t i) { return d[i].queue_depth; });
+  append_family(kDiskBusy, disks, format, out, [&](size_t i) { return d[i].utilisation; });
+  append_family(kDiskInFlight, disks, format, out, [&](size_t i) { return static_cast<double>(d[i].in_flight); });
+
+  const auto& n = scrape.networks;
+  append_family(kNetworkReceiveBytes, networks, format, out, [&](size_t i) { return n[i].rx_Bytes_per_s; });
+  append_family(kNetworkTransmitBytes, networks, format, out, [&](size_t i) { return n[i].tx_Bytes_per_s; });
+  append_family(kNetworkReceivePackets, networks, format, out, [&](size_t i) { return n[i].rx_packets_per_s; });
+  append_family(kNetworkTransmitPackets, networks, format, out, [&](size_t i) { return n[i].tx_packets_per_s; });
+  append_family(kNetworkReceiveErrors, networks, format, out, [&](size_t i) { return n[i].rx_errors_per_s; });
+  append_family(kNetworkTransmitErrors, networks, format, out, [&](size_t i) { return n[i].tx_errors_per_s; });
+  append_family(kNetworkReceiveDrops, networks, format, out, [&](size_t i) { return n[i].rx_drops_per_s; });
+  append_family(kNetworkTransmitDrops, networks, format, out, [&](size_t i) { return n[i].tx_drops_per_s; });
+
+  const auto& g = scrape.gpus;
+  append_family(kGPUBusy, gpus, format, out, [&](size_t i) { return g[i].utilisation; });
+  append_family(kGPUMemoryUsed, gpus, format, out,
+                [&](size_t i) { return static_cast<double>(g[i].memory_used_Bytes); });
+  append_family(kGPUMemoryTotal, gpus, format, out,
+                [&](size_t i) { return static_cast<double>(g[i].memory_total_Bytes); });
+  append_family(kGPUCoreFrequency, gpus, format, out,
+                [&](size_t i) { return static_cast<double>(g[i].core_clock_MHz) * 1e6; });
+  append_family(kGPUMemoryFrequency, gpus, format, out,
+                [&](size_t i) { return static_cast<double>(g[i].memory_clock_MHz) * 1e6; });
+  append_family(kGPUPower, gpus, format, out, [&](size_t i) { return g[i].power_W; });
+  append_family(kGPUTemperature, gpus, format, out, [&](size_t i) { return g[i].temperature_C; });
+
+  append_family(kDroppedFrames, 1, format, out, [&](size_t) { return static_cast<double>(scrape.dropped_frames); });
+  if (format == Format::OpenMetrics) {
+    out += "# EOF\n";
+  }
+}
+
+}  // namespace exporter
+}  // namespace hwinfo
@@ -0,0 +1,101 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/cpu_times.h>
+#include <hwinfo/disk_stats.h>
+#include <hwinfo/gpu_stats.h>
+#include <hwinfo/network_stats.h>
+#include <hwinfo/sampler.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+namespace exporter {
+
+// Identity of the sampled devices: the label values of the series, read once at startup.
+struct StaticLabels {
+  struct Disk {
+    std::string device;
+    std::string model;
+    std::string serial;
+  };
+  struct Network {
+    std::string interface;
+    std::string mac;
+  };
+  struct GPU {
+    std::string pci_bus_id;
+    std::string name;
+  };
+
+  std::string cpu_vendor;
+  std::string cpu_model;
+  // per-thread series are exported for the OS cpu ids [0, num_threads)
+  int num_threads{0};
+  // in the order of the per-device values of the sampler
+  std::vector<Disk> disks;
+  std::vector<Network> networks;
+  std::vector<GPU> gpus;
+
+  // Labels of the cpus and of the devices the sampler samples.
+  static StaticLabels collect(const Sampler& sampler);
+};
+
+// Values of one scrape. Kept between scrapes, so that sampling into it does not allocate.
+struct Scrape {
+  MetricFrame frame{};
+  // false until the sampler produced its first frame
+  bool has_frame{false};
+  std::vector<double> thread_utilisation;
+  std::vector<int64_t> thread_speed_MHz;
+  std::vector<DiskIOStats> disks;
+  std::vector<NetworkIOStats> networks;
+  std::vector<GPUStats> gpus;
+  // readCpuTimes() at the time of the scrape
+  std::vector<CpuTimes> cpu_times;
+  uint64_t dropped_frames{0};
+};
+
+enum class Format {
+  // text format 0.0.4
+  Prometheus,
+  // application/openmetrics-text 1.0.0
+  OpenMetrics,
+};
+
+/**
+ * Encoder of the exposition of a Scrape. The HELP and TYPE lines and the "name{labels} " prefix of every series are
+ * built (and their label values escaped) once by the constructor; encode() only appends the prefixes and the values
+ * formatted with std::to_chars, so once the output buffer reached the size of an exposition it does not allocate.
+ * Series whose value is unavailable (-1) are left out.
+ */
+class MetricsEncoder {
+ public:
+  explicit MetricsEncoder(const StaticLabels& labels);
+
+  // Replaces out by the exposition of scrape.
+  void encode(const Scrape& scrape, Format format, std::string& out) const;
+
+ private:
+  // Header lines and the series prefixes of one family: series i is prefixes[ends[i - 1], ends[i]).
+  struct Family {
+    std::string prometheus_header;
+    std::string openmetrics_header;
+    std::string prefixes;
+    std::vector<size_t> ends;
+  };
+
+  template <typename Value>
+  void append_family(size_t family, size_t count, Format format, std::string& out, const Value& value) const;
+
+  std::vector<Family> _families;
+  double _tick_seconds{0.0};
+};
+
+}  // namespace exporter
+}  // namespace hwinfo
@@ -0,0 +1,176 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+// hwinfo_hwbench: runs the hardware micro-benchmarks of hwinfo/bench.h and prints the results. With --output, the
+// results are written together with the inventory of the host (hwinfo/inventory.h), so that hosts can be compared.
+//
+//   hwinfo_hwbench [--output FILE] [--repetitions N] [--array-size MIB] [--max-size MIB] [--round-trips N] [--smt]
+//                  [--pairs] [--no-bandwidth] [--no-latency] [--no-core-to-core]
+
+#include <hwinfo/bench.h>
+#include <hwinfo/hwinfo.h>
+#include <hwinfo/inventory.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr double kMiB = 1024.0 * 1024.0;
+constexpr const char* kDistanceNames[] = {"smt sibling", "cache domain", "node", "socket", "remote"};
+
+// _____________________________________________________________________________________________________________________
+void usage(const char* program) {
+  std::fprintf(stderr,
+               "usage: %s [--output FILE] [--repetitions N] [--array-size MIB] [--max-size MIB] [--round-trips N]\n"
+               "       [--smt] [--pairs] [--no-bandwidth] [--no-latency] [--no-core-to-core]\n",
+               program);
+  std::fprintf(stderr, "  --output       write the inventory of the host and the results to FILE\n");
+  std::fprintf(stderr, "  --repetitions  runs per test, the best is reported (default 3)\n");
+  std::fprintf(stderr, "  --array-size   MiB per array of the bandwidth test (default 4x the last level caches)\n");
+  std::fprintf(stderr, "  --max-size     largest working set of the latency sweep in MiB (default 4x the LLC)\n");
+  std::fprintf(stderr, "  --round-trips  round trips per pair of the core-to-core test (default 10000)\n");
+  std::fprintf(stderr, "  --smt          core-to-core latency between all cpus, not only one cpu per core\n");
+  std::fprintf(stderr, "  --pairs        print the latency of every pair of cpus\n");
+}
+
+// _____________________________________________________________________________________________________________________
+void print_bandwidth(const std::vector<hwinfo::bench::BandwidthResult>& results) {
+  std::printf("\nmemory bandwidth (GB/s)\n");
+  std::printf("%6s %8s %7s %10s %9s %9s %9s %9s\n", "node", "threads", "pinned", "array MiB", "copy", "scale", "add",
+              "triad");
+  for (const auto& result : results) {
+    std::printf("%6d %8d %7s %10.0f %9.2f %9.2f %9.2f %9.2f\n", result.node, result.threads,
+                result.pinned ? "yes" : "no", static_cast<double>(result.array_Bytes) / kMiB,
+                result.copy_Bytes_per_s / 1e9, result.scale_Bytes_per_s / 1e9, result.add_Bytes_per_s / 1e9,
+                result.triad_Bytes_per_s / 1e9);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void print_latency(const std::vector<hwinfo::bench::LatencyResult>& results) {
+  std::printf("\nload latency (pointer chasing)\n");
+  std::printf("%8s %7s %12s %6s %9s\n", "threads", "pinned", "size KiB", "cache", "ns/load");
+  for (const auto& result : results) {
+    char level[4] = "mem";
+    if (result.cache_level > 0) {
+      std::snprintf(level, sizeof(level), "L%d", result.cache_level);
+    }
+    std::printf("%8d %7s %12.1f %6s %9.2f\n", result.threads, result.pinned ? "yes" : "no",
+                static_cast<double>(result.size_Bytes) / 1024.0, level, result.latency_ns);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void print_core_to_core(const std::vector<hwinfo::bench::CoreToCoreResult>& results, bool pairs) {
+  std::printf("\ncore-to-core latency (ns, one way)\n");
+  if (pairs) {
+    std::printf("%6s %6s %13s %7s %9s\n", "cpu", "cpu", "distance", "pinned", "ns");
+    for (const auto& result : results) {
+      std::printf("%6d %6d %13s %7s %9.1f\n", result.cpu_a, result.cpu_b,
+                  kDistanceNames[static_cast<int>(result.distance)], result.pinned ? "yes" : "no", result.latency_ns);
+    }
+    return;
+  }
+  std::printf("%13s %7s %9s %9s %9s\n", "distance", "pairs", "min", "mean", "max");
+  for (int distance = 0; distance < 5; ++distance) {
+    size_t count = 0;
+    double min = 0;
+    double max = 0;
+    double sum = 0;
+    for (const auto& result : results) {
+      if (static_cast<int>(result.distance) != distance) {
+        continue;
+      }
+      min = count == 0 ? result.latency_ns : std::min(min, result.latency_ns);
+      max = count == 0 ? result.latency_ns : std::max(max, result.latency_ns);
+      sum += result.latency_ns;
+      ++count;
+    }
+    if (count > 0) {
+      const double mean = sum / static_cast<double>(count);
+      std::printf("%13s %7zu %9.1f %9.1f %9.1f\n", kDistanceNames[distance], count, min, mean, max);
+    }
+  }
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+int main(int argc, char** argv) {
+  using namespace hwinfo;
+  bench::Options options;
+  std::string output;
+  bool pairs = false;
+  for (int i = 1; i < argc; ++i) {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+      output = argv[++i];
+    } else if (std::strcmp(argv[i], "--repetitions") == 0 && has_value) {
+      options.repetitions = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+    } else if (std::strcmp(argv[i], "--array-size") == 0 && has_value) {
+      options.bandwidth_array_Bytes = static_cast<int64_t>(std::strtod(argv[++i], nullptr) * kMiB);
+    } else if (std::strcmp(argv[i], "--max-size") == 0 && has_value) {
+      options.latency_max_Bytes = static_cast<int64_t>(std::strtod(argv[++i], nullptr) * kMiB);
+    } else if (std::strcmp(argv[i], "--round-trips") == 0 && has_value) {
+      options.round_trips = std::strtoll(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--smt") == 0) {
+      options.smt = true;
+    } else if (std::strcmp(argv[i], "--pairs") == 0) {
+      pairs = true;
+    } else if (std::strcmp(argv[i], "--no-bandwidth") == 0) {
+      options.bandwidth = false;
+    } else if (std::strcmp(argv[i], "--no-latency") == 0) {
+      options.latency = false;
+    } else if (std::strcmp(argv[i], "--no-core-to-core") == 0) {
+      options.core_to_core = false;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (options.repetitions <= 0 || options.round_trips <= 0 || options.bandwidth_array_Bytes < 0 ||
+      options.latency_max_Bytes < 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  // the tests one by one instead of bench::run(), to report the progress
+  bench::Report report;
+  if (options.bandwidth) {
+    std::fprintf(stderr, "hwinfo_hwbench: memory bandwidth\n");
+    report.bandwidth = bench::measureBandwidth(options);
+    print_bandwidth(report.bandwidth);
+  }
+  if (options.latency) {
+    std::fprintf(stderr, "hwinfo_hwbench: load latency\n");
+    report.latency = bench::measureLatency(options);
+    print_latency(report.latency);
+  }
+  if (options.core_to_core) {
+    std::fprintf(stderr, "hwinfo_hwbench: core-to-core latency\n");
+    report.core_to_core = bench::measureCoreToCore(options);
+    print_core_to_core(report.core_to_core, pairs);
+  }
+
+  if (!output.empty()) {
+    std::vector<inventory::Record> records = inventory::records(collectAll());
+    for (inventory::Record& record : bench::records(report)) {
+      records.push_back(std::move(record));
+    }
+    const std::string data = inventory::serialize(records);
+    std::ofstream file(output, std::ios::binary);
+    if (!file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+      std::fprintf(stderr, "hwinfo_hwbench: cannot write %s\n", output.c_str());
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,120 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace hwinfo {
+
+// Error of an asynchronous collection that did not finish within its timeout.
+class TimeoutError : public std::runtime_error {
+ public:
+  TimeoutError() : std::runtime_error("hwinfo: collection timed out") {}
+};
+
+/**
+ * Fixed number of worker threads that run blocking collectors (the sampling sleep of the first utilisation read, WMI
+ * queries, IOKit registry walks) off the threads of an event loop, plus one timer thread for the timeouts.
+ *
+ * A collector that hangs (e.g. a WMI provider that never answers) keeps its worker busy, but the timeout still
+ * completes the call, so callers are never blocked. Queued tasks that did not start when the pool is destroyed are
+ * dropped (their futures report std::future_error broken_promise); the destructor waits for running ones.
+ */
+class HWINFO_API WorkerPool {
+ public:
+  explicit WorkerPool(size_t num_threads);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Pool of the async functions: up to 4 threads, started on first use and never destroyed (so that a hung collector
+  // cannot block the exit of the process).
+  static WorkerPool& shared();
+
+  HWI_NODISCARD size_t num_threads() const;
+  void submit(std::function<void()> task);
+  // Runs task on the timer thread once delay elapsed. Timer tasks must not block.
+  void after(std::chrono::milliseconds delay, std::function<void()> task);
+
+ private:
+  struct State;
+  std::unique_ptr<State> _state;
+};
+
+/**
+ * Runs collect on pool and calls done exactly once, with the result or with the exception collect threw, or with a
+ * TimeoutError once timeout (if not zero) elapsed. done runs on the worker or on the timer thread and must not block;
+ * a result that arrives after the timeout is discarded.
+ *
+ *   hwinfo::dispatchAsync([] { return hwinfo::getAllDisks(); },
+ *                         [](std::optional<std::vector<hwinfo::Disk>> disks, std::exception_ptr error) { ... },
+ *                         std::chrono::seconds(2));
+ */
+template <typename Collect, typename Done>
+void dispatchAsync(Collect collect, Done done, std::chrono::milliseconds timeout = std::chrono::milliseconds::zero(),
+                   WorkerPool& pool = WorkerPool::shared()) {
+  using Result = decltype(collect());
+  struct Call {
+    std::atomic<bool> finished{false};
+    Done done;
+    explicit Call(Done callback) : done(std::move(callback)) {}
+  };
+  auto call = std::make_shared<Call>(std::move(done));
+  pool.submit([call, collect = std::move(collect)]() mutable {
+    std::optional<Result> result;
+    std::exception_ptr error;
+    try {
+      result.emplace(collect());
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (!call->finished.exchange(true)) {
+      call->done(std::move(result), std::move(error));
+    }
+  });
+  if (timeout.count() > 0) {
+    pool.after(timeout, [call] {
+      if (!call->finished.exchange(true)) {
+        call->done(std::optional<Result>(), std::make_exception_ptr(TimeoutError()));
+      }
+    });
+  }
+}
+
+/**
+ * Future variant of dispatchAsync(): get() returns the result or rethrows the exception of collect or the TimeoutError.
+ *
+ *   auto cpus = hwinfo::runAsync([] { return hwinfo::getAllCPUs(); }, std::chrono::seconds(2));
+ */
+template <typename Collect>
+auto runAsync(Collect collect, std::chrono::milliseconds timeout = std::chrono::milliseconds::zero(),
+              WorkerPool& pool = WorkerPool::shared()) -> std::future<decltype(collect())> {
+  using Result = decltype(collect());
+  auto promise = std::make_shared<std::promise<Result>>();
+  std::future<Result> future = promise->get_future();
+  dispatchAsync(
+      std::move(collect),
+      [promise](std::optional<Result> result, std::exception_ptr error) {
+        if (error) {
+          promise->set_exception(std::move(error));
+        } else {
+          promise->set_value(std::move(*result));
+        }
+      },
+      timeout, pool);
+  return future;
+}
+
+}  // namespace hwinfo
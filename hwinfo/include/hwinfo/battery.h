@@ -3,14 +3,32 @@
 
 #pragma once
 
+#include <hwinfo/interned_string.h>
 #include <hwinfo/platform.h>
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace hwinfo {
 
+namespace filesystem {
+class CachedFile;
+}  // namespace filesystem
+
+// Dynamic values of a battery, read together with Battery::status(). -1 where the platform does not report a value.
+// Units as reported by the platform (Linux: µWh, µW and µV).
+struct BatteryStatus {
+  int64_t energyNow{-1};
+  int64_t powerNow{-1};
+  int64_t voltageNow{-1};
+  // charge in percent of energyFull
+  int capacity{-1};
+  int64_t cycleCount{-1};
+  bool charging{false};
+};
+
 class HWINFO_API Battery {
   friend std::vector<Battery> getAllBatteries();
 
@@ -18,31 +36,35 @@ class HWINFO_API Battery {
   explicit Battery(int8_t id = 0);
   ~Battery() = default;
 
-  std::string& vendor();
-  std::string& model();
-  std::string& serialNumber();
-  std::string& technology();
+  InternedString vendor();
+  InternedString model();
+  InternedString serialNumber();
+  InternedString technology();
   uint32_t energyFull();
 
   double capacity();
 
-  [[nodiscard]] std::string getVendor() const;
-  [[nodiscard]] std::string getModel() const;
-  [[nodiscard]] std::string getSerialNumber() const;
-  [[nodiscard]] std::string getTechnology() const;
+  [[nodiscard]] InternedString getVendor() const;
+  [[nodiscard]] InternedString getModel() const;
+  [[nodiscard]] InternedString getSerialNumber() const;
+  [[nodiscard]] InternedString getTechnology() const;
   [[nodiscard]] uint32_t getEnergyFull() const;
 
   [[nodiscard]] uint32_t energyNow() const;
   [[nodiscard]] bool charging() const;
   [[nodiscard]] bool discharging() const;
+  // All dynamic values with one read (Linux: of the uevent file). energyNow() and charging() are single values of it.
+  [[nodiscard]] BatteryStatus status() const;
 
  private:
   int _id = -1;
-  std::string _vendor;
-  std::string _model;
-  std::string _serialNumber;
-  std::string _technology;
+  InternedString _vendor;
+  InternedString _model;
+  InternedString _serialNumber;
+  InternedString _technology;
   uint32_t _energyFull = 0;
+  // Linux: the uevent file of the power supply, opened by getAllBatteries() and shared by copies
+  std::shared_ptr<const filesystem::CachedFile> _uevent;
 };
 
 std::vector<Battery> getAllBatteries();
@@ -0,0 +1,124 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/inventory.h>
+#include <hwinfo/platform.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Hardware micro-benchmarks: what the memory, caches and cores described by CPU and Topology actually deliver.
+ * Opt-in, compiled into the library with -DHWINFO_BUILD_HWBENCH=ON, which also builds the hwinfo_hwbench CLI.
+ *
+ * Every test runs on threads of its own, each pinned to one cpu (Linux, Windows; macOS has no affinity API, there the
+ * threads are left to the scheduler and the results are marked as not pinned), once on a single thread and once on one
+ * thread per core. The tests load the memory system and the cores, so run them on an otherwise idle host. Every result
+ * is the best of Options::repetitions runs.
+ *
+ * records() turns the results into inventory records, so that they are serialized (and delta encoded) together with
+ * the inventory::records() of the same host.
+ */
+namespace bench {
+
+struct Options {
+  // Bytes of each of the three arrays of the bandwidth test of a node. 0 picks 4x the last level caches of the node
+  // (STREAM's rule), at least 64 MiB.
+  int64_t bandwidth_array_Bytes{0};
+  // Smallest and largest working set of the latency sweep. 0 picks a quarter of the L1 data cache and 4x the last level
+  // cache (at least 64 MiB).
+  int64_t latency_min_Bytes{0};
+  int64_t latency_max_Bytes{0};
+  // Working sets per doubling of the latency sweep.
+  int latency_steps_per_octave{2};
+  // Timed dependent loads per working set and run.
+  int64_t latency_loads{int64_t{1} << 22};
+  // Timed round trips per pair of cpus and run.
+  int64_t round_trips{10000};
+  // Measure the core-to-core latency between all online cpus instead of one cpu per core, so also between SMT siblings.
+  bool smt{false};
+  int repetitions{3};
+  bool bandwidth{true};
+  bool latency{true};
+  bool core_to_core{true};
+};
+
+// STREAM kernels on the memory of one NUMA node, run by threads on the cores of the node.
+struct BandwidthResult {
+  int32_t node{-1};
+  int32_t threads{0};
+  bool pinned{false};
+  // Size of each of the three arrays, split evenly between the threads; every thread writes its part first, so that
+  // the pages are allocated on the node.
+  int64_t array_Bytes{0};
+  // Bytes read and written by the kernels per second (write allocations are not counted, as in STREAM):
+  // copy c = a, scale b = s * c, add c = a + b, triad a = b + s * c.
+  double copy_Bytes_per_s{0};
+  double scale_Bytes_per_s{0};
+  double add_Bytes_per_s{0};
+  double triad_Bytes_per_s{0};
+};
+
+// Pointer chasing through a working set in random order, so that every load depends on the previous one and the
+// prefetchers cannot help. Large working sets include the TLB misses.
+struct LatencyResult {
+  // cpu of the (first) thread
+  int32_t cpu{-1};
+  // 1, or one per core: every thread chases through its own working set
+  int32_t threads{0};
+  bool pinned{false};
+  // working set of every thread
+  int64_t size_Bytes{0};
+  // smallest cache level (1 - 3) of the detected hierarchy that holds the working set, 0 if none does
+  int32_t cache_level{0};
+  // per load, average of the threads
+  double latency_ns{0};
+};
+
+// Relation of the two cpus of a CoreToCoreResult in the topology index, closest first.
+enum class Distance : int32_t {
+  SmtSibling = 0,
+  CacheDomain = 1,
+  Node = 2,
+  Socket = 3,
+  Remote = 4,
+};
+
+// A cache line bounced between two threads: each waits for the value written by the other and answers it.
+struct CoreToCoreResult {
+  int32_t cpu_a{-1};
+  int32_t cpu_b{-1};
+  Distance distance{Distance::Remote};
+  bool pinned{false};
+  // one way, half a round trip
+  double latency_ns{0};
+};
+
+struct Report {
+  std::vector<BandwidthResult> bandwidth;
+  std::vector<LatencyResult> latency;
+  std::vector<CoreToCoreResult> core_to_core;
+};
+
+// Pins the calling thread to an OS cpu id (as in Topology). False if the platform cannot, or the cpu is not allowed.
+HWINFO_API bool pinCurrentThread(int cpu);
+
+// Per NUMA node a result on a single thread and one on one thread per core of the node.
+HWINFO_API std::vector<BandwidthResult> measureBandwidth(const Options& options = {});
+// The sweep on one thread and on one thread per core.
+HWINFO_API std::vector<LatencyResult> measureLatency(const Options& options = {});
+// Every pair of cpus (one per core unless Options::smt), in ascending order.
+HWINFO_API std::vector<CoreToCoreResult> measureCoreToCore(const Options& options = {});
+// The tests enabled in options, in the order above.
+HWINFO_API Report run(const Options& options = {});
+
+// Records of the results (RecordType::Bandwidth, Latency, CoreToCore), to be appended to the inventory::records() of
+// the same host before serializing them.
+HWINFO_API std::vector<inventory::Record> records(const Report& report);
+
+}  // namespace bench
+}  // namespace hwinfo
@@ -0,0 +1,108 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Cpu and memory limits of the cgroup of the calling process, i.e. what a container may actually use. Linux only, on
+ * other platforms available() is false.
+ *
+ * read() resolves /proc/self/cgroup against the cgroup mounts of /proc/self/mountinfo once (cgroup v2, or the v1
+ * cpu, cpuacct, cpuset and memory hierarchies, also mixed) and opens the control files of the cgroup and of its
+ * ancestors; the getters re-read them with one pread() each and are thread-safe. Limits are hierarchical: the
+ * smallest limit of the cgroup and its visible ancestors applies.
+ *
+ * With set_apply_limits(true), CPU and Memory report container values instead of host values, see there.
+ */
+class HWINFO_API Cgroup {
+ public:
+  Cgroup();
+  ~Cgroup();
+  Cgroup(Cgroup&& other) noexcept;
+  Cgroup& operator=(Cgroup&& other) noexcept;
+
+  // Process wide resolver, read on first use. A process that is moved to another cgroup needs read().
+  static const Cgroup& get();
+  static Cgroup read();
+
+  /**
+   * Process wide opt-in: CPU::numLogicalCores() is limited to the cpus of the cpuset (and to the cpu quota rounded
+   * up), CPU::threadUtilisation()/threadsUtilisation() report -1 for threads outside the cpuset, Memory::total_Bytes()
+   * and the totals of Memory::snapshot() are limited to memory.max and the free/available values to memory.max minus
+   * memory.current. Off by default.
+   */
+  static void set_apply_limits(bool enabled);
+  static bool apply_limits();
+
+  // 2 (unified hierarchy), 1 if any controller is bound to a v1 hierarchy, 0 if no cgroup controller was found.
+  HWI_NODISCARD int version() const { return _version; }
+  HWI_NODISCARD bool available() const { return _version != 0; }
+  // Directories of the cgroup in the hierarchy of the controller, empty if the controller is not mounted.
+  HWI_NODISCARD const std::string& cpu_path() const { return _cpu_path; }
+  HWI_NODISCARD const std::string& cpuset_path() const { return _cpuset_path; }
+  HWI_NODISCARD const std::string& memory_path() const { return _memory_path; }
+
+  // Cpu bandwidth limit in cpus (cpu.max or cpu.cfs_quota_us / cpu.cfs_period_us), -1 if unlimited or unknown.
+  HWI_NODISCARD double cpu_quota() const;
+  // OS cpu ids the cgroup may run on in ascending order (cpuset.cpus.effective), empty if unknown.
+  HWI_NODISCARD std::vector<int> effective_cpus() const;
+  // Number of cpus the cgroup can keep busy: the smaller of the number of effective_cpus() and cpu_quota(), -1 if
+  // neither is known.
+  HWI_NODISCARD double effective_cpu_count() const;
+  // memory.max (memory.limit_in_bytes), -1 if unlimited or unknown.
+  HWI_NODISCARD int64_t memory_max_Bytes() const;
+  // memory.current (memory.usage_in_bytes), -1 if unknown.
+  HWI_NODISCARD int64_t memory_current_Bytes() const;
+  // Cumulative cpu time of all tasks of the cgroup (usage_usec of cpu.stat, cpuacct.usage), -1 if unknown.
+  HWI_NODISCARD int64_t cpu_usage_ns() const;
+
+ private:
+  // Platform specific state, e.g. the opened control files.
+  struct Source;
+
+  int _version{0};
+  std::string _cpu_path;
+  std::string _cpuset_path;
+  std::string _memory_path;
+  std::unique_ptr<Source> _source;
+};
+
+/**
+ * Cpu time used by the cgroup of the calling process over the period between two samples.
+ */
+struct CgroupUsageSample {
+  // Number of cpus the tasks of the cgroup kept busy on average, -1 if unknown.
+  double cpus{-1.0};
+  // cpus relative to Cgroup::effective_cpu_count(), in [0, 1]. -1 if either is unknown.
+  double utilisation{-1.0};
+  std::chrono::steady_clock::duration period{0};
+};
+
+/**
+ * Delta sampler of Cgroup::cpu_usage_ns() of Cgroup::get(), the counterpart of UtilisationSampler for containers: the
+ * constructor records a baseline, each sample() reports the usage since the previous one.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API CgroupUsageSampler {
+ public:
+  CgroupUsageSampler();
+
+  CgroupUsageSample sample();
+
+ private:
+  int64_t _usage_ns{-1};
+  std::chrono::steady_clock::time_point _timestamp{};
+};
+
+}  // namespace hwinfo
@@ -0,0 +1,34 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <cstdint>
+
+namespace hwinfo {
+
+// Components of the system information (collectAll(), DeviceMonitor). Combine with |.
+enum class Component : uint32_t {
+  None = 0,
+  CPU = 1 << 0,
+  OS = 1 << 1,
+  GPU = 1 << 2,
+  Memory = 1 << 3,
+  MainBoard = 1 << 4,
+  Disk = 1 << 5,
+  Battery = 1 << 6,
+  Network = 1 << 7,
+  All = 0xff,
+};
+
+constexpr Component operator|(Component a, Component b) {
+  return static_cast<Component>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+constexpr Component operator&(Component a, Component b) {
+  return static_cast<Component>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+}
+constexpr bool contains(Component set, Component component) {
+  return (static_cast<uint32_t>(set) & static_cast<uint32_t>(component)) == static_cast<uint32_t>(component);
+}
+
+}  // namespace hwinfo
@@ -3,16 +3,23 @@
 
 #pragma once
 
+#include <hwinfo/cpu_features.h>
+#include <hwinfo/fields.h>
+#include <hwinfo/interned_string.h>
 #include <hwinfo/platform.h>
+#include <hwinfo/static_cache.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace hwinfo {
 
-#ifdef HWINFO_UNIX
+// Cumulative cpu time counters of one cpu (or of the whole system). Units are platform specific.
 struct Jiffies {
   Jiffies() {
     working = -1;
@@ -27,17 +34,56 @@ struct Jiffies {
   int64_t working;
   int64_t all;
 };
-#endif
+
+/**
+ * Utilisation ([0, 1]) of the whole system, of every socket, of every core cluster and of every logical thread (indexed
+ * by the OS cpu id) over the period between two samples. Values that could not be determined are -1.
+ */
+struct UtilisationSample {
+  double total{-1.0};
+  std::vector<double> threads{};
+  // indexed by the socket index of Topology::get()
+  std::vector<double> sockets{};
+  // indexed by the efficiency class of Topology::get(): E-cores (0) and P-cores (1) of hybrid systems (Apple silicon
+  // hw.perflevel1/0, Intel Atom/Core), a single entry otherwise
+  std::vector<double> clusters{};
+  std::chrono::steady_clock::duration period{0};
+};
+
+/**
+ * Explicit utilisation sampler. The constructor records a baseline, each sample() reports the utilisation since the
+ * previous sample (or since construction) and becomes the baseline for the next one. The sampler never sleeps unless
+ * sample_over() is used, so callers can overlap the wait with other work.
+ *
+ * A sampler must not be used by multiple threads concurrently. Give every poller its own sampler instead.
+ */
+class HWINFO_API UtilisationSampler {
+ public:
+  UtilisationSampler();
+  ~UtilisationSampler() = default;
+
+  UtilisationSample sample();
+  // Takes a fresh baseline, blocks for duration and returns the utilisation over exactly that period.
+  UtilisationSample sample_over(std::chrono::nanoseconds duration);
+
+ private:
+  Jiffies _total{};
+  std::vector<Jiffies> _threads{};
+  // buffer of the next sample, swapped with _threads so that sampling does not allocate once sizes are stable
+  std::vector<Jiffies> _next_threads{};
+  std::chrono::steady_clock::time_point _timestamp{};
+};
 
 class HWINFO_API CPU {
-  friend std::vector<CPU> getAllCPUs();
+  friend std::vector<CPU> getAllCPUs(CPUFields fields);
+  friend struct static_cache::Access;
 
  public:
   ~CPU() = default;
 
   int id() const;
-  const std::string& modelName() const;
-  const std::string& vendor() const;
+  InternedString modelName() const;
+  InternedString vendor() const;
   int64_t L1CacheSize_Bytes() const;
   int64_t L2CacheSize_Bytes() const;
   int64_t L3CacheSize_Bytes() const;
@@ -47,21 +93,35 @@ class HWINFO_API CPU {
   int64_t regularClockSpeed_MHz() const;
   int64_t currentClockSpeed_MHz(int thread_id) const;
   std::vector<int64_t> currentClockSpeed_MHz() const;
+  // Writes at most capacity values into out and returns the number of threads (may exceed capacity, -1 on error).
+  // Callers that keep their buffer between calls sample without allocating.
+  int currentClockSpeed_MHz(int64_t* out, int capacity) const;
+  // Utilisation since the previous call of the same method on this object (since boot on the first one).
+  // threadUtilisation() keeps a previous sample per thread index, so that querying the threads one after another
+  // measures each against its own previous query; threadsUtilisation() shares one sample for all threads. Thread-safe.
+  // Pollers that sample at different intervals should each use their own UtilisationSampler. On Windows the values
+  // stem from the process wide "Processor Information" PDH query and cover the period since its previous collection.
   double currentUtilisation() const;
   double threadUtilisation(int thread_index) const;
   std::vector<double> threadsUtilisation() const;
+  // Fill variant of threadsUtilisation(), see currentClockSpeed_MHz(int64_t*, int). With capacity 0 it only returns
+  // the number of threads and takes no sample, so that sizing the buffer does not consume the measured period.
+  int threadsUtilisation(double* out, int capacity) const;
+  // Utilisation of the threads of this socket since the previous call on this object, see Topology.
+  double socketUtilisation() const;
+  // OS cpu ids of the threads of this socket.
+  std::vector<int> threadIds() const;
   // double currentTemperature_Celsius() const;
   const std::vector<std::string>& flags() const;
+  // Decoded feature set: CPUID on x86 (only features the OS enabled), the flags on other architectures.
+  const FeatureSet& features() const;
 
  private:
-#ifndef HWINFO_WINDOWS
-  void init_jiffies() const;
-#endif
   CPU() = default;
 
   int _id{-1};
-  std::string _modelName;
-  std::string _vendor;
+  InternedString _modelName;
+  InternedString _vendor;
   int _numPhysicalCores{-1};
   int _numLogicalCores{-1};
   int64_t _maxClockSpeed_MHz{-1};
@@ -70,10 +130,33 @@ class HWINFO_API CPU {
   int64_t _L2CacheSize_Bytes{-1};
   int64_t _L3CacheSize_Bytes{-1};
   std::vector<std::string> _flags{};
+  FeatureSet _features{};
 
-  mutable bool _jiffies_initialized = false;
+#ifndef HWINFO_WINDOWS
+  struct JiffiesSample {
+    Jiffies total{};
+    std::vector<Jiffies> threads{};
+  };
+  // previous samples of this object, replaced with std::atomic_exchange by the utilisation methods
+  mutable std::shared_ptr<const JiffiesSample> _last_total_sample{};
+  mutable std::shared_ptr<const JiffiesSample> _last_threads_sample{};
+  // previous Jiffies of every thread index of threadUtilisation(), created on first use (and shared by copies)
+  struct ThreadJiffies {
+    std::mutex mutex;
+    std::vector<Jiffies> last;
+  };
+  mutable std::shared_ptr<ThreadJiffies> _last_thread_jiffies{};
+  mutable std::shared_ptr<const JiffiesSample> _last_socket_sample{};
+
+  // Reads a new sample and publishes it in last. The replaced sample is returned through previous. Returns nullptr if
+  // no sample could be read.
+  static std::shared_ptr<const JiffiesSample> take_sample(std::shared_ptr<const JiffiesSample>& last,
+                                                          std::shared_ptr<const JiffiesSample>& previous);
+#endif
 };
 
 std::vector<CPU> getAllCPUs();
+// Reads only the requested attributes, see hwinfo/fields.h.
+std::vector<CPU> getAllCPUs(CPUFields fields);
 
 }  // namespace hwinfo
@@ -0,0 +1,188 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Canonical cpu features. The values are bit positions in FeatureSet and part of the C ABI (C_CPU::features): new
+ * features are only ever appended. The names (feature_name()) are those of the /proc/cpuinfo flags.
+ */
+enum class Feature : uint16_t {
+  // x86: leaf 1
+  MMX,
+  SSE,
+  SSE2,
+  SSE3,
+  SSSE3,
+  SSE4_1,
+  SSE4_2,
+  POPCNT,
+  AES,
+  PCLMULQDQ,
+  CX16,
+  MOVBE,
+  XSAVE,
+  OSXSAVE,
+  AVX,
+  F16C,
+  FMA,
+  RDRAND,
+  HT,
+  // x86: leaf 7
+  BMI1,
+  BMI2,
+  AVX2,
+  ERMS,
+  FSRM,
+  ADX,
+  RDSEED,
+  SHA,
+  CLFLUSHOPT,
+  CLWB,
+  GFNI,
+  VAES,
+  VPCLMULQDQ,
+  AVX512F,
+  AVX512DQ,
+  AVX512CD,
+  AVX512BW,
+  AVX512VL,
+  AVX512IFMA,
+  AVX512VBMI,
+  AVX512_VBMI2,
+  AVX512_VNNI,
+  AVX512_BITALG,
+  AVX512_VPOPCNTDQ,
+  AVX512_BF16,
+  AVX512_FP16,
+  AVX512_VP2INTERSECT,
+  AVX_VNNI,
+  AMX_TILE,
+  AMX_INT8,
+  AMX_BF16,
+  HYBRID,
+  SERIALIZE,
+  WAITPKG,
+  RDPID,
+  RTM,
+  // x86: extended leaves
+  LAHF_LM,
+  ABM,
+  SSE4A,
+  PREFETCHW,
+  FMA4,
+  XOP,
+  TBM,
+  TOPOEXT,
+  RDTSCP,
+  LM,
+  PDPE1GB,
+  NX,
+  // ARM (hwcaps)
+  FP,
+  ASIMD,
+  ASIMDHP,
+  ASIMDDP,
+  ASIMDFHM,
+  ARM_AES,
+  PMULL,
+  SHA1,
+  SHA2,
+  SHA3,
+  SHA512,
+  SM4,
+  CRC32,
+  ATOMICS,
+  SVE,
+  SVE2,
+  ARM_BF16,
+  I8MM,
+  // number of features, not a feature
+  Count
+};
+
+// Name of the feature as in /proc/cpuinfo ("avx512f"), "" for Feature::Count.
+HWINFO_API std::string_view feature_name(Feature feature);
+
+/**
+ * Feature with the given /proc/cpuinfo name (aliases such as "sse4.1" are accepted).
+ * @return false if the name is not a known feature.
+ */
+HWINFO_API bool feature_from_name(std::string_view name, Feature& feature);
+
+/**
+ * Fixed size feature bitmask: has() is a single shift and mask. The words are laid out like C_CPU::features, bit
+ * (f % 64) of word (f / 64) is feature f.
+ */
+class FeatureSet {
+ public:
+  static constexpr size_t num_words = 4;
+  static_assert(static_cast<size_t>(Feature::Count) <= num_words * 64, "FeatureSet is too small");
+
+  constexpr FeatureSet() = default;
+  explicit FeatureSet(const uint64_t* words) {
+    for (size_t i = 0; i < num_words; ++i) {
+      _words[i] = words[i];
+    }
+  }
+
+  HWI_NODISCARD constexpr bool has(Feature feature) const {
+    const auto bit = static_cast<size_t>(feature);
+    return bit < num_words * 64 && ((_words[bit / 64] >> (bit % 64)) & 1) != 0;
+  }
+  // True if every feature of required is set.
+  HWI_NODISCARD constexpr bool has_all(const FeatureSet& required) const {
+    for (size_t i = 0; i < num_words; ++i) {
+      if ((_words[i] & required._words[i]) != required._words[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  void set(Feature feature, bool value = true) {
+    const auto bit = static_cast<size_t>(feature);
+    if (bit >= num_words * 64) {
+      return;
+    }
+    const uint64_t mask = uint64_t{1} << (bit % 64);
+    _words[bit / 64] = value ? (_words[bit / 64] | mask) : (_words[bit / 64] & ~mask);
+  }
+  HWI_NODISCARD bool empty() const {
+    for (uint64_t word : _words) {
+      if (word != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+  HWI_NODISCARD const std::array<uint64_t, num_words>& words() const { return _words; }
+  // Names of all set features in enum order.
+  HWI_NODISCARD std::vector<std::string> names() const {
+    std::vector<std::string> result;
+    for (uint16_t i = 0; i < static_cast<uint16_t>(Feature::Count); ++i) {
+      if (has(static_cast<Feature>(i))) {
+        result.emplace_back(feature_name(static_cast<Feature>(i)));
+      }
+    }
+    return result;
+  }
+
+  friend bool operator==(const FeatureSet& a, const FeatureSet& b) { return a._words == b._words; }
+  friend bool operator!=(const FeatureSet& a, const FeatureSet& b) { return !(a == b); }
+
+ private:
+  std::array<uint64_t, num_words> _words{};
+};
+
+}  // namespace hwinfo
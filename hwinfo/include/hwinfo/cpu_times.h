@@ -0,0 +1,93 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Cumulative time of one logical cpu (or of the whole system) in every state, in the order of the columns of /proc/stat
+ * (USER_HZ ticks). guest and guest_nice are already contained in user and nice, the kernel accounts them twice.
+ *
+ * States a platform does not report are 0: Apple reports user, nice, system and idle (ticks); Windows reports user,
+ * system, idle, irq (interrupts) and softirq (DPCs) in 100 ns units. All values are -1 if the cpu is not listed.
+ */
+struct CpuTimes {
+  int64_t user{-1};
+  int64_t nice{-1};
+  int64_t system{-1};
+  int64_t idle{-1};
+  int64_t iowait{-1};
+  int64_t irq{-1};
+  int64_t softirq{-1};
+  int64_t steal{-1};
+  int64_t guest{-1};
+  int64_t guest_nice{-1};
+
+  HWI_NODISCARD bool valid() const { return user >= 0; }
+  // Every state once (without the guest time, which user and nice contain).
+  HWI_NODISCARD int64_t total() const { return user + nice + system + idle + iowait + irq + softirq + steal; }
+  // total() without idle and iowait: time the cpu ran something, including interrupts and time stolen by the
+  // hypervisor.
+  HWI_NODISCARD int64_t busy() const { return user + nice + system + irq + softirq + steal; }
+};
+static_assert(std::is_trivially_copyable<CpuTimes>::value, "CpuTimes is copied as a whole");
+
+/**
+ * Shares ([0, 1]) of the period between two CpuTimes samples of the same cpu, e.g. steal is the part of the period the
+ * hypervisor ran another guest on this cpu. Values that cannot be computed (invalid samples, no time passed) are -1.
+ */
+struct CpuTimeRates {
+  double busy{-1.0};
+  double user{-1.0};  // user and nice, including guest
+  double system{-1.0};
+  double iowait{-1.0};
+  double irq{-1.0};  // irq and softirq
+  double steal{-1.0};
+  double guest{-1.0};  // guest and guest_nice
+};
+
+/**
+ * Reads the counters of the whole system and of every logical thread (indexed by the OS cpu id, offline cpus are
+ * invalid). On Linux this is the same single read of /proc/stat the utilisation uses.
+ *
+ * @return false if the counters could not be read.
+ */
+HWINFO_API bool readCpuTimes(CpuTimes& total, std::vector<CpuTimes>& threads);
+
+// Rates of the period between two samples. If previous is invalid, the rates since boot are returned.
+HWINFO_API CpuTimeRates cpuTimeRates(const CpuTimes& previous, const CpuTimes& current);
+
+struct CpuTimesSample {
+  CpuTimeRates total{};
+  std::vector<CpuTimeRates> threads{};
+  std::chrono::steady_clock::duration period{0};
+};
+
+/**
+ * Explicit rate sampler, see UtilisationSampler: the constructor records a baseline, each sample() reports the rates
+ * since the previous sample and becomes the baseline for the next one. Must not be used by multiple threads
+ * concurrently.
+ */
+class HWINFO_API CpuTimesSampler {
+ public:
+  CpuTimesSampler();
+
+  CpuTimesSample sample();
+
+ private:
+  CpuTimes _total{};
+  std::vector<CpuTimes> _threads{};
+  // buffer of the next sample, swapped with _threads
+  std::vector<CpuTimes> _next_threads{};
+  std::chrono::steady_clock::time_point _timestamp{};
+};
+
+}  // namespace hwinfo
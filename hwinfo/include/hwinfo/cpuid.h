@@ -14,7 +14,10 @@
 #include <cpuid.h>
 #endif
 
+#include <hwinfo/cpu_features.h>
+
 #include <cstdint>
+#include <vector>
 
 #define MAX_INTEL_TOP_LVL 4
 
@@ -48,6 +51,258 @@ inline void cpuid(uint32_t func_id, uint32_t sub_func_id, uint32_t regs[4]) {
 #endif
 }
 
+// _____________________________________________________________________________________________________________________
+// Highest supported leaf of the range of leaf (0 for basic, 0x80000000 for extended leaves).
+inline uint32_t max_leaf(uint32_t range) {
+  uint32_t regs[4]{};
+  cpuid(range, 0, regs);
+  return regs[0];
+}
+
+// _____________________________________________________________________________________________________________________
+// XCR0: register state the OS saves on context switches. Features whose registers it does not save are unusable.
+inline uint64_t xgetbv0() {
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  uint32_t eax = 0;
+  uint32_t edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+/**
+ * Decodes the feature leaves 1, 7 (sub leaves 0 and 1) and 0x80000001. AVX, AVX-512 and AMX features are only reported
+ * if the OS enabled their register state (XCR0), so the result can be used to dispatch SIMD kernels directly.
+ */
+inline FeatureSet read_features() {
+  FeatureSet features;
+  const auto set = [&features](uint32_t reg, unsigned bit, Feature feature) {
+    if ((reg >> bit) & 1) {
+      features.set(feature);
+    }
+  };
+  const uint32_t max_basic = max_leaf(0);
+  uint32_t leaf1[4]{};
+  if (max_basic >= 1) {
+    cpuid(1, 0, leaf1);
+  }
+  const uint32_t ecx1 = leaf1[2];
+  const uint32_t edx1 = leaf1[3];
+  set(edx1, 23, Feature::MMX);
+  set(edx1, 25, Feature::SSE);
+  set(edx1, 26, Feature::SSE2);
+  set(edx1, 28, Feature::HT);
+  set(ecx1, 0, Feature::SSE3);
+  set(ecx1, 1, Feature::PCLMULQDQ);
+  set(ecx1, 9, Feature::SSSE3);
+  set(ecx1, 13, Feature::CX16);
+  set(ecx1, 19, Feature::SSE4_1);
+  set(ecx1, 20, Feature::SSE4_2);
+  set(ecx1, 22, Feature::MOVBE);
+  set(ecx1, 23, Feature::POPCNT);
+  set(ecx1, 25, Feature::AES);
+  set(ecx1, 26, Feature::XSAVE);
+  set(ecx1, 27, Feature::OSXSAVE);
+  set(ecx1, 30, Feature::RDRAND);
+
+  const uint64_t xcr0 = features.has(Feature::OSXSAVE) ? xgetbv0() : 0;
+  const bool avx_state = (xcr0 & 0x6) == 0x6;          // XMM | YMM
+  const bool avx512_state = (xcr0 & 0xe6) == 0xe6;     // XMM | YMM | opmask | ZMM
+  const bool amx_state = (xcr0 & 0x60000) == 0x60000;  // XTILECFG | XTILEDATA
+  if (avx_state) {
+    set(ecx1, 12, Feature::FMA);
+    set(ecx1, 28, Feature::AVX);
+    set(ecx1, 29, Feature::F16C);
+  }
+
+  if (max_basic >= 7) {
+    uint32_t leaf7[4]{};
+    cpuid(7, 0, leaf7);
+    const uint32_t ebx = leaf7[1];
+    const uint32_t ecx = leaf7[2];
+    const uint32_t edx = leaf7[3];
+    set(ebx, 3, Feature::BMI1);
+    set(ebx, 8, Feature::BMI2);
+    set(ebx, 9, Feature::ERMS);
+    set(ebx, 11, Feature::RTM);
+    set(ebx, 18, Feature::RDSEED);
+    set(ebx, 19, Feature::ADX);
+    set(ebx, 23, Feature::CLFLUSHOPT);
+    set(ebx, 24, Feature::CLWB);
+    set(ebx, 29, Feature::SHA);
+    set(ecx, 5, Feature::WAITPKG);
+    set(ecx, 8, Feature::GFNI);
+    set(ecx, 22, Feature::RDPID);
+    set(edx, 4, Feature::FSRM);
+    set(edx, 14, Feature::SERIALIZE);
+    set(edx, 15, Feature::HYBRID);
+    if (avx_state) {
+      set(ebx, 5, Feature::AVX2);
+      set(ecx, 9, Feature::VAES);
+      set(ecx, 10, Feature::VPCLMULQDQ);
+    }
+    if (avx512_state) {
+      set(ebx, 16, Feature::AVX512F);
+      set(ebx, 17, Feature::AVX512DQ);
+      set(ebx, 21, Feature::AVX512IFMA);
+      set(ebx, 28, Feature::AVX512CD);
+      set(ebx, 30, Feature::AVX512BW);
+      set(ebx, 31, Feature::AVX512VL);
+      set(ecx, 1, Feature::AVX512VBMI);
+      set(ecx, 6, Feature::AVX512_VBMI2);
+      set(ecx, 11, Feature::AVX512_VNNI);
+      set(ecx, 12, Feature::AVX512_BITALG);
+      set(ecx, 14, Feature::AVX512_VPOPCNTDQ);
+      set(edx, 8, Feature::AVX512_VP2INTERSECT);
+      set(edx, 23, Feature::AVX512_FP16);
+    }
+    if (amx_state) {
+      set(edx, 22, Feature::AMX_BF16);
+      set(edx, 24, Feature::AMX_TILE);
+      set(edx, 25, Feature::AMX_INT8);
+    }
+    // sub leaf 1 is valid if sub leaf 0 reports it in eax
+    if (leaf7[0] >= 1) {
+      uint32_t leaf7_1[4]{};
+      cpuid(7, 1, leaf7_1);
+      if (avx_state) {
+        set(leaf7_1[0], 4, Feature::AVX_VNNI);
+      }
+      if (avx512_state) {
+        set(leaf7_1[0], 5, Feature::AVX512_BF16);
+      }
+    }
+  }
+
+  if (max_leaf(0x80000000) >= 0x80000001) {
+    uint32_t ext[4]{};
+    cpuid(0x80000001, 0, ext);
+    set(ext[2], 0, Feature::LAHF_LM);
+    set(ext[2], 5, Feature::ABM);
+    set(ext[2], 6, Feature::SSE4A);
+    set(ext[2], 8, Feature::PREFETCHW);
+    set(ext[2], 21, Feature::TBM);
+    set(ext[2], 22, Feature::TOPOEXT);
+    set(ext[3], 20, Feature::NX);
+    set(ext[3], 26, Feature::PDPE1GB);
+    set(ext[3], 27, Feature::RDTSCP);
+    set(ext[3], 29, Feature::LM);
+    if (avx_state) {
+      set(ext[2], 11, Feature::XOP);
+      set(ext[2], 16, Feature::FMA4);
+    }
+  }
+  return features;
+}
+
+// One cache as described by leaf 4 (Intel) or 0x8000001D (AMD).
+struct CacheDescriptor {
+  enum Type : uint8_t { Data = 1, Instruction = 2, Unified = 3 };
+
+  int level{0};
+  Type type{Unified};
+  int64_t size_Bytes{0};
+  int line_size_Bytes{0};
+  int ways{0};
+  // maximum number of logical cpus sharing this cache
+  int shared_by{0};
+};
+
+/**
+ * Cache hierarchy of the cpu that executes the call, in the order reported by the cpu (usually L1d, L1i, L2, L3). Uses
+ * the deterministic cache parameters of leaf 4 or, on AMD, 0x8000001D (topology extensions). Older AMD cpus only
+ * report sizes in 0x80000005/0x80000006, which are decoded as a fallback.
+ */
+inline std::vector<CacheDescriptor> read_caches() {
+  std::vector<CacheDescriptor> caches;
+  uint32_t regs[4]{};
+  cpuid(0, 0, regs);
+  // "AuthenticAMD" and "HygonGenuine" use the AMD leaves
+  const bool amd = regs[1] == 0x68747541 || regs[1] == 0x6f677948;
+  const uint32_t max_basic = regs[0];
+  const uint32_t max_extended = max_leaf(0x80000000);
+
+  uint32_t leaf = 0;
+  if (amd) {
+    uint32_t ext[4]{};
+    if (max_extended >= 0x80000001) {
+      cpuid(0x80000001, 0, ext);
+    }
+    leaf = max_extended >= 0x8000001d && ((ext[2] >> 22) & 1) ? 0x8000001d : 0;
+  } else if (max_basic >= 4) {
+    leaf = 4;
+  }
+
+  if (leaf != 0) {
+    // sub leaves end with the null type; the limit only guards against broken hypervisors
+    for (uint32_t index = 0; index < 16; ++index) {
+      cpuid(leaf, index, regs);
+      const uint32_t type = regs[0] & 0x1f;
+      if (type == 0) {
+        break;
+      }
+      CacheDescriptor cache;
+      cache.level = static_cast<int>((regs[0] >> 5) & 0x7);
+      cache.type = static_cast<CacheDescriptor::Type>(type <= 3 ? type : 3);
+      cache.shared_by = static_cast<int>(((regs[0] >> 14) & 0xfff) + 1);
+      cache.ways = static_cast<int>(((regs[1] >> 22) & 0x3ff) + 1);
+      const int64_t partitions = ((regs[1] >> 12) & 0x3ff) + 1;
+      cache.line_size_Bytes = static_cast<int>((regs[1] & 0xfff) + 1);
+      const int64_t sets = static_cast<int64_t>(regs[2]) + 1;
+      cache.size_Bytes = cache.ways * partitions * cache.line_size_Bytes * sets;
+      caches.push_back(cache);
+    }
+    return caches;
+  }
+
+  if (amd && max_extended >= 0x80000006) {
+    uint32_t l1[4]{};
+    uint32_t l2[4]{};
+    cpuid(0x80000005, 0, l1);
+    cpuid(0x80000006, 0, l2);
+    const auto add = [&caches](int level, CacheDescriptor::Type type, int64_t size_Bytes, uint32_t line_size_Bytes) {
+      if (size_Bytes > 0) {
+        CacheDescriptor cache;
+        cache.level = level;
+        cache.type = type;
+        cache.size_Bytes = size_Bytes;
+        cache.line_size_Bytes = static_cast<int>(line_size_Bytes);
+        caches.push_back(cache);
+      }
+    };
+    add(1, CacheDescriptor::Data, static_cast<int64_t>(l1[2] >> 24) * 1024, l1[2] & 0xff);
+    add(1, CacheDescriptor::Instruction, static_cast<int64_t>(l1[3] >> 24) * 1024, l1[3] & 0xff);
+    add(2, CacheDescriptor::Unified, static_cast<int64_t>(l2[2] >> 16) * 1024, l2[2] & 0xff);
+    add(3, CacheDescriptor::Unified, static_cast<int64_t>(l2[3] >> 18) * 512 * 1024, l2[3] & 0xff);
+  }
+  return caches;
+}
+
+// Core type of a hybrid cpu (leaf 0x1A).
+enum class CoreType : uint8_t { Unknown = 0, Efficiency = 0x20, Performance = 0x40 };
+
+/**
+ * Core type of the cpu that executes the call. Only meaningful if Feature::HYBRID is set; pin the calling thread to
+ * query a specific cpu.
+ */
+inline CoreType core_type() {
+  if (max_leaf(0) < 0x1a) {
+    return CoreType::Unknown;
+  }
+  uint32_t regs[4]{};
+  cpuid(0x1a, 0, regs);
+  switch (regs[0] >> 24) {
+    case 0x20:
+      return CoreType::Efficiency;
+    case 0x40:
+      return CoreType::Performance;
+    default:
+      return CoreType::Unknown;
+  }
+}
+
 }  // namespace cpuid
 }  // namespace hwinfo
 
@@ -0,0 +1,84 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/component.h>
+#include <hwinfo/platform.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace hwinfo {
+
+/**
+ * Notifies about hotplug changes (disks, network interfaces, batteries, GPUs, memory and cpus coming and going) without
+ * re-enumerating anything: Linux listens to the kernel uevents (NETLINK_KOBJECT_UEVENT) and to link and address changes
+ * (NETLINK_ROUTE), Windows registers for WM_DEVICECHANGE device interface notifications, macOS for IOKit matching and
+ * termination notifications. Consumers re-enumerate only the reported components.
+ *
+ * wait() may be called from one thread at a time; interrupt() from any thread.
+ */
+class HWINFO_API DeviceMonitor {
+ public:
+  // Starts listening. Changes that happened before are not reported.
+  DeviceMonitor();
+  ~DeviceMonitor();
+  DeviceMonitor(const DeviceMonitor&) = delete;
+  DeviceMonitor& operator=(const DeviceMonitor&) = delete;
+
+  // false if the notifications could not be set up (wait() then only times out).
+  HWI_NODISCARD bool valid() const;
+  /**
+   * Linux: a descriptor that becomes readable when changes are pending, for the consumer's own poll/epoll loop (call
+   * wait() with a zero timeout once it is readable). -1 on other platforms.
+   */
+  HWI_NODISCARD int fd() const;
+
+  /**
+   * Waits up to timeout for changes and returns the components that changed since the previous call. Everything that
+   * is pending is reported at once, so a burst of events (a disk and its partitions) yields a single result. A zero
+   * timeout only collects what is pending, a negative one waits indefinitely.
+   * @return Component::None on timeout or after interrupt()
+   */
+  Component wait(std::chrono::milliseconds timeout);
+  // Makes a concurrent (or the next) wait() return early.
+  void interrupt();
+
+ private:
+  // Platform specific state: sockets, notification registrations, the thread receiving them.
+  struct Source;
+  std::unique_ptr<Source> _source;
+};
+
+/**
+ * Runs a DeviceMonitor on a background thread and calls callback (on that thread) with the changed components of every
+ * batch of changes.
+ */
+class HWINFO_API DeviceWatcher {
+ public:
+  using Callback = std::function<void(Component changed)>;
+
+  explicit DeviceWatcher(Callback callback);
+  // Stops the thread, see stop().
+  ~DeviceWatcher();
+  DeviceWatcher(const DeviceWatcher&) = delete;
+  DeviceWatcher& operator=(const DeviceWatcher&) = delete;
+
+  HWI_NODISCARD bool valid() const { return _monitor.valid(); }
+  // Stops watching and waits for a running callback to return. Must not be called from the callback. Idempotent.
+  void stop();
+
+ private:
+  void run();
+
+  DeviceMonitor _monitor;
+  Callback _callback;
+  std::atomic<bool> _stop{false};
+  std::thread _thread;
+};
+
+}  // namespace hwinfo
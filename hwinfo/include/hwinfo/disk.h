@@ -3,9 +3,13 @@
 
 #pragma once
 
+#include <hwinfo/fields.h>
+#include <hwinfo/interned_string.h>
 #include <hwinfo/platform.h>
 
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -15,31 +19,58 @@ namespace hwinfo {
 const unsigned short block_size = 512;
 
 class HWINFO_API Disk {
-  friend std::vector<Disk> getAllDisks();
+  friend std::vector<Disk> getAllDisks(DiskFields fields);
+  friend class DiskEnumerator;
 
  public:
   ~Disk() = default;
 
-  HWI_NODISCARD const std::string& vendor() const;
-  HWI_NODISCARD const std::string& model() const;
-  HWI_NODISCARD const std::string& serialNumber() const;
+  HWI_NODISCARD InternedString vendor() const;
+  HWI_NODISCARD InternedString model() const;
+  HWI_NODISCARD InternedString serialNumber() const;
   HWI_NODISCARD int64_t size_Bytes() const;
   HWI_NODISCARD int64_t free_size_Bytes() const;
   HWI_NODISCARD const std::vector<std::string>& volumes() const;
   HWI_NODISCARD int id() const;
+  // Name of the device as the OS addresses it: "nvme0n1" (Linux), "\\.\PHYSICALDRIVE0" (Windows), "disk0" (macOS).
+  HWI_NODISCARD const std::string& deviceName() const;
 
  private:
   Disk() = default;
 
-  std::string _vendor;
-  std::string _model;
-  std::string _serialNumber;
+  InternedString _vendor;
+  InternedString _model;
+  InternedString _serialNumber;
   int64_t _size_Bytes{-1};
   int64_t _free_size_Bytes{-1};
   std::vector<std::string> _volumes;
   int _id{-1};
+  std::string _device_name;
+};
+
+/**
+ * Streams the disks of getAllDisks(fields) one at a time, so callers can filter and stop early without the whole list
+ * being built. On Linux every next() reads the following entries of /sys/class/block until it finds a disk; other
+ * platforms enumerate eagerly and hand out the list item by item. Not thread-safe.
+ */
+class HWINFO_API DiskEnumerator {
+ public:
+  explicit DiskEnumerator(DiskFields fields = DiskFields::All);
+  ~DiskEnumerator();
+  DiskEnumerator(const DiskEnumerator&) = delete;
+  DiskEnumerator& operator=(const DiskEnumerator&) = delete;
+
+  // The next disk, std::nullopt after the last one.
+  std::optional<Disk> next();
+
+ private:
+  struct Source;
+
+  std::unique_ptr<Source> _source;
 };
 
 std::vector<Disk> getAllDisks();
+// Reads only the requested attributes, see hwinfo/fields.h.
+std::vector<Disk> getAllDisks(DiskFields fields);
 
 }  // namespace hwinfo
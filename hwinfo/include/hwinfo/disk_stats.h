@@ -0,0 +1,98 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * I/O activity of one disk over the period between two DiskStatsSampler updates. The layout is fixed (no pointers) so
+ * that arrays of it can be copied as a block, e.g. across the C API. Values that are not available are -1.
+ */
+struct DiskIOStats {
+  double reads_per_s{-1.0};
+  double writes_per_s{-1.0};
+  double read_Bytes_per_s{-1.0};
+  double written_Bytes_per_s{-1.0};
+  // Mean time of the requests completed in the period, queueing included (0 if there were none).
+  double read_await_ms{-1.0};
+  double write_await_ms{-1.0};
+  // Mean number of requests in flight.
+  double queue_depth{-1.0};
+  // Fraction of the period with at least one request in flight, in [0, 1].
+  double utilisation{-1.0};
+  // Requests in flight at the end of the period.
+  int64_t in_flight{-1};
+};
+
+/**
+ * Delta based disk I/O sampler. Every update() reads the cumulative counters of all disks at once (Linux: one pread of
+ * /proc/diskstats on a descriptor opened once; Windows: IOCTL_DISK_PERFORMANCE on handles opened once; macOS: the
+ * statistics of the IOBlockStorageDriver services) and computes the rates since the previous update().
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API DiskStatsSampler {
+ public:
+  // Samples the disks of getAllDisks(), in that order.
+  DiskStatsSampler();
+  // Samples the given disks (Disk::deviceName(), e.g. "nvme0n1").
+  explicit DiskStatsSampler(std::vector<std::string> device_names);
+  ~DiskStatsSampler();
+  DiskStatsSampler(const DiskStatsSampler&) = delete;
+  DiskStatsSampler& operator=(const DiskStatsSampler&) = delete;
+
+  /**
+   * Reads the counters and replaces stats() by the rates since the previous update. After the first update (which
+   * only records the baseline) and for disks whose counters could not be read, all stats are -1.
+   * @return false if no counters could be read.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _device_names.size(); }
+  HWI_NODISCARD const std::vector<std::string>& device_names() const { return _device_names; }
+  // size() entries, in the order of device_names().
+  HWI_NODISCARD const DiskIOStats* stats() const { return _stats.data(); }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Cumulative counters of one disk, -1 if the platform does not report them.
+  struct Counters {
+    int64_t reads{-1};
+    int64_t writes{-1};
+    int64_t read_Bytes{-1};
+    int64_t written_Bytes{-1};
+    // summed time of the completed requests
+    int64_t read_time_ms{-1};
+    int64_t write_time_ms{-1};
+    int64_t in_flight{-1};
+    // time with at least one request in flight
+    int64_t busy_time_ms{-1};
+    // busy time weighted by the number of requests in flight
+    int64_t weighted_time_ms{-1};
+  };
+  // Platform specific state, e.g. opened files or handles.
+  struct Source;
+
+  // Reads the counters of all disks into _current (one entry per disk, already sized). Implemented per platform.
+  bool read_counters();
+
+  std::vector<std::string> _device_names;
+  std::unique_ptr<Source> _source;
+  std::vector<Counters> _previous;
+  std::vector<Counters> _current;
+  std::vector<DiskIOStats> _stats;
+  int64_t _timestamp_ns{-1};
+  bool _has_baseline{false};
+};
+
+}  // namespace hwinfo
@@ -0,0 +1,76 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace hwinfo {
+
+/**
+ * Attributes that getAllCPUs(), getAllGPUs(), getAllDisks() and getAllNetworks() read, combine with |. Attributes
+ * that were not requested keep their defaults ("<unknown>", -1, empty), and the I/O behind them is skipped, e.g.
+ * getAllNetworks(NetworkFields::None) lists the interfaces with one if_nameindex() call. Ids and the names the OS
+ * addresses a device by are always set.
+ */
+
+// Vendor, model and core counts are always read.
+enum class CPUFields : uint32_t {
+  None = 0,
+  Clocks = 1 << 0,    // max and regular clock speed (cpufreq on Linux)
+  Caches = 1 << 1,    // cache sizes (CPUID, Win32_CacheMemory)
+  Features = 1 << 2,  // flags and FeatureSet
+  All = 0x7,
+};
+
+// The PCI vendor and device ids are always read.
+enum class GPUFields : uint32_t {
+  None = 0,
+  Names = 1 << 0,  // vendor and device name (PCI database on Linux), driver version
+  Memory = 1 << 1,
+  Frequency = 1 << 2,
+  All = 0x7,
+};
+
+enum class DiskFields : uint32_t {
+  None = 0,
+  Identity = 1 << 0,  // vendor, model and serial number
+  Size = 1 << 1,
+  Volumes = 1 << 2,  // mount points and free space (mount table, statfs)
+  All = 0x7,
+};
+
+// The interface index and name are always read.
+enum class NetworkFields : uint32_t {
+  None = 0,
+  Mac = 1 << 0,
+  Addresses = 1 << 1,  // IPv4 and IPv6 addresses
+  All = 0x3,
+};
+
+template <typename T>
+struct is_field_mask : std::false_type {};
+template <>
+struct is_field_mask<CPUFields> : std::true_type {};
+template <>
+struct is_field_mask<GPUFields> : std::true_type {};
+template <>
+struct is_field_mask<DiskFields> : std::true_type {};
+template <>
+struct is_field_mask<NetworkFields> : std::true_type {};
+
+template <typename T, typename = std::enable_if_t<is_field_mask<T>::value>>
+constexpr T operator|(T a, T b) {
+  return static_cast<T>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+template <typename T, typename = std::enable_if_t<is_field_mask<T>::value>>
+constexpr T operator&(T a, T b) {
+  return static_cast<T>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+}
+template <typename T, typename = std::enable_if_t<is_field_mask<T>::value>>
+constexpr bool contains(T set, T field) {
+  return (static_cast<uint32_t>(set) & static_cast<uint32_t>(field)) == static_cast<uint32_t>(field);
+}
+
+}  // namespace hwinfo
@@ -0,0 +1,92 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Effective clock of one logical cpu over the period between two FrequencySampler updates. The layout is fixed (no
+ * pointers) so that arrays of it can be copied as a block, e.g. across the C API. Values that are not available are -1.
+ */
+struct FrequencyStats {
+  // Mean clock while not halted (turbostat: Bzy_MHz): APERF / MPERF * TSC rate.
+  double busy_MHz{-1.0};
+  // Mean clock over the whole period, idle time counting as 0 (turbostat: Avg_MHz): cycles per second.
+  double average_MHz{-1.0};
+  // Fraction of the period the cpu was not halted (C0 residency), in [0, 1].
+  double busy{-1.0};
+};
+
+/**
+ * Delta based sampler of the effective clock of every logical cpu, derived from the cycle counters instead of the
+ * frequency the governor requested. All counters of a cpu are read together (Linux: one read() of a perf event group
+ * per cpu; Windows: one CallNtPowerInformation() call for all cpus) and the counters stay open between updates.
+ *
+ * Linux backends, the first that can be opened for every cpu is used:
+ *  - the perf "msr" PMU (tsc, aperf, mperf), available on x86 without raw MSR access
+ *  - the hardware cycles perf event (e.g. ARM, virtual machines): average_MHz only, busy_MHz and busy stay -1
+ *  - /dev/cpu/N/msr (IA32_TIME_STAMP_COUNTER, IA32_APERF, IA32_MPERF), requires root and the msr module
+ * perf_event_open() for cpu-wide events requires perf_event_paranoid <= 0 or CAP_PERFMON. Windows reports the current
+ * clock of the power manager as busy_MHz. macOS has no public interface, all values stay -1.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API FrequencySampler {
+ public:
+  // Samples the logical cpus 0 .. std::thread::hardware_concurrency() - 1.
+  FrequencySampler();
+  // Samples the logical cpus 0 .. num_threads - 1, indexed by the OS cpu id.
+  explicit FrequencySampler(int num_threads);
+  ~FrequencySampler();
+  FrequencySampler(const FrequencySampler&) = delete;
+  FrequencySampler& operator=(const FrequencySampler&) = delete;
+
+  /**
+   * Reads the counters and replaces stats() by the clocks since the previous update. After the first update (which
+   * only records the baseline of the counters) and for cpus whose counters could not be read, all stats are -1.
+   * @return false if no counters could be read.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _stats.size(); }
+  // False if no backend could be opened, update() then always fails.
+  HWI_NODISCARD bool available() const;
+  // size() entries, indexed by the OS cpu id.
+  HWI_NODISCARD const FrequencyStats* stats() const { return _stats.data(); }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Cumulative counters of one cpu, -1 if the backend does not provide them.
+  struct Counters {
+    // ticks at the constant (nominal) rate
+    int64_t tsc{-1};
+    // cycles at the actual clock while not halted
+    int64_t aperf{-1};
+    // ticks at the TSC rate while not halted
+    int64_t mperf{-1};
+  };
+  // Platform specific state, e.g. the opened counters.
+  struct Source;
+
+  // Reads the counters of all cpus into _current (one entry per cpu, already reset). Platforms that report the clock
+  // directly (Windows) write it to _stats (already reset) instead. Implemented per platform.
+  bool read_counters();
+
+  std::unique_ptr<Source> _source;
+  std::vector<Counters> _previous;
+  std::vector<Counters> _current;
+  std::vector<FrequencyStats> _stats;
+  int64_t _timestamp_ns{-1};
+  bool _has_baseline{false};
+};
+
+}  // namespace hwinfo
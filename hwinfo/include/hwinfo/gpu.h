@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <hwinfo/fields.h>
+#include <hwinfo/interned_string.h>
 #include <hwinfo/platform.h>
+#include <hwinfo/static_cache.h>
 
 #include <cstdint>
 #include <string>
@@ -12,34 +15,57 @@
 namespace hwinfo {
 
 class HWINFO_API GPU {
-  friend std::vector<GPU> getAllGPUs();
+  friend std::vector<GPU> getAllGPUs(GPUFields fields);
+  friend struct static_cache::Access;
+#ifdef USE_OCL
+  friend void enrichWithOpenCL(std::vector<GPU>& gpus);
+#endif
 
  public:
   ~GPU() = default;
 
-  HWI_NODISCARD const std::string& vendor() const;
-  HWI_NODISCARD const std::string& name() const;
-  HWI_NODISCARD const std::string& driverVersion() const;
+  HWI_NODISCARD InternedString vendor() const;
+  HWI_NODISCARD InternedString name() const;
+  HWI_NODISCARD InternedString driverVersion() const;
   HWI_NODISCARD int64_t memory_Bytes() const;
   HWI_NODISCARD int64_t frequency_MHz() const;
   HWI_NODISCARD int num_cores() const;
   HWI_NODISCARD int id() const;
-  HWI_NODISCARD const std::string& vendor_id() const;
-  HWI_NODISCARD const std::string& device_id() const;
+  HWI_NODISCARD InternedString vendor_id() const;
+  HWI_NODISCARD InternedString device_id() const;
+  // PCI address ("0000:01:00.0", domain:bus:device.function), empty where unknown (only Linux reports it).
+  HWI_NODISCARD const std::string& pciBusId() const;
 
  private:
   GPU() = default;
-  std::string _vendor{};
-  std::string _name{};
-  std::string _driverVersion{};
+  InternedString _vendor{};
+  InternedString _name{};
+  InternedString _driverVersion{};
   int64_t _memory_Bytes{0};
   int64_t _frequency_MHz{0};
   int _num_cores{0};
   int _id{0};
 
-  std::string _vendor_id{};
-  std::string _device_id{};
+  InternedString _vendor_id{};
+  InternedString _device_id{};
+  std::string _pci_bus_id{};
 };
 
 std::vector<GPU> getAllGPUs();
+// Reads only the requested attributes, see hwinfo/fields.h.
+std::vector<GPU> getAllGPUs(GPUFields fields);
+
+#ifdef USE_OCL
+/**
+ * Sets driverVersion(), frequency_MHz() (maximum clock), num_cores() and memory_Bytes() of the given GPUs from OpenCL.
+ * getAllGPUs() does not use OpenCL: initialising the platforms loads every installed ICD, which is far more expensive
+ * than the rest of the enumeration. This is why it is a separate, opt-in step.
+ *
+ * The OpenCL GPUs are enumerated on the first call only. Their properties are cached per PCI bus ID
+ * (cl_khr_pci_bus_info, or the NVIDIA/AMD topology extensions), and later calls only look them up. GPUs without a PCI
+ * bus ID are matched by name. GPUs without a matching OpenCL device keep their values. Thread-safe.
+ */
+void enrichWithOpenCL(std::vector<GPU>& gpus);
+#endif  // USE_OCL
+
 }  // namespace hwinfo
@@ -0,0 +1,81 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Telemetry of one GPU as of a GPUStatsSampler update. The layout is fixed (no pointers) so that arrays of it can be
+ * copied as a block, e.g. across the C API. Values that are not available are -1.
+ */
+struct GPUStats {
+  // Busy share ([0, 1]) of the graphics/compute engine.
+  double utilisation{-1.0};
+  int64_t memory_used_Bytes{-1};
+  int64_t memory_total_Bytes{-1};
+  // Current core (NVIDIA: SM) and memory clocks.
+  int64_t core_clock_MHz{-1};
+  int64_t memory_clock_MHz{-1};
+  // Board power (NVIDIA, amdgpu) or the power derived from the energy counter since the previous update.
+  double power_W{-1.0};
+  double temperature_C{-1.0};
+};
+
+/**
+ * GPU telemetry sampler with one backend per GPU, chosen when the sampler is constructed (Linux):
+ *  - NVML for NVIDIA GPUs. libnvidia-ml is loaded with dlopen() on first use, so it is no link dependency and GPUs of
+ *    systems without the driver just fall back to sysfs.
+ *  - sysfs for all others: gpu_busy_percent and mem_info_vram_* (amdgpu), the actual frequency of the DRM card (i915,
+ *    xe) and the hwmon sensors of the device (clocks, power, temperature).
+ * The attribute files and NVML handles are opened once and kept open between updates. Windows and macOS do not provide
+ * telemetry yet: every value stays -1.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API GPUStatsSampler {
+ public:
+  // Samples the GPUs of getAllGPUs(), in that order.
+  GPUStatsSampler();
+  // Samples the GPUs with the given PCI addresses (see GPU::pciBusId()).
+  explicit GPUStatsSampler(std::vector<std::string> pci_bus_ids);
+  ~GPUStatsSampler();
+  GPUStatsSampler(const GPUStatsSampler&) = delete;
+  GPUStatsSampler& operator=(const GPUStatsSampler&) = delete;
+
+  /**
+   * Replaces stats() by the current values. Values derived from counters (power from the energy counter) are -1 after
+   * the first update.
+   * @return false if no value of any GPU could be read.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _pci_bus_ids.size(); }
+  HWI_NODISCARD const std::vector<std::string>& pci_bus_ids() const { return _pci_bus_ids; }
+  // size() entries, in the order of pci_bus_ids().
+  HWI_NODISCARD const GPUStats* stats() const { return _stats.data(); }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Platform specific state, e.g. the backends of the GPUs.
+  struct Source;
+
+  // Reads the values of all GPUs into _stats (one entry per GPU, already reset). Implemented per platform.
+  bool read_stats(int64_t now_ns);
+
+  std::vector<std::string> _pci_bus_ids;
+  std::unique_ptr<Source> _source;
+  std::vector<GPUStats> _stats;
+  int64_t _timestamp_ns{-1};
+};
+
+}  // namespace hwinfo
@@ -3,11 +3,88 @@
 
 #pragma once
 
+#include <hwinfo/async.h>
 #include <hwinfo/battery.h>
+#include <hwinfo/cgroup.h>
+#include <hwinfo/component.h>
 #include <hwinfo/cpu.h>
+#include <hwinfo/cpu_times.h>
+#include <hwinfo/device_monitor.h>
 #include <hwinfo/disk.h>
+#include <hwinfo/disk_stats.h>
+#include <hwinfo/frequency_stats.h>
 #include <hwinfo/gpu.h>
+#include <hwinfo/interrupts.h>
+#include <hwinfo/inventory.h>
 #include <hwinfo/mainboard.h>
 #include <hwinfo/network.h>
+#include <hwinfo/network_stats.h>
+#include <hwinfo/nvme.h>
 #include <hwinfo/os.h>
+#include <hwinfo/pressure.h>
+#include <hwinfo/process_stats.h>
 #include <hwinfo/ram.h>
+#include <hwinfo/sampler.h>
+#include <hwinfo/sensors.h>
+#include <hwinfo/shared_frame.h>
+#include <hwinfo/static_cache.h>
+#include <hwinfo/stats.h>
+#include <hwinfo/thread_metrics.h>
+#include <hwinfo/topology.h>
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <optional>
+#include <vector>
+
+namespace hwinfo {
+
+// Result of collectAll(). Components that were not requested are empty.
+struct SystemInfo {
+  std::vector<CPU> cpus;
+  std::optional<OS> os;
+  std::vector<GPU> gpus;
+  std::optional<Memory> memory;
+  std::optional<MainBoard> mainboard;
+  std::vector<Disk> disks;
+  std::vector<Battery> batteries;
+  std::vector<Network> networks;
+};
+
+/**
+ * Runs a task, e.g. by posting it to an existing thread pool. collectAll() submits one task per requested component
+ * and blocks until all of them finished, so tasks must not wait for the calling thread.
+ */
+using Executor = std::function<void(std::function<void()>)>;
+
+// Runs every task on the calling thread (serial collection).
+HWINFO_API Executor inlineExecutor();
+
+/**
+ * Collects the requested components concurrently. The collectors are independent and mostly wait for I/O (sysfs,
+ * /proc, WMI, IOKit), so running them in parallel reduces the wall time to roughly that of the slowest one.
+ *
+ * Without an executor the components are collected on WorkerPool::shared() and on the calling thread, which runs the
+ * tasks no worker started yet. WMI based collectors (Windows) connect through the per-thread WMI session of whichever
+ * thread runs them, so no COM state is shared between threads and the workers reuse their sessions across calls.
+ * If a collector throws, the first exception is rethrown after all tasks finished.
+ */
+HWINFO_API SystemInfo collectAll(Component components = Component::All, const Executor& executor = {});
+
+/**
+ * Non-blocking collectAll(): the components are collected concurrently on WorkerPool::shared() and done is called
+ * exactly once, on a worker or on the timer thread, with the result or with the first exception of a collector, or with
+ * a TimeoutError once timeout (if not zero) elapsed. done must not block.
+ */
+HWINFO_API void collectAllAsync(Component components,
+                                std::function<void(std::optional<SystemInfo>, std::exception_ptr)> done,
+                                std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+// Future variant of collectAllAsync(): get() returns the system information or rethrows the error.
+HWINFO_API std::future<SystemInfo> collectAllAsync(
+    Component components = Component::All, std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+}  // namespace hwinfo
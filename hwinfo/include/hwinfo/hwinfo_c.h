@@ -29,6 +29,13 @@ typedef struct {
 
 // --- Component-Specific Structs ---
 
+// Cpu features are a fixed size bitmask: feature f (see hwinfo/cpu_features.h) is bit (f % 64) of
+// features[f / 64]. get_cpu_feature_name() returns the canonical (/proc/cpuinfo) name of a feature.
+typedef enum {
+  C_CPU_FEATURE_WORDS = 4,
+  C_CPU_FEATURE_COUNT = 85,
+} C_CpuFeatureLimits;
+
 typedef struct {
   int id;
   char* vendor;
@@ -40,7 +47,8 @@ typedef struct {
   int64_t L1CacheSize_Bytes;
   int64_t L2CacheSize_Bytes;
   int64_t L3CacheSize_Bytes;
-  C_StringArray flags;
+  C_StringArray flags;  // raw flag strings; prefer features for lookups
+  uint64_t features[4];  // C_CPU_FEATURE_WORDS
 } C_CPU;
 
 typedef struct {
@@ -62,6 +70,8 @@ typedef struct {
   int num_cores;
   char* vendor_id;
   char* device_id;
+  // PCI address ("0000:01:00.0"), empty where unknown
+  char* pciBusId;
 } C_GPU;
 
 typedef struct {
@@ -82,6 +92,49 @@ typedef struct {
   C_RAM_Module* modules;
 } C_MemoryInfo;
 
+// Memory counters of one read (see hwinfo/ram.h). HugePages values are page counts, all others in
+// bytes; values that are not available on the platform are -1.
+typedef struct {
+  int64_t timestamp_ns;
+  int64_t total_Bytes;
+  int64_t free_Bytes;
+  int64_t available_Bytes;
+  int64_t buffers_Bytes;
+  int64_t cached_Bytes;
+  int64_t shmem_Bytes;
+  int64_t dirty_Bytes;
+  int64_t writeback_Bytes;
+  int64_t swap_total_Bytes;
+  int64_t swap_free_Bytes;
+  int64_t hugepages_total;
+  int64_t hugepages_free;
+  int64_t hugepages_reserved;
+  int64_t hugepages_surplus;
+  int64_t hugepage_size_Bytes;
+} C_MemorySnapshot;
+
+// Memory of one NUMA node (see hwinfo/ram.h). HugePages values and the allocation counters are page
+// counts since boot, the sizes are bytes; values that are not available on the platform are -1.
+// The cpus of a node are those with that node in C_Topology::node.
+typedef struct {
+  int32_t node;
+  int64_t total_Bytes;
+  int64_t free_Bytes;
+  int64_t used_Bytes;
+  int64_t file_Bytes;
+  int64_t anon_Bytes;
+  int64_t hugepages_total;
+  int64_t hugepages_free;
+  int64_t numa_hit;
+  int64_t numa_miss;
+  int64_t numa_foreign;
+  int64_t interleave_hit;
+  int64_t local_node;
+  int64_t other_node;
+  int64_t promoted_pages;
+  int64_t demoted_pages;
+} C_NodeMemory;
+
 typedef struct {
   char* vendor;
   char* name;
@@ -108,6 +161,11 @@ typedef struct {
   uint32_t energyFull;
   uint32_t energyNow;
   bool charging;
+  // -1 if not reported (Linux: µW, µV, percent)
+  int64_t powerNow;
+  int64_t voltageNow;
+  int capacity;
+  int64_t cycleCount;
 } C_Battery;
 
 typedef struct {
@@ -116,20 +174,398 @@ typedef struct {
   char* mac;
   char* ip4;
   char* ip6;
+  // all addresses of the interface
+  C_StringArray ip4s;
+  C_StringArray ip6s;
 } C_Network;
 
+// --- Field Masks ---
+// Attributes read by the get_*_with_fields() functions (see hwinfo/fields.h). Combine with bitwise or;
+// attributes that were not requested keep their defaults ("<unknown>", empty, -1) and are not read.
+typedef enum {
+  C_CPU_FIELD_CLOCKS = 1 << 0,
+  C_CPU_FIELD_CACHES = 1 << 1,
+  C_CPU_FIELD_FEATURES = 1 << 2,
+  C_CPU_FIELD_ALL = 0x7,
+  C_GPU_FIELD_NAMES = 1 << 0,
+  C_GPU_FIELD_MEMORY = 1 << 1,
+  C_GPU_FIELD_FREQUENCY = 1 << 2,
+  C_GPU_FIELD_ALL = 0x7,
+  C_DISK_FIELD_IDENTITY = 1 << 0,
+  C_DISK_FIELD_SIZE = 1 << 1,
+  C_DISK_FIELD_VOLUMES = 1 << 2,
+  C_DISK_FIELD_ALL = 0x7,
+  C_NETWORK_FIELD_MAC = 1 << 0,
+  C_NETWORK_FIELD_ADDRESSES = 1 << 1,
+  C_NETWORK_FIELD_ALL = 0x3,
+} C_FieldFlags;
+
+// --- System Snapshot ---
+// Component selection for get_system_snapshot(). Combine with bitwise or.
+typedef enum {
+  C_SNAPSHOT_CPU = 1 << 0,
+  C_SNAPSHOT_OS = 1 << 1,
+  C_SNAPSHOT_GPU = 1 << 2,
+  C_SNAPSHOT_MEMORY = 1 << 3,
+  C_SNAPSHOT_MAINBOARD = 1 << 4,
+  C_SNAPSHOT_DISK = 1 << 5,
+  C_SNAPSHOT_BATTERY = 1 << 6,
+  C_SNAPSHOT_NETWORK = 1 << 7,
+  C_SNAPSHOT_ALL = 0xff,
+  // Gather the selected components concurrently.
+  C_SNAPSHOT_PARALLEL = 1 << 16,
+} C_SnapshotFlags;
+
+// All selected components in one contiguous allocation. Pointers of components that were
+// not selected (or are not available) are NULL and their counts are 0.
+typedef struct {
+  uint32_t flags;
+  int cpu_count;
+  C_CPU* cpus;
+  C_OS* os;
+  int gpu_count;
+  C_GPU* gpus;
+  C_MemoryInfo* memory;
+  C_MainBoard* mainboard;
+  int disk_count;
+  C_Disk* disks;
+  int battery_count;
+  C_Battery* batteries;
+  int network_count;
+  C_Network* networks;
+} C_SystemSnapshot;
+// Completion of get_system_snapshot_async(), snapshot is NULL on failure or timeout.
+typedef void (*C_SnapshotCallback)(C_SystemSnapshot* snapshot, void* user_data);
+
+// --- Iterators ---
+// Opaque handle of a streaming enumeration of disks or network interfaces (see hwinfo_iter_open()).
+typedef struct C_Iterator C_Iterator;
+
+// --- Sampler ---
+// Metrics of one tick of a background sampler (see hwinfo/sampler.h). Values that could not be
+// read are -1. Per-thread, per-disk and per-interface values are returned separately by
+// get_sampler_frames().
+typedef struct {
+  uint64_t sequence;
+  int64_t timestamp_ns;
+  int64_t period_ns;
+  double cpu_utilization;
+  int64_t memory_free_Bytes;
+  int64_t memory_available_Bytes;
+  int64_t battery_energy_now;
+  int32_t battery_charging;
+  int32_t num_threads;
+  int32_t num_disks;
+  int32_t num_networks;
+  int32_t num_gpus;
+} C_MetricFrame;
+
+// I/O activity of one disk over the period of a frame (see hwinfo/disk_stats.h). Values that
+// could not be read are -1.
+typedef struct {
+  double reads_per_s;
+  double writes_per_s;
+  double read_Bytes_per_s;
+  double written_Bytes_per_s;
+  double read_await_ms;
+  double write_await_ms;
+  double queue_depth;
+  double utilization;
+  int64_t in_flight;
+} C_DiskIOStats;
+
+// Traffic of one network interface over the period of a frame (see hwinfo/network_stats.h).
+// Values that could not be read are -1.
+typedef struct {
+  double rx_Bytes_per_s;
+  double tx_Bytes_per_s;
+  double rx_packets_per_s;
+  double tx_packets_per_s;
+  double rx_errors_per_s;
+  double tx_errors_per_s;
+  double rx_drops_per_s;
+  double tx_drops_per_s;
+} C_NetworkIOStats;
+
+// Telemetry of one GPU as of a frame (see hwinfo/gpu_stats.h). Values that could not be read are
+// -1.
+typedef struct {
+  double utilization;
+  int64_t memory_used_Bytes;
+  int64_t memory_total_Bytes;
+  int64_t core_clock_MHz;
+  int64_t memory_clock_MHz;
+  double power_W;
+  double temperature_C;
+} C_GPUStats;
+
+// Opaque handle of a running background sampler.
+typedef struct C_Sampler C_Sampler;
+
+// Opaque handle of a read-only mapping of the frames a sampler publishes into shared memory (see
+// hwinfo/shared_frame.h).
+typedef struct C_SharedFrameReader C_SharedFrameReader;
+
+// --- Thread Metrics ---
+// Per-thread counters in structure-of-arrays layout (see hwinfo/thread_metrics.h). Every column
+// holds count values, indexed by the OS cpu id, and starts on a 64 byte boundary. Jiffies are
+// cumulative; values that could not be read are -1.
+typedef struct {
+  int count;
+  int num_nodes;
+  int64_t timestamp_ns;
+  int64_t* user;
+  int64_t* system;
+  int64_t* idle;
+  int64_t* iowait;
+  int64_t* irq;
+  int64_t* frequency_MHz;
+  int32_t* node;
+} C_ThreadMetrics;
+
+// --- CPU Times ---
+// Cumulative time of a cpu in every state (see hwinfo/cpu_times.h), USER_HZ ticks on Linux. guest
+// and guest_nice are included in user and nice. All values are -1 for cpus that are not listed.
+typedef struct {
+  int64_t user;
+  int64_t nice;
+  int64_t system;
+  int64_t idle;
+  int64_t iowait;
+  int64_t irq;
+  int64_t softirq;
+  int64_t steal;
+  int64_t guest;
+  int64_t guest_nice;
+} C_CpuTimes;
+
+// Shares ([0, 1]) of the period between two C_CpuTimes; -1 if they cannot be computed.
+typedef struct {
+  double busy;  // user, nice, system, irq, softirq and steal
+  double user;  // user and nice
+  double system;
+  double iowait;
+  double irq;  // irq and softirq
+  double steal;
+  double guest;  // guest and guest_nice
+} C_CpuTimeRates;
+
+// --- Topology ---
+// Logical cpu -> core -> last level cache domain -> NUMA node -> socket (see hwinfo/topology.h).
+// Every column holds count values indexed by the OS cpu id; cpus that are not online are -1.
+// Cores, cache domains and sockets are numbered densely from 0, nodes keep the OS node id.
+typedef struct {
+  int count;
+  int num_sockets;
+  int num_cores;
+  int num_cache_domains;
+  int num_nodes;
+  int32_t* core;
+  int32_t* cache_domain;
+  int32_t* node;
+  int32_t* socket;
+  int32_t* efficiency_class;  // higher is faster, equal on systems without hybrid cores
+} C_Topology;
+
+// --- Device Monitor ---
+// Opaque handles of hotplug listeners (see hwinfo/device_monitor.h).
+typedef struct C_DeviceMonitor C_DeviceMonitor;
+typedef struct C_DeviceWatcher C_DeviceWatcher;
+// Called with the changed components (C_SnapshotFlags bits) of a batch of hotplug changes.
+typedef void (*C_DeviceChangeCallback)(uint32_t changed, void* user_data);
+
+// --- Sensors ---
+// Physical quantity of a sensor (see hwinfo/sensors.h) and the unit of its values.
+typedef enum {
+  C_SENSOR_TEMPERATURE = 0,  // °C
+  C_SENSOR_POWER = 1,        // W
+  C_SENSOR_FAN = 2,          // RPM
+  C_SENSOR_VOLTAGE = 3,      // V
+} C_SensorKind;
+
+// Static description of a sensor: the driver ("coretemp", "rapl", "smc", ...), the channel label
+// and the cpu package it belongs to (-1 if unknown or not a cpu sensor).
+typedef struct {
+  int32_t kind;  // C_SensorKind
+  int32_t socket;
+  char* chip;
+  char* label;
+} C_Sensor;
+
+typedef struct {
+  int count;
+  C_Sensor* sensors;
+} C_SensorArray;
+
+// Opaque handle of a sensor sampler.
+typedef struct C_SensorSampler C_SensorSampler;
+
+// --- Cgroup ---
+// Limits and usage of the cgroup of the calling process (see hwinfo/cgroup.h). Values that are
+// unlimited or unknown are -1.
+typedef struct {
+  int version;  // 2, 1 (any v1 controller) or 0
+  double cpu_quota;
+  double effective_cpu_count;
+  int64_t memory_max_Bytes;
+  int64_t memory_current_Bytes;
+  int64_t cpu_usage_ns;
+  int num_cpus;
+  int32_t* cpus;  // effective cpuset, OS cpu ids in ascending order
+} C_Cgroup;
+
+// --- Processes ---
+// Opaque handle of a sampler of a fixed set of processes (see hwinfo/process_stats.h).
+typedef struct C_ProcessSampler C_ProcessSampler;
+
+// --- Pressure ---
+// Resources of the Linux pressure stall information (see hwinfo/pressure.h).
+typedef enum {
+  C_PRESSURE_CPU = 0,
+  C_PRESSURE_MEMORY = 1,
+  C_PRESSURE_IO = 2,
+} C_PressureResource;
+
+// One line of a pressure file: the share of time (in percent) tasks stalled, averaged over 10, 60
+// and 300 s, and the cumulative stall time. Lines the kernel does not report are -1.
+typedef struct {
+  double avg10;
+  double avg60;
+  double avg300;
+  int64_t total_us;
+} C_PressureLine;
+
+typedef struct {
+  C_PressureLine some;  // at least one task stalled
+  C_PressureLine full;  // all non-idle tasks stalled at once
+} C_PressureStats;
+
+// Opaque handle of a registered kernel PSI trigger.
+typedef struct C_PressureTrigger C_PressureTrigger;
+
+// --- Interrupts ---
+// Kind of device an interrupt line was raised for (see hwinfo/interrupts.h).
+typedef enum {
+  C_INTERRUPT_OWNER_NONE = 0,
+  C_INTERRUPT_OWNER_NETWORK = 1,
+  C_INTERRUPT_OWNER_DISK = 2,
+} C_InterruptOwner;
+
+// A row of /proc/interrupts: the IRQ number (-1 for architecture interrupts such as "LOC"), the
+// name of the row, the rest of the row and the interfaces or disks that share the line.
+typedef struct {
+  int32_t irq;
+  int32_t owner;  // C_InterruptOwner
+  char* name;
+  char* description;
+  C_StringArray devices;
+} C_InterruptLine;
+
+typedef struct {
+  int count;
+  C_InterruptLine* lines;
+} C_InterruptLineArray;
+
+// Opaque handle of an interrupt sampler.
+typedef struct C_InterruptSampler C_InterruptSampler;
+
+// --- NVMe ---
+// Identity of an NVMe controller (see hwinfo/nvme.h). identified is 0 if the Identify Controller
+// command failed (it needs CAP_SYS_ADMIN) and the strings stem from sysfs; the capacities are -1
+// then.
+typedef struct {
+  char* name;
+  char* vendor;
+  char* model;
+  char* serial_number;
+  char* firmware_version;
+  int64_t total_capacity_Bytes;
+  int64_t unallocated_capacity_Bytes;
+  C_StringArray namespaces;
+  int32_t identified;
+} C_NvmeController;
+
+typedef struct {
+  int count;
+  C_NvmeController* controllers;
+} C_NvmeControllerArray;
+
+// SMART / Health log of a controller. Values that could not be read are -1, the temperature NaN.
+typedef struct {
+  int32_t critical_warning;
+  int32_t available_spare_percent;
+  int32_t available_spare_threshold_percent;
+  int32_t percentage_used;
+  double temperature_C;
+  int64_t data_read_Bytes;
+  int64_t data_written_Bytes;
+  int64_t host_read_commands;
+  int64_t host_write_commands;
+  int64_t controller_busy_minutes;
+  int64_t power_cycles;
+  int64_t power_on_hours;
+  int64_t unsafe_shutdowns;
+  int64_t media_errors;
+  int64_t error_log_entries;
+  int64_t timestamp_ns;  // steady clock time of the read, -1 if never read
+} C_NvmeHealth;
+
+// Opaque handle of an NVMe sampler.
+typedef struct C_NvmeSampler C_NvmeSampler;
+
+// --- Collector Stats ---
+// Counters of one collector (see hwinfo/stats.h), summed over all threads since the start of the
+// process or the last hwinfo_reset_stats().
+typedef struct {
+  char* name;
+  int64_t calls;
+  int64_t wall_ns;  // includes nested collectors
+  int64_t files_opened;
+  int64_t bytes_read;
+  int64_t wmi_queries;
+  int64_t allocations;
+} C_CollectorStats;
+
+typedef struct {
+  int count;
+  C_CollectorStats* collectors;
+} C_CollectorStatsArray;
+
+// --- Inventory ---
+// A binary inventory or delta (see hwinfo/inventory.h).
+typedef struct {
+  int64_t size;
+  uint8_t* data;
+} C_Bytes;
+
 
 // --- C API Functions ---
 // Note: For every 'get' function that returns a pointer, you MUST call the
 // corresponding 'free' function to avoid memory leaks.
+// Each returned pointer is a single allocation that also holds all strings and
+// string arrays it references, so the 'free' functions are O(1).
 
 // CPU
 int get_cpu_count();
 C_CPU* get_all_cpus();
+// Enumerates again (bypassing the cached list) and reads only the attributes in fields (C_FieldFlags).
+// *count receives the number of entries; the result is released with the matching free function.
+C_CPU* get_cpus_with_fields(uint32_t fields, int* count);
 double get_cpu_utilization(int cpu_id); // Overall utilization for a given CPU socket
 C_DoubleArray* get_cpu_thread_utilizations(int cpu_id);
 C_Int64Array* get_cpu_thread_speeds_mhz(int cpu_id);
+// Fill variants: write at most capacity values into caller-owned memory and return the number of
+// threads (which may exceed capacity), or -1 on error. Nothing is allocated and nothing must be freed.
+// With out == NULL and capacity == 0 they only return the number of threads; the utilizations are then
+// not sampled, so the next call still covers the period since the previous sample.
+int get_cpu_thread_utilizations_into(int cpu_id, double* out, int capacity);
+int get_cpu_thread_speeds_mhz_into(int cpu_id, int64_t* out, int capacity);
 void free_cpu_info(C_CPU* cpus, int count);
+// Canonical name of a feature bit, NULL if feature >= C_CPU_FEATURE_COUNT. Static storage, not freed.
+const char* get_cpu_feature_name(int feature);
+// Raw flag strings of a cpu, for callers that need flags without a canonical feature.
+C_StringArray* get_cpu_flags(int cpu_id);
+void free_string_array(C_StringArray* arr);
 void free_double_array(C_DoubleArray* arr);
 void free_int64_array(C_Int64Array* arr);
 
@@ -140,11 +576,18 @@ void free_os_info(C_OS* os);
 // GPU
 int get_gpu_count();
 C_GPU* get_all_gpus();
+C_GPU* get_gpus_with_fields(uint32_t fields, int* count);
 void free_gpu_info(C_GPU* gpus, int count);
 
 // Memory
 C_MemoryInfo* get_memory_info();
 void free_memory_info(C_MemoryInfo* memory_info);
+// Fill variant for polling: writes one snapshot into out and returns 0, or -1 if nothing could be read.
+int get_memory_snapshot_into(C_MemorySnapshot* out);
+// Writes the counters of at most capacity NUMA nodes, in ascending node order, into out. Returns the
+// number of nodes (so capacity 0 only counts them), or -1 if nothing could be read. The node files
+// are opened on first use and kept open.
+int get_numa_memory_into(C_NodeMemory* out, int capacity);
 
 // Mainboard
 C_MainBoard* get_mainboard_info();
@@ -153,6 +596,7 @@ void free_mainboard_info(C_MainBoard* mainboard);
 // Disk
 int get_disk_count();
 C_Disk* get_all_disks();
+C_Disk* get_disks_with_fields(uint32_t fields, int* count);
 void free_disk_info(C_Disk* disks, int count);
 
 // Battery
@@ -163,8 +607,290 @@ void free_battery_info(C_Battery* batteries, int count);
 // Network
 int get_network_count();
 C_Network* get_all_networks();
+C_Network* get_networks_with_fields(uint32_t fields, int* count);
 void free_network_info(C_Network* networks, int count);
 
+// Iterators
+// Streams the disks (component C_SNAPSHOT_DISK) or network interfaces (C_SNAPSHOT_NETWORK) one at
+// a time, reading only the attributes in fields (C_FieldFlags) like get_*_with_fields(). Items are
+// converted as they are requested, so callers can stop early and the full list never exists in C
+// form. Returns NULL for other components or on error. Not thread-safe.
+C_Iterator* hwinfo_iter_open(uint32_t component, uint32_t fields);
+// Writes the next item into *out, a C_Disk or C_Network matching the component. Its strings and
+// string arrays are owned by the iterator and stay valid until the next hwinfo_iter_next() or
+// hwinfo_iter_close(). Returns 1 if an item was written, 0 after the last one, -1 on error.
+int hwinfo_iter_next(C_Iterator* it, void* out);
+void hwinfo_iter_close(C_Iterator* it);
+
+// System Snapshot
+// Gathers all components selected by flags (C_SnapshotFlags) with a single call. The result is one
+// allocation that is released with a single free_system_snapshot() call.
+C_SystemSnapshot* get_system_snapshot(uint32_t flags);
+void free_system_snapshot(C_SystemSnapshot* snapshot);
+// Non-blocking variant: collects on the internal worker pool and returns immediately (0, or -1 if callback is NULL).
+// callback is called exactly once, on a worker thread, with the snapshot (owned by the callback, released with
+// free_system_snapshot()), or with NULL if the collection failed or did not finish within timeout_ms (0: no timeout).
+// callback must not block.
+int get_system_snapshot_async(uint32_t flags, int64_t timeout_ms, C_SnapshotCallback callback, void* user_data);
+
+// Sampler
+// Starts a background thread that samples the dynamic metrics every interval_ns into a ring buffer
+// of capacity frames. Returns NULL on error. Stop it with free_sampler().
+C_Sampler* get_sampler(int64_t interval_ns, int capacity);
+// Number of per-thread values stored for every frame.
+int get_sampler_num_threads(const C_Sampler* sampler);
+// Number of per-disk values stored for every frame.
+int get_sampler_num_disks(const C_Sampler* sampler);
+// Device names of the sampled disks, in the order of the per-disk values. Release with
+// free_string_array().
+C_StringArray* get_sampler_disk_names(const C_Sampler* sampler);
+// Number of per-interface values stored for every frame.
+int get_sampler_num_networks(const C_Sampler* sampler);
+// Writes up to max_indices interface indices (see C_Network::interfaceIndex) of the sampled
+// interfaces, in the order of the per-interface values. Returns the number of sampled interfaces,
+// or -1 on error.
+int get_sampler_network_indices(const C_Sampler* sampler, int* indices, int max_indices);
+// Number of per-GPU values stored for every frame.
+int get_sampler_num_gpus(const C_Sampler* sampler);
+// PCI addresses (see C_GPU::pciBusId) of the sampled GPUs, in the order of the per-GPU values.
+// Release with free_string_array().
+C_StringArray* get_sampler_gpu_bus_ids(const C_Sampler* sampler);
+// Frames discarded because the ring buffer was full.
+uint64_t get_sampler_dropped(const C_Sampler* sampler);
+// Moves up to max_frames frames (oldest first) into caller-owned memory and returns their number,
+// or -1 on error. The per-thread values of frame i are written at offset i * num_threads of
+// thread_utilizations and thread_speeds_mhz, the per-disk values at offset i * num_disks of
+// disk_stats, the per-interface values at offset i * num_networks of network_stats and the per-GPU
+// values at offset i * num_gpus of gpu_stats. All of them may be NULL.
+int get_sampler_frames(C_Sampler* sampler, C_MetricFrame* frames, int max_frames, double* thread_utilizations,
+                       int64_t* thread_speeds_mhz, C_DiskIOStats* disk_stats, C_NetworkIOStats* network_stats,
+                       C_GPUStats* gpu_stats);
+void free_sampler(C_Sampler* sampler);
+
+// Shared Frames
+// Like get_sampler(), but every frame is also published into the shared memory segment name (a
+// plain identifier) for get_shared_frame_reader() in other processes. Returns NULL if the segment
+// could not be created. Frames are published even while the ring buffer is full.
+C_Sampler* get_publishing_sampler(int64_t interval_ns, int capacity, const char* name);
+// Maps the segment of a publishing sampler read-only. Returns NULL if there is none. After the
+// publisher exited (get_shared_frame() returns -1), a new reader sees the segment of its
+// successor.
+C_SharedFrameReader* get_shared_frame_reader(const char* name);
+int get_shared_frame_num_threads(const C_SharedFrameReader* reader);
+int get_shared_frame_num_disks(const C_SharedFrameReader* reader);
+// Release with free_string_array().
+C_StringArray* get_shared_frame_disk_names(const C_SharedFrameReader* reader);
+int get_shared_frame_num_networks(const C_SharedFrameReader* reader);
+// Like get_sampler_network_indices().
+int get_shared_frame_network_indices(const C_SharedFrameReader* reader, int* indices, int max_indices);
+int get_shared_frame_num_gpus(const C_SharedFrameReader* reader);
+// Release with free_string_array().
+C_StringArray* get_shared_frame_gpu_bus_ids(const C_SharedFrameReader* reader);
+// Number of frames published so far (one atomic load), e.g. to skip get_shared_frame() until it
+// changes.
+uint64_t get_shared_frame_published(const C_SharedFrameReader* reader);
+// Copies the latest frame without a system call: the per-thread values into thread_utilizations
+// and thread_speeds_mhz (num_threads values each), num_disks values into disk_stats, num_networks
+// into network_stats and num_gpus into gpu_stats; all of them may be NULL. Returns 1 if frame was
+// written, 0 if nothing was published yet or the frame kept changing, -1 if the publisher exited
+// or on error. May be called concurrently.
+int get_shared_frame(const C_SharedFrameReader* reader, C_MetricFrame* frame, double* thread_utilizations,
+                     int64_t* thread_speeds_mhz, C_DiskIOStats* disk_stats, C_NetworkIOStats* network_stats,
+                     C_GPUStats* gpu_stats);
+void free_shared_frame_reader(C_SharedFrameReader* reader);
+
+// Thread Metrics
+// Reads all columns with one call. Returns NULL if not supported (only Linux) or on error.
+C_ThreadMetrics* get_thread_metrics();
+void free_thread_metrics(C_ThreadMetrics* metrics);
+
+// CPU Times
+// Writes the aggregate counters into total (may be NULL) and the counters of at most capacity
+// threads, indexed by the OS cpu id, into out. Returns the number of threads (which may exceed
+// capacity), or -1 on error. Nothing is allocated.
+int get_cpu_times_into(C_CpuTimes* total, C_CpuTimes* out, int capacity);
+// Rates of count cpus between the samples previous[i] and current[i]. previous may be NULL for the
+// rates since boot. Returns count, or -1 on error.
+int get_cpu_time_rates_into(const C_CpuTimes* previous, const C_CpuTimes* current, int count,
+                            C_CpuTimeRates* out);
+
+// Topology
+// Process wide index, read on first use. Returns NULL if the topology is unknown.
+C_Topology* get_topology();
+void free_topology(C_Topology* topology);
+
+// Device Monitor
+// The component lists are invalidated (see hwinfo_invalidate()) for every change a monitor or
+// watcher reports.
+// Starts listening for hotplug changes. Returns NULL on error.
+C_DeviceMonitor* get_device_monitor();
+// Linux: descriptor that becomes readable when changes are pending, for poll/epoll. -1 elsewhere.
+int get_device_monitor_fd(const C_DeviceMonitor* monitor);
+// Waits up to timeout_ms (0: only collect what is pending, negative: indefinitely) and returns the
+// components that changed since the previous call as C_SnapshotFlags bits, 0 if none.
+uint32_t get_device_changes(C_DeviceMonitor* monitor, int timeout_ms);
+void free_device_monitor(C_DeviceMonitor* monitor);
+// Calls callback on a background thread for every batch of hotplug changes. Returns NULL on error.
+C_DeviceWatcher* get_device_watcher(C_DeviceChangeCallback callback, void* user_data);
+// Stops the thread and waits for a running callback. Must not be called from the callback.
+void free_device_watcher(C_DeviceWatcher* watcher);
+
+// Sensors
+// Discovers the sensors once and keeps them open for reading. Returns NULL on error.
+C_SensorSampler* get_sensor_sampler();
+int get_sensor_count(const C_SensorSampler* sampler);
+// The sensors in the order of get_sensor_values(). Returns NULL on error.
+C_SensorArray* get_sensors(const C_SensorSampler* sampler);
+void free_sensor_array(C_SensorArray* sensors);
+// Reads all sensors and writes up to capacity values (in the unit of their kind, NaN if not
+// readable) to values. Power of energy counters is the mean since the previous call (NaN on the
+// first). Returns the number of sensors (so capacity 0 only counts them), -1 on error. Must not be
+// called concurrently for the same sampler.
+int get_sensor_values(C_SensorSampler* sampler, double* values, int capacity);
+void free_sensor_sampler(C_SensorSampler* sampler);
+
+// Cgroup
+// Current values of the process wide resolver. Returns NULL if the process is in no cgroup (or
+// not on Linux).
+C_Cgroup* get_cgroup();
+void free_cgroup(C_Cgroup* cgroup);
+// Process wide opt-in (off by default): cpu counts, per-thread utilisation and memory totals of the
+// cpu and memory functions are limited to the cgroup, see Cgroup::set_apply_limits().
+void hwinfo_set_cgroup_limits(int enabled);
+
+// Processes
+// Samples the given count pids. Returns NULL on error.
+C_ProcessSampler* get_process_sampler(const int64_t* pids, int count);
+int get_process_count(const C_ProcessSampler* sampler);
+// Reads all processes and writes up to capacity values per column in the order of the pids: the
+// share of the cpu time of all logical cpus ([0, 1]), the resident set size and the storage I/O
+// rates since the previous call. Any column may be NULL. Values that could not be read, and the
+// rates of the first call, are -1. Returns the number of processes (so capacity 0 only counts
+// them), -1 on error. Must not be called concurrently for the same sampler.
+int get_process_stats(C_ProcessSampler* sampler, double* cpu_utilisation, int64_t* rss_Bytes,
+                      double* read_Bytes_per_s, double* written_Bytes_per_s, int capacity);
+void free_process_sampler(C_ProcessSampler* sampler);
+
+// Pressure
+// Linux 4.20+ with CONFIG_PSI only.
+// Reads the pressure of resource (C_PressureResource) of the whole system, or with cgroup != 0 of
+// the cgroup of the process (unified hierarchy only). The file is opened on first use and kept
+// open. Returns 0, or -1 if the pressure could not be read.
+int get_pressure_into(int resource, int cgroup, C_PressureStats* out);
+// Registers a trigger that fires once the "some" (full == 0) or "full" stall time within a window
+// of window_us exceeds stall_us. The window must be between 500 ms and 10 s (multiples of 2 s for
+// unprivileged processes). Returns NULL if the trigger could not be registered.
+C_PressureTrigger* get_pressure_trigger(int resource, int cgroup, int full, int64_t stall_us,
+                                        int64_t window_us);
+// Descriptor that reports POLLPRI on an event, for poll/epoll.
+int get_pressure_trigger_fd(const C_PressureTrigger* trigger);
+// Waits up to timeout_ms (negative: indefinitely) and returns 1 on an event, 0 on timeout or after
+// hwinfo_interrupt_pressure_trigger(), -1 on error.
+int get_pressure_event(C_PressureTrigger* trigger, int timeout_ms);
+// Makes a concurrent (or the next) get_pressure_event() return 0. Callable from any thread.
+void hwinfo_interrupt_pressure_trigger(C_PressureTrigger* trigger);
+void free_pressure_trigger(C_PressureTrigger* trigger);
+
+// Interrupts
+// Linux only. Returns NULL on error.
+C_InterruptSampler* get_interrupt_sampler();
+// Reads /proc/interrupts and /proc/softirqs. Returns 1 if the lines, softirqs or cpus changed (the
+// deltas are -1 then; read the layout again), 0 if not, -1 on error. Must not be called
+// concurrently for the same sampler.
+int get_interrupt_update(C_InterruptSampler* sampler);
+// Columns of the matrices: one past the largest OS cpu id.
+int get_interrupt_num_cpus(const C_InterruptSampler* sampler);
+// The lines as of the last update, in the row order of get_interrupt_deltas(). Returns NULL on
+// error or if there are none.
+C_InterruptLineArray* get_interrupt_lines(const C_InterruptSampler* sampler);
+void free_interrupt_line_array(C_InterruptLineArray* lines);
+// The softirqs ("TIMER", "NET_RX", ...) in the row order of get_softirq_deltas(). Release with
+// free_string_array().
+C_StringArray* get_softirq_names(const C_InterruptSampler* sampler);
+// Write up to capacity values of the lines x cpus (softirqs x cpus) matrix of the last update in
+// row-major order: the count since the previous update on the cpu with the OS id of the column, -1
+// if not available. Return the number of values of the matrix, -1 on error.
+int get_interrupt_deltas(const C_InterruptSampler* sampler, int64_t* out, int capacity);
+int get_softirq_deltas(const C_InterruptSampler* sampler, int64_t* out, int capacity);
+void free_interrupt_sampler(C_InterruptSampler* sampler);
+
+// NVMe
+// Linux only. Discovers and identifies the controllers once; their health logs are read again once
+// older than refresh_ms. Returns NULL on error.
+C_NvmeSampler* get_nvme_sampler(int64_t refresh_ms);
+void hwinfo_set_nvme_refresh(C_NvmeSampler* sampler, int64_t refresh_ms);
+int get_nvme_count(const C_NvmeSampler* sampler);
+// The controllers in the order of get_nvme_health(). Returns NULL on error.
+C_NvmeControllerArray* get_nvme_controllers(const C_NvmeSampler* sampler);
+void free_nvme_controller_array(C_NvmeControllerArray* controllers);
+// Reads the logs that are older than the refresh interval and writes up to capacity entries, the
+// cached log for the others. Returns the number of controllers (so capacity 0 only counts them),
+// -1 on error. Must not be called concurrently for the same sampler.
+int get_nvme_health(C_NvmeSampler* sampler, C_NvmeHealth* out, int capacity);
+void free_nvme_sampler(C_NvmeSampler* sampler);
+
+// Filesystem root
+// Makes the Linux collectors read /proc, /sys, /dev and /etc below path, e.g. "/host" inside a
+// container that mounts the host's trees there, or a captured fixture tree ("/" for the real root,
+// the default unless HWINFO_ROOT is set). Also drops the component cache. Files that are kept open
+// for the process lifetime are bound to the root of their first use, so set the root before
+// collecting. Returns 0, or -1 if path is no directory (or not on Linux).
+int hwinfo_set_root(const char* path);
+
+// Static Cache
+// Caches the cpus, gpus, mainboard and memory modules for the current boot in directory (NULL or ""
+// for $XDG_RUNTIME_DIR), so that later processes skip their enumeration; dynamic values are still
+// read live. Also enabled by the environment variable HWINFO_STATIC_CACHE, see
+// hwinfo/static_cache.h. Returns 0, or -1 if directory is no directory.
+int hwinfo_enable_static_cache(const char* directory);
+void hwinfo_disable_static_cache();
+// Removes the cache files of the current boot.
+void hwinfo_clear_static_cache();
+
+// Collector Stats
+// Only recorded by builds with the CMake option HWINFO_TRACE (cargo feature "trace"). Returns one
+// entry per collector, NULL without HWINFO_TRACE.
+C_CollectorStatsArray* get_collector_stats();
+void free_collector_stats(C_CollectorStatsArray* stats);
+void hwinfo_reset_stats();
+// Records a Chrome trace event of every collector call until hwinfo_stop_trace() writes them to
+// path (JSON trace event format, opens in Perfetto). Both return 0, -1 without HWINFO_TRACE, if a
+// trace is already (start) or not (stop) being recorded, or if the file could not be written.
+int hwinfo_start_trace(const char* path);
+int hwinfo_stop_trace();
+
+// Inventory
+// Collects the components of flags (C_SNAPSHOT_* bits, C_SNAPSHOT_PARALLEL collects them
+// concurrently) and encodes them as binary inventory. The data is a copy that can be stored or
+// sent and read without the library (format in hwinfo/inventory.h).
+C_Bytes* get_inventory(uint32_t flags);
+// Delta that turns the inventory base into inventory, NULL if either is no valid inventory.
+C_Bytes* get_inventory_delta(const uint8_t* base, int64_t base_size, const uint8_t* inventory,
+                             int64_t size);
+// The inventory that a delta of get_inventory_delta() encodes, NULL if the delta is invalid or
+// was not computed against base.
+C_Bytes* get_inventory_from_delta(const uint8_t* base, int64_t base_size, const uint8_t* delta,
+                                  int64_t delta_size);
+void free_bytes(C_Bytes* bytes);
+
+// Component Cache
+// The cpu, gpu, disk, battery and network lists are enumerated on first use and cached process
+// wide. All functions are thread-safe. get_all_*() returns the list that the preceding
+// get_*_count() of the same thread counted. A list is enumerated again once it is older than its
+// TTL: never for cpus, gpus and batteries (their dynamic values are read on access), 1000 ms for
+// disks (free space) and networks (addresses).
+// Forces the next access to the lists of components (C_SnapshotFlags bits) to enumerate them again.
+void hwinfo_invalidate(uint32_t components);
+// Sets the TTL of the lists of components (C_SnapshotFlags bits): 0 enumerates on every access, a
+// negative TTL only after hwinfo_invalidate(). Memory, OS and mainboard are always read anew.
+void hwinfo_set_ttl(uint32_t components, int64_t ttl_ms);
+
+// WMI Limits
+// Windows only, no effect elsewhere. A WMI enumeration that takes longer than timeout_ms (default
+// 15000) ends with the objects received so far instead of blocking, and waits for a provider in
+// steps of poll_interval_ms (default 250). Values <= 0 keep the current setting.
+void hwinfo_set_wmi_timeout(int64_t timeout_ms, int64_t poll_interval_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,86 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace hwinfo {
+
+/**
+ * Handle of a string in the process wide, append-only intern pool: vendor and model names, "<unknown>" placeholders
+ * and the like are stored once (NUL terminated) no matter how many devices carry them, and a handle is a single
+ * pointer. Equal contents yield the same handle, so comparing two handles is a pointer comparison. The pool is never
+ * freed, handles and the views they return stay valid for the lifetime of the process; meant for the bounded set of
+ * strings that describe hardware, not for values that churn (interface names, addresses). Interning is thread-safe.
+ */
+class HWINFO_API InternedString {
+ public:
+  InternedString() = default;
+  // Implicit, so that the collectors assign strings to the members as before.
+  InternedString(std::string_view value);  // NOLINT(google-explicit-constructor)
+  InternedString(const std::string& value) : InternedString(std::string_view(value)) {}  // NOLINT
+  InternedString(const char* value) : InternedString(std::string_view(value)) {}         // NOLINT
+
+  HWI_NODISCARD const char* c_str() const { return _data != nullptr ? _data : ""; }
+  HWI_NODISCARD const char* data() const { return c_str(); }
+  HWI_NODISCARD size_t size() const {
+    if (_data == nullptr) {
+      return 0;
+    }
+    uint32_t size;
+    std::memcpy(&size, _data - sizeof(size), sizeof(size));
+    return size;
+  }
+  HWI_NODISCARD bool empty() const { return _data == nullptr; }
+  HWI_NODISCARD std::string_view view() const { return {c_str(), size()}; }
+  operator std::string_view() const { return view(); }  // NOLINT(google-explicit-constructor)
+  // Owned copy, for callers that need a std::string.
+  HWI_NODISCARD std::string str() const { return std::string(view()); }
+
+  friend bool operator==(InternedString a, InternedString b) { return a._data == b._data; }
+  friend bool operator!=(InternedString a, InternedString b) { return a._data != b._data; }
+  friend bool operator==(InternedString a, std::string_view b) { return a.view() == b; }
+  friend bool operator!=(InternedString a, std::string_view b) { return a.view() != b; }
+  friend bool operator==(std::string_view a, InternedString b) { return a == b.view(); }
+  friend bool operator!=(std::string_view a, InternedString b) { return a != b.view(); }
+  friend bool operator==(InternedString a, const char* b) { return a.view() == b; }
+  friend bool operator!=(InternedString a, const char* b) { return a.view() != b; }
+  friend bool operator==(InternedString a, const std::string& b) { return a.view() == b; }
+  friend bool operator!=(InternedString a, const std::string& b) { return a.view() != b; }
+  friend bool operator==(const std::string& a, InternedString b) { return a == b.view(); }
+  friend bool operator!=(const std::string& a, InternedString b) { return a != b.view(); }
+
+ private:
+  // characters in the pool, preceded by their uint32_t length; nullptr for the empty string
+  const char* _data{nullptr};
+};
+
+HWINFO_API std::ostream& operator<<(std::ostream& out, InternedString value);
+
+// Strings and bytes (including the length prefixes and padding) held by the intern pool.
+struct InternStats {
+  size_t strings{0};
+  size_t bytes{0};
+};
+HWINFO_API InternStats intern_stats();
+
+}  // namespace hwinfo
+
+namespace std {
+// equal strings share their characters in the pool, so the address identifies the content
+template <>
+struct hash<hwinfo::InternedString> {
+  size_t operator()(hwinfo::InternedString value) const noexcept {
+    return value.empty() ? 0 : std::hash<const char*>()(value.c_str());
+  }
+};
+}  // namespace std
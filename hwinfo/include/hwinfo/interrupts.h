@@ -0,0 +1,101 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+// Kind of device an interrupt line was raised for.
+enum class InterruptOwner { None, Network, Disk };
+
+struct InterruptLine {
+  // First column of /proc/interrupts: the IRQ number ("24") or the name of an architecture interrupt ("LOC", "NMI").
+  std::string name;
+  // IRQ number, -1 for architecture interrupts (whose number is not in the file).
+  int32_t irq{-1};
+  // Rest of the row: interrupt chip, hardware irq, trigger and the handlers, e.g. "PCI-MSIX-0000:00:04.0 1-edge eth0".
+  std::string description;
+  InterruptOwner owner{InterruptOwner::None};
+  // Network::description() (the interface name) or Disk::deviceName() of the devices sharing the line.
+  std::vector<std::string> devices;
+};
+
+/**
+ * Delta based sampler of the interrupts and softirqs serviced by every cpu, for tuning the IRQ affinity of NICs and
+ * storage controllers. Every update() reads /proc/interrupts and /proc/softirqs (opened once, one pread() each) into
+ * two dense row-major matrices of size() × num_cpus() and softirq_names().size() × num_cpus() counters, whose
+ * column c is the cpu with OS id c (see Topology). Cpus a file has no column for (offline) are -1. The parser reads
+ * the rows in place and does not allocate as long as the rows stay the same.
+ *
+ * The owners of the lines are resolved from the msi_irqs (and legacy irq) attributes of the PCI devices behind
+ * /sys/class/net/<interface>/device and /sys/block/<disk>/device, again whenever the lines changed. Linux only;
+ * elsewhere update() returns false.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API InterruptSampler {
+ public:
+  InterruptSampler();
+  ~InterruptSampler();
+  InterruptSampler(const InterruptSampler&) = delete;
+  InterruptSampler& operator=(const InterruptSampler&) = delete;
+
+  /**
+   * Reads the counters and replaces the deltas by the values since the previous update. After the first update, and
+   * after the lines or cpus changed (see layout_changed()), all deltas are -1.
+   * @return false if neither file could be read.
+   */
+  bool update();
+
+  // One past the largest OS cpu id of either file.
+  HWI_NODISCARD size_t num_cpus() const { return _num_cpus; }
+  HWI_NODISCARD size_t size() const { return _lines.size(); }
+  HWI_NODISCARD const std::vector<InterruptLine>& lines() const { return _lines; }
+  // Cumulative interrupts of lines()[i] on cpu c at counts()[i * num_cpus() + c]. The system wide error counters (ERR,
+  // MIS) are reported in column 0.
+  HWI_NODISCARD const int64_t* counts() const { return _counts.data(); }
+  // Interrupts since the previous update, in the layout of counts().
+  HWI_NODISCARD const int64_t* deltas() const { return _deltas.data(); }
+  // "HI", "TIMER", "NET_TX", "NET_RX", "BLOCK", ...
+  HWI_NODISCARD const std::vector<std::string>& softirq_names() const { return _softirq_names; }
+  HWI_NODISCARD const int64_t* softirq_counts() const { return _softirq_counts.data(); }
+  HWI_NODISCARD const int64_t* softirq_deltas() const { return _softirq_deltas.data(); }
+  // true if the last update() found other lines, softirqs or cpus than the previous one.
+  HWI_NODISCARD bool layout_changed() const { return _layout_changed; }
+  // Indices into lines() of the lines of a device (interface or disk name).
+  HWI_NODISCARD std::vector<size_t> lines_of(const std::string& device) const;
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Platform specific state, e.g. the opened files.
+  struct Source;
+
+  // Reads the cumulative counters into _counts and _softirq_counts (resized to the current layout, -1 where a cpu has
+  // no value) and sets _layout_changed if the lines, softirqs or cpus changed. Implemented per platform.
+  bool read_counters();
+
+  std::unique_ptr<Source> _source;
+  std::vector<InterruptLine> _lines;
+  std::vector<std::string> _softirq_names;
+  size_t _num_cpus{0};
+  std::vector<int64_t> _counts;
+  std::vector<int64_t> _previous;
+  std::vector<int64_t> _deltas;
+  std::vector<int64_t> _softirq_counts;
+  std::vector<int64_t> _softirq_previous;
+  std::vector<int64_t> _softirq_deltas;
+  int64_t _timestamp_ns{-1};
+  bool _has_baseline{false};
+  bool _layout_changed{false};
+};
+
+}  // namespace hwinfo
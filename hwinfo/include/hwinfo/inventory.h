@@ -0,0 +1,209 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hwinfo {
+
+struct SystemInfo;
+
+/**
+ * Compact binary encoding of the system information for shipping inventories, and delta encoding against a previous
+ * inventory of the same system.
+ *
+ * An inventory is a list of records (one per cpu, gpu, disk, memory module, ...), each a list of typed fields in the
+ * order of the *Field enums below. New fields are only ever appended, so readers skip fields they do not know.
+ *
+ * Format version 1, all fixed size integers little endian:
+ *   header   "HWIV", u8 version, u8 kind (0 inventory, 1 delta), u16 0, u32 size of the whole buffer,
+ *            u64 FNV-1a hash of everything behind the header (of an inventory: its own body, of a delta: the body of
+ *            the base it applies to)
+ *   strings  u32 count, u32 end offset of every string, the string bytes. Every distinct string is stored once.
+ *   records  varint count, per record: varint RecordType, varint field count, per field: u8 ValueType and its
+ *            payload: Int zigzag varint, Double 8 bytes, String and Strings varint index into the string table.
+ *
+ * A delta starts with the u64 hash of the resulting inventory and the strings that are new relative to the base
+ * (indices continue after those of the base), then the varint record count and a sequence of operations: 0 n (the
+ * next n records are those of the base), 1 (the next record is the base record with some fields replaced: varint field
+ * count, then pairs of varint number of unchanged fields, new value) or 2 (a new record, encoded in full). A delta of
+ * an unchanged system therefore is a few bytes.
+ */
+namespace inventory {
+
+constexpr uint8_t kVersion = 1;
+
+enum class RecordType : uint8_t {
+  CPU = 1,
+  OS = 2,
+  GPU = 3,
+  Memory = 4,
+  MemoryModule = 5,
+  MainBoard = 6,
+  Disk = 7,
+  Battery = 8,
+  Network = 9,
+  // results of hwinfo/bench.h
+  Bandwidth = 10,
+  Latency = 11,
+  CoreToCore = 12,
+};
+
+enum class ValueType : uint8_t {
+  Null = 0,
+  Int = 1,
+  Double = 2,
+  String = 3,
+  // list of strings, every item terminated by '\0' (see split())
+  Strings = 4,
+};
+
+// Field indices of the record types.
+enum class CPUField : uint32_t {
+  Id,
+  Vendor,
+  Model,
+  PhysicalCores,
+  LogicalCores,
+  MaxClockSpeed_MHz,
+  RegularClockSpeed_MHz,
+  L1CacheSize_Bytes,
+  L2CacheSize_Bytes,
+  L3CacheSize_Bytes,
+  Flags,
+  // FeatureSet::words()
+  Features0,
+  Features1,
+  Features2,
+  Features3,
+};
+enum class OSField : uint32_t { Name, Version, Kernel, Is32bit, Is64bit, IsLittleEndian };
+enum class GPUField : uint32_t {
+  Id,
+  Vendor,
+  Name,
+  DriverVersion,
+  Memory_Bytes,
+  Frequency_MHz,
+  NumCores,
+  VendorId,
+  DeviceId,
+  PciBusId,
+};
+enum class MemoryField : uint32_t { Total_Bytes, Free_Bytes, Available_Bytes };
+enum class MemoryModuleField : uint32_t { Id, Vendor, Name, Model, SerialNumber, Total_Bytes, Frequency_Hz };
+enum class MainBoardField : uint32_t { Vendor, Name, Version, SerialNumber };
+enum class DiskField : uint32_t { Id, Vendor, Model, SerialNumber, Size_Bytes, FreeSize_Bytes, Volumes };
+enum class BatteryField : uint32_t {
+  Id,
+  Vendor,
+  Model,
+  SerialNumber,
+  Technology,
+  EnergyFull,
+  EnergyNow,
+  Charging,
+  PowerNow,
+  VoltageNow,
+  Capacity,
+  CycleCount,
+};
+enum class NetworkField : uint32_t { InterfaceIndex, Description, Mac, IP4, IP6, IP4s, IP6s };
+// Pinned is 0 or 1, the throughputs and latencies are doubles.
+enum class BandwidthField : uint32_t {
+  Node,
+  Threads,
+  Pinned,
+  Array_Bytes,
+  Copy_Bytes_per_s,
+  Scale_Bytes_per_s,
+  Add_Bytes_per_s,
+  Triad_Bytes_per_s,
+};
+enum class LatencyField : uint32_t { Cpu, Threads, Pinned, Size_Bytes, CacheLevel, Latency_ns };
+enum class CoreToCoreField : uint32_t { CpuA, CpuB, Distance, Pinned, Latency_ns };
+
+struct Value {
+  ValueType type{ValueType::Null};
+  int64_t integer{0};
+  double real{0.0};
+  // String and Strings
+  std::string string;
+
+  bool operator==(const Value& other) const;
+  bool operator!=(const Value& other) const { return !(*this == other); }
+};
+
+struct Record {
+  RecordType type;
+  std::vector<Value> fields;
+};
+
+// The records of the collected system information, in the order of SystemInfo.
+HWINFO_API std::vector<Record> records(const SystemInfo& info);
+
+HWINFO_API std::string serialize(const std::vector<Record>& records);
+HWINFO_API std::string serialize(const SystemInfo& info);
+// Copies the records of an inventory. Returns false if data is no valid inventory.
+HWINFO_API bool deserialize(std::string_view data, std::vector<Record>& records);
+
+// Delta that turns base into inventory. Empty if either is no valid inventory.
+HWINFO_API std::string delta(std::string_view base, std::string_view inventory);
+// Applies a delta of delta() to its base. Returns false if one is invalid or the delta is not based on base.
+HWINFO_API bool apply_delta(std::string_view base, std::string_view delta, std::string& inventory);
+
+// Items of a Strings value.
+HWINFO_API std::vector<std::string_view> split(std::string_view strings);
+
+// A field as read by Reader: the string points into the inventory.
+struct FieldView {
+  ValueType type{ValueType::Null};
+  int64_t integer{0};
+  double real{0.0};
+  std::string_view string;
+};
+
+/**
+ * Zero-copy reader of an inventory, e.g. of a memory mapped file: strings are views into the data and nothing is
+ * allocated. The constructor checks the header, the size and the string table; next() and field() decode the records
+ * in order and turn valid() false if they find them malformed. The data must outlive the reader and the views.
+ */
+class HWINFO_API Reader {
+ public:
+  explicit Reader(std::string_view data);
+
+  HWI_NODISCARD bool valid() const { return _valid; }
+  HWI_NODISCARD uint32_t num_strings() const { return _num_strings; }
+  // Empty if index is out of range.
+  HWI_NODISCARD std::string_view string(uint32_t index) const;
+  HWI_NODISCARD uint32_t num_records() const { return _num_records; }
+
+  // Moves to the next record (skipping the unread fields of the current one). False at the end or on malformed data.
+  bool next(RecordType& type, uint32_t& num_fields);
+  // Reads the next field of the current record. False after its last field or on malformed data.
+  bool field(FieldView& field);
+
+ private:
+  bool skip_fields();
+
+  std::string_view _data;
+  bool _valid{false};
+  uint32_t _num_strings{0};
+  // u32 end offsets of the strings and the start of their bytes
+  const char* _string_ends{nullptr};
+  const char* _string_data{nullptr};
+  uint32_t _num_records{0};
+  uint32_t _record{0};
+  uint32_t _fields_left{0};
+  size_t _pos{0};
+};
+
+}  // namespace inventory
+}  // namespace hwinfo
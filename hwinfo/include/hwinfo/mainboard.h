@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <hwinfo/interned_string.h>
 #include <hwinfo/platform.h>
+#include <hwinfo/static_cache.h>
 
 #include <string>
 
@@ -11,21 +13,22 @@ namespace hwinfo {
 
 class HWINFO_API MainBoard {
   friend std::string get_dmi_by_name(const std::string& name);
+  friend struct static_cache::Access;
 
  public:
   MainBoard();
   ~MainBoard() = default;
 
-  HWI_NODISCARD const std::string& vendor() const;
-  HWI_NODISCARD const std::string& name() const;
-  HWI_NODISCARD const std::string& version() const;
-  HWI_NODISCARD const std::string& serialNumber() const;
+  HWI_NODISCARD InternedString vendor() const;
+  HWI_NODISCARD InternedString name() const;
+  HWI_NODISCARD InternedString version() const;
+  HWI_NODISCARD InternedString serialNumber() const;
 
  private:
-  std::string _vendor;
-  std::string _name;
-  std::string _version;
-  std::string _serialNumber;
+  InternedString _vendor;
+  InternedString _name;
+  InternedString _version;
+  InternedString _serialNumber;
 };
 
 }  // namespace hwinfo
@@ -1,14 +1,18 @@
 #pragma once
 
+#include <hwinfo/fields.h>
 #include <hwinfo/platform.h>
 
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace hwinfo {
 
 class HWINFO_API Network {
-  friend std::vector<Network> getAllNetworks();
+  friend std::vector<Network> getAllNetworks(NetworkFields fields);
+  friend class NetworkEnumerator;
 
  public:
   ~Network() = default;
@@ -18,6 +22,10 @@ class HWINFO_API Network {
   HWI_NODISCARD const std::string& mac() const;
   HWI_NODISCARD const std::string& ip4() const;
   HWI_NODISCARD const std::string& ip6() const;
+  // All addresses of the interface, in the order the OS reports them. ip4() is the first of ip4s(), ip6() the
+  // link-local one (or the first) of ip6s().
+  HWI_NODISCARD const std::vector<std::string>& ip4s() const;
+  HWI_NODISCARD const std::vector<std::string>& ip6s() const;
 
  private:
   Network() = default;
@@ -27,8 +35,34 @@ class HWINFO_API Network {
   std::string _mac;
   std::string _ip4;
   std::string _ip6;
+  std::vector<std::string> _ip4s;
+  std::vector<std::string> _ip6s;
+};
+
+/**
+ * Streams the interfaces of getAllNetworks(fields) one at a time, so callers can filter and stop early without the
+ * whole list being built. On Linux the interfaces are taken one by one from the netlink dump of the constructor (the
+ * dump is all getifaddrs() offers); other platforms enumerate eagerly and hand out the list item by item. Not
+ * thread-safe.
+ */
+class HWINFO_API NetworkEnumerator {
+ public:
+  explicit NetworkEnumerator(NetworkFields fields = NetworkFields::All);
+  ~NetworkEnumerator();
+  NetworkEnumerator(const NetworkEnumerator&) = delete;
+  NetworkEnumerator& operator=(const NetworkEnumerator&) = delete;
+
+  // The next interface, std::nullopt after the last one.
+  std::optional<Network> next();
+
+ private:
+  struct Source;
+
+  std::unique_ptr<Source> _source;
 };
 
 std::vector<Network> getAllNetworks();
+// Reads only the requested attributes, see hwinfo/fields.h.
+std::vector<Network> getAllNetworks(NetworkFields fields);
 
 }  // namespace hwinfo
\ No newline at end of file
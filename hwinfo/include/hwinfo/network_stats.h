@@ -0,0 +1,91 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Traffic of one network interface over the period between two NetworkStatsSampler updates. The layout is fixed (no
+ * pointers) so that arrays of it can be copied as a block, e.g. across the C API. Values that are not available are -1.
+ */
+struct NetworkIOStats {
+  double rx_Bytes_per_s{-1.0};
+  double tx_Bytes_per_s{-1.0};
+  double rx_packets_per_s{-1.0};
+  double tx_packets_per_s{-1.0};
+  double rx_errors_per_s{-1.0};
+  double tx_errors_per_s{-1.0};
+  // Packets dropped by the host (e.g. full queues), not by the network.
+  double rx_drops_per_s{-1.0};
+  double tx_drops_per_s{-1.0};
+};
+
+/**
+ * Delta based network traffic sampler. Every update() reads the cumulative counters of all interfaces with a single
+ * request (Linux: one pread of /proc/net/dev on a descriptor opened once; Windows: GetIfTable2; macOS: the
+ * NET_RT_IFLIST2 sysctl) and computes the rates since the previous update(), independently of the number of
+ * interfaces.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API NetworkStatsSampler {
+ public:
+  // Samples the interfaces of getAllNetworks(), in that order.
+  NetworkStatsSampler();
+  // Samples the given interfaces (the OS interface index, see Network::interfaceIndex()).
+  explicit NetworkStatsSampler(std::vector<int> interface_indices);
+  ~NetworkStatsSampler();
+  NetworkStatsSampler(const NetworkStatsSampler&) = delete;
+  NetworkStatsSampler& operator=(const NetworkStatsSampler&) = delete;
+
+  /**
+   * Reads the counters and replaces stats() by the rates since the previous update. After the first update (which
+   * only records the baseline) and for interfaces whose counters could not be read, all stats are -1.
+   * @return false if no counters could be read.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _interface_indices.size(); }
+  HWI_NODISCARD const std::vector<int>& interface_indices() const { return _interface_indices; }
+  // size() entries, in the order of interface_indices().
+  HWI_NODISCARD const NetworkIOStats* stats() const { return _stats.data(); }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Cumulative counters of one interface, -1 if the platform does not report them.
+  struct Counters {
+    int64_t rx_Bytes{-1};
+    int64_t tx_Bytes{-1};
+    int64_t rx_packets{-1};
+    int64_t tx_packets{-1};
+    int64_t rx_errors{-1};
+    int64_t tx_errors{-1};
+    int64_t rx_drops{-1};
+    int64_t tx_drops{-1};
+  };
+  // Platform specific state, e.g. opened files or buffers.
+  struct Source;
+
+  // Reads the counters of all interfaces into _current (one entry per interface, already sized). Implemented per
+  // platform.
+  bool read_counters();
+
+  std::vector<int> _interface_indices;
+  std::unique_ptr<Source> _source;
+  std::vector<Counters> _previous;
+  std::vector<Counters> _current;
+  std::vector<NetworkIOStats> _stats;
+  int64_t _timestamp_ns{-1};
+  bool _has_baseline{false};
+};
+
+}  // namespace hwinfo
@@ -0,0 +1,119 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/interned_string.h>
+#include <hwinfo/platform.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+// Identity of an NVMe controller, see NvmeSampler.
+struct NvmeController {
+  // Name of the controller ("nvme0"), its character device is /dev/<name>.
+  std::string name;
+  // PCI vendor id ("0x144d"), in the format of Disk::vendor().
+  InternedString vendor;
+  InternedString model;
+  InternedString serial_number;
+  InternedString firmware_version;
+  // Total and unallocated NVM capacity (TNVMCAP, UNVMCAP), -1 if not reported or the controller was not identified.
+  int64_t total_capacity_Bytes{-1};
+  int64_t unallocated_capacity_Bytes{-1};
+  // Block devices of the namespaces behind the controller (Disk::deviceName(), "nvme0n1"; with native multipath the
+  // per-path devices, "nvme0c0n1").
+  std::vector<std::string> namespaces;
+  // true if the values stem from an Identify Controller command, false if only the sysfs attributes were readable.
+  bool identified{false};
+};
+
+/**
+ * SMART / Health Information log (log page 0x02) of a controller. The layout is fixed (no pointers) so that arrays of
+ * it can be copied as a block, e.g. across the C API. Values that are not available are -1, the temperature NaN. The
+ * 128 bit counters of the log saturate at INT64_MAX.
+ */
+struct NvmeHealth {
+  // Bits: 0 spare below threshold, 1 temperature out of range, 2 reliability degraded, 3 read-only, 4 volatile memory
+  // backup failed, 5 persistent memory region read-only.
+  int32_t critical_warning{-1};
+  int32_t available_spare_percent{-1};
+  int32_t available_spare_threshold_percent{-1};
+  // Vendor estimate of the life used, may exceed 100.
+  int32_t percentage_used{-1};
+  // Composite temperature.
+  double temperature_C{std::numeric_limits<double>::quiet_NaN()};
+  // Data units (1000 blocks of 512 bytes) read and written by the host.
+  int64_t data_read_Bytes{-1};
+  int64_t data_written_Bytes{-1};
+  int64_t host_read_commands{-1};
+  int64_t host_write_commands{-1};
+  int64_t controller_busy_minutes{-1};
+  int64_t power_cycles{-1};
+  int64_t power_on_hours{-1};
+  int64_t unsafe_shutdowns{-1};
+  // Unrecovered data integrity errors.
+  int64_t media_errors{-1};
+  int64_t error_log_entries{-1};
+  // std::chrono::steady_clock time the log was read, -1 if it could not be read yet.
+  int64_t timestamp_ns{-1};
+};
+
+/**
+ * NVMe controllers and their health, for tracking the wear of drives. The controllers of /sys/class/nvme are
+ * discovered once when the sampler is constructed: their character devices are opened and kept open, and one Identify
+ * Controller admin command (NVME_IOCTL_ADMIN_CMD) per controller reads model, serial number, firmware and capacity.
+ * Controllers that cannot be identified (the admin commands need CAP_SYS_ADMIN) are described by their sysfs
+ * attributes.
+ *
+ * update() reads the SMART / Health log of every controller whose log is older than the refresh interval, so health()
+ * is a per-controller cache: controllers update the log about once a minute, and polling faster only costs admin
+ * commands. A failed read is retried after the same interval. Linux only; elsewhere there are no controllers.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API NvmeSampler {
+ public:
+  explicit NvmeSampler(std::chrono::nanoseconds refresh = std::chrono::seconds(60));
+  ~NvmeSampler();
+  NvmeSampler(const NvmeSampler&) = delete;
+  NvmeSampler& operator=(const NvmeSampler&) = delete;
+
+  /**
+   * Reads the health logs that are older than refresh() (all of them on the first call).
+   * @return false if the log of no controller could be read (yet).
+   */
+  bool update();
+
+  HWI_NODISCARD std::chrono::nanoseconds refresh() const { return _refresh; }
+  // Takes effect with the next update(); zero reads every log on every update().
+  void set_refresh(std::chrono::nanoseconds refresh) { _refresh = refresh; }
+
+  HWI_NODISCARD size_t size() const { return _controllers.size(); }
+  HWI_NODISCARD const std::vector<NvmeController>& controllers() const { return _controllers; }
+  // size() entries, in the order of controllers().
+  HWI_NODISCARD const NvmeHealth* health() const { return _health.data(); }
+
+ private:
+  // Platform specific state, e.g. the opened character devices.
+  struct Source;
+
+  // Reads the health log of controller i into health. Implemented per platform.
+  bool read_health(size_t i, NvmeHealth& health);
+
+  std::chrono::nanoseconds _refresh;
+  std::unique_ptr<Source> _source;
+  std::vector<NvmeController> _controllers;
+  std::vector<NvmeHealth> _health;
+  // steady_clock time of the last read attempt per controller, successful or not
+  std::vector<int64_t> _attempt_ns;
+};
+
+}  // namespace hwinfo
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <hwinfo/interned_string.h>
 #include <hwinfo/platform.h>
 
 #include <string>
@@ -14,18 +15,18 @@ class HWINFO_API OS {
   OS();
   ~OS() = default;
 
-  HWI_NODISCARD std::string name() const;
-  HWI_NODISCARD std::string version() const;
-  HWI_NODISCARD std::string kernel() const;
+  HWI_NODISCARD InternedString name() const;
+  HWI_NODISCARD InternedString version() const;
+  HWI_NODISCARD InternedString kernel() const;
   HWI_NODISCARD bool is32bit() const;
   HWI_NODISCARD bool is64bit() const;
   HWI_NODISCARD bool isBigEndian() const;
   HWI_NODISCARD bool isLittleEndian() const;
 
  private:
-  std::string _name;
-  std::string _version;
-  std::string _kernel;
+  InternedString _name;
+  InternedString _version;
+  InternedString _kernel;
   bool _32bit = false;
   bool _64bit = false;
   bool _bigEndian = false;
@@ -0,0 +1,104 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace hwinfo {
+
+// Resources tracked by the Linux pressure stall information (PSI).
+enum class PressureResource { CPU, Memory, IO };
+
+// One line of a pressure file.
+struct PressureLine {
+  // Share of wall time (in percent) in which tasks stalled on the resource, averaged over 10, 60 and 300 seconds.
+  double avg10{-1.0};
+  double avg60{-1.0};
+  double avg300{-1.0};
+  // Cumulative stall time.
+  int64_t total_us{-1};
+};
+
+struct PressureStats {
+  // At least one task stalled.
+  PressureLine some{};
+  // All non-idle tasks stalled at once. The cpu of the whole system reports zeros (and nothing before Linux 5.13).
+  PressureLine full{};
+};
+
+/**
+ * Pressure stall information of a resource (/proc/pressure/<resource>), or of the cgroup of the calling process
+ * (<resource>.pressure of the unified hierarchy, see Cgroup). The file is opened once and re-read with one pread() per
+ * read(), which is thread-safe. Linux 4.20+ with CONFIG_PSI only; otherwise valid() is false.
+ */
+class HWINFO_API Pressure {
+ public:
+  explicit Pressure(PressureResource resource);
+  ~Pressure();
+  Pressure(Pressure&& other) noexcept;
+  Pressure& operator=(Pressure&& other) noexcept;
+
+  // Pressure of the cgroup of Cgroup::get(). Invalid for cgroup v1.
+  static Pressure cgroup(PressureResource resource);
+
+  HWI_NODISCARD bool valid() const;
+  // false if the file could not be read or parsed. Lines the kernel does not report are left at -1.
+  bool read(PressureStats& stats) const;
+
+ private:
+  Pressure() = default;
+
+  // Platform specific state, the opened file.
+  struct Source;
+  std::unique_ptr<Source> _source;
+};
+
+/**
+ * Kernel PSI trigger: the kernel wakes the waiter once the stall time of a window exceeds a threshold, e.g. "some 150ms
+ * within 1s", instead of the consumer polling the averages. At most one event is reported per window.
+ *
+ * The window must be between 500ms and 10s; unprivileged processes may only use multiples of 2s (since Linux 6.5).
+ * wait() is meant for one waiting thread, interrupt() may be called from any thread.
+ */
+class HWINFO_API PressureTrigger {
+ public:
+  enum class Kind { Some, Full };
+
+  PressureTrigger(PressureResource resource, Kind kind, std::chrono::microseconds stall,
+                  std::chrono::microseconds window);
+  ~PressureTrigger();
+  PressureTrigger(PressureTrigger&& other) noexcept;
+  PressureTrigger& operator=(PressureTrigger&& other) noexcept;
+
+  // Trigger on the pressure of the cgroup of Cgroup::get().
+  static PressureTrigger cgroup(PressureResource resource, Kind kind, std::chrono::microseconds stall,
+                                std::chrono::microseconds window);
+
+  // false if the trigger could not be registered (no PSI, invalid window, not permitted).
+  HWI_NODISCARD bool valid() const;
+  // Descriptor that reports POLLPRI on an event, for the consumer's own poll/epoll loop. -1 if not valid().
+  HWI_NODISCARD int fd() const;
+
+  /**
+   * Waits up to timeout (indefinitely if negative) for an event.
+   * @return true on an event, false on timeout, after interrupt() and if the monitored cgroup was removed
+   */
+  bool wait(std::chrono::milliseconds timeout);
+  // Makes a concurrent (or the next) wait() return early.
+  void interrupt();
+
+ private:
+  PressureTrigger() = default;
+
+  // Platform specific state: the trigger descriptor and the wakeup of interrupt().
+  struct Source;
+  std::unique_ptr<Source> _source;
+};
+
+}  // namespace hwinfo
@@ -0,0 +1,88 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/cpu.h>
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Delta based sampler of the resource usage of a fixed set of processes, in structure-of-arrays layout: every metric is
+ * a contiguous column indexed like pids(). Every update() reads the cumulative counters of all watched processes:
+ *  - Linux: /proc/<pid>/stat, statm and io, opened once per process and re-read with one pread() each. A descriptor
+ *    keeps referring to the process it was opened for, so a recycled pid is never attributed to the old process.
+ *  - macOS: proc_pid_rusage(RUSAGE_INFO_V2) per process.
+ *  - Windows: one NtQuerySystemInformation(SystemProcessInformation) call for all processes.
+ * and, in the same update, the cpu time of the whole system (utils::read_jiffies), so that the per-process cpu share
+ * and UtilisationSample::total cover the same period and the same clock.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API ProcessSampler {
+ public:
+  explicit ProcessSampler(std::vector<int64_t> pids);
+  ~ProcessSampler();
+  ProcessSampler(const ProcessSampler&) = delete;
+  ProcessSampler& operator=(const ProcessSampler&) = delete;
+
+  /**
+   * Reads the counters and replaces the columns by the values since the previous update. After the first update (which
+   * only records the baseline) all rates are -1, as are all values of processes that exited or cannot be inspected
+   * (e.g. /proc/<pid>/io of other users' processes).
+   * @return false if no process could be read.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _pids.size(); }
+  HWI_NODISCARD const std::vector<int64_t>& pids() const { return _pids; }
+  // Share of the cpu time of all logical cpus ([0, 1]). Summed over all processes of the system it is the utilisation
+  // of the system, multiplied by the number of cpus it is the number of cpus the process kept busy.
+  HWI_NODISCARD const double* cpu_utilisation() const { return _cpu_utilisation.data(); }
+  // Resident set size at the time of the update.
+  HWI_NODISCARD const int64_t* rss_Bytes() const { return _rss_Bytes.data(); }
+  // Storage I/O of the process (Linux: read_bytes/write_bytes of /proc/<pid>/io, Windows: all I/O transfers).
+  HWI_NODISCARD const double* read_Bytes_per_s() const { return _read_Bytes_per_s.data(); }
+  HWI_NODISCARD const double* written_Bytes_per_s() const { return _written_Bytes_per_s.data(); }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Cumulative counters of one process, -1 if they could not be read.
+  struct Counters {
+    int64_t cpu_time_ns{-1};
+    int64_t rss_Bytes{-1};
+    int64_t read_Bytes{-1};
+    int64_t written_Bytes{-1};
+  };
+  // Platform specific state, e.g. the opened files.
+  struct Source;
+
+  // Reads the counters of all processes into _current (one entry per process, already reset). Implemented per platform.
+  bool read_counters();
+
+  std::vector<int64_t> _pids;
+  std::unique_ptr<Source> _source;
+  // duration of one unit of the utils::read_jiffies() counters, set by the platform constructor
+  double _jiffy_ns{-1.0};
+  Jiffies _previous_total{};
+  Jiffies _current_total{};
+  // per-thread jiffies of the system, only kept to reuse the buffer
+  std::vector<Jiffies> _threads;
+  std::vector<Counters> _previous;
+  std::vector<Counters> _current;
+  std::vector<double> _cpu_utilisation;
+  std::vector<int64_t> _rss_Bytes;
+  std::vector<double> _read_Bytes_per_s;
+  std::vector<double> _written_Bytes_per_s;
+  int64_t _timestamp_ns{-1};
+  bool _has_baseline{false};
+};
+
+}  // namespace hwinfo
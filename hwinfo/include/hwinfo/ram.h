@@ -3,22 +3,126 @@
 
 #pragma once
 
+#include <hwinfo/interned_string.h>
 #include <hwinfo/platform.h>
+#include <hwinfo/static_cache.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace hwinfo {
 
+/**
+ * System memory counters taken in a single read (on Linux one pread of /proc/meminfo), so all values belong to the
+ * same instant. Values that are not available on the platform are -1. The HugePages_* entries are page counts, every
+ * other value is in bytes.
+ */
+struct HWINFO_API MemorySnapshot {
+  // std::chrono::steady_clock time of the last update().
+  int64_t timestamp_ns{-1};
+  int64_t total_Bytes{-1};
+  // Windows: the zeroed and free page lists, -1 unless the process holds SeProfileSingleProcessPrivilege.
+  int64_t free_Bytes{-1};
+  int64_t available_Bytes{-1};
+  int64_t buffers_Bytes{-1};
+  int64_t cached_Bytes{-1};
+  int64_t shmem_Bytes{-1};
+  int64_t dirty_Bytes{-1};
+  int64_t writeback_Bytes{-1};
+  int64_t swap_total_Bytes{-1};
+  int64_t swap_free_Bytes{-1};
+  int64_t hugepages_total{-1};
+  int64_t hugepages_free{-1};
+  int64_t hugepages_reserved{-1};
+  int64_t hugepages_surplus{-1};
+  int64_t hugepage_size_Bytes{-1};
+
+  /**
+   * Re-reads all counters. Does not allocate after the first call of a thread, so it can be polled at a high rate.
+   * @return false if nothing could be read; the values are -1 then.
+   */
+  bool update();
+};
+
+/**
+ * Memory of one NUMA node. Values that are not available on the platform are -1. Sizes are in bytes, the HugePages_*
+ * entries and the allocation counters are page counts (the latter since boot).
+ */
+struct NodeMemory {
+  // OS node id, as used by Topology::node() and numactl.
+  int32_t node{-1};
+  int64_t total_Bytes{-1};
+  int64_t free_Bytes{-1};
+  int64_t used_Bytes{-1};
+  int64_t file_Bytes{-1};
+  int64_t anon_Bytes{-1};
+  int64_t hugepages_total{-1};
+  int64_t hugepages_free{-1};
+  // numastat: allocations that were served from this node as intended (hit), served from this node although another
+  // node was preferred (miss), or served from another node although this node was preferred (foreign). A growing
+  // numa_miss/numa_foreign is memory that is remote to the cpus that use it.
+  int64_t numa_hit{-1};
+  int64_t numa_miss{-1};
+  int64_t numa_foreign{-1};
+  int64_t interleave_hit{-1};
+  // Allocations on this node by a process running on this node (local) or on another node (other).
+  int64_t local_node{-1};
+  int64_t other_node{-1};
+  // vmstat: pages migrated to this node by NUMA balancing / memory tiering (promoted) and demoted from it.
+  int64_t promoted_pages{-1};
+  int64_t demoted_pages{-1};
+};
+
+/**
+ * Per-node memory counters. The nodes are discovered once; every update() reads all of them:
+ *  - Linux: meminfo, numastat and vmstat of /sys/devices/system/node/node<N>, opened once and re-read with one pread()
+ *    each, like MemorySnapshot reads /proc/meminfo.
+ *  - Windows: GetNumaAvailableMemoryNodeEx (free memory only).
+ *  - macOS: one node with the values of MemorySnapshot.
+ * The cpus local to a node are Topology::get().cpus_of_node(node). A sampler must not be used by multiple threads
+ * concurrently.
+ */
+class HWINFO_API NumaMemorySampler {
+ public:
+  NumaMemorySampler();
+  ~NumaMemorySampler();
+  NumaMemorySampler(const NumaMemorySampler&) = delete;
+  NumaMemorySampler& operator=(const NumaMemorySampler&) = delete;
+
+  /**
+   * Re-reads the counters of all nodes. Does not allocate.
+   * @return false if no node could be read.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _nodes.size(); }
+  // One entry per node in ascending node order, as of the last update().
+  HWI_NODISCARD const std::vector<NodeMemory>& nodes() const { return _nodes; }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Platform specific state, e.g. the opened files.
+  struct Source;
+
+  std::unique_ptr<Source> _source;
+  std::vector<NodeMemory> _nodes;
+  int64_t _timestamp_ns{-1};
+};
+
 class HWINFO_API Memory {
+  friend struct static_cache::Access;
+
  public:
   struct Module {
     int id;
-    std::string vendor;
-    std::string name;
-    std::string model;
-    std::string serial_number;
+    InternedString vendor;
+    InternedString name;
+    InternedString model;
+    InternedString serial_number;
     int64_t total_Bytes;
     int64_t frequency_Hz;
   };
@@ -31,6 +135,8 @@ class HWINFO_API Memory {
   HWI_NODISCARD int64_t total_Bytes() const;
   HWI_NODISCARD int64_t free_Bytes() const;
   HWI_NODISCARD int64_t available_Bytes() const;
+  // All counters of one read, free_Bytes() and available_Bytes() each take a snapshot of their own.
+  HWI_NODISCARD MemorySnapshot snapshot() const;
 
  private:
   std::vector<Memory::Module> _modules;
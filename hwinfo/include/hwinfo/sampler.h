@@ -0,0 +1,191 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/battery.h>
+#include <hwinfo/cpu.h>
+#include <hwinfo/disk_stats.h>
+#include <hwinfo/frequency_stats.h>
+#include <hwinfo/gpu_stats.h>
+#include <hwinfo/network_stats.h>
+#include <hwinfo/platform.h>
+#include <hwinfo/ram.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hwinfo {
+
+class SharedFramePublisher;
+
+/**
+ * Dynamic metrics read by one Sampler tick. The layout is fixed (no pointers) so that frames can be copied as a block,
+ * e.g. across the C API. Per-thread values are not part of the frame, see Sampler::drain(). Values that could not be
+ * read are -1.
+ */
+struct MetricFrame {
+  // Number of the tick that produced this frame, starting at 0. Gaps indicate dropped frames.
+  uint64_t sequence{0};
+  // std::chrono::steady_clock time at the start of the tick.
+  int64_t timestamp_ns{-1};
+  // Time covered by the utilisation values (since the previous tick).
+  int64_t period_ns{-1};
+  double cpu_utilisation{-1.0};
+  int64_t memory_free_Bytes{-1};
+  int64_t memory_available_Bytes{-1};
+  // Sum over all batteries.
+  int64_t battery_energy_now{-1};
+  // 1 if any battery is charging, 0 if none is, -1 without batteries.
+  int32_t battery_charging{-1};
+  // Number of per-thread values stored along with this frame (Sampler::num_threads()).
+  int32_t num_threads{0};
+  // Number of per-disk values stored along with this frame (Sampler::num_disks()).
+  int32_t num_disks{0};
+  // Number of per-interface values stored along with this frame (Sampler::num_networks()).
+  int32_t num_networks{0};
+  // Number of per-GPU values stored along with this frame (Sampler::num_gpus()).
+  int32_t num_gpus{0};
+};
+
+/**
+ * Background sampler of the dynamic metrics (cpu utilisation, per-thread utilisation and clock speed, free memory and
+ * battery charge, per-disk I/O rates, per-interface network traffic, per-GPU telemetry).
+ *
+ * One thread reads all metrics at a fixed interval and writes a MetricFrame per tick into a bounded single producer
+ * ring buffer. Ticks are scheduled on absolute deadlines, so wake-up jitter does not accumulate into drift; a tick that
+ * overran its deadline is not made up for. Only the sampler thread reads the metrics, so the persistent file descriptors
+ * (sysfs, /proc) and sampling buffers are shared by all consumers instead of being reopened by every polling loop. If
+ * consumers do not drain quickly enough, new frames are dropped (and counted in dropped()) instead of overwriting frames
+ * that are being read.
+ *
+ * The per-thread values are those of the first cpu returned by getAllCPUs(). The per-thread clock speed is the
+ * effective clock while not halted (FrequencyStats::busy_MHz) where the cycle counters can be read, the clock of the
+ * cpufreq governor (CPU::currentClockSpeed_MHz()) otherwise.
+ *
+ * Constructed with a segment name, the sampler also publishes every frame into shared memory (SharedFramePublisher),
+ * from which the other processes of the host read the latest frame with a SharedFrameReader. Frames are published
+ * even while the ring buffer is full, so a process that only publishes does not need to drain.
+ *
+ * drain() may be called from any number of threads; concurrent calls are serialized.
+ */
+class HWINFO_API Sampler {
+ public:
+  /**
+   * Starts the sampler thread. The first frame is taken one interval after construction.
+   *
+   * @param interval time between two ticks
+   * @param capacity number of frames the ring buffer holds (rounded up to a power of two, at least 2)
+   */
+  explicit Sampler(std::chrono::nanoseconds interval, size_t capacity = 1024);
+  /**
+   * Starts the sampler thread and publishes every frame into the shared memory segment shared_name. If the segment
+   * cannot be created the sampler runs without publishing, see publishing().
+   */
+  Sampler(std::chrono::nanoseconds interval, size_t capacity, const std::string& shared_name);
+  // Stops the sampler thread. Frames that were not drained are discarded.
+  ~Sampler();
+
+  Sampler(const Sampler&) = delete;
+  Sampler& operator=(const Sampler&) = delete;
+
+  // Stops sampling; frames remaining in the buffer can still be drained. Idempotent.
+  void stop();
+  HWI_NODISCARD bool running() const;
+  // true if the frames are published into a shared memory segment.
+  HWI_NODISCARD bool publishing() const;
+
+  // Number of per-thread values stored for every frame. Fixed for the lifetime of the sampler.
+  HWI_NODISCARD int num_threads() const { return _num_threads; }
+  // Number of per-disk values stored for every frame, in the order of disk_names(). Fixed for the lifetime of the
+  // sampler.
+  HWI_NODISCARD int num_disks() const { return _num_disks; }
+  HWI_NODISCARD const std::vector<std::string>& disk_names() const { return _disks.device_names(); }
+  // Number of per-interface values stored for every frame, in the order of network_indices(). Fixed for the lifetime
+  // of the sampler.
+  HWI_NODISCARD int num_networks() const { return _num_networks; }
+  HWI_NODISCARD const std::vector<int>& network_indices() const { return _networks.interface_indices(); }
+  // Number of per-GPU values stored for every frame, in the order of gpu_pci_bus_ids(). Fixed for the lifetime of the
+  // sampler.
+  HWI_NODISCARD int num_gpus() const { return _num_gpus; }
+  HWI_NODISCARD const std::vector<std::string>& gpu_pci_bus_ids() const { return _gpus.pci_bus_ids(); }
+  HWI_NODISCARD size_t capacity() const { return _capacity; }
+  HWI_NODISCARD std::chrono::nanoseconds interval() const { return _interval; }
+  // Frames that were discarded because the ring buffer was full.
+  HWI_NODISCARD uint64_t dropped() const;
+
+  /**
+   * Moves up to max_frames frames (oldest first) out of the ring buffer.
+   *
+   * The per-thread values of frame i are written to thread_utilisation[i * num_threads()] and
+   * thread_speed_MHz[i * num_threads()], so both arrays need room for max_frames * num_threads() values. Either may be
+   * nullptr if the values are not needed. Likewise, the disk values of frame i are written to
+   * disk_stats[i * num_disks()], the network values to network_stats[i * num_networks()] and the GPU values to
+   * gpu_stats[i * num_gpus()].
+   *
+   * @return the number of frames written
+   */
+  size_t drain(MetricFrame* frames, size_t max_frames, double* thread_utilisation = nullptr,
+               int64_t* thread_speed_MHz = nullptr, DiskIOStats* disk_stats = nullptr,
+               NetworkIOStats* network_stats = nullptr, GPUStats* gpu_stats = nullptr);
+  // Appends all buffered frames (and their per-thread, per-disk, per-interface and per-GPU values) to the vectors and
+  // returns their number.
+  size_t drain(std::vector<MetricFrame>& frames, std::vector<double>* thread_utilisation = nullptr,
+               std::vector<int64_t>* thread_speed_MHz = nullptr, std::vector<DiskIOStats>* disk_stats = nullptr,
+               std::vector<NetworkIOStats>* network_stats = nullptr, std::vector<GPUStats>* gpu_stats = nullptr);
+
+ private:
+  void start(const std::string& shared_name);
+  void run();
+  void tick(size_t slot, std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration period);
+
+  std::chrono::nanoseconds _interval;
+  size_t _capacity;
+  int _num_threads{0};
+  int _num_disks{0};
+  int _num_networks{0};
+  int _num_gpus{0};
+
+  // only used by the sampler thread once it was started
+  std::optional<CPU> _cpu;
+  MemorySnapshot _memory;
+  std::vector<Battery> _batteries;
+  FrequencySampler _frequencies;
+  DiskStatsSampler _disks;
+  NetworkStatsSampler _networks;
+  GPUStatsSampler _gpus;
+  std::unique_ptr<SharedFramePublisher> _publisher;
+
+  // ring buffer: slot i holds _frames[i], _thread_utilisation/_thread_speed_MHz [i * _num_threads, ...) and
+  // _disk_stats [i * _num_disks, ...), _network_stats [i * _num_networks, ...) and _gpu_stats [i * _num_gpus, ...).
+  // While publishing, slot _capacity holds the frames that are published but dropped from the full ring buffer.
+  std::vector<MetricFrame> _frames;
+  std::vector<double> _thread_utilisation;
+  std::vector<int64_t> _thread_speed_MHz;
+  std::vector<DiskIOStats> _disk_stats;
+  std::vector<NetworkIOStats> _network_stats;
+  std::vector<GPUStats> _gpu_stats;
+  // _head is only written by consumers (under _drain_mutex), _tail only by the sampler thread
+  alignas(64) std::atomic<uint64_t> _head{0};
+  alignas(64) std::atomic<uint64_t> _tail{0};
+  alignas(64) std::atomic<uint64_t> _dropped{0};
+  std::mutex _drain_mutex;
+
+  std::mutex _stop_mutex;
+  std::condition_variable _stop_cv;
+  bool _stop{false};
+  std::atomic<bool> _running{false};
+  std::once_flag _join_once;
+  std::thread _thread;
+};
+
+}  // namespace hwinfo
@@ -0,0 +1,86 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+// Physical quantity of a sensor and the unit of its values.
+enum class SensorKind : int32_t {
+  Temperature = 0,  // °C
+  Power = 1,        // W
+  Fan = 2,          // RPM
+  Voltage = 3,      // V
+};
+
+/**
+ * Static description of a sensor, see SensorSampler.
+ */
+struct Sensor {
+  SensorKind kind{SensorKind::Temperature};
+  // Source of the value: the hwmon driver ("coretemp", "k10temp", "nvme", ...), "thermal" (thermal zones), "rapl"
+  // (powercap energy counters) or "smc" (macOS).
+  std::string chip;
+  // Label of the channel as reported by the driver ("Package id 0", "Tctl", "package-0/dram"), the SMC key on macOS.
+  std::string label;
+  // CPU package the sensor belongs to (see Topology), -1 if unknown or not a cpu sensor.
+  int socket{-1};
+};
+
+/**
+ * Temperature, power, fan and voltage sensors, discovered once when the sampler is constructed:
+ *  - Linux: the channels of /sys/class/hwmon/hwmon* (temp*, fan*, in*, power* and energy*), the thermal zones and the
+ *    RAPL domains of /sys/class/powercap/intel-rapl:* (package, core, uncore, dram). Every attribute file is opened
+ *    once and re-read with a single pread() per update. Power of energy counters (RAPL, hwmon energy*) is the delta
+ *    since the previous update, counter wrap-arounds included.
+ *  - macOS: the temperature (T*), power (P*), fan (F*Ac) and voltage (V*) keys of the SMC, read over one connection
+ *    to the AppleSMC service.
+ *  - Windows: the thermal zones of the Win32_PerfFormattedData_Counters_ThermalZoneInformation class, all read by one
+ *    WMI query per update.
+ * Sockets are known for coretemp, k10temp/zenpower (one instance per socket since Zen 2) and RAPL packages.
+ *
+ * A sampler must not be used by multiple threads concurrently.
+ */
+class HWINFO_API SensorSampler {
+ public:
+  SensorSampler();
+  ~SensorSampler();
+  SensorSampler(const SensorSampler&) = delete;
+  SensorSampler& operator=(const SensorSampler&) = delete;
+
+  /**
+   * Replaces values() by the current readings. Values that could not be read are NaN (negative readings are valid),
+   * as are the power values of energy counters after the first update.
+   * @return false if no sensor could be read.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _sensors.size(); }
+  HWI_NODISCARD const std::vector<Sensor>& sensors() const { return _sensors; }
+  // size() values in the order of sensors(), in the unit of their kind.
+  HWI_NODISCARD const double* values() const { return _values.data(); }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+ private:
+  // Platform specific state, e.g. the opened attribute files.
+  struct Source;
+
+  // Reads all sensors into _values (one entry per sensor, already reset to NaN). Implemented per platform.
+  bool read_values(int64_t now_ns);
+
+  std::vector<Sensor> _sensors;
+  std::unique_ptr<Source> _source;
+  std::vector<double> _values;
+  int64_t _timestamp_ns{-1};
+};
+
+}  // namespace hwinfo
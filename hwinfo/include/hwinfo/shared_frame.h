@@ -0,0 +1,115 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/disk_stats.h>
+#include <hwinfo/gpu_stats.h>
+#include <hwinfo/network_stats.h>
+#include <hwinfo/platform.h>
+#include <hwinfo/sampler.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Writer of the latest MetricFrame (and its per-thread, per-disk, per-interface and per-GPU values) into a named
+ * shared memory segment (POSIX shm_open(), Windows named file mapping in the Local\ namespace), from which any number
+ * of local processes read it with SharedFrameReader instead of sampling /proc and sysfs themselves. The frame is
+ * protected by a seqlock: publish() never waits for readers and readers never block the publisher.
+ *
+ * The layout (number of threads, disks, interfaces and GPUs and their names) is fixed when the segment is created.
+ * Creating a publisher replaces a segment of the same name left behind by a previous publisher (POSIX; on Windows the
+ * name must be unused). The destructor marks the segment as closed and removes the name. Names are plain identifiers
+ * without slashes, at most 30 characters on macOS.
+ *
+ * Sampler publishes every tick when constructed with a segment name; a standalone publisher must not be used by
+ * multiple threads concurrently.
+ */
+class HWINFO_API SharedFramePublisher {
+ public:
+  SharedFramePublisher(const std::string& name, std::chrono::nanoseconds interval, int num_threads,
+                       const std::vector<std::string>& disk_names, const std::vector<int>& network_indices,
+                       const std::vector<std::string>& gpu_pci_bus_ids);
+  ~SharedFramePublisher();
+  SharedFramePublisher(const SharedFramePublisher&) = delete;
+  SharedFramePublisher& operator=(const SharedFramePublisher&) = delete;
+
+  // false if the segment could not be created (name in use, no permission, no shared memory).
+  HWI_NODISCARD bool valid() const;
+  HWI_NODISCARD const std::string& name() const { return _name; }
+
+  // Replaces the published frame. The arrays hold the number of values given to the constructor, nullptr for all -1.
+  void publish(const MetricFrame& frame, const double* thread_utilisation, const int64_t* thread_speed_MHz,
+               const DiskIOStats* disk_stats, const NetworkIOStats* network_stats, const GPUStats* gpu_stats);
+
+ private:
+  // Platform specific state, the mapped segment.
+  struct Source;
+
+  std::string _name;
+  std::unique_ptr<Source> _source;
+};
+
+/**
+ * Read-only view of a segment written by a SharedFramePublisher in another (or the same) process. The segment is mapped
+ * once by the constructor; read() is a copy out of the mapping and makes no system call.
+ *
+ * A reader stays attached to the segment it mapped: after the publisher exited (read() returns false, closed() is
+ * true) a new reader has to be created to see the segment of its successor. A publisher that was killed cannot mark the
+ * segment as closed, compare the MetricFrame::timestamp_ns (std::chrono::steady_clock, shared by the processes of a
+ * host) to interval() to detect that.
+ *
+ * read() may be called from any number of threads concurrently.
+ */
+class HWINFO_API SharedFrameReader {
+ public:
+  explicit SharedFrameReader(const std::string& name);
+  ~SharedFrameReader();
+  SharedFrameReader(const SharedFrameReader&) = delete;
+  SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+  // false if there is no segment of that name or it has an unknown layout.
+  HWI_NODISCARD bool valid() const;
+  HWI_NODISCARD int num_threads() const { return _num_threads; }
+  HWI_NODISCARD int num_disks() const { return static_cast<int>(_disk_names.size()); }
+  HWI_NODISCARD const std::vector<std::string>& disk_names() const { return _disk_names; }
+  HWI_NODISCARD int num_networks() const { return static_cast<int>(_network_indices.size()); }
+  HWI_NODISCARD const std::vector<int>& network_indices() const { return _network_indices; }
+  HWI_NODISCARD int num_gpus() const { return static_cast<int>(_gpu_pci_bus_ids.size()); }
+  HWI_NODISCARD const std::vector<std::string>& gpu_pci_bus_ids() const { return _gpu_pci_bus_ids; }
+  // Sampling interval of the publisher.
+  HWI_NODISCARD std::chrono::nanoseconds interval() const { return _interval; }
+  // Number of frames published so far (one atomic load): read() only returns a new frame if this changed.
+  HWI_NODISCARD uint64_t published() const;
+  // true once the publisher was destroyed.
+  HWI_NODISCARD bool closed() const;
+
+  /**
+   * Copies the latest consistent frame. The arrays need room for num_threads(), num_disks(), num_networks() and
+   * num_gpus() values; any of them may be nullptr if the values are not needed.
+   *
+   * @return false if nothing was published yet, the publisher is closed or the frame kept changing while it was copied
+   */
+  bool read(MetricFrame& frame, double* thread_utilisation = nullptr, int64_t* thread_speed_MHz = nullptr,
+            DiskIOStats* disk_stats = nullptr, NetworkIOStats* network_stats = nullptr,
+            GPUStats* gpu_stats = nullptr) const;
+
+ private:
+  // Platform specific state, the mapped segment.
+  struct Source;
+
+  std::unique_ptr<Source> _source;
+  int _num_threads{0};
+  std::vector<std::string> _disk_names;
+  std::vector<int> _network_indices;
+  std::vector<std::string> _gpu_pci_bus_ids;
+  std::chrono::nanoseconds _interval{0};
+};
+
+}  // namespace hwinfo
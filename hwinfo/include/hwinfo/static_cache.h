@@ -0,0 +1,64 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+class CPU;
+class GPU;
+class MainBoard;
+class Memory;
+
+/**
+ * Opt-in cache of the static inventory (cpus, gpus, mainboard and memory modules) that lives for the current boot, so
+ * that short-lived processes skip the enumeration (cpuinfo and CPUID, PCI database, SMBIOS, WMI, IOKit).
+ *
+ * Every component is stored in a file of its own in the format of hwinfo/inventory.h, memory mapped on load. The file
+ * names contain the boot id (Linux: /proc/sys/kernel/random/boot_id, macOS: kern.boottime, Windows: the boot time
+ * derived from the uptime) and the cache version, so neither a reboot nor another library version reads a stale
+ * file. Values that change while the system runs (clock speeds, utilisation, free memory) are still read live by the
+ * objects. Disks, batteries and networks are not cached since they can be attached at any time.
+ *
+ * Enabled by enable() or the environment variable HWINFO_STATIC_CACHE ("1" for the default directory, or a
+ * directory). Files that are not owned by the user or writable by others are ignored. Not used while
+ * filesystem::set_root() points the Linux collectors at another tree.
+ */
+namespace static_cache {
+
+// Bumped whenever the cached records or the collectors that produce them change.
+constexpr int kVersion = 1;
+
+// $XDG_RUNTIME_DIR (Linux, macOS: $TMPDIR if unset, then /tmp), the temp directory of the user on Windows.
+HWINFO_API std::string default_directory();
+// Caches in directory (default_directory() if empty). Returns false (keeping the previous state) if it is no
+// directory.
+HWINFO_API bool enable(const std::string& directory = {});
+HWINFO_API void disable();
+HWINFO_API bool enabled();
+// File of a component ("cpu", "gpu", "mainboard", "memory"), empty if the cache is disabled or the boot id unknown.
+HWINFO_API std::string path(const std::string& component);
+// Removes the files of the current boot, e.g. after a hardware change that did not require a reboot.
+HWINFO_API void clear();
+
+// Used by the collectors: load() replaces the value with the cached one and returns true on a hit, store() writes the
+// value of a successful enumeration. Both do nothing while the cache is disabled.
+bool load(std::vector<CPU>& cpus);
+void store(const std::vector<CPU>& cpus);
+bool load(std::vector<GPU>& gpus);
+void store(const std::vector<GPU>& gpus);
+bool load(MainBoard& mainboard);
+void store(const MainBoard& mainboard);
+bool load(Memory& memory);
+void store(const Memory& memory);
+
+// Restores the private members, friend of the cached classes.
+struct Access;
+
+}  // namespace static_cache
+}  // namespace hwinfo
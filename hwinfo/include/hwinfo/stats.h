@@ -0,0 +1,56 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Counters of one collector (enumeration like getAllCPUs() or a sampler update like ThreadMetrics::update()) since the
+ * start of the process or the last reset_stats(), summed over all threads.
+ *
+ * Only builds with the CMake option HWINFO_TRACE record them. Every thread counts into a block of its own with plain
+ * stores, so the hooks take no locks; without the option they are compiled out entirely.
+ */
+struct CollectorStats {
+  // e.g. "cpu", "disk_stats" (see trace::name())
+  std::string name;
+  uint64_t calls{0};
+  // includes nested collectors, e.g. the Topology::read() of the first getAllCPUs()
+  uint64_t wall_ns{0};
+  // files and directories opened (Linux)
+  uint64_t files_opened{0};
+  // bytes returned by read syscalls of the opened files (Linux)
+  uint64_t bytes_read{0};
+  // WMI queries executed (Windows)
+  uint64_t wmi_queries{0};
+  // operator new calls
+  uint64_t allocations{0};
+};
+
+// Whether the library was built with HWINFO_TRACE.
+HWINFO_API bool stats_enabled();
+
+// One entry per collector (also the ones that were not called), empty without HWINFO_TRACE.
+HWINFO_API std::vector<CollectorStats> stats();
+
+// Starts the counters of stats() from zero.
+HWINFO_API void reset_stats();
+
+/**
+ * Records a Chrome trace event (JSON trace event format, opens in Perfetto and chrome://tracing) for every collector
+ * call until stop_trace(), which writes them to path. Returns false without HWINFO_TRACE or if a trace is already
+ * being recorded. Events are buffered in memory, at most about a million, later ones are dropped.
+ */
+HWINFO_API bool start_trace(const std::string& path);
+
+// Writes the recorded trace. Returns false if no trace was recorded or if the file could not be written.
+HWINFO_API bool stop_trace();
+
+}  // namespace hwinfo
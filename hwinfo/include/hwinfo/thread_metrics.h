@@ -0,0 +1,97 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+#include <hwinfo/utils/aligned_allocator.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Per-thread cpu counters of one point in time in structure-of-arrays layout: every metric is a contiguous, 64 byte
+ * aligned column indexed by the OS cpu id. Aggregations over many threads (and many samples) therefore run over plain
+ * arrays, see the reductions below, instead of over vectors of per-thread objects.
+ *
+ * The jiffies columns are cumulative (/proc/stat units); user includes nice, irq includes softirq. Values that could
+ * not be read are -1. Only implemented on Linux; update() returns false on other platforms.
+ */
+class HWINFO_API ThreadMetrics {
+ public:
+  template <typename T>
+  using Column = std::vector<T, utils::AlignedAllocator<T>>;
+
+  ThreadMetrics() = default;
+
+  /**
+   * Re-reads all columns. The columns keep their capacity, so updating the same object does not allocate once the
+   * number of threads is known.
+   *
+   * @return false if the counters could not be read. The block is empty in that case.
+   */
+  bool update();
+
+  HWI_NODISCARD size_t size() const { return _user.size(); }
+  HWI_NODISCARD bool empty() const { return _user.empty(); }
+  // std::chrono::steady_clock time of the last update().
+  HWI_NODISCARD int64_t timestamp_ns() const { return _timestamp_ns; }
+
+  HWI_NODISCARD const int64_t* user() const { return _user.data(); }
+  HWI_NODISCARD const int64_t* system() const { return _system.data(); }
+  HWI_NODISCARD const int64_t* idle() const { return _idle.data(); }
+  HWI_NODISCARD const int64_t* iowait() const { return _iowait.data(); }
+  HWI_NODISCARD const int64_t* irq() const { return _irq.data(); }
+  // Current clock speed.
+  HWI_NODISCARD const int64_t* frequency_MHz() const { return _frequency_MHz.data(); }
+  // NUMA node of every thread (0 on systems without NUMA information).
+  HWI_NODISCARD const int32_t* node() const { return _node.data(); }
+  // One past the largest node id.
+  HWI_NODISCARD int32_t num_nodes() const { return _num_nodes; }
+
+ private:
+  void resize(size_t num_threads);
+
+  int64_t _timestamp_ns{-1};
+  Column<int64_t> _user;
+  Column<int64_t> _system;
+  Column<int64_t> _idle;
+  Column<int64_t> _iowait;
+  Column<int64_t> _irq;
+  Column<int64_t> _frequency_MHz;
+  Column<int32_t> _node;
+  int32_t _num_nodes{0};
+};
+
+namespace reduce {
+
+// Reductions over columns. The loops are written branch free with independent accumulators so that the compiler
+// vectorizes them.
+
+HWINFO_API int64_t sum(const int64_t* values, size_t count);
+HWINFO_API double sum(const double* values, size_t count);
+// {min, max} of the values, {0, 0} for count == 0.
+HWINFO_API std::pair<int64_t, int64_t> minmax(const int64_t* values, size_t count);
+HWINFO_API std::pair<double, double> minmax(const double* values, size_t count);
+
+/**
+ * Busy share ([0, 1]) of every thread between two blocks: (user + system + irq) / (user + system + irq + idle +
+ * iowait) over the period. Threads without a valid period get -1. Writes min(previous.size(), current.size()) values.
+ */
+HWINFO_API size_t utilisation(const ThreadMetrics& previous, const ThreadMetrics& current, double* out);
+
+/**
+ * Sums values[i] into sums[groups[i]] and counts the members of every group in counts. Members with a negative value
+ * or a group outside [0, num_groups) are skipped. sums and counts are overwritten (num_groups values each), so
+ * sums[g] / counts[g] is the group mean, e.g. the average utilisation per NUMA node with groups = ThreadMetrics::node().
+ */
+HWINFO_API void group_sum(const double* values, const int32_t* groups, size_t count, double* sums, int64_t* counts,
+                          size_t num_groups);
+
+}  // namespace reduce
+
+}  // namespace hwinfo
@@ -0,0 +1,73 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hwinfo {
+
+/**
+ * Processor topology index: maps every logical cpu (OS cpu id) to its core, last level cache domain, NUMA node and
+ * socket. Built from sysfs (Linux), GetLogicalProcessorInformationEx (Windows) and the hw.perflevel sysctls (macOS).
+ *
+ * Cores, cache domains and sockets are numbered densely from 0 in the order they are found, nodes keep the id of the
+ * OS (as used by numactl), so every column can be used as the groups of reduce::group_sum(). Cpus that are not online
+ * are -1 in every column. SMT siblings are the cpus that share a core.
+ */
+class HWINFO_API Topology {
+ public:
+  Topology() = default;
+
+  // Process wide index, read on first use. Cpus that come online later are not included, use read() for them.
+  static const Topology& get();
+  // Reads a fresh index.
+  static Topology read();
+
+  // One past the largest OS cpu id.
+  HWI_NODISCARD size_t size() const { return _socket.size(); }
+  HWI_NODISCARD bool empty() const { return _socket.empty(); }
+  HWI_NODISCARD int32_t num_sockets() const { return static_cast<int32_t>(_package_ids.size()); }
+  HWI_NODISCARD int32_t num_cores() const { return _num_cores; }
+  HWI_NODISCARD int32_t num_cache_domains() const { return _num_cache_domains; }
+  // One past the largest node id.
+  HWI_NODISCARD int32_t num_nodes() const { return _num_nodes; }
+
+  HWI_NODISCARD const int32_t* core() const { return _core.data(); }
+  // Domain of the last level cache (L3 on most x86 systems, L2 clusters on ARM).
+  HWI_NODISCARD const int32_t* cache_domain() const { return _cache_domain.data(); }
+  HWI_NODISCARD const int32_t* node() const { return _node.data(); }
+  HWI_NODISCARD const int32_t* socket() const { return _socket.data(); }
+  // Relative performance of the core: higher is faster, equal on systems without hybrid cores.
+  HWI_NODISCARD const int32_t* efficiency_class() const { return _efficiency_class.data(); }
+
+  // Dense socket index of a CPU::id(), -1 if the socket is unknown.
+  HWI_NODISCARD int32_t find_socket(int32_t cpu_id) const;
+  // OS cpu ids of all cpus of a socket (core, NUMA node) in ascending order.
+  HWI_NODISCARD std::vector<int> cpus_of_socket(int32_t socket) const;
+  HWI_NODISCARD std::vector<int> cpus_of_core(int32_t core) const;
+  HWI_NODISCARD std::vector<int> cpus_of_node(int32_t node) const;
+
+ private:
+  // Grows the columns to num_cpus entries (-1 for the added cpus).
+  void resize(size_t num_cpus);
+  // Dense id of key in keys, appended if it is new.
+  static int32_t index_of(std::vector<int64_t>& keys, int64_t key);
+
+  std::vector<int32_t> _core;
+  std::vector<int32_t> _cache_domain;
+  std::vector<int32_t> _node;
+  std::vector<int32_t> _socket;
+  std::vector<int32_t> _efficiency_class;
+  // CPU::id() of every socket (e.g. the physical package id on Linux)
+  std::vector<int32_t> _package_ids;
+  int32_t _num_cores{0};
+  int32_t _num_cache_domains{0};
+  int32_t _num_nodes{0};
+};
+
+}  // namespace hwinfo
@@ -11,50 +11,71 @@
 
 #ifdef HWINFO_UNIX
 
-#include <map>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace hwinfo {
 
+namespace pci_table {
+struct VendorEntry;
+struct DeviceEntry;
+}  // namespace pci_table
+
+/**
+ * PCIDevice and PCIVendor are lightweight views into the static PCI ID table generated by scripts/pci_builder.py.
+ * Names point into static storage and stay valid for the whole program lifetime. Lookups never allocate.
+ */
 struct PCIDevice {
-  PCIDevice(std::string d_id, std::string d_name);
+  PCIDevice() = default;
+  explicit PCIDevice(const pci_table::DeviceEntry* entry);
+
+  HWI_NODISCARD bool valid() const { return _entry != nullptr; }
+  HWI_NODISCARD std::string_view subsystem_name(uint16_t subvendor_id, uint16_t subdevice_id) const;
+
+  uint16_t device_id{0};
+  std::string_view device_name{"invalid"};
 
-  const std::string device_id{};
-  const std::string device_name{};
-  std::map<std::string, std::string> subsystems{};
+ private:
+  const pci_table::DeviceEntry* _entry{nullptr};
 };
 
 struct PCIVendor {
-  PCIVendor(std::string v_id, std::string v_name);
+  PCIVendor() = default;
+  explicit PCIVendor(const pci_table::VendorEntry* entry);
+
+  HWI_NODISCARD bool valid() const { return _entry != nullptr; }
+  HWI_NODISCARD PCIDevice device_from_id(uint16_t device_id) const;
+  HWI_NODISCARD PCIDevice device_from_id(std::string_view device_id) const;
 
-  const PCIDevice& operator[](const std::string& device_id) const;
+  PCIDevice operator[](uint16_t device_id) const { return device_from_id(device_id); }
+  PCIDevice operator[](std::string_view device_id) const { return device_from_id(device_id); }
 
-  const std::string vendor_id{};
-  const std::string vendor_name{};
-  std::map<std::string, PCIDevice> devices{};
+  uint16_t vendor_id{0};
+  std::string_view vendor_name{"invalid"};
 
  private:
-  PCIDevice _invalid_device{"0000", "invalid"};
+  const pci_table::VendorEntry* _entry{nullptr};
 };
 
 class PCIMapper {
  public:
-  explicit PCIMapper();
+  PCIMapper() = default;
   ~PCIMapper() = default;
 
-  const PCIVendor& vendor_from_id(const std::string& vendor_id) const;
+  HWI_NODISCARD PCIVendor vendor_from_id(uint16_t vendor_id) const;
+  // accepts hex ids with or without "0x" prefix (e.g. "0x10de", "10de")
+  HWI_NODISCARD PCIVendor vendor_from_id(std::string_view vendor_id) const;
 
-  const PCIVendor& operator[](const std::string& vendor_id) const;
-
- private:
-  std::map<std::string, PCIVendor> _vendors{};
-  PCIVendor _invalid_vendor{"0000", "invalid"};
+  PCIVendor operator[](uint16_t vendor_id) const { return vendor_from_id(vendor_id); }
+  PCIVendor operator[](std::string_view vendor_id) const { return vendor_from_id(vendor_id); }
 };
 
 struct PCI {
-  static PCIMapper getMapper();
+  // Returns the process wide mapper. Lazily initialized, thread-safe and never copied.
+  static const PCIMapper& getMapper();
 };
 
 }  // namespace hwinfo
 
-#endif  // HWINFO_UNIX
\ No newline at end of file
+#endif  // HWINFO_UNIX
@@ -0,0 +1,46 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace hwinfo {
+namespace utils {
+
+/**
+ * Allocator that aligns the storage to Alignment bytes (a cache line by default), so that columns of numbers start on
+ * a vector register boundary and reductions over them can use aligned SIMD loads.
+ */
+template <typename T, size_t Alignment = 64>
+class AlignedAllocator {
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "invalid alignment");
+
+ public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>& /*other*/) noexcept {}  // NOLINT: implicit by design
+
+  T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+  void deallocate(T* p, size_t /*n*/) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment>& /*other*/) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment>& /*other*/) const noexcept {
+    return false;
+  }
+};
+
+}  // namespace utils
+}  // namespace hwinfo
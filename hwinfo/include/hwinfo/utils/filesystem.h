@@ -1,10 +1,21 @@
 #pragma once
 
-#include <hwinfo/cpu.h>
+#include <hwinfo/platform.h>
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#ifdef HWINFO_UNIX
+#include <dirent.h>
+#endif
+
 namespace hwinfo {
 namespace filesystem {
 
@@ -17,7 +28,208 @@ int64_t get_specs_by_file_path(const std::string& path);
 #endif  // HWINFO_UNIX || HWINFO_APPLE
 
 #if defined(HWINFO_UNIX)
-Jiffies get_jiffies(int index);
+/**
+ * Root of the /proc, /sys, /dev and /etc trees that the Linux collectors read: "/" by default, the value of the
+ * environment variable HWINFO_ROOT if set. All path based helpers of this namespace resolve absolute paths below the
+ * root, and thereby all collectors, e.g. below "/host" to report the host from inside a container that mounts the
+ * host's /proc and /sys there, or below a captured (or synthetic, see MemoryTree) fixture tree.
+ *
+ * The root directory is opened once and files are opened relative to it with openat2(RESOLVE_IN_ROOT), so absolute
+ * symlinks and ".." stay inside the root. Kernels before 5.6 (or seccomp filters that reject openat2) fall back to
+ * openat(), with which absolute symlinks resolve against the real root.
+ *
+ * Files and values that are kept for the process lifetime are bound to the root of their first use, except those that
+ * are held in a PerRoot (/proc/stat, /proc/meminfo, the scaling_cur_freq files, get_cached_value()): set the root
+ * before collecting.
+ *
+ * @return false (keeping the previous root) if path is not a directory.
+ */
+bool set_root(const std::string& path);
+// The current root, "/" unless set_root() or HWINFO_ROOT set another one.
+std::string root();
+// Incremented by every successful set_root(), see PerRoot.
+uint64_t root_generation();
+
+// Opens an absolute path below the root like open() (O_CLOEXEC is always added). Relative paths are opened as given.
+int open_path(const char* path, int flags);
+// path prefixed with the root, for interfaces that take a path instead of a descriptor (statvfs(), realpath()).
+std::string rooted(const std::string& path);
+
+/**
+ * Value that is created once per root, e.g. a file that is kept open for the process lifetime: get() creates it on
+ * first use and again after set_root() changed the root. Replaced values are kept, since other threads may still use
+ * them. Thread-safe; get() costs two atomic loads once the value exists.
+ */
+template <typename T>
+class PerRoot {
+ public:
+  explicit PerRoot(std::function<T()> create) : _create(std::move(create)) {}
+  PerRoot(const PerRoot&) = delete;
+  PerRoot& operator=(const PerRoot&) = delete;
+
+  const T& get() const {
+    const uint64_t generation = root_generation();
+    if (_generation.load(std::memory_order_acquire) != generation) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_generation.load(std::memory_order_relaxed) != generation) {
+        _values.push_back(std::make_unique<const T>(_create()));
+        _value.store(_values.back().get(), std::memory_order_release);
+        _generation.store(generation, std::memory_order_release);
+      }
+    }
+    return *_value.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::function<T()> _create;
+  mutable std::mutex _mutex;
+  mutable std::vector<std::unique_ptr<const T>> _values;
+  mutable std::atomic<const T*> _value{nullptr};
+  mutable std::atomic<uint64_t> _generation{~uint64_t{0}};
+};
+
+/**
+ * Fixture tree in memory, meant as root for set_root(): the files are created in a private directory on tmpfs
+ * (/dev/shm, $TMPDIR if that is not writable) and removed with the object. Collectors therefore read it with the same
+ * descriptors and syscalls (pread(), poll(), openat()) as the real /proc and /sys, only without the kernel generating
+ * the content. Not thread-safe; populate the tree before collecting.
+ */
+class MemoryTree {
+ public:
+  MemoryTree();
+  ~MemoryTree();
+  MemoryTree(const MemoryTree&) = delete;
+  MemoryTree& operator=(const MemoryTree&) = delete;
+
+  HWI_NODISCARD bool valid() const { return !_path.empty(); }
+  // Directory of the tree, the argument for set_root().
+  HWI_NODISCARD const std::string& path() const { return _path; }
+  // Creates (or replaces) the file at the absolute path within the tree, including missing parent directories.
+  bool add_file(const std::string& path, std::string_view content);
+  // Creates a symlink at the absolute path within the tree, e.g. the /sys/class links into /sys/devices.
+  bool add_symlink(const std::string& path, const std::string& target);
+
+ private:
+  bool add_parents(const std::string& path);
+
+  std::string _path;
+};
+
+/**
+ * Read-only file that is opened once and re-read with pread() at offset 0. Meant for sysfs attributes that are polled
+ * frequently: a read costs a single syscall, uses a stack buffer and never throws.
+ */
+class CachedFile {
+ public:
+  CachedFile() = default;
+  explicit CachedFile(const std::string& path);
+  ~CachedFile();
+  CachedFile(const CachedFile&) = delete;
+  CachedFile& operator=(const CachedFile&) = delete;
+  CachedFile(CachedFile&& other) noexcept;
+  CachedFile& operator=(CachedFile&& other) noexcept;
+
+  HWI_NODISCARD bool valid() const { return _fd >= 0; }
+  // The descriptor, e.g. to poll() for changes of /proc/self/mountinfo. Owned by the CachedFile.
+  HWI_NODISCARD int fd() const { return _fd; }
+  // Parses the leading (optionally signed) decimal integer. Returns false if the file could not be read or parsed.
+  bool read_int64(int64_t& value) const;
+  // Reads the whole file into buffer (resized to the content). buffer keeps its capacity, so re-reading with the same
+  // buffer does not allocate. Returns false if the file could not be read.
+  bool read(std::string& buffer) const;
+
+ private:
+  int _fd{-1};
+};
+
+/**
+ * Directory that is opened once; its files are read with openat() relative to it, so reading several attributes of a
+ * sysfs device neither builds paths nor resolves the directory again. Never throws.
+ */
+class Directory {
+ public:
+  Directory() = default;
+  explicit Directory(const std::string& path);
+  ~Directory();
+  Directory(const Directory&) = delete;
+  Directory& operator=(const Directory&) = delete;
+  Directory(Directory&& other) noexcept;
+  Directory& operator=(Directory&& other) noexcept;
+
+  HWI_NODISCARD bool valid() const { return _fd >= 0; }
+  HWI_NODISCARD int fd() const { return _fd; }
+  // True if the (relative) path exists.
+  HWI_NODISCARD bool exists(const char* name) const;
+  // Reads the first line of the file without surrounding whitespace. Returns false if it cannot be read or is empty.
+  bool read(const char* name, std::string& value) const;
+  // Parses the leading (optionally signed) decimal integer of the file.
+  bool read_int64(const char* name, int64_t& value) const;
+
+ private:
+  int _fd{-1};
+};
+
+/**
+ * Entries of a directory, read one at a time with readdir() ("." and ".." are skipped). Unlike getDirectoryEntries()
+ * the names are never collected, so large directories (e.g. /sys/class/net with thousands of veth interfaces) can be
+ * walked with constant memory and abandoned early. Never throws.
+ */
+class DirectoryStream {
+ public:
+  explicit DirectoryStream(const std::string& path);
+  ~DirectoryStream();
+  DirectoryStream(const DirectoryStream&) = delete;
+  DirectoryStream& operator=(const DirectoryStream&) = delete;
+
+  HWI_NODISCARD bool valid() const { return _dir != nullptr; }
+  // The name of the next entry, valid until the following call. Returns false after the last entry.
+  bool next(std::string_view& name);
+
+ private:
+  DIR* _dir{nullptr};
+};
+
+/**
+ * Sequential line by line reader with a fixed size buffer: only one chunk of the file is held at a time, so large
+ * files (e.g. /proc/cpuinfo on many-core machines) can be parsed incrementally and abandoned early.
+ */
+class LineReader {
+ public:
+  explicit LineReader(const std::string& path, size_t chunk_size = 16 * 1024);
+  ~LineReader();
+  LineReader(const LineReader&) = delete;
+  LineReader& operator=(const LineReader&) = delete;
+
+  HWI_NODISCARD bool valid() const { return _fd >= 0; }
+  /**
+   * Reads the next line (without the trailing '\n'). The view is valid until the following call. Lines longer than
+   * the chunk size grow the buffer.
+   * @return false at the end of the file or on a read error.
+   */
+  bool next(std::string_view& line);
+
+ private:
+  bool fill();
+
+  int _fd{-1};
+  std::string _buffer;
+  size_t _begin{0};
+  size_t _end{0};
+  bool _eof{false};
+};
+
+/**
+ * Returns the integer value of the file at path or -1 on error. The file is opened on first successful use and kept
+ * open in a process wide cache, so subsequent calls only cost a single pread(). A descriptor that fails to read is
+ * closed and the path opened once more before -1 is returned. Thread-safe.
+ */
+int64_t get_cached_value(const std::string& path);
+
+/**
+ * scaling_cur_freq (kHz) of every cpu, indexed by the OS cpu id. Opened once per process (up to the first cpu without
+ * cpufreq support) and re-read with pread().
+ */
+const std::vector<CachedFile>& cpu_frequency_files();
 #endif  // HWINFO_UNIX
 
 }  // namespace filesystem
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <IOKit/IOKitLib.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+namespace utils {
+namespace iokit {
+
+/**
+ * UTF-8 copy of a CFString. Uses the internal buffer of the string (CFStringGetCStringPtr()) if it has one in UTF-8
+ * or ASCII, which is the case for most registry properties, and converts into a buffer of the exact size otherwise.
+ * Empty for nullptr and for objects that are no CFString.
+ */
+std::string to_string(CFTypeRef string);
+
+// Owns one reference of a CoreFoundation object.
+template <typename T>
+class CFRef {
+ public:
+  CFRef() = default;
+  // takes over the reference of a Create/Copy function
+  explicit CFRef(T ref) : _ref(ref) {}
+  ~CFRef() {
+    if (_ref) CFRelease(_ref);
+  }
+  CFRef(CFRef&& other) noexcept : _ref(other._ref) { other._ref = nullptr; }
+  CFRef& operator=(CFRef&& other) noexcept {
+    std::swap(_ref, other._ref);
+    return *this;
+  }
+  CFRef(const CFRef&) = delete;
+  CFRef& operator=(const CFRef&) = delete;
+
+  HWI_NODISCARD T get() const { return _ref; }
+  explicit operator bool() const { return _ref != nullptr; }
+
+ private:
+  T _ref{nullptr};
+};
+
+/**
+ * A registry entry with all of its properties, read with one IORegistryEntryCreateCFProperties() call instead of one
+ * IORegistryEntryCreateCFProperty() round trip per key. The accessors return nullopt for missing properties and for
+ * properties of another type.
+ */
+class Entry {
+ public:
+  // takes over the reference of object
+  explicit Entry(io_registry_entry_t object);
+  ~Entry();
+  Entry(Entry&& other) noexcept;
+  Entry& operator=(Entry&& other) = delete;
+  Entry(const Entry&) = delete;
+  Entry& operator=(const Entry&) = delete;
+
+  HWI_NODISCARD io_registry_entry_t object() const { return _object; }
+  // IORegistryEntryGetName(), e.g. the model of a disk
+  HWI_NODISCARD const std::string& name() const { return _name; }
+  HWI_NODISCARD CFTypeRef property(CFStringRef key) const;
+  HWI_NODISCARD std::optional<std::string> string(CFStringRef key) const;
+  HWI_NODISCARD std::optional<int64_t> number(CFStringRef key) const;
+  HWI_NODISCARD std::optional<bool> boolean(CFStringRef key) const;
+
+ private:
+  io_registry_entry_t _object;
+  std::string _name;
+  CFRef<CFMutableDictionaryRef> _properties;
+};
+
+/**
+ * Every service of an IOKit class (IOServiceMatching(class_name)) with its properties. While a Scope is alive, the
+ * walk of a class is done once and shared by all threads; otherwise every call walks the registry.
+ */
+std::shared_ptr<const std::vector<Entry>> services(const char* class_name);
+
+/**
+ * Shares the registry walks of services() between the collectors while at least one Scope exists, e.g. for the
+ * duration of a collectAll(). The walks are dropped with the last Scope, so that later calls see hotplugged devices.
+ */
+class Scope {
+ public:
+  Scope();
+  ~Scope();
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+};
+
+}  // namespace iokit
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
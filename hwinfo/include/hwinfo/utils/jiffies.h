@@ -0,0 +1,28 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/cpu.h>
+
+#include <vector>
+
+namespace hwinfo {
+namespace utils {
+
+/**
+ * Reads the cumulative cpu time counters of the whole system and of every logical thread (indexed by the OS cpu id).
+ * Implemented per platform: /proc/stat on Linux, host_processor_info on Apple, NtQuerySystemInformation on Windows.
+ *
+ * @return false if the counters could not be read.
+ */
+bool read_jiffies(Jiffies& total, std::vector<Jiffies>& threads);
+
+/**
+ * Utilisation ([0, 1]) between two Jiffies samples of the same cpu. If previous is invalid (Jiffies()), the utilisation
+ * since boot is returned. Returns -1.0 if it cannot be computed (e.g. no time has passed).
+ */
+double utilisation(const Jiffies& previous, const Jiffies& current);
+
+}  // namespace utils
+}  // namespace hwinfo
@@ -0,0 +1,74 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/utils/filesystem.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace hwinfo {
+namespace utils {
+
+// One line of /proc/self/mountinfo. Octal escapes ("\040" for blanks) are decoded.
+struct Mount {
+  uint32_t major{0};
+  uint32_t minor{0};
+  // root of the mount within the filesystem ("/" unless it is a bind mount)
+  std::string root;
+  std::string mount_point;
+  std::string fs_type;
+  // e.g. "/dev/nvme0n1p2", "overlay", "tmpfs"
+  std::string source;
+};
+
+/**
+ * Mount table indexed by device number and by source.
+ *
+ * refresh() parses /proc/self/mountinfo in one pass. The file stays open: the kernel marks it with POLLPRI whenever the
+ * mount table of the namespace changes, so later refreshes cost a single poll() and only re-parse after a change.
+ * The kernel does not report which mounts changed, so a change rebuilds the whole index.
+ */
+class MountIndex {
+ public:
+  MountIndex();
+  // Mount table of another file in /proc/<pid>/mountinfo format, e.g. of another mount namespace or a fixture.
+  explicit MountIndex(const std::string& path);
+
+  /**
+   * Parses the mount table if it changed since the last call (or was never parsed).
+   * @return true if the index was rebuilt.
+   */
+  bool refresh();
+
+  HWI_NODISCARD const std::vector<Mount>& mounts() const { return _mounts; }
+  // Indices into mounts() of the mounts of the device major:minor, in mount order.
+  HWI_NODISCARD const std::vector<size_t>& of_device(uint32_t major, uint32_t minor) const;
+  // Indices into mounts() whose source is the given path. Filesystems such as btrfs report an anonymous device
+  // number, only the source names the block device.
+  HWI_NODISCARD const std::vector<size_t>& of_source(std::string_view source) const;
+
+ private:
+  void parse();
+
+  filesystem::CachedFile _file;
+  bool _parsed{false};
+  std::string _buffer;
+  std::vector<Mount> _mounts;
+  std::unordered_map<uint64_t, std::vector<size_t>> _by_device;
+  std::unordered_map<std::string, std::vector<size_t>> _by_source;
+};
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -0,0 +1,25 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <winternl.h>
+
+namespace hwinfo {
+namespace utils {
+
+using NtQuerySystemInformation_t = NTSTATUS(NTAPI*)(SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
+
+// NtQuerySystemInformation of ntdll.dll, resolved once at runtime so that no additional import library (ntdll.lib) is
+// required. nullptr if ntdll.dll does not export it.
+NtQuerySystemInformation_t nt_query_system_information();
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -0,0 +1,326 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+// Non throwing number parsing for /proc, sysfs and similar text files. skip_blanks() and skip_digits() classify 16
+// bytes per step (SSE2 on x86, NEON on ARM, scalar otherwise), the conversion itself is done by std::from_chars. Blanks
+// are ' ' and '\t'; line breaks are never skipped implicitly, so line based formats keep their structure.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HWINFO_PARSE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define HWINFO_PARSE_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace hwinfo {
+namespace utils {
+
+namespace parse_detail {
+
+// _____________________________________________________________________________________________________________________
+inline unsigned count_trailing_zeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+#ifdef HWINFO_PARSE_NEON
+// _____________________________________________________________________________________________________________________
+// 4 bits per byte of a 0x00/0xff byte mask (the usual replacement for movemask on NEON)
+inline uint64_t nibble_mask(uint8x16_t mask) {
+  return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(mask), 4)), 0);
+}
+
+// _____________________________________________________________________________________________________________________
+inline unsigned count_trailing_zero_bytes(uint64_t nibbles) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward64(&index, nibbles);
+  return static_cast<unsigned>(index) / 4;
+#else
+  return static_cast<unsigned>(__builtin_ctzll(nibbles)) / 4;
+#endif
+}
+#endif  // HWINFO_PARSE_NEON
+
+}  // namespace parse_detail
+
+// _____________________________________________________________________________________________________________________
+inline bool is_blank(char c) { return c == ' ' || c == '\t'; }
+
+// _____________________________________________________________________________________________________________________
+inline bool is_digit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+
+/**
+ * Returns the first position in [p, end) that is not a blank (' ', '\t'), or end.
+ */
+inline const char* skip_blanks(const char* p, const char* end) {
+  // fast path: numbers in /proc are mostly separated by a single blank
+  if (p < end && !is_blank(*p)) {
+    return p;
+  }
+#if defined(HWINFO_PARSE_SSE2)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  while (end - p >= 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab));
+    const auto other = static_cast<uint32_t>(~_mm_movemask_epi8(blank)) & 0xffffu;
+    if (other != 0) {
+      return p + parse_detail::count_trailing_zeros(other);
+    }
+    p += 16;
+  }
+#elif defined(HWINFO_PARSE_NEON)
+  const uint8x16_t space = vdupq_n_u8(' ');
+  const uint8x16_t tab = vdupq_n_u8('\t');
+  while (end - p >= 16) {
+    const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    const uint8x16_t blank = vorrq_u8(vceqq_u8(chunk, space), vceqq_u8(chunk, tab));
+    const uint64_t other = ~parse_detail::nibble_mask(blank);
+    if (other != 0) {
+      return p + parse_detail::count_trailing_zero_bytes(other);
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && is_blank(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+/**
+ * Returns the first position in [p, end) that is not a decimal digit, or end.
+ */
+inline const char* skip_digits(const char* p, const char* end) {
+#if defined(HWINFO_PARSE_SSE2)
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i nine = _mm_set1_epi8(9);
+  while (end - p >= 16) {
+    const __m128i chunk = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), zero);
+    // digit iff (c - '0') <= 9 as unsigned byte
+    const __m128i digit = _mm_cmpeq_epi8(_mm_min_epu8(chunk, nine), chunk);
+    const auto other = static_cast<uint32_t>(~_mm_movemask_epi8(digit)) & 0xffffu;
+    if (other != 0) {
+      return p + parse_detail::count_trailing_zeros(other);
+    }
+    p += 16;
+  }
+#elif defined(HWINFO_PARSE_NEON)
+  const uint8x16_t zero = vdupq_n_u8('0');
+  const uint8x16_t nine = vdupq_n_u8(9);
+  while (end - p >= 16) {
+    const uint8x16_t chunk = vsubq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p)), zero);
+    const uint64_t other = ~parse_detail::nibble_mask(vcleq_u8(chunk, nine));
+    if (other != 0) {
+      return p + parse_detail::count_trailing_zero_bytes(other);
+    }
+    p += 16;
+  }
+#endif
+  while (p < end && is_digit(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+/**
+ * Returns the position of the next '\n' in [p, end), or end.
+ */
+inline const char* find_line_end(const char* p, const char* end) {
+  // memchr is vectorized by every libc
+  const void* match = p < end ? std::memchr(p, '\n', static_cast<size_t>(end - p)) : nullptr;
+  return match != nullptr ? static_cast<const char*>(match) : end;
+}
+
+/**
+ * Parses an integer that may be surrounded by blanks and line breaks ("  42\n"). Anything else after the number
+ * (e.g. a unit suffix) is allowed unless full is set.
+ *
+ * @return false (and value untouched) if s does not start with a number or the number does not fit into T.
+ */
+template <typename T>
+bool parse_int(std::string_view s, T& value, bool full = false) {
+  static_assert(std::is_integral<T>::value, "parse_int requires an integral type");
+  const char* p = s.data();
+  const char* end = p + s.size();
+  while (p < end && (is_blank(*p) || *p == '\n' || *p == '\r')) {
+    ++p;
+  }
+  if (p < end && *p == '+') {
+    ++p;
+  }
+  T result{};
+  auto [ptr, ec] = std::from_chars(p, end, result);
+  if (ec != std::errc() || ptr == p) {
+    return false;
+  }
+  if (full) {
+    while (ptr < end && (is_blank(*ptr) || *ptr == '\n' || *ptr == '\r')) {
+      ++ptr;
+    }
+    if (ptr != end) {
+      return false;
+    }
+  }
+  value = result;
+  return true;
+}
+
+// parse_int() returning fallback on failure.
+template <typename T>
+T parse_int_or(std::string_view s, T fallback) {
+  T value = fallback;
+  return parse_int(s, value) ? value : fallback;
+}
+
+/**
+ * Parses a cpu list as used by sysfs ("0-3,8,10-11\n") and sets the listed cpus in cpus (grown as needed, other
+ * entries are kept).
+ *
+ * @return false if the list is malformed. cpus may be partially updated in that case.
+ */
+inline bool parse_cpu_list(std::string_view list, std::vector<bool>& cpus) {
+  while (!list.empty() && (list.back() == '\n' || is_blank(list.back()))) {
+    list.remove_suffix(1);
+  }
+  while (!list.empty()) {
+    const size_t comma = list.find(',');
+    const std::string_view range = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    const size_t dash = range.find('-');
+    size_t first = 0;
+    size_t last = 0;
+    if (!parse_int(range.substr(0, dash), first, true) ||
+        !parse_int(dash == std::string_view::npos ? range : range.substr(dash + 1), last, true) || last < first) {
+      return false;
+    }
+    if (cpus.size() <= last) {
+      cpus.resize(last + 1, false);
+    }
+    for (size_t cpu = first; cpu <= last; ++cpu) {
+      cpus[cpu] = true;
+    }
+  }
+  return true;
+}
+
+/**
+ * Cursor over a text buffer that reads numbers and words without allocating and without throwing. Numbers and words
+ * are only read within the current line; next_line() moves to the start of the following one.
+ */
+class NumberScanner {
+ public:
+  NumberScanner(const char* begin, const char* end) : _p(begin), _end(end) {}
+  explicit NumberScanner(std::string_view text) : _p(text.data()), _end(text.data() + text.size()) {}
+
+  HWI_NODISCARD bool done() const { return _p >= _end; }
+  HWI_NODISCARD bool at_line_end() const { return _p >= _end || *_p == '\n'; }
+  HWI_NODISCARD const char* position() const { return _p; }
+
+  // Skips blanks and reads an unsigned decimal number. Returns false (and does not move) if there is none or it does
+  // not fit.
+  template <typename T>
+  bool next_uint(T& value) {
+    const char* start = skip_blanks(_p, _end);
+    const char* stop = skip_digits(start, _end);
+    if (stop == start || std::from_chars(start, stop, value).ec != std::errc()) {
+      return false;
+    }
+    _p = stop;
+    return true;
+  }
+
+  // Like next_uint() but for a possibly signed number.
+  bool next_int(int64_t& value) {
+    const char* start = skip_blanks(_p, _end);
+    const char* digits = start < _end && *start == '-' ? start + 1 : start;
+    const char* stop = skip_digits(digits, _end);
+    if (stop == digits || std::from_chars(start, stop, value).ec != std::errc()) {
+      return false;
+    }
+    _p = stop;
+    return true;
+  }
+
+  /**
+   * Reads up to max numbers of the current line into out (see next_uint()) and returns how many were read. Stops at
+   * the first token that is not a number.
+   */
+  template <typename T>
+  size_t read_uints(T* out, size_t max) {
+    size_t n = 0;
+    while (n < max && next_uint(out[n])) {
+      ++n;
+    }
+    return n;
+  }
+
+  // Skips blanks and returns the following run of non blank characters of the current line (empty at the line end).
+  std::string_view next_word() {
+    const char* start = skip_blanks(_p, _end);
+    const char* stop = start;
+    while (stop < _end && !is_blank(*stop) && *stop != '\n') {
+      ++stop;
+    }
+    _p = stop;
+    return {start, static_cast<size_t>(stop - start)};
+  }
+
+  // Skips everything up to the given character of the current line (inclusive). Returns false at the line end.
+  bool skip_past(char c) {
+    const char* line_end = find_line_end(_p, _end);
+    const void* match = _p < line_end ? std::memchr(_p, c, static_cast<size_t>(line_end - _p)) : nullptr;
+    if (match == nullptr) {
+      _p = line_end;
+      return false;
+    }
+    _p = static_cast<const char*>(match) + 1;
+    return true;
+  }
+
+  // Rest of the current line without consuming it.
+  HWI_NODISCARD std::string_view rest_of_line() const {
+    return {_p, static_cast<size_t>(find_line_end(_p, _end) - _p)};
+  }
+
+  // Moves to the start of the next line. Returns false if there is none.
+  bool next_line() {
+    _p = find_line_end(_p, _end);
+    if (_p >= _end) {
+      return false;
+    }
+    ++_p;
+    return _p < _end;
+  }
+
+ private:
+  const char* _p;
+  const char* _end;
+};
+
+}  // namespace utils
+}  // namespace hwinfo
@@ -0,0 +1,71 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+namespace utils {
+
+// Values of the "Processor Information" performance counters. Per processor values are ordered by processor group and
+// number, which matches the logical thread ids used elsewhere. Values that could not be read are -1.
+struct ProcessorCounterSample {
+  // "% Processor Utility" of all processors and per processor (100 = fully busy at base frequency, may exceed 100)
+  double utility_total{-1.0};
+  std::vector<double> utility{};
+  // "% Processor Performance" per processor (current frequency relative to base frequency in percent)
+  std::vector<double> performance{};
+};
+
+/**
+ * Process wide PDH query over all instances of the "Processor Information" counters.
+ *
+ * The query handle is opened once and kept open. sample() collects all counters of all instances with a single
+ * PdhCollectQueryData() call, which takes microseconds, while the equivalent WMI perf class query takes ~100ms. The
+ * counters are rates, so each reported value covers the period since the previous collection (of any caller). Samples
+ * requested within min_interval of the previous collection reuse it instead of producing a near empty period.
+ */
+class ProcessorCounters {
+ public:
+  static ProcessorCounters& get();
+
+  ProcessorCounters(const ProcessorCounters&) = delete;
+  ProcessorCounters& operator=(const ProcessorCounters&) = delete;
+  ~ProcessorCounters();
+
+  // Copies the latest values into out (reusing its buffers). Returns false if PDH is not available. Until min_interval
+  // has passed since the baseline collection of the first get(), the values are -1 (empty per processor values).
+  bool sample(ProcessorCounterSample& out);
+
+  static constexpr std::chrono::milliseconds min_interval{100};
+
+ private:
+  ProcessorCounters();
+  bool collect();
+  bool read_counter(void* counter, std::vector<double>& values, double* total);
+
+  // PDH_HQUERY / PDH_HCOUNTER, kept opaque so that this header does not pull in <pdh.h>
+  void* _query{nullptr};
+  void* _utility{nullptr};
+  void* _performance{nullptr};
+
+  std::mutex _mutex;
+  std::chrono::steady_clock::time_point _last_collect{};
+  ProcessorCounterSample _last{};
+  std::vector<unsigned char> _buffer{};
+  std::vector<std::pair<uint64_t, double>> _ordered{};
+};
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
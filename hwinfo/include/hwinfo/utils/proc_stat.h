@@ -0,0 +1,62 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/cpu.h>
+#include <hwinfo/cpu_times.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hwinfo {
+namespace utils {
+
+/**
+ * Snapshot of the cpu lines of /proc/stat.
+ *
+ * update() reads the whole file with a single pread() on a file descriptor that is opened once per process and parses
+ * the aggregate "cpu" line and every "cpuN" line in one pass. The read buffer is owned by the snapshot and reused by
+ * subsequent updates, so re-sampling the same snapshot does not allocate.
+ */
+class StatSnapshot {
+ public:
+  StatSnapshot() = default;
+
+  /**
+   * Re-reads /proc/stat.
+   *
+   * @return false if /proc/stat could not be read. The snapshot is left empty in that case.
+   */
+  bool update();
+
+  // Jiffies of the aggregate "cpu" line: all is CpuTimes::total(), working CpuTimes::busy().
+  HWI_NODISCARD const Jiffies& total() const { return _total; }
+  // Jiffies of the "cpu<thread_id>" line. Returns Jiffies() (all values -1) if the thread is not listed.
+  HWI_NODISCARD const Jiffies& thread(int thread_id) const;
+  // One past the largest listed thread id.
+  HWI_NODISCARD size_t num_threads() const { return _threads.size(); }
+
+  // All columns of the aggregate "cpu" line. Columns that older kernels do not report are 0.
+  HWI_NODISCARD const CpuTimes& total_times() const { return _total_times; }
+  // All columns of the "cpu<thread_id>" line, CpuTimes() (all values -1) if the thread is not listed.
+  HWI_NODISCARD const CpuTimes& times(int thread_id) const;
+
+ private:
+  Jiffies _total{};
+  std::vector<Jiffies> _threads{};
+  CpuTimes _total_times{};
+  std::vector<CpuTimes> _times{};
+  std::string _buffer{};
+};
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
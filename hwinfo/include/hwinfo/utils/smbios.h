@@ -0,0 +1,193 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+#include <hwinfo/ram.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hwinfo {
+namespace smbios {
+
+/**
+ * One SMBIOS structure: the formatted area (header included) followed by the string set. Only views into the table
+ * blob, nothing is copied.
+ */
+struct Structure {
+  uint8_t type{0};
+  // length of the formatted area
+  uint8_t length{0};
+  uint16_t handle{0};
+  const uint8_t* data{nullptr};
+  const char* strings{nullptr};
+  const char* strings_end{nullptr};
+
+  // Field at the given offset of the formatted area, fallback if the structure is too short (older SMBIOS versions).
+  template <typename T>
+  HWI_NODISCARD T get(size_t offset, T fallback = T()) const {
+    if (offset + sizeof(T) > length) {
+      return fallback;
+    }
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+  }
+
+  // String referenced by the byte at offset (1-based string number, 0 means none). Empty if not set.
+  HWI_NODISCARD std::string_view string(size_t offset) const {
+    const auto number = get<uint8_t>(offset);
+    if (number == 0) {
+      return {};
+    }
+    const char* p = strings;
+    for (uint8_t i = 1; p < strings_end && *p != '\0'; ++i) {
+      const auto* end = static_cast<const char*>(std::memchr(p, '\0', static_cast<size_t>(strings_end - p)));
+      if (end == nullptr) {
+        return {};
+      }
+      if (i == number) {
+        return {p, static_cast<size_t>(end - p)};
+      }
+      p = end + 1;
+    }
+    return {};
+  }
+};
+
+/**
+ * Forward range over the structures of a raw SMBIOS structure table (the content of /sys/firmware/dmi/tables/DMI).
+ * Iteration stops at the end-of-table structure (type 127) or at the first malformed structure.
+ */
+class Table {
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Structure;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Structure*;
+    using reference = const Structure&;
+
+    iterator() = default;
+    iterator(const uint8_t* pos, const uint8_t* end) : _end(end) { parse(pos); }
+
+    reference operator*() const { return _current; }
+    pointer operator->() const { return &_current; }
+    iterator& operator++() {
+      parse(_next);
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+    friend bool operator==(const iterator& a, const iterator& b) { return a._current.data == b._current.data; }
+    friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+
+   private:
+    void parse(const uint8_t* pos) {
+      _current = Structure();
+      // header: type, length, handle
+      if (pos == nullptr || _end - pos < 4 || pos[1] < 4 || pos[1] > _end - pos || pos[0] == 127) {
+        return;
+      }
+      // the string set ends with a double NUL (which is also all there is if the structure has no strings)
+      const auto* strings = reinterpret_cast<const char*>(pos + pos[1]);
+      const auto* end = reinterpret_cast<const char*>(_end);
+      const char* p = strings;
+      while (p + 1 < end && (p[0] != '\0' || p[1] != '\0')) {
+        ++p;
+      }
+      if (p + 1 >= end) {
+        return;
+      }
+      _current.type = pos[0];
+      _current.length = pos[1];
+      std::memcpy(&_current.handle, pos + 2, sizeof(_current.handle));
+      _current.data = pos;
+      _current.strings = strings;
+      _current.strings_end = p + 1;
+      _next = reinterpret_cast<const uint8_t*>(p + 2);
+    }
+
+    Structure _current;
+    const uint8_t* _next{nullptr};
+    const uint8_t* _end{nullptr};
+  };
+
+  Table() = default;
+  Table(const void* data, size_t size)
+      : _begin(static_cast<const uint8_t*>(data)), _end(static_cast<const uint8_t*>(data) + size) {}
+
+  HWI_NODISCARD iterator begin() const { return {_begin, _end}; }
+  HWI_NODISCARD iterator end() const { return {}; }
+  HWI_NODISCARD bool empty() const { return _begin == _end; }
+
+ private:
+  const uint8_t* _begin{nullptr};
+  const uint8_t* _end{nullptr};
+};
+
+// Structure types used by hwinfo.
+enum Type : uint8_t {
+  BIOS = 0,
+  System = 1,
+  Baseboard = 2,
+  Chassis = 3,
+  MemoryDevice = 17,
+};
+
+/**
+ * SMBIOS structure table of this machine, loaded once per process: /sys/firmware/dmi/tables/DMI on Linux (root only),
+ * GetSystemFirmwareTable('RSMB') on Windows, the AppleSMBIOS property on Intel Macs. Empty if it cannot be read.
+ * Thread-safe.
+ */
+HWINFO_API const Table& system_table();
+
+// Platform part of system_table(): reads the raw structure table into blob.
+bool read_system_table(std::string& blob);
+
+// Strings that are not set (or only blanks, as some vendors fill them) are "<unknown>" in all of the following.
+struct BiosInfo {
+  std::string vendor;
+  std::string version;
+  std::string release_date;
+};
+
+struct BoardInfo {
+  std::string vendor;
+  std::string name;
+  std::string version;
+  std::string serial_number;
+};
+
+struct ChassisInfo {
+  std::string vendor;
+  // SMBIOS chassis type (3: desktop, 9: laptop, 17: main server chassis, 23: rack mount chassis, ...), -1 if unknown
+  int type{-1};
+  std::string version;
+  std::string serial_number;
+};
+
+// Information of the first structure of the type, false (and "<unknown>" values) if there is none.
+HWINFO_API bool bios(const Table& table, BiosInfo& info);
+HWINFO_API bool baseboard(const Table& table, BoardInfo& info);
+HWINFO_API bool chassis(const Table& table, ChassisInfo& info);
+
+/**
+ * Installed memory modules of the Memory Device (type 17) structures. Empty slots are skipped, values that are not
+ * reported are "<unknown>" or -1.
+ */
+HWINFO_API std::vector<Memory::Module> memory_devices(const Table& table);
+
+}  // namespace smbios
+}  // namespace hwinfo
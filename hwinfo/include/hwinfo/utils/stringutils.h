@@ -3,12 +3,16 @@
 
 #pragma once
 
+#include <hwinfo/platform.h>
+
 #include <algorithm>
 #include <clocale>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace hwinfo {
@@ -42,45 +46,36 @@ inline void replaceAll(std::string& input, const char from, const char to) {
   std::replace(input.begin(), input.end(), from, to);
 }
 
+// _____________________________________________________________________________________________________________________
+inline bool is_strip_space(char c) { return c == ' ' || c == '\t' || c == '\n'; }
+
 /**
- * remove all white spaces (' ', '\t', '\n') from start and end of input
- * inplace!
+ * View of input without white spaces (' ', '\t', '\n') at start and end. Nothing is copied.
  * @param input
+ * @return
  */
-inline void strip(std::string& input) {
-  if (input.empty()) {
-    return;
-  }
-  // optimization for input size == 1
-  if (input.size() == 1) {
-    if (input[0] == ' ' || input[0] == '\t' || input[0] == '\n') {
-      input = "";
-      return;
-    } else {
-      return;
-    }
-  }
-  size_t start_index = 0;
-  while (true) {
-    char c = input[start_index];
-    if (c != ' ' && c != '\t' && c != '\n') {
-      break;
-    }
-    start_index++;
-  }
-  size_t end_index = input.size() - 1;
-  while (true) {
-    char c = input[end_index];
-    if (c != ' ' && c != '\t' && c != '\n') {
-      break;
-    }
-    end_index--;
+inline std::string_view strip_view(std::string_view input) {
+  size_t start = 0;
+  while (start < input.size() && is_strip_space(input[start])) {
+    start++;
   }
-  if (end_index < start_index) {
-    input.assign("");
-    return;
+  size_t end = input.size();
+  while (end > start && is_strip_space(input[end - 1])) {
+    end--;
   }
-  input.assign(input.begin() + start_index, input.begin() + end_index + 1);
+  return input.substr(start, end - start);
+}
+
+/**
+ * remove all white spaces (' ', '\t', '\n') from start and end of input
+ * inplace! (erases in place, the capacity of input is kept)
+ * @param input
+ */
+inline void strip(std::string& input) {
+  const std::string_view stripped = strip_view(input);
+  const size_t start = static_cast<size_t>(stripped.data() - input.data());
+  input.erase(start + stripped.size());
+  input.erase(0, start);
 }
 
 /**
@@ -99,6 +94,103 @@ inline unsigned count_substring(const std::string& input, const std::string& sub
   return occurrences;
 }
 
+/**
+ * Lazy range over the tokens of input separated by delimiter (a char or a string). Tokens are views into input, so
+ * nothing is allocated and input must outlive the range. If skip_empty is set, empty tokens (e.g. between repeated
+ * delimiters) are left out.
+ */
+template <typename Delimiter>
+class SplitRange {
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view*;
+    using reference = std::string_view;
+
+    iterator() = default;
+    iterator(std::string_view input, Delimiter delimiter, bool skip_empty)
+        : _rest(input), _delimiter(delimiter), _skip_empty(skip_empty), _done(false) {
+      advance();
+    }
+
+    std::string_view operator*() const { return _token; }
+    const std::string_view* operator->() const { return &_token; }
+    iterator& operator++() {
+      advance();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator previous = *this;
+      advance();
+      return previous;
+    }
+    bool operator==(const iterator& other) const {
+      return _done == other._done && (_done || _token.data() == other._token.data());
+    }
+    bool operator!=(const iterator& other) const { return !(*this == other); }
+
+   private:
+    static size_t size_of(char /*delimiter*/) { return 1; }
+    static size_t size_of(std::string_view delimiter) { return delimiter.size(); }
+
+    void advance() {
+      do {
+        if (_last) {
+          _done = true;
+          return;
+        }
+        const size_t delimiter_size = size_of(_delimiter);
+        const size_t match = delimiter_size == 0 ? std::string_view::npos : _rest.find(_delimiter);
+        if (match == std::string_view::npos) {
+          _token = _rest;
+          _last = true;
+        } else {
+          _token = _rest.substr(0, match);
+          _rest.remove_prefix(match + delimiter_size);
+        }
+      } while (_skip_empty && _token.empty());
+    }
+
+    std::string_view _rest{};
+    Delimiter _delimiter{};
+    std::string_view _token{};
+    bool _skip_empty{false};
+    bool _last{false};
+    bool _done{true};
+  };
+
+  SplitRange(std::string_view input, Delimiter delimiter, bool skip_empty)
+      : _input(input), _delimiter(delimiter), _skip_empty(skip_empty) {}
+
+  HWI_NODISCARD iterator begin() const { return iterator(_input, _delimiter, _skip_empty); }
+  HWI_NODISCARD iterator end() const { return iterator(); }
+
+ private:
+  std::string_view _input;
+  Delimiter _delimiter;
+  bool _skip_empty;
+};
+
+/**
+ * Split input at delimiter without copying: for (std::string_view token : split_view(input, ':')) ...
+ * Every token is returned, including an empty one after a trailing delimiter (unless skip_empty).
+ * @param input
+ * @param delimiter
+ * @param skip_empty
+ * @return
+ */
+inline SplitRange<std::string_view> split_view(std::string_view input, std::string_view delimiter,
+                                               bool skip_empty = false) {
+  return {input, delimiter, skip_empty};
+}
+
+inline SplitRange<char> split_view(std::string_view input, char delimiter, bool skip_empty = false) {
+  return {input, delimiter, skip_empty};
+}
+
 /**
  * Split input string at delimiter and return result
  * @param input
@@ -107,20 +199,15 @@ inline unsigned count_substring(const std::string& input, const std::string& sub
  */
 inline std::vector<std::string> split(const std::string& input, const std::string& delimiter) {
   std::vector<std::string> result;
-  size_t shift = 0;
-  while (true) {
-    size_t match = input.find(delimiter, shift);
-    result.emplace_back(input.substr(shift, match - shift));
-    if (match == std::string::npos) {
-      break;
-    }
-    shift = match + delimiter.size();
+  for (std::string_view token : split_view(input, std::string_view(delimiter))) {
+    result.emplace_back(token);
   }
   return result;
 }
 
 /**
- * Split input string at delimiter (char) and return result
+ * Split input string at delimiter (char) and return result. Unlike split_view(), the part after the last delimiter is
+ * not returned.
  * @param input
  * @param delimiter
  * @return
@@ -148,25 +235,30 @@ inline std::vector<std::string> split(const std::string& input, const char delim
  * @return
  */
 inline std::string split_get_index(const std::string& input, const std::string& delimiter, int index) {
-  unsigned occ = count_substring(input, delimiter) + 1;
-  index = index < 0 ? static_cast<int>(occ + index) : index;
-  if (static_cast<int>(occ) <= index) {
+  if (delimiter.empty()) {
+    return index == 0 || index == -1 ? input : "";
+  }
+  // single pass from the front (index >= 0) or from the back (index < 0)
+  if (index >= 0) {
+    for (std::string_view token : split_view(input, std::string_view(delimiter))) {
+      if (index-- == 0) {
+        return std::string(token);
+      }
+    }
     return "";
   }
-
-  std::string::size_type start_index = 0;
+  size_t end = input.size();
   while (true) {
-    if (index == 0) {
-      break;
+    const size_t match = end < delimiter.size() ? std::string::npos : input.rfind(delimiter, end - delimiter.size());
+    const size_t start = match == std::string::npos ? 0 : match + delimiter.size();
+    if (++index == 0) {
+      return input.substr(start, end - start);
     }
-    start_index = input.find(delimiter, start_index) + delimiter.size();
-    index--;
-  }
-  std::string::size_type end_index = input.find(delimiter, start_index);
-  if (end_index == std::string::npos) {
-    return {input.begin() + static_cast<int64_t>(start_index), input.end()};
+    if (match == std::string::npos) {
+      return "";
+    }
+    end = match;
   }
-  return {input.begin() + static_cast<int64_t>(start_index), input.begin() + static_cast<int64_t>(end_index)};
 }
 
 /**
@@ -6,15 +6,33 @@
 
 #include <sys/sysctl.h>
 
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
 #include <string>
 
 namespace hwinfo {
 namespace utils {
 
-// Get a string value from sysctl
+// Get a string value from sysctl (including the terminating '\0', as the kernel reports it). Values up to initialSize
+// bytes are read into a stack buffer, so only the result is allocated.
 inline std::string getSysctlString(const char* name, std::string defaultValue = "", size_t initialSize = 256) {
-  auto buffer = std::string(initialSize, '\0');
-  size_t size = buffer.size();
+  char stack_buffer[256];
+  size_t size = sizeof(stack_buffer);
+  if (initialSize <= sizeof(stack_buffer)) {
+    if (sysctlbyname(name, stack_buffer, &size, nullptr, 0) == 0) {
+      return std::string(stack_buffer, size);
+    }
+    if (errno != ENOMEM) {
+      return defaultValue;
+    }
+  }
+  // longer than the stack buffer: query the size
+  size = 0;
+  if (sysctlbyname(name, nullptr, &size, nullptr, 0) != 0 || size == 0) {
+    return defaultValue;
+  }
+  std::string buffer(size, '\0');
   if (sysctlbyname(name, buffer.data(), &size, nullptr, 0) == 0) {
     buffer.resize(size);
     return buffer;
@@ -33,6 +51,88 @@ T getSysctlValue(const char* name, T defaultValue = T()) {
   return defaultValue;
 }
 
+// Integer values are 32 or 64 bit wide (hw.logicalcpu is an int, hw.memsize a uint64_t): widens the size bytes that a
+// read wrote into buffer. False for other sizes.
+inline bool widenSysctlInteger(const unsigned char* buffer, size_t size, int64_t& value) {
+  if (size == sizeof(int32_t)) {
+    int32_t narrow;
+    std::memcpy(&narrow, buffer, sizeof(narrow));
+    value = narrow;
+    return true;
+  }
+  if (size == sizeof(int64_t)) {
+    std::memcpy(&value, buffer, sizeof(value));
+    return true;
+  }
+  return false;
+}
+
+/**
+ * A sysctl name resolved to its MIB once (sysctlnametomib()), so that reading the value is a single sysctl() without
+ * the name lookup of sysctlbyname(). Meant for polled values (vm.swapusage); construct it once, e.g. as a
+ * function-local static. Reads never allocate; thread-safe.
+ */
+class SysctlKey {
+ public:
+  explicit SysctlKey(const char* name) {
+    size_t length = CTL_MAXNAME;
+    if (sysctlnametomib(name, _mib, &length) == 0) {
+      _length = static_cast<unsigned>(length);
+    }
+  }
+
+  HWI_NODISCARD bool valid() const { return _length > 0; }
+
+  // Reads a value of fixed size, e.g. a struct. False if the key is missing or reports another size.
+  template <typename T>
+  bool read(T& value) const {
+    size_t size = sizeof(T);
+    return valid() && sysctl(const_cast<int*>(_mib), _length, &value, &size, nullptr, 0) == 0 && size == sizeof(T);
+  }
+
+  // Reads an integer of either width, see widenSysctlInteger().
+  bool read_int(int64_t& value) const {
+    unsigned char buffer[sizeof(int64_t)];
+    size_t size = sizeof(buffer);
+    return valid() && sysctl(const_cast<int*>(_mib), _length, buffer, &size, nullptr, 0) == 0 &&
+           widenSysctlInteger(buffer, size, value);
+  }
+
+ private:
+  int _mib[CTL_MAXNAME]{};
+  unsigned _length{0};
+};
+
+/**
+ * The values of the CPU, memory and OS collectors that do not change while the system runs, read in a single pass on
+ * first use and kept for the process lifetime. Strings are empty and integers -1 if the key does not exist (e.g.
+ * machdep.cpu.vendor on Apple silicon, hw.l3cachesize on most Macs). Thread-safe.
+ */
+struct SysctlStatic {
+  std::string machine;               // hw.machine
+  std::string cpu_vendor;            // machdep.cpu.vendor
+  std::string cpu_brand;             // machdep.cpu.brand_string
+  std::string os_type;               // kern.ostype
+  std::string os_release;            // kern.osrelease
+  std::string os_product_version;    // kern.osproductversion
+  std::string os_build;              // kern.osversion
+  int64_t physical_cpus{-1};         // hw.physicalcpu
+  int64_t logical_cpus{-1};          // hw.logicalcpu
+  int64_t packages{-1};              // hw.packages
+  int64_t perf_levels{-1};           // hw.nperflevels (Apple silicon)
+  int64_t byte_order{-1};            // hw.byteorder: 1234 or 4321
+  int64_t l1d_cache_Bytes{-1};       // hw.l1dcachesize
+  int64_t l2_cache_Bytes{-1};        // hw.l2cachesize
+  int64_t l3_cache_Bytes{-1};        // hw.l3cachesize
+  int64_t cpu_frequency_Hz{-1};      // hw.cpufrequency (Intel only, as the _max and _min variants)
+  int64_t cpu_frequency_max_Hz{-1};  // hw.cpufrequency_max
+  int64_t cpu_frequency_min_Hz{-1};  // hw.cpufrequency_min
+  int64_t memory_Bytes{-1};          // hw.memsize
+  bool apple_silicon{false};         // hw.machine contains "arm64"
+};
+
+const SysctlStatic& sysctl_static();
+
 }  // namespace utils
 }  // namespace hwinfo
 
@@ -0,0 +1,93 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#pragma once
+
+#include <hwinfo/platform.h>
+
+#include <cstdint>
+
+namespace hwinfo {
+namespace trace {
+
+// Collectors that are accounted separately in builds with HWINFO_TRACE, see hwinfo/stats.h.
+enum class Collector : uint8_t {
+  Battery,
+  CPU,
+  Disk,
+  GPU,
+  MainBoard,
+  Memory,
+  Network,
+  OS,
+  Topology,
+  Cgroup,
+  SMBIOS,
+  Mounts,
+  WMIConnect,
+  Utilisation,
+  ThreadMetrics,
+  MemorySnapshot,
+  DiskStats,
+  FrequencyStats,
+  GPUStats,
+  NetworkStats,
+  ProcessStats,
+  Sensors,
+  Pressure,
+  Interrupts,
+  Nvme,
+  Count  // number of collectors, not a collector
+};
+
+// e.g. "cpu", "disk_stats"
+HWINFO_API const char* name(Collector collector);
+
+#ifdef HWINFO_TRACE
+/**
+ * Accounts the wall time of its lifetime and everything counted on this thread meanwhile to the collector. Scopes
+ * nest: the counters go to the innermost scope, the wall time of an inner scope is also part of the outer one.
+ */
+class HWINFO_API Scope {
+ public:
+  explicit Scope(Collector collector);
+  ~Scope();
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  Collector _collector;
+  // collector of the enclosing scope (Collector::Count outside any scope)
+  Collector _previous;
+  int64_t _start_ns;
+  // counters of the collector at construction, for the arguments of the trace event
+  uint64_t _files_opened;
+  uint64_t _bytes_read;
+  uint64_t _wmi_queries;
+  uint64_t _allocations;
+};
+
+// Count towards the innermost scope of the calling thread, nothing outside of scopes.
+HWINFO_API void count_file_opened();
+HWINFO_API void count_bytes_read(int64_t bytes);
+HWINFO_API void count_wmi_query();
+
+// operator new calls of the process so far (all threads, inside and outside of scopes). HWINFO_TRACE builds replace
+// the global allocation functions to count them.
+HWINFO_API uint64_t allocations();
+
+#define HWINFO_TRACE_SCOPE(collector) \
+  ::hwinfo::trace::Scope hwinfo_trace_scope_(::hwinfo::trace::Collector::collector)
+#define HWINFO_TRACE_FILE_OPENED() ::hwinfo::trace::count_file_opened()
+#define HWINFO_TRACE_BYTES_READ(bytes) ::hwinfo::trace::count_bytes_read(bytes)
+#define HWINFO_TRACE_WMI_QUERY() ::hwinfo::trace::count_wmi_query()
+#else
+// without HWINFO_TRACE the hooks are compiled out, arguments are not evaluated
+#define HWINFO_TRACE_SCOPE(collector) static_cast<void>(0)
+#define HWINFO_TRACE_FILE_OPENED() static_cast<void>(0)
+#define HWINFO_TRACE_BYTES_READ(bytes) static_cast<void>(0)
+#define HWINFO_TRACE_WMI_QUERY() static_cast<void>(0)
+#endif  // HWINFO_TRACE
+
+}  // namespace trace
+}  // namespace hwinfo
@@ -7,8 +7,17 @@
 #include <WbemIdl.h>
 #include <comdef.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 #pragma comment(lib, "wbemuuid.lib")
 
@@ -17,18 +26,219 @@ namespace hwinfo {
 namespace utils {
 namespace WMI {
 
+/**
+ * Connection to ROOT\CIMV2 that is created once per thread and reused by every query on that thread.
+ *
+ * Connecting (COM initialization, CoCreateInstance(CLSID_WbemLocator) and ConnectServer()) takes tens of milliseconds,
+ * while a query on an existing connection is cheap. The session of a thread is released when the thread exits or when
+ * shutdown() is called on that thread, whichever happens first.
+ */
+class Session {
+ public:
+  // Returns the session of the calling thread and connects it on first use.
+  static Session& get();
+  // Releases the session of the calling thread (e.g. before CoUninitialize() by the application or DLL unload). The
+  // next query on this thread reconnects.
+  static void shutdown();
+
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+  ~Session();
+
+  HWI_NODISCARD IWbemServices* service() const { return _service; }
+
+ private:
+  Session();
+
+  bool _com_initialized{false};
+  IWbemLocator* _locator{nullptr};
+  IWbemServices* _service{nullptr};
+};
+
+// Releases the WMI session of the calling thread, see Session::shutdown().
+inline void shutdown() { Session::shutdown(); }
+
+// Stops the enumerations of every thread that uses a copy of the token (see ScopedOptions).
+class CancellationToken {
+ public:
+  void cancel() { _cancelled->store(true, std::memory_order_relaxed); }
+  HWI_NODISCARD bool cancelled() const { return _cancelled->load(std::memory_order_relaxed); }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> _cancelled{std::make_shared<std::atomic<bool>>(false)};
+};
+
+/**
+ * Limits of an enumeration. Results are fetched semi-synchronously: every IEnumWbemClassObject::Next() waits at most
+ * poll_interval, so that the deadline and the token are checked even while a provider does not answer. A provider
+ * that misses the deadline ends the enumeration with the objects received so far.
+ */
+struct Options {
+  // for the whole enumeration, from execute_query() on
+  std::chrono::milliseconds timeout{std::chrono::seconds(15)};
+  std::chrono::milliseconds poll_interval{250};
+  ULONG batch_size{64};
+  std::optional<CancellationToken> cancel;
+};
+
+// Options of the queries of threads without ScopedOptions. Thread-safe.
+Options default_options();
+void set_default_options(const Options& options);
+
+// Overrides the options of the queries of the calling thread while alive, e.g. to cancel a collectAll() task.
+class ScopedOptions {
+ public:
+  explicit ScopedOptions(Options options);
+  ~ScopedOptions();
+  ScopedOptions(const ScopedOptions&) = delete;
+  ScopedOptions& operator=(const ScopedOptions&) = delete;
+
+ private:
+  std::optional<Options> _previous;
+};
+
+enum class Status {
+  Complete,
+  TimedOut,
+  Cancelled,
+  Failed,  // connection, query or provider error
+};
+
+/**
+ * Status of the last query on the calling thread. The collectors return the objects received before a timeout,
+ * cancellation or provider error, so this tells complete results from partial ones.
+ */
+Status last_status();
+
+// A single query on the session of the calling thread. Cheap to construct.
 struct _WMI {
   _WMI();
   ~_WMI();
+  _WMI(const _WMI&) = delete;
+  _WMI& operator=(const _WMI&) = delete;
   bool execute_query(const std::wstring& query);
+  // Fetches up to count result objects (the caller releases them) into objs and returns false once the enumeration
+  // ended, see status.
+  bool next_batch(IWbemClassObject** objs, ULONG count, ULONG& n);
+  // Single object variant of next_batch().
+  bool next(IWbemClassObject** obj);
+  // Calls f(IWbemClassObject*) for every result object of the last query. Objects are fetched in batches of
+  // Options::batch_size and released after f returned.
+  template <typename F>
+  Status for_each(F&& f);
 
-  IWbemLocator* locator = nullptr;
+  // owned by the thread's Session, do not release
   IWbemServices* service = nullptr;
   IEnumWbemClassObject* enumerator = nullptr;
+  Status status = Status::Complete;
+
+ private:
+  void finish(Status result);
+
+  Options _options;
+  std::chrono::steady_clock::time_point _deadline;
 };
 
+// _____________________________________________________________________________________________________________________
+template <typename F>
+Status _WMI::for_each(F&& f) {
+  std::vector<IWbemClassObject*> objs(std::max<ULONG>(_options.batch_size, 1));
+  ULONG n = 0;
+  while (next_batch(objs.data(), static_cast<ULONG>(objs.size()), n)) {
+    for (ULONG i = 0; i < n; ++i) {
+      f(objs[i]);
+      objs[i]->Release();
+    }
+  }
+  return status;
+}
+
+/**
+ * Converts a VARIANT into the requested type. Numbers are converted with VariantChangeType(), so properties that WMI
+ * reports as strings (e.g. uint64 or perf counter values) convert as well. Strings are converted from BSTR to UTF-8
+ * directly. Returns false (and leaves out untouched) if the property is empty, NULL or not convertible.
+ */
+bool from_variant(const VARIANT& v, bool& out);
+bool from_variant(const VARIANT& v, int& out);
+bool from_variant(const VARIANT& v, unsigned& out);
+bool from_variant(const VARIANT& v, long& out);
+bool from_variant(const VARIANT& v, unsigned long& out);
+bool from_variant(const VARIANT& v, long long& out);
+bool from_variant(const VARIANT& v, unsigned long long& out);
+bool from_variant(const VARIANT& v, double& out);
+bool from_variant(const VARIANT& v, std::string& out);
+bool from_variant(const VARIANT& v, std::wstring& out);
+
+template <typename T>
+bool from_variant(const VARIANT& v, std::optional<T>& out) {
+  T value{};
+  if (!from_variant(v, value)) {
+    return false;
+  }
+  out = std::move(value);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename T>
+void get_property(IWbemClassObject* obj, const std::wstring& field, T& out) {
+  VARIANT v;
+  VariantInit(&v);
+  if (SUCCEEDED(obj->Get(field.c_str(), 0, &v, nullptr, nullptr))) {
+    from_variant(v, out);
+  }
+  VariantClear(&v);
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Row, size_t N, size_t... I>
+void get_row(IWbemClassObject* obj, const std::array<std::wstring, N>& fields, Row& row, std::index_sequence<I...>) {
+  (get_property(obj, fields[I], std::get<I>(row)), ...);
+}
+
+/**
+ * Fetches several properties of a class with a single query, e.g.
+ *   query_rows<std::string, int64_t, bool>(L"Win32_DiskDrive", {L"Model", L"Size", L"MediaLoaded"})
+ * Every result object becomes one row. Missing or unconvertible properties keep their value-initialized default (use
+ * std::optional<T> to tell them apart). Rows received before a timeout are returned as well, see last_status().
+ */
+template <typename... Ts>
+std::vector<std::tuple<Ts...>> query_rows(const std::wstring& wmi_class,
+                                          const std::array<std::wstring, sizeof...(Ts)>& fields,
+                                          const std::wstring& filter = L"") {
+  std::wstring query_string(L"SELECT ");
+  for (size_t i = 0; i < fields.size(); ++i) {
+    if (i > 0) {
+      query_string.append(L", ");
+    }
+    query_string.append(fields[i]);
+  }
+  query_string.append(L" FROM " + wmi_class);
+  if (!filter.empty()) {
+    query_string.append(L" WHERE " + filter);
+  }
+  _WMI wmi;
+  if (!wmi.execute_query(query_string)) {
+    return {};
+  }
+  std::vector<std::tuple<Ts...>> rows;
+  wmi.for_each([&](IWbemClassObject* obj) {
+    std::tuple<Ts...> row{};
+    get_row(obj, fields, row, std::index_sequence_for<Ts...>{});
+    rows.push_back(std::move(row));
+  });
+  return rows;
+}
+
+// Single property variant of query_rows().
 template <typename T>
-std::vector<T> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter = L"");
+std::vector<T> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter = L"") {
+  std::vector<T> result;
+  for (auto& row : query_rows<T>(wmi_class, {field}, filter)) {
+    result.push_back(std::move(std::get<0>(row)));
+  }
+  return result;
+}
 
 }  // namespace WMI
 }  // namespace utils
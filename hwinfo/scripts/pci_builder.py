@@ -4,11 +4,17 @@ Author: Leon Freist <freist.leon@gmail.com>
 
 This script is used to build a compile time PCI ID mapper in C++.
 We use the pci.ids file (https://pci-ids.ucw.cz/v2.2/pci.ids) licenced under BSD3.
+
+The generated header (include/hwinfo/utils/pci_table.h) contains sorted constexpr tables of vendors, devices and
+subsystems that index into one shared, deduplicated string pool. hwinfo::PCIMapper binary searches these tables, so no
+parsing is done at runtime.
+
+usage: python3 scripts/pci_builder.py [path/to/pci.ids] [path/to/pci_table.h]
 """
 
 import sys
 from dataclasses import dataclass, field
-from typing import Generator, Optional
+from typing import Dict, Generator, List, Optional, Tuple
 from collections import OrderedDict
 
 
@@ -38,43 +44,173 @@ class PCIParser:
         last_vendor: Optional[PCIVendor] = None
         last_device_id: str = ""
         for line in self.read_lines():
+            if line.startswith("C "):
+                # device class section starts: no more vendors/devices follow
+                break
             processed_line = line.strip()
+            if "  " not in processed_line:
+                continue
             _id, _info = processed_line.split("  ", maxsplit=1)
             if line.startswith('\t'):
+                if last_vendor is None:
+                    continue
                 # device or subsystem
                 if line.startswith("\t\t"):
                     # subsystem
-                    last_vendor.devices[last_device_id].subsystems[_id] = _info
+                    if last_device_id in last_vendor.devices:
+                        last_vendor.devices[last_device_id].subsystems.setdefault(_id, _info)
                 else:
                     # device
-                    last_vendor.devices[_id] = PCIDevice(_id, _info)
+                    last_vendor.devices.setdefault(_id, PCIDevice(_id, _info))
                     last_device_id = _id
             else:
                 if last_vendor:
                     yield last_vendor
                 # vendor
                 last_vendor = PCIVendor(_id, _info)
+                last_device_id = ""
+        if last_vendor:
+            yield last_vendor
 
     def read_lines(self) -> Generator[str, None, None]:
-        with open(self.in_path) as f:
+        with open(self.in_path, encoding="utf-8", errors="replace") as f:
             for line in f.readlines():
                 # skip all nonsense lines (comments and empty lines)
                 if line.startswith("#") or len(line) == 0 or line == '\n':
                     continue
-                yield line
+                yield line.rstrip("\n")
+
+
+class StringPool:
+    """Deduplicated string pool. Every entry is NUL terminated, offsets point to its first character."""
+
+    def __init__(self):
+        self.offsets: Dict[str, int] = {}
+        self.strings: List[str] = []
+        self.size = 0
+
+    def add(self, value: str) -> Tuple[int, int]:
+        encoded_length = len(value.encode("utf-8"))
+        if value not in self.offsets:
+            self.offsets[value] = self.size
+            self.strings.append(value)
+            self.size += encoded_length + 1
+        return self.offsets[value], encoded_length
+
+
+def escape(value: str) -> str:
+    out = []
+    for byte in value.encode("utf-8"):
+        c = chr(byte)
+        if c in ('"', '\\', '?'):
+            out.append('\\' + c)
+        elif 0x20 <= byte < 0x7f:
+            out.append(c)
+        else:
+            out.append(f"\\{byte:03o}")
+    return "".join(out)
+
+
+def build_header(vendors: List[PCIVendor], pci_ids_path: str) -> str:
+    pool = StringPool()
+    vendor_rows, device_rows, subsystem_rows = [], [], []
+
+    for vendor in sorted(vendors, key=lambda v: int(v.id, 16)):
+        v_offset, v_length = pool.add(vendor.name)
+        first_device = len(device_rows)
+        for device in sorted(vendor.devices.values(), key=lambda d: int(d.id, 16)):
+            d_offset, d_length = pool.add(device.name)
+            first_subsystem = len(subsystem_rows)
+            subsystems = []
+            for sub_id, sub_name in device.subsystems.items():
+                sub_vendor, sub_device = sub_id.split()
+                subsystems.append((int(sub_vendor, 16), int(sub_device, 16), sub_name))
+            for sub_vendor, sub_device, sub_name in sorted(subsystems):
+                s_offset, s_length = pool.add(sub_name)
+                subsystem_rows.append(f"{{0x{sub_vendor:04x}, 0x{sub_device:04x}, {s_length}, {s_offset}}}")
+            device_rows.append(f"{{0x{int(device.id, 16):04x}, {d_length}, {d_offset}, {first_subsystem}, "
+                               f"{len(subsystem_rows) - first_subsystem}}}")
+        vendor_rows.append(f"{{0x{int(vendor.id, 16):04x}, {v_length}, {v_offset}, {first_device}, "
+                           f"{len(device_rows) - first_device}}}")
+
+    version = "<unknown>"
+    with open(pci_ids_path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            if line.startswith("#\tVersion:"):
+                version = line.split(":", maxsplit=1)[1].strip()
+                break
+
+    lines = [
+        "/**",
+        " * This file is generated by scripts/pci_builder.py from scripts/pci.ids. Do not edit it by hand.",
+        f" * pci.ids version: {version}",
+        " */",
+        "",
+        "#pragma once",
+        "",
+        "#include <cstdint>",
+        "",
+        "namespace hwinfo {",
+        "namespace pci_table {",
+        "",
+        "struct VendorEntry {",
+        "  uint16_t id;",
+        "  uint16_t name_length;",
+        "  uint32_t name_offset;",
+        "  uint32_t first_device;",
+        "  uint32_t num_devices;",
+        "};",
+        "",
+        "struct DeviceEntry {",
+        "  uint16_t id;",
+        "  uint16_t name_length;",
+        "  uint32_t name_offset;",
+        "  uint32_t first_subsystem;",
+        "  uint32_t num_subsystems;",
+        "};",
+        "",
+        "struct SubsystemEntry {",
+        "  uint16_t subvendor_id;",
+        "  uint16_t subdevice_id;",
+        "  uint16_t name_length;",
+        "  uint32_t name_offset;",
+        "};",
+        "",
+        f"inline constexpr uint32_t num_vendors = {len(vendor_rows)};",
+        f"inline constexpr uint32_t num_devices = {len(device_rows)};",
+        f"inline constexpr uint32_t num_subsystems = {len(subsystem_rows)};",
+        "",
+        "// clang-format off",
+        "inline constexpr char names[] =",
+    ]
+    lines += [f'    "{escape(s)}\\0"' for s in pool.strings]
+    lines[-1] += ";"
+    lines += ["", "inline constexpr VendorEntry vendors[] = {"]
+    lines += [f"    {row}," for row in vendor_rows]
+    lines += ["};", "", "inline constexpr DeviceEntry devices[] = {"]
+    lines += [f"    {row}," for row in device_rows]
+    lines += ["};", "", "inline constexpr SubsystemEntry subsystems[] = {"]
+    lines += [f"    {row}," for row in subsystem_rows]
+    lines += [
+        "};",
+        "// clang-format on",
+        "",
+        "}  // namespace pci_table",
+        "}  // namespace hwinfo",
+        "",
+    ]
+    return "\n".join(lines)
 
 
 if __name__ == "__main__":
     import os
-    path = "pci.ids"
-    if not os.path.isfile(path):
-        path = "scripts/pci.ids"
-    if not os.path.isfile(path):
-        path = "hwinfo/scripts/pci.ids"
-    else:
+    script_dir = os.path.dirname(os.path.abspath(__file__))
+    in_path = sys.argv[1] if len(sys.argv) > 1 else os.path.join(script_dir, "pci.ids")
+    out_path = sys.argv[2] if len(sys.argv) > 2 else os.path.join(script_dir, "..", "include", "hwinfo", "utils",
+                                                                   "pci_table.h")
+    if not os.path.isfile(in_path):
         print("pci.ids file could not be found")
         exit(1)
-    parser = PCIParser(path)
-    for vendor in parser.parse():
-        print(f"{'{'}{vendor.id}")
-
+    parser = PCIParser(in_path)
+    with open(out_path, "w", encoding="utf-8", newline="\n") as out:
+        out.write(build_header(list(parser.parse()), in_path))
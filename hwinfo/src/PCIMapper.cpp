@@ -9,109 +9,110 @@
 
 #ifdef HWINFO_UNIX
 
-#include <hwinfo/utils/pci.ids.h>
+#include <hwinfo/utils/pci_table.h>
 #include <hwinfo/utils/stringutils.h>
 
-#include <sstream>
+#include <algorithm>
+#include <charconv>
 
 namespace hwinfo {
 
+namespace {
+
+// _____________________________________________________________________________________________________________________
+std::string_view table_string(uint32_t offset, uint16_t length) {
+  return {pci_table::names + offset, length};
+}
+
+// _____________________________________________________________________________________________________________________
+bool parse_pci_id(std::string_view id, uint16_t& out) {
+  id = utils::strip_view(id);
+  if (id.size() > 2 && id[0] == '0' && (id[1] == 'x' || id[1] == 'X')) {
+    id.remove_prefix(2);
+  }
+  if (id.empty()) {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(id.data(), id.data() + id.size(), out, 16);
+  return ec == std::errc() && ptr == id.data() + id.size();
+}
+
 // _____________________________________________________________________________________________________________________
-PCIDevice::PCIDevice(std::string d_id, std::string d_name)
-    : device_id(std::move(d_id)), device_name(std::move(d_name)) {}
+template <typename Entry>
+const Entry* find_by_id(const Entry* first, const Entry* last, uint16_t id) {
+  auto it = std::lower_bound(first, last, id, [](const Entry& e, uint16_t value) { return e.id < value; });
+  if (it == last || it->id != id) {
+    return nullptr;
+  }
+  return it;
+}
+
+}  // namespace
 
 // _____________________________________________________________________________________________________________________
-PCIVendor::PCIVendor(std::string v_id, std::string v_name)
-    : vendor_id(std::move(v_id)), vendor_name(std::move(v_name)) {}
+PCIDevice::PCIDevice(const pci_table::DeviceEntry* entry)
+    : device_id(entry->id), device_name(table_string(entry->name_offset, entry->name_length)), _entry(entry) {}
 
 // _____________________________________________________________________________________________________________________
-const PCIDevice& PCIVendor::operator[](const std::string& device_id) const {
-  std::string d_id =
-      utils::starts_with(device_id, "0x") ? std::string(device_id.begin() + 2, device_id.end()) : device_id;
-  if (devices.find(d_id) == devices.end()) {
-    return _invalid_device;
+std::string_view PCIDevice::subsystem_name(uint16_t subvendor_id, uint16_t subdevice_id) const {
+  if (_entry == nullptr) {
+    return "invalid";
+  }
+  const pci_table::SubsystemEntry* first = pci_table::subsystems + _entry->first_subsystem;
+  const pci_table::SubsystemEntry* last = first + _entry->num_subsystems;
+  auto it = std::lower_bound(first, last, std::make_pair(subvendor_id, subdevice_id),
+                             [](const pci_table::SubsystemEntry& e, const std::pair<uint16_t, uint16_t>& value) {
+                               return std::make_pair(e.subvendor_id, e.subdevice_id) < value;
+                             });
+  if (it == last || it->subvendor_id != subvendor_id || it->subdevice_id != subdevice_id) {
+    return "invalid";
   }
-  return devices.at(d_id);
+  return table_string(it->name_offset, it->name_length);
 }
 
 // _____________________________________________________________________________________________________________________
-PCIMapper::PCIMapper() {
-  std::stringstream s_pciid(get_pci_ids());
-  PCIVendor* current_vendor = nullptr;
-  PCIDevice* current_device = nullptr;
-  while (true) {
-    std::string line;
-    if (!std::getline(s_pciid, line)) {
-      break;
-    }
-    if (utils::starts_with(line, "#") || utils::starts_with(line, "\n") || line.empty()) {
-      // empty line or comment
-      continue;
-    }
-    if (utils::starts_with(line, "\t\t")) {
-      // subsystem entry
-      utils::strip(line);
-      auto split_line = utils::split(line, "  ");
-      if (split_line.size() != 2 || current_device == nullptr) {
-        // parse error
-        continue;
-      }
-      current_device->subsystems.insert({split_line[0], split_line[1]});
-    } else if (utils::starts_with(line, "\t")) {
-      // device
-      utils::strip(line);
-      auto split_line = utils::split(line, "  ");
-      if (split_line.size() != 2 || current_vendor == nullptr) {
-        // parse error
-        continue;
-      }
-      current_vendor->devices.insert({split_line[0], {split_line[0], split_line[1]}});
-      current_device = &current_vendor->devices.at(split_line[0]);
-    } else {
-      // vendor
-      utils::strip(line);
-      auto split_line = utils::split(line, "  ");
-      if (split_line.size() != 2) {
-        // parse error
-        continue;
-      }
-      _vendors.insert({split_line[0], {split_line[0], split_line[1]}});
-      current_vendor = &_vendors.at(split_line[0]);
-    }
+PCIVendor::PCIVendor(const pci_table::VendorEntry* entry)
+    : vendor_id(entry->id), vendor_name(table_string(entry->name_offset, entry->name_length)), _entry(entry) {}
+
+// _____________________________________________________________________________________________________________________
+PCIDevice PCIVendor::device_from_id(uint16_t device_id) const {
+  if (_entry == nullptr) {
+    return {};
   }
+  const pci_table::DeviceEntry* first = pci_table::devices + _entry->first_device;
+  const pci_table::DeviceEntry* entry = find_by_id(first, first + _entry->num_devices, device_id);
+  return entry == nullptr ? PCIDevice() : PCIDevice(entry);
 }
 
 // _____________________________________________________________________________________________________________________
-const PCIVendor& PCIMapper::vendor_from_id(const std::string& vendor_id) const {
-  std::string v_id =
-      utils::starts_with(vendor_id, "0x") ? std::string(vendor_id.begin() + 2, vendor_id.end()) : vendor_id;
-  if (_vendors.find(v_id) == _vendors.end()) {
-    return _invalid_vendor;
+PCIDevice PCIVendor::device_from_id(std::string_view device_id) const {
+  uint16_t id = 0;
+  if (!parse_pci_id(device_id, id)) {
+    return {};
   }
-  return _vendors.at(v_id);
+  return device_from_id(id);
 }
 
 // _____________________________________________________________________________________________________________________
-const PCIVendor& PCIMapper::operator[](const std::string& vendor_id) const { return vendor_from_id(vendor_id); }
+PCIVendor PCIMapper::vendor_from_id(uint16_t vendor_id) const {
+  const pci_table::VendorEntry* entry =
+      find_by_id(pci_table::vendors, pci_table::vendors + pci_table::num_vendors, vendor_id);
+  return entry == nullptr ? PCIVendor() : PCIVendor(entry);
+}
+
+// _____________________________________________________________________________________________________________________
+PCIVendor PCIMapper::vendor_from_id(std::string_view vendor_id) const {
+  uint16_t id = 0;
+  if (!parse_pci_id(vendor_id, id)) {
+    return {};
+  }
+  return vendor_from_id(id);
+}
 
 // _____________________________________________________________________________________________________________________
-PCIMapper PCI::getMapper() {
-  const auto getenv = [](const char* name) -> std::string {
-
-#ifdef _MSC_VER
-    char* value;
-    size_t size;
-    _dupenv_s(&value, &size, name);
-    std::string ret(value);
-    free(value);
-#else
-    std::string ret(std::getenv(name));
-#endif
-    return ret;
-  };
-
-  static std::string path = getenv("HOME");
-  static PCIMapper mapper;
+const PCIMapper& PCI::getMapper() {
+  // function local static: initialization is thread-safe and happens at first use
+  static const PCIMapper mapper;
   return mapper;
 }
 
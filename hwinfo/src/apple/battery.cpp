@@ -12,6 +12,7 @@
 #include <iostream>
 
 #include "hwinfo/battery.h"
+#include "hwinfo/utils/trace.h"
 
 namespace hwinfo {
 
@@ -46,13 +47,13 @@ CFDictionaryRef getPowerSource(const int id) {
 }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getVendor() const { return "<unknown>"; }
+InternedString Battery::getVendor() const { return "<unknown>"; }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getModel() const { return "<unknown>"; }
+InternedString Battery::getModel() const { return "<unknown>"; }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getSerialNumber() const {
+InternedString Battery::getSerialNumber() const {
   const CFDictionaryRef powerSource = getPowerSource(_id);
   if (!powerSource) {
     return "<unknown>";
@@ -76,7 +77,7 @@ std::string Battery::getSerialNumber() const {
 }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getTechnology() const { return "<unknown>"; }
+InternedString Battery::getTechnology() const { return "<unknown>"; }
 
 // _____________________________________________________________________________________________________________________
 uint32_t Battery::getEnergyFull() const {
@@ -132,9 +133,18 @@ bool Battery::charging() const {
 // _____________________________________________________________________________________________________________________
 bool Battery::discharging() const { return !charging(); }
 
+// _____________________________________________________________________________________________________________________
+BatteryStatus Battery::status() const {
+  BatteryStatus status;
+  status.energyNow = energyNow();
+  status.charging = charging();
+  return status;
+}
+
 // =====================================================================================================================
 // _____________________________________________________________________________________________________________________
 std::vector<Battery> getAllBatteries() {
+  HWINFO_TRACE_SCOPE(Battery);
   std::vector<Battery> batteries;
 
   const CFTypeRef powerInfo = IOPSCopyPowerSourcesInfo();
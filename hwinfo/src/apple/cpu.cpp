@@ -9,11 +9,15 @@
 #include <mach/mach_time.h>
 #include <sys/sysctl.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "hwinfo/cpu.h"
+#include "hwinfo/cpu_times.h"
+#include "hwinfo/utils/jiffies.h"
 #include "hwinfo/utils/sysctl.h"
+#include "hwinfo/utils/trace.h"
 
 #if defined(HWINFO_X86)
 #include "hwinfo/cpuid.h"
@@ -24,21 +28,13 @@ namespace hwinfo {
 // Helper functions to reduce code duplication
 namespace {
 
-// Check if the system is running on Apple Silicon
-bool isAppleSilicon() {
-  auto machine = utils::getSysctlString("hw.machine");
-  return machine.find("arm64") != std::string::npos;
-}
-
-// Get the number of physical CPU cores
-int getPhysicalCoreCount() { return utils::getSysctlValue<int>("hw.physicalcpu", 0); }
-
 // Calculate CPU frequency for Apple Silicon - simplified version
 int64_t getCpuFrequency(bool isMax = true) {
   // Try to get CPU frequency directly
-  uint64_t directFreq = utils::getSysctlValue<uint64_t>(isMax ? "hw.cpufrequency_max" : "hw.cpufrequency", 0);
+  const utils::SysctlStatic& sysctl = utils::sysctl_static();
+  const int64_t directFreq = isMax ? sysctl.cpu_frequency_max_Hz : sysctl.cpu_frequency_Hz;
   if (directFreq > 0) {
-    return static_cast<int64_t>(directFreq / 1000000);
+    return directFreq / 1000000;
   }
 
   // If we can't get a direct measurement, return -1
@@ -55,34 +51,14 @@ int64_t getRegularClockSpeed_MHz(const int& core_id) { return getCpuFrequency(fa
 
 // _____________________________________________________________________________________________________________________
 int64_t getMinClockSpeed_MHz(const int& core_id) {
-  return utils::getSysctlValue<uint64_t>("hw.cpufrequency_min", 0) / 1000000;
+  return std::max<int64_t>(utils::sysctl_static().cpu_frequency_min_Hz, 0) / 1000000;
 }
 
 // _____________________________________________________________________________________________________________________
 std::vector<int64_t> CPU::currentClockSpeed_MHz() const {
-  std::vector<int64_t> clockSpeeds;
-
-  processor_info_array_t cpuInfo;
-  mach_msg_type_number_t numCpuInfo;
-  natural_t numCPUs = 0;
-
-  kern_return_t err = host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &numCPUs, &cpuInfo, &numCpuInfo);
-
-  if (err == KERN_SUCCESS) {
-    // Get CPU frequency
-    int64_t freq_mhz = utils::getSysctlValue<uint64_t>("hw.cpufrequency", 0) / 1000000;
-
-    // Fill the vector with the frequency for each logical CPU
-    clockSpeeds.resize(_numLogicalCores, freq_mhz > 0 ? freq_mhz : -1);
-
-    // Free the processor info when done
-    vm_deallocate(mach_task_self(), (vm_address_t)cpuInfo, numCpuInfo * sizeof(natural_t));
-  } else {
-    // If we can't get processor info, still resize the vector to match the number of cores
-    clockSpeeds.resize(_numLogicalCores, -1);
-  }
-
-  return clockSpeeds;
+  // macOS does not report the current clock of a cpu, the nominal one is reported for all of them
+  const int64_t freq_mhz = getCpuFrequency(false);
+  return std::vector<int64_t>(_numLogicalCores > 0 ? _numLogicalCores : 0, freq_mhz);
 }
 
 // _____________________________________________________________________________________________________________________
@@ -97,146 +73,16 @@ std::string getVendor() {
   return vendor;
 #else
   // Try to get vendor from sysctl
-  auto vendor = utils::getSysctlString("machdep.cpu.vendor", "<unknown>");
-
-  // Check if this is Apple Silicon
-  if (vendor == "<unknown>" && isAppleSilicon()) {
-    return "Apple";
+  const utils::SysctlStatic& sysctl = utils::sysctl_static();
+  if (!sysctl.cpu_vendor.empty()) {
+    return sysctl.cpu_vendor;
   }
 
-  return vendor;
+  // Check if this is Apple Silicon
+  return sysctl.apple_silicon ? "Apple" : "<unknown>";
 #endif
 }
 
-// _____________________________________________________________________________________________________________________
-double CPU::currentUtilisation() const {
-  host_cpu_load_info_data_t cpuinfo;
-  mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
-
-  static uint64_t lastTotalTicks = 0;
-  static uint64_t lastIdleTicks = 0;
-
-  if (host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, (host_info_t)&cpuinfo, &count) == KERN_SUCCESS) {
-    uint64_t totalTicks = 0;
-    for (int i_tick = 0; i_tick < CPU_STATE_MAX; i_tick++) {
-      totalTicks += cpuinfo.cpu_ticks[i_tick];
-    }
-
-    uint64_t idleTicks = cpuinfo.cpu_ticks[CPU_STATE_IDLE];
-
-    uint64_t totalTicksSinceLastTime = totalTicks - lastTotalTicks;
-    uint64_t idleTicksSinceLastTime = idleTicks - lastIdleTicks;
-
-    lastTotalTicks = totalTicks;
-    lastIdleTicks = idleTicks;
-
-    if (totalTicksSinceLastTime > 0) {
-      return 1.0 - ((double)idleTicksSinceLastTime / totalTicksSinceLastTime);
-    }
-  }
-
-  return -1.0;
-}
-
-// _____________________________________________________________________________________________________________________
-double CPU::threadUtilisation(int thread_index) const {
-  // On macOS, getting per-thread utilization requires more complex code
-  // This is a simplified implementation that returns the same value for all threads
-  if (thread_index >= 0 && thread_index < _numLogicalCores) {
-    processor_cpu_load_info_t cpuLoad;
-    mach_msg_type_number_t processorMsgCount;
-    natural_t processorCount;
-
-    kern_return_t err = host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &processorCount,
-                                            (processor_info_array_t*)&cpuLoad, &processorMsgCount);
-
-    if (err == KERN_SUCCESS && thread_index < processorCount) {
-      static std::vector<uint64_t> lastTotalTicks;
-      static std::vector<uint64_t> lastIdleTicks;
-
-      // Initialize on first call
-      if (lastTotalTicks.size() != processorCount) {
-        lastTotalTicks.resize(processorCount, 0);
-        lastIdleTicks.resize(processorCount, 0);
-      }
-
-      uint64_t totalTicks = 0;
-      for (int state = 0; state < CPU_STATE_MAX; state++) {
-        totalTicks += cpuLoad[thread_index].cpu_ticks[state];
-      }
-
-      uint64_t idleTicks = cpuLoad[thread_index].cpu_ticks[CPU_STATE_IDLE];
-
-      uint64_t totalTicksSinceLastTime = totalTicks - lastTotalTicks[thread_index];
-      uint64_t idleTicksSinceLastTime = idleTicks - lastIdleTicks[thread_index];
-
-      lastTotalTicks[thread_index] = totalTicks;
-      lastIdleTicks[thread_index] = idleTicks;
-
-      vm_deallocate(mach_task_self(), (vm_address_t)cpuLoad,
-                    processorMsgCount * sizeof(processor_cpu_load_info_data_t));
-
-      if (totalTicksSinceLastTime > 0) {
-        return 1.0 - ((double)idleTicksSinceLastTime / totalTicksSinceLastTime);
-      }
-    }
-
-    if (err == KERN_SUCCESS) {
-      vm_deallocate(mach_task_self(), (vm_address_t)cpuLoad,
-                    processorMsgCount * sizeof(processor_cpu_load_info_data_t));
-    }
-  }
-
-  return -1.0;
-}
-
-// _____________________________________________________________________________________________________________________
-std::vector<double> CPU::threadsUtilisation() const {
-  std::vector<double> thread_utility;
-  processor_cpu_load_info_t cpuLoad;
-  mach_msg_type_number_t processorMsgCount;
-  natural_t processorCount;
-
-  kern_return_t err = host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &processorCount,
-                                          (processor_info_array_t*)&cpuLoad, &processorMsgCount);
-
-  if (err == KERN_SUCCESS) {
-    static std::vector<uint64_t> lastTotalTicks;
-    static std::vector<uint64_t> lastIdleTicks;
-
-    // Initialize on first call
-    if (lastTotalTicks.size() != processorCount) {
-      lastTotalTicks.resize(processorCount, 0);
-      lastIdleTicks.resize(processorCount, 0);
-    }
-
-    thread_utility.resize(processorCount, -1.0);
-
-    for (natural_t i = 0; i < processorCount; i++) {
-      uint64_t totalTicks = 0;
-      for (int state = 0; state < CPU_STATE_MAX; state++) {
-        totalTicks += cpuLoad[i].cpu_ticks[state];
-      }
-
-      uint64_t idleTicks = cpuLoad[i].cpu_ticks[CPU_STATE_IDLE];
-
-      uint64_t totalTicksSinceLastTime = totalTicks - lastTotalTicks[i];
-      uint64_t idleTicksSinceLastTime = idleTicks - lastIdleTicks[i];
-
-      lastTotalTicks[i] = totalTicks;
-      lastIdleTicks[i] = idleTicks;
-
-      if (totalTicksSinceLastTime > 0) {
-        thread_utility[i] = 1.0 - ((double)idleTicksSinceLastTime / totalTicksSinceLastTime);
-      }
-    }
-
-    vm_deallocate(mach_task_self(), (vm_address_t)cpuLoad, processorMsgCount * sizeof(processor_cpu_load_info_data_t));
-  }
-
-  return thread_utility;
-}
-
 // _____________________________________________________________________________________________________________________
 std::string getModelName() {
 #if defined(HWINFO_X86)
@@ -267,9 +113,8 @@ std::string getModelName() {
   }
   return model;
 #else
-  std::string name = utils::getSysctlString("machdep.cpu.brand_string", "<unknown> ");
-  name.pop_back();
-  return name;
+  const std::string& name = utils::sysctl_static().cpu_brand;
+  return name.empty() ? "<unknown>" : name;
 #endif
 }
 
@@ -320,7 +165,7 @@ int getNumPhysicalCores() {
   }
   return -1;
 #else
-  return utils::getSysctlValue<int>("hw.physicalcpu", 0);
+  return static_cast<int>(std::max<int64_t>(utils::sysctl_static().physical_cpus, 0));
 #endif
 }
 
@@ -352,33 +197,102 @@ int getNumLogicalCores() {
   }
   return -1;
 #else
-  return utils::getSysctlValue<int>("hw.logicalcpu", 0);
+  return static_cast<int>(std::max<int64_t>(utils::sysctl_static().logical_cpus, 0));
 #endif
 }
 
-int64_t getL1CacheSize_Bytes() { return utils::getSysctlValue<int64_t>("hw.l1dcachesize", -1); }
+int64_t getL1CacheSize_Bytes() { return utils::sysctl_static().l1d_cache_Bytes; }
+
+int64_t getL2CacheSize_Bytes() { return utils::sysctl_static().l2_cache_Bytes; }
+
+int64_t getL3CacheSize_Bytes() { return utils::sysctl_static().l3_cache_Bytes; }
+
+namespace utils {
+
+// _____________________________________________________________________________________________________________________
+// Derived from readCpuTimes(): every reported state is counted, idle is the only one that is not working.
+bool read_jiffies(Jiffies& total, std::vector<Jiffies>& threads) {
+  thread_local std::vector<CpuTimes> times;
+  CpuTimes total_times;
+  if (!readCpuTimes(total_times, times)) {
+    return false;
+  }
+  threads.resize(times.size());
+  for (size_t i = 0; i < times.size(); ++i) {
+    threads[i] = Jiffies(times[i].total(), times[i].busy());
+  }
+  total = Jiffies(total_times.total(), total_times.busy());
+  return true;
+}
+
+}  // namespace utils
 
-int64_t getL2CacheSize_Bytes() { return utils::getSysctlValue<int64_t>("hw.l2cachesize", -1); }
+// _____________________________________________________________________________________________________________________
+// One host_processor_info() call reports the ticks of all cpus. The kernel returns them in freshly mapped memory that
+// cannot be supplied by the caller, threads is reused.
+bool readCpuTimes(CpuTimes& total, std::vector<CpuTimes>& threads) {
+  processor_cpu_load_info_t cpuLoad;
+  mach_msg_type_number_t processorMsgCount;
+  natural_t processorCount;
 
-int64_t getL3CacheSize_Bytes() { return utils::getSysctlValue<int64_t>("hw.l3cachesize", -1); }
+  kern_return_t err = host_processor_info(mach_host_self(), PROCESSOR_CPU_LOAD_INFO, &processorCount,
+                                          (processor_info_array_t*)&cpuLoad, &processorMsgCount);
+  if (err != KERN_SUCCESS) {
+    return false;
+  }
+  threads.resize(processorCount);
+  total = CpuTimes{0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  for (natural_t i = 0; i < processorCount; i++) {
+    // user, system, idle and nice ticks, the other states are not reported
+    CpuTimes& times = threads[i];
+    times = CpuTimes{0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    times.user = cpuLoad[i].cpu_ticks[CPU_STATE_USER];
+    times.nice = cpuLoad[i].cpu_ticks[CPU_STATE_NICE];
+    times.system = cpuLoad[i].cpu_ticks[CPU_STATE_SYSTEM];
+    times.idle = cpuLoad[i].cpu_ticks[CPU_STATE_IDLE];
+    total.user += times.user;
+    total.nice += times.nice;
+    total.system += times.system;
+    total.idle += times.idle;
+  }
+  vm_deallocate(mach_task_self(), (vm_address_t)cpuLoad, processorMsgCount * sizeof(integer_t));
+  return true;
+}
 
 // _____________________________________________________________________________________________________________________
-std::vector<CPU> getAllCPUs() {
+std::vector<CPU> getAllCPUs(CPUFields fields) {
+  HWINFO_TRACE_SCOPE(CPU);
+  if (std::vector<CPU> cached; static_cache::load(cached)) {
+    return cached;
+  }
   std::vector<CPU> cpus;
   CPU cpu;
 
+  cpu._id = 0;
   cpu._vendor = getVendor();
   cpu._modelName = getModelName();
   cpu._numPhysicalCores = getNumPhysicalCores();
   cpu._numLogicalCores = getNumLogicalCores();
-  cpu._maxClockSpeed_MHz = getMaxClockSpeed_MHz(0);
-  cpu._regularClockSpeed_MHz = getRegularClockSpeed_MHz(0);
-  cpu._L1CacheSize_Bytes = getL1CacheSize_Bytes();
-  cpu._L2CacheSize_Bytes = getL2CacheSize_Bytes();
-  cpu._L3CacheSize_Bytes = getL3CacheSize_Bytes();
+  if (contains(fields, CPUFields::Clocks)) {
+    cpu._maxClockSpeed_MHz = getMaxClockSpeed_MHz(0);
+    cpu._regularClockSpeed_MHz = getRegularClockSpeed_MHz(0);
+  }
+  if (contains(fields, CPUFields::Caches)) {
+    cpu._L1CacheSize_Bytes = getL1CacheSize_Bytes();
+    cpu._L2CacheSize_Bytes = getL2CacheSize_Bytes();
+    cpu._L3CacheSize_Bytes = getL3CacheSize_Bytes();
+  }
+#if defined(HWINFO_X86)
+  if (contains(fields, CPUFields::Features)) {
+    cpu._features = cpuid::read_features();
+  }
+#endif
 
   cpus.push_back(cpu);
 
+  if (fields == CPUFields::All) {
+    static_cache::store(cpus);
+  }
   return cpus;
 }
 
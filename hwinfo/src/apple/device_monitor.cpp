@@ -0,0 +1,179 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <IOKit/IOKitLib.h>
+#include <hwinfo/device_monitor.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// IOKit classes whose services are watched, and the component they belong to
+struct Watched {
+  const char* class_name;
+  Component component;
+};
+constexpr Watched watched[] = {
+    {"IOMedia", Component::Disk},
+    {"IONetworkInterface", Component::Network},
+    {"IOPMPowerSource", Component::Battery},
+    {"IOAccelerator", Component::GPU},
+};
+
+// _____________________________________________________________________________________________________________________
+// Releases the services of a notification iterator. This also re-arms the notification.
+bool drain(io_iterator_t iterator) {
+  bool any = false;
+  while (io_object_t service = IOIteratorNext(iterator)) {
+    IOObjectRelease(service);
+    any = true;
+  }
+  return any;
+}
+
+}  // namespace
+
+struct DeviceMonitor::Source {
+  // refcon of one notification: the component it reports
+  struct Registration {
+    Source* source;
+    Component component;
+  };
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t pending{0};
+  bool interrupted{false};
+  // set once the thread registered the notifications (or failed to)
+  bool started{false};
+  bool valid{false};
+  CFRunLoopRef run_loop{nullptr};
+  // signaled by the destructor; a signal stays pending until the run loop performs it, so none is lost
+  CFRunLoopSourceRef stop_source{nullptr};
+  // stable addresses: two per watched class (first match and termination)
+  Registration registrations[2 * (sizeof(watched) / sizeof(watched[0]))];
+  std::thread thread;
+
+  static void notified(void* refcon, io_iterator_t iterator) {
+    auto* registration = static_cast<Registration*>(refcon);
+    if (!drain(iterator)) {
+      return;
+    }
+    Source* source = registration->source;
+    {
+      std::lock_guard<std::mutex> lock(source->mutex);
+      source->pending |= static_cast<uint32_t>(registration->component);
+    }
+    source->cv.notify_all();
+  }
+
+  // The notifications are delivered through a run loop, which this thread runs until the monitor is destroyed.
+  void run() {
+    CFRunLoopSourceContext context{};
+    context.perform = [](void*) { CFRunLoopStop(CFRunLoopGetCurrent()); };
+    stop_source = CFRunLoopSourceCreate(kCFAllocatorDefault, 0, &context);
+    IONotificationPortRef port = stop_source != nullptr ? IONotificationPortCreate(0) : nullptr;
+    std::vector<io_iterator_t> iterators;
+    if (port != nullptr) {
+      CFRunLoopAddSource(CFRunLoopGetCurrent(), stop_source, kCFRunLoopDefaultMode);
+      CFRunLoopAddSource(CFRunLoopGetCurrent(), IONotificationPortGetRunLoopSource(port), kCFRunLoopDefaultMode);
+      size_t i = 0;
+      for (const auto& entry : watched) {
+        for (const char* type : {kIOFirstMatchNotification, kIOTerminatedNotification}) {
+          Registration& registration = registrations[i++];
+          registration = {this, entry.component};
+          io_iterator_t iterator = 0;
+          // consumes the matching dictionary
+          if (IOServiceAddMatchingNotification(port, type, IOServiceMatching(entry.class_name), &Source::notified,
+                                               &registration, &iterator) == KERN_SUCCESS) {
+            // the services that exist already are not changes, but draining arms the notification
+            drain(iterator);
+            iterators.push_back(iterator);
+          }
+        }
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      valid = !iterators.empty();
+      run_loop = CFRunLoopGetCurrent();
+      started = true;
+    }
+    cv.notify_all();
+
+    if (valid) {
+      CFRunLoopRun();
+    }
+    for (io_iterator_t iterator : iterators) {
+      IOObjectRelease(iterator);
+    }
+    if (port != nullptr) {
+      IONotificationPortDestroy(port);
+    }
+    if (stop_source != nullptr) {
+      CFRunLoopSourceInvalidate(stop_source);
+      CFRelease(stop_source);
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+DeviceMonitor::DeviceMonitor() : _source(new Source()) {
+  _source->thread = std::thread(&Source::run, _source.get());
+  std::unique_lock<std::mutex> lock(_source->mutex);
+  _source->cv.wait(lock, [this] { return _source->started; });
+}
+
+// _____________________________________________________________________________________________________________________
+DeviceMonitor::~DeviceMonitor() {
+  // unlike CFRunLoopStop(), this also works if the thread did not enter CFRunLoopRun() yet
+  if (_source->valid) {
+    CFRunLoopSourceSignal(_source->stop_source);
+    CFRunLoopWakeUp(_source->run_loop);
+  }
+  _source->thread.join();
+}
+
+// _____________________________________________________________________________________________________________________
+bool DeviceMonitor::valid() const { return _source->valid; }
+
+// _____________________________________________________________________________________________________________________
+int DeviceMonitor::fd() const { return -1; }
+
+// _____________________________________________________________________________________________________________________
+Component DeviceMonitor::wait(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(_source->mutex);
+  const auto ready = [this] { return _source->pending != 0 || _source->interrupted; };
+  if (timeout.count() < 0) {
+    _source->cv.wait(lock, ready);
+  } else {
+    _source->cv.wait_for(lock, timeout, ready);
+  }
+  const auto changed = static_cast<Component>(_source->pending);
+  _source->pending = 0;
+  _source->interrupted = false;
+  return changed;
+}
+
+// _____________________________________________________________________________________________________________________
+void DeviceMonitor::interrupt() {
+  {
+    std::lock_guard<std::mutex> lock(_source->mutex);
+    _source->interrupted = true;
+  }
+  _source->cv.notify_all();
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
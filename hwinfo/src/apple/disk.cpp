@@ -12,76 +12,17 @@
 #include <IOKit/IOKitLib.h>
 #include <IOKit/storage/IOMedia.h>
 #include <hwinfo/disk.h>
+#include <hwinfo/utils/iokit.h>
+#include <hwinfo/utils/trace.h>
 #include <sys/mount.h>
 #include <sys/stat.h>
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace hwinfo {
 
-// kIOMasterPortDefault/kIOMainPortDefault is 0
-static const mach_port_t hc_IOMasterPortDefault = 0;
-
-/**
-  Converts a CFStringRef to a std::string
- */
-std::string cf_to_std(CFStringRef cfString) {
-  if (cfString == nullptr) {
-    return "<unknown>";
-  }
-
-  CFIndex length = CFStringGetLength(cfString);
-  CFIndex maxSize = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8) + 1;
-
-  // Initialize std::string with maxSize and fill with null characters
-  auto out = std::string(maxSize, '\0');
-
-  // Fill std::string with the actual string
-  auto success = CFStringGetCString(cfString, const_cast<char*>(out.data()), maxSize, kCFStringEncodingUTF8);
-
-  if (!success) {
-    return "<unknown>";
-  }
-
-  // Resize the string to the actual length
-  out.resize(strlen(out.c_str()));
-  return out;
-}
-
-/**
-  Converts a CFNumberRef to a number of type ReturnType
- */
-template <typename NumberType>
-NumberType cf_to_std(CFNumberRef raw, CFNumberType cfNumberEnum) {
-  if (raw == nullptr) {
-    return NumberType();
-  }
-
-  NumberType out;
-  CFNumberGetValue(raw, cfNumberEnum, &out);
-
-  return out;
-}
-
-int64_t cf_to_std(CFNumberRef raw) { return cf_to_std<int64_t>(raw, kCFNumberSInt64Type); }
-
-template <typename ReturnType, typename CFType>
-ReturnType getIORegistryProperty(io_object_t service, CFStringRef key) {
-  // Get the property from I/O Registry
-  auto raw = static_cast<CFType>(IORegistryEntryCreateCFProperty(service, key, kCFAllocatorDefault, 0));
-
-  // Convert the property to a output type
-  ReturnType out = cf_to_std(raw);
-
-  // Release the property
-  if (raw) {
-    CFRelease(raw);
-  };
-
-  return out;
-}
-
 /**
  * Extracts the base disk name (e.g. "disk3") from a
  * BSD device name like "disk3s1s1".
@@ -181,68 +122,58 @@ uint64_t getFreeDiskSpace(const std::string& mountPoint) {
 }
 
 // Retrieves disk information using I/O Kit
-std::vector<Disk> getAllDisks() {
+std::vector<Disk> getAllDisks(DiskFields fields) {
+  HWINFO_TRACE_SCOPE(Disk);
   std::vector<Disk> disks;
 
   // Build a map from BSD devices (diskXsY) and base disks (diskX) to mount points
-  auto mountMap = getBSDToMountPointMapping();
-
-  CFMutableDictionaryRef matchingDict = IOServiceMatching(kIOMediaClass);
-  CFDictionaryAddValue(matchingDict, CFSTR(kIOMediaWholeKey), kCFBooleanTrue);
-
-  io_iterator_t iter;
-  if (IOServiceGetMatchingServices(0, matchingDict, &iter) == KERN_SUCCESS) {
-    int i_disk = 0;
-    while (true) {
-      auto service = IOIteratorNext(iter);
-      if (service == 0) {
-        break;
-      }
+  std::unordered_map<std::string, std::string> mountMap;
+  if (contains(fields, DiskFields::Volumes)) {
+    mountMap = getBSDToMountPointMapping();
+  }
 
-      Disk disk;
-      disk._id = i_disk;
+  // one walk over the IOMedia objects (shared within a collectAll()), every object with all of its properties
+  const auto media = utils::iokit::services(kIOMediaClass);
+  int i_disk = 0;
+  for (const auto& entry : *media) {
+    // whole disks only, not their partitions
+    if (!entry.boolean(CFSTR(kIOMediaWholeKey)).value_or(false)) {
+      continue;
+    }
+    Disk disk;
+    disk._id = i_disk++;
 
-      // Retrieve the BSD name (e.g. "disk3")
-      std::string bsdName = getIORegistryProperty<std::string, CFStringRef>(service, CFSTR(kIOBSDNameKey));
+    // Retrieve the BSD name (e.g. "disk3")
+    std::string bsdName = entry.string(CFSTR(kIOBSDNameKey)).value_or("<unknown>");
+    disk._device_name = bsdName;
 
-      // Get disk name
-      char model[128];
-      if (IORegistryEntryGetName(service, model) != KERN_SUCCESS) {
-        disk._model = "<unknown>";
-      } else {
-        disk._model = model;
-      }
+    if (contains(fields, DiskFields::Identity)) {
+      disk._model = entry.name().empty() ? "<unknown>" : entry.name();
 
       // Guess vendor based on model
-      if (disk._model.find("APPLE") != std::string::npos || disk._model.find("Apple") != std::string::npos) {
+      const std::string_view model = disk._model;
+      if (model.find("APPLE") != std::string_view::npos || model.find("Apple") != std::string_view::npos) {
         disk._vendor = "Apple";
       } else {
         disk._vendor = "<unknown>";
       }
 
-      disk._serialNumber = getIORegistryProperty<std::string, CFStringRef>(service, CFSTR(kIOMediaUUIDKey));
-
-      disk._size_Bytes = getIORegistryProperty<int64_t, CFNumberRef>(service, CFSTR(kIOMediaSizeKey));
-
-      // If there's no BSD name, we can't look it up in the mount map
-      if (!bsdName.empty()) {
-        // Look up this BSD device in the mountMap
-        if (auto it = mountMap.find(bsdName); it != mountMap.end()) {
-          // Get free space for the found mount point
-          const std::string& mountPoint = it->second;
-          disk._free_size_Bytes = getFreeDiskSpace(mountPoint);
-
-          disk._volumes.push_back(mountPoint);
-        }
-      }
-
-      disks.push_back(std::move(disk));
+      disk._serialNumber = entry.string(CFSTR(kIOMediaUUIDKey)).value_or("<unknown>");
+    }
+    if (contains(fields, DiskFields::Size)) {
+      disk._size_Bytes = entry.number(CFSTR(kIOMediaSizeKey)).value_or(0);
+    }
 
-      IOObjectRelease(service);
+    // Look up this BSD device in the mountMap
+    if (auto it = mountMap.find(bsdName); it != mountMap.end()) {
+      // Get free space for the found mount point
+      const std::string& mountPoint = it->second;
+      disk._free_size_Bytes = getFreeDiskSpace(mountPoint);
 
-      i_disk++;
+      disk._volumes.push_back(mountPoint);
     }
-    IOObjectRelease(iter);
+
+    disks.push_back(std::move(disk));
   }
   return disks;
 }
@@ -0,0 +1,119 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <IOKit/IOBSD.h>
+#include <IOKit/IOKitLib.h>
+#include <IOKit/storage/IOBlockStorageDriver.h>
+#include <hwinfo/disk_stats.h>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+int64_t statistic(CFDictionaryRef statistics, CFStringRef key) {
+  const auto number = static_cast<CFNumberRef>(CFDictionaryGetValue(statistics, key));
+  int64_t value = -1;
+  if (number == nullptr || !CFNumberGetValue(number, kCFNumberSInt64Type, &value)) {
+    return -1;
+  }
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+// BSD name ("disk0") of the IOMedia below a block storage driver, empty if there is none.
+std::string media_bsd_name(io_registry_entry_t driver) {
+  io_registry_entry_t media = 0;
+  if (IORegistryEntryGetChildEntry(driver, kIOServicePlane, &media) != KERN_SUCCESS) {
+    return {};
+  }
+  std::string name;
+  const auto value =
+      static_cast<CFStringRef>(IORegistryEntryCreateCFProperty(media, CFSTR(kIOBSDNameKey), kCFAllocatorDefault, 0));
+  if (value != nullptr) {
+    char buffer[64];
+    if (CFGetTypeID(value) == CFStringGetTypeID() &&
+        CFStringGetCString(value, buffer, sizeof(buffer), kCFStringEncodingUTF8)) {
+      name = buffer;
+    }
+    CFRelease(value);
+  }
+  IOObjectRelease(media);
+  return name;
+}
+
+}  // namespace
+
+struct DiskStatsSampler::Source {
+  // BSD name -> index into the sampled disks
+  std::unordered_map<std::string, size_t> index;
+};
+
+// _____________________________________________________________________________________________________________________
+DiskStatsSampler::DiskStatsSampler(std::vector<std::string> device_names)
+    : _device_names(std::move(device_names)),
+      _source(new Source()),
+      _previous(_device_names.size()),
+      _current(_device_names.size()),
+      _stats(_device_names.size()) {
+  for (size_t i = 0; i < _device_names.size(); ++i) {
+    _source->index.emplace(_device_names[i], i);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+DiskStatsSampler::~DiskStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool DiskStatsSampler::read_counters() {
+  // the drivers come and go with the disks: they are looked up on every update, the statistics live there and not in
+  // the IOMedia that getAllDisks() reads
+  io_iterator_t iterator = 0;
+  if (IOServiceGetMatchingServices(0, IOServiceMatching(kIOBlockStorageDriverClass), &iterator) != KERN_SUCCESS) {
+    return false;
+  }
+  bool any = false;
+  while (io_registry_entry_t driver = IOIteratorNext(iterator)) {
+    const auto it = _source->index.find(media_bsd_name(driver));
+    if (it != _source->index.end()) {
+      const auto statistics = static_cast<CFDictionaryRef>(IORegistryEntryCreateCFProperty(
+          driver, CFSTR(kIOBlockStorageDriverStatisticsKey), kCFAllocatorDefault, 0));
+      if (statistics != nullptr) {
+        // times are in ns
+        constexpr int64_t ns_per_ms = 1000 * 1000;
+        Counters& counters = _current[it->second];
+        counters.reads = statistic(statistics, CFSTR(kIOBlockStorageDriverStatisticsReadsKey));
+        counters.writes = statistic(statistics, CFSTR(kIOBlockStorageDriverStatisticsWritesKey));
+        counters.read_Bytes = statistic(statistics, CFSTR(kIOBlockStorageDriverStatisticsBytesReadKey));
+        counters.written_Bytes = statistic(statistics, CFSTR(kIOBlockStorageDriverStatisticsBytesWrittenKey));
+        const int64_t read_time = statistic(statistics, CFSTR(kIOBlockStorageDriverStatisticsTotalReadTimeKey));
+        const int64_t write_time = statistic(statistics, CFSTR(kIOBlockStorageDriverStatisticsTotalWriteTimeKey));
+        counters.read_time_ms = read_time < 0 ? -1 : read_time / ns_per_ms;
+        counters.write_time_ms = write_time < 0 ? -1 : write_time / ns_per_ms;
+        // not reported as such: the summed request time over the period yields the same mean queue depth
+        if (read_time >= 0 && write_time >= 0) {
+          counters.weighted_time_ms = counters.read_time_ms + counters.write_time_ms;
+        }
+        CFRelease(statistics);
+        any = true;
+      }
+    }
+    IOObjectRelease(driver);
+  }
+  IOObjectRelease(iterator);
+  return any;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
@@ -0,0 +1,35 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <hwinfo/frequency_stats.h>
+
+#include <algorithm>
+
+namespace hwinfo {
+
+// no public interface to the cycle counters (IOReport is private)
+struct FrequencySampler::Source {};
+
+// _____________________________________________________________________________________________________________________
+FrequencySampler::FrequencySampler(int num_threads)
+    : _source(new Source()),
+      _previous(static_cast<size_t>(std::max(num_threads, 0))),
+      _current(_previous.size()),
+      _stats(_previous.size()) {}
+
+// _____________________________________________________________________________________________________________________
+FrequencySampler::~FrequencySampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool FrequencySampler::available() const { return false; }
+
+// _____________________________________________________________________________________________________________________
+bool FrequencySampler::read_counters() { return false; }
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
@@ -10,11 +10,13 @@
 #include <vector>
 
 #include "hwinfo/gpu.h"
+#include "hwinfo/utils/trace.h"
 
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
-std::vector<GPU> getAllGPUs() {
+std::vector<GPU> getAllGPUs(GPUFields) {
+  HWINFO_TRACE_SCOPE(GPU);
   std::vector<GPU> gpus{};
   // TODO: implement
   return gpus;
@@ -0,0 +1,31 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <hwinfo/gpu_stats.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+// no telemetry backend yet
+struct GPUStatsSampler::Source {};
+
+// _____________________________________________________________________________________________________________________
+GPUStatsSampler::GPUStatsSampler(std::vector<std::string> pci_bus_ids)
+    : _pci_bus_ids(std::move(pci_bus_ids)), _source(new Source()), _stats(_pci_bus_ids.size()) {}
+
+// _____________________________________________________________________________________________________________________
+GPUStatsSampler::~GPUStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool GPUStatsSampler::read_stats(int64_t /*now_ns*/) { return false; }
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
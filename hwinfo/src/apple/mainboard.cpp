@@ -8,49 +8,44 @@
 #include <IOKit/IOKitLib.h>
 
 #include "hwinfo/mainboard.h"
+#include "hwinfo/utils/iokit.h"
+#include "hwinfo/utils/smbios.h"
+#include "hwinfo/utils/trace.h"
 
-#ifndef kIOMainPortDefault
-#define kIOMainPortDefault kIOMasterPortDefault
-#endif
+#include <utility>
 
 namespace hwinfo {
 
+// _____________________________________________________________________________________________________________________
 std::string get_mainboard_property(CFStringRef property_name) {
-  auto platformExpert = IOServiceGetMatchingService(kIOMainPortDefault, IOServiceMatching("IOPlatformExpertDevice"));
-  if (!platformExpert) {
-    return "<unknown>";
-  }
-
-  auto propertyRef = IORegistryEntryCreateCFProperty(platformExpert, property_name, kCFAllocatorDefault, 0);
-
-  IOObjectRelease(platformExpert);
-
-  if (!propertyRef) {
-    return "<unknown>";
-  }
-
+  const auto experts = utils::iokit::services("IOPlatformExpertDevice");
   std::string result;
-  if (CFGetTypeID(propertyRef) == CFStringGetTypeID()) {
-    auto stringRef = static_cast<CFStringRef>(propertyRef);
-    auto length = CFStringGetLength(stringRef);
-    auto maxSize = CFStringGetMaximumSizeForEncoding(length, kCFStringEncodingUTF8) + 1;
-
-    auto buffer = std::string(maxSize, '\0');
-    if (CFStringGetCString(stringRef, buffer.data(), maxSize, kCFStringEncodingUTF8)) {
-      result = buffer.c_str();  // Remove trailing nulls
-    }
+  if (!experts->empty()) {
+    result = experts->front().string(property_name).value_or("");
   }
-
-  CFRelease(propertyRef);
   return result.empty() ? "<unknown>" : result;
 }
 
 // _____________________________________________________________________________________________________________________
 MainBoard::MainBoard() {
+  HWINFO_TRACE_SCOPE(MainBoard);
+  if (static_cache::load(*this)) {
+    return;
+  }
+  smbios::BoardInfo board;
+  if (smbios::baseboard(smbios::system_table(), board)) {
+    _vendor = std::move(board.vendor);
+    _name = std::move(board.name);
+    _version = std::move(board.version);
+    _serialNumber = std::move(board.serial_number);
+    static_cache::store(*this);
+    return;
+  }
   _vendor = "<unknown>";
   _name = "<unknown>";
   _version = "<unknown>";
   _serialNumber = get_mainboard_property(CFSTR(kIOPlatformSerialNumberKey));
+  static_cache::store(*this);
 }
 
 }  // namespace hwinfo
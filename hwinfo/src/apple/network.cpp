@@ -2,10 +2,12 @@
 
 #ifdef HWINFO_APPLE
 #include <hwinfo/network.h>
+#include <hwinfo/utils/trace.h>
 
 #include <vector>
 namespace hwinfo {
-std::vector<Network> getAllNetworks() {
+std::vector<Network> getAllNetworks(NetworkFields) {
+  HWINFO_TRACE_SCOPE(Network);
   std::vector<Network> networks;
   return networks;
 }
@@ -0,0 +1,91 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <hwinfo/network_stats.h>
+#include <net/if.h>
+#include <net/route.h>
+#include <sys/socket.h>
+#include <sys/sysctl.h>
+
+#include <cerrno>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+struct NetworkStatsSampler::Source {
+  // interface index -> index into the sampled interfaces
+  std::unordered_map<unsigned, size_t> index;
+  // reused between updates, grown if the routing table does not fit anymore
+  std::vector<char> buffer;
+};
+
+// _____________________________________________________________________________________________________________________
+NetworkStatsSampler::NetworkStatsSampler(std::vector<int> interface_indices)
+    : _interface_indices(std::move(interface_indices)),
+      _source(new Source()),
+      _previous(_interface_indices.size()),
+      _current(_interface_indices.size()),
+      _stats(_interface_indices.size()) {
+  for (size_t i = 0; i < _interface_indices.size(); ++i) {
+    if (_interface_indices[i] > 0) {
+      _source->index.emplace(static_cast<unsigned>(_interface_indices[i]), i);
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+NetworkStatsSampler::~NetworkStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool NetworkStatsSampler::read_counters() {
+  int mib[] = {CTL_NET, PF_ROUTE, 0, 0, NET_RT_IFLIST2, 0};
+  std::vector<char>& buffer = _source->buffer;
+  size_t size = buffer.size();
+  // usually a single sysctl: the size is only queried again if the buffer turned out to be too small
+  while (buffer.empty() || sysctl(mib, 6, buffer.data(), &size, nullptr, 0) != 0) {
+    if (!buffer.empty() && errno != ENOMEM) {
+      return false;
+    }
+    if (sysctl(mib, 6, nullptr, &size, nullptr, 0) != 0) {
+      return false;
+    }
+    // room for interfaces that appear until the next call
+    size += size / 4;
+    buffer.resize(size);
+  }
+
+  for (size_t offset = 0; offset + sizeof(if_msghdr) <= size;) {
+    const auto* header = reinterpret_cast<const if_msghdr*>(buffer.data() + offset);
+    if (header->ifm_msglen == 0) {
+      break;
+    }
+    if (header->ifm_type == RTM_IFINFO2 && offset + sizeof(if_msghdr2) <= size) {
+      const auto* info = reinterpret_cast<const if_msghdr2*>(header);
+      const auto it = _source->index.find(info->ifm_index);
+      if (it != _source->index.end()) {
+        const if_data64& data = info->ifm_data;
+        Counters& counters = _current[it->second];
+        counters.rx_Bytes = static_cast<int64_t>(data.ifi_ibytes);
+        counters.tx_Bytes = static_cast<int64_t>(data.ifi_obytes);
+        counters.rx_packets = static_cast<int64_t>(data.ifi_ipackets);
+        counters.tx_packets = static_cast<int64_t>(data.ifi_opackets);
+        counters.rx_errors = static_cast<int64_t>(data.ifi_ierrors);
+        counters.tx_errors = static_cast<int64_t>(data.ifi_oerrors);
+        counters.rx_drops = static_cast<int64_t>(data.ifi_iqdrops);
+        // not reported: the send queue drops are not part of if_data64
+      }
+    }
+    offset += header->ifm_msglen;
+  }
+  return true;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
@@ -9,28 +9,29 @@
 
 #include "hwinfo/os.h"
 #include "hwinfo/utils/sysctl.h"
+#include "hwinfo/utils/trace.h"
 
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
 OS::OS() {
+  HWINFO_TRACE_SCOPE(OS);
   _name = "macOS";
 
+  const utils::SysctlStatic& sysctl = utils::sysctl_static();
+  const auto orDefault = [](const std::string& value, const char* fallback) {
+    return value.empty() ? std::string(fallback) : value;
+  };
+
   // Get kernel name and version
-  _kernel = utils::getSysctlString("kern.ostype", "<unknown name> ");
-  _kernel.pop_back();
-  _kernel = _kernel + " " + utils::getSysctlString("kern.osrelease", "<unknown version> ");
-  _kernel.pop_back();
+  _kernel = orDefault(sysctl.os_type, "<unknown name>") + " " + orDefault(sysctl.os_release, "<unknown version>");
 
   // get OS name and build version
-  _version = utils::getSysctlString("kern.osproductversion", "<unknown> ");
-  _version.pop_back();
-  _version = _version + " (" + utils::getSysctlString("kern.osversion", "<unknown build> ");
-  _version.pop_back();
-  _version = _version + ")";
+  _version = orDefault(sysctl.os_product_version, "<unknown>") + " (" + orDefault(sysctl.os_build, "<unknown build>") +
+             ")";
 
   // determine endianess
-  const int byteorder = utils::getSysctlValue("hw.byteorder", 0);
+  const int64_t byteorder = sysctl.byte_order;
   _bigEndian = (byteorder == 4321);
   _littleEndian = (byteorder == 1234);
 
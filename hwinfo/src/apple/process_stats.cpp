@@ -0,0 +1,80 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <hwinfo/process_stats.h>
+#include <libproc.h>
+#include <mach/mach_time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+struct ProcessSampler::Source {
+  // ri_user_time and ri_system_time are mach_absolute_time() units (not ns on Apple silicon)
+  double abstime_ns{1.0};
+  // ri_proc_start_abstime of every process at its first update, a pid that was reused by another process has a
+  // different one
+  std::vector<uint64_t> start_time;
+};
+
+// _____________________________________________________________________________________________________________________
+ProcessSampler::ProcessSampler(std::vector<int64_t> pids)
+    : _pids(std::move(pids)),
+      _source(new Source()),
+      _previous(_pids.size()),
+      _current(_pids.size()),
+      _cpu_utilisation(_pids.size(), -1.0),
+      _rss_Bytes(_pids.size(), -1),
+      _read_Bytes_per_s(_pids.size(), -1.0),
+      _written_Bytes_per_s(_pids.size(), -1.0) {
+  // host_processor_info() ticks at CLK_TCK
+  _jiffy_ns = 1e9 / static_cast<double>(std::max<long>(sysconf(_SC_CLK_TCK), 1));
+  mach_timebase_info_data_t timebase;
+  if (mach_timebase_info(&timebase) == KERN_SUCCESS && timebase.denom != 0) {
+    _source->abstime_ns = static_cast<double>(timebase.numer) / static_cast<double>(timebase.denom);
+  }
+  _source->start_time.assign(_pids.size(), 0);
+}
+
+// _____________________________________________________________________________________________________________________
+ProcessSampler::~ProcessSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool ProcessSampler::read_counters() {
+  bool success = false;
+  for (size_t i = 0; i < _pids.size(); ++i) {
+    rusage_info_v2 info;
+    if (_pids[i] <= 0 ||
+        proc_pid_rusage(static_cast<int>(_pids[i]), RUSAGE_INFO_V2, reinterpret_cast<rusage_info_t*>(&info)) != 0) {
+      continue;
+    }
+    uint64_t& start_time = _source->start_time[i];
+    if (start_time == 0) {
+      start_time = info.ri_proc_start_abstime;
+    }
+    if (start_time != info.ri_proc_start_abstime) {
+      continue;
+    }
+    Counters& counters = _current[i];
+    counters.cpu_time_ns =
+        static_cast<int64_t>(static_cast<double>(info.ri_user_time + info.ri_system_time) * _source->abstime_ns);
+    counters.rss_Bytes = static_cast<int64_t>(info.ri_resident_size);
+    counters.read_Bytes = static_cast<int64_t>(info.ri_diskio_bytesread);
+    counters.written_Bytes = static_cast<int64_t>(info.ri_diskio_byteswritten);
+    success = true;
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
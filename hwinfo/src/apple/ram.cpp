@@ -6,27 +6,35 @@
 #ifdef HWINFO_APPLE
 
 #include <hwinfo/ram.h>
+#include <hwinfo/utils/smbios.h>
+#include <hwinfo/utils/sysctl.h>
+#include <hwinfo/utils/trace.h>
+#include <mach/mach.h>
 #include <sys/sysctl.h>
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
 
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
-int64_t getMemSize() {
-  int64_t memSize;
-  size_t size = sizeof(memSize);
-
-  if (sysctlbyname("hw.memsize", &memSize, &size, nullptr, 0) == 0) {
-    return memSize;
-  }
-
-  return -1;
-}
+int64_t getMemSize() { return utils::sysctl_static().memory_Bytes; }
 
 // _____________________________________________________________________________________________________________________
 Memory::Memory() {
-  // TODO: get information for actual memory modules (DIMM)
+  HWINFO_TRACE_SCOPE(Memory);
+  if (static_cache::load(*this)) {
+    return;
+  }
+  // Intel Macs only, Apple silicon has no SMBIOS table
+  _modules = smbios::memory_devices(smbios::system_table());
+  if (!_modules.empty()) {
+    static_cache::store(*this);
+    return;
+  }
+  // TODO: get information for actual memory modules (DIMM) on Apple silicon
   Module module;
   module.vendor = "<unknown>";
   module.name = "<unknown>";
@@ -36,24 +44,65 @@ Memory::Memory() {
   module.total_Bytes = getMemSize();
   module.frequency_Hz = -1;
   _modules.push_back(module);
+  static_cache::store(*this);
 }
 
 // _____________________________________________________________________________________________________________________
-int64_t Memory::free_Bytes() const {
-  // TODO: implement
-  return -1;
+bool MemorySnapshot::update() {
+  HWINFO_TRACE_SCOPE(MemorySnapshot);
+  *this = MemorySnapshot();
+  timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+  total_Bytes = getMemSize();
+  // resolved once, every poll is a single sysctl()
+  static const utils::SysctlKey swap_usage("vm.swapusage");
+  xsw_usage swap{};
+  if (swap_usage.read(swap)) {
+    swap_total_Bytes = static_cast<int64_t>(swap.xsu_total);
+    swap_free_Bytes = static_cast<int64_t>(swap.xsu_avail);
+  }
+  vm_statistics64_data_t vm_stats;
+  mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+  vm_size_t page_size = 0;
+  // the host port is a send right that never changes, no need to deallocate it on every poll
+  static const mach_port_t host = mach_host_self();
+  if (host_page_size(host, &page_size) != KERN_SUCCESS ||
+      host_statistics64(host, HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&vm_stats), &count) != KERN_SUCCESS) {
+    return total_Bytes != -1;
+  }
+  const auto pages = [&](uint64_t num_pages) { return static_cast<int64_t>(num_pages * page_size); };
+  free_Bytes = pages(vm_stats.free_count - std::min(vm_stats.speculative_count, vm_stats.free_count));
+  // what the OS can hand out without swapping: free, speculative, inactive and purgeable pages
+  available_Bytes = pages(uint64_t(vm_stats.free_count) + vm_stats.inactive_count + vm_stats.purgeable_count);
+  cached_Bytes = pages(vm_stats.external_page_count);
+  return true;
 }
 
+// macOS has no NUMA nodes: the whole memory is node 0, see Topology
+struct NumaMemorySampler::Source {};
+
 // _____________________________________________________________________________________________________________________
-int64_t Memory::available_Bytes() const {
-  int64_t usableMemSize;
-  size_t size = sizeof(usableMemSize);
+NumaMemorySampler::NumaMemorySampler() : _source(std::make_unique<Source>()), _nodes(1) {}
 
-  if (sysctlbyname("hw.memsize_usable", &usableMemSize, &size, nullptr, 0) == 0) {
-    return usableMemSize;
-  }
+// _____________________________________________________________________________________________________________________
+NumaMemorySampler::~NumaMemorySampler() = default;
 
-  return -1;
+// _____________________________________________________________________________________________________________________
+bool NumaMemorySampler::update() {
+  MemorySnapshot snapshot;
+  const bool success = snapshot.update();
+  _timestamp_ns = snapshot.timestamp_ns;
+  NodeMemory& node = _nodes[0];
+  node = NodeMemory();
+  node.node = 0;
+  node.total_Bytes = snapshot.total_Bytes;
+  node.free_Bytes = snapshot.free_Bytes;
+  if (node.total_Bytes >= 0 && node.free_Bytes >= 0) {
+    node.used_Bytes = std::max<int64_t>(node.total_Bytes - node.free_Bytes, 0);
+  }
+  node.file_Bytes = snapshot.cached_Bytes;
+  return success;
 }
 
 }  // namespace hwinfo
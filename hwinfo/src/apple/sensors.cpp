@@ -0,0 +1,243 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <IOKit/IOKitLib.h>
+#include <hwinfo/sensors.h>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef kIOMainPortDefault
+#define kIOMainPortDefault kIOMasterPortDefault
+#endif
+
+namespace hwinfo {
+
+namespace {
+
+// The parameter block of the AppleSMC user client (see the open source SMC tools), 80 bytes.
+struct SMCKeyData {
+  struct Version {
+    uint8_t major;
+    uint8_t minor;
+    uint8_t build;
+    uint8_t reserved;
+    uint16_t release;
+  };
+  struct PLimitData {
+    uint16_t version;
+    uint16_t length;
+    uint32_t cpu_limit;
+    uint32_t gpu_limit;
+    uint32_t memory_limit;
+  };
+  struct KeyInfo {
+    uint32_t size;
+    uint32_t type;
+    uint8_t attributes;
+  };
+  uint32_t key;
+  Version version;
+  PLimitData limit;
+  KeyInfo info;
+  uint8_t result;
+  uint8_t status;
+  uint8_t command;
+  uint32_t index;
+  uint8_t bytes[32];
+};
+static_assert(sizeof(SMCKeyData) == 80, "SMCKeyData must match the AppleSMC user client");
+
+// selector of the user client method and the commands it executes
+constexpr uint32_t kSMCHandleYPCEvent = 2;
+constexpr uint8_t kSMCReadKey = 5;
+constexpr uint8_t kSMCGetKeyFromIndex = 8;
+constexpr uint8_t kSMCGetKeyInfo = 9;
+
+// _____________________________________________________________________________________________________________________
+constexpr uint32_t fourCC(const char* code) {
+  return static_cast<uint32_t>(code[0]) << 24 | static_cast<uint32_t>(code[1]) << 16 |
+         static_cast<uint32_t>(code[2]) << 8 | static_cast<uint32_t>(code[3]);
+}
+
+// _____________________________________________________________________________________________________________________
+std::string fourCCString(uint32_t code) {
+  const char chars[] = {static_cast<char>(code >> 24), static_cast<char>(code >> 16), static_cast<char>(code >> 8),
+                        static_cast<char>(code)};
+  return std::string(chars, sizeof(chars));
+}
+
+// _____________________________________________________________________________________________________________________
+// Decodes flt (little endian float, Apple silicon) and the big endian fixed point types spXY (signed) and fpXY
+// (unsigned) with Y fraction bits (sp78: °C, fpe2: RPM, ...). false for other types.
+bool decode(uint32_t type, uint32_t size, const uint8_t* bytes, double& value) {
+  if (type == fourCC("flt ") && size == 4) {
+    float f;
+    std::memcpy(&f, bytes, sizeof(f));
+    value = f;
+    return true;
+  }
+  const std::string name = fourCCString(type);
+  if (size != 2 || (name.compare(0, 2, "sp") != 0 && name.compare(0, 2, "fp") != 0)) {
+    return false;
+  }
+  const char fraction = name[3];
+  int bits = -1;
+  if (fraction >= '0' && fraction <= '9') {
+    bits = fraction - '0';
+  } else if (fraction >= 'a' && fraction <= 'f') {
+    bits = fraction - 'a' + 10;
+  }
+  if (bits < 0) {
+    return false;
+  }
+  const auto raw = static_cast<uint16_t>(bytes[0] << 8 | bytes[1]);
+  const double integer = name[0] == 's' ? static_cast<double>(static_cast<int16_t>(raw)) : static_cast<double>(raw);
+  value = integer / static_cast<double>(1 << bits);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+// Kind of the quantity an SMC key reports, false if it is not a sensor.
+bool kindOf(const std::string& key, SensorKind& kind) {
+  switch (key[0]) {
+    case 'T':
+      kind = SensorKind::Temperature;
+      return true;
+    case 'P':
+      kind = SensorKind::Power;
+      return true;
+    case 'V':
+      kind = SensorKind::Voltage;
+      return true;
+    case 'F':
+      // F<n>Ac: actual fan speed (F<n>Mn, F<n>Mx, ... are limits)
+      kind = SensorKind::Fan;
+      return key[2] == 'A' && key[3] == 'c';
+    default:
+      return false;
+  }
+}
+
+// A sensor key and how its value is read.
+struct Key {
+  uint32_t key;
+  uint32_t type;
+  uint32_t size;
+};
+
+}  // namespace
+
+struct SensorSampler::Source {
+  io_connect_t connection{0};
+  // one per sensor
+  std::vector<Key> keys;
+
+  ~Source() {
+    if (connection != 0) {
+      IOServiceClose(connection);
+    }
+  }
+
+  bool call(SMCKeyData& input, SMCKeyData& output) const {
+    size_t size = sizeof(output);
+    return IOConnectCallStructMethod(connection, kSMCHandleYPCEvent, &input, sizeof(input), &output, &size) ==
+               KERN_SUCCESS &&
+           output.result == 0;
+  }
+
+  bool keyInfo(uint32_t key, SMCKeyData::KeyInfo& info) const {
+    SMCKeyData input{};
+    SMCKeyData output{};
+    input.key = key;
+    input.command = kSMCGetKeyInfo;
+    if (!call(input, output)) {
+      return false;
+    }
+    info = output.info;
+    return true;
+  }
+
+  bool read(const Key& key, uint8_t* bytes) const {
+    SMCKeyData input{};
+    SMCKeyData output{};
+    input.key = key.key;
+    input.info.size = key.size;
+    input.command = kSMCReadKey;
+    if (!call(input, output)) {
+      return false;
+    }
+    std::memcpy(bytes, output.bytes, sizeof(output.bytes));
+    return true;
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+SensorSampler::SensorSampler() : _source(new Source()) {
+  const io_service_t service = IOServiceGetMatchingService(kIOMainPortDefault, IOServiceMatching("AppleSMC"));
+  if (service != 0) {
+    if (IOServiceOpen(service, mach_task_self(), 0, &_source->connection) != KERN_SUCCESS) {
+      _source->connection = 0;
+    }
+    IOObjectRelease(service);
+  }
+  SMCKeyData::KeyInfo info{};
+  uint8_t bytes[32];
+  // #KEY: number of keys (ui32, big endian). Enumerating them once takes a few thousand calls.
+  if (_source->connection != 0 && _source->keyInfo(fourCC("#KEY"), info) &&
+      _source->read({fourCC("#KEY"), info.type, info.size}, bytes)) {
+    const uint32_t count = static_cast<uint32_t>(bytes[0]) << 24 | static_cast<uint32_t>(bytes[1]) << 16 |
+                           static_cast<uint32_t>(bytes[2]) << 8 | static_cast<uint32_t>(bytes[3]);
+    for (uint32_t i = 0; i < count; ++i) {
+      SMCKeyData input{};
+      SMCKeyData output{};
+      input.command = kSMCGetKeyFromIndex;
+      input.index = i;
+      if (!_source->call(input, output)) {
+        continue;
+      }
+      const std::string name = fourCCString(output.key);
+      Sensor sensor;
+      double value = 0;
+      if (!kindOf(name, sensor.kind) || !_source->keyInfo(output.key, info) ||
+          !_source->read({output.key, info.type, info.size}, bytes) || !decode(info.type, info.size, bytes, value)) {
+        continue;
+      }
+      sensor.chip = "smc";
+      sensor.label = name;
+      _source->keys.push_back({output.key, info.type, info.size});
+      _sensors.push_back(std::move(sensor));
+    }
+  }
+  _values.assign(_sensors.size(), std::numeric_limits<double>::quiet_NaN());
+}
+
+// _____________________________________________________________________________________________________________________
+SensorSampler::~SensorSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool SensorSampler::read_values(int64_t /*now_ns*/) {
+  bool success = false;
+  uint8_t bytes[32];
+  for (size_t i = 0; i < _source->keys.size(); ++i) {
+    const Key& key = _source->keys[i];
+    double value = 0;
+    if (_source->read(key, bytes) && decode(key.type, key.size, bytes, value)) {
+      _values[i] = value;
+      success = true;
+    }
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
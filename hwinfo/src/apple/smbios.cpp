@@ -0,0 +1,35 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <IOKit/IOKitLib.h>
+#include <hwinfo/utils/iokit.h>
+#include <hwinfo/utils/smbios.h>
+
+#include <string>
+
+namespace hwinfo {
+namespace smbios {
+
+// _____________________________________________________________________________________________________________________
+bool read_system_table(std::string& blob) {
+  // Intel Macs publish the structure table as a property of the AppleSMBIOS service, Apple silicon has none
+  const auto services = utils::iokit::services("AppleSMBIOS");
+  if (services->empty()) {
+    return false;
+  }
+  CFTypeRef property = services->front().property(CFSTR("SMBIOS"));
+  if (property != nullptr && CFGetTypeID(property) == CFDataGetTypeID()) {
+    const auto data = static_cast<CFDataRef>(property);
+    blob.assign(reinterpret_cast<const char*>(CFDataGetBytePtr(data)), static_cast<size_t>(CFDataGetLength(data)));
+  }
+  return !blob.empty();
+}
+
+}  // namespace smbios
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
@@ -0,0 +1,77 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_APPLE
+
+#include <hwinfo/topology.h>
+#include <hwinfo/utils/sysctl.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <string>
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+Topology Topology::read() {
+  HWINFO_TRACE_SCOPE(Topology);
+  Topology topology;
+  const utils::SysctlStatic& sysctl = utils::sysctl_static();
+  const int logical_cpus = static_cast<int>(std::max<int64_t>(sysctl.logical_cpus, 0));
+  if (logical_cpus <= 0) {
+    return topology;
+  }
+  topology.resize(static_cast<size_t>(logical_cpus));
+  // macOS exposes neither NUMA nodes nor per-cpu package ids
+  topology._num_nodes = 1;
+  std::fill(topology._node.begin(), topology._node.end(), 0);
+
+  const int num_perflevels = static_cast<int>(std::max<int64_t>(sysctl.perf_levels, 0));
+  if (num_perflevels > 0) {
+    // Apple silicon: one socket, cpus are numbered level by level starting with the most efficient one (perflevel0
+    // is the fastest), the L2 cache is shared by a cluster of cores of the same level
+    topology._package_ids.push_back(0);
+    std::fill(topology._socket.begin(), topology._socket.end(), 0);
+    size_t cpu = 0;
+    for (int level = num_perflevels - 1; level >= 0; --level) {
+      const std::string prefix = "hw.perflevel" + std::to_string(level) + ".";
+      const int level_cpus = utils::getSysctlValue<int>((prefix + "logicalcpu").c_str(), 0);
+      const int level_cores = std::max(utils::getSysctlValue<int>((prefix + "physicalcpu").c_str(), level_cpus), 1);
+      const int cpus_per_l2 = std::max(utils::getSysctlValue<int>((prefix + "cpusperl2").c_str(), level_cpus), 1);
+      const int threads_per_core = std::max(level_cpus / level_cores, 1);
+      for (int i = 0; i < level_cpus && cpu < topology.size(); ++i, ++cpu) {
+        topology._core[cpu] = topology._num_cores + i / threads_per_core;
+        topology._cache_domain[cpu] = topology._num_cache_domains + i / cpus_per_l2;
+        topology._efficiency_class[cpu] = num_perflevels - 1 - level;
+      }
+      topology._num_cores += (level_cpus + threads_per_core - 1) / threads_per_core;
+      topology._num_cache_domains += (level_cpus + cpus_per_l2 - 1) / cpus_per_l2;
+    }
+    return topology;
+  }
+
+  // Intel: SMT siblings are numbered next to each other, the L3 cache is shared by the whole package
+  const int num_packages = static_cast<int>(std::max<int64_t>(sysctl.packages, 1));
+  const int physical_cpus =
+      static_cast<int>(std::max<int64_t>(sysctl.physical_cpus > 0 ? sysctl.physical_cpus : logical_cpus, 1));
+  const int threads_per_core = std::max(logical_cpus / physical_cpus, 1);
+  const int cpus_per_package = std::max(logical_cpus / num_packages, 1);
+  for (int cpu = 0; cpu < logical_cpus; ++cpu) {
+    topology._core[cpu] = cpu / threads_per_core;
+    topology._socket[cpu] = std::min(cpu / cpus_per_package, num_packages - 1);
+    topology._cache_domain[cpu] = topology._socket[cpu];
+    topology._efficiency_class[cpu] = 0;
+  }
+  for (int32_t package = 0; package < num_packages; ++package) {
+    topology._package_ids.push_back(package);
+  }
+  topology._num_cores = (logical_cpus + threads_per_core - 1) / threads_per_core;
+  topology._num_cache_domains = num_packages;
+  return topology;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
@@ -0,0 +1,175 @@
+#include <hwinfo/utils/iokit.h>
+
+#ifdef HWINFO_APPLE
+
+#include <hwinfo/utils/trace.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef kIOMainPortDefault
+#define kIOMainPortDefault kIOMasterPortDefault
+#endif
+
+namespace hwinfo {
+namespace utils {
+namespace iokit {
+
+namespace {
+
+// walks shared by the Scopes
+struct Shared {
+  std::mutex mutex;
+  size_t scopes{0};
+  std::map<std::string, std::shared_ptr<const std::vector<Entry>>> walks;
+};
+
+// _____________________________________________________________________________________________________________________
+Shared& shared() {
+  static Shared* state = new Shared();
+  return *state;
+}
+
+// _____________________________________________________________________________________________________________________
+std::shared_ptr<const std::vector<Entry>> walk(const char* class_name) {
+  auto entries = std::make_shared<std::vector<Entry>>();
+  io_iterator_t iterator = 0;
+  // consumes the matching dictionary
+  if (IOServiceGetMatchingServices(kIOMainPortDefault, IOServiceMatching(class_name), &iterator) != KERN_SUCCESS) {
+    return entries;
+  }
+  while (io_registry_entry_t object = IOIteratorNext(iterator)) {
+    entries->emplace_back(object);
+  }
+  IOObjectRelease(iterator);
+  return entries;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+std::string to_string(CFTypeRef value) {
+  if (value == nullptr || CFGetTypeID(value) != CFStringGetTypeID()) {
+    return {};
+  }
+  const auto string = static_cast<CFStringRef>(value);
+  if (const char* direct = CFStringGetCStringPtr(string, kCFStringEncodingUTF8)) {
+    return direct;
+  }
+  if (const char* direct = CFStringGetCStringPtr(string, kCFStringEncodingASCII)) {
+    return direct;
+  }
+  // measure, then convert into the final buffer: no strlen() over a worst case sized one
+  const CFRange range = CFRangeMake(0, CFStringGetLength(string));
+  CFIndex size = 0;
+  CFStringGetBytes(string, range, kCFStringEncodingUTF8, 0, false, nullptr, 0, &size);
+  std::string out(static_cast<size_t>(size), '\0');
+  if (size > 0) {
+    CFStringGetBytes(string, range, kCFStringEncodingUTF8, 0, false, reinterpret_cast<UInt8*>(&out[0]), size, &size);
+    out.resize(static_cast<size_t>(size));
+  }
+  return out;
+}
+
+// _____________________________________________________________________________________________________________________
+Entry::Entry(io_registry_entry_t object) : _object(object) {
+  io_name_t name;
+  if (IORegistryEntryGetName(object, name) == KERN_SUCCESS) {
+    _name = name;
+  }
+  CFMutableDictionaryRef properties = nullptr;
+  if (IORegistryEntryCreateCFProperties(object, &properties, kCFAllocatorDefault, 0) == KERN_SUCCESS) {
+    _properties = CFRef<CFMutableDictionaryRef>(properties);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+Entry::~Entry() {
+  if (_object) IOObjectRelease(_object);
+}
+
+// _____________________________________________________________________________________________________________________
+Entry::Entry(Entry&& other) noexcept
+    : _object(other._object), _name(std::move(other._name)), _properties(std::move(other._properties)) {
+  other._object = 0;
+}
+
+// _____________________________________________________________________________________________________________________
+CFTypeRef Entry::property(CFStringRef key) const {
+  return _properties ? CFDictionaryGetValue(_properties.get(), key) : nullptr;
+}
+
+// _____________________________________________________________________________________________________________________
+std::optional<std::string> Entry::string(CFStringRef key) const {
+  CFTypeRef value = property(key);
+  if (value == nullptr || CFGetTypeID(value) != CFStringGetTypeID()) {
+    return std::nullopt;
+  }
+  return to_string(value);
+}
+
+// _____________________________________________________________________________________________________________________
+std::optional<int64_t> Entry::number(CFStringRef key) const {
+  CFTypeRef value = property(key);
+  int64_t out = 0;
+  if (value == nullptr || CFGetTypeID(value) != CFNumberGetTypeID() ||
+      !CFNumberGetValue(static_cast<CFNumberRef>(value), kCFNumberSInt64Type, &out)) {
+    return std::nullopt;
+  }
+  return out;
+}
+
+// _____________________________________________________________________________________________________________________
+std::optional<bool> Entry::boolean(CFStringRef key) const {
+  CFTypeRef value = property(key);
+  if (value == nullptr || CFGetTypeID(value) != CFBooleanGetTypeID()) {
+    return std::nullopt;
+  }
+  return CFBooleanGetValue(static_cast<CFBooleanRef>(value));
+}
+
+// _____________________________________________________________________________________________________________________
+std::shared_ptr<const std::vector<Entry>> services(const char* class_name) {
+  Shared& state = shared();
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.scopes == 0) {
+      return walk(class_name);
+    }
+    if (auto it = state.walks.find(class_name); it != state.walks.end()) {
+      return it->second;
+    }
+  }
+  // walk outside of the lock, collectors of other classes go on. Two threads that miss the same class walk twice and
+  // the first one wins, which is cheaper than serializing all walks.
+  auto entries = walk(class_name);
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.scopes == 0) {
+    return entries;
+  }
+  return state.walks.emplace(class_name, std::move(entries)).first->second;
+}
+
+// _____________________________________________________________________________________________________________________
+Scope::Scope() {
+  std::lock_guard<std::mutex> lock(shared().mutex);
+  ++shared().scopes;
+}
+
+// _____________________________________________________________________________________________________________________
+Scope::~Scope() {
+  std::lock_guard<std::mutex> lock(shared().mutex);
+  if (--shared().scopes == 0) {
+    shared().walks.clear();
+  }
+}
+
+}  // namespace iokit
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
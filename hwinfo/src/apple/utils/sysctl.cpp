@@ -0,0 +1,73 @@
+#include <hwinfo/utils/sysctl.h>
+
+#ifdef HWINFO_APPLE
+
+#include <cstdint>
+#include <string>
+
+namespace hwinfo {
+namespace utils {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// The value without the terminating '\0', empty if the key does not exist.
+std::string readString(const char* name) {
+  std::string value = getSysctlString(name);
+  while (!value.empty() && value.back() == '\0') {
+    value.pop_back();
+  }
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+// -1 if the key does not exist. Keys that are read once are looked up by name: resolving them to a MIB first would
+// cost a second syscall.
+int64_t readInteger(const char* name) {
+  unsigned char buffer[sizeof(int64_t)];
+  size_t size = sizeof(buffer);
+  int64_t value = -1;
+  if (sysctlbyname(name, buffer, &size, nullptr, 0) != 0 || !widenSysctlInteger(buffer, size, value)) {
+    return -1;
+  }
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+SysctlStatic readStatic() {
+  SysctlStatic values;
+  values.machine = readString("hw.machine");
+  values.cpu_vendor = readString("machdep.cpu.vendor");
+  values.cpu_brand = readString("machdep.cpu.brand_string");
+  values.os_type = readString("kern.ostype");
+  values.os_release = readString("kern.osrelease");
+  values.os_product_version = readString("kern.osproductversion");
+  values.os_build = readString("kern.osversion");
+  values.physical_cpus = readInteger("hw.physicalcpu");
+  values.logical_cpus = readInteger("hw.logicalcpu");
+  values.packages = readInteger("hw.packages");
+  values.perf_levels = readInteger("hw.nperflevels");
+  values.byte_order = readInteger("hw.byteorder");
+  values.l1d_cache_Bytes = readInteger("hw.l1dcachesize");
+  values.l2_cache_Bytes = readInteger("hw.l2cachesize");
+  values.l3_cache_Bytes = readInteger("hw.l3cachesize");
+  values.cpu_frequency_Hz = readInteger("hw.cpufrequency");
+  values.cpu_frequency_max_Hz = readInteger("hw.cpufrequency_max");
+  values.cpu_frequency_min_Hz = readInteger("hw.cpufrequency_min");
+  values.memory_Bytes = readInteger("hw.memsize");
+  values.apple_silicon = values.machine.find("arm64") != std::string::npos;
+  return values;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+const SysctlStatic& sysctl_static() {
+  static const SysctlStatic values = readStatic();
+  return values;
+}
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_APPLE
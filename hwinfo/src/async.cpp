@@ -0,0 +1,120 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/async.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+struct WorkerPool::State {
+  std::mutex mutex;
+  std::condition_variable tasks_changed;
+  std::condition_variable timers_changed;
+  std::deque<std::function<void()>> tasks;
+  std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> timers;
+  bool stop{false};
+  std::vector<std::thread> workers;
+  std::thread timer;
+
+  // ___________________________________________________________________________________________________________________
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      tasks_changed.wait(lock, [this] { return stop || !tasks.empty(); });
+      if (stop) {
+        return;
+      }
+      std::function<void()> task = std::move(tasks.front());
+      tasks.pop_front();
+      lock.unlock();
+      task();
+      // destroy the captures before taking the lock again
+      task = nullptr;
+      lock.lock();
+    }
+  }
+
+  // ___________________________________________________________________________________________________________________
+  void run_timers() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop) {
+      if (timers.empty()) {
+        timers_changed.wait(lock);
+        continue;
+      }
+      const auto next = timers.begin();
+      if (next->first > std::chrono::steady_clock::now()) {
+        timers_changed.wait_until(lock, next->first);
+        continue;
+      }
+      std::function<void()> task = std::move(next->second);
+      timers.erase(next);
+      lock.unlock();
+      task();
+      task = nullptr;
+      lock.lock();
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+WorkerPool::WorkerPool(size_t num_threads) : _state(std::make_unique<State>()) {
+  num_threads = std::max<size_t>(num_threads, 1);
+  for (size_t i = 0; i < num_threads; ++i) {
+    _state->workers.emplace_back([state = _state.get()] { state->work(); });
+  }
+  _state->timer = std::thread([state = _state.get()] { state->run_timers(); });
+}
+
+// _____________________________________________________________________________________________________________________
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    _state->stop = true;
+  }
+  _state->tasks_changed.notify_all();
+  _state->timers_changed.notify_all();
+  for (auto& worker : _state->workers) {
+    worker.join();
+  }
+  _state->timer.join();
+}
+
+// _____________________________________________________________________________________________________________________
+WorkerPool& WorkerPool::shared() {
+  static WorkerPool* pool = new WorkerPool(std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 4));
+  return *pool;
+}
+
+// _____________________________________________________________________________________________________________________
+size_t WorkerPool::num_threads() const { return _state->workers.size(); }
+
+// _____________________________________________________________________________________________________________________
+void WorkerPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    _state->tasks.push_back(std::move(task));
+  }
+  _state->tasks_changed.notify_one();
+}
+
+// _____________________________________________________________________________________________________________________
+void WorkerPool::after(std::chrono::milliseconds delay, std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    _state->timers.emplace(std::chrono::steady_clock::now() + delay, std::move(task));
+  }
+  _state->timers_changed.notify_one();
+}
+
+}  // namespace hwinfo
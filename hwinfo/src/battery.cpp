@@ -10,7 +10,7 @@ namespace hwinfo {
 Battery::Battery(int8_t id) { _id = id; }
 
 // _____________________________________________________________________________________________________________________
-std::string& Battery::vendor() {
+InternedString Battery::vendor() {
   if (_vendor.empty()) {
     _vendor = getVendor();
   }
@@ -18,7 +18,7 @@ std::string& Battery::vendor() {
 }
 
 // _____________________________________________________________________________________________________________________
-std::string& Battery::model() {
+InternedString Battery::model() {
   if (_model.empty()) {
     _model = getModel();
   }
@@ -26,7 +26,7 @@ std::string& Battery::model() {
 }
 
 // _____________________________________________________________________________________________________________________
-std::string& Battery::serialNumber() {
+InternedString Battery::serialNumber() {
   if (_serialNumber.empty()) {
     _serialNumber = getSerialNumber();
   }
@@ -34,7 +34,7 @@ std::string& Battery::serialNumber() {
 }
 
 // _____________________________________________________________________________________________________________________
-std::string& Battery::technology() {
+InternedString Battery::technology() {
   if (_technology.empty()) {
     _technology = getTechnology();
   }
@@ -0,0 +1,537 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/bench.h>
+#include <hwinfo/cpu.h>
+#include <hwinfo/fields.h>
+#include <hwinfo/topology.h>
+#include <hwinfo/utils/aligned_allocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+namespace bench {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kCacheLine = 64;
+constexpr int64_t kMinWorkingSet_Bytes = int64_t{64} * 1024 * 1024;
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+// _____________________________________________________________________________________________________________________
+double seconds_since(Clock::time_point start) { return std::chrono::duration<double>(Clock::now() - start).count(); }
+
+// _____________________________________________________________________________________________________________________
+// Busy waits: the threads of a test run on cpus of their own. Yields now and then, so that threads that could not be
+// pinned (and may share a cpu) still make progress.
+template <typename Predicate>
+void spin_until(const Predicate& done) {
+  for (uint32_t spins = 1; !done(); ++spins) {
+    if (spins % 4096 == 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+// Reusable barrier of the threads of a test, spinning instead of sleeping so that all of them leave it at once.
+class SpinBarrier {
+ public:
+  explicit SpinBarrier(size_t num_threads) : _num_threads(num_threads) {}
+
+  void wait() {
+    const uint32_t generation = _generation.load(std::memory_order_acquire);
+    if (_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == _num_threads) {
+      _waiting.store(0, std::memory_order_relaxed);
+      _generation.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    spin_until([&] { return _generation.load(std::memory_order_acquire) != generation; });
+  }
+
+ private:
+  const size_t _num_threads;
+  alignas(kCacheLine) std::atomic<size_t> _waiting{0};
+  alignas(kCacheLine) std::atomic<uint32_t> _generation{0};
+};
+
+// Cache line aligned storage that is not initialized, so that its pages are allocated on the NUMA node of the thread
+// that writes them first.
+template <typename T>
+class Uninitialized {
+ public:
+  explicit Uninitialized(size_t size) : _data(utils::AlignedAllocator<T, kCacheLine>().allocate(size)), _size(size) {}
+  ~Uninitialized() { utils::AlignedAllocator<T, kCacheLine>().deallocate(_data, _size); }
+  Uninitialized(const Uninitialized&) = delete;
+  Uninitialized& operator=(const Uninitialized&) = delete;
+
+  T* data() const { return _data; }
+
+ private:
+  T* _data;
+  size_t _size;
+};
+
+// _____________________________________________________________________________________________________________________
+// Runs body(i) on one thread per cpu, the i-th pinned to cpus[i]. Returns whether every thread could be pinned.
+template <typename Body>
+bool run_pinned(const std::vector<int>& cpus, const Body& body) {
+  std::atomic<bool> pinned{true};
+  std::vector<std::thread> threads;
+  threads.reserve(cpus.size());
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    threads.emplace_back([&, i] {
+      if (!pinCurrentThread(cpus[i])) {
+        pinned.store(false, std::memory_order_relaxed);
+      }
+      body(i);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return pinned.load(std::memory_order_relaxed);
+}
+
+// _____________________________________________________________________________________________________________________
+// Online cpus of a node (all nodes if node < 0), the first of every core unless all. Without a topology index the cpus
+// 0 .. hardware_concurrency() - 1, all on node 0.
+std::vector<int> online_cpus(const Topology& topology, int32_t node, bool all) {
+  std::vector<int> cpus;
+  if (topology.empty()) {
+    if (node <= 0) {
+      for (unsigned i = 0; i < std::max(1u, std::thread::hardware_concurrency()); ++i) {
+        cpus.push_back(static_cast<int>(i));
+      }
+    }
+    return cpus;
+  }
+  std::vector<bool> seen(static_cast<size_t>(std::max(topology.num_cores(), 0)), false);
+  for (size_t i = 0; i < topology.size(); ++i) {
+    const int32_t core = topology.core()[i];
+    if (core < 0 || (node >= 0 && std::max(topology.node()[i], 0) != node)) {
+      continue;
+    }
+    if (!all && static_cast<size_t>(core) < seen.size()) {
+      if (seen[static_cast<size_t>(core)]) {
+        continue;
+      }
+      seen[static_cast<size_t>(core)] = true;
+    }
+    cpus.push_back(static_cast<int>(i));
+  }
+  return cpus;
+}
+
+// Cache sizes of the first cpu by level, -1 if unknown.
+struct CacheSizes {
+  int64_t level_Bytes[4]{-1, -1, -1, -1};
+
+  static CacheSizes read() {
+    CacheSizes sizes;
+    const std::vector<CPU> cpus = getAllCPUs(CPUFields::Caches);
+    if (!cpus.empty()) {
+      sizes.level_Bytes[1] = cpus.front().L1CacheSize_Bytes();
+      sizes.level_Bytes[2] = cpus.front().L2CacheSize_Bytes();
+      sizes.level_Bytes[3] = cpus.front().L3CacheSize_Bytes();
+    }
+    return sizes;
+  }
+
+  HWI_NODISCARD int64_t last_level_Bytes() const {
+    for (int level = 3; level >= 1; --level) {
+      if (level_Bytes[level] > 0) {
+        return level_Bytes[level];
+      }
+    }
+    return -1;
+  }
+
+  // Smallest level that holds size bytes, 0 if none.
+  HWI_NODISCARD int32_t level_of(int64_t size) const {
+    for (int32_t level = 1; level <= 3; ++level) {
+      if (level_Bytes[level] > 0 && size <= level_Bytes[level]) {
+        return level;
+      }
+    }
+    return 0;
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+BandwidthResult stream(int32_t node, const std::vector<int>& cpus, int64_t array_Bytes, int repetitions) {
+  constexpr size_t doubles_per_line = kCacheLine / sizeof(double);
+  const size_t num_threads = cpus.size();
+  // every thread works on whole cache lines
+  const size_t chunk = std::max<size_t>(
+      doubles_per_line,
+      static_cast<size_t>(array_Bytes) / sizeof(double) / num_threads / doubles_per_line * doubles_per_line);
+  const size_t size = chunk * num_threads;
+  Uninitialized<double> a(size);
+  Uninitialized<double> b(size);
+  Uninitialized<double> c(size);
+  SpinBarrier barrier(num_threads);
+  // best time of copy, scale, add and triad
+  double best[4]{kInfinity, kInfinity, kInfinity, kInfinity};
+  const double scalar = 3.0;
+
+  BandwidthResult result;
+  result.node = node;
+  result.threads = static_cast<int32_t>(num_threads);
+  result.array_Bytes = static_cast<int64_t>(size * sizeof(double));
+  result.pinned = run_pinned(cpus, [&](size_t thread) {
+    double* const ta = a.data() + thread * chunk;
+    double* const tb = b.data() + thread * chunk;
+    double* const tc = c.data() + thread * chunk;
+    for (size_t i = 0; i < chunk; ++i) {
+      ta[i] = 1.0;
+      tb[i] = 2.0;
+      tc[i] = 0.0;
+    }
+    for (int repetition = 0; repetition < repetitions; ++repetition) {
+      for (int kernel = 0; kernel < 4; ++kernel) {
+        barrier.wait();
+        const Clock::time_point start = Clock::now();
+        switch (kernel) {
+          case 0:
+            for (size_t i = 0; i < chunk; ++i) {
+              tc[i] = ta[i];
+            }
+            break;
+          case 1:
+            for (size_t i = 0; i < chunk; ++i) {
+              tb[i] = scalar * tc[i];
+            }
+            break;
+          case 2:
+            for (size_t i = 0; i < chunk; ++i) {
+              tc[i] = ta[i] + tb[i];
+            }
+            break;
+          default:
+            for (size_t i = 0; i < chunk; ++i) {
+              ta[i] = tb[i] + scalar * tc[i];
+            }
+            break;
+        }
+        // the kernel ends with its slowest thread
+        barrier.wait();
+        if (thread == 0) {
+          best[kernel] = std::min(best[kernel], seconds_since(start));
+        }
+      }
+    }
+  });
+  // read the results, so that the kernels cannot be optimized away
+  volatile double sink = a.data()[0] + b.data()[size / 2] + c.data()[size - 1];
+  (void)sink;
+
+  const auto bytes = static_cast<double>(size * sizeof(double));
+  result.copy_Bytes_per_s = 2 * bytes / best[0];
+  result.scale_Bytes_per_s = 2 * bytes / best[1];
+  result.add_Bytes_per_s = 3 * bytes / best[2];
+  result.triad_Bytes_per_s = 3 * bytes / best[3];
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+// Links the cache lines of data into a single cycle in random order (Sattolo's algorithm): every line starts with the
+// address of the next one.
+void link_lines(char* data, size_t num_lines, uint64_t seed) {
+  std::vector<size_t> next(num_lines);
+  for (size_t i = 0; i < num_lines; ++i) {
+    next[i] = i;
+  }
+  std::mt19937_64 random(seed);
+  for (size_t i = num_lines - 1; i > 0; --i) {
+    std::swap(next[i], next[std::uniform_int_distribution<size_t>(0, i - 1)(random)]);
+  }
+  for (size_t i = 0; i < num_lines; ++i) {
+    *reinterpret_cast<void**>(data + i * kCacheLine) = data + next[i] * kCacheLine;
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void* const* chase(void* const* line, int64_t loads) {
+  for (; loads >= 4; loads -= 4) {
+    line = static_cast<void* const*>(*line);
+    line = static_cast<void* const*>(*line);
+    line = static_cast<void* const*>(*line);
+    line = static_cast<void* const*>(*line);
+  }
+  for (; loads > 0; --loads) {
+    line = static_cast<void* const*>(*line);
+  }
+  return line;
+}
+
+// _____________________________________________________________________________________________________________________
+// Average latency of the threads on cpus chasing through one shared cycle of size bytes, each from another line.
+LatencyResult chase_latency(const std::vector<int>& cpus, int64_t size, const Options& options) {
+  const size_t num_lines = std::max<size_t>(2, static_cast<size_t>(size) / kCacheLine);
+  Uninitialized<char> data(num_lines * kCacheLine);
+  SpinBarrier barrier(cpus.size());
+  std::vector<double> latency_ns(cpus.size(), kInfinity);
+  std::atomic<const void*> sink{nullptr};
+
+  LatencyResult result;
+  result.cpu = cpus.front();
+  result.threads = static_cast<int32_t>(cpus.size());
+  result.size_Bytes = static_cast<int64_t>(num_lines * kCacheLine);
+  result.pinned = run_pinned(cpus, [&](size_t thread) {
+    if (thread == 0) {
+      link_lines(data.data(), num_lines, num_lines);
+    }
+    barrier.wait();
+    // one pass to warm up the caches and TLBs
+    auto line = reinterpret_cast<void* const*>(data.data() + thread * num_lines / cpus.size() * kCacheLine);
+    line = chase(line, static_cast<int64_t>(num_lines));
+    for (int repetition = 0; repetition < options.repetitions; ++repetition) {
+      barrier.wait();
+      const Clock::time_point start = Clock::now();
+      line = chase(line, options.latency_loads);
+      const double ns = seconds_since(start) * 1e9 / static_cast<double>(options.latency_loads);
+      latency_ns[thread] = std::min(latency_ns[thread], ns);
+    }
+    sink.store(line, std::memory_order_relaxed);
+  });
+  double sum = 0;
+  for (const double ns : latency_ns) {
+    sum += ns;
+  }
+  result.latency_ns = sum / static_cast<double>(latency_ns.size());
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+// Working sets of the sweep: latency_steps_per_octave per doubling from min to max, in whole cache lines.
+std::vector<int64_t> sweep_sizes(const Options& options, const CacheSizes& caches) {
+  int64_t min = options.latency_min_Bytes;
+  if (min <= 0) {
+    min = caches.level_Bytes[1] > 0 ? caches.level_Bytes[1] / 4 : 4096;
+  }
+  int64_t max = options.latency_max_Bytes;
+  if (max <= 0) {
+    max = std::max(kMinWorkingSet_Bytes, 4 * caches.last_level_Bytes());
+  }
+  const int steps = std::max(options.latency_steps_per_octave, 1);
+  std::vector<int64_t> sizes;
+  for (int step = 0;; ++step) {
+    const double size = static_cast<double>(min) * std::exp2(static_cast<double>(step) / steps);
+    if (size > static_cast<double>(max) * (1 + 1e-9)) {
+      break;
+    }
+    const int64_t lines = std::max<int64_t>(2, std::llround(size / kCacheLine));
+    if (sizes.empty() || sizes.back() != lines * static_cast<int64_t>(kCacheLine)) {
+      sizes.push_back(lines * static_cast<int64_t>(kCacheLine));
+    }
+  }
+  return sizes;
+}
+
+// _____________________________________________________________________________________________________________________
+// One way latency of a cache line bounced between cpus a and b.
+CoreToCoreResult ping_pong(int a, int b, const Options& options) {
+  struct alignas(kCacheLine) Line {
+    std::atomic<int64_t> value{0};
+  };
+  Line line;
+  const int repetitions = std::max(options.repetitions, 1);
+  const int64_t round_trips = std::max<int64_t>(options.round_trips, 1);
+  const int64_t warm_up = std::max<int64_t>(round_trips / 10, 100);
+  double best = kInfinity;
+
+  CoreToCoreResult result;
+  result.cpu_a = a;
+  result.cpu_b = b;
+  result.pinned = run_pinned({a, b}, [&](size_t thread) {
+    // a writes the odd values and waits for the even ones, b answers every odd value with the next even one
+    int64_t value = 0;
+    if (thread == 1) {
+      for (int64_t i = 0; i < warm_up + repetitions * round_trips; ++i) {
+        ++value;
+        spin_until([&] { return line.value.load(std::memory_order_acquire) == value; });
+        line.value.store(++value, std::memory_order_release);
+      }
+      return;
+    }
+    for (int repetition = -1; repetition < repetitions; ++repetition) {
+      const int64_t count = repetition < 0 ? warm_up : round_trips;
+      const Clock::time_point start = Clock::now();
+      for (int64_t i = 0; i < count; ++i) {
+        line.value.store(++value, std::memory_order_release);
+        ++value;
+        spin_until([&] { return line.value.load(std::memory_order_acquire) == value; });
+      }
+      if (repetition >= 0) {
+        best = std::min(best, seconds_since(start) / static_cast<double>(count));
+      }
+    }
+  });
+  result.latency_ns = best * 1e9 / 2;
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+Distance distance(const Topology& topology, int a, int b) {
+  if (topology.empty()) {
+    return Distance::Remote;
+  }
+  const auto same = [a, b](const int32_t* column) { return column[a] >= 0 && column[a] == column[b]; };
+  if (same(topology.core())) {
+    return Distance::SmtSibling;
+  }
+  if (same(topology.cache_domain())) {
+    return Distance::CacheDomain;
+  }
+  if (same(topology.node())) {
+    return Distance::Node;
+  }
+  return same(topology.socket()) ? Distance::Socket : Distance::Remote;
+}
+
+// _____________________________________________________________________________________________________________________
+inventory::Value int_value(int64_t integer) {
+  inventory::Value value;
+  value.type = inventory::ValueType::Int;
+  value.integer = integer;
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+inventory::Value double_value(double real) {
+  inventory::Value value;
+  value.type = inventory::ValueType::Double;
+  value.real = real;
+  return value;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+std::vector<BandwidthResult> measureBandwidth(const Options& options) {
+  const Topology& topology = Topology::get();
+  const CacheSizes caches = CacheSizes::read();
+  const int repetitions = std::max(options.repetitions, 1);
+  std::vector<BandwidthResult> results;
+  for (int32_t node = 0; node < std::max(topology.num_nodes(), 1); ++node) {
+    const std::vector<int> cpus = online_cpus(topology, node, false);
+    if (cpus.empty()) {
+      // memory-only node
+      continue;
+    }
+    int64_t array_Bytes = options.bandwidth_array_Bytes;
+    if (array_Bytes <= 0) {
+      std::vector<int32_t> domains;
+      for (const int cpu : cpus) {
+        domains.push_back(topology.empty() ? 0 : topology.cache_domain()[cpu]);
+      }
+      std::sort(domains.begin(), domains.end());
+      const auto num_domains = static_cast<int64_t>(std::unique(domains.begin(), domains.end()) - domains.begin());
+      array_Bytes = std::max(kMinWorkingSet_Bytes, 4 * caches.last_level_Bytes() * num_domains);
+    }
+    results.push_back(stream(node, {cpus.front()}, array_Bytes, repetitions));
+    if (cpus.size() > 1) {
+      results.push_back(stream(node, cpus, array_Bytes, repetitions));
+    }
+  }
+  return results;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<LatencyResult> measureLatency(const Options& options) {
+  const CacheSizes caches = CacheSizes::read();
+  const std::vector<int> cpus = online_cpus(Topology::get(), -1, false);
+  std::vector<LatencyResult> results;
+  if (cpus.empty() || options.latency_loads <= 0) {
+    return results;
+  }
+  Options run_options = options;
+  run_options.repetitions = std::max(options.repetitions, 1);
+  const std::vector<int64_t> sizes = sweep_sizes(options, caches);
+  for (const std::vector<int>& threads : {std::vector<int>{cpus.front()}, cpus}) {
+    if (threads.size() == 1 && !results.empty()) {
+      // a single core: the sweep on all cores is the same
+      break;
+    }
+    for (const int64_t size : sizes) {
+      results.push_back(chase_latency(threads, size, run_options));
+      results.back().cache_level = caches.level_of(results.back().size_Bytes);
+    }
+  }
+  return results;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<CoreToCoreResult> measureCoreToCore(const Options& options) {
+  const Topology& topology = Topology::get();
+  const std::vector<int> cpus = online_cpus(topology, -1, options.smt);
+  std::vector<CoreToCoreResult> results;
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    for (size_t j = i + 1; j < cpus.size(); ++j) {
+      results.push_back(ping_pong(cpus[i], cpus[j], options));
+      results.back().distance = distance(topology, cpus[i], cpus[j]);
+    }
+  }
+  return results;
+}
+
+// _____________________________________________________________________________________________________________________
+Report run(const Options& options) {
+  Report report;
+  if (options.bandwidth) {
+    report.bandwidth = measureBandwidth(options);
+  }
+  if (options.latency) {
+    report.latency = measureLatency(options);
+  }
+  if (options.core_to_core) {
+    report.core_to_core = measureCoreToCore(options);
+  }
+  return report;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<inventory::Record> records(const Report& report) {
+  std::vector<inventory::Record> result;
+  result.reserve(report.bandwidth.size() + report.latency.size() + report.core_to_core.size());
+  for (const BandwidthResult& bandwidth : report.bandwidth) {
+    result.push_back({inventory::RecordType::Bandwidth,
+                      {int_value(bandwidth.node), int_value(bandwidth.threads), int_value(bandwidth.pinned),
+                       int_value(bandwidth.array_Bytes), double_value(bandwidth.copy_Bytes_per_s),
+                       double_value(bandwidth.scale_Bytes_per_s), double_value(bandwidth.add_Bytes_per_s),
+                       double_value(bandwidth.triad_Bytes_per_s)}});
+  }
+  for (const LatencyResult& latency : report.latency) {
+    result.push_back({inventory::RecordType::Latency,
+                      {int_value(latency.cpu), int_value(latency.threads), int_value(latency.pinned),
+                       int_value(latency.size_Bytes), int_value(latency.cache_level),
+                       double_value(latency.latency_ns)}});
+  }
+  for (const CoreToCoreResult& pair : report.core_to_core) {
+    result.push_back({inventory::RecordType::CoreToCore,
+                      {int_value(pair.cpu_a), int_value(pair.cpu_b), int_value(static_cast<int64_t>(pair.distance)),
+                       int_value(pair.pinned), double_value(pair.latency_ns)}});
+  }
+  return result;
+}
+
+#if !defined(HWINFO_UNIX) && !defined(HWINFO_WINDOWS)
+// _____________________________________________________________________________________________________________________
+// macOS only has affinity tags (THREAD_AFFINITY_POLICY), which are hints and ignored on Apple silicon.
+bool pinCurrentThread(int /*cpu*/) { return false; }
+#endif
+
+}  // namespace bench
+}  // namespace hwinfo
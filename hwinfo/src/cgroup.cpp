@@ -0,0 +1,100 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/cgroup.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+namespace hwinfo {
+
+namespace {
+
+std::atomic<bool> apply_cgroup_limits{false};
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+const Cgroup& Cgroup::get() {
+  static const Cgroup cgroup = read();
+  return cgroup;
+}
+
+// _____________________________________________________________________________________________________________________
+void Cgroup::set_apply_limits(bool enabled) { apply_cgroup_limits.store(enabled, std::memory_order_relaxed); }
+
+// _____________________________________________________________________________________________________________________
+bool Cgroup::apply_limits() { return apply_cgroup_limits.load(std::memory_order_relaxed); }
+
+// _____________________________________________________________________________________________________________________
+double Cgroup::effective_cpu_count() const {
+  const double quota = cpu_quota();
+  const auto num_cpus = static_cast<double>(effective_cpus().size());
+  if (num_cpus > 0 && quota > 0) {
+    return std::min(num_cpus, quota);
+  }
+  return num_cpus > 0 ? num_cpus : quota;
+}
+
+#ifndef HWINFO_UNIX
+struct Cgroup::Source {};
+
+// _____________________________________________________________________________________________________________________
+Cgroup::Cgroup() = default;
+
+// _____________________________________________________________________________________________________________________
+Cgroup::~Cgroup() = default;
+
+// _____________________________________________________________________________________________________________________
+Cgroup::Cgroup(Cgroup&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Cgroup& Cgroup::operator=(Cgroup&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Cgroup Cgroup::read() { return {}; }
+
+// _____________________________________________________________________________________________________________________
+double Cgroup::cpu_quota() const { return -1.0; }
+
+// _____________________________________________________________________________________________________________________
+std::vector<int> Cgroup::effective_cpus() const { return {}; }
+
+// _____________________________________________________________________________________________________________________
+int64_t Cgroup::memory_max_Bytes() const { return -1; }
+
+// _____________________________________________________________________________________________________________________
+int64_t Cgroup::memory_current_Bytes() const { return -1; }
+
+// _____________________________________________________________________________________________________________________
+int64_t Cgroup::cpu_usage_ns() const { return -1; }
+#endif  // HWINFO_UNIX
+
+// =====================================================================================================================
+// _____________________________________________________________________________________________________________________
+CgroupUsageSampler::CgroupUsageSampler()
+    : _usage_ns(Cgroup::get().cpu_usage_ns()), _timestamp(std::chrono::steady_clock::now()) {}
+
+// _____________________________________________________________________________________________________________________
+CgroupUsageSample CgroupUsageSampler::sample() {
+  CgroupUsageSample result;
+  const Cgroup& cgroup = Cgroup::get();
+  const int64_t usage_ns = cgroup.cpu_usage_ns();
+  const auto now = std::chrono::steady_clock::now();
+  result.period = now - _timestamp;
+  const auto period_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(result.period).count();
+  if (usage_ns >= 0 && _usage_ns >= 0 && usage_ns >= _usage_ns && period_ns > 0) {
+    result.cpus = static_cast<double>(usage_ns - _usage_ns) / static_cast<double>(period_ns);
+    const double capacity = cgroup.effective_cpu_count();
+    if (capacity > 0) {
+      result.utilisation = std::min(result.cpus / capacity, 1.0);
+    }
+  }
+  _usage_ns = usage_ns;
+  _timestamp = now;
+  return result;
+}
+
+}  // namespace hwinfo
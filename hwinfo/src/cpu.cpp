@@ -1,9 +1,19 @@
 // Copyright (c) Leon Freist <freist@informatik.uni-freiburg.de>
 // This software is part of HWBenchmark
 
+#include <hwinfo/cgroup.h>
 #include <hwinfo/cpu.h>
+#include <hwinfo/topology.h>
+#include <hwinfo/utils/jiffies.h>
+#include <hwinfo/utils/trace.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace hwinfo {
@@ -12,10 +22,10 @@ namespace hwinfo {
 int CPU::id() const { return _id; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& CPU::modelName() const { return _modelName; }
+InternedString CPU::modelName() const { return _modelName; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& CPU::vendor() const { return _vendor; }
+InternedString CPU::vendor() const { return _vendor; }
 
 // _____________________________________________________________________________________________________________________
 int64_t CPU::L1CacheSize_Bytes() const { return _L1CacheSize_Bytes; }
@@ -30,7 +40,26 @@ int64_t CPU::L3CacheSize_Bytes() const { return _L3CacheSize_Bytes; }
 int CPU::numPhysicalCores() const { return _numPhysicalCores; }
 
 // _____________________________________________________________________________________________________________________
-int CPU::numLogicalCores() const { return _numLogicalCores; }
+int CPU::numLogicalCores() const {
+  if (!Cgroup::apply_limits() || _numLogicalCores <= 0) {
+    return _numLogicalCores;
+  }
+  const Cgroup& cgroup = Cgroup::get();
+  int num_cores = _numLogicalCores;
+  const std::vector<int> cpus = cgroup.effective_cpus();
+  if (!cpus.empty()) {
+    const std::vector<int> thread_ids = threadIds();
+    num_cores = thread_ids.empty() ? std::min(num_cores, static_cast<int>(cpus.size()))
+                                   : static_cast<int>(std::count_if(thread_ids.begin(), thread_ids.end(), [&](int id) {
+                                       return std::binary_search(cpus.begin(), cpus.end(), id);
+                                     }));
+  }
+  const double quota = cgroup.cpu_quota();
+  if (quota > 0) {
+    num_cores = std::min(num_cores, std::max(static_cast<int>(std::ceil(quota)), 1));
+  }
+  return num_cores;
+}
 
 // _____________________________________________________________________________________________________________________
 int64_t CPU::maxClockSpeed_MHz() const { return _maxClockSpeed_MHz; }
@@ -41,4 +70,296 @@ int64_t CPU::regularClockSpeed_MHz() const { return _regularClockSpeed_MHz; }
 // _____________________________________________________________________________________________________________________
 const std::vector<std::string>& CPU::flags() const { return _flags; }
 
+// _____________________________________________________________________________________________________________________
+const FeatureSet& CPU::features() const { return _features; }
+
+// _____________________________________________________________________________________________________________________
+std::vector<CPU> getAllCPUs() { return getAllCPUs(CPUFields::All); }
+
+// _____________________________________________________________________________________________________________________
+std::vector<int> CPU::threadIds() const {
+  const Topology& topology = Topology::get();
+  return topology.cpus_of_socket(topology.find_socket(_id));
+}
+
+#ifdef HWINFO_APPLE
+namespace {
+
+// _____________________________________________________________________________________________________________________
+template <typename T>
+int copy_into(const std::vector<T>& values, T* out, int capacity) {
+  for (size_t i = 0; i < values.size() && i < static_cast<size_t>(capacity); ++i) {
+    out[i] = values[i];
+  }
+  return static_cast<int>(values.size());
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+int CPU::currentClockSpeed_MHz(int64_t* out, int capacity) const {
+  return copy_into(currentClockSpeed_MHz(), out, capacity);
+}
+#endif  // HWINFO_APPLE
+
+#ifndef HWINFO_WINDOWS
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// The cpus of the cgroup cpuset indexed by the OS cpu id, empty if every cpu counts (see Cgroup::set_apply_limits()).
+std::vector<bool> cpuset_mask() {
+  std::vector<bool> mask;
+  if (!Cgroup::apply_limits()) {
+    return mask;
+  }
+  for (int cpu : Cgroup::get().effective_cpus()) {
+    if (mask.size() <= static_cast<size_t>(cpu)) {
+      mask.resize(cpu + 1, false);
+    }
+    mask[cpu] = true;
+  }
+  return mask;
+}
+
+// _____________________________________________________________________________________________________________________
+bool outside_cpuset(const std::vector<bool>& mask, size_t cpu) {
+  return !mask.empty() && (cpu >= mask.size() || !mask[cpu]);
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+std::shared_ptr<const CPU::JiffiesSample> CPU::take_sample(std::shared_ptr<const JiffiesSample>& last,
+                                                           std::shared_ptr<const JiffiesSample>& previous) {
+  // the sample replaced by the previous call on this thread is reused (if nobody holds it anymore), so that steady
+  // state sampling does not allocate
+  thread_local std::shared_ptr<const JiffiesSample> spare;
+  std::shared_ptr<JiffiesSample> current;
+  if (spare && spare.use_count() == 1) {
+    // use_count() is a relaxed load. The other owners dropped their references with a release decrement (acq_rel in
+    // every standard library), so this fence orders their last reads of the sample before the overwrite below.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    current = std::const_pointer_cast<JiffiesSample>(std::move(spare));
+  } else {
+    current = std::make_shared<JiffiesSample>();
+  }
+  spare.reset();
+  if (!utils::read_jiffies(current->total, current->threads)) {
+    return nullptr;
+  }
+  // concurrent callers each get the delta to the sample that was published right before their own one
+  previous = std::atomic_exchange(&last, std::shared_ptr<const JiffiesSample>(current));
+  spare = previous;
+  return current;
+}
+
+// _____________________________________________________________________________________________________________________
+double CPU::currentUtilisation() const {
+  std::shared_ptr<const JiffiesSample> last;
+  auto current = take_sample(_last_total_sample, last);
+  if (!current) {
+    return -1.0;
+  }
+  return utils::utilisation(last ? last->total : Jiffies(), current->total);
+}
+
+// _____________________________________________________________________________________________________________________
+double CPU::threadUtilisation(int thread_index) const {
+  if (thread_index < 0) {
+    return -1.0;
+  }
+  // the buffers of the fresh sample are reused by the next call on this thread
+  thread_local Jiffies total;
+  thread_local std::vector<Jiffies> threads;
+  const auto index = static_cast<size_t>(thread_index);
+  if (!utils::read_jiffies(total, threads) || index >= threads.size() || outside_cpuset(cpuset_mask(), index)) {
+    return -1.0;
+  }
+  auto state = std::atomic_load(&_last_thread_jiffies);
+  if (!state) {
+    auto created = std::make_shared<ThreadJiffies>();
+    // on a race the state of the other caller is used
+    if (std::atomic_compare_exchange_strong(&_last_thread_jiffies, &state, created)) {
+      state = std::move(created);
+    }
+  }
+  Jiffies last;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    // bounded by the threads of the sample, which grow only with cpus that came online
+    if (state->last.size() < threads.size()) {
+      state->last.resize(threads.size());
+    }
+    last = state->last[index];
+    state->last[index] = threads[index];
+  }
+  return utils::utilisation(last, threads[index]);
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<double> CPU::threadsUtilisation() const {
+  std::shared_ptr<const JiffiesSample> last;
+  auto current = take_sample(_last_threads_sample, last);
+  if (!current) {
+    return std::vector<double>(_numLogicalCores > 0 ? _numLogicalCores : 0, -1.0);
+  }
+  std::vector<double> thread_utility(_numLogicalCores > 0 ? _numLogicalCores : current->threads.size(), -1.0);
+  const std::vector<bool> mask = cpuset_mask();
+  for (size_t i = 0; i < thread_utility.size() && i < current->threads.size(); ++i) {
+    if (outside_cpuset(mask, i)) {
+      continue;
+    }
+    const bool has_last = last && i < last->threads.size();
+    thread_utility[i] = utils::utilisation(has_last ? last->threads[i] : Jiffies(), current->threads[i]);
+  }
+  return thread_utility;
+}
+
+// _____________________________________________________________________________________________________________________
+int CPU::threadsUtilisation(double* out, int capacity) const {
+  if (capacity <= 0 && _numLogicalCores > 0) {
+    return _numLogicalCores;
+  }
+  std::shared_ptr<const JiffiesSample> last;
+  auto current = take_sample(_last_threads_sample, last);
+  if (!current) {
+    return -1;
+  }
+  const size_t num_threads = _numLogicalCores > 0 ? _numLogicalCores : current->threads.size();
+  const std::vector<bool> mask = cpuset_mask();
+  for (size_t i = 0; i < num_threads && i < static_cast<size_t>(capacity); ++i) {
+    const bool has_current = i < current->threads.size() && !outside_cpuset(mask, i);
+    const bool has_last = last && i < last->threads.size();
+    out[i] = has_current ? utils::utilisation(has_last ? last->threads[i] : Jiffies(), current->threads[i]) : -1.0;
+  }
+  return static_cast<int>(num_threads);
+}
+
+// _____________________________________________________________________________________________________________________
+double CPU::socketUtilisation() const {
+  const Topology& topology = Topology::get();
+  const int32_t socket = topology.find_socket(_id);
+  if (socket < 0) {
+    return -1.0;
+  }
+  std::shared_ptr<const JiffiesSample> last;
+  auto current = take_sample(_last_socket_sample, last);
+  if (!current) {
+    return -1.0;
+  }
+  // the jiffies of all threads of the socket are summed up, so that busy and idle threads are weighted by time
+  Jiffies previous_sum(0, 0);
+  Jiffies current_sum(0, 0);
+  const size_t num_threads = std::min(topology.size(), current->threads.size());
+  for (size_t i = 0; i < num_threads; ++i) {
+    const bool has_last = last && i < last->threads.size() && last->threads[i].all >= 0;
+    if (topology.socket()[i] != socket || current->threads[i].all < 0 || (last && !has_last)) {
+      continue;
+    }
+    current_sum.all += current->threads[i].all;
+    current_sum.working += current->threads[i].working;
+    if (has_last) {
+      previous_sum.all += last->threads[i].all;
+      previous_sum.working += last->threads[i].working;
+    }
+  }
+  return utils::utilisation(last ? previous_sum : Jiffies(), current_sum);
+}
+#endif  // HWINFO_WINDOWS
+
+// =====================================================================================================================
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// Utilisation of every group of threads (sockets, clusters, ...), groups[i] < 0 excludes thread i. The jiffies of the
+// threads of a group are summed up, so that busy and idle threads are weighted by time.
+std::vector<double> groupUtilisation(const std::vector<Jiffies>& previous, const std::vector<Jiffies>& current,
+                                     const int32_t* groups, size_t num_cpus, size_t num_groups) {
+  std::vector<Jiffies> previous_sum(num_groups, Jiffies(0, 0));
+  std::vector<Jiffies> current_sum(num_groups, Jiffies(0, 0));
+  const size_t num_threads = std::min({current.size(), previous.size(), num_cpus});
+  for (size_t i = 0; i < num_threads; ++i) {
+    const int32_t group = groups[i];
+    if (group < 0 || static_cast<size_t>(group) >= num_groups || current[i].all < 0 || previous[i].all < 0) {
+      continue;
+    }
+    previous_sum[group].all += previous[i].all;
+    previous_sum[group].working += previous[i].working;
+    current_sum[group].all += current[i].all;
+    current_sum[group].working += current[i].working;
+  }
+  std::vector<double> result(num_groups, -1.0);
+  for (size_t group = 0; group < num_groups; ++group) {
+    result[group] = utils::utilisation(previous_sum[group], current_sum[group]);
+  }
+  return result;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+UtilisationSampler::UtilisationSampler() {
+  if (!utils::read_jiffies(_total, _threads)) {
+    _total = Jiffies();
+    _threads.clear();
+  }
+  _next_threads.reserve(_threads.size());
+  _timestamp = std::chrono::steady_clock::now();
+}
+
+// _____________________________________________________________________________________________________________________
+UtilisationSample UtilisationSampler::sample() {
+  HWINFO_TRACE_SCOPE(Utilisation);
+  UtilisationSample result;
+  Jiffies total;
+  std::vector<Jiffies>& threads = _next_threads;
+  if (!utils::read_jiffies(total, threads)) {
+    return result;
+  }
+  auto now = std::chrono::steady_clock::now();
+  result.period = now - _timestamp;
+  result.total = utils::utilisation(_total, total);
+  result.threads.resize(threads.size(), -1.0);
+  for (size_t i = 0; i < threads.size(); ++i) {
+    result.threads[i] = utils::utilisation(i < _threads.size() ? _threads[i] : Jiffies(), threads[i]);
+  }
+  const Topology& topology = Topology::get();
+  result.sockets = groupUtilisation(_threads, threads, topology.socket(), topology.size(), topology.num_sockets());
+  const int32_t* efficiency_class = topology.efficiency_class();
+  const int32_t num_clusters =
+      topology.empty() ? 0 : *std::max_element(efficiency_class, efficiency_class + topology.size()) + 1;
+  result.clusters = groupUtilisation(_threads, threads, efficiency_class, topology.size(), num_clusters);
+  _total = total;
+  _threads.swap(threads);
+  _timestamp = now;
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+UtilisationSample UtilisationSampler::sample_over(std::chrono::nanoseconds duration) {
+  sample();
+  std::this_thread::sleep_for(duration);
+  return sample();
+}
+
+namespace utils {
+
+// _____________________________________________________________________________________________________________________
+double utilisation(const Jiffies& previous, const Jiffies& current) {
+  if (current.all < 0) {
+    return -1.0;
+  }
+  // without a previous sample the utilisation since boot is returned
+  const Jiffies start = previous.all < 0 ? Jiffies(0, 0) : previous;
+  auto total_over_period = static_cast<double>(current.all - start.all);
+  auto work_over_period = static_cast<double>(current.working - start.working);
+  const double utilisation = work_over_period / total_over_period;
+  if (utilisation < 0 || utilisation > 1 || std::isnan(utilisation) || std::isinf(utilisation)) {
+    return -1.0;
+  }
+  return utilisation;
+}
+
+}  // namespace utils
+
 }  // namespace hwinfo
@@ -0,0 +1,77 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/cpu_features.h>
+
+#include <string_view>
+
+namespace hwinfo {
+
+namespace {
+
+// indexed by Feature
+constexpr std::string_view feature_names[] = {
+    // x86: leaf 1
+    "mmx", "sse", "sse2", "pni", "ssse3", "sse4_1", "sse4_2", "popcnt", "aes", "pclmulqdq", "cx16", "movbe", "xsave",
+    "osxsave", "avx", "f16c", "fma", "rdrand", "ht",
+    // x86: leaf 7
+    "bmi1", "bmi2", "avx2", "erms", "fsrm", "adx", "rdseed", "sha_ni", "clflushopt", "clwb", "gfni", "vaes",
+    "vpclmulqdq", "avx512f", "avx512dq", "avx512cd", "avx512bw", "avx512vl", "avx512ifma", "avx512vbmi",
+    "avx512_vbmi2", "avx512_vnni", "avx512_bitalg", "avx512_vpopcntdq", "avx512_bf16", "avx512_fp16",
+    "avx512_vp2intersect", "avx_vnni", "amx_tile", "amx_int8", "amx_bf16", "hybrid_cpu", "serialize", "waitpkg",
+    "rdpid", "rtm",
+    // x86: extended leaves
+    "lahf_lm", "abm", "sse4a", "3dnowprefetch", "fma4", "xop", "tbm", "topoext", "rdtscp", "lm", "pdpe1gb", "nx",
+    // ARM
+    "fp", "asimd", "asimdhp", "asimddp", "asimdfhm", "aes", "pmull", "sha1", "sha2", "sha3", "sha512", "sm4", "crc32",
+    "atomics", "sve", "sve2", "bf16", "i8mm"};
+static_assert(sizeof(feature_names) / sizeof(feature_names[0]) == static_cast<size_t>(Feature::Count),
+              "feature_names must list every Feature");
+
+// alternative spellings (other tools, older kernels)
+struct Alias {
+  std::string_view name;
+  Feature feature;
+};
+constexpr Alias aliases[] = {
+    {"sse3", Feature::SSE3},
+    {"sse4.1", Feature::SSE4_1},
+    {"sse4.2", Feature::SSE4_2},
+    {"sha", Feature::SHA},
+    {"lzcnt", Feature::ABM},
+    {"prefetchw", Feature::PREFETCHW},
+    {"pclmul", Feature::PCLMULQDQ},
+    {"hybrid", Feature::HYBRID},
+    {"avx512vnni", Feature::AVX512_VNNI},
+    {"avx512bf16", Feature::AVX512_BF16},
+    {"avx512fp16", Feature::AVX512_FP16},
+    {"neon", Feature::ASIMD},
+};
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+std::string_view feature_name(Feature feature) {
+  const auto index = static_cast<size_t>(feature);
+  return index < static_cast<size_t>(Feature::Count) ? feature_names[index] : std::string_view();
+}
+
+// _____________________________________________________________________________________________________________________
+bool feature_from_name(std::string_view name, Feature& feature) {
+  // "aes" is listed for x86 and ARM: the first match is the x86 one, ARM callers map "aes" themselves
+  for (size_t i = 0; i < static_cast<size_t>(Feature::Count); ++i) {
+    if (feature_names[i] == name) {
+      feature = static_cast<Feature>(i);
+      return true;
+    }
+  }
+  for (const auto& alias : aliases) {
+    if (alias.name == name) {
+      feature = alias.feature;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace hwinfo
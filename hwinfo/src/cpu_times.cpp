@@ -0,0 +1,80 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/cpu_times.h>
+#include <hwinfo/utils/trace.h>
+
+#include <cmath>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// Share of part in period, -1 for rates outside of [0, 1] (counter resets, no time passed).
+double share(int64_t part, int64_t period) {
+  const double rate = static_cast<double>(part) / static_cast<double>(period);
+  if (rate < 0 || rate > 1 || std::isnan(rate) || std::isinf(rate)) {
+    return -1.0;
+  }
+  return rate;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+CpuTimeRates cpuTimeRates(const CpuTimes& previous, const CpuTimes& current) {
+  CpuTimeRates rates;
+  if (!current.valid()) {
+    return rates;
+  }
+  // without a previous sample the rates since boot are returned
+  CpuTimes start = previous;
+  if (!start.valid()) {
+    start = CpuTimes{0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  }
+  const int64_t period = current.total() - start.total();
+  rates.busy = share(current.busy() - start.busy(), period);
+  rates.user = share(current.user + current.nice - start.user - start.nice, period);
+  rates.system = share(current.system - start.system, period);
+  rates.iowait = share(current.iowait - start.iowait, period);
+  rates.irq = share(current.irq + current.softirq - start.irq - start.softirq, period);
+  rates.steal = share(current.steal - start.steal, period);
+  rates.guest = share(current.guest + current.guest_nice - start.guest - start.guest_nice, period);
+  return rates;
+}
+
+// _____________________________________________________________________________________________________________________
+CpuTimesSampler::CpuTimesSampler() {
+  if (!readCpuTimes(_total, _threads)) {
+    _total = CpuTimes();
+    _threads.clear();
+  }
+  _next_threads.reserve(_threads.size());
+  _timestamp = std::chrono::steady_clock::now();
+}
+
+// _____________________________________________________________________________________________________________________
+CpuTimesSample CpuTimesSampler::sample() {
+  HWINFO_TRACE_SCOPE(Utilisation);
+  CpuTimesSample result;
+  CpuTimes total;
+  std::vector<CpuTimes>& threads = _next_threads;
+  if (!readCpuTimes(total, threads)) {
+    return result;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  result.period = now - _timestamp;
+  result.total = cpuTimeRates(_total, total);
+  result.threads.resize(threads.size());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    result.threads[i] = cpuTimeRates(i < _threads.size() ? _threads[i] : CpuTimes(), threads[i]);
+  }
+  _total = total;
+  _threads.swap(threads);
+  _timestamp = now;
+  return result;
+}
+
+}  // namespace hwinfo
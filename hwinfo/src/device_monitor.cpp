@@ -0,0 +1,39 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/device_monitor.h>
+
+#include <utility>
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+DeviceWatcher::DeviceWatcher(Callback callback) : _callback(std::move(callback)) {
+  if (_monitor.valid()) {
+    _thread = std::thread(&DeviceWatcher::run, this);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+DeviceWatcher::~DeviceWatcher() { stop(); }
+
+// _____________________________________________________________________________________________________________________
+void DeviceWatcher::stop() {
+  _stop = true;
+  _monitor.interrupt();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void DeviceWatcher::run() {
+  while (!_stop) {
+    const Component changed = _monitor.wait(std::chrono::milliseconds(-1));
+    if (changed != Component::None && !_stop && _callback) {
+      _callback(changed);
+    }
+  }
+}
+
+}  // namespace hwinfo
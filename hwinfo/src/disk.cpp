@@ -3,16 +3,20 @@
 
 #include <hwinfo/disk.h>
 
+#include <cstddef>
+#include <optional>
+#include <vector>
+
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
-const std::string& Disk::vendor() const { return _vendor; }
+InternedString Disk::vendor() const { return _vendor; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& Disk::model() const { return _model; }
+InternedString Disk::model() const { return _model; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& Disk::serialNumber() const { return _serialNumber; }
+InternedString Disk::serialNumber() const { return _serialNumber; }
 
 // _____________________________________________________________________________________________________________________
 int64_t Disk::size_Bytes() const { return _size_Bytes; }
@@ -26,4 +30,33 @@ int Disk::id() const { return _id; }
 // _____________________________________________________________________________________________________________________
 const std::vector<std::string>& Disk::volumes() const { return _volumes; }
 
+// _____________________________________________________________________________________________________________________
+const std::string& Disk::deviceName() const { return _device_name; }
+
+// _____________________________________________________________________________________________________________________
+std::vector<Disk> getAllDisks() { return getAllDisks(DiskFields::All); }
+
+#ifndef HWINFO_UNIX
+struct DiskEnumerator::Source {
+  std::vector<Disk> disks;
+  size_t next{0};
+};
+
+// _____________________________________________________________________________________________________________________
+DiskEnumerator::DiskEnumerator(DiskFields fields) : _source(std::make_unique<Source>()) {
+  _source->disks = getAllDisks(fields);
+}
+
+// _____________________________________________________________________________________________________________________
+DiskEnumerator::~DiskEnumerator() = default;
+
+// _____________________________________________________________________________________________________________________
+std::optional<Disk> DiskEnumerator::next() {
+  if (_source->next >= _source->disks.size()) {
+    return std::nullopt;
+  }
+  return std::move(_source->disks[_source->next++]);
+}
+#endif  // HWINFO_UNIX
+
 }  // namespace hwinfo
@@ -0,0 +1,84 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/disk.h>
+#include <hwinfo/disk_stats.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+std::vector<std::string> disk_device_names() {
+  std::vector<std::string> names;
+  for (const auto& disk : getAllDisks()) {
+    names.push_back(disk.deviceName());
+  }
+  return names;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+DiskStatsSampler::DiskStatsSampler() : DiskStatsSampler(disk_device_names()) {}
+
+// _____________________________________________________________________________________________________________________
+bool DiskStatsSampler::update() {
+  HWINFO_TRACE_SCOPE(DiskStats);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  std::swap(_previous, _current);
+  std::fill(_current.begin(), _current.end(), Counters());
+  std::fill(_stats.begin(), _stats.end(), DiskIOStats());
+  const bool success = read_counters();
+  const double period_s = static_cast<double>(now - _timestamp_ns) / 1e9;
+  const bool has_baseline = _has_baseline && period_s > 0;
+  _has_baseline = success;
+  _timestamp_ns = now;
+  if (!success || !has_baseline) {
+    return success;
+  }
+
+  const double period_ms = period_s * 1000;
+  for (size_t i = 0; i < _current.size(); ++i) {
+    const Counters& previous = _previous[i];
+    const Counters& current = _current[i];
+    DiskIOStats& stats = _stats[i];
+    // -1 if either sample lacks the counter or it went backwards (device replaced, counter wrapped)
+    const auto delta = [](int64_t before, int64_t after) -> int64_t {
+      return before < 0 || after < before ? -1 : after - before;
+    };
+    const auto rate = [&](int64_t before, int64_t after) {
+      const int64_t d = delta(before, after);
+      return d < 0 ? -1.0 : static_cast<double>(d) / period_s;
+    };
+    const auto await = [&](int64_t time_before, int64_t time_after, int64_t count_before, int64_t count_after) {
+      const int64_t time = delta(time_before, time_after);
+      const int64_t count = delta(count_before, count_after);
+      if (time < 0 || count < 0) {
+        return -1.0;
+      }
+      return count == 0 ? 0.0 : static_cast<double>(time) / static_cast<double>(count);
+    };
+    stats.reads_per_s = rate(previous.reads, current.reads);
+    stats.writes_per_s = rate(previous.writes, current.writes);
+    stats.read_Bytes_per_s = rate(previous.read_Bytes, current.read_Bytes);
+    stats.written_Bytes_per_s = rate(previous.written_Bytes, current.written_Bytes);
+    stats.read_await_ms = await(previous.read_time_ms, current.read_time_ms, previous.reads, current.reads);
+    stats.write_await_ms = await(previous.write_time_ms, current.write_time_ms, previous.writes, current.writes);
+    const int64_t weighted = delta(previous.weighted_time_ms, current.weighted_time_ms);
+    stats.queue_depth = weighted < 0 ? -1.0 : static_cast<double>(weighted) / period_ms;
+    const int64_t busy = delta(previous.busy_time_ms, current.busy_time_ms);
+    stats.utilisation = busy < 0 ? -1.0 : std::min(static_cast<double>(busy) / period_ms, 1.0);
+    stats.in_flight = current.in_flight;
+  }
+  return true;
+}
+
+}  // namespace hwinfo
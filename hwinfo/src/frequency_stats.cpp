@@ -0,0 +1,61 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/frequency_stats.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+FrequencySampler::FrequencySampler() : FrequencySampler(static_cast<int>(std::thread::hardware_concurrency())) {}
+
+// _____________________________________________________________________________________________________________________
+bool FrequencySampler::update() {
+  HWINFO_TRACE_SCOPE(FrequencyStats);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  std::swap(_previous, _current);
+  std::fill(_current.begin(), _current.end(), Counters());
+  std::fill(_stats.begin(), _stats.end(), FrequencyStats());
+  const bool success = read_counters();
+  const double period_s = static_cast<double>(now - _timestamp_ns) / 1e9;
+  const bool has_baseline = _has_baseline && period_s > 0;
+  _has_baseline = success;
+  _timestamp_ns = now;
+  if (!success || !has_baseline) {
+    return success;
+  }
+
+  for (size_t i = 0; i < _current.size(); ++i) {
+    const Counters& previous = _previous[i];
+    const Counters& current = _current[i];
+    FrequencyStats& stats = _stats[i];
+    // -1 if either sample lacks the counter or it went backwards (cpu offlined, counter reset)
+    const auto delta = [](int64_t before, int64_t after) -> int64_t {
+      return before < 0 || after < before ? -1 : after - before;
+    };
+    const int64_t tsc = delta(previous.tsc, current.tsc);
+    const int64_t aperf = delta(previous.aperf, current.aperf);
+    const int64_t mperf = delta(previous.mperf, current.mperf);
+    if (aperf >= 0) {
+      stats.average_MHz = static_cast<double>(aperf) / period_s / 1e6;
+    }
+    if (tsc > 0 && mperf >= 0) {
+      stats.busy = std::min(static_cast<double>(mperf) / static_cast<double>(tsc), 1.0);
+    }
+    if (tsc > 0 && aperf >= 0 && mperf > 0) {
+      // MPERF ticks at the TSC rate while not halted
+      const double tsc_MHz = static_cast<double>(tsc) / period_s / 1e6;
+      stats.busy_MHz = static_cast<double>(aperf) / static_cast<double>(mperf) * tsc_MHz;
+    }
+  }
+  return true;
+}
+
+}  // namespace hwinfo
@@ -8,13 +8,13 @@
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
-const std::string& GPU::vendor() const { return _vendor; }
+InternedString GPU::vendor() const { return _vendor; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& GPU::name() const { return _name; }
+InternedString GPU::name() const { return _name; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& GPU::driverVersion() const { return _driverVersion; }
+InternedString GPU::driverVersion() const { return _driverVersion; }
 
 // _____________________________________________________________________________________________________________________
 int GPU::id() const { return _id; }
@@ -29,9 +29,15 @@ int64_t GPU::frequency_MHz() const { return _frequency_MHz; }
 int GPU::num_cores() const { return _num_cores; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& GPU::vendor_id() const { return _vendor_id; }
+InternedString GPU::vendor_id() const { return _vendor_id; }
 
 // _____________________________________________________________________________________________________________________
-const std::string& GPU::device_id() const { return _device_id; }
+InternedString GPU::device_id() const { return _device_id; }
+
+// _____________________________________________________________________________________________________________________
+const std::string& GPU::pciBusId() const { return _pci_bus_id; }
+
+// _____________________________________________________________________________________________________________________
+std::vector<GPU> getAllGPUs() { return getAllGPUs(GPUFields::All); }
 
 }  // namespace hwinfo
@@ -0,0 +1,41 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/gpu.h>
+#include <hwinfo/gpu_stats.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+std::vector<std::string> gpu_pci_bus_ids() {
+  std::vector<std::string> ids;
+  for (const auto& gpu : getAllGPUs()) {
+    ids.push_back(gpu.pciBusId());
+  }
+  return ids;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+GPUStatsSampler::GPUStatsSampler() : GPUStatsSampler(gpu_pci_bus_ids()) {}
+
+// _____________________________________________________________________________________________________________________
+bool GPUStatsSampler::update() {
+  HWINFO_TRACE_SCOPE(GPUStats);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  std::fill(_stats.begin(), _stats.end(), GPUStats());
+  const bool success = read_stats(now);
+  _timestamp_ns = now;
+  return success;
+}
+
+}  // namespace hwinfo
@@ -5,4 +5,225 @@
  * This file is part of hwinfo.
  */
 
-#include <hwinfo/hwinfo.h>
\ No newline at end of file
+#include <hwinfo/hwinfo.h>
+#include <hwinfo/utils/iokit.h>
+#include <hwinfo/utils/wmi_wrapper.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// Counts finished tasks and keeps the first exception.
+class TaskGroup {
+ public:
+  explicit TaskGroup(size_t num_tasks) : _pending(num_tasks) {}
+
+  void done(std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (error && !_error) {
+      _error = std::move(error);
+    }
+    if (--_pending == 0) {
+      _finished.notify_all();
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished.wait(lock, [this] { return _pending == 0; });
+    if (_error) {
+      std::rethrow_exception(_error);
+    }
+  }
+
+ private:
+  std::mutex _mutex;
+  std::condition_variable _finished;
+  size_t _pending;
+  std::exception_ptr _error;
+};
+
+// One task per requested component, every task writes to its own member of info only.
+std::vector<std::function<void()>> componentTasks(Component components, SystemInfo& info) {
+  std::vector<std::function<void()>> tasks;
+  if (contains(components, Component::CPU)) tasks.emplace_back([&info] { info.cpus = getAllCPUs(); });
+  if (contains(components, Component::OS)) tasks.emplace_back([&info] { info.os.emplace(); });
+  if (contains(components, Component::GPU)) tasks.emplace_back([&info] { info.gpus = getAllGPUs(); });
+  if (contains(components, Component::Memory)) tasks.emplace_back([&info] { info.memory.emplace(); });
+  if (contains(components, Component::MainBoard)) tasks.emplace_back([&info] { info.mainboard.emplace(); });
+  if (contains(components, Component::Disk)) tasks.emplace_back([&info] { info.disks = getAllDisks(); });
+  if (contains(components, Component::Battery)) tasks.emplace_back([&info] { info.batteries = getAllBatteries(); });
+  if (contains(components, Component::Network)) tasks.emplace_back([&info] { info.networks = getAllNetworks(); });
+  return tasks;
+}
+
+// Shared state of a collectAllAsync() call, completed by the last task or by the timeout.
+struct AsyncCollection {
+  using Done = std::function<void(std::optional<SystemInfo>, std::exception_ptr)>;
+
+  SystemInfo info;
+  std::vector<std::function<void()>> tasks;
+  Done done;
+  std::atomic<bool> finished{false};
+  std::mutex mutex;
+  size_t pending{0};
+  std::exception_ptr error;
+#ifdef HWINFO_WINDOWS
+  // cancelled by the timeout, so that WMI enumerations release their workers as well
+  utils::WMI::Options wmi_options{utils::WMI::default_options()};
+#endif
+#ifdef HWINFO_APPLE
+  // shares the registry walks of the tasks, released by the last one
+  std::unique_ptr<utils::iokit::Scope> registry_scope{std::make_unique<utils::iokit::Scope>()};
+#endif
+
+  void finish(std::optional<SystemInfo> result, std::exception_ptr failure) {
+    if (!finished.exchange(true)) {
+      Done callback = std::move(done);
+      callback(std::move(result), std::move(failure));
+    }
+  }
+
+  void taskDone(std::exception_ptr failure) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (failure && !error) {
+        error = std::move(failure);
+      }
+      if (--pending > 0) {
+        return;
+      }
+#ifdef HWINFO_APPLE
+      registry_scope.reset();
+#endif
+    }
+    if (error) {
+      finish(std::nullopt, error);
+    } else {
+      finish(std::move(info), nullptr);
+    }
+  }
+};
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+Executor inlineExecutor() {
+  return [](std::function<void()> task) { task(); };
+}
+
+// _____________________________________________________________________________________________________________________
+SystemInfo collectAll(Component components, const Executor& executor) {
+#ifdef HWINFO_APPLE
+  // the collectors share one walk of every IOKit class they read
+  const utils::iokit::Scope registry_scope;
+#endif
+  SystemInfo info;
+  const std::vector<std::function<void()>> tasks = componentTasks(components, info);
+
+  TaskGroup group(tasks.size());
+  auto run = [&group](const std::function<void()>& task) {
+    std::exception_ptr error;
+    try {
+      task();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    group.done(std::move(error));
+  };
+
+  if (executor) {
+    for (const auto& task : tasks) {
+      executor([&run, &task] { run(task); });
+    }
+    group.wait();
+    return info;
+  }
+
+  // the workers of the shared pool keep their WMI sessions between collections. Whichever of a worker and the calling
+  // thread claims a task first runs it, so that the call completes while all workers are busy (a hung collector, or
+  // collectAll() called from a worker); a worker only touches the stack of this call after claiming a task.
+  auto claimed = std::make_shared<std::vector<std::atomic<bool>>>(tasks.size());
+  WorkerPool& pool = WorkerPool::shared();
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    pool.submit([claimed, i, &run, &tasks] {
+      if (!(*claimed)[i].exchange(true)) {
+        run(tasks[i]);
+      }
+    });
+  }
+  // from the back, the workers start at the front
+  for (size_t i = tasks.size(); i-- > 0;) {
+    if (!(*claimed)[i].exchange(true)) {
+      run(tasks[i]);
+    }
+  }
+  group.wait();
+  return info;
+}
+
+// _____________________________________________________________________________________________________________________
+void collectAllAsync(Component components, std::function<void(std::optional<SystemInfo>, std::exception_ptr)> done,
+                     std::chrono::milliseconds timeout) {
+  auto call = std::make_shared<AsyncCollection>();
+  call->done = std::move(done);
+  call->tasks = componentTasks(components, call->info);
+  call->pending = call->tasks.size();
+  if (call->tasks.empty()) {
+    call->finish(std::move(call->info), nullptr);
+    return;
+  }
+  WorkerPool& pool = WorkerPool::shared();
+  if (timeout.count() > 0) {
+#ifdef HWINFO_WINDOWS
+    call->wmi_options.cancel.emplace();
+#endif
+    pool.after(timeout, [call] {
+#ifdef HWINFO_WINDOWS
+      call->wmi_options.cancel->cancel();
+#endif
+      call->finish(std::nullopt, std::make_exception_ptr(TimeoutError()));
+    });
+  }
+  for (size_t i = 0; i < call->tasks.size(); ++i) {
+    pool.submit([call, i] {
+#ifdef HWINFO_WINDOWS
+      const utils::WMI::ScopedOptions wmi_options(call->wmi_options);
+#endif
+      std::exception_ptr error;
+      try {
+        call->tasks[i]();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      call->taskDone(std::move(error));
+    });
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+std::future<SystemInfo> collectAllAsync(Component components, std::chrono::milliseconds timeout) {
+  auto promise = std::make_shared<std::promise<SystemInfo>>();
+  std::future<SystemInfo> future = promise->get_future();
+  collectAllAsync(
+      components,
+      [promise](std::optional<SystemInfo> info, std::exception_ptr error) {
+        if (error) {
+          promise->set_exception(std::move(error));
+        } else {
+          promise->set_value(std::move(*info));
+        }
+      },
+      timeout);
+  return future;
+}
+
+}  // namespace hwinfo
@@ -1,391 +1,1851 @@
 #include "hwinfo/hwinfo_c.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "hwinfo/hwinfo.h"
+#include "hwinfo/utils/filesystem.h"
+#include "hwinfo/utils/wmi_wrapper.h"
 
-extern "C" {
+namespace {
+
+// Bump allocator over one single malloc'ed block, used in two phases: first every object and string is reserved
+// (sizes include worst case alignment padding), then allocate() creates the block and the same objects are placed into
+// it. The first object placed starts the block, so the whole result is released with one std::free() on it.
+class Arena {
+ public:
+  template <typename T, size_t Alignment = alignof(T)>
+  void reserve(size_t n = 1) {
+    if (n > 0) {
+      _size += n * sizeof(T) + Alignment - 1;
+    }
+  }
+
+  void reserve(const std::string& s) { _size += s.size() + 1; }
+
+  void reserve(hwinfo::InternedString s) { _size += s.size() + 1; }
+
+  void reserve(const std::vector<std::string>& strings) {
+    reserve<char*>(strings.size());
+    for (const auto& s : strings) {
+      reserve(s);
+    }
+  }
+
+  bool allocate() {
+    _base = static_cast<char*>(std::malloc(_size > 0 ? _size : 1));
+    _offset = 0;
+    return _base != nullptr;
+  }
+
+  // Places the objects into buffer (grown if needed) instead of a new block. The result is owned by buffer and
+  // overwritten by its next use, so repeated conversions allocate only when an item is larger than all before.
+  void allocate(std::vector<char>& buffer) {
+    if (buffer.size() < _size) {
+      buffer.resize(_size);
+    }
+    _base = buffer.data();
+    _offset = 0;
+  }
+
+  template <typename T, size_t Alignment = alignof(T)>
+  T* alloc(size_t n = 1) {
+    if (n == 0) {
+      return nullptr;
+    }
+    // aligns the address (not only the offset): Alignment may exceed the alignment guaranteed by malloc
+    const auto address = reinterpret_cast<uintptr_t>(_base) + _offset;
+    _offset += (Alignment - address % Alignment) % Alignment;
+    T* ptr = reinterpret_cast<T*>(_base + _offset);
+    _offset += n * sizeof(T);
+    for (size_t i = 0; i < n; ++i) {
+      new (ptr + i) T{};
+    }
+    return ptr;
+  }
+
+  char* copy(const std::string& s) {
+    char* dst = _base + _offset;
+    std::memcpy(dst, s.c_str(), s.size() + 1);
+    _offset += s.size() + 1;
+    return dst;
+  }
+
+  char* copy(hwinfo::InternedString s) {
+    char* dst = _base + _offset;
+    std::memcpy(dst, s.c_str(), s.size() + 1);
+    _offset += s.size() + 1;
+    return dst;
+  }
+
+  C_StringArray copy(const std::vector<std::string>& strings) {
+    C_StringArray array{static_cast<int>(strings.size()), alloc<char*>(strings.size())};
+    for (size_t i = 0; i < strings.size(); ++i) {
+      array.strings[i] = copy(strings[i]);
+    }
+    return array;
+  }
+
+ private:
+  char* _base{nullptr};
+  size_t _size{0};
+  size_t _offset{0};
+};
+
+// Values that are computed on access are read once, so that both arena phases see the same data.
+struct OSValues {
+  hwinfo::InternedString name;
+  hwinfo::InternedString version;
+  hwinfo::InternedString kernel;
+  bool is32bit;
+  bool is64bit;
+  bool isLittleEndian;
+};
+
+struct MemoryValues {
+  int64_t total_Bytes;
+  int64_t free_Bytes;
+  int64_t available_Bytes;
+  std::vector<hwinfo::Memory::Module> modules;
+};
+
+struct MainBoardValues {
+  hwinfo::InternedString vendor;
+  hwinfo::InternedString name;
+  hwinfo::InternedString version;
+  hwinfo::InternedString serialNumber;
+};
+
+struct BatteryValues {
+  int id;
+  hwinfo::InternedString vendor;
+  hwinfo::InternedString model;
+  hwinfo::InternedString serialNumber;
+  hwinfo::InternedString technology;
+  uint32_t energyFull;
+  hwinfo::BatteryStatus status;
+};
+
+// _____________________________________________________________________________________________________________________
+OSValues read_os(const hwinfo::OS& os) {
+  return {os.name(), os.version(), os.kernel(), os.is32bit(), os.is64bit(), os.isLittleEndian()};
+}
+
+// _____________________________________________________________________________________________________________________
+MemoryValues read_memory(const hwinfo::Memory& mem) {
+  const hwinfo::MemorySnapshot snapshot = mem.snapshot();
+  return {mem.total_Bytes(), snapshot.free_Bytes, snapshot.available_Bytes, mem.modules()};
+}
+
+// _____________________________________________________________________________________________________________________
+MainBoardValues read_mainboard(const hwinfo::MainBoard& mb) {
+  return {mb.vendor(), mb.name(), mb.version(), mb.serialNumber()};
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<BatteryValues> read_batteries(const std::vector<hwinfo::Battery>& batteries) {
+  std::vector<BatteryValues> values;
+  values.reserve(batteries.size());
+  for (size_t i = 0; i < batteries.size(); ++i) {
+    const auto& b = batteries[i];
+    values.push_back({static_cast<int>(i), b.getVendor(), b.getModel(), b.getSerialNumber(), b.getTechnology(),
+                      b.getEnergyFull(), b.status()});
+  }
+  return values;
+}
+
+// --- reserve / convert per component ---
+
+static_assert(C_CPU_FEATURE_COUNT == static_cast<int>(hwinfo::Feature::Count), "feature count mismatch");
+static_assert(C_CPU_FEATURE_WORDS == hwinfo::FeatureSet::num_words, "feature word count mismatch");
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const hwinfo::CPU& cpu) {
+  arena.reserve(cpu.vendor());
+  arena.reserve(cpu.modelName());
+  arena.reserve(cpu.flags());
+}
+
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const hwinfo::CPU& cpu, C_CPU& out) {
+  out.id = cpu.id();
+  out.vendor = arena.copy(cpu.vendor());
+  out.modelName = arena.copy(cpu.modelName());
+  out.numPhysicalCores = cpu.numPhysicalCores();
+  out.numLogicalCores = cpu.numLogicalCores();
+  out.maxClockSpeed_MHz = cpu.maxClockSpeed_MHz();
+  out.regularClockSpeed_MHz = cpu.regularClockSpeed_MHz();
+  out.L1CacheSize_Bytes = cpu.L1CacheSize_Bytes();
+  out.L2CacheSize_Bytes = cpu.L2CacheSize_Bytes();
+  out.L3CacheSize_Bytes = cpu.L3CacheSize_Bytes();
+  out.flags = arena.copy(cpu.flags());
+  const auto& words = cpu.features().words();
+  std::copy(words.begin(), words.end(), out.features);
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const OSValues& os) {
+  arena.reserve(os.name);
+  arena.reserve(os.version);
+  arena.reserve(os.kernel);
+}
+
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const OSValues& os, C_OS& out) {
+  out.name = arena.copy(os.name);
+  out.version = arena.copy(os.version);
+  out.kernel = arena.copy(os.kernel);
+  out.is32bit = os.is32bit;
+  out.is64bit = os.is64bit;
+  out.isLittleEndian = os.isLittleEndian;
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const hwinfo::GPU& gpu) {
+  arena.reserve(gpu.vendor());
+  arena.reserve(gpu.name());
+  arena.reserve(gpu.driverVersion());
+  arena.reserve(gpu.vendor_id());
+  arena.reserve(gpu.device_id());
+  arena.reserve(gpu.pciBusId());
+}
+
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const hwinfo::GPU& gpu, C_GPU& out) {
+  out.id = gpu.id();
+  out.vendor = arena.copy(gpu.vendor());
+  out.name = arena.copy(gpu.name());
+  out.driverVersion = arena.copy(gpu.driverVersion());
+  out.memory_Bytes = gpu.memory_Bytes();
+  out.frequency_MHz = gpu.frequency_MHz();
+  out.num_cores = gpu.num_cores();
+  out.vendor_id = arena.copy(gpu.vendor_id());
+  out.device_id = arena.copy(gpu.device_id());
+  out.pciBusId = arena.copy(gpu.pciBusId());
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const hwinfo::Memory::Module& module) {
+  arena.reserve(module.vendor);
+  arena.reserve(module.name);
+  arena.reserve(module.model);
+  arena.reserve(module.serial_number);
+}
+
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const hwinfo::Memory::Module& module, C_RAM_Module& out) {
+  out.id = module.id;
+  out.vendor = arena.copy(module.vendor);
+  out.name = arena.copy(module.name);
+  out.model = arena.copy(module.model);
+  out.serial_number = arena.copy(module.serial_number);
+  out.total_Bytes = module.total_Bytes;
+  out.frequency_Hz = module.frequency_Hz;
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const MemoryValues& mem) {
+  arena.reserve<C_RAM_Module>(mem.modules.size());
+  for (const auto& module : mem.modules) {
+    reserve(arena, module);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const MemoryValues& mem, C_MemoryInfo& out) {
+  out.total_Bytes = mem.total_Bytes;
+  out.free_Bytes = mem.free_Bytes;
+  out.available_Bytes = mem.available_Bytes;
+  out.module_count = static_cast<int>(mem.modules.size());
+  out.modules = arena.alloc<C_RAM_Module>(mem.modules.size());
+  for (size_t i = 0; i < mem.modules.size(); ++i) {
+    convert(arena, mem.modules[i], out.modules[i]);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const MainBoardValues& mb) {
+  arena.reserve(mb.vendor);
+  arena.reserve(mb.name);
+  arena.reserve(mb.version);
+  arena.reserve(mb.serialNumber);
+}
+
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const MainBoardValues& mb, C_MainBoard& out) {
+  out.vendor = arena.copy(mb.vendor);
+  out.name = arena.copy(mb.name);
+  out.version = arena.copy(mb.version);
+  out.serialNumber = arena.copy(mb.serialNumber);
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const hwinfo::Disk& disk) {
+  arena.reserve(disk.vendor());
+  arena.reserve(disk.model());
+  arena.reserve(disk.serialNumber());
+  arena.reserve(disk.volumes());
+}
 
-// --- Helper Functions for Memory Management ---
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const hwinfo::Disk& disk, C_Disk& out) {
+  out.id = disk.id();
+  out.vendor = arena.copy(disk.vendor());
+  out.model = arena.copy(disk.model());
+  out.serialNumber = arena.copy(disk.serialNumber());
+  out.size_Bytes = disk.size_Bytes();
+  out.free_size_Bytes = disk.free_size_Bytes();
+  out.volumes = arena.copy(disk.volumes());
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const BatteryValues& battery) {
+  arena.reserve(battery.vendor);
+  arena.reserve(battery.model);
+  arena.reserve(battery.serialNumber);
+  arena.reserve(battery.technology);
+}
+
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const BatteryValues& battery, C_Battery& out) {
+  out.id = battery.id;
+  out.vendor = arena.copy(battery.vendor);
+  out.model = arena.copy(battery.model);
+  out.serialNumber = arena.copy(battery.serialNumber);
+  out.technology = arena.copy(battery.technology);
+  out.energyFull = battery.energyFull;
+  out.energyNow = battery.status.energyNow < 0 ? 0 : static_cast<uint32_t>(battery.status.energyNow);
+  out.charging = battery.status.charging;
+  out.powerNow = battery.status.powerNow;
+  out.voltageNow = battery.status.voltageNow;
+  out.capacity = battery.status.capacity;
+  out.cycleCount = battery.status.cycleCount;
+}
+
+// _____________________________________________________________________________________________________________________
+void reserve(Arena& arena, const hwinfo::Network& network) {
+  arena.reserve(network.interfaceIndex());
+  arena.reserve(network.description());
+  arena.reserve(network.mac());
+  arena.reserve(network.ip4());
+  arena.reserve(network.ip6());
+  arena.reserve(network.ip4s());
+  arena.reserve(network.ip6s());
+}
 
-// Allocates a new C-style string and copies the content of a std::string into it.
-// The caller is responsible for freeing this memory with delete[].
-char* copy_string(const std::string& s) {
-  if (s.empty()) {
-    char* c_str = new char[1];
-    c_str[0] = '\0';
-    return c_str;
+// _____________________________________________________________________________________________________________________
+void convert(Arena& arena, const hwinfo::Network& network, C_Network& out) {
+  out.interfaceIndex = arena.copy(network.interfaceIndex());
+  out.description = arena.copy(network.description());
+  out.mac = arena.copy(network.mac());
+  out.ip4 = arena.copy(network.ip4());
+  out.ip6 = arena.copy(network.ip6());
+  out.ip4s = arena.copy(network.ip4s());
+  out.ip6s = arena.copy(network.ip6s());
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename C, typename T>
+void reserve_all(Arena& arena, const std::vector<T>& items) {
+  arena.reserve<C>(items.size());
+  for (const auto& item : items) {
+    reserve(arena, item);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename C, typename T>
+C* convert_all(Arena& arena, const std::vector<T>& items) {
+  C* out = arena.alloc<C>(items.size());
+  for (size_t i = 0; i < items.size(); ++i) {
+    convert(arena, items[i], out[i]);
+  }
+  return out;
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename C, typename T>
+C* convert_optional(Arena& arena, const std::unique_ptr<T>& item) {
+  if (!item) {
+    return nullptr;
   }
-  char* c_str = new char[s.length() + 1];
-  std::strcpy(c_str, s.c_str());
-  return c_str;
+  C* out = arena.alloc<C>();
+  convert(arena, *item, *out);
+  return out;
 }
 
-// Frees a C_StringArray, including all individual strings.
-void free_string_array(C_StringArray* arr) {
-    if (!arr) return;
-    for (int i = 0; i < arr->count; ++i) {
-        delete[] arr->strings[i];
+// _____________________________________________________________________________________________________________________
+template <typename C, typename T>
+C* build_array(const std::vector<T>& items) {
+  if (items.empty()) {
+    return nullptr;
+  }
+  Arena arena;
+  reserve_all<C>(arena, items);
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  return convert_all<C>(arena, items);
+}
+
+// _____________________________________________________________________________________________________________________
+// Fresh enumeration with a field mask for the get_*_with_fields() functions.
+template <typename C, typename Fields, typename T>
+C* build_with_fields(std::vector<T> (*collect)(Fields), uint32_t fields, int* count) {
+  if (count) *count = 0;
+  try {
+    const std::vector<T> items = collect(static_cast<Fields>(fields & static_cast<uint32_t>(Fields::All)));
+    C* result = build_array<C>(items);
+    if (result && count) *count = static_cast<int>(items.size());
+    return result;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename C, typename T>
+C* build_single(const T& item) {
+  Arena arena;
+  arena.reserve<C>();
+  reserve(arena, item);
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  C* out = arena.alloc<C>();
+  convert(arena, item, *out);
+  return out;
+}
+
+// _____________________________________________________________________________________________________________________
+// Places a C_DoubleArray / C_Int64Array header and its values into one block.
+template <typename C, typename T>
+C* build_values(const std::vector<T>& values) {
+  Arena arena;
+  arena.reserve<C>();
+  arena.reserve<T>(values.size());
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  C* out = arena.alloc<C>();
+  out->count = static_cast<int>(values.size());
+  out->values = arena.alloc<T>(values.size());
+  if (!values.empty()) {
+    std::memcpy(out->values, values.data(), values.size() * sizeof(T));
+  }
+  return out;
+}
+
+struct SystemValues {
+  std::vector<hwinfo::CPU> cpus;
+  std::unique_ptr<OSValues> os;
+  std::vector<hwinfo::GPU> gpus;
+  std::unique_ptr<MemoryValues> memory;
+  std::unique_ptr<MainBoardValues> mainboard;
+  std::vector<hwinfo::Disk> disks;
+  std::vector<BatteryValues> batteries;
+  std::vector<hwinfo::Network> networks;
+};
+
+// _____________________________________________________________________________________________________________________
+int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Enumerated list of one component, shared by all threads. The current list is an immutable snapshot that readers take
+// without locking and keep alive for as long as they use it, a reload publishes a new one. A snapshot is reloaded once
+// it is older than the TTL (never if negative) or after invalidate(). Only one thread enumerates at a time: while it
+// does, the others keep using the expired snapshot, they only wait for the first load and for one after invalidate().
+template <typename T>
+class ComponentCache {
+ public:
+  using Items = std::vector<T>;
+
+  ComponentCache(Items (*load)(), int64_t ttl_ms) : _load(load), _ttl_ms(ttl_ms) {}
+
+  std::shared_ptr<const Items> get() {
+    std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&_snapshot);
+    if (snapshot && fresh(*snapshot)) {
+      return items_of(std::move(snapshot));
+    }
+    std::unique_lock<std::mutex> lock(_reload_mutex, std::defer_lock);
+    const bool expired_only = snapshot && snapshot->generation == _generation.load();
+    if (expired_only && !lock.try_lock()) {
+      return items_of(std::move(snapshot));
     }
-    delete[] arr->strings;
-    delete arr;
+    if (!lock.owns_lock()) {
+      lock.lock();
+    }
+    // another thread may have reloaded while this one waited
+    snapshot = std::atomic_load(&_snapshot);
+    if (snapshot && fresh(*snapshot)) {
+      return items_of(std::move(snapshot));
+    }
+    // read before enumerating: an invalidate() during the enumeration causes another reload
+    const uint64_t generation = _generation.load();
+    snapshot = std::make_shared<const Snapshot>(Snapshot{_load(), now_ns(), generation});
+    std::atomic_store(&_snapshot, snapshot);
+    return items_of(std::move(snapshot));
+  }
+
+  // Number of items of the current snapshot, which the next take_counted() of this thread returns. Pairs the
+  // get_*_count() and get_all_*() calls of the C API, so that a reload in between cannot change the size.
+  int count() {
+    counted() = get();
+    return static_cast<int>(counted()->size());
+  }
+
+  std::shared_ptr<const Items> take_counted() {
+    std::shared_ptr<const Items> items = std::move(counted());
+    return items ? items : get();
+  }
+
+  void invalidate() { _generation.fetch_add(1); }
+
+  void set_ttl(int64_t ttl_ms) { _ttl_ms.store(ttl_ms); }
+
+ private:
+  struct Snapshot {
+    Items items;
+    int64_t loaded_ns;
+    uint64_t generation;
+  };
+
+  bool fresh(const Snapshot& snapshot) const {
+    const int64_t ttl_ms = _ttl_ms.load();
+    return snapshot.generation == _generation.load() &&
+           (ttl_ms < 0 || now_ns() - snapshot.loaded_ns < ttl_ms * 1000000);
+  }
+
+  static std::shared_ptr<const Items> items_of(std::shared_ptr<const Snapshot> snapshot) {
+    // shares the ownership of the snapshot
+    const Items* items = &snapshot->items;
+    return std::shared_ptr<const Items>(std::move(snapshot), items);
+  }
+
+  static std::shared_ptr<const Items>& counted() {
+    thread_local std::shared_ptr<const Items> items;
+    return items;
+  }
+
+  Items (*_load)();
+  std::atomic<int64_t> _ttl_ms;
+  std::atomic<uint64_t> _generation{0};
+  std::shared_ptr<const Snapshot> _snapshot;
+  std::mutex _reload_mutex;
+};
+
+// The cpu, gpu and battery objects read their dynamic values on access, the disk and network lists hold the free space
+// and the addresses as of the enumeration.
+ComponentCache<hwinfo::CPU> cpu_cache(hwinfo::getAllCPUs, -1);
+ComponentCache<hwinfo::GPU> gpu_cache(hwinfo::getAllGPUs, -1);
+ComponentCache<hwinfo::Disk> disk_cache(hwinfo::getAllDisks, 1000);
+ComponentCache<hwinfo::Battery> battery_cache(hwinfo::getAllBatteries, -1);
+ComponentCache<hwinfo::Network> network_cache(hwinfo::getAllNetworks, 1000);
+
+// _____________________________________________________________________________________________________________________
+template <typename F>
+void for_each_cache(uint32_t components, F f) {
+  const auto selected = static_cast<hwinfo::Component>(components);
+  if (hwinfo::contains(selected, hwinfo::Component::CPU)) f(cpu_cache);
+  if (hwinfo::contains(selected, hwinfo::Component::GPU)) f(gpu_cache);
+  if (hwinfo::contains(selected, hwinfo::Component::Disk)) f(disk_cache);
+  if (hwinfo::contains(selected, hwinfo::Component::Battery)) f(battery_cache);
+  if (hwinfo::contains(selected, hwinfo::Component::Network)) f(network_cache);
 }
 
+// _____________________________________________________________________________________________________________________
+void invalidate_caches(hwinfo::Component components) {
+  for_each_cache(static_cast<uint32_t>(components), [](auto& cache) { cache.invalidate(); });
+}
+
+// _____________________________________________________________________________________________________________________
+// The cpu_id-th cpu of cpus, nullptr if cpu_id is out of range.
+const hwinfo::CPU* cpu_at(const std::shared_ptr<const std::vector<hwinfo::CPU>>& cpus, int cpu_id) {
+  return cpu_id >= 0 && static_cast<size_t>(cpu_id) < cpus->size() ? &(*cpus)[cpu_id] : nullptr;
+}
+
+// the snapshot flags are the hwinfo::Component bits
+static_assert(C_SNAPSHOT_CPU == static_cast<uint32_t>(hwinfo::Component::CPU), "flag mismatch");
+static_assert(C_SNAPSHOT_NETWORK == static_cast<uint32_t>(hwinfo::Component::Network), "flag mismatch");
+static_assert(C_SNAPSHOT_ALL == static_cast<uint32_t>(hwinfo::Component::All), "flag mismatch");
+
+// _____________________________________________________________________________________________________________________
+hwinfo::SystemInfo collect_system(uint32_t flags) {
+  const auto components = static_cast<hwinfo::Component>(flags & C_SNAPSHOT_ALL);
+  return hwinfo::collectAll(components, (flags & C_SNAPSHOT_PARALLEL) ? hwinfo::Executor() : hwinfo::inlineExecutor());
+}
+
+// _____________________________________________________________________________________________________________________
+SystemValues to_values(hwinfo::SystemInfo info) {
+  SystemValues values;
+  values.cpus = std::move(info.cpus);
+  if (info.os) values.os = std::make_unique<OSValues>(read_os(*info.os));
+  values.gpus = std::move(info.gpus);
+  if (info.memory) values.memory = std::make_unique<MemoryValues>(read_memory(*info.memory));
+  if (info.mainboard) values.mainboard = std::make_unique<MainBoardValues>(read_mainboard(*info.mainboard));
+  values.disks = std::move(info.disks);
+  values.batteries = read_batteries(info.batteries);
+  values.networks = std::move(info.networks);
+  return values;
+}
+
+// _____________________________________________________________________________________________________________________
+SystemValues read_system(uint32_t flags) { return to_values(collect_system(flags)); }
+
+// _____________________________________________________________________________________________________________________
+C_SystemSnapshot* to_snapshot(const SystemValues& values, uint32_t flags) {
+  Arena arena;
+  arena.reserve<C_SystemSnapshot>();
+  reserve_all<C_CPU>(arena, values.cpus);
+  if (values.os) {
+    arena.reserve<C_OS>();
+    reserve(arena, *values.os);
+  }
+  reserve_all<C_GPU>(arena, values.gpus);
+  if (values.memory) {
+    arena.reserve<C_MemoryInfo>();
+    reserve(arena, *values.memory);
+  }
+  if (values.mainboard) {
+    arena.reserve<C_MainBoard>();
+    reserve(arena, *values.mainboard);
+  }
+  reserve_all<C_Disk>(arena, values.disks);
+  reserve_all<C_Battery>(arena, values.batteries);
+  reserve_all<C_Network>(arena, values.networks);
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+
+  C_SystemSnapshot* snapshot = arena.alloc<C_SystemSnapshot>();
+  snapshot->flags = flags;
+  snapshot->cpu_count = static_cast<int>(values.cpus.size());
+  snapshot->cpus = convert_all<C_CPU>(arena, values.cpus);
+  snapshot->os = convert_optional<C_OS>(arena, values.os);
+  snapshot->gpu_count = static_cast<int>(values.gpus.size());
+  snapshot->gpus = convert_all<C_GPU>(arena, values.gpus);
+  snapshot->memory = convert_optional<C_MemoryInfo>(arena, values.memory);
+  snapshot->mainboard = convert_optional<C_MainBoard>(arena, values.mainboard);
+  snapshot->disk_count = static_cast<int>(values.disks.size());
+  snapshot->disks = convert_all<C_Disk>(arena, values.disks);
+  snapshot->battery_count = static_cast<int>(values.batteries.size());
+  snapshot->batteries = convert_all<C_Battery>(arena, values.batteries);
+  snapshot->network_count = static_cast<int>(values.networks.size());
+  snapshot->networks = convert_all<C_Network>(arena, values.networks);
+  return snapshot;
+}
+
+// _____________________________________________________________________________________________________________________
+C_Bytes* to_bytes(const std::string& data) {
+  if (data.empty()) {
+    return nullptr;
+  }
+  Arena arena;
+  arena.reserve<C_Bytes>();
+  arena.reserve<uint8_t>(data.size());
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_Bytes>();
+  result->size = static_cast<int64_t>(data.size());
+  result->data = arena.alloc<uint8_t>(data.size());
+  std::memcpy(result->data, data.data(), data.size());
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+std::string_view as_view(const uint8_t* data, int64_t size) {
+  if (!data || size <= 0) {
+    return {};
+  }
+  return {reinterpret_cast<const char*>(data), static_cast<size_t>(size)};
+}
+
+// _____________________________________________________________________________________________________________________
+// Field by field: CpuTimes has default member initializers, so it is no C struct that could be copied as a whole.
+void convert(const hwinfo::CpuTimes& times, C_CpuTimes& out) {
+  out.user = times.user;
+  out.nice = times.nice;
+  out.system = times.system;
+  out.idle = times.idle;
+  out.iowait = times.iowait;
+  out.irq = times.irq;
+  out.softirq = times.softirq;
+  out.steal = times.steal;
+  out.guest = times.guest;
+  out.guest_nice = times.guest_nice;
+}
+
+// _____________________________________________________________________________________________________________________
+hwinfo::CpuTimes to_cpu_times(const C_CpuTimes& times) {
+  hwinfo::CpuTimes out;
+  out.user = times.user;
+  out.nice = times.nice;
+  out.system = times.system;
+  out.idle = times.idle;
+  out.iowait = times.iowait;
+  out.irq = times.irq;
+  out.softirq = times.softirq;
+  out.steal = times.steal;
+  out.guest = times.guest;
+  out.guest_nice = times.guest_nice;
+  return out;
+}
+
+}  // namespace
+
+extern "C" {
+
 // --- Component Implementations ---
+// Every result is one arena block (see Arena above): structs, string pointer arrays and string bytes are placed into a
+// single malloc'ed allocation, so the free functions release it with one std::free() and ignore the count argument.
 
 // CPU
-static std::vector<hwinfo::CPU> cpus;
-
-int get_cpu_count() {
-  if (cpus.empty()) {
-    cpus = hwinfo::getAllCPUs();
-  }
-  return static_cast<int>(cpus.size());
-}
-
-C_CPU* get_all_cpus() {
-  if (cpus.empty()) {
-    cpus = hwinfo::getAllCPUs();
-  }
-  if (cpus.empty()) {
-    return nullptr;
-  }
-  C_CPU* c_cpus = new C_CPU[cpus.size()];
-  for (size_t i = 0; i < cpus.size(); ++i) {
-    c_cpus[i].id = cpus[i].id();
-    c_cpus[i].vendor = copy_string(cpus[i].vendor());
-    c_cpus[i].modelName = copy_string(cpus[i].modelName());
-    c_cpus[i].numPhysicalCores = cpus[i].numPhysicalCores();
-    c_cpus[i].numLogicalCores = cpus[i].numLogicalCores();
-    c_cpus[i].maxClockSpeed_MHz = cpus[i].maxClockSpeed_MHz();
-    c_cpus[i].regularClockSpeed_MHz = cpus[i].regularClockSpeed_MHz();
-    c_cpus[i].L1CacheSize_Bytes = cpus[i].L1CacheSize_Bytes();
-    c_cpus[i].L2CacheSize_Bytes = cpus[i].L2CacheSize_Bytes();
-    c_cpus[i].L3CacheSize_Bytes = cpus[i].L3CacheSize_Bytes();
-    const auto& flags = cpus[i].flags();
-    c_cpus[i].flags.count = static_cast<int>(flags.size());
-    c_cpus[i].flags.strings = new char*[flags.size()];
-    for(size_t j = 0; j < flags.size(); ++j) {
-        c_cpus[i].flags.strings[j] = copy_string(flags[j]);
-    }
-  }
-  return c_cpus;
+int get_cpu_count() { return cpu_cache.count(); }
+
+C_CPU* get_all_cpus() { return build_array<C_CPU>(*cpu_cache.take_counted()); }
+
+C_CPU* get_cpus_with_fields(uint32_t fields, int* count) {
+  return build_with_fields<C_CPU>(hwinfo::getAllCPUs, fields, count);
 }
 
 double get_cpu_utilization(int cpu_id) {
-    if (cpus.empty()) { cpus = hwinfo::getAllCPUs(); }
-    if (cpu_id < 0 || cpu_id >= cpus.size()) return -1.0;
-    return cpus[cpu_id].currentUtilisation();
+  const auto cpus = cpu_cache.get();
+  const hwinfo::CPU* cpu = cpu_at(cpus, cpu_id);
+  return cpu ? cpu->socketUtilisation() : -1.0;
 }
 
 C_DoubleArray* get_cpu_thread_utilizations(int cpu_id) {
-    if (cpus.empty()) { cpus = hwinfo::getAllCPUs(); }
-    if (cpu_id < 0 || cpu_id >= cpus.size()) return nullptr;
-    std::vector<double> utils = cpus[cpu_id].threadsUtilisation();
-    C_DoubleArray* result = new C_DoubleArray();
-    result->count = static_cast<int>(utils.size());
-    result->values = new double[utils.size()];
-    std::memcpy(result->values, utils.data(), utils.size() * sizeof(double));
-    return result;
+  const auto cpus = cpu_cache.get();
+  const hwinfo::CPU* cpu = cpu_at(cpus, cpu_id);
+  return cpu ? build_values<C_DoubleArray>(cpu->threadsUtilisation()) : nullptr;
 }
 
 C_Int64Array* get_cpu_thread_speeds_mhz(int cpu_id) {
-    if (cpus.empty()) { cpus = hwinfo::getAllCPUs(); }
-    if (cpu_id < 0 || cpu_id >= cpus.size()) return nullptr;
-    std::vector<int64_t> speeds = cpus[cpu_id].currentClockSpeed_MHz();
-    C_Int64Array* result = new C_Int64Array();
-    result->count = static_cast<int>(speeds.size());
-    result->values = new int64_t[speeds.size()];
-    std::memcpy(result->values, speeds.data(), speeds.size() * sizeof(int64_t));
-    return result;
+  const auto cpus = cpu_cache.get();
+  const hwinfo::CPU* cpu = cpu_at(cpus, cpu_id);
+  return cpu ? build_values<C_Int64Array>(cpu->currentClockSpeed_MHz()) : nullptr;
 }
 
-void free_cpu_info(C_CPU* c_cpus, int count) {
-  if (c_cpus) {
-    for (int i = 0; i < count; ++i) {
-      delete[] c_cpus[i].vendor;
-      delete[] c_cpus[i].modelName;
-      for (int j = 0; j < c_cpus[i].flags.count; ++j) {
-        delete[] c_cpus[i].flags.strings[j];
-      }
-      delete[] c_cpus[i].flags.strings;
-    }
-    delete[] c_cpus;
+int get_cpu_thread_utilizations_into(int cpu_id, double* out, int capacity) {
+  const auto cpus = cpu_cache.get();
+  const hwinfo::CPU* cpu = cpu_at(cpus, cpu_id);
+  if (!cpu || (!out && capacity > 0)) return -1;
+  return cpu->threadsUtilisation(out, capacity);
+}
+
+int get_cpu_thread_speeds_mhz_into(int cpu_id, int64_t* out, int capacity) {
+  const auto cpus = cpu_cache.get();
+  const hwinfo::CPU* cpu = cpu_at(cpus, cpu_id);
+  if (!cpu || (!out && capacity > 0)) return -1;
+  return cpu->currentClockSpeed_MHz(out, capacity);
+}
+
+void free_cpu_info(C_CPU* c_cpus, int /*count*/) { std::free(c_cpus); }
+
+const char* get_cpu_feature_name(int feature) {
+  if (feature < 0 || feature >= C_CPU_FEATURE_COUNT) return nullptr;
+  // the names are string literals, so the view is null terminated
+  return hwinfo::feature_name(static_cast<hwinfo::Feature>(feature)).data();
+}
+
+C_StringArray* get_cpu_flags(int cpu_id) {
+  const auto cpus = cpu_cache.get();
+  const hwinfo::CPU* cpu = cpu_at(cpus, cpu_id);
+  if (!cpu) return nullptr;
+  const auto& flags = cpu->flags();
+  Arena arena;
+  arena.reserve<C_StringArray>();
+  arena.reserve(flags);
+  if (!arena.allocate()) {
+    return nullptr;
   }
+  auto* result = arena.alloc<C_StringArray>();
+  *result = arena.copy(flags);
+  return result;
 }
 
-void free_double_array(C_DoubleArray* arr) {
-    if (arr) {
-        delete[] arr->values;
-        delete arr;
+void free_string_array(C_StringArray* arr) { std::free(arr); }
+
+void free_double_array(C_DoubleArray* arr) { std::free(arr); }
+
+void free_int64_array(C_Int64Array* arr) { std::free(arr); }
+
+// OS
+C_OS* get_os_info() { return build_single<C_OS>(read_os(hwinfo::OS())); }
+
+void free_os_info(C_OS* os) { std::free(os); }
+
+// GPU
+int get_gpu_count() { return gpu_cache.count(); }
+
+C_GPU* get_all_gpus() { return build_array<C_GPU>(*gpu_cache.take_counted()); }
+
+C_GPU* get_gpus_with_fields(uint32_t fields, int* count) {
+  return build_with_fields<C_GPU>(hwinfo::getAllGPUs, fields, count);
+}
+
+void free_gpu_info(C_GPU* c_gpus, int /*count*/) { std::free(c_gpus); }
+
+// Memory
+C_MemoryInfo* get_memory_info() { return build_single<C_MemoryInfo>(read_memory(hwinfo::Memory())); }
+
+void free_memory_info(C_MemoryInfo* memory_info) { std::free(memory_info); }
+
+// snapshots are copied as a whole into the caller's C_MemorySnapshot
+static_assert(std::is_trivially_copyable<hwinfo::MemorySnapshot>::value, "MemorySnapshot must be trivially copyable");
+static_assert(sizeof(C_MemorySnapshot) == sizeof(hwinfo::MemorySnapshot), "C_MemorySnapshot does not match");
+static_assert(offsetof(C_MemorySnapshot, hugepage_size_Bytes) == offsetof(hwinfo::MemorySnapshot, hugepage_size_Bytes),
+              "layout mismatch");
+
+int get_memory_snapshot_into(C_MemorySnapshot* out) {
+  if (!out) return -1;
+  hwinfo::MemorySnapshot snapshot;
+  const bool success = snapshot.update();
+  std::memcpy(out, &snapshot, sizeof(snapshot));
+  return success ? 0 : -1;
+}
+
+static_assert(std::is_trivially_copyable<hwinfo::NodeMemory>::value, "NodeMemory must be trivially copyable");
+static_assert(sizeof(C_NodeMemory) == sizeof(hwinfo::NodeMemory), "C_NodeMemory does not match");
+static_assert(offsetof(C_NodeMemory, total_Bytes) == offsetof(hwinfo::NodeMemory, total_Bytes), "layout mismatch");
+static_assert(offsetof(C_NodeMemory, demoted_pages) == offsetof(hwinfo::NodeMemory, demoted_pages), "layout mismatch");
+
+int get_numa_memory_into(C_NodeMemory* out, int capacity) {
+  if (capacity < 0 || (!out && capacity > 0)) return -1;
+  // one process wide sampler keeps the files open, a sampler must not be updated concurrently
+  static std::mutex mutex;
+  static hwinfo::NumaMemorySampler* const sampler = new hwinfo::NumaMemorySampler();
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!sampler->update()) {
+    return -1;
+  }
+  const std::vector<hwinfo::NodeMemory>& nodes = sampler->nodes();
+  const size_t n = std::min(nodes.size(), static_cast<size_t>(capacity));
+  if (n > 0) std::memcpy(out, nodes.data(), n * sizeof(hwinfo::NodeMemory));
+  return static_cast<int>(nodes.size());
+}
+
+// Mainboard
+C_MainBoard* get_mainboard_info() { return build_single<C_MainBoard>(read_mainboard(hwinfo::MainBoard())); }
+
+void free_mainboard_info(C_MainBoard* mainboard) { std::free(mainboard); }
+
+// Disk
+int get_disk_count() { return disk_cache.count(); }
+
+C_Disk* get_all_disks() { return build_array<C_Disk>(*disk_cache.take_counted()); }
+
+C_Disk* get_disks_with_fields(uint32_t fields, int* count) {
+  return build_with_fields<C_Disk>(hwinfo::getAllDisks, fields, count);
+}
+
+void free_disk_info(C_Disk* c_disks, int /*count*/) { std::free(c_disks); }
+
+// Battery
+int get_battery_count() { return battery_cache.count(); }
+
+C_Battery* get_all_batteries() { return build_array<C_Battery>(read_batteries(*battery_cache.take_counted())); }
+
+void free_battery_info(C_Battery* c_batteries, int /*count*/) { std::free(c_batteries); }
+
+// Network
+int get_network_count() { return network_cache.count(); }
+
+C_Network* get_all_networks() { return build_array<C_Network>(*network_cache.take_counted()); }
+
+C_Network* get_networks_with_fields(uint32_t fields, int* count) {
+  return build_with_fields<C_Network>(hwinfo::getAllNetworks, fields, count);
+}
+
+void free_network_info(C_Network* c_networks, int /*count*/) { std::free(c_networks); }
+
+// Iterators
+struct C_Iterator {
+  std::unique_ptr<hwinfo::DiskEnumerator> disks;
+  std::unique_ptr<hwinfo::NetworkEnumerator> networks;
+  // strings of the current item
+  std::vector<char> buffer;
+};
+
+C_Iterator* hwinfo_iter_open(uint32_t component, uint32_t fields) {
+  try {
+    auto it = std::make_unique<C_Iterator>();
+    if (component == C_SNAPSHOT_DISK) {
+      const auto mask = static_cast<hwinfo::DiskFields>(fields & static_cast<uint32_t>(hwinfo::DiskFields::All));
+      it->disks = std::make_unique<hwinfo::DiskEnumerator>(mask);
+    } else if (component == C_SNAPSHOT_NETWORK) {
+      const auto mask = static_cast<hwinfo::NetworkFields>(fields & static_cast<uint32_t>(hwinfo::NetworkFields::All));
+      it->networks = std::make_unique<hwinfo::NetworkEnumerator>(mask);
+    } else {
+      return nullptr;
     }
+    return it.release();
+  } catch (...) {
+    return nullptr;
+  }
 }
 
-void free_int64_array(C_Int64Array* arr) {
-    if (arr) {
-        delete[] arr->values;
-        delete arr;
+int hwinfo_iter_next(C_Iterator* it, void* out) {
+  if (!it || !out) return -1;
+  try {
+    Arena arena;
+    if (it->disks) {
+      const std::optional<hwinfo::Disk> disk = it->disks->next();
+      if (!disk) return 0;
+      reserve(arena, *disk);
+      arena.allocate(it->buffer);
+      convert(arena, *disk, *static_cast<C_Disk*>(out));
+    } else {
+      const std::optional<hwinfo::Network> network = it->networks->next();
+      if (!network) return 0;
+      reserve(arena, *network);
+      arena.allocate(it->buffer);
+      convert(arena, *network, *static_cast<C_Network*>(out));
     }
+    return 1;
+  } catch (...) {
+    return -1;
+  }
 }
 
+void hwinfo_iter_close(C_Iterator* it) { delete it; }
 
-// OS
-C_OS* get_os_info() {
-  hwinfo::OS os;
-  C_OS* c_os = new C_OS();
-  c_os->name = copy_string(os.name());
-  c_os->version = copy_string(os.version());
-  c_os->kernel = copy_string(os.kernel());
-  c_os->is32bit = os.is32bit();
-  c_os->is64bit = os.is64bit();
-  c_os->isLittleEndian = os.isLittleEndian();
-  return c_os;
+// System Snapshot
+C_SystemSnapshot* get_system_snapshot(uint32_t flags) { return to_snapshot(read_system(flags), flags); }
+
+int get_system_snapshot_async(uint32_t flags, int64_t timeout_ms, C_SnapshotCallback callback, void* user_data) {
+  if (!callback) {
+    return -1;
+  }
+  try {
+    hwinfo::collectAllAsync(
+        static_cast<hwinfo::Component>(flags & C_SNAPSHOT_ALL),
+        [flags, callback, user_data](std::optional<hwinfo::SystemInfo> info, std::exception_ptr /*error*/) {
+          C_SystemSnapshot* snapshot = nullptr;
+          if (info) {
+            try {
+              snapshot = to_snapshot(to_values(std::move(*info)), flags);
+            } catch (...) {
+            }
+          }
+          callback(snapshot, user_data);
+        },
+        std::chrono::milliseconds(std::max<int64_t>(timeout_ms, 0)));
+    return 0;
+  } catch (...) {
+    return -1;
+  }
+}
+
+void free_system_snapshot(C_SystemSnapshot* snapshot) {
+  // everything lives in the block starting at snapshot
+  std::free(snapshot);
 }
 
-void free_os_info(C_OS* os) {
-  if (os) {
-    delete[] os->name;
-    delete[] os->version;
-    delete[] os->kernel;
-    delete os;
+// Sampler
+struct C_Sampler {
+  hwinfo::Sampler sampler;
+
+  C_Sampler(std::chrono::nanoseconds interval, size_t capacity) : sampler(interval, capacity) {}
+  C_Sampler(std::chrono::nanoseconds interval, size_t capacity, const std::string& name)
+      : sampler(interval, capacity, name) {}
+};
+
+// frames are moved directly into the caller's C_MetricFrame array
+static_assert(std::is_trivially_copyable<hwinfo::MetricFrame>::value, "MetricFrame must be trivially copyable");
+static_assert(sizeof(C_MetricFrame) == sizeof(hwinfo::MetricFrame), "C_MetricFrame does not match MetricFrame");
+static_assert(offsetof(C_MetricFrame, period_ns) == offsetof(hwinfo::MetricFrame, period_ns), "layout mismatch");
+static_assert(offsetof(C_MetricFrame, battery_energy_now) == offsetof(hwinfo::MetricFrame, battery_energy_now),
+              "layout mismatch");
+static_assert(offsetof(C_MetricFrame, num_threads) == offsetof(hwinfo::MetricFrame, num_threads), "layout mismatch");
+static_assert(offsetof(C_MetricFrame, num_disks) == offsetof(hwinfo::MetricFrame, num_disks), "layout mismatch");
+static_assert(std::is_trivially_copyable<hwinfo::DiskIOStats>::value, "DiskIOStats must be trivially copyable");
+static_assert(sizeof(C_DiskIOStats) == sizeof(hwinfo::DiskIOStats), "C_DiskIOStats does not match DiskIOStats");
+static_assert(offsetof(C_DiskIOStats, utilization) == offsetof(hwinfo::DiskIOStats, utilisation), "layout mismatch");
+static_assert(offsetof(C_DiskIOStats, in_flight) == offsetof(hwinfo::DiskIOStats, in_flight), "layout mismatch");
+static_assert(offsetof(C_MetricFrame, num_networks) == offsetof(hwinfo::MetricFrame, num_networks), "layout mismatch");
+static_assert(std::is_trivially_copyable<hwinfo::NetworkIOStats>::value, "NetworkIOStats must be trivially copyable");
+static_assert(sizeof(C_NetworkIOStats) == sizeof(hwinfo::NetworkIOStats), "C_NetworkIOStats does not match");
+static_assert(offsetof(C_NetworkIOStats, tx_drops_per_s) == offsetof(hwinfo::NetworkIOStats, tx_drops_per_s),
+              "layout mismatch");
+static_assert(offsetof(C_MetricFrame, num_gpus) == offsetof(hwinfo::MetricFrame, num_gpus), "layout mismatch");
+static_assert(std::is_trivially_copyable<hwinfo::GPUStats>::value, "GPUStats must be trivially copyable");
+static_assert(sizeof(C_GPUStats) == sizeof(hwinfo::GPUStats), "C_GPUStats does not match GPUStats");
+static_assert(offsetof(C_GPUStats, utilization) == offsetof(hwinfo::GPUStats, utilisation), "layout mismatch");
+static_assert(offsetof(C_GPUStats, temperature_C) == offsetof(hwinfo::GPUStats, temperature_C), "layout mismatch");
+
+C_Sampler* get_sampler(int64_t interval_ns, int capacity) {
+  if (interval_ns <= 0 || capacity <= 0) {
+    return nullptr;
+  }
+  try {
+    return new C_Sampler(std::chrono::nanoseconds(interval_ns), static_cast<size_t>(capacity));
+  } catch (...) {
+    // e.g. the sampler thread could not be started: exceptions must not cross the C boundary
+    return nullptr;
   }
 }
 
-// GPU
-static std::vector<hwinfo::GPU> gpus;
+int get_sampler_num_threads(const C_Sampler* sampler) { return sampler ? sampler->sampler.num_threads() : -1; }
+
+uint64_t get_sampler_dropped(const C_Sampler* sampler) { return sampler ? sampler->sampler.dropped() : 0; }
+
+int get_sampler_num_disks(const C_Sampler* sampler) { return sampler ? sampler->sampler.num_disks() : -1; }
 
-int get_gpu_count() {
-  if (gpus.empty()) {
-    gpus = hwinfo::getAllGPUs();
+C_StringArray* get_sampler_disk_names(const C_Sampler* sampler) {
+  if (!sampler) {
+    return nullptr;
+  }
+  const auto& names = sampler->sampler.disk_names();
+  Arena arena;
+  arena.reserve<C_StringArray>();
+  arena.reserve(names);
+  if (!arena.allocate()) {
+    return nullptr;
   }
-  return static_cast<int>(gpus.size());
+  auto* result = arena.alloc<C_StringArray>();
+  *result = arena.copy(names);
+  return result;
 }
 
-C_GPU* get_all_gpus() {
-  if (gpus.empty()) {
-    gpus = hwinfo::getAllGPUs();
+int get_sampler_num_networks(const C_Sampler* sampler) { return sampler ? sampler->sampler.num_networks() : -1; }
+
+int get_sampler_network_indices(const C_Sampler* sampler, int* indices, int max_indices) {
+  if (!sampler || (!indices && max_indices > 0)) {
+    return -1;
   }
-  if (gpus.empty()) {
+  const auto& network_indices = sampler->sampler.network_indices();
+  std::copy_n(network_indices.begin(), std::min<size_t>(network_indices.size(), std::max(max_indices, 0)), indices);
+  return static_cast<int>(network_indices.size());
+}
+
+int get_sampler_num_gpus(const C_Sampler* sampler) { return sampler ? sampler->sampler.num_gpus() : -1; }
+
+C_StringArray* get_sampler_gpu_bus_ids(const C_Sampler* sampler) {
+  if (!sampler) {
     return nullptr;
   }
-  C_GPU* c_gpus = new C_GPU[gpus.size()];
-  for (size_t i = 0; i < gpus.size(); ++i) {
-    c_gpus[i].id = gpus[i].id();
-    c_gpus[i].vendor = copy_string(gpus[i].vendor());
-    c_gpus[i].name = copy_string(gpus[i].name());
-    c_gpus[i].driverVersion = copy_string(gpus[i].driverVersion());
-    c_gpus[i].memory_Bytes = gpus[i].memory_Bytes();
-    c_gpus[i].frequency_MHz = gpus[i].frequency_MHz();
-    c_gpus[i].num_cores = gpus[i].num_cores();
-    c_gpus[i].vendor_id = copy_string(gpus[i].vendor_id());
-    c_gpus[i].device_id = copy_string(gpus[i].device_id());
+  const auto& ids = sampler->sampler.gpu_pci_bus_ids();
+  Arena arena;
+  arena.reserve<C_StringArray>();
+  arena.reserve(ids);
+  if (!arena.allocate()) {
+    return nullptr;
   }
-  return c_gpus;
+  auto* result = arena.alloc<C_StringArray>();
+  *result = arena.copy(ids);
+  return result;
 }
 
-void free_gpu_info(C_GPU* c_gpus, int count) {
-  if (c_gpus) {
-    for (int i = 0; i < count; ++i) {
-      delete[] c_gpus[i].vendor;
-      delete[] c_gpus[i].name;
-      delete[] c_gpus[i].driverVersion;
-      delete[] c_gpus[i].vendor_id;
-      delete[] c_gpus[i].device_id;
-    }
-    delete[] c_gpus;
+int get_sampler_frames(C_Sampler* sampler, C_MetricFrame* frames, int max_frames, double* thread_utilizations,
+                       int64_t* thread_speeds_mhz, C_DiskIOStats* disk_stats, C_NetworkIOStats* network_stats,
+                       C_GPUStats* gpu_stats) {
+  if (!sampler || !frames || max_frames < 0) {
+    return -1;
   }
+  return static_cast<int>(sampler->sampler.drain(reinterpret_cast<hwinfo::MetricFrame*>(frames),
+                                                 static_cast<size_t>(max_frames), thread_utilizations,
+                                                 thread_speeds_mhz,
+                                                 reinterpret_cast<hwinfo::DiskIOStats*>(disk_stats),
+                                                 reinterpret_cast<hwinfo::NetworkIOStats*>(network_stats),
+                                                 reinterpret_cast<hwinfo::GPUStats*>(gpu_stats)));
 }
 
-// Memory
-C_MemoryInfo* get_memory_info() {
-  hwinfo::Memory mem;
-  C_MemoryInfo* c_mem = new C_MemoryInfo();
-  c_mem->total_Bytes = mem.total_Bytes();
-  c_mem->free_Bytes = mem.free_Bytes();
-  c_mem->available_Bytes = mem.available_Bytes();
-  const auto& modules = mem.modules();
-  c_mem->module_count = static_cast<int>(modules.size());
-  c_mem->modules = new C_RAM_Module[modules.size()];
-  for (size_t i = 0; i < modules.size(); ++i) {
-      c_mem->modules[i].id = modules[i].id;
-      c_mem->modules[i].vendor = copy_string(modules[i].vendor);
-      c_mem->modules[i].name = copy_string(modules[i].name);
-      c_mem->modules[i].model = copy_string(modules[i].model);
-      c_mem->modules[i].serial_number = copy_string(modules[i].serial_number);
-      c_mem->modules[i].total_Bytes = modules[i].total_Bytes;
-      c_mem->modules[i].frequency_Hz = modules[i].frequency_Hz;
-  }
-  return c_mem;
-}
-
-void free_memory_info(C_MemoryInfo* memory_info) {
-    if (memory_info) {
-        for (int i = 0; i < memory_info->module_count; ++i) {
-            delete[] memory_info->modules[i].vendor;
-            delete[] memory_info->modules[i].name;
-            delete[] memory_info->modules[i].model;
-            delete[] memory_info->modules[i].serial_number;
-        }
-        delete[] memory_info->modules;
-        delete memory_info;
-    }
+void free_sampler(C_Sampler* sampler) { delete sampler; }
+
+// Shared Frames
+struct C_SharedFrameReader {
+  hwinfo::SharedFrameReader reader;
+
+  explicit C_SharedFrameReader(const std::string& name) : reader(name) {}
+};
+
+C_Sampler* get_publishing_sampler(int64_t interval_ns, int capacity, const char* name) {
+  if (interval_ns <= 0 || capacity <= 0 || !name) {
+    return nullptr;
+  }
+  try {
+    std::unique_ptr<C_Sampler> sampler(
+        new C_Sampler(std::chrono::nanoseconds(interval_ns), static_cast<size_t>(capacity), name));
+    return sampler->sampler.publishing() ? sampler.release() : nullptr;
+  } catch (...) {
+    return nullptr;
+  }
 }
 
-// Mainboard
-C_MainBoard* get_mainboard_info() {
-  hwinfo::MainBoard mb;
-  C_MainBoard* c_mb = new C_MainBoard();
-  c_mb->vendor = copy_string(mb.vendor());
-  c_mb->name = copy_string(mb.name());
-  c_mb->version = copy_string(mb.version());
-  c_mb->serialNumber = copy_string(mb.serialNumber());
-  return c_mb;
+C_SharedFrameReader* get_shared_frame_reader(const char* name) {
+  if (!name) {
+    return nullptr;
+  }
+  try {
+    std::unique_ptr<C_SharedFrameReader> reader(new C_SharedFrameReader(name));
+    return reader->reader.valid() ? reader.release() : nullptr;
+  } catch (...) {
+    return nullptr;
+  }
 }
 
-void free_mainboard_info(C_MainBoard* mainboard) {
-  if (mainboard) {
-    delete[] mainboard->vendor;
-    delete[] mainboard->name;
-    delete[] mainboard->version;
-    delete[] mainboard->serialNumber;
-    delete mainboard;
+int get_shared_frame_num_threads(const C_SharedFrameReader* reader) {
+  return reader ? reader->reader.num_threads() : -1;
+}
+
+int get_shared_frame_num_disks(const C_SharedFrameReader* reader) { return reader ? reader->reader.num_disks() : -1; }
+
+C_StringArray* get_shared_frame_disk_names(const C_SharedFrameReader* reader) {
+  if (!reader) {
+    return nullptr;
   }
+  const auto& names = reader->reader.disk_names();
+  Arena arena;
+  arena.reserve<C_StringArray>();
+  arena.reserve(names);
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_StringArray>();
+  *result = arena.copy(names);
+  return result;
 }
 
-// Disk
-static std::vector<hwinfo::Disk> disks;
+int get_shared_frame_num_networks(const C_SharedFrameReader* reader) {
+  return reader ? reader->reader.num_networks() : -1;
+}
 
-int get_disk_count() {
-    if (disks.empty()) {
-        disks = hwinfo::getAllDisks();
-    }
-    return static_cast<int>(disks.size());
+int get_shared_frame_network_indices(const C_SharedFrameReader* reader, int* indices, int max_indices) {
+  if (!reader || (!indices && max_indices > 0)) {
+    return -1;
+  }
+  const auto& network_indices = reader->reader.network_indices();
+  std::copy_n(network_indices.begin(), std::min<size_t>(network_indices.size(), std::max(max_indices, 0)), indices);
+  return static_cast<int>(network_indices.size());
 }
 
-C_Disk* get_all_disks() {
-    if (disks.empty()) {
-        disks = hwinfo::getAllDisks();
-    }
-    if (disks.empty()) {
-        return nullptr;
-    }
-    C_Disk* c_disks = new C_Disk[disks.size()];
-    for (size_t i = 0; i < disks.size(); ++i) {
-        c_disks[i].id = disks[i].id();
-        c_disks[i].vendor = copy_string(disks[i].vendor());
-        c_disks[i].model = copy_string(disks[i].model());
-        c_disks[i].serialNumber = copy_string(disks[i].serialNumber());
-        c_disks[i].size_Bytes = disks[i].size_Bytes();
-        c_disks[i].free_size_Bytes = disks[i].free_size_Bytes();
-        const auto& volumes = disks[i].volumes();
-        c_disks[i].volumes.count = static_cast<int>(volumes.size());
-        c_disks[i].volumes.strings = new char*[volumes.size()];
-        for(size_t j = 0; j < volumes.size(); ++j) {
-            c_disks[i].volumes.strings[j] = copy_string(volumes[j]);
-        }
-    }
-    return c_disks;
+int get_shared_frame_num_gpus(const C_SharedFrameReader* reader) { return reader ? reader->reader.num_gpus() : -1; }
+
+C_StringArray* get_shared_frame_gpu_bus_ids(const C_SharedFrameReader* reader) {
+  if (!reader) {
+    return nullptr;
+  }
+  const auto& ids = reader->reader.gpu_pci_bus_ids();
+  Arena arena;
+  arena.reserve<C_StringArray>();
+  arena.reserve(ids);
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_StringArray>();
+  *result = arena.copy(ids);
+  return result;
 }
 
-void free_disk_info(C_Disk* c_disks, int count) {
-    if (c_disks) {
-        for(int i = 0; i < count; ++i) {
-            delete[] c_disks[i].vendor;
-            delete[] c_disks[i].model;
-            delete[] c_disks[i].serialNumber;
-            for (int j = 0; j < c_disks[i].volumes.count; ++j) {
-                delete[] c_disks[i].volumes.strings[j];
-            }
-            delete[] c_disks[i].volumes.strings;
-        }
-        delete[] c_disks;
-    }
+uint64_t get_shared_frame_published(const C_SharedFrameReader* reader) {
+  return reader ? reader->reader.published() : 0;
 }
 
-// Battery
-static std::vector<hwinfo::Battery> batteries;
+int get_shared_frame(const C_SharedFrameReader* reader, C_MetricFrame* frame, double* thread_utilizations,
+                     int64_t* thread_speeds_mhz, C_DiskIOStats* disk_stats, C_NetworkIOStats* network_stats,
+                     C_GPUStats* gpu_stats) {
+  if (!reader || !frame) {
+    return -1;
+  }
+  if (reader->reader.read(*reinterpret_cast<hwinfo::MetricFrame*>(frame), thread_utilizations, thread_speeds_mhz,
+                          reinterpret_cast<hwinfo::DiskIOStats*>(disk_stats),
+                          reinterpret_cast<hwinfo::NetworkIOStats*>(network_stats),
+                          reinterpret_cast<hwinfo::GPUStats*>(gpu_stats))) {
+    return 1;
+  }
+  return reader->reader.closed() ? -1 : 0;
+}
 
-int get_battery_count() {
-    if (batteries.empty()) {
-        batteries = hwinfo::getAllBatteries();
-    }
-    return static_cast<int>(batteries.size());
+void free_shared_frame_reader(C_SharedFrameReader* reader) { delete reader; }
+
+// Thread Metrics
+C_ThreadMetrics* get_thread_metrics() {
+  // reused by subsequent calls of this thread: the columns only have to be copied
+  thread_local hwinfo::ThreadMetrics metrics;
+  if (!metrics.update()) {
+    return nullptr;
+  }
+  const size_t n = metrics.size();
+  constexpr size_t alignment = 64;
+
+  Arena arena;
+  arena.reserve<C_ThreadMetrics>();
+  for (int i = 0; i < 6; ++i) {
+    // every column is padded separately
+    arena.reserve<int64_t, alignment>(n);
+  }
+  arena.reserve<int32_t, alignment>(n);
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_ThreadMetrics>();
+  result->count = static_cast<int>(n);
+  result->num_nodes = metrics.num_nodes();
+  result->timestamp_ns = metrics.timestamp_ns();
+  auto column = [&arena, n](const int64_t* values) {
+    int64_t* dst = arena.alloc<int64_t, alignment>(n);
+    std::copy(values, values + n, dst);
+    return dst;
+  };
+  result->user = column(metrics.user());
+  result->system = column(metrics.system());
+  result->idle = column(metrics.idle());
+  result->iowait = column(metrics.iowait());
+  result->irq = column(metrics.irq());
+  result->frequency_MHz = column(metrics.frequency_MHz());
+  result->node = arena.alloc<int32_t, alignment>(n);
+  std::copy(metrics.node(), metrics.node() + n, result->node);
+  return result;
 }
 
-C_Battery* get_all_batteries() {
-    if (batteries.empty()) {
-        batteries = hwinfo::getAllBatteries();
-    }
-    if (batteries.empty()) {
-        return nullptr;
-    }
-    C_Battery* c_batteries = new C_Battery[batteries.size()];
-    for(size_t i = 0; i < batteries.size(); ++i) {
-        c_batteries[i].vendor = copy_string(batteries[i].getVendor());
-        c_batteries[i].model = copy_string(batteries[i].getModel());
-        c_batteries[i].serialNumber = copy_string(batteries[i].getSerialNumber());
-        c_batteries[i].technology = copy_string(batteries[i].getTechnology());
-        c_batteries[i].energyFull = batteries[i].getEnergyFull();
-        c_batteries[i].energyNow = batteries[i].energyNow();
-        c_batteries[i].charging = batteries[i].charging();
-    }
-    return c_batteries;
-}
-
-void free_battery_info(C_Battery* c_batteries, int count) {
-    if (c_batteries) {
-        for (int i = 0; i < count; ++i) {
-            delete[] c_batteries[i].vendor;
-            delete[] c_batteries[i].model;
-            delete[] c_batteries[i].serialNumber;
-            delete[] c_batteries[i].technology;
-        }
-        delete[] c_batteries;
+void free_thread_metrics(C_ThreadMetrics* metrics) { std::free(metrics); }
+
+// CPU Times
+// the rates are copied as a whole between the C and the C++ struct
+static_assert(sizeof(C_CpuTimeRates) == sizeof(hwinfo::CpuTimeRates), "C_CpuTimeRates does not match");
+static_assert(offsetof(C_CpuTimeRates, guest) == offsetof(hwinfo::CpuTimeRates, guest), "layout mismatch");
+
+int get_cpu_times_into(C_CpuTimes* total, C_CpuTimes* out, int capacity) {
+  if (!out && capacity > 0) return -1;
+  // reused by subsequent calls of this thread
+  thread_local std::vector<hwinfo::CpuTimes> threads;
+  hwinfo::CpuTimes total_times;
+  if (!hwinfo::readCpuTimes(total_times, threads)) {
+    return -1;
+  }
+  if (total) convert(total_times, *total);
+  const size_t n = std::min(threads.size(), static_cast<size_t>(std::max(capacity, 0)));
+  for (size_t i = 0; i < n; ++i) {
+    convert(threads[i], out[i]);
+  }
+  return static_cast<int>(threads.size());
+}
+
+int get_cpu_time_rates_into(const C_CpuTimes* previous, const C_CpuTimes* current, int count,
+                            C_CpuTimeRates* out) {
+  if (!current || !out || count < 0) return -1;
+  for (int i = 0; i < count; ++i) {
+    const hwinfo::CpuTimes start = previous ? to_cpu_times(previous[i]) : hwinfo::CpuTimes();
+    const hwinfo::CpuTimeRates rates = hwinfo::cpuTimeRates(start, to_cpu_times(current[i]));
+    std::memcpy(out + i, &rates, sizeof(rates));
+  }
+  return count;
+}
+
+// Topology
+C_Topology* get_topology() {
+  const hwinfo::Topology& topology = hwinfo::Topology::get();
+  if (topology.empty()) {
+    return nullptr;
+  }
+  const size_t n = topology.size();
+
+  Arena arena;
+  arena.reserve<C_Topology>();
+  for (int i = 0; i < 5; ++i) {
+    arena.reserve<int32_t>(n);
+  }
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_Topology>();
+  result->count = static_cast<int>(n);
+  result->num_sockets = topology.num_sockets();
+  result->num_cores = topology.num_cores();
+  result->num_cache_domains = topology.num_cache_domains();
+  result->num_nodes = topology.num_nodes();
+  auto column = [&arena, n](const int32_t* values) {
+    int32_t* dst = arena.alloc<int32_t>(n);
+    std::copy(values, values + n, dst);
+    return dst;
+  };
+  result->core = column(topology.core());
+  result->cache_domain = column(topology.cache_domain());
+  result->node = column(topology.node());
+  result->socket = column(topology.socket());
+  result->efficiency_class = column(topology.efficiency_class());
+  return result;
+}
+
+void free_topology(C_Topology* topology) { std::free(topology); }
+
+// Device Monitor
+struct C_DeviceMonitor {
+  hwinfo::DeviceMonitor monitor;
+};
+
+struct C_DeviceWatcher {
+  hwinfo::DeviceWatcher watcher;
+
+  C_DeviceWatcher(C_DeviceChangeCallback callback, void* user_data)
+      : watcher([callback, user_data](hwinfo::Component changed) {
+          // invalidated before the callback runs, so that it can re-enumerate right away
+          invalidate_caches(changed);
+          callback(static_cast<uint32_t>(changed), user_data);
+        }) {}
+};
+
+C_DeviceMonitor* get_device_monitor() {
+  try {
+    auto* monitor = new C_DeviceMonitor();
+    if (!monitor->monitor.valid()) {
+      delete monitor;
+      return nullptr;
     }
+    return monitor;
+  } catch (...) {
+    return nullptr;
+  }
 }
 
+int get_device_monitor_fd(const C_DeviceMonitor* monitor) { return monitor ? monitor->monitor.fd() : -1; }
 
-// Network
-static std::vector<hwinfo::Network> networks;
-int get_network_count() {
-    if (networks.empty()) {
-        networks = hwinfo::getAllNetworks();
+uint32_t get_device_changes(C_DeviceMonitor* monitor, int timeout_ms) {
+  if (!monitor) {
+    return 0;
+  }
+  const hwinfo::Component changed = monitor->monitor.wait(std::chrono::milliseconds(timeout_ms));
+  invalidate_caches(changed);
+  return static_cast<uint32_t>(changed);
+}
+
+void free_device_monitor(C_DeviceMonitor* monitor) { delete monitor; }
+
+C_DeviceWatcher* get_device_watcher(C_DeviceChangeCallback callback, void* user_data) {
+  if (!callback) {
+    return nullptr;
+  }
+  try {
+    auto* watcher = new C_DeviceWatcher(callback, user_data);
+    if (!watcher->watcher.valid()) {
+      delete watcher;
+      return nullptr;
     }
-    return static_cast<int>(networks.size());
+    return watcher;
+  } catch (...) {
+    // e.g. the thread could not be started: exceptions must not cross the C boundary
+    return nullptr;
+  }
+}
+
+void free_device_watcher(C_DeviceWatcher* watcher) { delete watcher; }
+
+// Sensors
+struct C_SensorSampler {
+  hwinfo::SensorSampler sampler;
+};
+
+static_assert(static_cast<int>(hwinfo::SensorKind::Temperature) == C_SENSOR_TEMPERATURE, "kind mismatch");
+static_assert(static_cast<int>(hwinfo::SensorKind::Power) == C_SENSOR_POWER, "kind mismatch");
+static_assert(static_cast<int>(hwinfo::SensorKind::Fan) == C_SENSOR_FAN, "kind mismatch");
+static_assert(static_cast<int>(hwinfo::SensorKind::Voltage) == C_SENSOR_VOLTAGE, "kind mismatch");
+
+C_SensorSampler* get_sensor_sampler() {
+  try {
+    return new C_SensorSampler();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+int get_sensor_count(const C_SensorSampler* sampler) {
+  return sampler ? static_cast<int>(sampler->sampler.size()) : -1;
+}
+
+C_SensorArray* get_sensors(const C_SensorSampler* sampler) {
+  if (!sampler) {
+    return nullptr;
+  }
+  const auto& sensors = sampler->sampler.sensors();
+  Arena arena;
+  arena.reserve<C_SensorArray>();
+  arena.reserve<C_Sensor>(sensors.size());
+  for (const auto& sensor : sensors) {
+    arena.reserve(sensor.chip);
+    arena.reserve(sensor.label);
+  }
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_SensorArray>();
+  result->count = static_cast<int>(sensors.size());
+  result->sensors = arena.alloc<C_Sensor>(sensors.size());
+  for (size_t i = 0; i < sensors.size(); ++i) {
+    C_Sensor& out = result->sensors[i];
+    out.kind = static_cast<int32_t>(sensors[i].kind);
+    out.socket = sensors[i].socket;
+    out.chip = arena.copy(sensors[i].chip);
+    out.label = arena.copy(sensors[i].label);
+  }
+  return result;
+}
+
+void free_sensor_array(C_SensorArray* sensors) { std::free(sensors); }
+
+int get_sensor_values(C_SensorSampler* sampler, double* values, int capacity) {
+  if (!sampler || capacity < 0 || (capacity > 0 && !values)) {
+    return -1;
+  }
+  auto& sensors = sampler->sampler;
+  const auto count = static_cast<int>(sensors.size());
+  if (capacity == 0) {
+    return count;
+  }
+  sensors.update();
+  std::copy_n(sensors.values(), std::min(count, capacity), values);
+  return count;
+}
+
+void free_sensor_sampler(C_SensorSampler* sampler) { delete sampler; }
+
+// Cgroup
+C_Cgroup* get_cgroup() {
+  const hwinfo::Cgroup& cgroup = hwinfo::Cgroup::get();
+  if (!cgroup.available()) {
+    return nullptr;
+  }
+  const std::vector<int> cpus = cgroup.effective_cpus();
+  Arena arena;
+  arena.reserve<C_Cgroup>();
+  arena.reserve<int32_t>(cpus.size());
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_Cgroup>();
+  result->version = cgroup.version();
+  result->cpu_quota = cgroup.cpu_quota();
+  result->effective_cpu_count = cgroup.effective_cpu_count();
+  result->memory_max_Bytes = cgroup.memory_max_Bytes();
+  result->memory_current_Bytes = cgroup.memory_current_Bytes();
+  result->cpu_usage_ns = cgroup.cpu_usage_ns();
+  result->num_cpus = static_cast<int>(cpus.size());
+  result->cpus = arena.alloc<int32_t>(cpus.size());
+  std::copy(cpus.begin(), cpus.end(), result->cpus);
+  return result;
+}
+
+void free_cgroup(C_Cgroup* cgroup) { std::free(cgroup); }
+
+void hwinfo_set_cgroup_limits(int enabled) { hwinfo::Cgroup::set_apply_limits(enabled != 0); }
+
+// Processes
+struct C_ProcessSampler {
+  hwinfo::ProcessSampler sampler;
+};
+
+C_ProcessSampler* get_process_sampler(const int64_t* pids, int count) {
+  if (count < 0 || (count > 0 && !pids)) {
+    return nullptr;
+  }
+  try {
+    return new C_ProcessSampler{hwinfo::ProcessSampler(std::vector<int64_t>(pids, pids + count))};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+int get_process_count(const C_ProcessSampler* sampler) {
+  return sampler ? static_cast<int>(sampler->sampler.size()) : -1;
+}
+
+int get_process_stats(C_ProcessSampler* sampler, double* cpu_utilisation, int64_t* rss_Bytes,
+                      double* read_Bytes_per_s, double* written_Bytes_per_s, int capacity) {
+  if (!sampler || capacity < 0) {
+    return -1;
+  }
+  auto& processes = sampler->sampler;
+  const auto count = static_cast<int>(processes.size());
+  if (capacity == 0) {
+    return count;
+  }
+  processes.update();
+  const int n = std::min(count, capacity);
+  if (cpu_utilisation) {
+    std::copy_n(processes.cpu_utilisation(), n, cpu_utilisation);
+  }
+  if (rss_Bytes) {
+    std::copy_n(processes.rss_Bytes(), n, rss_Bytes);
+  }
+  if (read_Bytes_per_s) {
+    std::copy_n(processes.read_Bytes_per_s(), n, read_Bytes_per_s);
+  }
+  if (written_Bytes_per_s) {
+    std::copy_n(processes.written_Bytes_per_s(), n, written_Bytes_per_s);
+  }
+  return count;
 }
 
-C_Network* get_all_networks() {
-    if (networks.empty()) {
-        networks = hwinfo::getAllNetworks();
+void free_process_sampler(C_ProcessSampler* sampler) { delete sampler; }
+
+// Pressure
+static_assert(sizeof(C_PressureStats) == sizeof(hwinfo::PressureStats), "C_PressureStats does not match");
+static_assert(offsetof(C_PressureStats, full) == offsetof(hwinfo::PressureStats, full), "layout mismatch");
+static_assert(offsetof(C_PressureLine, total_us) == offsetof(hwinfo::PressureLine, total_us), "layout mismatch");
+
+struct C_PressureTrigger {
+  hwinfo::PressureTrigger trigger;
+};
+
+int get_pressure_into(int resource, int cgroup, C_PressureStats* out) {
+  if (!out || resource < C_PRESSURE_CPU || resource > C_PRESSURE_IO) return -1;
+  // opened once per resource and kept open, read() is thread-safe
+  static const auto* const files = [] {
+    auto* pressures = new std::vector<hwinfo::Pressure>();
+    for (int r = C_PRESSURE_CPU; r <= C_PRESSURE_IO; ++r) {
+      pressures->emplace_back(static_cast<hwinfo::PressureResource>(r));
+      pressures->push_back(hwinfo::Pressure::cgroup(static_cast<hwinfo::PressureResource>(r)));
     }
-    if (networks.empty()) {
-        return nullptr;
+    return pressures;
+  }();
+  hwinfo::PressureStats stats;
+  if (!(*files)[resource * 2 + (cgroup ? 1 : 0)].read(stats)) {
+    return -1;
+  }
+  std::memcpy(out, &stats, sizeof(stats));
+  return 0;
+}
+
+C_PressureTrigger* get_pressure_trigger(int resource, int cgroup, int full, int64_t stall_us,
+                                        int64_t window_us) {
+  if (resource < C_PRESSURE_CPU || resource > C_PRESSURE_IO) {
+    return nullptr;
+  }
+  const auto r = static_cast<hwinfo::PressureResource>(resource);
+  const auto kind = full ? hwinfo::PressureTrigger::Kind::Full : hwinfo::PressureTrigger::Kind::Some;
+  const std::chrono::microseconds stall(stall_us);
+  const std::chrono::microseconds window(window_us);
+  try {
+    auto* trigger = new C_PressureTrigger{cgroup ? hwinfo::PressureTrigger::cgroup(r, kind, stall, window)
+                                                 : hwinfo::PressureTrigger(r, kind, stall, window)};
+    if (!trigger->trigger.valid()) {
+      delete trigger;
+      return nullptr;
     }
-    C_Network* c_networks = new C_Network[networks.size()];
-    for (size_t i = 0; i < networks.size(); ++i) {
-        c_networks[i].interfaceIndex = copy_string(networks[i].interfaceIndex());
-        c_networks[i].description = copy_string(networks[i].description());
-        c_networks[i].mac = copy_string(networks[i].mac());
-        c_networks[i].ip4 = copy_string(networks[i].ip4());
-        c_networks[i].ip6 = copy_string(networks[i].ip6());
+    return trigger;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+int get_pressure_trigger_fd(const C_PressureTrigger* trigger) { return trigger ? trigger->trigger.fd() : -1; }
+
+int get_pressure_event(C_PressureTrigger* trigger, int timeout_ms) {
+  if (!trigger) return -1;
+  return trigger->trigger.wait(std::chrono::milliseconds(timeout_ms)) ? 1 : 0;
+}
+
+void hwinfo_interrupt_pressure_trigger(C_PressureTrigger* trigger) {
+  if (trigger) trigger->trigger.interrupt();
+}
+
+void free_pressure_trigger(C_PressureTrigger* trigger) { delete trigger; }
+
+// Interrupts
+struct C_InterruptSampler {
+  hwinfo::InterruptSampler sampler;
+};
+
+C_InterruptSampler* get_interrupt_sampler() {
+  try {
+    return new C_InterruptSampler();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+int get_interrupt_update(C_InterruptSampler* sampler) {
+  if (!sampler || !sampler->sampler.update()) return -1;
+  return sampler->sampler.layout_changed() ? 1 : 0;
+}
+
+int get_interrupt_num_cpus(const C_InterruptSampler* sampler) {
+  return sampler ? static_cast<int>(sampler->sampler.num_cpus()) : -1;
+}
+
+C_InterruptLineArray* get_interrupt_lines(const C_InterruptSampler* sampler) {
+  if (!sampler || sampler->sampler.size() == 0) {
+    return nullptr;
+  }
+  const auto& lines = sampler->sampler.lines();
+  Arena arena;
+  arena.reserve<C_InterruptLineArray>();
+  arena.reserve<C_InterruptLine>(lines.size());
+  for (const auto& line : lines) {
+    arena.reserve(line.name);
+    arena.reserve(line.description);
+    arena.reserve(line.devices);
+  }
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_InterruptLineArray>();
+  result->count = static_cast<int>(lines.size());
+  result->lines = arena.alloc<C_InterruptLine>(lines.size());
+  for (size_t i = 0; i < lines.size(); ++i) {
+    C_InterruptLine& out = result->lines[i];
+    out.irq = lines[i].irq;
+    out.owner = static_cast<int32_t>(lines[i].owner);
+    out.name = arena.copy(lines[i].name);
+    out.description = arena.copy(lines[i].description);
+    out.devices = arena.copy(lines[i].devices);
+  }
+  return result;
+}
+
+void free_interrupt_line_array(C_InterruptLineArray* lines) { std::free(lines); }
+
+C_StringArray* get_softirq_names(const C_InterruptSampler* sampler) {
+  if (!sampler) {
+    return nullptr;
+  }
+  const auto& names = sampler->sampler.softirq_names();
+  Arena arena;
+  arena.reserve<C_StringArray>();
+  arena.reserve(names);
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_StringArray>();
+  *result = arena.copy(names);
+  return result;
+}
+
+int get_interrupt_deltas(const C_InterruptSampler* sampler, int64_t* out, int capacity) {
+  if (!sampler || capacity < 0 || (!out && capacity > 0)) return -1;
+  const size_t size = sampler->sampler.size() * sampler->sampler.num_cpus();
+  std::copy_n(sampler->sampler.deltas(), std::min(size, static_cast<size_t>(capacity)), out);
+  return static_cast<int>(size);
+}
+
+int get_softirq_deltas(const C_InterruptSampler* sampler, int64_t* out, int capacity) {
+  if (!sampler || capacity < 0 || (!out && capacity > 0)) return -1;
+  const size_t size = sampler->sampler.softirq_names().size() * sampler->sampler.num_cpus();
+  std::copy_n(sampler->sampler.softirq_deltas(), std::min(size, static_cast<size_t>(capacity)), out);
+  return static_cast<int>(size);
+}
+
+void free_interrupt_sampler(C_InterruptSampler* sampler) { delete sampler; }
+
+// NVMe
+struct C_NvmeSampler {
+  explicit C_NvmeSampler(int64_t refresh_ms) : sampler(std::chrono::milliseconds(refresh_ms)) {}
+
+  hwinfo::NvmeSampler sampler;
+};
+
+// the logs are copied into the caller's C_NvmeHealth array
+static_assert(std::is_trivially_copyable<hwinfo::NvmeHealth>::value, "NvmeHealth must be trivially copyable");
+static_assert(sizeof(C_NvmeHealth) == sizeof(hwinfo::NvmeHealth), "C_NvmeHealth does not match NvmeHealth");
+static_assert(offsetof(C_NvmeHealth, temperature_C) == offsetof(hwinfo::NvmeHealth, temperature_C), "layout mismatch");
+static_assert(offsetof(C_NvmeHealth, timestamp_ns) == offsetof(hwinfo::NvmeHealth, timestamp_ns), "layout mismatch");
+
+C_NvmeSampler* get_nvme_sampler(int64_t refresh_ms) {
+  try {
+    return new C_NvmeSampler(std::max<int64_t>(refresh_ms, 0));
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void hwinfo_set_nvme_refresh(C_NvmeSampler* sampler, int64_t refresh_ms) {
+  if (sampler) sampler->sampler.set_refresh(std::chrono::milliseconds(std::max<int64_t>(refresh_ms, 0)));
+}
+
+int get_nvme_count(const C_NvmeSampler* sampler) { return sampler ? static_cast<int>(sampler->sampler.size()) : -1; }
+
+C_NvmeControllerArray* get_nvme_controllers(const C_NvmeSampler* sampler) {
+  if (!sampler) {
+    return nullptr;
+  }
+  const auto& controllers = sampler->sampler.controllers();
+  Arena arena;
+  arena.reserve<C_NvmeControllerArray>();
+  arena.reserve<C_NvmeController>(controllers.size());
+  for (const auto& controller : controllers) {
+    arena.reserve(controller.name);
+    arena.reserve(controller.vendor);
+    arena.reserve(controller.model);
+    arena.reserve(controller.serial_number);
+    arena.reserve(controller.firmware_version);
+    arena.reserve(controller.namespaces);
+  }
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_NvmeControllerArray>();
+  result->count = static_cast<int>(controllers.size());
+  result->controllers = arena.alloc<C_NvmeController>(controllers.size());
+  for (size_t i = 0; i < controllers.size(); ++i) {
+    C_NvmeController& out = result->controllers[i];
+    out.name = arena.copy(controllers[i].name);
+    out.vendor = arena.copy(controllers[i].vendor);
+    out.model = arena.copy(controllers[i].model);
+    out.serial_number = arena.copy(controllers[i].serial_number);
+    out.firmware_version = arena.copy(controllers[i].firmware_version);
+    out.total_capacity_Bytes = controllers[i].total_capacity_Bytes;
+    out.unallocated_capacity_Bytes = controllers[i].unallocated_capacity_Bytes;
+    out.namespaces = arena.copy(controllers[i].namespaces);
+    out.identified = controllers[i].identified ? 1 : 0;
+  }
+  return result;
+}
+
+void free_nvme_controller_array(C_NvmeControllerArray* controllers) { std::free(controllers); }
+
+int get_nvme_health(C_NvmeSampler* sampler, C_NvmeHealth* out, int capacity) {
+  if (!sampler || capacity < 0 || (capacity > 0 && !out)) {
+    return -1;
+  }
+  auto& nvme = sampler->sampler;
+  const auto count = static_cast<int>(nvme.size());
+  if (capacity == 0) {
+    return count;
+  }
+  nvme.update();
+  std::copy_n(reinterpret_cast<const C_NvmeHealth*>(nvme.health()), std::min(count, capacity), out);
+  return count;
+}
+
+void free_nvme_sampler(C_NvmeSampler* sampler) { delete sampler; }
+
+// Filesystem root
+int hwinfo_set_root(const char* path) {
+#ifdef HWINFO_UNIX
+  if (!path) {
+    return -1;
+  }
+  try {
+    if (!hwinfo::filesystem::set_root(path)) {
+      return -1;
     }
-    return c_networks;
-}
-
-void free_network_info(C_Network* c_networks, int count) {
-    if (c_networks) {
-        for (int i = 0; i < count; ++i) {
-            delete[] c_networks[i].interfaceIndex;
-            delete[] c_networks[i].description;
-            delete[] c_networks[i].mac;
-            delete[] c_networks[i].ip4;
-            delete[] c_networks[i].ip6;
-        }
-        delete[] c_networks;
+  } catch (...) {
+    return -1;
+  }
+  invalidate_caches(hwinfo::Component::All);
+  return 0;
+#else
+  (void)path;
+  return -1;
+#endif
+}
+
+// Static Cache
+int hwinfo_enable_static_cache(const char* directory) {
+  try {
+    return hwinfo::static_cache::enable(directory ? directory : "") ? 0 : -1;
+  } catch (...) {
+    return -1;
+  }
+}
+
+void hwinfo_disable_static_cache() { hwinfo::static_cache::disable(); }
+
+void hwinfo_clear_static_cache() { hwinfo::static_cache::clear(); }
+
+// Collector Stats
+C_CollectorStatsArray* get_collector_stats() {
+  if (!hwinfo::stats_enabled()) {
+    return nullptr;
+  }
+  const std::vector<hwinfo::CollectorStats> stats = hwinfo::stats();
+  Arena arena;
+  arena.reserve<C_CollectorStatsArray>();
+  arena.reserve<C_CollectorStats>(stats.size());
+  for (const auto& entry : stats) {
+    arena.reserve(entry.name);
+  }
+  if (!arena.allocate()) {
+    return nullptr;
+  }
+  auto* result = arena.alloc<C_CollectorStatsArray>();
+  result->count = static_cast<int>(stats.size());
+  result->collectors = arena.alloc<C_CollectorStats>(stats.size());
+  for (size_t i = 0; i < stats.size(); ++i) {
+    C_CollectorStats& out = result->collectors[i];
+    out.name = arena.copy(stats[i].name);
+    out.calls = static_cast<int64_t>(stats[i].calls);
+    out.wall_ns = static_cast<int64_t>(stats[i].wall_ns);
+    out.files_opened = static_cast<int64_t>(stats[i].files_opened);
+    out.bytes_read = static_cast<int64_t>(stats[i].bytes_read);
+    out.wmi_queries = static_cast<int64_t>(stats[i].wmi_queries);
+    out.allocations = static_cast<int64_t>(stats[i].allocations);
+  }
+  return result;
+}
+
+void free_collector_stats(C_CollectorStatsArray* stats) { std::free(stats); }
+
+void hwinfo_reset_stats() { hwinfo::reset_stats(); }
+
+int hwinfo_start_trace(const char* path) { return path && hwinfo::start_trace(path) ? 0 : -1; }
+
+int hwinfo_stop_trace() { return hwinfo::stop_trace() ? 0 : -1; }
+
+// Inventory
+C_Bytes* get_inventory(uint32_t flags) {
+  try {
+    return to_bytes(hwinfo::inventory::serialize(collect_system(flags)));
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+C_Bytes* get_inventory_delta(const uint8_t* base, int64_t base_size, const uint8_t* inventory, int64_t size) {
+  try {
+    return to_bytes(hwinfo::inventory::delta(as_view(base, base_size), as_view(inventory, size)));
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+C_Bytes* get_inventory_from_delta(const uint8_t* base, int64_t base_size, const uint8_t* delta, int64_t delta_size) {
+  try {
+    std::string inventory;
+    if (!hwinfo::inventory::apply_delta(as_view(base, base_size), as_view(delta, delta_size), inventory)) {
+      return nullptr;
     }
+    return to_bytes(inventory);
+  } catch (...) {
+    return nullptr;
+  }
 }
 
+void free_bytes(C_Bytes* bytes) { std::free(bytes); }
+
+// Component Cache
+void hwinfo_invalidate(uint32_t components) { invalidate_caches(static_cast<hwinfo::Component>(components)); }
+
+void hwinfo_set_ttl(uint32_t components, int64_t ttl_ms) {
+  for_each_cache(components, [ttl_ms](auto& cache) { cache.set_ttl(ttl_ms); });
+}
+
+#ifdef HWINFO_WINDOWS
+void hwinfo_set_wmi_timeout(int64_t timeout_ms, int64_t poll_interval_ms) {
+  auto options = hwinfo::utils::WMI::default_options();
+  if (timeout_ms > 0) options.timeout = std::chrono::milliseconds(timeout_ms);
+  if (poll_interval_ms > 0) options.poll_interval = std::chrono::milliseconds(poll_interval_ms);
+  hwinfo::utils::WMI::set_default_options(options);
+}
+#else
+void hwinfo_set_wmi_timeout(int64_t /*timeout_ms*/, int64_t /*poll_interval_ms*/) {}
+#endif
 
-}  // extern "C"
\ No newline at end of file
+}  // extern "C"
@@ -0,0 +1,83 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/interned_string.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// Append-only storage of the interned strings: chunks of entries {uint32_t length, characters, '\0'}, each entry
+// aligned to 4 bytes for the length of the next one. Chunks are never moved or freed, so views into them stay valid.
+class Pool {
+ public:
+  const char* intern(std::string_view value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _strings.find(value);
+    if (it != _strings.end()) {
+      return it->data();
+    }
+    const size_t bytes = (sizeof(uint32_t) + value.size() + 1 + 3) & ~size_t{3};
+    if (_chunks.empty() || _used + bytes > _chunk_size) {
+      // strings longer than a chunk get a chunk of their own
+      _chunk_size = std::max(kChunkSize, bytes);
+      _chunks.push_back(std::make_unique<char[]>(_chunk_size));
+      _used = 0;
+      _total += _chunk_size;
+    }
+    char* entry = _chunks.back().get() + _used;
+    _used += bytes;
+    const auto length = static_cast<uint32_t>(value.size());
+    std::memcpy(entry, &length, sizeof(length));
+    char* data = entry + sizeof(length);
+    std::memcpy(data, value.data(), value.size());
+    data[value.size()] = '\0';
+    _strings.emplace(data, value.size());
+    return data;
+  }
+
+  InternStats stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return {_strings.size(), _total};
+  }
+
+ private:
+  static constexpr size_t kChunkSize = 16 * 1024;
+
+  std::mutex _mutex;
+  std::unordered_set<std::string_view> _strings;
+  std::vector<std::unique_ptr<char[]>> _chunks;
+  size_t _chunk_size{0};
+  size_t _used{0};
+  size_t _total{0};
+};
+
+// _____________________________________________________________________________________________________________________
+// Never destroyed: handles in static objects may be used during static destruction.
+Pool& pool() {
+  static Pool* const instance = new Pool();
+  return *instance;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+InternedString::InternedString(std::string_view value) : _data(value.empty() ? nullptr : pool().intern(value)) {}
+
+// _____________________________________________________________________________________________________________________
+std::ostream& operator<<(std::ostream& out, InternedString value) { return out << value.view(); }
+
+// _____________________________________________________________________________________________________________________
+InternStats intern_stats() { return pool().stats(); }
+
+}  // namespace hwinfo
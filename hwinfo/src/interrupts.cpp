@@ -0,0 +1,85 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/interrupts.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+void computeDeltas(const std::vector<int64_t>& previous, const std::vector<int64_t>& current,
+                   std::vector<int64_t>& deltas, bool has_baseline) {
+  deltas.resize(current.size());
+  if (!has_baseline || previous.size() != current.size()) {
+    std::fill(deltas.begin(), deltas.end(), -1);
+    return;
+  }
+  constexpr int64_t wrap = int64_t{1} << 32;
+  for (size_t i = 0; i < current.size(); ++i) {
+    if (previous[i] < 0 || current[i] < 0) {
+      deltas[i] = -1;
+    } else if (current[i] >= previous[i]) {
+      deltas[i] = current[i] - previous[i];
+    } else {
+      // the per-cpu counters are unsigned int in the kernel and wrap around
+      deltas[i] = previous[i] < wrap ? current[i] + wrap - previous[i] : -1;
+    }
+  }
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+bool InterruptSampler::update() {
+  HWINFO_TRACE_SCOPE(Interrupts);
+  // the previous counters become the buffers of this read
+  _previous.swap(_counts);
+  _softirq_previous.swap(_softirq_counts);
+  _layout_changed = false;
+  const bool success = read_counters();
+  _timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+  const bool has_baseline = success && _has_baseline && !_layout_changed;
+  computeDeltas(_previous, _counts, _deltas, has_baseline);
+  computeDeltas(_softirq_previous, _softirq_counts, _softirq_deltas, has_baseline);
+  _has_baseline = success;
+  return success;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<size_t> InterruptSampler::lines_of(const std::string& device) const {
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < _lines.size(); ++i) {
+    const auto& devices = _lines[i].devices;
+    if (std::find(devices.begin(), devices.end(), device) != devices.end()) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+#ifndef HWINFO_UNIX
+struct InterruptSampler::Source {};
+
+// _____________________________________________________________________________________________________________________
+InterruptSampler::InterruptSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+InterruptSampler::~InterruptSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool InterruptSampler::read_counters() {
+  _counts.clear();
+  _softirq_counts.clear();
+  return false;
+}
+#endif  // HWINFO_UNIX
+
+}  // namespace hwinfo
@@ -0,0 +1,725 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/hwinfo.h>
+#include <hwinfo/inventory.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+namespace inventory {
+
+namespace {
+
+constexpr char kMagic[4] = {'H', 'W', 'I', 'V'};
+constexpr size_t kHeaderSize = 20;
+constexpr uint8_t kKindInventory = 0;
+constexpr uint8_t kKindDelta = 1;
+
+// delta operations
+constexpr uint64_t kCopyRecords = 0;
+constexpr uint64_t kPatchRecord = 1;
+constexpr uint64_t kNewRecord = 2;
+
+// _____________________________________________________________________________________________________________________
+void put_u32(std::string& out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void put_u64(std::string& out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void put_varint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// _____________________________________________________________________________________________________________________
+uint64_t get_le(const char* data, int num_bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < num_bytes; ++i) {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+  }
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+uint64_t zigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+
+// _____________________________________________________________________________________________________________________
+int64_t unzigzag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+// _____________________________________________________________________________________________________________________
+uint64_t fnv1a(std::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : data) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Bounds checked decoding of a buffer.
+struct Cursor {
+  std::string_view data;
+  size_t pos;
+
+  bool varint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+      const auto byte = static_cast<unsigned char>(data[pos++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool varint32(uint32_t& value) {
+    uint64_t wide;
+    if (!varint(wide) || wide > UINT32_MAX) {
+      return false;
+    }
+    value = static_cast<uint32_t>(wide);
+    return true;
+  }
+
+  bool fixed(uint64_t& value, int num_bytes) {
+    if (data.size() - pos < static_cast<size_t>(num_bytes)) {
+      return false;
+    }
+    value = get_le(data.data() + pos, num_bytes);
+    pos += static_cast<size_t>(num_bytes);
+    return true;
+  }
+};
+
+// String table of an inventory or delta: index -> view into the encoded data.
+struct StringTable {
+  uint32_t count{0};
+  const char* ends{nullptr};
+  const char* data{nullptr};
+
+  // Parses the table at cursor.pos and checks that the offsets are ascending and within the data.
+  bool parse(Cursor& cursor) {
+    uint64_t num;
+    if (!cursor.fixed(num, 4) || (cursor.data.size() - cursor.pos) / 4 < num) {
+      return false;
+    }
+    count = static_cast<uint32_t>(num);
+    ends = cursor.data.data() + cursor.pos;
+    cursor.pos += 4 * static_cast<size_t>(count);
+    data = cursor.data.data() + cursor.pos;
+    uint64_t previous = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+      const uint64_t end = get_le(ends + 4 * static_cast<size_t>(i), 4);
+      if (end < previous || end > cursor.data.size() - cursor.pos) {
+        return false;
+      }
+      previous = end;
+    }
+    cursor.pos += static_cast<size_t>(previous);
+    return true;
+  }
+
+  std::string_view get(uint32_t index) const {
+    if (index >= count) {
+      return {};
+    }
+    const uint64_t begin = index == 0 ? 0 : get_le(ends + 4 * static_cast<size_t>(index - 1), 4);
+    const uint64_t end = get_le(ends + 4 * static_cast<size_t>(index), 4);
+    return {data + begin, static_cast<size_t>(end - begin)};
+  }
+};
+
+// Distinct strings in order of their first use, numbered from first_index.
+class StringInterner {
+ public:
+  explicit StringInterner(uint32_t first_index = 0) : _first_index(first_index) {}
+
+  uint32_t add(std::string_view string) {
+    const auto it = _index.find(string);
+    if (it != _index.end()) {
+      return it->second;
+    }
+    const auto index = _first_index + static_cast<uint32_t>(_strings.size());
+    _strings.push_back(string);
+    _index.emplace(string, index);
+    return index;
+  }
+
+  void write(std::string& out) const {
+    put_u32(out, static_cast<uint32_t>(_strings.size()));
+    uint32_t end = 0;
+    for (std::string_view string : _strings) {
+      end += static_cast<uint32_t>(string.size());
+      put_u32(out, end);
+    }
+    for (std::string_view string : _strings) {
+      out.append(string.data(), string.size());
+    }
+  }
+
+ private:
+  uint32_t _first_index;
+  std::vector<std::string_view> _strings;
+  std::unordered_map<std::string_view, uint32_t> _index;
+};
+
+// _____________________________________________________________________________________________________________________
+template <typename Intern>
+void put_value(std::string& out, const Value& value, Intern& intern) {
+  out.push_back(static_cast<char>(value.type));
+  switch (value.type) {
+    case ValueType::Int:
+      put_varint(out, zigzag(value.integer));
+      break;
+    case ValueType::Double: {
+      uint64_t bits;
+      std::memcpy(&bits, &value.real, sizeof(bits));
+      put_u64(out, bits);
+      break;
+    }
+    case ValueType::String:
+    case ValueType::Strings:
+      put_varint(out, intern(value.string));
+      break;
+    case ValueType::Null:
+      break;
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Intern>
+void put_record(std::string& out, const Record& record, Intern& intern) {
+  put_varint(out, static_cast<uint64_t>(record.type));
+  put_varint(out, record.fields.size());
+  for (const Value& value : record.fields) {
+    put_value(out, value, intern);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+// Reads a value whose strings are resolved by lookup(index, view), which returns false for unknown indices.
+template <typename Lookup>
+bool read_value(Cursor& cursor, const Lookup& lookup, FieldView& field) {
+  uint64_t tag;
+  if (!cursor.fixed(tag, 1)) {
+    return false;
+  }
+  field = FieldView();
+  field.type = static_cast<ValueType>(tag);
+  switch (field.type) {
+    case ValueType::Null:
+      return true;
+    case ValueType::Int: {
+      uint64_t raw;
+      if (!cursor.varint(raw)) {
+        return false;
+      }
+      field.integer = unzigzag(raw);
+      return true;
+    }
+    case ValueType::Double: {
+      uint64_t bits;
+      if (!cursor.fixed(bits, 8)) {
+        return false;
+      }
+      std::memcpy(&field.real, &bits, sizeof(bits));
+      return true;
+    }
+    case ValueType::String:
+    case ValueType::Strings: {
+      uint32_t index;
+      return cursor.varint32(index) && lookup(index, field.string);
+    }
+  }
+  // value types of a newer version cannot be skipped
+  return false;
+}
+
+// _____________________________________________________________________________________________________________________
+Value to_value(const FieldView& field) {
+  Value value;
+  value.type = field.type;
+  value.integer = field.integer;
+  value.real = field.real;
+  value.string.assign(field.string.data(), field.string.size());
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+// Writes the header in front of body (which starts with kHeaderSize placeholder bytes).
+void finish(std::string& out, uint8_t kind, uint64_t hash) {
+  std::string header(kMagic, sizeof(kMagic));
+  header.push_back(static_cast<char>(kVersion));
+  header.push_back(static_cast<char>(kind));
+  header.append(2, '\0');
+  put_u32(header, static_cast<uint32_t>(out.size()));
+  put_u64(header, hash);
+  out.replace(0, kHeaderSize, header);
+}
+
+// _____________________________________________________________________________________________________________________
+// Checks the header of data and returns its body and hash.
+bool parse_header(std::string_view data, uint8_t kind, std::string_view& body, uint64_t& hash) {
+  if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+      static_cast<uint8_t>(data[4]) != kVersion || static_cast<uint8_t>(data[5]) != kind || data[6] != 0 ||
+      data[7] != 0) {
+    return false;
+  }
+  const uint64_t size = get_le(data.data() + 8, 4);
+  if (size < kHeaderSize || size > data.size()) {
+    return false;
+  }
+  hash = get_le(data.data() + 12, 8);
+  body = data.substr(kHeaderSize, static_cast<size_t>(size) - kHeaderSize);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+Value int_value(int64_t integer) {
+  Value value;
+  value.type = ValueType::Int;
+  value.integer = integer;
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+Value string_value(std::string_view string) {
+  Value value;
+  value.type = ValueType::String;
+  value.string.assign(string);
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+Value strings_value(const std::vector<std::string>& strings) {
+  Value value;
+  value.type = ValueType::Strings;
+  for (const std::string& string : strings) {
+    value.string += string;
+    value.string.push_back('\0');
+  }
+  return value;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+bool Value::operator==(const Value& other) const {
+  if (type != other.type) {
+    return false;
+  }
+  switch (type) {
+    case ValueType::Int:
+      return integer == other.integer;
+    case ValueType::Double:
+      // bitwise, so that NaN equals itself and the delta stays empty
+      return std::memcmp(&real, &other.real, sizeof(real)) == 0;
+    case ValueType::String:
+    case ValueType::Strings:
+      return string == other.string;
+    case ValueType::Null:
+      break;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<Record> records(const SystemInfo& info) {
+  std::vector<Record> result;
+  for (const CPU& cpu : info.cpus) {
+    result.push_back({RecordType::CPU,
+                      {int_value(cpu.id()), string_value(cpu.vendor()), string_value(cpu.modelName()),
+                       int_value(cpu.numPhysicalCores()), int_value(cpu.numLogicalCores()),
+                       int_value(cpu.maxClockSpeed_MHz()), int_value(cpu.regularClockSpeed_MHz()),
+                       int_value(cpu.L1CacheSize_Bytes()), int_value(cpu.L2CacheSize_Bytes()),
+                       int_value(cpu.L3CacheSize_Bytes()), strings_value(cpu.flags())}});
+    for (uint64_t word : cpu.features().words()) {
+      result.back().fields.push_back(int_value(static_cast<int64_t>(word)));
+    }
+  }
+  if (info.os) {
+    const OS& os = *info.os;
+    result.push_back({RecordType::OS,
+                      {string_value(os.name()), string_value(os.version()), string_value(os.kernel()),
+                       int_value(os.is32bit()), int_value(os.is64bit()), int_value(os.isLittleEndian())}});
+  }
+  for (const GPU& gpu : info.gpus) {
+    result.push_back({RecordType::GPU,
+                      {int_value(gpu.id()), string_value(gpu.vendor()), string_value(gpu.name()),
+                       string_value(gpu.driverVersion()), int_value(gpu.memory_Bytes()), int_value(gpu.frequency_MHz()),
+                       int_value(gpu.num_cores()), string_value(gpu.vendor_id()), string_value(gpu.device_id()),
+                       string_value(gpu.pciBusId())}});
+  }
+  if (info.memory) {
+    const Memory& memory = *info.memory;
+    const MemorySnapshot snapshot = memory.snapshot();
+    result.push_back({RecordType::Memory,
+                      {int_value(memory.total_Bytes()), int_value(snapshot.free_Bytes),
+                       int_value(snapshot.available_Bytes)}});
+    for (const Memory::Module& module : memory.modules()) {
+      result.push_back({RecordType::MemoryModule,
+                        {int_value(module.id), string_value(module.vendor), string_value(module.name),
+                         string_value(module.model), string_value(module.serial_number), int_value(module.total_Bytes),
+                         int_value(module.frequency_Hz)}});
+    }
+  }
+  if (info.mainboard) {
+    const MainBoard& mainboard = *info.mainboard;
+    result.push_back({RecordType::MainBoard,
+                      {string_value(mainboard.vendor()), string_value(mainboard.name()),
+                       string_value(mainboard.version()), string_value(mainboard.serialNumber())}});
+  }
+  for (const Disk& disk : info.disks) {
+    result.push_back({RecordType::Disk,
+                      {int_value(disk.id()), string_value(disk.vendor()), string_value(disk.model()),
+                       string_value(disk.serialNumber()), int_value(disk.size_Bytes()),
+                       int_value(disk.free_size_Bytes()), strings_value(disk.volumes())}});
+  }
+  for (size_t i = 0; i < info.batteries.size(); ++i) {
+    const Battery& battery = info.batteries[i];
+    const BatteryStatus status = battery.status();
+    result.push_back({RecordType::Battery,
+                      {int_value(static_cast<int64_t>(i)), string_value(battery.getVendor()),
+                       string_value(battery.getModel()), string_value(battery.getSerialNumber()),
+                       string_value(battery.getTechnology()), int_value(battery.getEnergyFull()),
+                       int_value(status.energyNow), int_value(status.charging), int_value(status.powerNow),
+                       int_value(status.voltageNow), int_value(status.capacity), int_value(status.cycleCount)}});
+  }
+  for (const Network& network : info.networks) {
+    result.push_back({RecordType::Network,
+                      {string_value(network.interfaceIndex()), string_value(network.description()),
+                       string_value(network.mac()), string_value(network.ip4()), string_value(network.ip6()),
+                       strings_value(network.ip4s()), strings_value(network.ip6s())}});
+  }
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+std::string serialize(const std::vector<Record>& records) {
+  StringInterner strings;
+  auto intern = [&strings](std::string_view string) { return strings.add(string); };
+  std::string encoded;
+  put_varint(encoded, records.size());
+  for (const Record& record : records) {
+    put_record(encoded, record, intern);
+  }
+  std::string out(kHeaderSize, '\0');
+  strings.write(out);
+  out += encoded;
+  finish(out, kKindInventory, fnv1a(std::string_view(out).substr(kHeaderSize)));
+  return out;
+}
+
+// _____________________________________________________________________________________________________________________
+std::string serialize(const SystemInfo& info) { return serialize(records(info)); }
+
+// _____________________________________________________________________________________________________________________
+bool deserialize(std::string_view data, std::vector<Record>& records) {
+  Reader reader(data);
+  records.clear();
+  records.reserve(reader.num_records());
+  Record record;
+  uint32_t num_fields;
+  while (reader.next(record.type, num_fields)) {
+    record.fields.clear();
+    FieldView field;
+    while (reader.field(field)) {
+      record.fields.push_back(to_value(field));
+    }
+    records.push_back(std::move(record));
+  }
+  return reader.valid() && records.size() == reader.num_records();
+}
+
+// _____________________________________________________________________________________________________________________
+std::string delta(std::string_view base, std::string_view inventory) {
+  std::vector<Record> base_records;
+  std::vector<Record> records;
+  if (!deserialize(base, base_records) || !deserialize(inventory, records)) {
+    return {};
+  }
+  // strings of the base are referenced by their index, new ones are added behind them
+  const Reader base_reader(base);
+  std::unordered_map<std::string_view, uint32_t> base_strings;
+  for (uint32_t i = 0; i < base_reader.num_strings(); ++i) {
+    base_strings.emplace(base_reader.string(i), i);
+  }
+  StringInterner added(base_reader.num_strings());
+  auto intern = [&](std::string_view string) {
+    const auto it = base_strings.find(string);
+    return it != base_strings.end() ? it->second : added.add(string);
+  };
+
+  std::string operations;
+  put_varint(operations, records.size());
+  size_t i = 0;
+  while (i < records.size()) {
+    size_t unchanged = 0;
+    while (i + unchanged < records.size() && i + unchanged < base_records.size() &&
+           records[i + unchanged].type == base_records[i + unchanged].type &&
+           records[i + unchanged].fields == base_records[i + unchanged].fields) {
+      ++unchanged;
+    }
+    if (unchanged > 0) {
+      put_varint(operations, kCopyRecords);
+      put_varint(operations, unchanged);
+      i += unchanged;
+      continue;
+    }
+    const Record& record = records[i];
+    if (i < base_records.size() && base_records[i].type == record.type) {
+      const std::vector<Value>& base_fields = base_records[i].fields;
+      put_varint(operations, kPatchRecord);
+      put_varint(operations, record.fields.size());
+      size_t f = 0;
+      while (f < record.fields.size()) {
+        size_t same = 0;
+        while (f + same < record.fields.size() && f + same < base_fields.size() &&
+               record.fields[f + same] == base_fields[f + same]) {
+          ++same;
+        }
+        put_varint(operations, same);
+        f += same;
+        if (f < record.fields.size()) {
+          put_value(operations, record.fields[f], intern);
+          ++f;
+        }
+      }
+    } else {
+      put_varint(operations, kNewRecord);
+      put_record(operations, record, intern);
+    }
+    ++i;
+  }
+
+  std::string_view base_body;
+  uint64_t base_hash;
+  parse_header(base, kKindInventory, base_body, base_hash);
+  const std::string canonical = serialize(records);
+  std::string out(kHeaderSize, '\0');
+  put_u64(out, fnv1a(std::string_view(canonical).substr(kHeaderSize)));
+  added.write(out);
+  out += operations;
+  finish(out, kKindDelta, fnv1a(base_body));
+  return out;
+}
+
+// _____________________________________________________________________________________________________________________
+bool apply_delta(std::string_view base, std::string_view delta, std::string& inventory) {
+  std::vector<Record> base_records;
+  std::string_view base_body;
+  std::string_view body;
+  uint64_t hash;
+  uint64_t base_hash;
+  if (!deserialize(base, base_records) || !parse_header(base, kKindInventory, base_body, hash) ||
+      !parse_header(delta, kKindDelta, body, base_hash) || base_hash != fnv1a(base_body)) {
+    return false;
+  }
+  const Reader base_reader(base);
+  Cursor cursor{body, 0};
+  uint64_t target_hash;
+  StringTable added;
+  if (!cursor.fixed(target_hash, 8) || !added.parse(cursor)) {
+    return false;
+  }
+  const uint32_t num_base_strings = base_reader.num_strings();
+  auto lookup = [&](uint32_t index, std::string_view& string) {
+    if (index < num_base_strings) {
+      string = base_reader.string(index);
+      return true;
+    }
+    if (index - num_base_strings < added.count) {
+      string = added.get(index - num_base_strings);
+      return true;
+    }
+    return false;
+  };
+  auto read = [&](Value& value) {
+    FieldView field;
+    if (!read_value(cursor, lookup, field)) {
+      return false;
+    }
+    value = to_value(field);
+    return true;
+  };
+
+  uint32_t num_records;
+  if (!cursor.varint32(num_records)) {
+    return false;
+  }
+  std::vector<Record> records;
+  records.reserve(num_records);
+  while (records.size() < num_records) {
+    const size_t i = records.size();
+    uint64_t operation;
+    if (!cursor.varint(operation)) {
+      return false;
+    }
+    if (operation == kCopyRecords) {
+      uint64_t count;
+      if (!cursor.varint(count) || count == 0 || count > num_records - i || i > base_records.size() ||
+          count > base_records.size() - i) {
+        return false;
+      }
+      records.insert(records.end(), base_records.begin() + static_cast<ptrdiff_t>(i),
+                     base_records.begin() + static_cast<ptrdiff_t>(i + count));
+    } else if (operation == kPatchRecord) {
+      uint32_t num_fields;
+      if (i >= base_records.size() || !cursor.varint32(num_fields)) {
+        return false;
+      }
+      const Record& base_record = base_records[i];
+      Record record{base_record.type, {}};
+      record.fields.reserve(num_fields);
+      while (record.fields.size() < num_fields) {
+        uint64_t same;
+        const size_t f = record.fields.size();
+        if (!cursor.varint(same) || same > num_fields - f ||
+            f + same > std::max(f, base_record.fields.size())) {
+          return false;
+        }
+        record.fields.insert(record.fields.end(), base_record.fields.begin() + static_cast<ptrdiff_t>(f),
+                             base_record.fields.begin() + static_cast<ptrdiff_t>(f + same));
+        if (record.fields.size() < num_fields) {
+          Value value;
+          if (!read(value)) {
+            return false;
+          }
+          record.fields.push_back(std::move(value));
+        }
+      }
+      records.push_back(std::move(record));
+    } else if (operation == kNewRecord) {
+      uint64_t type;
+      uint32_t num_fields;
+      if (!cursor.varint(type) || type > UINT8_MAX || !cursor.varint32(num_fields)) {
+        return false;
+      }
+      Record record{static_cast<RecordType>(type), {}};
+      for (uint32_t f = 0; f < num_fields; ++f) {
+        Value value;
+        if (!read(value)) {
+          return false;
+        }
+        record.fields.push_back(std::move(value));
+      }
+      records.push_back(std::move(record));
+    } else {
+      return false;
+    }
+  }
+  inventory = serialize(records);
+  return fnv1a(std::string_view(inventory).substr(kHeaderSize)) == target_hash;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<std::string_view> split(std::string_view strings) {
+  std::vector<std::string_view> items;
+  size_t begin = 0;
+  while (begin < strings.size()) {
+    const size_t end = strings.find('\0', begin);
+    if (end == std::string_view::npos) {
+      items.push_back(strings.substr(begin));
+      break;
+    }
+    items.push_back(strings.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  return items;
+}
+
+// =====================================================================================================================
+// _____________________________________________________________________________________________________________________
+Reader::Reader(std::string_view data) {
+  std::string_view body;
+  uint64_t hash;
+  if (!parse_header(data, kKindInventory, body, hash) || fnv1a(body) != hash) {
+    return;
+  }
+  _data = data.substr(0, kHeaderSize + body.size());
+  Cursor cursor{_data, kHeaderSize};
+  StringTable strings;
+  if (!strings.parse(cursor) || !cursor.varint32(_num_records)) {
+    return;
+  }
+  _num_strings = strings.count;
+  _string_ends = strings.ends;
+  _string_data = strings.data;
+  _pos = cursor.pos;
+  _valid = true;
+}
+
+// _____________________________________________________________________________________________________________________
+std::string_view Reader::string(uint32_t index) const {
+  return StringTable{_num_strings, _string_ends, _string_data}.get(index);
+}
+
+// _____________________________________________________________________________________________________________________
+bool Reader::next(RecordType& type, uint32_t& num_fields) {
+  if (!_valid || _record == _num_records || !skip_fields()) {
+    return false;
+  }
+  Cursor cursor{_data, _pos};
+  uint64_t raw_type;
+  if (!cursor.varint(raw_type) || raw_type > UINT8_MAX || !cursor.varint32(num_fields)) {
+    _valid = false;
+    return false;
+  }
+  type = static_cast<RecordType>(raw_type);
+  _fields_left = num_fields;
+  _pos = cursor.pos;
+  ++_record;
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+bool Reader::field(FieldView& field) {
+  if (!_valid || _fields_left == 0) {
+    return false;
+  }
+  Cursor cursor{_data, _pos};
+  auto lookup = [this](uint32_t index, std::string_view& string) {
+    string = this->string(index);
+    return index < _num_strings;
+  };
+  if (!read_value(cursor, lookup, field)) {
+    _valid = false;
+    return false;
+  }
+  --_fields_left;
+  _pos = cursor.pos;
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+bool Reader::skip_fields() {
+  FieldView field;
+  while (_fields_left > 0) {
+    if (!this->field(field)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace inventory
+}  // namespace hwinfo
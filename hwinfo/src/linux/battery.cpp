@@ -5,132 +5,211 @@
 
 #ifdef HWINFO_UNIX
 
-#include <fstream>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "hwinfo/battery.h"
 #include "hwinfo/utils/filesystem.h"
+#include "hwinfo/utils/parse.h"
+#include "hwinfo/utils/trace.h"
 
 namespace hwinfo {
 
-static std::string base_path = "/sys/class/power_supply/";
+namespace {
+
+const std::string base_path = "/sys/class/power_supply/";
+
+// The POWER_SUPPLY_* keys of a uevent file. Numbers are -1 and strings empty if the driver does not report them.
+struct PowerSupply {
+  std::string type;
+  std::string scope;
+  std::string status;
+  std::string technology;
+  std::string manufacturer;
+  std::string model_name;
+  std::string serial_number;
+  int64_t capacity{-1};
+  int64_t cycle_count{-1};
+  int64_t voltage_min_design{-1};
+  int64_t voltage_now{-1};
+  int64_t power_now{-1};
+  int64_t current_now{-1};
+  int64_t energy_full{-1};
+  int64_t energy_now{-1};
+  int64_t charge_full{-1};
+  int64_t charge_now{-1};
+};
 
-// =====================================================================================================================
 // _____________________________________________________________________________________________________________________
-std::string Battery::getVendor() const {
-  if (_id < 0) {
-    return "<unknown>";
-  }
-  std::ifstream vendor_file(base_path + "BAT" + std::to_string(_id) + "/" + "manufacturer");
-  std::string vendor;
-  if (vendor_file.is_open()) {
-    getline(vendor_file, vendor);
-    return vendor;
+// Parses the KEY=value lines of a power supply uevent file (one POWER_SUPPLY_ prefixed key per line).
+PowerSupply parseUevent(std::string_view content) {
+  constexpr std::string_view prefix = "POWER_SUPPLY_";
+  PowerSupply supply;
+  const char* p = content.data();
+  const char* end = p + content.size();
+  while (p < end) {
+    const char* line_end = utils::find_line_end(p, end);
+    const std::string_view line(p, static_cast<size_t>(line_end - p));
+    p = line_end + 1;
+    const size_t equals = line.find('=');
+    if (line.compare(0, prefix.size(), prefix) != 0 || equals == std::string_view::npos) continue;
+    const std::string_view key = line.substr(prefix.size(), equals - prefix.size());
+    const std::string_view value = line.substr(equals + 1);
+    if (key == "TYPE") {
+      supply.type = value;
+    } else if (key == "SCOPE") {
+      supply.scope = value;
+    } else if (key == "STATUS") {
+      supply.status = value;
+    } else if (key == "TECHNOLOGY") {
+      supply.technology = value;
+    } else if (key == "MANUFACTURER") {
+      supply.manufacturer = value;
+    } else if (key == "MODEL_NAME") {
+      supply.model_name = value;
+    } else if (key == "SERIAL_NUMBER") {
+      supply.serial_number = value;
+    } else if (key == "CAPACITY") {
+      supply.capacity = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "CYCLE_COUNT") {
+      supply.cycle_count = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "VOLTAGE_MIN_DESIGN") {
+      supply.voltage_min_design = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "VOLTAGE_NOW") {
+      supply.voltage_now = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "POWER_NOW") {
+      supply.power_now = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "CURRENT_NOW") {
+      supply.current_now = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "ENERGY_FULL") {
+      supply.energy_full = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "ENERGY_NOW") {
+      supply.energy_now = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "CHARGE_FULL") {
+      supply.charge_full = utils::parse_int_or<int64_t>(value, -1);
+    } else if (key == "CHARGE_NOW") {
+      supply.charge_now = utils::parse_int_or<int64_t>(value, -1);
+    }
   }
-  return "<unknown>";
+  return supply;
 }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getModel() const {
-  if (_id < 0) {
-    return "<unknown>";
+// Reads the uevent file of a battery: the one opened by getAllBatteries(), otherwise (Battery constructed directly)
+// the one of BAT<id>.
+PowerSupply readSupply(const filesystem::CachedFile* uevent, int id) {
+  std::string content;
+  if (uevent != nullptr) {
+    if (!uevent->read(content)) return {};
+  } else if (id < 0 || !filesystem::CachedFile(base_path + "BAT" + std::to_string(id) + "/uevent").read(content)) {
+    return {};
   }
-  std::ifstream vendor_file(base_path + "BAT" + std::to_string(_id) + "/" + "model_name");
-  std::string value;
-  if (vendor_file.is_open()) {
-    getline(vendor_file, value);
-    return value;
-  }
-  return "<unknown>";
+  return parseUevent(content);
 }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getSerialNumber() const {
-  if (_id < 0) {
-    return "<unknown>";
-  }
-  std::ifstream vendor_file(base_path + "BAT" + std::to_string(_id) + "/" + "serial_number");
-  std::string value;
-  if (vendor_file.is_open()) {
-    getline(vendor_file, value);
-    return value;
-  }
-  return "<unknown>";
+// Energy in µWh. Drivers that report the charge (µAh) instead are converted with the design voltage.
+int64_t energyOf(int64_t energy, int64_t charge, const PowerSupply& supply) {
+  if (energy >= 0) return energy;
+  if (charge < 0 || supply.voltage_min_design <= 0) return -1;
+  return charge * (supply.voltage_min_design / 1000) / 1000;
 }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getTechnology() const {
-  if (_id < 0) {
-    return "<unknown>";
-  }
-  std::ifstream vendor_file(base_path + "BAT" + std::to_string(_id) + "/" + "technology");
-  std::string value;
-  if (vendor_file.is_open()) {
-    getline(vendor_file, value);
-    return value;
-  }
-  return "<unknown>";
+uint32_t toEnergy(int64_t value) { return value < 0 ? 0 : static_cast<uint32_t>(value); }
+
+// _____________________________________________________________________________________________________________________
+std::string orUnknown(std::string value) { return value.empty() ? "<unknown>" : value; }
+
+}  // namespace
+
+// =====================================================================================================================
+// _____________________________________________________________________________________________________________________
+InternedString Battery::getVendor() const {
+  return _vendor.empty() ? orUnknown(readSupply(_uevent.get(), _id).manufacturer) : _vendor;
 }
 
 // _____________________________________________________________________________________________________________________
-uint32_t Battery::getEnergyFull() const {
-  if (_id < 0) {
-    return 0;
-  }
-  std::ifstream vendor_file(base_path + "BAT" + std::to_string(_id) + "/" + "energy_full");
-  std::string value;
-  if (vendor_file.is_open()) {
-    getline(vendor_file, value);
-    try {
-      return std::stoi(value);
-    } catch (const std::invalid_argument& e) {
-      return 0;
-    }
-  }
-  return 0;
+InternedString Battery::getModel() const {
+  return _model.empty() ? orUnknown(readSupply(_uevent.get(), _id).model_name) : _model;
 }
 
 // _____________________________________________________________________________________________________________________
-uint32_t Battery::energyNow() const {
-  if (_id < 0) {
-    return 0;
-  }
-  std::ifstream vendor_file(base_path + "BAT" + std::to_string(_id) + "/" + "energy_now");
-  std::string value;
-  if (vendor_file.is_open()) {
-    getline(vendor_file, value);
-    try {
-      return std::stoi(value);
-    } catch (const std::invalid_argument& e) {
-      return 0;
-    }
-  }
-  return 0;
+InternedString Battery::getSerialNumber() const {
+  return _serialNumber.empty() ? orUnknown(readSupply(_uevent.get(), _id).serial_number) : _serialNumber;
 }
 
 // _____________________________________________________________________________________________________________________
-bool Battery::charging() const {
-  if (_id < 0) {
-    return false;
-  }
-  std::ifstream vendor_file(base_path + "BAT" + std::to_string(_id) + "/" + "status");
-  std::string value;
-  if (vendor_file.is_open()) {
-    getline(vendor_file, value);
-    return value == "Charging";
+InternedString Battery::getTechnology() const {
+  return _technology.empty() ? orUnknown(readSupply(_uevent.get(), _id).technology) : _technology;
+}
+
+// _____________________________________________________________________________________________________________________
+uint32_t Battery::getEnergyFull() const {
+  if (_energyFull != 0) {
+    return _energyFull;
   }
-  return false;
+  const PowerSupply supply = readSupply(_uevent.get(), _id);
+  return toEnergy(energyOf(supply.energy_full, supply.charge_full, supply));
 }
 
+// _____________________________________________________________________________________________________________________
+uint32_t Battery::energyNow() const { return toEnergy(status().energyNow); }
+
+// _____________________________________________________________________________________________________________________
+bool Battery::charging() const { return status().charging; }
+
 // _____________________________________________________________________________________________________________________
 bool Battery::discharging() const { return !charging(); }
 
+// _____________________________________________________________________________________________________________________
+BatteryStatus Battery::status() const {
+  const PowerSupply supply = readSupply(_uevent.get(), _id);
+  BatteryStatus status;
+  status.energyNow = energyOf(supply.energy_now, supply.charge_now, supply);
+  status.voltageNow = supply.voltage_now;
+  status.powerNow = supply.power_now;
+  if (status.powerNow < 0 && supply.current_now >= 0 && supply.voltage_now >= 0) {
+    // mA * mV = µW
+    status.powerNow = (supply.current_now / 1000) * (supply.voltage_now / 1000);
+  }
+  status.capacity = static_cast<int>(supply.capacity);
+  status.cycleCount = supply.cycle_count;
+  status.charging = supply.status == "Charging";
+  return status;
+}
+
 // =====================================================================================================================
 // _____________________________________________________________________________________________________________________
 std::vector<Battery> getAllBatteries() {
+  HWINFO_TRACE_SCOPE(Battery);
+  std::vector<std::string> names = filesystem::getDirectoryEntries(base_path);
+  // readdir order is arbitrary
+  std::sort(names.begin(), names.end());
   std::vector<Battery> batteries;
-  int8_t id = 0;
-  while (filesystem::exists(base_path + "BAT" + std::to_string(id))) {
-    batteries.emplace_back(id++);
+  std::string content;
+  for (const auto& name : names) {
+    auto uevent = std::make_shared<filesystem::CachedFile>(base_path + name + "/uevent");
+    if (!uevent->valid() || !uevent->read(content)) continue;
+    PowerSupply supply = parseUevent(content);
+    if (supply.type.empty()) {
+      // older kernels do not list the type in uevent
+      filesystem::Directory(base_path + name).read("type", supply.type);
+    }
+    // batteries of peripherals (mice, keyboards) have device scope
+    if (supply.type != "Battery" || supply.scope == "Device") continue;
+    Battery battery(static_cast<int8_t>(batteries.size()));
+    // static values are kept, dynamic ones are read from uevent on access
+    battery._vendor = orUnknown(std::move(supply.manufacturer));
+    battery._model = orUnknown(std::move(supply.model_name));
+    battery._serialNumber = orUnknown(std::move(supply.serial_number));
+    battery._technology = orUnknown(std::move(supply.technology));
+    battery._energyFull = toEnergy(energyOf(supply.energy_full, supply.charge_full, supply));
+    battery._uevent = std::move(uevent);
+    batteries.push_back(std::move(battery));
   }
   return batteries;
 }
@@ -0,0 +1,39 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/bench.h>
+#include <sched.h>
+
+#include <cstddef>
+
+namespace hwinfo {
+namespace bench {
+
+// _____________________________________________________________________________________________________________________
+bool pinCurrentThread(int cpu) {
+  if (cpu < 0) {
+    return false;
+  }
+  // sized for the cpu: systems may have more cpus than the static cpu_set_t holds
+  const auto num_cpus = static_cast<size_t>(cpu) + 1;
+  cpu_set_t* set = CPU_ALLOC(num_cpus);
+  if (set == nullptr) {
+    return false;
+  }
+  const size_t size = CPU_ALLOC_SIZE(num_cpus);
+  CPU_ZERO_S(size, set);
+  CPU_SET_S(static_cast<size_t>(cpu), size, set);
+  // 0 is the calling thread, which is migrated before the call returns
+  const bool pinned = sched_setaffinity(0, size, set) == 0;
+  CPU_FREE(set);
+  return pinned;
+}
+
+}  // namespace bench
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
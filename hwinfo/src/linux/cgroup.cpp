@@ -0,0 +1,337 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/cgroup.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/mountinfo.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+const std::string proc_cgroup_path = "/proc/self/cgroup";
+
+// v1 memory.limit_in_bytes without a limit is PAGE_COUNTER_MAX pages, larger than any real limit
+constexpr int64_t unlimited_memory = int64_t{1} << 62;
+
+// One line of /proc/self/cgroup: "4:cpu,cpuacct:/docker/abc" (v1), "0::/user.slice/session-1.scope" (v2).
+struct Membership {
+  // empty for the unified hierarchy
+  std::string controllers;
+  std::string path;
+};
+
+// The directory of the cgroup of a controller and the mount point of its hierarchy.
+struct Hierarchy {
+  std::string directory;
+  std::string mount_point;
+  int version{0};
+};
+
+// _____________________________________________________________________________________________________________________
+bool hasController(std::string_view controllers, std::string_view controller) {
+  while (!controllers.empty()) {
+    const size_t comma = controllers.find(',');
+    if (controllers.substr(0, comma) == controller) {
+      return true;
+    }
+    controllers = comma == std::string_view::npos ? std::string_view() : controllers.substr(comma + 1);
+  }
+  return false;
+}
+
+// _____________________________________________________________________________________________________________________
+// Directory of the cgroup at path in a hierarchy mounted at mount. Containers without a cgroup namespace mount only
+// their own subtree (the mount root is the cgroup path), with a namespace the path is relative to the mount already.
+std::string cgroupDirectory(const utils::Mount& mount, const std::string& path) {
+  std::string relative = path;
+  if (mount.root != "/") {
+    const bool inside = path.compare(0, mount.root.size(), mount.root) == 0 &&
+                        (path.size() == mount.root.size() || path[mount.root.size()] == '/');
+    relative = inside ? path.substr(mount.root.size()) : std::string();
+  }
+  while (!relative.empty() && relative.back() == '/') {
+    relative.pop_back();
+  }
+  const std::string directory = mount.mount_point + relative;
+  return filesystem::exists(directory) ? directory : mount.mount_point;
+}
+
+// _____________________________________________________________________________________________________________________
+// The hierarchy of a controller: the v1 hierarchy it is bound to (identified by probe, mountinfo does not report the
+// controllers of a mount), otherwise the unified hierarchy. controller nullptr only looks for the unified one.
+Hierarchy resolve(const std::vector<Membership>& memberships, const std::vector<utils::Mount>& mounts,
+                  const char* controller, const char* probe) {
+  for (const auto& membership : memberships) {
+    if (controller == nullptr || !hasController(membership.controllers, controller)) {
+      continue;
+    }
+    for (const auto& mount : mounts) {
+      if (mount.fs_type == "cgroup" && filesystem::exists(mount.mount_point + '/' + probe)) {
+        return {cgroupDirectory(mount, membership.path), mount.mount_point, 1};
+      }
+    }
+  }
+  for (const auto& membership : memberships) {
+    if (!membership.controllers.empty()) {
+      continue;
+    }
+    for (const auto& mount : mounts) {
+      if (mount.fs_type == "cgroup2") {
+        return {cgroupDirectory(mount, membership.path), mount.mount_point, 2};
+      }
+    }
+  }
+  return {};
+}
+
+// _____________________________________________________________________________________________________________________
+// The directory and its ancestors up to the mount point of the hierarchy, the directory first.
+std::vector<std::string> ancestors(const Hierarchy& hierarchy) {
+  std::vector<std::string> directories;
+  if (hierarchy.version == 0) {
+    return directories;
+  }
+  std::string directory = hierarchy.directory;
+  directories.push_back(directory);
+  while (directory.size() > hierarchy.mount_point.size()) {
+    directory.erase(directory.rfind('/'));
+    if (directory.size() < hierarchy.mount_point.size()) {
+      break;
+    }
+    directories.push_back(directory);
+  }
+  return directories;
+}
+
+// _____________________________________________________________________________________________________________________
+// Opens the file in every directory that has it. If other is given, it must exist as well and is opened into others.
+void openAll(const std::vector<std::string>& directories, const char* name, std::vector<filesystem::CachedFile>& files,
+             const char* other = nullptr, std::vector<filesystem::CachedFile>* others = nullptr) {
+  for (const auto& directory : directories) {
+    filesystem::CachedFile file(directory + '/' + name);
+    if (!file.valid()) {
+      continue;
+    }
+    if (other != nullptr) {
+      filesystem::CachedFile second(directory + '/' + other);
+      if (!second.valid()) {
+        continue;
+      }
+      others->push_back(std::move(second));
+    }
+    files.push_back(std::move(file));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+// The first directory (the cgroup itself, then its ancestors) that has the file.
+filesystem::CachedFile openFirst(const std::vector<std::string>& directories, const char* name) {
+  for (const auto& directory : directories) {
+    filesystem::CachedFile file(directory + '/' + name);
+    if (file.valid()) {
+      return file;
+    }
+  }
+  return {};
+}
+
+}  // namespace
+
+struct Cgroup::Source {
+  // cpu.max (v2) or cpu.cfs_quota_us (v1) of the cgroup and of its ancestors
+  std::vector<filesystem::CachedFile> cpu_quota;
+  // v1: cpu.cfs_period_us next to every cpu_quota file
+  std::vector<filesystem::CachedFile> cpu_period;
+  bool cpu_v2{false};
+  // cpuset.cpus.effective (v2) or cpuset.effective_cpus (v1)
+  filesystem::CachedFile cpus;
+  // memory.max (v2) or memory.limit_in_bytes (v1) of the cgroup and of its ancestors
+  std::vector<filesystem::CachedFile> memory_max;
+  // memory.current (v2) or memory.usage_in_bytes (v1)
+  filesystem::CachedFile memory_current;
+  // cpu.stat (v2, usage_usec) or cpuacct.usage (v1, ns)
+  filesystem::CachedFile cpu_usage;
+  bool usage_v2{false};
+};
+
+// _____________________________________________________________________________________________________________________
+Cgroup::Cgroup() : _source(new Source()) {}
+
+// _____________________________________________________________________________________________________________________
+Cgroup::~Cgroup() = default;
+
+// _____________________________________________________________________________________________________________________
+Cgroup::Cgroup(Cgroup&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Cgroup& Cgroup::operator=(Cgroup&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Cgroup Cgroup::read() {
+  HWINFO_TRACE_SCOPE(Cgroup);
+  Cgroup cgroup;
+  std::vector<Membership> memberships;
+  filesystem::LineReader reader(proc_cgroup_path);
+  std::string_view line;
+  while (reader.next(line)) {
+    // "hierarchy-ID:controller-list:cgroup-path"
+    const size_t first = line.find(':');
+    const size_t second = first == std::string_view::npos ? first : line.find(':', first + 1);
+    if (second == std::string_view::npos) {
+      continue;
+    }
+    memberships.push_back(
+        {std::string(line.substr(first + 1, second - first - 1)), std::string(line.substr(second + 1))});
+  }
+  if (memberships.empty()) {
+    return cgroup;
+  }
+  utils::MountIndex mount_index;
+  mount_index.refresh();
+  const std::vector<utils::Mount>& mounts = mount_index.mounts();
+  Source& source = *cgroup._source;
+
+  const Hierarchy cpu = resolve(memberships, mounts, "cpu", "cpu.cfs_quota_us");
+  source.cpu_v2 = cpu.version == 2;
+  if (source.cpu_v2) {
+    openAll(ancestors(cpu), "cpu.max", source.cpu_quota);
+  } else {
+    openAll(ancestors(cpu), "cpu.cfs_quota_us", source.cpu_quota, "cpu.cfs_period_us", &source.cpu_period);
+  }
+
+  const Hierarchy cpuset = resolve(memberships, mounts, "cpuset", "cpuset.cpus");
+  // without the controller enabled for the cgroup, the effective cpus of the closest ancestor apply
+  source.cpus = openFirst(ancestors(cpuset), cpuset.version == 2 ? "cpuset.cpus.effective" : "cpuset.effective_cpus");
+
+  const Hierarchy memory = resolve(memberships, mounts, "memory", "memory.limit_in_bytes");
+  openAll(ancestors(memory), memory.version == 2 ? "memory.max" : "memory.limit_in_bytes", source.memory_max);
+  if (memory.version != 0) {
+    source.memory_current =
+        filesystem::CachedFile(memory.directory + (memory.version == 2 ? "/memory.current" : "/memory.usage_in_bytes"));
+  }
+
+  const Hierarchy cpuacct = resolve(memberships, mounts, "cpuacct", "cpuacct.usage");
+  if (cpuacct.version == 1) {
+    source.cpu_usage = filesystem::CachedFile(cpuacct.directory + "/cpuacct.usage");
+  } else {
+    // cpu.stat is always present in the unified hierarchy, also without the cpu controller
+    const Hierarchy unified = cpuacct.version == 2 ? cpuacct : resolve(memberships, mounts, nullptr, nullptr);
+    if (unified.version == 2) {
+      source.cpu_usage = filesystem::CachedFile(unified.directory + "/cpu.stat");
+      source.usage_v2 = true;
+    }
+  }
+
+  for (const Hierarchy* hierarchy : {&cpu, &cpuset, &memory, &cpuacct}) {
+    if (hierarchy->version != 0 && (cgroup._version == 0 || hierarchy->version < cgroup._version)) {
+      cgroup._version = hierarchy->version;
+    }
+  }
+  cgroup._cpu_path = cpu.directory;
+  cgroup._cpuset_path = cpuset.directory;
+  cgroup._memory_path = memory.directory;
+  return cgroup;
+}
+
+// _____________________________________________________________________________________________________________________
+double Cgroup::cpu_quota() const {
+  double quota = -1.0;
+  std::string buffer;
+  for (size_t i = 0; i < _source->cpu_quota.size(); ++i) {
+    int64_t limit = -1;
+    int64_t period = -1;
+    if (_source->cpu_v2) {
+      if (!_source->cpu_quota[i].read(buffer)) {
+        continue;
+      }
+      // "max 100000" (unlimited) or "50000 100000"
+      utils::NumberScanner scanner(buffer);
+      if (!scanner.next_int(limit) || !scanner.next_int(period)) {
+        continue;
+      }
+    } else if (!_source->cpu_quota[i].read_int64(limit) || !_source->cpu_period[i].read_int64(period)) {
+      continue;
+    }
+    // v1 reports -1 without a limit
+    if (limit > 0 && period > 0) {
+      const double cpus = static_cast<double>(limit) / static_cast<double>(period);
+      quota = quota < 0 ? cpus : std::min(quota, cpus);
+    }
+  }
+  return quota;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<int> Cgroup::effective_cpus() const {
+  std::vector<int> cpus;
+  std::string buffer;
+  std::vector<bool> set;
+  if (!_source->cpus.valid() || !_source->cpus.read(buffer) || !utils::parse_cpu_list(buffer, set)) {
+    return cpus;
+  }
+  for (size_t cpu = 0; cpu < set.size(); ++cpu) {
+    if (set[cpu]) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t Cgroup::memory_max_Bytes() const {
+  int64_t result = -1;
+  for (const auto& file : _source->memory_max) {
+    int64_t limit = -1;
+    // "max" (v2) does not parse
+    if (file.read_int64(limit) && limit >= 0 && limit < unlimited_memory) {
+      result = result < 0 ? limit : std::min(result, limit);
+    }
+  }
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t Cgroup::memory_current_Bytes() const {
+  int64_t value = -1;
+  return _source->memory_current.valid() && _source->memory_current.read_int64(value) ? value : -1;
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t Cgroup::cpu_usage_ns() const {
+  if (!_source->cpu_usage.valid()) {
+    return -1;
+  }
+  int64_t value = -1;
+  if (!_source->usage_v2) {
+    return _source->cpu_usage.read_int64(value) ? value : -1;
+  }
+  // "usage_usec 123\nuser_usec 100\nsystem_usec 23\n..."
+  std::string buffer;
+  if (!_source->cpu_usage.read(buffer)) {
+    return -1;
+  }
+  utils::NumberScanner scanner(buffer);
+  do {
+    if (scanner.next_word() == "usage_usec" && scanner.next_uint(value)) {
+      return value * 1000;
+    }
+  } while (scanner.next_line());
+  return -1;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -2,21 +2,21 @@
 // This software is part of HWBenchmark
 
 #include <hwinfo/platform.h>
+#include <hwinfo/utils/trace.h>
 
 #ifdef HWINFO_UNIX
 
 #include <unistd.h>
 
-#include <chrono>
-#include <cmath>
-#include <fstream>
-#include <map>
+#include <algorithm>
 #include <string>
-#include <thread>
+#include <string_view>
 #include <vector>
 
 #include "hwinfo/cpu.h"
+#include "hwinfo/cpuid.h"
 #include "hwinfo/utils/filesystem.h"
+#include "hwinfo/utils/parse.h"
 #include "hwinfo/utils/stringutils.h"
 
 namespace hwinfo {
@@ -54,186 +54,199 @@ int64_t getMinClockSpeed_MHz(const int& core_id) {
   return -1;
 }
 
+// _____________________________________________________________________________________________________________________
+int64_t CPU::currentClockSpeed_MHz(int thread_id) const {
+  const auto& files = filesystem::cpu_frequency_files();
+  int64_t frequency_kHz = -1;
+  if (thread_id < 0 || static_cast<size_t>(thread_id) >= files.size() || !files[thread_id].read_int64(frequency_kHz)) {
+    return -1;
+  }
+  return frequency_kHz / 1000;
+}
+
 // _____________________________________________________________________________________________________________________
 std::vector<int64_t> CPU::currentClockSpeed_MHz() const {
+  const auto& files = filesystem::cpu_frequency_files();
   std::vector<int64_t> res;
-  res.reserve(numLogicalCores());
-  for (int core_id = 0; /* breaks, if i is no valid cpu id */; ++core_id) {
-    int64_t frequency_Hz = filesystem::get_specs_by_file_path("/sys/devices/system/cpu/cpu" + std::to_string(core_id) +
-                                                              "/cpufreq/scaling_cur_freq");
-    if (frequency_Hz == -1) {
-      break;
-    }
-    res.push_back(frequency_Hz / 1000);
+  res.reserve(files.size());
+  for (const auto& file : files) {
+    int64_t frequency_kHz = -1;
+    res.push_back(file.read_int64(frequency_kHz) ? frequency_kHz / 1000 : -1);
   }
 
   return res;
 }
 
 // _____________________________________________________________________________________________________________________
-double CPU::currentUtilisation() const {
-  init_jiffies();
-  // TODO: Leon Freist a socket max num and a socket id inside the CPU could make it work with all sockets
-  //       I will not support it because I only have a 1 socket target device
-  static Jiffies last = Jiffies();
-
-  Jiffies current = filesystem::get_jiffies(0);
-
-  auto total_over_period = static_cast<double>(current.all - last.all);
-  auto work_over_period = static_cast<double>(current.working - last.working);
-
-  last = current;
-
-  const double utilization = work_over_period / total_over_period;
-  if (utilization < 0 || utilization > 1 || std::isnan(utilization)) {
-    return -1.0;
+int CPU::currentClockSpeed_MHz(int64_t* out, int capacity) const {
+  const auto& files = filesystem::cpu_frequency_files();
+  for (size_t i = 0; i < files.size() && i < static_cast<size_t>(capacity); ++i) {
+    int64_t frequency_kHz = -1;
+    out[i] = files[i].read_int64(frequency_kHz) ? frequency_kHz / 1000 : -1;
   }
-  return utilization;
+  return static_cast<int>(files.size());
 }
 
-// _____________________________________________________________________________________________________________________
-double CPU::threadUtilisation(int thread_index) const {
-  init_jiffies();
-  // TODO: Leon Freist a socket max num and a socket id inside the CPU could make it work with all sockets
-  //       I will not support it because I only have a 1 socket target device
-  static std::vector<Jiffies> last(0);
-  if (last.empty()) {
-    last.resize(_numLogicalCores);
-  }
-
-  Jiffies current = filesystem::get_jiffies(thread_index + 1);  // thread_index works only with 1 socket right now
-
-  auto total_over_period = static_cast<double>(current.all - last[thread_index].all);
-  auto work_over_period = static_cast<double>(current.working - last[thread_index].working);
-
-  last[thread_index] = current;
-
-  const double percentage = work_over_period / total_over_period;
-  if (percentage < 0 || percentage > 100 || std::isnan(percentage)) {
-    return -1.0;
-  }
-  return percentage;
-}
+namespace {
 
 // _____________________________________________________________________________________________________________________
-std::vector<double> CPU::threadsUtilisation() const {
-  std::vector<double> thread_utility(CPU::_numLogicalCores);
-  for (int thread_idx = 0; thread_idx < CPU::_numLogicalCores; ++thread_idx) {
-    thread_utility[thread_idx] = threadUtilisation(thread_idx);
+// Number of sockets from the sysfs topology or -1 if it is not available. Only one cpu per socket is looked at: its
+// package cpu list covers all cpus of the same socket.
+int count_sockets() {
+  const std::string cpu_dir = "/sys/devices/system/cpu/";
+  std::vector<size_t> cpu_ids;
+  for (const auto& entry : filesystem::getDirectoryEntries(cpu_dir)) {
+    size_t id = 0;
+    if (entry.compare(0, 3, "cpu") == 0 && utils::parse_int(std::string_view(entry).substr(3), id, true)) {
+      cpu_ids.push_back(id);
+    }
   }
-  return thread_utility;
-}
-
-// _____________________________________________________________________________________________________________________
-void CPU::init_jiffies() const {
-  if (!_jiffies_initialized) {
-    // Sleep 1 sec just for the start cause the usage needs to have a delta value which is depending on the unix file
-    // read it's just for the init, you don't need to wait if the delta is already created ...
-    std::this_thread::sleep_for(std::chrono::duration<double>(1));
-    _jiffies_initialized = true;
+  std::sort(cpu_ids.begin(), cpu_ids.end());
+
+  std::vector<bool> covered;
+  std::string list;
+  int sockets = 0;
+  for (size_t id : cpu_ids) {
+    if (id < covered.size() && covered[id]) {
+      continue;
+    }
+    const std::string topology = cpu_dir + "cpu" + std::to_string(id) + "/topology/";
+    // package_cpus_list replaces core_siblings_list since Linux 5.7. Offline cpus have no topology.
+    filesystem::CachedFile file(topology + "package_cpus_list");
+    if (!file.valid()) {
+      file = filesystem::CachedFile(topology + "core_siblings_list");
+    }
+    if (!file.valid()) {
+      continue;
+    }
+    if (!file.read(list) || !utils::parse_cpu_list(list, covered)) {
+      return -1;
+    }
+    sockets++;
   }
+  return sockets > 0 ? sockets : -1;
 }
 
-// CPU Temp -> Works | But requires Im_sensors
-// double CPU::currentTemperature_Celsius() const {
-//     if (!std::ifstream("/etc/sensors3.conf"))
-//     {
-//       std::cout << "The lm-sensors, the tool for monitoring your system's temperature, needs to be configured. Please
-//       set it up." << '\n';
-//       // Configure lm-sensors if not already configured
-//       std::string detect_command = "sudo sensors-detect";
-//       std::system(detect_command.c_str());
-//     }
-
-//     // TODO: Leon Freist a socket max num and a socket id inside the CPU could make it work with all sockets
-//     //       I will not support it because I only have a 1 socket target device
-//     const int Socked_id = 0;
-
-//     // Command to get temperature data using 'sensors' command
-//     std::string command = "sensors | grep 'Package id " + std::to_string(Socked_id) + "' | awk '{print $4}'";
-
-//     // Open a pipe to execute the command and capture its output
-//     FILE* pipe = popen(command.c_str(), "r");
-//     if (!pipe) {
-//         std::cerr << "Error executing command." << '\n';
-//         return -1.0; // Return a negative value to indicate an error
-//     }
-
-//     char buffer[128];
-//     std::string result = "";
-
-//     // Read the output of the command into 'result'
-//     while (!feof(pipe)) {
-//         if (fgets(buffer, sizeof(buffer), pipe) != NULL) {
-//             result += buffer;
-//         }
-//     }
-
-//     // Close the pipe
-//     pclose(pipe);
-
-//     // Convert the result (string) to a double
-//     double temperature = -1.0; // Default value in case of conversion failure
-//     std::istringstream(result) >> temperature;
-
-//     return temperature;
-// }
+}  // namespace
 
 // =====================================================================================================================
 // _____________________________________________________________________________________________________________________
-std::vector<CPU> getAllCPUs() {
-  std::vector<CPU> cpus;
-
-  std::ifstream cpuinfo("/proc/cpuinfo");
-  if (!cpuinfo.is_open()) {
+std::vector<CPU> getAllCPUs(CPUFields fields) {
+  HWINFO_TRACE_SCOPE(CPU);
+  // the cache holds every field, but only a complete read is stored
+  if (std::vector<CPU> cached; static_cache::load(cached)) {
+    return cached;
+  }
+  const bool complete = fields == CPUFields::All;
+  const bool read_features = contains(fields, CPUFields::Features);
+  const bool read_caches = contains(fields, CPUFields::Caches);
+  // /proc/cpuinfo has one block per logical cpu, but only the first block of every socket is used: the file is read
+  // in chunks and parsing stops once every socket was seen.
+  filesystem::LineReader cpuinfo("/proc/cpuinfo");
+  if (!cpuinfo.valid()) {
     return {};
   }
-  std::string file((std::istreambuf_iterator<char>(cpuinfo)), (std::istreambuf_iterator<char>()));
-  cpuinfo.close();
-  auto cpu_blocks_string = utils::split(file, "\n\n");
-  std::map<const std::string, const std::string> cpu_block;
-  int physical_id = -1;
-  bool next_add = false;
-  for (const auto& block : cpu_blocks_string) {
-    CPU cpu;
-    auto lines = utils::split(block, '\n');
-    for (auto& line : lines) {
-      auto line_pairs = utils::split(line, ":");
-      if (line_pairs.size() < 2) {
-        continue;
+  const int num_sockets = count_sockets();
+#if defined(HWINFO_X86)
+  // all sockets of a system have the same model: cpuid of the calling cpu describes every one of them
+  const FeatureSet features = read_features ? cpuid::read_features() : FeatureSet();
+  int64_t cache_sizes[4]{-1, -1, -1, -1};
+  for (const auto& cache : read_caches ? cpuid::read_caches() : std::vector<cpuid::CacheDescriptor>()) {
+    if (cache.type != cpuid::CacheDescriptor::Instruction && cache.level >= 1 && cache.level <= 3) {
+      cache_sizes[cache.level] = cache.size_Bytes;
+    }
+  }
+#endif
+
+  std::vector<CPU> cpus;
+  std::vector<int> seen_sockets;
+  CPU cpu;
+  bool add = false;
+  bool skip_block = false;
+  // returns true once all sockets are known
+  auto finish_block = [&]() {
+    if (add) {
+#if defined(HWINFO_X86)
+      cpu._features = features;
+      cpu._L1CacheSize_Bytes = cache_sizes[1];
+      cpu._L2CacheSize_Bytes = cache_sizes[2];
+      if (cache_sizes[3] > 0) {
+        cpu._L3CacheSize_Bytes = cache_sizes[3];
       }
-      auto name = line_pairs[0];
-      auto value = line_pairs[1];
-      utils::strip(name);
-      utils::strip(value);
-      if (name == "vendor_id") {
-        cpu._vendor = value;
-      } else if (name == "model name") {
-        cpu._modelName = value;
-      } else if (name == "cache size") {
-        cpu._L3CacheSize_Bytes = std::stoi(utils::split(value, " ")[0]) * 1024;
-      } else if (name == "siblings") {
-        cpu._numLogicalCores = std::stoi(value);
-      } else if (name == "cpu cores") {
-        cpu._numPhysicalCores = std::stoi(value);
-      } else if (name == "flags") {
-        cpu._flags = utils::split(value, " ");
-      } else if (name == "physical id") {
-        int tmp_phys_id = std::stoi(value);
-        if (physical_id == tmp_phys_id) {
-          continue;
+#else
+      for (const auto& flag : cpu._flags) {
+        Feature feature;
+        if (feature_from_name(flag, feature)) {
+          // "aes" names the ARM extension here
+          if (feature == Feature::AES) {
+            feature = Feature::ARM_AES;
+          }
+          cpu._features.set(feature);
         }
-        cpu._id = tmp_phys_id;
-        next_add = true;
       }
-    }
-    if (next_add) {
-      cpu._maxClockSpeed_MHz = getMaxClockSpeed_MHz(cpu._id);
-      cpu._regularClockSpeed_MHz = getRegularClockSpeed_MHz(cpu._id);
-      next_add = false;
-      physical_id++;
+#endif
+      if (contains(fields, CPUFields::Clocks)) {
+        cpu._maxClockSpeed_MHz = getMaxClockSpeed_MHz(cpu._id);
+        cpu._regularClockSpeed_MHz = getRegularClockSpeed_MHz(cpu._id);
+      }
       cpus.push_back(std::move(cpu));
     }
+    cpu = CPU();
+    add = false;
+    skip_block = false;
+    return num_sockets > 0 && cpus.size() >= static_cast<size_t>(num_sockets);
+  };
+
+  std::string_view line;
+  while (cpuinfo.next(line)) {
+    if (line.empty()) {
+      if (finish_block()) {
+        if (complete) {
+          static_cache::store(cpus);
+        }
+        return cpus;
+      }
+      continue;
+    }
+    if (skip_block) {
+      continue;
+    }
+    const size_t colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    const std::string_view name = utils::strip_view(line.substr(0, colon));
+    const std::string_view value = utils::strip_view(line.substr(colon + 1));
+    if (name == "vendor_id") {
+      cpu._vendor = value;
+    } else if (name == "model name") {
+      cpu._modelName = value;
+    } else if (name == "cache size" && read_caches) {
+      cpu._L3CacheSize_Bytes = utils::parse_int_or<int64_t>(value, -1) * 1024;
+    } else if (name == "siblings") {
+      cpu._numLogicalCores = utils::parse_int_or(value, -1);
+    } else if (name == "cpu cores") {
+      cpu._numPhysicalCores = utils::parse_int_or(value, -1);
+    } else if ((name == "flags" || name == "Features") && read_features) {
+      cpu._flags.clear();
+      for (std::string_view flag : utils::split_view(value, ' ', true)) {
+        cpu._flags.emplace_back(flag);
+      }
+    } else if (name == "physical id") {
+      const int socket_id = utils::parse_int_or(value, -1);
+      if (std::find(seen_sockets.begin(), seen_sockets.end(), socket_id) != seen_sockets.end()) {
+        // the rest of the block (including the long flags line) belongs to a known socket
+        skip_block = true;
+        continue;
+      }
+      seen_sockets.push_back(socket_id);
+      cpu._id = socket_id;
+      add = true;
+    }
+  }
+  finish_block();
+  if (complete) {
+    static_cache::store(cpus);
   }
   return cpus;
 }
@@ -0,0 +1,183 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/device_monitor.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+int openNetlink(int protocol, uint32_t groups) {
+  const int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+  if (fd < 0) {
+    return -1;
+  }
+  sockaddr_nl address{};
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = groups;
+  if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// _____________________________________________________________________________________________________________________
+// Component affected by a kernel uevent ("add@/devices/...\0ACTION=add\0DEVPATH=...\0SUBSYSTEM=block\0...").
+Component classifyUevent(std::string_view message) {
+  std::string_view action;
+  std::string_view subsystem;
+  while (!message.empty()) {
+    const size_t end = std::min(message.find('\0'), message.size());
+    const std::string_view field = message.substr(0, end);
+    if (field.substr(0, 7) == "ACTION=") {
+      action = field.substr(7);
+    } else if (field.substr(0, 10) == "SUBSYSTEM=") {
+      subsystem = field.substr(10);
+    }
+    message.remove_prefix(std::min(end + 1, message.size()));
+  }
+  // "change" is sent for every charge level update of a battery, but for block devices it means new media or a new
+  // partition table
+  if (action == "change") {
+    return subsystem == "block" ? Component::Disk : Component::None;
+  }
+  if (action != "add" && action != "remove" && action != "move" && action != "online" && action != "offline") {
+    return Component::None;
+  }
+  if (subsystem == "block") return Component::Disk;
+  if (subsystem == "net") return Component::Network;
+  if (subsystem == "power_supply") return Component::Battery;
+  if (subsystem == "drm") return Component::GPU;
+  if (subsystem == "memory") return Component::Memory;
+  if (subsystem == "cpu") return Component::CPU;
+  return Component::None;
+}
+
+}  // namespace
+
+struct DeviceMonitor::Source {
+  int uevent{-1};
+  // link and address changes (rtnetlink): addresses are part of Network but do not cause uevents
+  int route{-1};
+  // written by interrupt()
+  int wake{-1};
+  int epoll{-1};
+
+  ~Source() {
+    for (int fd : {uevent, route, wake, epoll}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+DeviceMonitor::DeviceMonitor() : _source(new Source()) {
+  // group 1: the kernel's own events (does not depend on udevd running)
+  _source->uevent = openNetlink(NETLINK_KOBJECT_UEVENT, 1);
+  _source->route = openNetlink(NETLINK_ROUTE, RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR);
+  _source->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  _source->epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (_source->epoll < 0) {
+    return;
+  }
+  for (int fd : {_source->uevent, _source->route, _source->wake}) {
+    if (fd >= 0) {
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.fd = fd;
+      epoll_ctl(_source->epoll, EPOLL_CTL_ADD, fd, &event);
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+DeviceMonitor::~DeviceMonitor() = default;
+
+// _____________________________________________________________________________________________________________________
+bool DeviceMonitor::valid() const {
+  return _source->epoll >= 0 && _source->wake >= 0 && (_source->uevent >= 0 || _source->route >= 0);
+}
+
+// _____________________________________________________________________________________________________________________
+int DeviceMonitor::fd() const { return _source->epoll; }
+
+// _____________________________________________________________________________________________________________________
+Component DeviceMonitor::wait(std::chrono::milliseconds timeout) {
+  if (!valid()) {
+    return Component::None;
+  }
+  // clamped so that the deadline does not overflow
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::min<std::chrono::milliseconds>(timeout, std::chrono::hours(24 * 365));
+  while (true) {
+    int timeout_ms = -1;
+    if (timeout.count() >= 0) {
+      const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - std::chrono::steady_clock::now());
+      timeout_ms = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(remaining.count(), INT32_MAX)));
+    }
+    epoll_event events[3];
+    if (epoll_wait(_source->epoll, events, 3, timeout_ms) <= 0) {
+      return Component::None;
+    }
+    // not only the sockets epoll reported: everything that is pending, so that bursts are coalesced into one result
+    Component changed = Component::None;
+    char buffer[8192];
+    ssize_t size;
+    while (_source->uevent >= 0) {
+      size = recv(_source->uevent, buffer, sizeof(buffer), MSG_DONTWAIT);
+      if (size <= 0) {
+        // the socket buffer overflowed: events were lost
+        if (size < 0 && errno == ENOBUFS) changed = changed | Component::All;
+        break;
+      }
+      changed = changed | classifyUevent(std::string_view(buffer, static_cast<size_t>(size)));
+    }
+    while (_source->route >= 0) {
+      size = recv(_source->route, buffer, sizeof(buffer), MSG_DONTWAIT);
+      if (size <= 0) {
+        if (size < 0 && errno == ENOBUFS) changed = changed | Component::Network;
+        break;
+      }
+      changed = changed | Component::Network;
+    }
+    uint64_t count;
+    const bool interrupted = read(_source->wake, &count, sizeof(count)) > 0;
+    // events of no interest (e.g. battery charge updates) do not end the wait
+    if (changed != Component::None || interrupted || timeout_ms == 0) {
+      return changed;
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void DeviceMonitor::interrupt() {
+  const uint64_t one = 1;
+  if (_source->wake >= 0 && write(_source->wake, &one, sizeof(one)) < 0) {
+    // the counter is saturated: a wake-up is pending anyway
+  }
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -7,128 +7,198 @@
 
 #include <hwinfo/disk.h>
 #include <hwinfo/utils/filesystem.h>
-#include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/mountinfo.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/trace.h>
 #include <sys/statvfs.h>
 
-#include <fstream>
-#include <regex>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace {
 
 // _____________________________________________________________________________________________________________________
-bool isPartition(const std::string& path) {
-  static const std::regex partitionRegex(R"((sd[a-z]|nvme\d+n\d+)p?\d+$)");
-  return std::regex_search(path, partitionRegex);
-}
+bool startsWith(std::string_view name, std::string_view prefix) { return name.compare(0, prefix.size(), prefix) == 0; }
 
 // _____________________________________________________________________________________________________________________
-bool readFile(const std::string& path, std::string& outContent) {
-  // Reads the file content and stores it in `outContent`. Returns true if successful, false otherwise.
-  std::ifstream file(path);
-  if (!file) return false;
-
-  std::getline(file, outContent);
-  hwinfo::utils::strip(outContent);
-  return !outContent.empty();
+// Block devices that are not disks: ram disks, loop devices, compressed swap, network block devices, and device mapper
+// and software RAID volumes (their capacity is that of the underlying disks, which are listed themselves).
+bool isVirtualDevice(std::string_view name) {
+  static constexpr std::string_view prefixes[] = {"loop", "ram", "zram", "nbd", "dm-", "md"};
+  for (const auto prefix : prefixes) {
+    if (startsWith(name, prefix)) return true;
+  }
+  return false;
 }
 
 // _____________________________________________________________________________________________________________________
-std::string getMountPoint(const std::string& device) {
-  std::ifstream mounts("/proc/mounts");
-  std::string line, dev, mount_point;
-  while (std::getline(mounts, line)) {
-    std::istringstream iss(line);
-    if (iss >> dev >> mount_point && dev == device) {
-      return mount_point;
-    }
-  }
-  return "/";
+// The boot areas and the replay protected memory block of eMMC devices are block devices of their own, but no
+// partitions (they have no "partition" attribute).
+bool isMmcHardwarePartition(std::string_view name) {
+  return startsWith(name, "mmcblk") &&
+         (name.find("boot") != std::string_view::npos || name.find("rpmb") != std::string_view::npos);
 }
 
-}  // anonymous namespace
-
-namespace hwinfo {
+// Attribute paths relative to /sys/class/block/<dev>/.
+struct DiskAttributes {
+  const char* vendor;
+  const char* model;
+  const char* serial;
+};
 
 // _____________________________________________________________________________________________________________________
-std::string getDiskVendor(const std::string& path) {
-  // nvme devices are in /sys/class/nvme/ and /sys/class/block/nvme*
-  // but the vendor file is only in /sys/class/nvme/
-  // so we need to check if the device is in /sys/class/block/nvme* and if so, we need to change the path
-  // TODO: use utils::get_specs_by_file
-  std::string vendor_path = path;
-  std::string::size_type nvme_pos = path.find("nvme");
-  if (nvme_pos != std::string::npos) {
-    std::string nvme_name = path.substr(nvme_pos, 5);  // e.g., "nvme0"
-    vendor_path = path.substr(0, nvme_pos - 6) + "nvme/" + nvme_name;
-  }
-
-  std::string vendor;
-  return readFile(vendor_path + "/device/vendor", vendor) ? vendor : "<unknown>";
+DiskAttributes diskAttributes(std::string_view name) {
+  // "device" of a namespace is the controller (/sys/class/nvme/nvmeN), the vendor id is that of its PCI device
+  if (startsWith(name, "nvme")) return {"device/device/vendor", "device/model", "device/serial"};
+  // mmc cards report a manufacturer id and a product name
+  if (startsWith(name, "mmcblk")) return {"device/manfid", "device/name", "device/serial"};
+  return {"device/vendor", "device/model", "device/serial"};
 }
 
 // _____________________________________________________________________________________________________________________
-std::string getDiskModel(const std::string& path) {
-  std::string model;
-  return readFile(path + "/device/model", model) ? model : "<unknown>";
+std::string readOrUnknown(const hwinfo::filesystem::Directory& dir, const char* name) {
+  std::string value;
+  return dir.read(name, value) ? value : "<unknown>";
 }
 
 // _____________________________________________________________________________________________________________________
-std::string getDiskSerialNumber(const std::string& path) {
-  std::string serial;
-  return readFile(path + "/device/serial", serial) ? serial : "<unknown>";
+// "major:minor" of the dev attribute.
+bool readDeviceNumber(const hwinfo::filesystem::Directory& dir, uint32_t& major, uint32_t& minor) {
+  std::string value;
+  if (!dir.read("dev", value)) return false;
+  const auto colon = value.find(':');
+  return colon != std::string::npos && hwinfo::utils::parse_int(std::string_view(value).substr(0, colon), major) &&
+         hwinfo::utils::parse_int(std::string_view(value).substr(colon + 1), minor);
 }
 
 // _____________________________________________________________________________________________________________________
-int64_t getDiskSize_Bytes(const std::string& path) {
-  std::ifstream f(path + "/size");
-  if (f) {
-    int64_t size;
-    f >> size;
-    f.close();
-    return size * block_size;
-  }
-  return -1;
+// Process wide mount index: parsed on first use and re-parsed only after the mount table changed.
+const hwinfo::utils::MountIndex& mountIndex(std::unique_lock<std::mutex>& lock) {
+  static std::mutex mutex;
+  static hwinfo::utils::MountIndex index;
+  lock = std::unique_lock<std::mutex>(mutex);
+  index.refresh();
+  return index;
 }
 
+}  // anonymous namespace
+
+namespace hwinfo {
+
 // _____________________________________________________________________________________________________________________
 int64_t getDiskFreeSize_Bytes(const std::string& path) {
   struct statvfs stat {};
-  if (statvfs(path.c_str(), &stat) == 0)
+  if (statvfs(filesystem::rooted(path).c_str(), &stat) == 0)
     return static_cast<int64_t>(stat.f_bsize) * static_cast<int64_t>(stat.f_bavail);
 
   return -1;
 }
 
 // =====================================================================================================================
+struct DiskEnumerator::Source {
+  DiskFields fields{DiskFields::None};
+  filesystem::DirectoryStream entries{"/sys/class/block"};
+};
+
 // _____________________________________________________________________________________________________________________
-std::vector<Disk> getAllDisks() {
-  std::vector<Disk> disks;
-  const std::string base_path = "/sys/class/block/";
+DiskEnumerator::DiskEnumerator(DiskFields fields) : _source(std::make_unique<Source>()) { _source->fields = fields; }
 
-  for (const auto& entry : filesystem::getDirectoryEntries(base_path)) {
-    std::string path = base_path + entry;
-    if (!filesystem::exists(path) || isPartition(path)) continue;
+// _____________________________________________________________________________________________________________________
+DiskEnumerator::~DiskEnumerator() = default;
 
-    Disk disk;
-    disk._vendor = getDiskVendor(path);
-    disk._model = getDiskModel(path);
-    disk._serialNumber = getDiskSerialNumber(path);
+// _____________________________________________________________________________________________________________________
+std::optional<Disk> DiskEnumerator::next() {
+  const std::string base_path = "/sys/class/block/";
+  const DiskFields fields = _source->fields;
+  std::string_view name;
+  while (_source->entries.next(name)) {
+    if (isVirtualDevice(name) || isMmcHardwarePartition(name)) continue;
+    const std::string entry(name);
+    const std::string path = base_path + entry;
+    const filesystem::Directory dir(path);
+    if (!dir.valid() || dir.exists("partition")) continue;
 
+    Disk disk;
+    disk._device_name = entry;
+    const DiskAttributes attributes = diskAttributes(entry);
     // Check before get size because size is always define in /sys/class/block/...
-    if (disk._vendor == "<unknown>" && disk._model == "<unknown>" && disk._serialNumber == "<unknown>") {
+    if (contains(fields, DiskFields::Identity)) {
+      disk._vendor = readOrUnknown(dir, attributes.vendor);
+      disk._model = readOrUnknown(dir, attributes.model);
+      disk._serialNumber = readOrUnknown(dir, attributes.serial);
+      if (disk._vendor == "<unknown>" && disk._model == "<unknown>" && disk._serialNumber == "<unknown>") {
+        continue;
+      }
+    } else if (!dir.exists(attributes.vendor) && !dir.exists(attributes.model) && !dir.exists(attributes.serial)) {
       continue;
     }
 
-    disk._size_Bytes = getDiskSize_Bytes(path);
+    if (contains(fields, DiskFields::Size)) {
+      int64_t sectors = -1;
+      disk._size_Bytes = dir.read_int64("size", sectors) && sectors >= 0 ? sectors * block_size : -1;
+    }
 
-    auto mount_point = getMountPoint("/dev/" + entry);
-    disk._free_size_Bytes = getDiskFreeSize_Bytes(mount_point);
-    disk._volumes.push_back(std::move(mount_point));
+    if (!contains(fields, DiskFields::Volumes)) {
+      return disk;
+    }
 
-    disks.push_back(std::move(disk));
+    // mounts of the whole disk and of its partitions (the subdirectories with a "partition" attribute)
+    std::vector<std::string> devices = {entry};
+    for (const auto& child : filesystem::getDirectoryEntries(path)) {
+      if (startsWith(child, entry) && dir.exists((child + "/partition").c_str())) devices.push_back(child);
+    }
+    // the mount index is only locked while the volumes of this disk are looked up
+    std::unique_lock<std::mutex> lock;
+    const utils::MountIndex& mounts = mountIndex(lock);
+    std::vector<size_t> disk_mounts;
+    for (const auto& device : devices) {
+      uint32_t major = 0;
+      uint32_t minor = 0;
+      const size_t first = disk_mounts.size();
+      if (readDeviceNumber(filesystem::Directory(base_path + device), major, minor)) {
+        const auto& of_device = mounts.of_device(major, minor);
+        disk_mounts.insert(disk_mounts.end(), of_device.begin(), of_device.end());
+      }
+      // btrfs and friends report an anonymous device number
+      if (disk_mounts.size() == first) {
+        const auto& of_source = mounts.of_source("/dev/" + device);
+        disk_mounts.insert(disk_mounts.end(), of_source.begin(), of_source.end());
+      }
+    }
+    std::sort(disk_mounts.begin(), disk_mounts.end());
+    disk_mounts.erase(std::unique(disk_mounts.begin(), disk_mounts.end()), disk_mounts.end());
+
+    // a filesystem mounted several times (bind mounts, containers) is only counted once
+    std::vector<std::string> counted_sources;
+    for (const size_t index : disk_mounts) {
+      const utils::Mount& mount = mounts.mounts()[index];
+      disk._volumes.push_back(mount.mount_point);
+      if (std::find(counted_sources.begin(), counted_sources.end(), mount.source) != counted_sources.end()) continue;
+      counted_sources.push_back(mount.source);
+      const int64_t free_Bytes = getDiskFreeSize_Bytes(mount.mount_point);
+      if (free_Bytes >= 0) {
+        disk._free_size_Bytes = std::max<int64_t>(disk._free_size_Bytes, 0) + free_Bytes;
+      }
+    }
+    return disk;
   }
+  return std::nullopt;
+}
 
+// _____________________________________________________________________________________________________________________
+std::vector<Disk> getAllDisks(DiskFields fields) {
+  HWINFO_TRACE_SCOPE(Disk);
+  std::vector<Disk> disks;
+  DiskEnumerator enumerator(fields);
+  while (auto disk = enumerator.next()) {
+    disks.push_back(std::move(*disk));
+  }
   return disks;
 }
 
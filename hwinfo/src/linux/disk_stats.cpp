@@ -0,0 +1,81 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/disk.h>
+#include <hwinfo/disk_stats.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+struct DiskStatsSampler::Source {
+  filesystem::CachedFile file{"/proc/diskstats"};
+  std::string buffer;
+  // device name (viewing into _device_names) -> index
+  std::unordered_map<std::string_view, size_t> index;
+};
+
+// _____________________________________________________________________________________________________________________
+DiskStatsSampler::DiskStatsSampler(std::vector<std::string> device_names)
+    : _device_names(std::move(device_names)),
+      _source(new Source()),
+      _previous(_device_names.size()),
+      _current(_device_names.size()),
+      _stats(_device_names.size()) {
+  for (size_t i = 0; i < _device_names.size(); ++i) {
+    _source->index.emplace(_device_names[i], i);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+DiskStatsSampler::~DiskStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool DiskStatsSampler::read_counters() {
+  if (!_source->file.read(_source->buffer)) {
+    return false;
+  }
+  // "259  0 nvme0n1 reads merged sectors ms writes merged sectors ms in_flight io_ms weighted_ms ..."
+  utils::NumberScanner scanner(_source->buffer);
+  do {
+    scanner.next_word();
+    scanner.next_word();
+    const auto it = _source->index.find(scanner.next_word());
+    if (it == _source->index.end()) {
+      continue;
+    }
+    int64_t fields[11];
+    bool complete = true;
+    for (auto& field : fields) {
+      complete = complete && scanner.next_uint(field);
+    }
+    if (!complete) {
+      continue;
+    }
+    Counters& counters = _current[it->second];
+    counters.reads = fields[0];
+    counters.read_Bytes = fields[2] * block_size;
+    counters.read_time_ms = fields[3];
+    counters.writes = fields[4];
+    counters.written_Bytes = fields[6] * block_size;
+    counters.write_time_ms = fields[7];
+    counters.in_flight = fields[8];
+    counters.busy_time_ms = fields[9];
+    counters.weighted_time_ms = fields[10];
+  } while (scanner.next_line());
+  return true;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
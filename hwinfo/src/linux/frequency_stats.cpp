@@ -0,0 +1,216 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <fcntl.h>
+#include <hwinfo/frequency_stats.h>
+#include <hwinfo/utils/filesystem.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+const std::string msr_pmu_path = "/sys/bus/event_source/devices/msr/";
+
+// MSR addresses, see the Intel SDM vol. 4 (AMD uses the same)
+constexpr off_t IA32_TIME_STAMP_COUNTER = 0x10;
+constexpr off_t IA32_MPERF = 0xE7;
+constexpr off_t IA32_APERF = 0xE8;
+
+// _____________________________________________________________________________________________________________________
+// Opens a cpu-wide counter (all tasks on that cpu). Returns -1 on error.
+int openPerfEvent(uint32_t type, uint64_t config, int cpu, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  // all counters of the group are returned by one read() of the leader
+  attr.read_format = PERF_FORMAT_GROUP;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, -1, cpu, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+// _____________________________________________________________________________________________________________________
+// Config of an event of a dynamic PMU ("event=0x01" in events/<name>), false if the PMU does not provide it.
+bool pmuEventConfig(const filesystem::Directory& pmu, const char* name, uint64_t& config) {
+  std::string value;
+  if (!pmu.read((std::string("events/") + name).c_str(), value)) {
+    return false;
+  }
+  constexpr std::string_view prefix = "event=0x";
+  if (value.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  config = 0;
+  for (char c : std::string_view(value).substr(prefix.size())) {
+    const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    if (digit < 0) {
+      break;
+    }
+    config = config << 4 | static_cast<uint64_t>(digit);
+  }
+  return true;
+}
+
+enum class Backend { None, MsrPmu, Cycles, MsrDevice };
+
+}  // namespace
+
+struct FrequencySampler::Source {
+  Backend backend{Backend::None};
+  // per cpu: the group leader (perf backends) or /dev/cpu/N/msr, -1 if it could not be opened
+  std::vector<int> fds;
+  // group members, only kept to be closed
+  std::vector<int> members;
+  // counters per group: tsc, aperf, mperf (MsrPmu) or cycles only (Cycles)
+  size_t group_size{0};
+
+  ~Source() {
+    for (int fd : fds) {
+      if (fd >= 0) close(fd);
+    }
+    for (int fd : members) {
+      close(fd);
+    }
+  }
+
+  // Opens the (tsc, aperf, mperf) group of every cpu. False if it worked for none.
+  bool openMsrPmu() {
+    const filesystem::Directory pmu(msr_pmu_path);
+    int64_t type = -1;
+    uint64_t configs[3];
+    if (!pmu.valid() || !pmu.read_int64("type", type) || !pmuEventConfig(pmu, "tsc", configs[0]) ||
+        !pmuEventConfig(pmu, "aperf", configs[1]) || !pmuEventConfig(pmu, "mperf", configs[2])) {
+      return false;
+    }
+    return openGroups(static_cast<uint32_t>(type), configs, 3);
+  }
+
+  // Opens the cycles counter of every cpu. False if it worked for none.
+  bool openCycles() {
+    const uint64_t config = PERF_COUNT_HW_CPU_CYCLES;
+    return openGroups(PERF_TYPE_HARDWARE, &config, 1);
+  }
+
+  // Opens /dev/cpu/N/msr of every cpu. False if it worked for none.
+  bool openMsrDevice() {
+    bool any = false;
+    for (size_t cpu = 0; cpu < fds.size(); ++cpu) {
+      fds[cpu] = filesystem::open_path(("/dev/cpu/" + std::to_string(cpu) + "/msr").c_str(), O_RDONLY);
+      uint64_t value = 0;
+      // MSR reads fail on cpus without the register
+      if (fds[cpu] >= 0 && pread(fds[cpu], &value, sizeof(value), IA32_MPERF) != sizeof(value)) {
+        close(fds[cpu]);
+        fds[cpu] = -1;
+      }
+      any = any || fds[cpu] >= 0;
+    }
+    return any;
+  }
+
+ private:
+  bool openGroups(uint32_t type, const uint64_t* configs, size_t count) {
+    bool any = false;
+    for (size_t cpu = 0; cpu < fds.size(); ++cpu) {
+      int leader = openPerfEvent(type, configs[0], static_cast<int>(cpu), -1);
+      for (size_t i = 1; i < count && leader >= 0; ++i) {
+        const int member = openPerfEvent(type, configs[i], static_cast<int>(cpu), leader);
+        if (member < 0) {
+          // the group is incomplete, members opened so far are closed with the others
+          close(leader);
+          leader = -1;
+          break;
+        }
+        members.push_back(member);
+      }
+      fds[cpu] = leader;
+      any = any || leader >= 0;
+    }
+    if (!any) {
+      for (int fd : members) {
+        close(fd);
+      }
+      members.clear();
+    }
+    group_size = count;
+    return any;
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+FrequencySampler::FrequencySampler(int num_threads)
+    : _source(new Source()),
+      _previous(static_cast<size_t>(std::max(num_threads, 0))),
+      _current(_previous.size()),
+      _stats(_previous.size()) {
+  _source->fds.assign(_stats.size(), -1);
+  if (_source->openMsrPmu()) {
+    _source->backend = Backend::MsrPmu;
+  } else if (_source->openCycles()) {
+    _source->backend = Backend::Cycles;
+  } else if (_source->openMsrDevice()) {
+    _source->backend = Backend::MsrDevice;
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+FrequencySampler::~FrequencySampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool FrequencySampler::available() const { return _source->backend != Backend::None; }
+
+// _____________________________________________________________________________________________________________________
+bool FrequencySampler::read_counters() {
+  bool success = false;
+  for (size_t cpu = 0; cpu < _current.size(); ++cpu) {
+    const int fd = _source->fds[cpu];
+    if (fd < 0) {
+      continue;
+    }
+    Counters& counters = _current[cpu];
+    if (_source->backend == Backend::MsrDevice) {
+      uint64_t values[3];
+      if (pread(fd, &values[0], sizeof(uint64_t), IA32_TIME_STAMP_COUNTER) != sizeof(uint64_t) ||
+          pread(fd, &values[1], sizeof(uint64_t), IA32_APERF) != sizeof(uint64_t) ||
+          pread(fd, &values[2], sizeof(uint64_t), IA32_MPERF) != sizeof(uint64_t)) {
+        continue;
+      }
+      counters.tsc = static_cast<int64_t>(values[0]);
+      counters.aperf = static_cast<int64_t>(values[1]);
+      counters.mperf = static_cast<int64_t>(values[2]);
+    } else {
+      // PERF_FORMAT_GROUP: nr, then one value per counter in the order they were opened
+      uint64_t values[4];
+      const auto size = static_cast<ssize_t>((1 + _source->group_size) * sizeof(uint64_t));
+      if (read(fd, values, static_cast<size_t>(size)) != size || values[0] != _source->group_size) {
+        continue;
+      }
+      if (_source->backend == Backend::MsrPmu) {
+        counters.tsc = static_cast<int64_t>(values[1]);
+        counters.aperf = static_cast<int64_t>(values[2]);
+        counters.mperf = static_cast<int64_t>(values[3]);
+      } else {
+        counters.aperf = static_cast<int64_t>(values[1]);
+      }
+    }
+    success = true;
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
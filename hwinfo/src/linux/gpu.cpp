@@ -1,4 +1,3 @@
-
 // Copyright Leon Freist
 // Author Leon Freist <freist@informatik.uni-freiburg.de>
 
@@ -9,97 +8,166 @@
 #include <hwinfo/gpu.h>
 #include <hwinfo/utils/PCIMapper.h>
 #include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/trace.h>
 
-#ifdef USE_OCL
-#include <hwinfo/opencl/device.h>
-#endif
-
-#include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace hwinfo {
 
+namespace {
+
+const std::string pci_devices_path = "/sys/bus/pci/devices/";
+
+// resource flags, see include/linux/ioport.h
+constexpr uint64_t IORESOURCE_MEM = 0x00000200;
+constexpr uint64_t IORESOURCE_PREFETCH = 0x00002000;
+
 // _____________________________________________________________________________________________________________________
-std::string read_drm_by_path(const std::string& path) {
-  std::ifstream f_drm(path);
-  if (!f_drm) {
-    return "";
+// Parses a sysfs hex attribute ("0x030000"). Returns false if it is not one.
+bool parseHex(std::string_view value, uint64_t& out) {
+  if (value.size() > 2 && value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) {
+    value.remove_prefix(2);
   }
-  std::string ret;
-  getline(f_drm, ret);
-  return ret;
+  const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), out, 16);
+  return ec == std::errc() && ptr != value.data();
 }
 
 // _____________________________________________________________________________________________________________________
-std::vector<int> get_frequencies(const std::string drm_path) {
-  // {min, current, max}
-  std::vector<int> freqs(3);
-  try {
-    freqs[0] = std::stoi(read_drm_by_path(drm_path + "gt_min_freq_mhz"));
-  } catch (const std::invalid_argument& e) {
-    freqs[0] = -1;
+// Size of the largest prefetchable memory BAR of the "start end flags" lines of a resource file: the VRAM aperture,
+// i.e. the whole VRAM with resizable BAR, a lower bound without.
+int64_t largestPrefetchableBar(std::string_view resource) {
+  int64_t largest = -1;
+  const char* p = resource.data();
+  const char* end = p + resource.size();
+  while (p < end) {
+    const char* line_end = utils::find_line_end(p, end);
+    uint64_t fields[3];
+    const char* q = p;
+    bool valid = true;
+    for (uint64_t& field : fields) {
+      q = utils::skip_blanks(q, line_end);
+      const char* token_end = std::find(q, line_end, ' ');
+      valid = valid && parseHex(std::string_view(q, static_cast<size_t>(token_end - q)), field);
+      q = token_end;
+    }
+    p = line_end + 1;
+    if (!valid || (fields[2] & (IORESOURCE_MEM | IORESOURCE_PREFETCH)) != (IORESOURCE_MEM | IORESOURCE_PREFETCH) ||
+        fields[1] <= fields[0]) {
+      continue;
+    }
+    largest = std::max(largest, static_cast<int64_t>(fields[1] - fields[0] + 1));
   }
-  try {
-    freqs[1] = std::stoi(read_drm_by_path(drm_path + "gt_cur_freq_mhz"));
-  } catch (const std::invalid_argument& e) {
-    freqs[0] = -1;
+  return largest;
+}
+
+// _____________________________________________________________________________________________________________________
+// Highest shader clock of an amdgpu pp_dpm_sclk table ("0: 500Mhz\n1: 2100Mhz *\n"), -1 if there is none.
+int64_t maxDpmClock_MHz(std::string_view table) {
+  int64_t max = -1;
+  const char* p = table.data();
+  const char* end = p + table.size();
+  while (p < end) {
+    const char* line_end = utils::find_line_end(p, end);
+    const std::string_view line(p, static_cast<size_t>(line_end - p));
+    p = line_end + 1;
+    const size_t colon = line.find(':');
+    if (colon != std::string_view::npos) {
+      max = std::max(max, utils::parse_int_or<int64_t>(line.substr(colon + 1), -1));
+    }
   }
-  try {
-    freqs[2] = std::stoi(read_drm_by_path(drm_path + "gt_max_freq_mhz"));
-  } catch (const std::invalid_argument& e) {
-    freqs[0] = -1;
+  return max;
+}
+
+// _____________________________________________________________________________________________________________________
+// Name of the DRM card node (e.g. "card1") bound to the PCI device, empty if no DRM driver is bound.
+std::string drmCard(const std::string& device_path) {
+  for (auto& entry : filesystem::getDirectoryEntries(device_path + "drm")) {
+    if (entry.compare(0, 4, "card") == 0) {
+      return entry;
+    }
   }
-  return freqs;
+  return {};
 }
 
+}  // namespace
+
 // _____________________________________________________________________________________________________________________
-std::vector<GPU> getAllGPUs() {
+std::vector<GPU> getAllGPUs(GPUFields fields) {
+  HWINFO_TRACE_SCOPE(GPU);
+  if (std::vector<GPU> cached; static_cache::load(cached)) {
+    return cached;
+  }
   std::vector<GPU> gpus{};
-  PCIMapper pci = PCI::getMapper();
-  int id = 0;
-  while (true) {
-    GPU gpu;
-    gpu._id = id;
-    std::string path("/sys/class/drm/card" + std::to_string(id) + '/');
-    if (!filesystem::exists(path)) {
-      if (id > 2) {
-        break;
-      }
-      id++;
+  // the PCI database is only parsed for the names
+  const PCIMapper* pci = contains(fields, GPUFields::Names) ? &PCI::getMapper() : nullptr;
+  std::vector<std::string> addresses = filesystem::getDirectoryEntries(pci_devices_path);
+  // readdir order is arbitrary, sorted addresses follow the bus topology
+  std::sort(addresses.begin(), addresses.end());
+  std::string value;
+  for (const auto& address : addresses) {
+    const std::string path = pci_devices_path + address + '/';
+    uint64_t pci_class = 0;
+    // base class 0x03: display controller (VGA, XGA, 3D). Only its directory is opened for the other attributes.
+    if (!filesystem::CachedFile(path + "class").read(value) || !parseHex(value, pci_class) ||
+        (pci_class >> 16) != 0x03) {
       continue;
     }
-    gpu._vendor_id = read_drm_by_path(path + "device/vendor");
-    gpu._device_id = read_drm_by_path(path + "device/device");
-    if (gpu._vendor_id.empty() || gpu._device_id.empty()) {
-      id++;
+    const filesystem::Directory device(path);
+    GPU gpu;
+    gpu._id = static_cast<int>(gpus.size());
+    gpu._pci_bus_id = address;
+    std::string vendor_hex;
+    std::string device_hex;
+    uint64_t vendor_id = 0;
+    uint64_t device_id = 0;
+    if (!device.read("vendor", vendor_hex) || !device.read("device", device_hex) || !parseHex(vendor_hex, vendor_id) ||
+        !parseHex(device_hex, device_id)) {
       continue;
     }
-    const PCIVendor& vendor = pci[gpu._vendor_id];
-    const PCIDevice device = vendor[gpu._device_id];
-    gpu._vendor = vendor.vendor_name;
-    gpu._name = vendor[gpu._device_id].device_name;
-    auto frequencies = get_frequencies(path);
-    gpu._frequency_MHz = frequencies[2];
-    gpus.push_back(std::move(gpu));
-    id++;
-  }
-#ifdef USE_OCL
-  auto cl_gpus = opencl_::DeviceManager::get_list<opencl_::Filter::GPU>();
-  for (auto& gpu : gpus) {
-    for (auto* cl_gpu : cl_gpus) {
-      if (cl_gpu->name().find(gpu._device_id)) {
-        gpu._driverVersion = cl_gpu->driver_version();
-        gpu._frequency_MHz = static_cast<int64_t>(cl_gpu->clock_frequency_MHz());
-        gpu._num_cores = static_cast<int>(cl_gpu->cores());
-        gpu._memory_Bytes = static_cast<int64_t>(cl_gpu->memory_Bytes());
+    gpu._vendor_id = vendor_hex;
+    gpu._device_id = device_hex;
+    if (pci) {
+      const PCIVendor vendor = (*pci)[static_cast<uint16_t>(vendor_id)];
+      const PCIDevice pci_device = vendor[static_cast<uint16_t>(device_id)];
+      gpu._vendor = vendor.vendor_name;
+      gpu._name = pci_device.device_name;
+    }
+
+    if (contains(fields, GPUFields::Memory)) {
+      int64_t vram_Bytes = -1;
+      if (device.read_int64("mem_info_vram_total", vram_Bytes)) {
+        // amdgpu
+        gpu._memory_Bytes = vram_Bytes;
+      } else if (filesystem::CachedFile(path + "resource").read(value)) {
+        gpu._memory_Bytes = std::max<int64_t>(largestPrefetchableBar(value), 0);
       }
     }
+
+    if (contains(fields, GPUFields::Frequency)) {
+      int64_t frequency_MHz = -1;
+      const std::string card = drmCard(path);
+      if (!card.empty() && device.read_int64(("drm/" + card + "/gt_max_freq_mhz").c_str(), frequency_MHz)) {
+        // i915 / xe
+        gpu._frequency_MHz = frequency_MHz;
+      } else if (filesystem::CachedFile(path + "pp_dpm_sclk").read(value)) {
+        // amdgpu
+        gpu._frequency_MHz = std::max<int64_t>(maxDpmClock_MHz(value), 0);
+      }
+    }
+    gpus.push_back(std::move(gpu));
+  }
+  if (fields == GPUFields::All) {
+    static_cache::store(gpus);
   }
-#endif  // USE_OCL
   return gpus;
 }
 
 }  // namespace hwinfo
 
-#endif  // HWINFO_UNIX
\ No newline at end of file
+#endif  // HWINFO_UNIX
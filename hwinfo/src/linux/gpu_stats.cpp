@@ -0,0 +1,276 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <dlfcn.h>
+#include <hwinfo/gpu_stats.h>
+#include <hwinfo/utils/filesystem.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+const std::string pci_devices_path = "/sys/bus/pci/devices/";
+
+// Source of the telemetry of one GPU.
+class Backend {
+ public:
+  virtual ~Backend() = default;
+  // Sets the values the backend provides. Returns false if none could be read.
+  virtual bool read(int64_t now_ns, GPUStats& stats) = 0;
+};
+
+// --- NVML ---
+
+// The subset of nvml.h that is used. All functions return an nvmlReturn_t, 0 (NVML_SUCCESS) on success.
+using nvmlReturn_t = int;
+using nvmlDevice_t = struct nvmlDevice_st*;
+struct nvmlUtilization_t {
+  unsigned int gpu;
+  unsigned int memory;
+};
+struct nvmlMemory_t {
+  unsigned long long total;
+  unsigned long long free;
+  unsigned long long used;
+};
+constexpr int NVML_CLOCK_SM = 1;
+constexpr int NVML_CLOCK_MEM = 2;
+constexpr int NVML_TEMPERATURE_GPU = 0;
+
+// libnvidia-ml, loaded and initialized on first use. It stays loaded (and initialized) for the lifetime of the process:
+// nvmlShutdown() at exit could race with samplers of other threads.
+struct Nvml {
+  nvmlReturn_t (*init)();
+  nvmlReturn_t (*handle_by_pci_bus_id)(const char*, nvmlDevice_t*);
+  nvmlReturn_t (*utilization_rates)(nvmlDevice_t, nvmlUtilization_t*);
+  nvmlReturn_t (*memory_info)(nvmlDevice_t, nvmlMemory_t*);
+  nvmlReturn_t (*clock_info)(nvmlDevice_t, int, unsigned int*);
+  nvmlReturn_t (*power_usage)(nvmlDevice_t, unsigned int*);
+  nvmlReturn_t (*temperature)(nvmlDevice_t, int, unsigned int*);
+
+  // nullptr if the driver is not installed or no GPU could be initialized. Thread-safe.
+  static const Nvml* get() {
+    static const Nvml* nvml = load();
+    return nvml;
+  }
+
+ private:
+  static const Nvml* load() {
+    void* library = dlopen("libnvidia-ml.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) {
+      return nullptr;
+    }
+    auto nvml = std::make_unique<Nvml>();
+    const bool resolved = resolve(library, "nvmlInit_v2", nvml->init) &&
+                          resolve(library, "nvmlDeviceGetHandleByPciBusId_v2", nvml->handle_by_pci_bus_id) &&
+                          resolve(library, "nvmlDeviceGetUtilizationRates", nvml->utilization_rates) &&
+                          resolve(library, "nvmlDeviceGetMemoryInfo", nvml->memory_info) &&
+                          resolve(library, "nvmlDeviceGetClockInfo", nvml->clock_info) &&
+                          resolve(library, "nvmlDeviceGetPowerUsage", nvml->power_usage) &&
+                          resolve(library, "nvmlDeviceGetTemperature", nvml->temperature);
+    if (!resolved || nvml->init() != 0) {
+      dlclose(library);
+      return nullptr;
+    }
+    return nvml.release();
+  }
+
+  template <typename F>
+  static bool resolve(void* library, const char* name, F& function) {
+    function = reinterpret_cast<F>(dlsym(library, name));
+    return function != nullptr;
+  }
+};
+
+class NvmlBackend : public Backend {
+ public:
+  NvmlBackend(const Nvml& nvml, nvmlDevice_t device) : _nvml(nvml), _device(device) {}
+
+  bool read(int64_t /*now_ns*/, GPUStats& stats) override {
+    bool success = false;
+    nvmlUtilization_t utilization{};
+    if (_nvml.utilization_rates(_device, &utilization) == 0) {
+      stats.utilisation = utilization.gpu / 100.0;
+      success = true;
+    }
+    nvmlMemory_t memory{};
+    if (_nvml.memory_info(_device, &memory) == 0) {
+      stats.memory_used_Bytes = static_cast<int64_t>(memory.used);
+      stats.memory_total_Bytes = static_cast<int64_t>(memory.total);
+      success = true;
+    }
+    unsigned int value = 0;
+    if (_nvml.clock_info(_device, NVML_CLOCK_SM, &value) == 0) {
+      stats.core_clock_MHz = value;
+      success = true;
+    }
+    if (_nvml.clock_info(_device, NVML_CLOCK_MEM, &value) == 0) {
+      stats.memory_clock_MHz = value;
+      success = true;
+    }
+    if (_nvml.power_usage(_device, &value) == 0) {
+      // mW
+      stats.power_W = value / 1000.0;
+      success = true;
+    }
+    if (_nvml.temperature(_device, NVML_TEMPERATURE_GPU, &value) == 0) {
+      stats.temperature_C = value;
+      success = true;
+    }
+    return success;
+  }
+
+ private:
+  const Nvml& _nvml;
+  nvmlDevice_t _device;
+};
+
+// --- sysfs ---
+
+// amdgpu, i915, xe and every driver with hwmon sensors. Attributes the driver does not provide are not opened.
+class SysfsBackend : public Backend {
+ public:
+  explicit SysfsBackend(const std::string& device_path) {
+    // amdgpu
+    _busy_percent = filesystem::CachedFile(device_path + "gpu_busy_percent");
+    _vram_used_Bytes = filesystem::CachedFile(device_path + "mem_info_vram_used");
+    _vram_total_Bytes = filesystem::CachedFile(device_path + "mem_info_vram_total");
+    // i915 (per DRM card) and xe (per tile and GT)
+    for (const auto& entry : filesystem::getDirectoryEntries(device_path + "drm")) {
+      if (entry.compare(0, 4, "card") == 0) {
+        _act_freq_MHz = filesystem::CachedFile(device_path + "drm/" + entry + "/gt_act_freq_mhz");
+        break;
+      }
+    }
+    if (!_act_freq_MHz.valid()) {
+      _act_freq_MHz = filesystem::CachedFile(device_path + "tile0/gt0/freq0/act_freq");
+    }
+    // the first (and usually only) hwmon device
+    for (const auto& entry : filesystem::getDirectoryEntries(device_path + "hwmon")) {
+      const std::string hwmon = device_path + "hwmon/" + entry + '/';
+      _core_clock_Hz = filesystem::CachedFile(hwmon + "freq1_input");
+      _memory_clock_Hz = filesystem::CachedFile(hwmon + "freq2_input");
+      _power_uW = filesystem::CachedFile(hwmon + "power1_average");
+      if (!_power_uW.valid()) {
+        _power_uW = filesystem::CachedFile(hwmon + "power1_input");
+      }
+      if (!_power_uW.valid()) {
+        _energy_uJ = filesystem::CachedFile(hwmon + "energy1_input");
+      }
+      _temperature_mC = filesystem::CachedFile(hwmon + "temp1_input");
+      break;
+    }
+  }
+
+  HWI_NODISCARD bool empty() const {
+    return !_busy_percent.valid() && !_vram_used_Bytes.valid() && !_act_freq_MHz.valid() && !_core_clock_Hz.valid() &&
+           !_power_uW.valid() && !_energy_uJ.valid() && !_temperature_mC.valid();
+  }
+
+  bool read(int64_t now_ns, GPUStats& stats) override {
+    bool success = false;
+    int64_t value = 0;
+    const auto read_value = [&success, &value](const filesystem::CachedFile& file) {
+      const bool valid = file.valid() && file.read_int64(value);
+      success = success || valid;
+      return valid;
+    };
+    if (read_value(_busy_percent)) stats.utilisation = static_cast<double>(value) / 100.0;
+    if (read_value(_vram_used_Bytes)) stats.memory_used_Bytes = value;
+    if (read_value(_vram_total_Bytes)) stats.memory_total_Bytes = value;
+    if (read_value(_act_freq_MHz)) {
+      stats.core_clock_MHz = value;
+    } else if (read_value(_core_clock_Hz)) {
+      stats.core_clock_MHz = value / 1000000;
+    }
+    if (read_value(_memory_clock_Hz)) stats.memory_clock_MHz = value / 1000000;
+    if (read_value(_power_uW)) {
+      stats.power_W = static_cast<double>(value) / 1e6;
+    } else if (read_value(_energy_uJ)) {
+      if (_last_energy_uJ >= 0 && value >= _last_energy_uJ && now_ns > _last_energy_ns) {
+        // µJ / ns = kW
+        const auto period_ns = static_cast<double>(now_ns - _last_energy_ns);
+        stats.power_W = static_cast<double>(value - _last_energy_uJ) * 1e3 / period_ns;
+      }
+      _last_energy_uJ = value;
+      _last_energy_ns = now_ns;
+    }
+    if (read_value(_temperature_mC)) stats.temperature_C = static_cast<double>(value) / 1000.0;
+    return success;
+  }
+
+ private:
+  filesystem::CachedFile _busy_percent;
+  filesystem::CachedFile _vram_used_Bytes;
+  filesystem::CachedFile _vram_total_Bytes;
+  filesystem::CachedFile _act_freq_MHz;
+  filesystem::CachedFile _core_clock_Hz;
+  filesystem::CachedFile _memory_clock_Hz;
+  filesystem::CachedFile _power_uW;
+  filesystem::CachedFile _energy_uJ;
+  filesystem::CachedFile _temperature_mC;
+  int64_t _last_energy_uJ{-1};
+  int64_t _last_energy_ns{-1};
+};
+
+// _____________________________________________________________________________________________________________________
+// NVML for NVIDIA GPUs it knows, sysfs otherwise. nullptr if neither provides anything.
+std::unique_ptr<Backend> make_backend(const std::string& pci_bus_id) {
+  if (pci_bus_id.empty()) {
+    return nullptr;
+  }
+  const std::string path = pci_devices_path + pci_bus_id + '/';
+  std::string vendor;
+  if (filesystem::Directory(path).read("vendor", vendor) && vendor == "0x10de") {
+    // the library is only loaded once an NVIDIA GPU is sampled
+    const Nvml* nvml = Nvml::get();
+    nvmlDevice_t device = nullptr;
+    if (nvml != nullptr && nvml->handle_by_pci_bus_id(pci_bus_id.c_str(), &device) == 0) {
+      return std::make_unique<NvmlBackend>(*nvml, device);
+    }
+  }
+  auto sysfs = std::make_unique<SysfsBackend>(path);
+  return sysfs->empty() ? nullptr : std::move(sysfs);
+}
+
+}  // namespace
+
+struct GPUStatsSampler::Source {
+  // one per sampled GPU, nullptr if nothing can be read
+  std::vector<std::unique_ptr<Backend>> backends;
+};
+
+// _____________________________________________________________________________________________________________________
+GPUStatsSampler::GPUStatsSampler(std::vector<std::string> pci_bus_ids)
+    : _pci_bus_ids(std::move(pci_bus_ids)), _source(new Source()), _stats(_pci_bus_ids.size()) {
+  for (const auto& pci_bus_id : _pci_bus_ids) {
+    _source->backends.push_back(make_backend(pci_bus_id));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+GPUStatsSampler::~GPUStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool GPUStatsSampler::read_stats(int64_t now_ns) {
+  bool success = false;
+  for (size_t i = 0; i < _stats.size(); ++i) {
+    if (_source->backends[i] && _source->backends[i]->read(now_ns, _stats[i])) {
+      success = true;
+    }
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -0,0 +1,256 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/interrupts.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// OS cpu id of every column from the header line ("           CPU0       CPU1       CPU3"). Offline cpus have no
+// column in /proc/interrupts, /proc/softirqs lists all possible cpus. Returns false if there is no header.
+bool parseColumns(utils::NumberScanner& scanner, std::vector<int32_t>& columns) {
+  columns.clear();
+  for (std::string_view word = scanner.next_word(); !word.empty(); word = scanner.next_word()) {
+    int32_t cpu = -1;
+    if (word.compare(0, 3, "CPU") != 0 || !utils::parse_int(word.substr(3), cpu, true) || cpu < 0) {
+      return false;
+    }
+    columns.push_back(cpu);
+  }
+  return !columns.empty();
+}
+
+// _____________________________________________________________________________________________________________________
+// True if column i is cpu i, the rows can then be read straight into the matrix.
+bool isDense(const std::vector<int32_t>& columns) {
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (columns[i] != static_cast<int32_t>(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+// Reads the counters of the current row into row (num_cpus values, -1 for cpus without a column). scratch holds at
+// least columns.size() values.
+void readRow(utils::NumberScanner& scanner, const std::vector<int32_t>& columns, bool dense, int64_t* row,
+             size_t num_cpus, int64_t* scratch) {
+  std::fill_n(row, num_cpus, -1);
+  if (dense) {
+    scanner.read_uints(row, columns.size());
+    return;
+  }
+  const size_t n = scanner.read_uints(scratch, columns.size());
+  for (size_t i = 0; i < n; ++i) {
+    row[columns[i]] = scratch[i];
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+// First word of a row without the colon ("24:" -> "24", "NET_RX:" -> "NET_RX").
+std::string_view rowName(utils::NumberScanner& scanner) {
+  std::string_view name = scanner.next_word();
+  if (!name.empty() && name.back() == ':') {
+    name.remove_suffix(1);
+  }
+  return name;
+}
+
+// _____________________________________________________________________________________________________________________
+std::string_view trimLeft(std::string_view value) {
+  while (!value.empty() && utils::is_blank(value.front())) {
+    value.remove_prefix(1);
+  }
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+// IRQs of the device behind a sysfs device link (/sys/class/net/eth0/device): the msi_irqs (MSI and MSI-X vectors) or
+// the legacy irq of the device or of its closest parent that has them. virtio and nvme devices sit directly below their
+// PCI function, SATA disks a few levels below the host controller.
+std::vector<int32_t> deviceIrqs(std::string path) {
+  for (int depth = 0; depth < 5; ++depth, path += "/..") {
+    if (!filesystem::exists(path)) {
+      break;
+    }
+    std::vector<int32_t> irqs;
+    for (const std::string& entry : filesystem::getDirectoryEntries(path + "/msi_irqs")) {
+      int32_t irq = -1;
+      if (utils::parse_int(entry, irq, true)) {
+        irqs.push_back(irq);
+      }
+    }
+    if (!irqs.empty()) {
+      return irqs;
+    }
+    int64_t irq = 0;
+    if (filesystem::CachedFile(path + "/irq").read_int64(irq) && irq > 0) {
+      return {static_cast<int32_t>(irq)};
+    }
+  }
+  return {};
+}
+
+// _____________________________________________________________________________________________________________________
+// Sets owner and devices of every line with an IRQ number that belongs to a network interface or a disk.
+void resolveOwners(std::vector<InterruptLine>& lines) {
+  std::unordered_map<int32_t, size_t> line_of;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    lines[i].owner = InterruptOwner::None;
+    lines[i].devices.clear();
+    if (lines[i].irq >= 0) {
+      line_of.emplace(lines[i].irq, i);
+    }
+  }
+  const auto assign = [&](InterruptOwner owner, const std::string& device, const std::string& link) {
+    for (int32_t irq : deviceIrqs(link)) {
+      auto it = line_of.find(irq);
+      if (it == line_of.end()) {
+        continue;
+      }
+      InterruptLine& line = lines[it->second];
+      if (line.owner == InterruptOwner::None) {
+        line.owner = owner;
+      }
+      line.devices.push_back(device);
+    }
+  };
+  for (const std::string& interface : filesystem::getDirectoryEntries("/sys/class/net")) {
+    assign(InterruptOwner::Network, interface, "/sys/class/net/" + interface + "/device");
+  }
+  for (const std::string& disk : filesystem::getDirectoryEntries("/sys/block")) {
+    assign(InterruptOwner::Disk, disk, "/sys/block/" + disk + "/device");
+  }
+}
+
+}  // namespace
+
+struct InterruptSampler::Source {
+  filesystem::CachedFile interrupts{std::string("/proc/interrupts")};
+  filesystem::CachedFile softirqs{std::string("/proc/softirqs")};
+  std::string interrupts_buffer;
+  std::string softirqs_buffer;
+  std::vector<int32_t> interrupt_columns;
+  std::vector<int32_t> softirq_columns;
+  // one row of a file with columns that are not the cpu ids
+  std::vector<int64_t> scratch;
+};
+
+// _____________________________________________________________________________________________________________________
+InterruptSampler::InterruptSampler() : _source(std::make_unique<Source>()) {}
+
+// _____________________________________________________________________________________________________________________
+InterruptSampler::~InterruptSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool InterruptSampler::read_counters() {
+  Source& source = *_source;
+  // on 256 cpus /proc/interrupts is a few MB, the buffers keep their capacity
+  bool has_interrupts = source.interrupts.read(source.interrupts_buffer);
+  bool has_softirqs = source.softirqs.read(source.softirqs_buffer);
+  utils::NumberScanner interrupts(source.interrupts_buffer);
+  utils::NumberScanner softirqs(source.softirqs_buffer);
+  has_interrupts = has_interrupts && parseColumns(interrupts, source.interrupt_columns);
+  has_softirqs = has_softirqs && parseColumns(softirqs, source.softirq_columns);
+  if (!has_interrupts) {
+    source.interrupt_columns.clear();
+  }
+  if (!has_softirqs) {
+    source.softirq_columns.clear();
+  }
+
+  size_t num_cpus = 0;
+  for (const auto* columns : {&source.interrupt_columns, &source.softirq_columns}) {
+    for (int32_t cpu : *columns) {
+      num_cpus = std::max(num_cpus, static_cast<size_t>(cpu) + 1);
+    }
+  }
+  if (num_cpus != _num_cpus) {
+    _num_cpus = num_cpus;
+    _layout_changed = true;
+  }
+  source.scratch.resize(std::max(source.interrupt_columns.size(), source.softirq_columns.size()));
+
+  // interrupt lines: the rows only change when drivers request or free interrupts
+  const bool interrupts_dense = isDense(source.interrupt_columns);
+  size_t rows = 0;
+  bool lines_changed = false;
+  while (has_interrupts && interrupts.next_line()) {
+    const std::string_view name = rowName(interrupts);
+    if (name.empty()) {
+      continue;
+    }
+    _counts.resize((rows + 1) * _num_cpus);
+    readRow(interrupts, source.interrupt_columns, interrupts_dense, _counts.data() + rows * _num_cpus, _num_cpus,
+            source.scratch.data());
+    const std::string_view description = trimLeft(interrupts.rest_of_line());
+    if (rows == _lines.size()) {
+      _lines.emplace_back();
+    }
+    InterruptLine& line = _lines[rows];
+    if (line.name != name || line.description != description) {
+      line.name.assign(name);
+      line.description.assign(description);
+      line.irq = -1;
+      utils::parse_int(name, line.irq, true);
+      lines_changed = true;
+    }
+    ++rows;
+  }
+  _counts.resize(rows * _num_cpus);
+  if (rows != _lines.size()) {
+    _lines.resize(rows);
+    lines_changed = true;
+  }
+  if (lines_changed) {
+    resolveOwners(_lines);
+    _layout_changed = true;
+  }
+
+  const bool softirqs_dense = isDense(source.softirq_columns);
+  rows = 0;
+  while (has_softirqs && softirqs.next_line()) {
+    const std::string_view name = rowName(softirqs);
+    if (name.empty()) {
+      continue;
+    }
+    _softirq_counts.resize((rows + 1) * _num_cpus);
+    readRow(softirqs, source.softirq_columns, softirqs_dense, _softirq_counts.data() + rows * _num_cpus, _num_cpus,
+            source.scratch.data());
+    if (rows == _softirq_names.size()) {
+      _softirq_names.emplace_back();
+    }
+    if (_softirq_names[rows] != name) {
+      _softirq_names[rows].assign(name);
+      _layout_changed = true;
+    }
+    ++rows;
+  }
+  _softirq_counts.resize(rows * _num_cpus);
+  if (rows != _softirq_names.size()) {
+    _softirq_names.resize(rows);
+    _layout_changed = true;
+  }
+  return has_interrupts || has_softirqs;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
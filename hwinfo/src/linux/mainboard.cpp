@@ -5,26 +5,22 @@
 
 #ifdef HWINFO_UNIX
 
-#include <fstream>
-#include <vector>
+#include <string>
+#include <utility>
 
 #include "hwinfo/mainboard.h"
+#include "hwinfo/utils/filesystem.h"
+#include "hwinfo/utils/smbios.h"
+#include "hwinfo/utils/trace.h"
 
 namespace hwinfo {
 
 std::string get_dmi_by_name(const std::string& name) {
+  static const char* const candidates[] = {"/sys/devices/virtual/dmi/id/", "/sys/class/dmi/id/"};
   std::string value;
-  std::vector<std::string> candidates = {"/sys/devices/virtual/dmi/", "/sys/class/dmi/"};
-  for (const auto& path : candidates) {
-    std::string full_path(path);
-    full_path.append("id/");
-    full_path.append(name);
-    std::ifstream f(full_path);
-    if (f) {
-      getline(f, value);
-      if (!value.empty()) {
-        return value;
-      }
+  for (const char* path : candidates) {
+    if (filesystem::Directory(path).read(name.c_str(), value)) {
+      return value;
     }
   }
   return "<unknown>";
@@ -32,10 +28,25 @@ std::string get_dmi_by_name(const std::string& name) {
 
 // _____________________________________________________________________________________________________________________
 MainBoard::MainBoard() {
+  HWINFO_TRACE_SCOPE(MainBoard);
+  if (static_cache::load(*this)) {
+    return;
+  }
+  // the SMBIOS table (root only) has all fields at once, including the serial number
+  smbios::BoardInfo board;
+  if (smbios::baseboard(smbios::system_table(), board)) {
+    _vendor = std::move(board.vendor);
+    _name = std::move(board.name);
+    _version = std::move(board.version);
+    _serialNumber = std::move(board.serial_number);
+    static_cache::store(*this);
+    return;
+  }
   _vendor = get_dmi_by_name("board_vendor");
   _name = get_dmi_by_name("board_name");
   _version = get_dmi_by_name("board_version");
   _serialNumber = get_dmi_by_name("board_serial");
+  static_cache::store(*this);
 }
 
 }  // namespace hwinfo
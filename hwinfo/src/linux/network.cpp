@@ -3,101 +3,163 @@
 #ifdef HWINFO_UNIX
 #include <arpa/inet.h>
 #include <hwinfo/network.h>
+#include <hwinfo/utils/trace.h>
 #include <ifaddrs.h>
 #include <net/if.h>
+#include <netinet/in.h>
 #include <netpacket/packet.h>
-#include <sys/ioctl.h>
 
+#include <cstdio>
 #include <cstring>
-#include <fstream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace hwinfo {
 
-std::string getInterfaceIndex(const std::string& path) {
-  int index = if_nametoindex(path.c_str());
-  return (index > 0) ? std::to_string(index) : "<unknown>";
-}
-
-std::string getDescription(const std::string& path) { return path; }
+namespace {
 
-std::string getMac(const std::string& path) {
-  std::ifstream file("/sys/class/net/" + path + "/address");
-  std::string mac;
-  if (file.is_open()) {
-    std::getline(file, mac);
-    file.close();
+// _____________________________________________________________________________________________________________________
+// Hardware address of a link as "aa:bb:cc:dd:ee:ff", "<unknown>" if the link has none (e.g. tun devices).
+std::string formatMac(const sockaddr_ll& link) {
+  if (link.sll_halen == 0 || link.sll_halen > sizeof(link.sll_addr)) {
+    return "<unknown>";
   }
-  return mac.empty() ? "<unknown>" : mac;
+  std::string mac(link.sll_halen * 3 - 1, ':');
+  for (size_t i = 0; i < link.sll_halen; ++i) {
+    char hex[3];
+    std::snprintf(hex, sizeof(hex), "%02x", link.sll_addr[i]);
+    mac[i * 3] = hex[0];
+    mac[i * 3 + 1] = hex[1];
+  }
+  return mac;
 }
 
-std::string getIp4(const std::string& interface) {
-  std::string ip4 = "<unknown>";
-  struct ifaddrs* ifaddr;
-  if (getifaddrs(&ifaddr) == -1) {
-    return ip4;
+}  // namespace
+
+// Position in the interface list: the names of if_nameindex() if no attribute was requested, the links of the
+// getifaddrs() list otherwise.
+struct NetworkEnumerator::Source {
+  NetworkFields fields{NetworkFields::None};
+  struct if_nameindex* names{nullptr};
+  const struct if_nameindex* name{nullptr};
+  struct ifaddrs* ifaddr{nullptr};
+  const struct ifaddrs* link{nullptr};
+  // the address entries of every interface, in list order; only built if the addresses were requested
+  std::unordered_map<std::string_view, std::vector<const struct ifaddrs*>> addresses;
+
+  ~Source() {
+    if (names != nullptr) {
+      if_freenameindex(names);
+    }
+    if (ifaddr != nullptr) {
+      freeifaddrs(ifaddr);
+    }
   }
+};
 
-  for (struct ifaddrs* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+// _____________________________________________________________________________________________________________________
+NetworkEnumerator::NetworkEnumerator(NetworkFields fields) : _source(std::make_unique<Source>()) {
+  Source& source = *_source;
+  source.fields = fields;
+  if (fields == NetworkFields::None) {
+    // names and indices only: one RTM_GETLINK dump without the addresses
+    source.names = if_nameindex();
+    source.name = source.names;
+    return;
+  }
+  // glibc builds the list from one RTM_GETLINK and one RTM_GETADDR netlink dump
+  if (getifaddrs(&source.ifaddr) == -1) {
+    perror("getifaddrs");
+    source.ifaddr = nullptr;
+    return;
+  }
+  source.link = source.ifaddr;
+  if (!contains(fields, NetworkFields::Addresses)) {
+    return;
+  }
+  // links (AF_PACKET entries) come first, the addresses of all links follow
+  for (const struct ifaddrs* ifa = source.ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
     if (ifa->ifa_addr == nullptr) continue;
-    if (ifa->ifa_addr->sa_family == AF_INET && interface == ifa->ifa_name) {
-      char ip[INET_ADDRSTRLEN];
-      inet_ntop(AF_INET, &((struct sockaddr_in*)ifa->ifa_addr)->sin_addr, ip, sizeof(ip));
-      ip4 = ip;
-      break;
-    }
+    const int family = ifa->ifa_addr->sa_family;
+    if (family != AF_INET && family != AF_INET6) continue;
+    source.addresses[ifa->ifa_name].push_back(ifa);
   }
-  freeifaddrs(ifaddr);
-  return ip4;
 }
 
-std::string getIp6(const std::string& interface) {
-  std::string ip6 = "<unknown>";
-  struct ifaddrs* ifaddr;
-  if (getifaddrs(&ifaddr) == -1) {
-    return ip6;
-  }
+// _____________________________________________________________________________________________________________________
+NetworkEnumerator::~NetworkEnumerator() = default;
 
-  for (struct ifaddrs* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-    if (ifa->ifa_addr == nullptr) {
-      continue;
+// _____________________________________________________________________________________________________________________
+std::optional<Network> NetworkEnumerator::next() {
+  Source& source = *_source;
+  if (source.name != nullptr) {
+    if (source.name->if_index == 0 && source.name->if_name == nullptr) {
+      return std::nullopt;
     }
-    if (ifa->ifa_addr->sa_family == AF_INET6 && interface == ifa->ifa_name) {
+    Network network;
+    network._index = std::to_string(source.name->if_index);
+    network._description = source.name->if_name;
+    ++source.name;
+    return network;
+  }
+
+  while (source.link != nullptr &&
+         (source.link->ifa_addr == nullptr || source.link->ifa_addr->sa_family != AF_PACKET)) {
+    source.link = source.link->ifa_next;
+  }
+  if (source.link == nullptr) {
+    return std::nullopt;
+  }
+  const struct ifaddrs* ifa = source.link;
+  source.link = ifa->ifa_next;
+  const auto& link = *reinterpret_cast<const sockaddr_ll*>(ifa->ifa_addr);
+  Network network;
+  network._index = link.sll_ifindex > 0 ? std::to_string(link.sll_ifindex) : "<unknown>";
+  network._description = ifa->ifa_name;
+  if (contains(source.fields, NetworkFields::Mac)) {
+    network._mac = formatMac(link);
+  }
+  if (!contains(source.fields, NetworkFields::Addresses)) {
+    return network;
+  }
+
+  const auto it = source.addresses.find(ifa->ifa_name);
+  if (it != source.addresses.end()) {
+    for (const struct ifaddrs* address : it->second) {
       char ip[INET6_ADDRSTRLEN];
-      inet_ntop(AF_INET6, &((struct sockaddr_in6*)ifa->ifa_addr)->sin6_addr, ip, sizeof(ip));
-      if (std::strncmp(ip, "fe80", 4) == 0) {
-        ip6 = ip;
-        break;
+      if (address->ifa_addr->sa_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(address->ifa_addr)->sin_addr, ip, sizeof(ip));
+        network._ip4s.emplace_back(ip);
+      } else {
+        inet_ntop(AF_INET6, &reinterpret_cast<const sockaddr_in6*>(address->ifa_addr)->sin6_addr, ip, sizeof(ip));
+        network._ip6s.emplace_back(ip);
       }
     }
   }
-  freeifaddrs(ifaddr);
-  return ip6;
+  network._ip4 = network._ip4s.empty() ? "<unknown>" : network._ip4s.front();
+  // the link-local address as before, if there is one
+  network._ip6 = network._ip6s.empty() ? "<unknown>" : network._ip6s.front();
+  for (const auto& ip : network._ip6s) {
+    if (std::strncmp(ip.c_str(), "fe80", 4) == 0) {
+      network._ip6 = ip;
+      break;
+    }
+  }
+  return network;
 }
 
-std::vector<Network> getAllNetworks() {
+// _____________________________________________________________________________________________________________________
+std::vector<Network> getAllNetworks(NetworkFields fields) {
+  HWINFO_TRACE_SCOPE(Network);
   std::vector<Network> networks;
-  struct ifaddrs* ifaddr;
-  if (getifaddrs(&ifaddr) == -1) {
-    perror("getifaddrs");
-    return networks;
-  }
-
-  for (struct ifaddrs* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-    if (ifa->ifa_addr == nullptr) continue;
-    if (ifa->ifa_addr->sa_family != AF_PACKET) continue;
-
-    std::string interface = ifa->ifa_name;
-    Network network;
-    network._index = getInterfaceIndex(interface);
-    network._description = getDescription(interface);
-    network._mac = getMac(interface);
-    network._ip4 = getIp4(interface);
-    network._ip6 = getIp6(interface);
-    networks.push_back(std::move(network));
+  NetworkEnumerator enumerator(fields);
+  while (auto network = enumerator.next()) {
+    networks.push_back(std::move(*network));
   }
-  freeifaddrs(ifaddr);
   return networks;
 }
 
@@ -0,0 +1,93 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/network_stats.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+#include <net/if.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+struct NetworkStatsSampler::Source {
+  filesystem::CachedFile file{"/proc/net/dev"};
+  std::string buffer;
+  // /proc/net/dev lists the interfaces by name
+  std::vector<std::string> names;
+  // name (viewing into names) -> index into the sampled interfaces
+  std::unordered_map<std::string_view, size_t> index;
+};
+
+// _____________________________________________________________________________________________________________________
+NetworkStatsSampler::NetworkStatsSampler(std::vector<int> interface_indices)
+    : _interface_indices(std::move(interface_indices)),
+      _source(new Source()),
+      _previous(_interface_indices.size()),
+      _current(_interface_indices.size()),
+      _stats(_interface_indices.size()) {
+  _source->names.resize(_interface_indices.size());
+  for (size_t i = 0; i < _interface_indices.size(); ++i) {
+    char name[IF_NAMESIZE];
+    if (_interface_indices[i] > 0 && if_indextoname(static_cast<unsigned>(_interface_indices[i]), name) != nullptr) {
+      _source->names[i] = name;
+      _source->index.emplace(_source->names[i], i);
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+NetworkStatsSampler::~NetworkStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool NetworkStatsSampler::read_counters() {
+  if (!_source->file.read(_source->buffer)) {
+    return false;
+  }
+  // two header lines, then "  eth0: rx_bytes packets errs drop fifo frame compressed multicast tx_bytes packets errs
+  // drop fifo colls carrier compressed" (no blank after the colon if the number fills the column)
+  utils::NumberScanner scanner(_source->buffer);
+  if (!scanner.next_line() || !scanner.next_line()) {
+    return false;
+  }
+  do {
+    std::string_view name = scanner.rest_of_line();
+    if (!scanner.skip_past(':')) {
+      continue;
+    }
+    name = name.substr(0, static_cast<size_t>(scanner.position() - 1 - name.data()));
+    while (!name.empty() && name.front() == ' ') {
+      name.remove_prefix(1);
+    }
+    const auto it = _source->index.find(name);
+    if (it == _source->index.end()) {
+      continue;
+    }
+    int64_t fields[12];
+    if (scanner.read_uints(fields, 12) != 12) {
+      continue;
+    }
+    Counters& counters = _current[it->second];
+    counters.rx_Bytes = fields[0];
+    counters.rx_packets = fields[1];
+    counters.rx_errors = fields[2];
+    counters.rx_drops = fields[3];
+    counters.tx_Bytes = fields[8];
+    counters.tx_packets = fields[9];
+    counters.tx_errors = fields[10];
+    counters.tx_drops = fields[11];
+  } while (scanner.next_line());
+  return true;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
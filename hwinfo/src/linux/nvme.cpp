@@ -0,0 +1,238 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <fcntl.h>
+#include <hwinfo/nvme.h>
+#include <hwinfo/utils/filesystem.h>
+#include <linux/nvme_ioctl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+const std::string nvme_path = "/sys/class/nvme/";
+
+// admin opcodes, identify CNS and log page identifier of the NVMe base specification
+constexpr uint8_t admin_get_log_page = 0x02;
+constexpr uint8_t admin_identify = 0x06;
+constexpr uint32_t identify_controller = 0x01;
+constexpr uint32_t log_smart_health = 0x02;
+constexpr uint32_t all_namespaces = 0xffffffff;
+constexpr size_t identify_size = 4096;
+constexpr size_t smart_log_size = 512;
+// data units are thousands of 512 byte blocks
+constexpr int64_t data_unit_Bytes = 512 * 1000;
+
+// _____________________________________________________________________________________________________________________
+// nvme2 < nvme10
+bool numericOrder(const std::string& a, const std::string& b) {
+  return a.size() != b.size() ? a.size() < b.size() : a < b;
+}
+
+// _____________________________________________________________________________________________________________________
+bool isDigits(std::string_view value) {
+  return !value.empty() && std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+// _____________________________________________________________________________________________________________________
+// "nvme0n1" or, with native multipath, "nvme0c0n1" below the controller "nvme0".
+bool isNamespace(std::string_view entry, std::string_view controller) {
+  if (entry.compare(0, controller.size(), controller) != 0) {
+    return false;
+  }
+  entry.remove_prefix(controller.size());
+  if (!entry.empty() && entry.front() == 'c') {
+    const size_t n = entry.find('n');
+    if (n == std::string_view::npos || !isDigits(entry.substr(1, n - 1))) {
+      return false;
+    }
+    entry.remove_prefix(n);
+  }
+  return !entry.empty() && entry.front() == 'n' && isDigits(entry.substr(1));
+}
+
+// _____________________________________________________________________________________________________________________
+bool adminCommand(int fd, uint8_t opcode, uint32_t nsid, uint32_t cdw10, void* data, size_t size) {
+  nvme_admin_cmd command{};
+  command.opcode = opcode;
+  command.nsid = nsid;
+  command.addr = reinterpret_cast<uintptr_t>(data);
+  command.data_len = static_cast<uint32_t>(size);
+  command.cdw10 = cdw10;
+  // > 0 is the status of a command the controller rejected
+  return ioctl(fd, NVME_IOCTL_ADMIN_CMD, &command) == 0;
+}
+
+// _____________________________________________________________________________________________________________________
+uint16_t le16(const uint8_t* data) { return static_cast<uint16_t>(data[0] | (data[1] << 8)); }
+
+// _____________________________________________________________________________________________________________________
+// Little endian 128 bit counter, saturated at INT64_MAX.
+int64_t le128(const uint8_t* data) {
+  uint64_t low = 0;
+  uint64_t high = 0;
+  for (int i = 7; i >= 0; --i) {
+    low = (low << 8) | data[i];
+    high = (high << 8) | data[8 + i];
+  }
+  constexpr auto max = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+  return high != 0 || low > max ? std::numeric_limits<int64_t>::max() : static_cast<int64_t>(low);
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t dataUnitsToBytes(int64_t units) {
+  return units > std::numeric_limits<int64_t>::max() / data_unit_Bytes ? std::numeric_limits<int64_t>::max()
+                                                                         : units * data_unit_Bytes;
+}
+
+// _____________________________________________________________________________________________________________________
+// Space padded ASCII field of the identify data.
+std::string_view asciiField(const uint8_t* data, size_t size) {
+  std::string_view value(reinterpret_cast<const char*>(data), size);
+  while (!value.empty() && (value.back() == ' ' || value.back() == '\0')) {
+    value.remove_suffix(1);
+  }
+  while (!value.empty() && value.front() == ' ') {
+    value.remove_prefix(1);
+  }
+  return value;
+}
+
+// _____________________________________________________________________________________________________________________
+InternedString readOrUnknown(const filesystem::Directory& dir, const char* name) {
+  std::string value;
+  return dir.read(name, value) ? InternedString(value) : InternedString("<unknown>");
+}
+
+// _____________________________________________________________________________________________________________________
+// Fills the controller from the Identify Controller data, see the NVMe base specification.
+bool identify(int fd, NvmeController& controller) {
+  std::array<uint8_t, identify_size> data{};
+  if (fd < 0 || !adminCommand(fd, admin_identify, 0, identify_controller, data.data(), data.size())) {
+    return false;
+  }
+  char vendor[8];
+  std::snprintf(vendor, sizeof(vendor), "0x%04x", le16(data.data()));
+  controller.vendor = vendor;
+  controller.serial_number = asciiField(data.data() + 4, 20);
+  controller.model = asciiField(data.data() + 24, 40);
+  controller.firmware_version = asciiField(data.data() + 64, 8);
+  // 0 if the controller does not support namespace management
+  const int64_t total = le128(data.data() + 280);
+  if (total > 0) {
+    controller.total_capacity_Bytes = total;
+    controller.unallocated_capacity_Bytes = le128(data.data() + 296);
+  }
+  controller.identified = true;
+  return true;
+}
+
+}  // namespace
+
+// =====================================================================================================================
+struct NvmeSampler::Source {
+  // character device of every controller, -1 if it could not be opened
+  std::vector<int> fds;
+
+  Source() = default;
+  Source(const Source&) = delete;
+  Source& operator=(const Source&) = delete;
+  ~Source() {
+    for (const int fd : fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+NvmeSampler::NvmeSampler(std::chrono::nanoseconds refresh) : _refresh(refresh), _source(new Source()) {
+  std::vector<std::string> names;
+  for (auto& entry : filesystem::getDirectoryEntries(nvme_path)) {
+    if (entry.compare(0, 4, "nvme") == 0 && isDigits(std::string_view(entry).substr(4))) {
+      names.push_back(std::move(entry));
+    }
+  }
+  std::sort(names.begin(), names.end(), numericOrder);
+  for (auto& name : names) {
+    const std::string path = nvme_path + name;
+    const int fd = filesystem::open_path(("/dev/" + name).c_str(), O_RDONLY);
+    NvmeController controller;
+    if (!identify(fd, controller)) {
+      // attributes of the kernel's own identify at probe time, readable without privileges
+      const filesystem::Directory dir(path);
+      controller.vendor = readOrUnknown(dir, "device/vendor");
+      controller.model = readOrUnknown(dir, "model");
+      controller.serial_number = readOrUnknown(dir, "serial");
+      controller.firmware_version = readOrUnknown(dir, "firmware_rev");
+    }
+    for (auto& entry : filesystem::getDirectoryEntries(path)) {
+      if (isNamespace(entry, name)) {
+        controller.namespaces.push_back(std::move(entry));
+      }
+    }
+    std::sort(controller.namespaces.begin(), controller.namespaces.end(), numericOrder);
+    controller.name = std::move(name);
+    _controllers.push_back(std::move(controller));
+    _source->fds.push_back(fd);
+  }
+  _health.resize(_controllers.size());
+  _attempt_ns.assign(_controllers.size(), -1);
+}
+
+// _____________________________________________________________________________________________________________________
+NvmeSampler::~NvmeSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool NvmeSampler::read_health(size_t i, NvmeHealth& health) {
+  const int fd = _source->fds[i];
+  std::array<uint8_t, smart_log_size> log{};
+  // number of dwords - 1 in the upper half of cdw10, the log identifier in the lower byte
+  const uint32_t cdw10 = static_cast<uint32_t>(log.size() / 4 - 1) << 16 | log_smart_health;
+  if (fd < 0 || !adminCommand(fd, admin_get_log_page, all_namespaces, cdw10, log.data(), log.size())) {
+    return false;
+  }
+  const uint8_t* data = log.data();
+  health.critical_warning = data[0];
+  // Kelvin, 0 if not reported
+  const uint16_t temperature_K = le16(data + 1);
+  if (temperature_K != 0) {
+    health.temperature_C = temperature_K - 273.15;
+  }
+  health.available_spare_percent = data[3];
+  health.available_spare_threshold_percent = data[4];
+  health.percentage_used = data[5];
+  health.data_read_Bytes = dataUnitsToBytes(le128(data + 32));
+  health.data_written_Bytes = dataUnitsToBytes(le128(data + 48));
+  health.host_read_commands = le128(data + 64);
+  health.host_write_commands = le128(data + 80);
+  health.controller_busy_minutes = le128(data + 96);
+  health.power_cycles = le128(data + 112);
+  health.power_on_hours = le128(data + 128);
+  health.unsafe_shutdowns = le128(data + 144);
+  health.media_errors = le128(data + 160);
+  health.error_log_entries = le128(data + 176);
+  return true;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
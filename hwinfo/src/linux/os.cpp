@@ -5,51 +5,58 @@
 
 #ifdef HWINFO_UNIX
 
-#include <sys/stat.h>
 #include <sys/utsname.h>
 
-#include <fstream>
 #include <string>
+#include <string_view>
 
 #include "hwinfo/os.h"
+#include "hwinfo/utils/filesystem.h"
 #include "hwinfo/utils/stringutils.h"
+#include "hwinfo/utils/trace.h"
 
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
 OS::OS() {
+  HWINFO_TRACE_SCOPE(OS);
   {  // name and version
-    std::string line;
-    std::ifstream stream("/etc/os-release");
-    if (!stream) {
+    filesystem::LineReader reader("/etc/os-release");
+    if (!reader.valid()) {
       _name = "Linux";
       _version = "<unknown>";
     }
-    while (std::getline(stream, line)) {
-      if (utils::starts_with(line, "PRETTY_NAME")) {
-        line = line.substr(line.find('=') + 1, line.length());
-        // remove \" at begin and end of the substring result
-        _name = {line.begin() + 1, line.end() - 1};
+    std::string_view line;
+    while (reader.next(line)) {
+      const size_t eq = line.find('=');
+      if (eq == std::string_view::npos) {
+        continue;
       }
-      if (utils::starts_with(line, "VERSION=")) {
-        line = line.substr(line.find('=') + 1, line.length());
-        // remove \" at begin and end of the substring result
-        _version = {line.begin() + 1, line.end() - 1};
+      const std::string_view key = line.substr(0, eq);
+      if (key != "PRETTY_NAME" && key != "VERSION") {
+        continue;
       }
+      std::string_view value = utils::strip_view(line.substr(eq + 1));
+      // remove the quotes around the value
+      if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+        value = value.substr(1, value.size() - 2);
+      }
+      (key == "PRETTY_NAME" ? _name : _version) = value;
     }
-    stream.close();
   }
-  {  // Kernel
+  {  // Kernel: uname() describes the running kernel, the release file that of the tree below another root
+    std::string release;
     static utsname info;
-    if (uname(&info) == 0) {
+    if (filesystem::root() != "/" && filesystem::CachedFile("/proc/sys/kernel/osrelease").read(release)) {
+      _kernel = utils::strip_view(release);
+    } else if (uname(&info) == 0) {
       _kernel = info.release;
     } else {
       _kernel = "<unknown>";
     }
   }
   {  // architecture
-    struct stat buffer {};
-    _64bit = stat("/lib64/ld-linux-x86-64.so.2", &buffer) == 0;
+    _64bit = filesystem::exists("/lib64/ld-linux-x86-64.so.2");
     _32bit = !_64bit;
   }
   {  // Get endian. This is platform independent...
@@ -0,0 +1,259 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <fcntl.h>
+#include <hwinfo/cgroup.h>
+#include <hwinfo/pressure.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/trace.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+const char* resourceName(PressureResource resource) {
+  switch (resource) {
+    case PressureResource::CPU:
+      return "cpu";
+    case PressureResource::Memory:
+      return "memory";
+    case PressureResource::IO:
+      return "io";
+  }
+  return "cpu";
+}
+
+// _____________________________________________________________________________________________________________________
+std::string systemPath(PressureResource resource) { return std::string("/proc/pressure/") + resourceName(resource); }
+
+// _____________________________________________________________________________________________________________________
+// <resource>.pressure of the cgroup of the process, empty without the unified hierarchy. PSI files exist in every
+// cgroup of the unified hierarchy, independent of the enabled controllers.
+std::string cgroupPath(PressureResource resource) {
+  const Cgroup& cgroup = Cgroup::get();
+  if (cgroup.version() != 2) {
+    return {};
+  }
+  for (const std::string* directory : {&cgroup.cpu_path(), &cgroup.memory_path(), &cgroup.cpuset_path()}) {
+    if (!directory->empty()) {
+      return *directory + '/' + resourceName(resource) + ".pressure";
+    }
+  }
+  return {};
+}
+
+// _____________________________________________________________________________________________________________________
+// Reads "12.34" (the kernel always prints two decimals, LOAD_INT.LOAD_FRAC) after the next '='.
+bool nextAverage(utils::NumberScanner& scanner, double& value) {
+  uint64_t integer = 0;
+  if (!scanner.skip_past('=') || !scanner.next_uint(integer)) {
+    return false;
+  }
+  value = static_cast<double>(integer);
+  if (scanner.rest_of_line().substr(0, 1) != ".") {
+    return true;
+  }
+  scanner.skip_past('.');
+  const std::string_view rest = scanner.rest_of_line();
+  uint64_t fraction = 0;
+  if (!scanner.next_uint(fraction)) {
+    return true;
+  }
+  // the digits consumed by next_uint()
+  const size_t digits = rest.size() - scanner.rest_of_line().size();
+  double scale = 1.0;
+  for (size_t i = 0; i < digits; ++i) {
+    scale *= 10.0;
+  }
+  value += static_cast<double>(fraction) / scale;
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+// "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+bool parseLine(utils::NumberScanner& scanner, PressureLine& line) {
+  int64_t total = 0;
+  if (!nextAverage(scanner, line.avg10) || !nextAverage(scanner, line.avg60) || !nextAverage(scanner, line.avg300) ||
+      !scanner.skip_past('=') || !scanner.next_int(total)) {
+    line = PressureLine();
+    return false;
+  }
+  line.total_us = total;
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+int openTrigger(const std::string& path, PressureTrigger::Kind kind, std::chrono::microseconds stall,
+                std::chrono::microseconds window) {
+  if (path.empty() || stall.count() <= 0 || window.count() <= 0) {
+    return -1;
+  }
+  // one trigger per descriptor, the trigger is removed when it is closed
+  const int fd = open(filesystem::rooted(path).c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  const std::string trigger = std::string(kind == PressureTrigger::Kind::Full ? "full " : "some ") +
+                              std::to_string(stall.count()) + ' ' + std::to_string(window.count());
+  // the kernel expects the terminating null character
+  if (write(fd, trigger.c_str(), trigger.size() + 1) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+}  // namespace
+
+struct Pressure::Source {
+  filesystem::CachedFile file;
+};
+
+struct PressureTrigger::Source {
+  int trigger{-1};
+  int wake{-1};
+
+  Source() = default;
+  Source(const Source&) = delete;
+  Source& operator=(const Source&) = delete;
+  ~Source() {
+    for (int fd : {trigger, wake}) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+Pressure::Pressure(PressureResource resource)
+    : _source(std::make_unique<Source>(Source{filesystem::CachedFile(systemPath(resource))})) {}
+
+// _____________________________________________________________________________________________________________________
+Pressure::~Pressure() = default;
+
+// _____________________________________________________________________________________________________________________
+Pressure::Pressure(Pressure&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Pressure& Pressure::operator=(Pressure&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Pressure Pressure::cgroup(PressureResource resource) {
+  Pressure pressure;
+  const std::string path = cgroupPath(resource);
+  if (!path.empty()) {
+    pressure._source = std::make_unique<Source>(Source{filesystem::CachedFile(path)});
+  }
+  return pressure;
+}
+
+// _____________________________________________________________________________________________________________________
+bool Pressure::valid() const { return _source && _source->file.valid(); }
+
+// _____________________________________________________________________________________________________________________
+bool Pressure::read(PressureStats& stats) const {
+  HWINFO_TRACE_SCOPE(Pressure);
+  stats = PressureStats();
+  // both lines fit into the small string buffer of most implementations, one buffer per thread otherwise
+  thread_local std::string buffer;
+  if (!valid() || !_source->file.read(buffer)) {
+    return false;
+  }
+  utils::NumberScanner scanner(buffer);
+  bool success = false;
+  do {
+    const std::string_view kind = scanner.next_word();
+    if (kind == "some") {
+      success = parseLine(scanner, stats.some) || success;
+    } else if (kind == "full") {
+      success = parseLine(scanner, stats.full) || success;
+    }
+  } while (scanner.next_line());
+  return success;
+}
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger::PressureTrigger(PressureResource resource, Kind kind, std::chrono::microseconds stall,
+                                 std::chrono::microseconds window)
+    : _source(std::make_unique<Source>()) {
+  _source->trigger = openTrigger(systemPath(resource), kind, stall, window);
+  _source->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger::~PressureTrigger() = default;
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger::PressureTrigger(PressureTrigger&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger& PressureTrigger::operator=(PressureTrigger&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger PressureTrigger::cgroup(PressureResource resource, Kind kind, std::chrono::microseconds stall,
+                                        std::chrono::microseconds window) {
+  PressureTrigger trigger;
+  trigger._source = std::make_unique<Source>();
+  trigger._source->trigger = openTrigger(cgroupPath(resource), kind, stall, window);
+  trigger._source->wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  return trigger;
+}
+
+// _____________________________________________________________________________________________________________________
+bool PressureTrigger::valid() const { return _source && _source->trigger >= 0 && _source->wake >= 0; }
+
+// _____________________________________________________________________________________________________________________
+int PressureTrigger::fd() const { return valid() ? _source->trigger : -1; }
+
+// _____________________________________________________________________________________________________________________
+bool PressureTrigger::wait(std::chrono::milliseconds timeout) {
+  if (!valid()) {
+    return false;
+  }
+  pollfd fds[2]{{_source->trigger, POLLPRI, 0}, {_source->wake, POLLIN, 0}};
+  const int timeout_ms = timeout.count() < 0 ? -1 : static_cast<int>(std::min<int64_t>(timeout.count(), INT32_MAX));
+  int ready = 0;
+  do {
+    ready = poll(fds, 2, timeout_ms);
+  } while (ready < 0 && errno == EINTR);
+  if (ready <= 0) {
+    return false;
+  }
+  if (fds[1].revents & POLLIN) {
+    uint64_t count = 0;
+    // resets the eventfd counter
+    (void)!::read(_source->wake, &count, sizeof(count));
+    return false;
+  }
+  // POLLERR: the monitored cgroup was removed
+  return (fds[0].revents & POLLPRI) != 0 && (fds[0].revents & POLLERR) == 0;
+}
+
+// _____________________________________________________________________________________________________________________
+void PressureTrigger::interrupt() {
+  if (_source && _source->wake >= 0) {
+    const uint64_t one = 1;
+    (void)!write(_source->wake, &one, sizeof(one));
+  }
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -0,0 +1,150 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/process_stats.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// The opened files of one process.
+struct ProcessFiles {
+  filesystem::CachedFile stat;
+  filesystem::CachedFile statm;
+  filesystem::CachedFile io;
+};
+
+}  // namespace
+
+struct ProcessSampler::Source {
+  std::vector<ProcessFiles> processes;
+  std::string buffer;
+  int64_t page_size{sysconf(_SC_PAGESIZE)};
+  // duration of a utime/stime tick (USER_HZ, the unit of /proc/stat as well)
+  int64_t tick_ns{1000000000 / std::max<int64_t>(sysconf(_SC_CLK_TCK), 1)};
+
+  // utime + stime of /proc/<pid>/stat
+  bool readCpuTime(const ProcessFiles& files, int64_t& cpu_time_ns) {
+    if (!files.stat.read(buffer)) {
+      return false;
+    }
+    // "pid (comm) state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime stime ...", comm may
+    // contain blanks and parentheses
+    const size_t comm_end = buffer.rfind(')');
+    if (comm_end == std::string::npos) {
+      return false;
+    }
+    utils::NumberScanner scanner(std::string_view(buffer).substr(comm_end + 1));
+    scanner.next_word();
+    // tpgid is -1 for processes without a controlling terminal
+    int64_t fields[12];
+    for (auto& field : fields) {
+      if (!scanner.next_int(field)) {
+        return false;
+      }
+    }
+    cpu_time_ns = (fields[10] + fields[11]) * tick_ns;
+    return true;
+  }
+
+  // resident pages of /proc/<pid>/statm
+  bool readRss(const ProcessFiles& files, int64_t& rss_Bytes) {
+    if (!files.statm.read(buffer)) {
+      return false;
+    }
+    // "size resident shared text lib data dt" (pages)
+    utils::NumberScanner scanner(buffer);
+    int64_t fields[2];
+    if (scanner.read_uints(fields, 2) != 2) {
+      return false;
+    }
+    rss_Bytes = fields[1] * page_size;
+    return true;
+  }
+
+  // read_bytes and write_bytes of /proc/<pid>/io (requires ptrace access to the process)
+  bool readIo(const ProcessFiles& files, int64_t& read_Bytes, int64_t& written_Bytes) {
+    if (!files.io.read(buffer)) {
+      return false;
+    }
+    // "rchar: 1\nwchar: 2\nsyscr: 3\nsyscw: 4\nread_bytes: 5\nwrite_bytes: 6\ncancelled_write_bytes: 7\n"
+    utils::NumberScanner scanner(buffer);
+    bool has_read = false;
+    bool has_written = false;
+    do {
+      const std::string_view key = scanner.next_word();
+      if (key == "read_bytes:") {
+        has_read = scanner.next_uint(read_Bytes);
+      } else if (key == "write_bytes:") {
+        has_written = scanner.next_uint(written_Bytes);
+      }
+    } while (scanner.next_line());
+    return has_read && has_written;
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+ProcessSampler::ProcessSampler(std::vector<int64_t> pids)
+    : _pids(std::move(pids)),
+      _source(new Source()),
+      _previous(_pids.size()),
+      _current(_pids.size()),
+      _cpu_utilisation(_pids.size(), -1.0),
+      _rss_Bytes(_pids.size(), -1),
+      _read_Bytes_per_s(_pids.size(), -1.0),
+      _written_Bytes_per_s(_pids.size(), -1.0) {
+  _jiffy_ns = static_cast<double>(_source->tick_ns);
+  _source->processes.resize(_pids.size());
+  for (size_t i = 0; i < _pids.size(); ++i) {
+    if (_pids[i] <= 0) {
+      continue;
+    }
+    const std::string path = "/proc/" + std::to_string(_pids[i]) + '/';
+    ProcessFiles& files = _source->processes[i];
+    files.stat = filesystem::CachedFile(path + "stat");
+    files.statm = filesystem::CachedFile(path + "statm");
+    files.io = filesystem::CachedFile(path + "io");
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+ProcessSampler::~ProcessSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool ProcessSampler::read_counters() {
+  bool success = false;
+  for (size_t i = 0; i < _current.size(); ++i) {
+    const ProcessFiles& files = _source->processes[i];
+    Counters& counters = _current[i];
+    // reads of an exited process fail (ESRCH) instead of returning the counters of a process that reused the pid
+    if (!files.stat.valid() || !_source->readCpuTime(files, counters.cpu_time_ns)) {
+      continue;
+    }
+    success = true;
+    _source->readRss(files, counters.rss_Bytes);
+    int64_t read_Bytes = -1;
+    int64_t written_Bytes = -1;
+    if (files.io.valid() && _source->readIo(files, read_Bytes, written_Bytes)) {
+      counters.read_Bytes = read_Bytes;
+      counters.written_Bytes = written_Bytes;
+    }
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -6,97 +6,413 @@
 #ifdef HWINFO_UNIX
 
 #include <hwinfo/ram.h>
-#include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/smbios.h>
+#include <hwinfo/utils/trace.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace hwinfo {
 
-// _____________________________________________________________________________________________________________________
-struct MemInfo {
-  int64_t total{-1};
-  int64_t free{-1};
-  int64_t available{-1};
-};
+namespace {
 
-void get_from_sysconf(MemInfo& mi) {
+// _____________________________________________________________________________________________________________________
+void get_from_sysconf(MemorySnapshot& snapshot) {
   int64_t pages = sysconf(_SC_PHYS_PAGES);
   int64_t available_pages = sysconf(_SC_AVPHYS_PAGES);
   int64_t page_size = sysconf(_SC_PAGESIZE);
   if (pages > 0 && page_size > 0) {
-    mi.total = pages * page_size;
+    snapshot.total_Bytes = pages * page_size;
   }
   if (available_pages > 0 && page_size > 0) {
-    mi.available = available_pages * page_size;
+    snapshot.available_Bytes = available_pages * page_size;
   }
 }
 
-void set_value(std::string& line, int64_t* dst) {
-  auto split_line = utils::split(line, ":");
-  if (split_line.size() == 2) {
-    auto& value = split_line[1];
-    utils::strip(value);
-    auto space = value.find(' ');
-    if (space != std::string::npos) {
-      auto a = std::string(value.begin(), value.begin() + static_cast<int64_t>(space));
-      *dst = (std::stoll(a) * 1024);
+template <typename T>
+struct MemInfoKey {
+  std::string_view name;
+  int64_t T::*field;
+  // the HugePages_* entries are counts, everything else is in kB
+  int64_t scale;
+};
+
+constexpr MemInfoKey<MemorySnapshot> meminfo_keys[] = {
+    {"MemTotal", &MemorySnapshot::total_Bytes, 1024},
+    {"MemFree", &MemorySnapshot::free_Bytes, 1024},
+    {"MemAvailable", &MemorySnapshot::available_Bytes, 1024},
+    {"Buffers", &MemorySnapshot::buffers_Bytes, 1024},
+    {"Cached", &MemorySnapshot::cached_Bytes, 1024},
+    {"SwapTotal", &MemorySnapshot::swap_total_Bytes, 1024},
+    {"SwapFree", &MemorySnapshot::swap_free_Bytes, 1024},
+    {"Dirty", &MemorySnapshot::dirty_Bytes, 1024},
+    {"Writeback", &MemorySnapshot::writeback_Bytes, 1024},
+    {"Shmem", &MemorySnapshot::shmem_Bytes, 1024},
+    {"HugePages_Total", &MemorySnapshot::hugepages_total, 1},
+    {"HugePages_Free", &MemorySnapshot::hugepages_free, 1},
+    {"HugePages_Rsvd", &MemorySnapshot::hugepages_reserved, 1},
+    {"HugePages_Surp", &MemorySnapshot::hugepages_surplus, 1},
+    {"Hugepagesize", &MemorySnapshot::hugepage_size_Bytes, 1024},
+};
+
+// /sys/devices/system/node/node<N>/meminfo, every line starts with "Node <N>"
+constexpr MemInfoKey<NodeMemory> node_meminfo_keys[] = {
+    {"MemTotal", &NodeMemory::total_Bytes, 1024},
+    {"MemFree", &NodeMemory::free_Bytes, 1024},
+    {"MemUsed", &NodeMemory::used_Bytes, 1024},
+    {"FilePages", &NodeMemory::file_Bytes, 1024},
+    {"AnonPages", &NodeMemory::anon_Bytes, 1024},
+    {"HugePages_Total", &NodeMemory::hugepages_total, 1},
+    {"HugePages_Free", &NodeMemory::hugepages_free, 1},
+};
+
+constexpr MemInfoKey<NodeMemory> numastat_keys[] = {
+    {"numa_hit", &NodeMemory::numa_hit, 1},
+    {"numa_miss", &NodeMemory::numa_miss, 1},
+    {"numa_foreign", &NodeMemory::numa_foreign, 1},
+    {"interleave_hit", &NodeMemory::interleave_hit, 1},
+    {"local_node", &NodeMemory::local_node, 1},
+    {"other_node", &NodeMemory::other_node, 1},
+};
+
+// _____________________________________________________________________________________________________________________
+// Reads the keys from lines like "MemTotal:       16318412 kB" or "numa_hit 52349683", after skip_words leading words
+// of every line. The keys come in kernel order, which is also the table order. Returns the number of keys found.
+template <typename T, size_t N>
+size_t parse_keys(std::string_view text, const MemInfoKey<T> (&keys)[N], size_t skip_words, T& values) {
+  utils::NumberScanner scanner(text);
+  size_t next_key = 0;
+  size_t num_found = 0;
+  do {
+    for (size_t i = 0; i < skip_words; ++i) {
+      scanner.next_word();
+    }
+    std::string_view name = scanner.next_word();
+    if (!name.empty() && name.back() == ':') {
+      name.remove_suffix(1);
+    }
+    for (size_t i = 0; i < N; ++i) {
+      const MemInfoKey<T>& key = keys[(next_key + i) % N];
+      if (key.name != name) {
+        continue;
+      }
+      int64_t value = -1;
+      if (scanner.next_uint(value)) {
+        values.*key.field = value * key.scale;
+        ++num_found;
+      }
+      next_key = (next_key + i + 1) % N;
+      break;
+    }
+  } while (num_found < N && scanner.next_line());
+  return num_found;
+}
+
+// _____________________________________________________________________________________________________________________
+// Pages migrated by NUMA balancing / memory tiering from the node vmstat (Linux 5.18+, demotion split up in 6.x).
+void parse_migrations(std::string_view text, NodeMemory& node) {
+  utils::NumberScanner scanner(text);
+  do {
+    const std::string_view name = scanner.next_word();
+    if (name.compare(0, 4, "pgpr") != 0 && name.compare(0, 4, "pgde") != 0) {
+      continue;
+    }
+    int64_t value = 0;
+    if (!scanner.next_uint(value)) {
+      continue;
     }
+    if (name == "pgpromote_success") {
+      node.promoted_pages = value;
+    } else if (name.compare(0, 9, "pgdemote_") == 0) {
+      node.demoted_pages = std::max<int64_t>(node.demoted_pages, 0) + value;
+    }
+  } while (scanner.next_line());
+}
+
+// The SMBIOS table is only readable by root, so the decoded modules are cached in a small binary file:
+//   "HWDM" | version | fingerprint size | module count | fingerprint | modules (id, size, speed, vendor, model)
+// all integers in host byte order, strings as uint32 length and bytes. The fingerprint is the world readable DMI
+// modalias (BIOS, board and product ids): a BIOS update or a different machine invalidates the cache. Serial numbers
+// are not cached since the file is meant to be readable by everyone. The cache belongs to the host: it is neither read
+// nor written below another filesystem::root(), whose SMBIOS table is decoded directly.
+constexpr char cache_magic[4] = {'H', 'W', 'D', 'M'};
+constexpr uint32_t cache_version = 1;
+constexpr const char* system_cache_dir = "/var/cache/hwinfo";
+constexpr const char* cache_file_name = "/dmi_memory.bin";
+
+// _____________________________________________________________________________________________________________________
+std::string dmi_fingerprint() {
+  std::string value;
+  if (!filesystem::CachedFile("/sys/class/dmi/id/modalias").read(value)) {
+    return {};
   }
+  return value.substr(0, value.find('\n'));
+}
+
+// _____________________________________________________________________________________________________________________
+// Cache directories in lookup order: the system wide one (written by root), then the one of the user.
+std::vector<std::string> cache_dirs() {
+  std::vector<std::string> dirs = {system_cache_dir};
+  if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg != nullptr && xdg[0] == '/') {
+    dirs.push_back(std::string(xdg) + "/hwinfo");
+  } else if (const char* home = std::getenv("HOME"); home != nullptr && home[0] == '/') {
+    dirs.push_back(std::string(home) + "/.cache/hwinfo");
+  }
+  return dirs;
+}
+
+// _____________________________________________________________________________________________________________________
+void append_u32(std::string& out, uint32_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+// _____________________________________________________________________________________________________________________
+void append_string(std::string& out, std::string_view value) {
+  append_u32(out, static_cast<uint32_t>(value.size()));
+  out.append(value);
 }
 
-MemInfo parse_meminfo() {
-  MemInfo mi;
-  std::ifstream f_meminfo("/proc/meminfo");
-  if (!f_meminfo) {
-    get_from_sysconf(mi);
-  } else {
-    while (mi.total == -1 || mi.available == -1 || mi.free == -1) {
-      std::string line;
-      if (!std::getline(f_meminfo, line)) {
-        if (mi.total == -1 || mi.available == -1) {
-          get_from_sysconf(mi);
-        }
-        return mi;
+// _____________________________________________________________________________________________________________________
+// Bounds checked reader over a cache file.
+struct CacheReader {
+  std::string_view data;
+
+  template <typename T>
+  bool next(T& value) {
+    if (data.size() < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return true;
+  }
+  bool next(InternedString& value) {
+    uint32_t size = 0;
+    if (!next(size) || data.size() < size) {
+      return false;
+    }
+    value = data.substr(0, size);
+    data.remove_prefix(size);
+    return true;
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+bool read_cache(const std::string& path, const std::string& fingerprint, std::vector<Memory::Module>& modules) {
+  const filesystem::CachedFile file(path);
+  std::string buffer;
+  if (!file.read(buffer) || buffer.size() < sizeof(cache_magic) ||
+      std::memcmp(buffer.data(), cache_magic, sizeof(cache_magic)) != 0) {
+    return false;
+  }
+  CacheReader reader{std::string_view(buffer).substr(sizeof(cache_magic))};
+  uint32_t version = 0;
+  uint32_t fingerprint_size = 0;
+  uint32_t count = 0;
+  if (!reader.next(version) || version != cache_version || !reader.next(fingerprint_size) || !reader.next(count) ||
+      reader.data.substr(0, fingerprint_size) != fingerprint || fingerprint_size != fingerprint.size()) {
+    return false;
+  }
+  reader.data.remove_prefix(fingerprint_size);
+  // id, size, frequency and the sizes of vendor and model: a count the remaining bytes cannot hold is a corrupt (the
+  // file may live in $HOME) cache, which must not make the allocation throw
+  constexpr size_t min_record_size = sizeof(int32_t) + sizeof(Memory::Module::total_Bytes) +
+                                     sizeof(Memory::Module::frequency_Hz) + 2 * sizeof(uint32_t);
+  if (count > reader.data.size() / min_record_size) {
+    return false;
+  }
+  std::vector<Memory::Module> result(count);
+  for (auto& module : result) {
+    int32_t id = 0;
+    if (!reader.next(id) || !reader.next(module.total_Bytes) || !reader.next(module.frequency_Hz) ||
+        !reader.next(module.vendor) || !reader.next(module.model)) {
+      return false;
+    }
+    module.id = id;
+    module.name = module.vendor.str() + " " + module.model.str();
+    module.serial_number = "<unknown>";
+  }
+  modules = std::move(result);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+void write_cache(const std::string& fingerprint, const std::vector<Memory::Module>& modules) {
+  std::string out(cache_magic, sizeof(cache_magic));
+  append_u32(out, cache_version);
+  append_u32(out, static_cast<uint32_t>(fingerprint.size()));
+  append_u32(out, static_cast<uint32_t>(modules.size()));
+  out.append(fingerprint);
+  for (const auto& module : modules) {
+    const auto id = static_cast<int32_t>(module.id);
+    out.append(reinterpret_cast<const char*>(&id), sizeof(id));
+    out.append(reinterpret_cast<const char*>(&module.total_Bytes), sizeof(module.total_Bytes));
+    out.append(reinterpret_cast<const char*>(&module.frequency_Hz), sizeof(module.frequency_Hz));
+    append_string(out, module.vendor);
+    append_string(out, module.model);
+  }
+  // the first directory that can be written to; write and rename, so concurrent readers never see a partial file
+  for (const auto& dir : cache_dirs()) {
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+      continue;
+    }
+    const std::string path = dir + cache_file_name;
+    const std::string tmp_path = path + "." + std::to_string(getpid());
+    {
+      std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+      if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        std::remove(tmp_path.c_str());
+        continue;
       }
-      if (utils::starts_with(line, "MemTotal")) {
-        set_value(line, &mi.total);
-      } else if (utils::starts_with(line, "MemFree")) {
-        set_value(line, &mi.free);
-      } else if (utils::starts_with(line, "MemAvailable")) {
-        set_value(line, &mi.available);
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) == 0) {
+      return;
+    }
+    std::remove(tmp_path.c_str());
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+// Memory devices from the cache or, if there is none for this machine, from the raw SMBIOS table.
+std::vector<Memory::Module> read_memory_devices() {
+  std::vector<Memory::Module> modules;
+  // the cache files are written with plain paths, which would not match a rooted read
+  const std::string fingerprint = filesystem::root() == "/" ? dmi_fingerprint() : std::string();
+  if (!fingerprint.empty()) {
+    for (const auto& dir : cache_dirs()) {
+      if (read_cache(dir + cache_file_name, fingerprint, modules)) {
+        return modules;
       }
     }
   }
-  return mi;
+  modules = smbios::memory_devices(smbios::system_table());
+  if (!modules.empty() && !fingerprint.empty()) {
+    write_cache(fingerprint, modules);
+  }
+  return modules;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+bool MemorySnapshot::update() {
+  HWINFO_TRACE_SCOPE(MemorySnapshot);
+  *this = MemorySnapshot();
+  timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+  // polled frequently: keep the file open (per root) and reuse the read buffer of this thread
+  static const filesystem::PerRoot<filesystem::CachedFile> file([] { return filesystem::CachedFile("/proc/meminfo"); });
+  thread_local std::string buffer;
+  if (!file.get().read(buffer)) {
+    get_from_sysconf(*this);
+    return total_Bytes != -1;
+  }
+  parse_keys(buffer, meminfo_keys, 0, *this);
+  if (total_Bytes == -1 || available_Bytes == -1) {
+    get_from_sysconf(*this);
+  }
+  return total_Bytes != -1;
 }
 
 // _____________________________________________________________________________________________________________________
 Memory::Memory() {
-  // TODO: get information for actual memory modules (DIMM)
+  HWINFO_TRACE_SCOPE(Memory);
+  if (static_cache::load(*this)) {
+    return;
+  }
+  _modules = read_memory_devices();
+  if (!_modules.empty()) {
+    static_cache::store(*this);
+    return;
+  }
+  // no SMBIOS table (containers, some ARM boards) and no cache: one module with the total memory of the system
   Module module;
   module.vendor = "<unknown>";
   module.name = "<unknown>";
   module.serial_number = "<unknown>";
   module.model = "<unknown>";
   module.id = 0;
-  module.total_Bytes = parse_meminfo().total;
+  MemorySnapshot snapshot;
+  snapshot.update();
+  module.total_Bytes = snapshot.total_Bytes;
   module.frequency_Hz = -1;
   _modules.push_back(module);
+  static_cache::store(*this);
 }
 
+struct NumaMemorySampler::Source {
+  struct Node {
+    int32_t id;
+    filesystem::CachedFile meminfo;
+    filesystem::CachedFile numastat;
+    filesystem::CachedFile vmstat;
+  };
+  std::vector<Node> nodes;
+  std::string buffer;
+};
+
 // _____________________________________________________________________________________________________________________
-int64_t Memory::free_Bytes() const {
-  auto meminfo = parse_meminfo();
-  return meminfo.free;
+NumaMemorySampler::NumaMemorySampler() : _source(std::make_unique<Source>()) {
+  // kernels without CONFIG_NUMA have no node directory (and no nodes here)
+  std::string online;
+  std::vector<bool> ids;
+  if (!filesystem::CachedFile("/sys/devices/system/node/online").read(online) || !utils::parse_cpu_list(online, ids)) {
+    return;
+  }
+  for (size_t id = 0; id < ids.size(); ++id) {
+    if (!ids[id]) {
+      continue;
+    }
+    const std::string path = "/sys/devices/system/node/node" + std::to_string(id);
+    Source::Node node{static_cast<int32_t>(id), filesystem::CachedFile(path + "/meminfo"),
+                      filesystem::CachedFile(path + "/numastat"), filesystem::CachedFile(path + "/vmstat")};
+    if (node.meminfo.valid()) {
+      _source->nodes.push_back(std::move(node));
+    }
+  }
+  _nodes.resize(_source->nodes.size());
 }
 
 // _____________________________________________________________________________________________________________________
-int64_t Memory::available_Bytes() const {
-  auto meminfo = parse_meminfo();
-  return meminfo.available;
+NumaMemorySampler::~NumaMemorySampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool NumaMemorySampler::update() {
+  HWINFO_TRACE_SCOPE(MemorySnapshot);
+  _timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+  std::string& buffer = _source->buffer;
+  bool success = false;
+  for (size_t i = 0; i < _nodes.size(); ++i) {
+    const Source::Node& source = _source->nodes[i];
+    NodeMemory& node = _nodes[i];
+    node = NodeMemory();
+    node.node = source.id;
+    if (source.meminfo.read(buffer)) {
+      success = parse_keys(buffer, node_meminfo_keys, 2, node) > 0 || success;
+    }
+    if (source.numastat.valid() && source.numastat.read(buffer)) {
+      parse_keys(buffer, numastat_keys, 0, node);
+    }
+    if (source.vmstat.valid() && source.vmstat.read(buffer)) {
+      parse_migrations(buffer, node);
+    }
+  }
+  return success;
 }
 
 }  // namespace hwinfo
@@ -0,0 +1,297 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/sensors.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+const std::string hwmon_path = "/sys/class/hwmon/";
+const std::string thermal_path = "/sys/class/thermal/";
+const std::string powercap_path = "/sys/class/powercap/";
+
+// An opened attribute file and how its values are converted.
+struct Channel {
+  filesystem::CachedFile file;
+  // value * scale is in the unit of the sensor kind
+  double scale{1.0};
+  // cumulative energy (µJ): the value is the power since the previous read
+  bool energy{false};
+  // the energy counter wraps around after this value, -1 if unknown
+  int64_t energy_range{-1};
+  int64_t last_energy{-1};
+  int64_t last_ns{-1};
+};
+
+// _____________________________________________________________________________________________________________________
+// hwmon2 < hwmon10
+bool numericOrder(const std::string& a, const std::string& b) {
+  return a.size() != b.size() ? a.size() < b.size() : a < b;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<std::string> sortedEntries(const std::string& path, std::string_view prefix) {
+  std::vector<std::string> entries;
+  for (auto& entry : filesystem::getDirectoryEntries(path)) {
+    if (entry.compare(0, prefix.size(), prefix) == 0) {
+      entries.push_back(std::move(entry));
+    }
+  }
+  std::sort(entries.begin(), entries.end(), numericOrder);
+  return entries;
+}
+
+// _____________________________________________________________________________________________________________________
+// Number after the last occurrence of separator ("coretemp.1" -> 1, "package-0" -> 0), -1 if there is none.
+int trailingNumber(std::string_view value, char separator) {
+  const size_t pos = value.rfind(separator);
+  return pos == std::string_view::npos ? -1 : utils::parse_int_or<int>(value.substr(pos + 1), -1);
+}
+
+// _____________________________________________________________________________________________________________________
+// Name of the device a hwmon instance belongs to ("coretemp.0", "0000:00:18.3"), empty if it has none.
+std::string deviceName(const std::string& hwmon) {
+  char resolved[PATH_MAX];
+  if (realpath(filesystem::rooted(hwmon + "device").c_str(), resolved) == nullptr) {
+    return {};
+  }
+  const std::string_view path(resolved);
+  return std::string(path.substr(path.rfind('/') + 1));
+}
+
+// A hwmon channel attribute: "temp1_input" -> {"temp", "1", "input"}.
+struct Attribute {
+  std::string_view type;
+  std::string_view index;
+  std::string_view item;
+};
+
+// _____________________________________________________________________________________________________________________
+bool parseAttribute(std::string_view name, Attribute& attribute) {
+  const size_t underscore = name.find('_');
+  if (underscore == std::string_view::npos) {
+    return false;
+  }
+  const std::string_view channel = name.substr(0, underscore);
+  const size_t digits = channel.find_first_of("0123456789");
+  if (digits == 0 || digits == std::string_view::npos) {
+    return false;
+  }
+  attribute = {channel.substr(0, digits), channel.substr(digits), name.substr(underscore + 1)};
+  return true;
+}
+
+// The hwmon channel types and the scale of their values.
+struct ChannelType {
+  std::string_view type;
+  SensorKind kind;
+  double scale;
+};
+constexpr ChannelType channel_types[] = {
+    {"temp", SensorKind::Temperature, 1e-3},  // m°C
+    {"fan", SensorKind::Fan, 1.0},            // RPM
+    {"in", SensorKind::Voltage, 1e-3},        // mV
+    {"power", SensorKind::Power, 1e-6},       // µW
+};
+
+}  // namespace
+
+struct SensorSampler::Source {
+  // one per sensor
+  std::vector<Channel> channels;
+
+  void add(std::vector<Sensor>& sensors, Sensor sensor, Channel channel) {
+    if (!channel.file.valid()) {
+      // e.g. RAPL energy counters, only readable by root
+      return;
+    }
+    sensors.push_back(std::move(sensor));
+    channels.push_back(std::move(channel));
+  }
+
+  void discoverHwmon(std::vector<Sensor>& sensors) {
+    const std::vector<std::string> instances = sortedEntries(hwmon_path, "hwmon");
+    // k10temp/zenpower: one instance per data fabric, i.e. per socket (Zen 2 and later), in PCI address order
+    std::map<std::string, int> zen_sockets;
+    for (const auto& instance : instances) {
+      std::string name;
+      const std::string path = hwmon_path + instance + '/';
+      if (filesystem::Directory(path).read("name", name) && (name == "k10temp" || name == "zenpower")) {
+        zen_sockets.emplace(deviceName(path), 0);
+      }
+    }
+    int socket_id = 0;
+    for (auto& [device, socket] : zen_sockets) {
+      socket = socket_id++;
+    }
+
+    for (const auto& instance : instances) {
+      const std::string path = hwmon_path + instance + '/';
+      const filesystem::Directory directory(path);
+      Sensor sensor;
+      if (!directory.read("name", sensor.chip)) {
+        continue;
+      }
+      const std::string device = deviceName(path);
+      if (sensor.chip == "coretemp") {
+        // platform device coretemp.<package>
+        sensor.socket = trailingNumber(device, '.');
+      } else if (zen_sockets.count(device) != 0 && (sensor.chip == "k10temp" || sensor.chip == "zenpower")) {
+        sensor.socket = zen_sockets[device];
+      }
+      std::vector<std::string> entries = filesystem::getDirectoryEntries(path);
+      std::sort(entries.begin(), entries.end());
+      for (const auto& entry : entries) {
+        Attribute attribute;
+        if (!parseAttribute(entry, attribute)) {
+          continue;
+        }
+        const std::string channel_name = std::string(attribute.type) + std::string(attribute.index);
+        const auto exists = [&](const char* item) { return directory.exists((channel_name + item).c_str()); };
+        Channel channel;
+        if (attribute.type == "energy" && attribute.item == "input") {
+          const std::string power = "power" + std::string(attribute.index);
+          if (directory.exists((power + "_input").c_str()) || directory.exists((power + "_average").c_str())) {
+            // the power channel with the same index is preferred
+            continue;
+          }
+          sensor.kind = SensorKind::Power;
+          channel.energy = true;
+        } else if (attribute.type == "power" && attribute.item == "input" && exists("_average")) {
+          // power*_average is preferred
+          continue;
+        } else if (attribute.item == "input" || (attribute.type == "power" && attribute.item == "average")) {
+          const auto* type = std::find_if(std::begin(channel_types), std::end(channel_types),
+                                          [&](const ChannelType& t) { return t.type == attribute.type; });
+          if (type == std::end(channel_types)) {
+            continue;
+          }
+          sensor.kind = type->kind;
+          channel.scale = type->scale;
+        } else {
+          continue;
+        }
+        if (!directory.read((channel_name + "_label").c_str(), sensor.label)) {
+          sensor.label = channel_name;
+        }
+        channel.file = filesystem::CachedFile(path + entry);
+        add(sensors, sensor, std::move(channel));
+      }
+    }
+  }
+
+  void discoverThermalZones(std::vector<Sensor>& sensors) {
+    for (const auto& zone : sortedEntries(thermal_path, "thermal_zone")) {
+      const std::string path = thermal_path + zone + '/';
+      Sensor sensor;
+      sensor.kind = SensorKind::Temperature;
+      sensor.chip = "thermal";
+      if (!filesystem::Directory(path).read("type", sensor.label)) {
+        sensor.label = zone;
+      }
+      Channel channel;
+      channel.file = filesystem::CachedFile(path + "temp");
+      // m°C
+      channel.scale = 1e-3;
+      add(sensors, std::move(sensor), std::move(channel));
+    }
+  }
+
+  void discoverRapl(std::vector<Sensor>& sensors) {
+    // "intel-rapl:0" (package-0), "intel-rapl:0:0" (core), ... AMD uses the same driver. "intel-rapl-mmio" duplicates
+    // the package domains and is skipped.
+    std::map<std::string, std::string> names;
+    for (const auto& zone : sortedEntries(powercap_path, "intel-rapl:")) {
+      const std::string path = powercap_path + zone + '/';
+      const filesystem::Directory directory(path);
+      std::string name;
+      if (!directory.read("name", name)) {
+        continue;
+      }
+      names[zone] = name;
+      Sensor sensor;
+      sensor.kind = SensorKind::Power;
+      sensor.chip = "rapl";
+      sensor.label = name;
+      // subzones belong to the package of their parent zone
+      const size_t parent_end = zone.find(':', zone.find(':') + 1);
+      if (parent_end != std::string::npos) {
+        const auto parent = names.find(zone.substr(0, parent_end));
+        if (parent != names.end()) {
+          sensor.label = parent->second + '/' + name;
+          name = parent->second;
+        }
+      }
+      if (name.compare(0, 8, "package-") == 0) {
+        sensor.socket = trailingNumber(name, '-');
+      }
+      Channel channel;
+      channel.file = filesystem::CachedFile(path + "energy_uj");
+      channel.energy = true;
+      directory.read_int64("max_energy_range_uj", channel.energy_range);
+      add(sensors, std::move(sensor), std::move(channel));
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+SensorSampler::SensorSampler() : _source(new Source()) {
+  _source->discoverHwmon(_sensors);
+  _source->discoverThermalZones(_sensors);
+  _source->discoverRapl(_sensors);
+  _values.assign(_sensors.size(), std::numeric_limits<double>::quiet_NaN());
+}
+
+// _____________________________________________________________________________________________________________________
+SensorSampler::~SensorSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool SensorSampler::read_values(int64_t now_ns) {
+  bool success = false;
+  for (size_t i = 0; i < _source->channels.size(); ++i) {
+    Channel& channel = _source->channels[i];
+    int64_t value = 0;
+    if (!channel.file.read_int64(value)) {
+      continue;
+    }
+    success = true;
+    if (!channel.energy) {
+      _values[i] = static_cast<double>(value) * channel.scale;
+      continue;
+    }
+    if (channel.last_energy >= 0 && now_ns > channel.last_ns) {
+      int64_t delta = value - channel.last_energy;
+      if (delta < 0 && channel.energy_range > 0) {
+        delta += channel.energy_range;
+      }
+      if (delta >= 0) {
+        // µJ / ns = kW
+        _values[i] = static_cast<double>(delta) * 1e3 / static_cast<double>(now_ns - channel.last_ns);
+      }
+    }
+    channel.last_energy = value;
+    channel.last_ns = now_ns;
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
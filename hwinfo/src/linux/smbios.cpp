@@ -0,0 +1,26 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/smbios.h>
+
+#include <string>
+
+namespace hwinfo {
+namespace smbios {
+
+// _____________________________________________________________________________________________________________________
+bool read_system_table(std::string& blob) {
+  // the structure table without the entry point, readable by root only
+  const filesystem::CachedFile file("/sys/firmware/dmi/tables/DMI");
+  return file.read(blob) && !blob.empty();
+}
+
+}  // namespace smbios
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
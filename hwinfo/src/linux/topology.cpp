@@ -0,0 +1,131 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/topology.h>
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+const std::string cpu_dir = "/sys/devices/system/cpu/";
+
+// _____________________________________________________________________________________________________________________
+bool read_cpu_list(const std::string& path, std::vector<bool>& cpus) {
+  std::string list;
+  return filesystem::CachedFile(path).read(list) && utils::parse_cpu_list(list, cpus);
+}
+
+// _____________________________________________________________________________________________________________________
+int32_t read_node(const std::string& cpu_path) {
+  // the cpu directory contains a "node<id>" link to its NUMA node
+  for (const auto& entry : filesystem::getDirectoryEntries(cpu_path)) {
+    int32_t node = -1;
+    if (entry.compare(0, 4, "node") == 0 && utils::parse_int(std::string_view(entry).substr(4), node, true)) {
+      return node;
+    }
+  }
+  return 0;
+}
+
+// _____________________________________________________________________________________________________________________
+// Lowest cpu that shares the last level cache with the cpu, -1 if the kernel exports no cache information.
+int64_t last_level_cache_leader(const std::string& cpu_path) {
+  const std::string cache_dir = cpu_path + "cache/";
+  int64_t max_level = -1;
+  int64_t leader = -1;
+  std::string list;
+  for (const auto& entry : filesystem::getDirectoryEntries(cache_dir)) {
+    if (entry.compare(0, 5, "index") != 0) {
+      continue;
+    }
+    const int64_t level = filesystem::get_specs_by_file_path(cache_dir + entry + "/level");
+    int64_t first = -1;
+    if (level > max_level && filesystem::CachedFile(cache_dir + entry + "/shared_cpu_list").read(list) &&
+        utils::parse_int(list, first)) {
+      max_level = level;
+      leader = first;
+    }
+  }
+  return leader;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+Topology Topology::read() {
+  HWINFO_TRACE_SCOPE(Topology);
+  Topology topology;
+  std::vector<size_t> cpu_ids;
+  for (const auto& entry : filesystem::getDirectoryEntries(cpu_dir)) {
+    size_t id = 0;
+    if (entry.compare(0, 3, "cpu") == 0 && utils::parse_int(std::string_view(entry).substr(3), id, true)) {
+      cpu_ids.push_back(id);
+    }
+  }
+  if (cpu_ids.empty()) {
+    return topology;
+  }
+  std::sort(cpu_ids.begin(), cpu_ids.end());
+  topology.resize(cpu_ids.back() + 1);
+
+  // hybrid Intel cpus register one perf PMU per core type
+  std::vector<bool> performance_cores;
+  std::vector<bool> efficiency_cores;
+  const bool hybrid = read_cpu_list("/sys/devices/cpu_core/cpus", performance_cores) &&
+                      read_cpu_list("/sys/devices/cpu_atom/cpus", efficiency_cores);
+
+  std::vector<int64_t> packages;
+  std::vector<int64_t> cores;
+  std::vector<int64_t> caches;
+  for (size_t id : cpu_ids) {
+    const std::string cpu_path = cpu_dir + "cpu" + std::to_string(id) + "/";
+    // offline cpus have no topology directory
+    if (!filesystem::exists(cpu_path + "topology")) {
+      continue;
+    }
+    // -1 ("unknown") is reported by some ARM systems
+    const int64_t package =
+        std::max<int64_t>(filesystem::get_specs_by_file_path(cpu_path + "topology/physical_package_id"), 0);
+    const int64_t die = std::max<int64_t>(filesystem::get_specs_by_file_path(cpu_path + "topology/die_id"), 0);
+    int64_t core = filesystem::get_specs_by_file_path(cpu_path + "topology/core_id");
+    if (core < 0) {
+      core = static_cast<int64_t>(id);
+    }
+    // core ids are only unique within a die
+    topology._socket[id] = index_of(packages, package);
+    topology._core[id] = index_of(cores, (package << 40) | ((die & 0xfffff) << 20) | (core & 0xfffff));
+
+    const int64_t leader = last_level_cache_leader(cpu_path);
+    // without cache information the socket is the cache domain
+    topology._cache_domain[id] = leader >= 0 ? index_of(caches, leader) : index_of(caches, -1 - package);
+
+    topology._node[id] = read_node(cpu_path);
+    topology._num_nodes = std::max(topology._num_nodes, topology._node[id] + 1);
+
+    if (hybrid) {
+      topology._efficiency_class[id] = id < performance_cores.size() && performance_cores[id] ? 1 : 0;
+    } else {
+      topology._efficiency_class[id] = 0;
+    }
+  }
+  topology._package_ids.assign(packages.begin(), packages.end());
+  topology._num_cores = static_cast<int32_t>(cores.size());
+  topology._num_cache_domains = static_cast<int32_t>(caches.size());
+  return topology;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
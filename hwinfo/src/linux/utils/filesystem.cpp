@@ -3,94 +3,489 @@
 #ifdef HWINFO_UNIX
 
 #include <dirent.h>
-#include <hwinfo/cpu.h>
+#include <fcntl.h>
+#include <ftw.h>
 #include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
+#if __has_include(<linux/openat2.h>) && defined(SYS_openat2)
+#include <linux/openat2.h>
+#define HWINFO_HAS_OPENAT2
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
-#include <fstream>
-#include <iterator>
-#include <limits>
-#include <sstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace hwinfo {
 namespace filesystem {
 
+namespace {
+
+struct Root {
+  Root() {
+    const char* path = std::getenv("HWINFO_ROOT");
+    if (path != nullptr && path[0] != '\0') {
+      set(path);
+    }
+  }
+
+  bool set(const std::string& root_path) {
+    char resolved[PATH_MAX];
+    if (realpath(root_path.c_str(), resolved) == nullptr) {
+      return false;
+    }
+    const std::string normalized = resolved;
+    int root_fd = -1;
+    if (normalized != "/") {
+      root_fd = open(normalized.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+      if (root_fd < 0) {
+        return false;
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    // the previous descriptor stays open: other threads may be opening files relative to it right now
+    fd.store(root_fd, std::memory_order_release);
+    path = normalized == "/" ? std::string() : normalized;
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+  }
+
+  // -1 for the real root
+  std::atomic<int> fd{-1};
+  std::atomic<uint64_t> generation{0};
+  std::atomic<bool> openat2_supported{true};
+  std::mutex mutex;
+  // without trailing slash, empty for the real root
+  std::string path;
+};
+
+Root& root_state() {
+  static Root state;
+  return state;
+}
+
+int remove_entry(const char* path, const struct stat*, int, struct FTW*) { return std::remove(path); }
+
+int open_below_root(const char* path, int flags) {
+  flags |= O_CLOEXEC;
+  Root& state = root_state();
+  const int root_fd = state.fd.load(std::memory_order_acquire);
+  if (root_fd < 0 || path[0] != '/') {
+    return open(path, flags);
+  }
+  while (*path == '/') {
+    ++path;
+  }
+  if (*path == '\0') {
+    path = ".";
+  }
+#ifdef HWINFO_HAS_OPENAT2
+  if (state.openat2_supported.load(std::memory_order_relaxed)) {
+    open_how how{};
+    how.flags = static_cast<uint64_t>(flags);
+    how.resolve = RESOLVE_IN_ROOT;
+    const auto fd = static_cast<int>(syscall(SYS_openat2, root_fd, path, &how, sizeof(how)));
+    if (fd >= 0 || (errno != ENOSYS && errno != EPERM)) {
+      return fd;
+    }
+    if (errno == ENOSYS) {
+      state.openat2_supported.store(false, std::memory_order_relaxed);
+    }
+  }
+#endif
+  return openat(root_fd, path, flags);
+}
+
+}  // namespace
+
+bool set_root(const std::string& path) { return root_state().set(path); }
+
+std::string root() {
+  Root& state = root_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return state.path.empty() ? "/" : state.path;
+}
+
+uint64_t root_generation() { return root_state().generation.load(std::memory_order_acquire); }
+
+int open_path(const char* path, int flags) {
+  const int fd = open_below_root(path, flags);
+  if (fd >= 0) {
+    HWINFO_TRACE_FILE_OPENED();
+  }
+  return fd;
+}
+
+std::string rooted(const std::string& path) {
+  Root& state = root_state();
+  if (state.fd.load(std::memory_order_acquire) < 0 || path.empty() || path[0] != '/') {
+    return path;
+  }
+  std::lock_guard<std::mutex> lock(state.mutex);
+  return state.path + path;
+}
+
+MemoryTree::MemoryTree() {
+  const char* const bases[] = {"/dev/shm", std::getenv("TMPDIR"), "/tmp"};
+  for (const char* base : bases) {
+    if (base == nullptr || base[0] == '\0') {
+      continue;
+    }
+    std::string directory = std::string(base) + "/hwinfo-tree-XXXXXX";
+    if (mkdtemp(&directory[0]) != nullptr) {
+      _path = std::move(directory);
+      return;
+    }
+  }
+}
+
+MemoryTree::~MemoryTree() {
+  if (!_path.empty()) {
+    nftw(_path.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+  }
+}
+
+bool MemoryTree::add_parents(const std::string& path) {
+  if (_path.empty() || path.empty() || path[0] != '/') {
+    return false;
+  }
+  for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+    const std::string directory = _path + path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MemoryTree::add_file(const std::string& path, std::string_view content) {
+  if (!add_parents(path)) {
+    return false;
+  }
+  const int fd = open((_path + path).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  size_t written = 0;
+  while (written < content.size()) {
+    const ssize_t n = write(fd, content.data() + written, content.size() - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    written += static_cast<size_t>(n);
+  }
+  close(fd);
+  return written == content.size();
+}
+
+bool MemoryTree::add_symlink(const std::string& path, const std::string& target) {
+  if (!add_parents(path)) {
+    return false;
+  }
+  const std::string link = _path + path;
+  unlink(link.c_str());
+  return symlink(target.c_str(), link.c_str()) == 0;
+}
+
 bool exists(const std::string& path) {
-  struct stat sb {};
-  return stat(path.c_str(), &sb) == 0;
+  const int fd = open_path(path.c_str(), O_PATH);
+  if (fd < 0) {
+    return false;
+  }
+  close(fd);
+  return true;
 }
 
 std::vector<std::string> getDirectoryEntries(const std::string& path) {
   std::vector<std::string> children;
-  struct dirent* entry = nullptr;
-  DIR* dp = nullptr;
+  DirectoryStream stream(path);
+  std::string_view name;
+  while (stream.next(name)) {
+    children.emplace_back(name);
+  }
+  return children;
+}
 
-  dp = opendir(path.c_str());
-  if (dp != nullptr) {
-    while ((entry = readdir(dp))) {
-      if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
-      children.emplace_back(entry->d_name);
+int64_t get_specs_by_file_path(const std::string& path) {
+  // one-shot read: no need to keep the file open
+  int64_t value = -1;
+  if (!CachedFile(path).read_int64(value)) {
+    return -1;
+  }
+  return value;
+}
+
+CachedFile::CachedFile(const std::string& path) : _fd(open_path(path.c_str(), O_RDONLY)) {}
+
+CachedFile::~CachedFile() {
+  if (_fd >= 0) {
+    close(_fd);
+  }
+}
+
+CachedFile::CachedFile(CachedFile&& other) noexcept : _fd(other._fd) { other._fd = -1; }
+
+CachedFile& CachedFile::operator=(CachedFile&& other) noexcept {
+  if (this != &other) {
+    if (_fd >= 0) {
+      close(_fd);
     }
-    closedir(dp);
+    _fd = other._fd;
+    other._fd = -1;
   }
+  return *this;
+}
 
-  return children;
+bool CachedFile::read_int64(int64_t& value) const {
+  if (_fd < 0) {
+    return false;
+  }
+  char buffer[64];
+  ssize_t n;
+  do {
+    n = pread(_fd, buffer, sizeof(buffer), 0);
+  } while (n < 0 && errno == EINTR);
+  HWINFO_TRACE_BYTES_READ(n);
+  if (n <= 0) {
+    return false;
+  }
+  return utils::parse_int(std::string_view(buffer, static_cast<size_t>(n)), value);
 }
 
-int64_t get_specs_by_file_path(const std::string& path) {
-  std::string line;
-  std::ifstream stream(path);
+bool CachedFile::read(std::string& buffer) const {
+  if (_fd < 0) {
+    return false;
+  }
+  // read up to the capacity, not the size of the previous content: a file of the same size then still takes one read
+  buffer.resize(std::max<size_t>(buffer.capacity(), 4096));
+  while (true) {
+    ssize_t n = pread(_fd, &buffer[0], buffer.size(), 0);
+    HWINFO_TRACE_BYTES_READ(n);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (static_cast<size_t>(n) < buffer.size()) {
+      buffer.resize(static_cast<size_t>(n));
+      return true;
+    }
+    // buffer was too small: retry with a bigger one so that the content stems from one single read
+    buffer.resize(buffer.size() * 2);
+  }
+}
 
-  if (!stream) {
-    return -1;
+Directory::Directory(const std::string& path) : _fd(open_path(path.c_str(), O_RDONLY | O_DIRECTORY)) {}
+
+Directory::~Directory() {
+  if (_fd >= 0) {
+    close(_fd);
   }
+}
 
-  getline(stream, line);
-  stream.close();
+Directory::Directory(Directory&& other) noexcept : _fd(other._fd) { other._fd = -1; }
 
-  try {
-    return static_cast<int64_t>(std::stoll(line));
-  } catch (std::invalid_argument& e) {
-    return -1;
+Directory& Directory::operator=(Directory&& other) noexcept {
+  if (this != &other) {
+    if (_fd >= 0) {
+      close(_fd);
+    }
+    _fd = other._fd;
+    other._fd = -1;
   }
+  return *this;
 }
 
-Jiffies get_jiffies(int index) {
-  std::ifstream filestat("/proc/stat");
-  if (!filestat.is_open()) {
-    return {};
+bool Directory::exists(const char* name) const { return _fd >= 0 && faccessat(_fd, name, F_OK, 0) == 0; }
+
+bool Directory::read(const char* name, std::string& value) const {
+  if (_fd < 0) {
+    return false;
+  }
+  const int fd = openat(_fd, name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
   }
+  HWINFO_TRACE_FILE_OPENED();
+  // sysfs attributes are at most a page
+  char buffer[4096];
+  ssize_t n;
+  do {
+    n = ::read(fd, buffer, sizeof(buffer));
+  } while (n < 0 && errno == EINTR);
+  close(fd);
+  HWINFO_TRACE_BYTES_READ(n);
+  if (n <= 0) {
+    return false;
+  }
+  std::string_view content(buffer, static_cast<size_t>(n));
+  content = utils::strip_view(content.substr(0, content.find('\n')));
+  value.assign(content.data(), content.size());
+  return !value.empty();
+}
 
-  for (int i = 0; i < index; ++i) {
-    if (!filestat.ignore(std::numeric_limits<std::streamsize>::max(), '\n')) {
-      break;
+bool Directory::read_int64(const char* name, int64_t& value) const {
+  std::string content;
+  return read(name, content) && utils::parse_int(content, value);
+}
+
+DirectoryStream::DirectoryStream(const std::string& path) {
+  const int fd = open_path(path.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return;
+  }
+  _dir = fdopendir(fd);
+  if (_dir == nullptr) {
+    close(fd);
+  }
+}
+
+DirectoryStream::~DirectoryStream() {
+  if (_dir != nullptr) {
+    closedir(_dir);
+  }
+}
+
+bool DirectoryStream::next(std::string_view& name) {
+  if (_dir == nullptr) {
+    return false;
+  }
+  while (const struct dirent* entry = readdir(_dir)) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+    name = entry->d_name;
+    return true;
+  }
+  return false;
+}
+
+LineReader::LineReader(const std::string& path, size_t chunk_size)
+    : _fd(open_path(path.c_str(), O_RDONLY)), _buffer(chunk_size > 0 ? chunk_size : 1, '\0') {}
+
+LineReader::~LineReader() {
+  if (_fd >= 0) {
+    close(_fd);
+  }
+}
+
+bool LineReader::next(std::string_view& line) {
+  while (true) {
+    const char* begin = _buffer.data() + _begin;
+    const void* match = _begin < _end ? std::memchr(begin, '\n', _end - _begin) : nullptr;
+    if (match != nullptr) {
+      const auto length = static_cast<size_t>(static_cast<const char*>(match) - begin);
+      line = std::string_view(begin, length);
+      _begin += length + 1;
+      return true;
+    }
+    if (_eof || !fill()) {
+      // last line without a trailing line break
+      if (_begin < _end) {
+        line = std::string_view(_buffer.data() + _begin, _end - _begin);
+        _begin = _end;
+        return true;
+      }
+      return false;
     }
   }
-  std::string line;
-  std::getline(filestat, line);
+}
 
-  std::istringstream iss(line);
-  std::vector<std::string> results(std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>());
+bool LineReader::fill() {
+  if (_fd < 0) {
+    _eof = true;
+    return false;
+  }
+  // keep the incomplete line at the front and read behind it
+  if (_begin > 0) {
+    std::memmove(&_buffer[0], _buffer.data() + _begin, _end - _begin);
+    _end -= _begin;
+    _begin = 0;
+  }
+  if (_end == _buffer.size()) {
+    _buffer.resize(_buffer.size() * 2);
+  }
+  ssize_t n;
+  do {
+    n = ::read(_fd, &_buffer[_end], _buffer.size() - _end);
+  } while (n < 0 && errno == EINTR);
+  HWINFO_TRACE_BYTES_READ(n);
+  if (n <= 0) {
+    _eof = true;
+    return false;
+  }
+  _end += static_cast<size_t>(n);
+  return true;
+}
 
-  const int64_t jiffies_0 = std::stol(results[1]);
-  const int64_t jiffies_1 = std::stol(results[2]);
-  const int64_t jiffies_2 = std::stol(results[3]);
-  const int64_t jiffies_3 = std::stol(results[4]);
-  const int64_t jiffies_4 = std::stol(results[5]);
-  const int64_t jiffies_5 = std::stol(results[6]);
-  const int64_t jiffies_6 = std::stol(results[7]);
-  const int64_t jiffies_7 = std::stol(results[8]);
-  const int64_t jiffies_8 = std::stol(results[9]);
-  const int64_t jiffies_9 = std::stol(results[10]);
+int64_t get_cached_value(const std::string& path) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::shared_ptr<const CachedFile>> files;
 
-  int64_t all = jiffies_0 + jiffies_1 + jiffies_2 + jiffies_3 + jiffies_4 + jiffies_5 + jiffies_6 + jiffies_7 +
-                jiffies_8 + jiffies_9;
-  int64_t working = jiffies_0 + jiffies_1 + jiffies_2;
+  // files of a previous root stay in the map (and open), see PerRoot
+  const std::string key = std::to_string(root_generation()) + ':' + path;
+  std::shared_ptr<const CachedFile> failed;
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    std::shared_ptr<const CachedFile> file;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = files.find(key);
+      if (it != files.end() && it->second == failed) {
+        // the descriptor failed to read (e.g. the device was removed, or removed and added again): drop it (closed with
+        // the last reader) and open the path once more
+        files.erase(it);
+        it = files.end();
+      }
+      if (it == files.end()) {
+        auto opened = std::make_shared<const CachedFile>(path);
+        if (!opened->valid()) {
+          // do not cache failures: the attribute may appear later (e.g. hotplug)
+          return -1;
+        }
+        it = files.emplace(key, std::move(opened)).first;
+      }
+      // shared, so that a thread may replace the entry while another one still reads through it
+      file = it->second;
+    }
+    int64_t value = -1;
+    if (file->read_int64(value)) {
+      return value;
+    }
+    failed = std::move(file);
+  }
+  return -1;
+}
 
-  return {all, working};
+const std::vector<CachedFile>& cpu_frequency_files() {
+  static const PerRoot<std::vector<CachedFile>> files([] {
+    std::vector<CachedFile> result;
+    for (int core_id = 0; /* breaks, if i is no valid cpu id */; ++core_id) {
+      CachedFile file("/sys/devices/system/cpu/cpu" + std::to_string(core_id) + "/cpufreq/scaling_cur_freq");
+      if (!file.valid()) {
+        break;
+      }
+      result.push_back(std::move(file));
+    }
+    return result;
+  });
+  return files.get();
 }
 
 }  // namespace filesystem
@@ -0,0 +1,124 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/utils/mountinfo.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/trace.h>
+#include <poll.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hwinfo {
+namespace utils {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+uint64_t device_key(uint32_t major, uint32_t minor) { return (static_cast<uint64_t>(major) << 32) | minor; }
+
+// _____________________________________________________________________________________________________________________
+// Decodes the octal escapes the kernel uses for blanks, tabs, newlines and backslashes in paths.
+std::string unescape(std::string_view field) {
+  std::string result;
+  result.reserve(field.size());
+  for (size_t i = 0; i < field.size(); ++i) {
+    if (field[i] == '\\' && i + 3 < field.size() && field[i + 1] >= '0' && field[i + 1] <= '3' &&
+        field[i + 2] >= '0' && field[i + 2] <= '7' && field[i + 3] >= '0' && field[i + 3] <= '7') {
+      result.push_back(static_cast<char>((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 + (field[i + 3] - '0')));
+      i += 3;
+    } else {
+      result.push_back(field[i]);
+    }
+  }
+  return result;
+}
+
+const std::vector<size_t> no_mounts;
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+MountIndex::MountIndex() : MountIndex("/proc/self/mountinfo") {}
+
+// _____________________________________________________________________________________________________________________
+MountIndex::MountIndex(const std::string& path) : _file(path) {}
+
+// _____________________________________________________________________________________________________________________
+bool MountIndex::refresh() {
+  HWINFO_TRACE_SCOPE(Mounts);
+  if (_parsed) {
+    pollfd fd{_file.fd(), POLLPRI, 0};
+    if (!_file.valid() || poll(&fd, 1, 0) <= 0 || (fd.revents & (POLLPRI | POLLERR)) == 0) {
+      return false;
+    }
+  }
+  parse();
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+void MountIndex::parse() {
+  _parsed = true;
+  _mounts.clear();
+  _by_device.clear();
+  _by_source.clear();
+  // reading the file also resets the change notification
+  if (!_file.read(_buffer)) {
+    return;
+  }
+  // "36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue"
+  NumberScanner scanner(_buffer);
+  do {
+    if (scanner.at_line_end()) {
+      continue;
+    }
+    Mount mount;
+    scanner.next_word();  // mount id
+    scanner.next_word();  // parent id
+    const std::string_view device = scanner.next_word();
+    const size_t colon = device.find(':');
+    if (colon == std::string_view::npos || !parse_int(device.substr(0, colon), mount.major) ||
+        !parse_int(device.substr(colon + 1), mount.minor)) {
+      continue;
+    }
+    mount.root = unescape(scanner.next_word());
+    mount.mount_point = unescape(scanner.next_word());
+    // mount options and a variable number of optional fields up to the separator
+    std::string_view word = scanner.next_word();
+    while (!word.empty() && word != "-") {
+      word = scanner.next_word();
+    }
+    mount.fs_type = unescape(scanner.next_word());
+    mount.source = unescape(scanner.next_word());
+    if (mount.mount_point.empty()) {
+      continue;
+    }
+    const size_t index = _mounts.size();
+    _by_device[device_key(mount.major, mount.minor)].push_back(index);
+    _by_source[mount.source].push_back(index);
+    _mounts.push_back(std::move(mount));
+  } while (scanner.next_line());
+}
+
+// _____________________________________________________________________________________________________________________
+const std::vector<size_t>& MountIndex::of_device(uint32_t major, uint32_t minor) const {
+  const auto it = _by_device.find(device_key(major, minor));
+  return it == _by_device.end() ? no_mounts : it->second;
+}
+
+// _____________________________________________________________________________________________________________________
+const std::vector<size_t>& MountIndex::of_source(std::string_view source) const {
+  const auto it = _by_source.find(std::string(source));
+  return it == _by_source.end() ? no_mounts : it->second;
+}
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -0,0 +1,141 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_UNIX
+
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/jiffies.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/proc_stat.h>
+
+#include <cstddef>
+#include <string_view>
+
+namespace hwinfo {
+namespace utils {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+const filesystem::CachedFile& proc_stat_file() {
+  // opened once per root and kept: pread() with offset 0 makes the kernel regenerate the content
+  static const filesystem::PerRoot<filesystem::CachedFile> file([] { return filesystem::CachedFile("/proc/stat"); });
+  return file.get();
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+bool StatSnapshot::update() {
+  // keep the allocated capacity of _threads, _times and _buffer
+  _total = Jiffies();
+  _total_times = CpuTimes();
+  for (auto& j : _threads) {
+    j = Jiffies();
+  }
+  for (auto& t : _times) {
+    t = CpuTimes();
+  }
+  if (!proc_stat_file().read(_buffer)) {
+    _buffer.clear();
+    _threads.clear();
+    _times.clear();
+    return false;
+  }
+
+  utils::NumberScanner scanner(_buffer);
+  size_t num_threads = 0;
+  // the cpu lines are always the first lines of /proc/stat
+  while (true) {
+    const std::string_view line = scanner.rest_of_line();
+    if (line.size() < 3 || line.compare(0, 3, "cpu") != 0) {
+      break;
+    }
+    utils::NumberScanner fields(line.data() + 3, line.data() + line.size());
+    int64_t thread_id = -1;
+    if (line.size() > 3 && utils::is_digit(line[3])) {
+      fields.next_uint(thread_id);
+    }
+    // user nice system idle iowait irq softirq steal guest guest_nice (older kernels report less columns)
+    int64_t values[10]{};
+    fields.read_uints(values, 10);
+    const CpuTimes times{values[0], values[1], values[2], values[3], values[4],
+                         values[5], values[6], values[7], values[8], values[9]};
+    // irq, softirq and steal are busy time, guest is counted in user already
+    const Jiffies jiffies(times.total(), times.busy());
+    if (thread_id < 0) {
+      _total = jiffies;
+      _total_times = times;
+    } else {
+      auto index = static_cast<size_t>(thread_id);
+      if (index >= _threads.size()) {
+        _threads.resize(index + 1);
+        _times.resize(index + 1);
+      }
+      _threads[index] = jiffies;
+      _times[index] = times;
+      num_threads = index + 1;
+    }
+    if (!scanner.next_line()) {
+      break;
+    }
+  }
+  _threads.resize(num_threads);
+  _times.resize(num_threads);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+const Jiffies& StatSnapshot::thread(int thread_id) const {
+  static const Jiffies invalid;
+  if (thread_id < 0 || static_cast<size_t>(thread_id) >= _threads.size()) {
+    return invalid;
+  }
+  return _threads[thread_id];
+}
+
+// _____________________________________________________________________________________________________________________
+const CpuTimes& StatSnapshot::times(int thread_id) const {
+  static const CpuTimes invalid;
+  if (thread_id < 0 || static_cast<size_t>(thread_id) >= _times.size()) {
+    return invalid;
+  }
+  return _times[thread_id];
+}
+
+// _____________________________________________________________________________________________________________________
+bool read_jiffies(Jiffies& total, std::vector<Jiffies>& threads) {
+  // one snapshot per thread, so that its buffer is reused without synchronization
+  thread_local StatSnapshot snapshot;
+  if (!snapshot.update()) {
+    return false;
+  }
+  total = snapshot.total();
+  threads.resize(snapshot.num_threads());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i] = snapshot.thread(static_cast<int>(i));
+  }
+  return true;
+}
+
+}  // namespace utils
+
+// _____________________________________________________________________________________________________________________
+bool readCpuTimes(CpuTimes& total, std::vector<CpuTimes>& threads) {
+  thread_local utils::StatSnapshot snapshot;
+  if (!snapshot.update()) {
+    return false;
+  }
+  total = snapshot.total_times();
+  threads.resize(snapshot.num_threads());
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i] = snapshot.times(static_cast<int>(i));
+  }
+  return true;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_UNIX
@@ -1,5 +1,10 @@
 
 #include <hwinfo/network.h>
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
@@ -17,4 +22,36 @@ const std::string& Network::ip4() const { return _ip4; }
 // _____________________________________________________________________________________________________________________
 const std::string& Network::ip6() const { return _ip6; }
 
+// _____________________________________________________________________________________________________________________
+const std::vector<std::string>& Network::ip4s() const { return _ip4s; }
+
+// _____________________________________________________________________________________________________________________
+const std::vector<std::string>& Network::ip6s() const { return _ip6s; }
+
+// _____________________________________________________________________________________________________________________
+std::vector<Network> getAllNetworks() { return getAllNetworks(NetworkFields::All); }
+
+#ifndef HWINFO_UNIX
+struct NetworkEnumerator::Source {
+  std::vector<Network> networks;
+  size_t next{0};
+};
+
+// _____________________________________________________________________________________________________________________
+NetworkEnumerator::NetworkEnumerator(NetworkFields fields) : _source(std::make_unique<Source>()) {
+  _source->networks = getAllNetworks(fields);
+}
+
+// _____________________________________________________________________________________________________________________
+NetworkEnumerator::~NetworkEnumerator() = default;
+
+// _____________________________________________________________________________________________________________________
+std::optional<Network> NetworkEnumerator::next() {
+  if (_source->next >= _source->networks.size()) {
+    return std::nullopt;
+  }
+  return std::move(_source->networks[_source->next++]);
+}
+#endif  // HWINFO_UNIX
+
 }  // namespace hwinfo
@@ -0,0 +1,69 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/network.h>
+#include <hwinfo/network_stats.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+std::vector<int> network_interface_indices() {
+  std::vector<int> indices;
+  for (const auto& network : getAllNetworks()) {
+    indices.push_back(utils::parse_int_or<int>(network.interfaceIndex(), -1));
+  }
+  return indices;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+NetworkStatsSampler::NetworkStatsSampler() : NetworkStatsSampler(network_interface_indices()) {}
+
+// _____________________________________________________________________________________________________________________
+bool NetworkStatsSampler::update() {
+  HWINFO_TRACE_SCOPE(NetworkStats);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  std::swap(_previous, _current);
+  std::fill(_current.begin(), _current.end(), Counters());
+  std::fill(_stats.begin(), _stats.end(), NetworkIOStats());
+  const bool success = read_counters();
+  const double period_s = static_cast<double>(now - _timestamp_ns) / 1e9;
+  const bool has_baseline = _has_baseline && period_s > 0;
+  _has_baseline = success;
+  _timestamp_ns = now;
+  if (!success || !has_baseline) {
+    return success;
+  }
+
+  for (size_t i = 0; i < _current.size(); ++i) {
+    const Counters& previous = _previous[i];
+    const Counters& current = _current[i];
+    NetworkIOStats& stats = _stats[i];
+    // -1 if either sample lacks the counter or it went backwards (interface recreated, 32 bit counter wrapped)
+    const auto rate = [&](int64_t before, int64_t after) {
+      return before < 0 || after < before ? -1.0 : static_cast<double>(after - before) / period_s;
+    };
+    stats.rx_Bytes_per_s = rate(previous.rx_Bytes, current.rx_Bytes);
+    stats.tx_Bytes_per_s = rate(previous.tx_Bytes, current.tx_Bytes);
+    stats.rx_packets_per_s = rate(previous.rx_packets, current.rx_packets);
+    stats.tx_packets_per_s = rate(previous.tx_packets, current.tx_packets);
+    stats.rx_errors_per_s = rate(previous.rx_errors, current.rx_errors);
+    stats.tx_errors_per_s = rate(previous.tx_errors, current.tx_errors);
+    stats.rx_drops_per_s = rate(previous.rx_drops, current.rx_drops);
+    stats.tx_drops_per_s = rate(previous.tx_drops, current.tx_drops);
+  }
+  return true;
+}
+
+}  // namespace hwinfo
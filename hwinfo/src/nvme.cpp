@@ -0,0 +1,46 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/nvme.h>
+#include <hwinfo/utils/trace.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+bool NvmeSampler::update() {
+  HWINFO_TRACE_SCOPE(Nvme);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  bool success = false;
+  for (size_t i = 0; i < _controllers.size(); ++i) {
+    if (_attempt_ns[i] < 0 || now - _attempt_ns[i] >= _refresh.count()) {
+      _attempt_ns[i] = now;
+      NvmeHealth health;
+      if (read_health(i, health)) {
+        health.timestamp_ns = now;
+        _health[i] = health;
+      }
+    }
+    success = success || _health[i].timestamp_ns >= 0;
+  }
+  return success;
+}
+
+#ifndef HWINFO_UNIX
+struct NvmeSampler::Source {};
+
+// _____________________________________________________________________________________________________________________
+NvmeSampler::NvmeSampler(std::chrono::nanoseconds refresh) : _refresh(refresh) {}
+
+// _____________________________________________________________________________________________________________________
+NvmeSampler::~NvmeSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool NvmeSampler::read_health(size_t, NvmeHealth&) { return false; }
+#endif  // HWINFO_UNIX
+
+}  // namespace hwinfo
@@ -0,0 +1,213 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/gpu.h>
+
+#ifdef USE_OCL
+
+#include <hwinfo/opencl/device.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// cl_khr_pci_bus_info, cl_nv_device_attribute_query and cl_amd_device_attribute_query, for headers without them
+#ifndef CL_DEVICE_PCI_BUS_INFO_KHR
+#define CL_DEVICE_PCI_BUS_INFO_KHR 0x410F
+#endif
+#ifndef CL_DEVICE_PCI_BUS_ID_NV
+#define CL_DEVICE_PCI_BUS_ID_NV 0x4008
+#endif
+#ifndef CL_DEVICE_PCI_SLOT_ID_NV
+#define CL_DEVICE_PCI_SLOT_ID_NV 0x4009
+#endif
+#ifndef CL_DEVICE_PCI_DOMAIN_ID_NV
+#define CL_DEVICE_PCI_DOMAIN_ID_NV 0x400A
+#endif
+#ifndef CL_DEVICE_TOPOLOGY_AMD
+#define CL_DEVICE_TOPOLOGY_AMD 0x4037
+#endif
+
+namespace hwinfo {
+
+namespace {
+
+// The values enrichWithOpenCL() sets, as of the first enumeration.
+struct OpenCLProperties {
+  std::string name;
+  std::string driver_version;
+  int64_t frequency_MHz{0};
+  int num_cores{0};
+  int64_t memory_Bytes{0};
+};
+
+// Layouts of CL_DEVICE_PCI_BUS_INFO_KHR and CL_DEVICE_TOPOLOGY_AMD.
+struct PciBusInfo {
+  cl_uint domain;
+  cl_uint bus;
+  cl_uint device;
+  cl_uint function;
+};
+union AmdTopology {
+  struct {
+    cl_uint type;
+    cl_uint data[5];
+  } raw;
+  struct {
+    cl_uint type;
+    cl_char unused[17];
+    cl_char bus;
+    cl_char device;
+    cl_char function;
+  } pcie;
+};
+constexpr cl_uint AMD_TOPOLOGY_TYPE_PCIE = 1;
+
+// _____________________________________________________________________________________________________________________
+// Same format as GPU::pciBusId(): "0000:01:00.0".
+std::string formatPciBusId(cl_uint domain, cl_uint bus, cl_uint device, cl_uint function) {
+  char id[16];
+  std::snprintf(id, sizeof(id), "%04x:%02x:%02x.%x", domain & 0xffff, bus & 0xff, device & 0x1f, function & 0x7);
+  return id;
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename T>
+bool deviceInfo(cl_device_id device, cl_device_info param, T& value) {
+  return clGetDeviceInfo(device, param, sizeof(T), &value, nullptr) == CL_SUCCESS;
+}
+
+// _____________________________________________________________________________________________________________________
+// PCI bus ID of an OpenCL device, empty if the platform reports none. The raw C API is used since the queries of
+// unsupported extensions are expected to fail.
+std::string pciBusIdOf(cl_device_id device) {
+  PciBusInfo info{};
+  if (deviceInfo(device, CL_DEVICE_PCI_BUS_INFO_KHR, info)) {
+    return formatPciBusId(info.domain, info.bus, info.device, info.function);
+  }
+  cl_uint bus = 0;
+  cl_uint slot = 0;
+  if (deviceInfo(device, CL_DEVICE_PCI_BUS_ID_NV, bus) && deviceInfo(device, CL_DEVICE_PCI_SLOT_ID_NV, slot)) {
+    cl_uint domain = 0;
+    deviceInfo(device, CL_DEVICE_PCI_DOMAIN_ID_NV, domain);
+    // slot: device << 3 | function
+    return formatPciBusId(domain, bus, slot >> 3, slot & 0x7);
+  }
+  AmdTopology topology{};
+  if (deviceInfo(device, CL_DEVICE_TOPOLOGY_AMD, topology) && topology.raw.type == AMD_TOPOLOGY_TYPE_PCIE) {
+    // the AMD extension has no domain
+    return formatPciBusId(0, static_cast<cl_uchar>(topology.pcie.bus), static_cast<cl_uchar>(topology.pcie.device),
+                          static_cast<cl_uchar>(topology.pcie.function));
+  }
+  return {};
+}
+
+// _____________________________________________________________________________________________________________________
+std::string toLower(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+  return value;
+}
+
+// The OpenCL GPUs of the first enrichWithOpenCL() call, keyed by PCI bus ID. Devices without one are kept by name.
+struct OpenCLGPUs {
+  std::map<std::string, OpenCLProperties> by_pci_bus_id;
+  std::vector<OpenCLProperties> without_pci_bus_id;
+};
+
+// _____________________________________________________________________________________________________________________
+OpenCLGPUs enumerateOpenCLGPUs() {
+  OpenCLGPUs gpus;
+  std::vector<cl::Platform> platforms;
+  try {
+    cl::Platform::get(&platforms);
+  } catch (const cl::Error&) {
+    // no ICD installed
+    return gpus;
+  }
+  for (const auto& platform : platforms) {
+    std::vector<cl::Device> devices;
+    try {
+      platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+    } catch (const cl::Error&) {
+      // CL_DEVICE_NOT_FOUND: a CPU-only platform
+      continue;
+    }
+    for (auto& cl_device : devices) {
+      try {
+        const std::string pci_bus_id = pciBusIdOf(cl_device());
+        // only the queried device is wrapped, for the core count estimation (name, vendor, compute units, clock)
+        const opencl_::Device device(0, std::move(cl_device));
+        OpenCLProperties properties;
+        properties.name = toLower(device.name());
+        properties.driver_version = device.driver_version();
+        properties.frequency_MHz = static_cast<int64_t>(device.clock_frequency_MHz());
+        properties.num_cores = static_cast<int>(device.cores());
+        properties.memory_Bytes = static_cast<int64_t>(device.memory_Bytes());
+        if (pci_bus_id.empty()) {
+          gpus.without_pci_bus_id.push_back(std::move(properties));
+        } else {
+          gpus.by_pci_bus_id.emplace(pci_bus_id, std::move(properties));
+        }
+      } catch (const cl::Error&) {
+        continue;
+      }
+    }
+  }
+  return gpus;
+}
+
+// _____________________________________________________________________________________________________________________
+// nullptr if no OpenCL device matches the GPU.
+const OpenCLProperties* find(const OpenCLGPUs& cl_gpus, const GPU& gpu) {
+  if (!gpu.pciBusId().empty()) {
+    auto it = cl_gpus.by_pci_bus_id.find(toLower(gpu.pciBusId()));
+    if (it != cl_gpus.by_pci_bus_id.end()) {
+      return &it->second;
+    }
+  }
+  const std::string name = toLower(gpu.name());
+  for (const auto& properties : cl_gpus.without_pci_bus_id) {
+    if (properties.name == name) {
+      return &properties;
+    }
+  }
+  if (gpu.pciBusId().empty()) {
+    // e.g. Windows: devices with a PCI bus ID are matchable by name as well
+    for (const auto& [pci_bus_id, properties] : cl_gpus.by_pci_bus_id) {
+      if (properties.name == name) {
+        return &properties;
+      }
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+void enrichWithOpenCL(std::vector<GPU>& gpus) {
+  static std::once_flag enumerated;
+  static OpenCLGPUs cl_gpus;
+  // later calls only read cl_gpus
+  std::call_once(enumerated, [] { cl_gpus = enumerateOpenCLGPUs(); });
+  for (auto& gpu : gpus) {
+    const OpenCLProperties* properties = find(cl_gpus, gpu);
+    if (properties == nullptr) {
+      continue;
+    }
+    gpu._driverVersion = properties->driver_version;
+    gpu._frequency_MHz = properties->frequency_MHz;
+    gpu._num_cores = properties->num_cores;
+    gpu._memory_Bytes = properties->memory_Bytes;
+  }
+}
+
+}  // namespace hwinfo
+
+#endif  // USE_OCL
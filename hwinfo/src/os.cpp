@@ -8,13 +8,13 @@
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
-std::string OS::name() const { return _name; }
+InternedString OS::name() const { return _name; }
 
 // _____________________________________________________________________________________________________________________
-std::string OS::version() const { return _version; }
+InternedString OS::version() const { return _version; }
 
 // _____________________________________________________________________________________________________________________
-std::string OS::kernel() const { return _kernel; }
+InternedString OS::kernel() const { return _kernel; }
 
 // _____________________________________________________________________________________________________________________
 bool OS::is32bit() const { return _32bit; }
@@ -0,0 +1,68 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/pressure.h>
+
+namespace hwinfo {
+
+#ifndef HWINFO_UNIX
+struct Pressure::Source {};
+struct PressureTrigger::Source {};
+
+// _____________________________________________________________________________________________________________________
+Pressure::Pressure(PressureResource /*resource*/) {}
+
+// _____________________________________________________________________________________________________________________
+Pressure::~Pressure() = default;
+
+// _____________________________________________________________________________________________________________________
+Pressure::Pressure(Pressure&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Pressure& Pressure::operator=(Pressure&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+Pressure Pressure::cgroup(PressureResource /*resource*/) { return {}; }
+
+// _____________________________________________________________________________________________________________________
+bool Pressure::valid() const { return false; }
+
+// _____________________________________________________________________________________________________________________
+bool Pressure::read(PressureStats& stats) const {
+  stats = PressureStats();
+  return false;
+}
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger::PressureTrigger(PressureResource /*resource*/, Kind /*kind*/, std::chrono::microseconds /*stall*/,
+                                 std::chrono::microseconds /*window*/) {}
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger::~PressureTrigger() = default;
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger::PressureTrigger(PressureTrigger&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger& PressureTrigger::operator=(PressureTrigger&& other) noexcept = default;
+
+// _____________________________________________________________________________________________________________________
+PressureTrigger PressureTrigger::cgroup(PressureResource /*resource*/, Kind /*kind*/,
+                                        std::chrono::microseconds /*stall*/, std::chrono::microseconds /*window*/) {
+  return {};
+}
+
+// _____________________________________________________________________________________________________________________
+bool PressureTrigger::valid() const { return false; }
+
+// _____________________________________________________________________________________________________________________
+int PressureTrigger::fd() const { return -1; }
+
+// _____________________________________________________________________________________________________________________
+bool PressureTrigger::wait(std::chrono::milliseconds /*timeout*/) { return false; }
+
+// _____________________________________________________________________________________________________________________
+void PressureTrigger::interrupt() {}
+#endif  // HWINFO_UNIX
+
+}  // namespace hwinfo
@@ -0,0 +1,67 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/process_stats.h>
+#include <hwinfo/utils/jiffies.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+bool ProcessSampler::update() {
+  HWINFO_TRACE_SCOPE(ProcessStats);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  std::swap(_previous, _current);
+  std::fill(_current.begin(), _current.end(), Counters());
+  std::fill(_cpu_utilisation.begin(), _cpu_utilisation.end(), -1.0);
+  std::fill(_read_Bytes_per_s.begin(), _read_Bytes_per_s.end(), -1.0);
+  std::fill(_written_Bytes_per_s.begin(), _written_Bytes_per_s.end(), -1.0);
+  _previous_total = _current_total;
+  if (!utils::read_jiffies(_current_total, _threads)) {
+    _current_total = Jiffies();
+  }
+  const bool success = read_counters();
+  for (size_t i = 0; i < _current.size(); ++i) {
+    _rss_Bytes[i] = _current[i].rss_Bytes;
+  }
+  const double period_s = static_cast<double>(now - _timestamp_ns) / 1e9;
+  const bool has_baseline = _has_baseline && period_s > 0;
+  _has_baseline = success;
+  _timestamp_ns = now;
+  if (!success || !has_baseline) {
+    return success;
+  }
+
+  // cpu time of all logical cpus over the period, in ns
+  const double system_ns = _previous_total.all < 0 || _current_total.all <= _previous_total.all || _jiffy_ns <= 0
+                               ? -1.0
+                               : static_cast<double>(_current_total.all - _previous_total.all) * _jiffy_ns;
+  for (size_t i = 0; i < _current.size(); ++i) {
+    const Counters& previous = _previous[i];
+    const Counters& current = _current[i];
+    // -1 if either sample lacks the counter or it went backwards (process replaced)
+    const auto delta = [](int64_t before, int64_t after) -> int64_t {
+      return before < 0 || after < before ? -1 : after - before;
+    };
+    const auto rate = [&](int64_t before, int64_t after) {
+      const int64_t d = delta(before, after);
+      return d < 0 ? -1.0 : static_cast<double>(d) / period_s;
+    };
+    const int64_t cpu_ns = delta(previous.cpu_time_ns, current.cpu_time_ns);
+    if (cpu_ns >= 0 && system_ns > 0) {
+      // both clocks tick at a coarse granularity, a fully busy process may exceed the system time slightly
+      _cpu_utilisation[i] = std::min(static_cast<double>(cpu_ns) / system_ns, 1.0);
+    }
+    _read_Bytes_per_s[i] = rate(previous.read_Bytes, current.read_Bytes);
+    _written_Bytes_per_s[i] = rate(previous.written_Bytes, current.written_Bytes);
+  }
+  return true;
+}
+
+}  // namespace hwinfo
@@ -1,10 +1,33 @@
 // Copyright (c) Leon Freist <freist@informatik.uni-freiburg.de>
 // This software is part of HWBenchmark
 
+#include <hwinfo/cgroup.h>
 #include <hwinfo/ram.h>
 
+#include <algorithm>
+
 namespace hwinfo {
 
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// Limits the values of a snapshot to what the cgroup may still use (see Cgroup::set_apply_limits()).
+void apply_cgroup_limits(MemorySnapshot& snapshot) {
+  const Cgroup& cgroup = Cgroup::get();
+  const int64_t max = cgroup.memory_max_Bytes();
+  if (max < 0) {
+    return;
+  }
+  const int64_t current = cgroup.memory_current_Bytes();
+  const int64_t headroom = current < 0 ? max : std::max<int64_t>(max - current, 0);
+  const auto limit = [](int64_t value, int64_t bound) { return value < 0 ? bound : std::min(value, bound); };
+  snapshot.total_Bytes = limit(snapshot.total_Bytes, max);
+  snapshot.free_Bytes = limit(snapshot.free_Bytes, headroom);
+  snapshot.available_Bytes = limit(snapshot.available_Bytes, headroom);
+}
+
+}  // namespace
+
 // _____________________________________________________________________________________________________________________
 const std::vector<Memory::Module>& Memory::modules() const { return _modules; }
 
@@ -14,7 +37,26 @@ int64_t Memory::total_Bytes() const {
   for (const auto& module : _modules) {
     sum += module.total_Bytes;
   }
+  if (Cgroup::apply_limits()) {
+    const int64_t max = Cgroup::get().memory_max_Bytes();
+    return max < 0 || (sum > 0 && sum < max) ? sum : max;
+  }
   return sum;
 }
 
+// _____________________________________________________________________________________________________________________
+int64_t Memory::free_Bytes() const { return snapshot().free_Bytes; }
+
+// _____________________________________________________________________________________________________________________
+int64_t Memory::available_Bytes() const { return snapshot().available_Bytes; }
+
+// _____________________________________________________________________________________________________________________
+MemorySnapshot Memory::snapshot() const {
+  MemorySnapshot snapshot;
+  if (snapshot.update() && Cgroup::apply_limits()) {
+    apply_cgroup_limits(snapshot);
+  }
+  return snapshot;
+}
+
 }  // namespace hwinfo
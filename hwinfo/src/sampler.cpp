@@ -0,0 +1,308 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/sampler.h>
+#include <hwinfo/shared_frame.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+size_t round_up_to_power_of_two(size_t value) {
+  size_t result = 2;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t to_ns(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+Sampler::Sampler(std::chrono::nanoseconds interval, size_t capacity)
+    : _interval(std::max(interval, std::chrono::nanoseconds(1))), _capacity(round_up_to_power_of_two(capacity)) {
+  start(std::string());
+}
+
+// _____________________________________________________________________________________________________________________
+Sampler::Sampler(std::chrono::nanoseconds interval, size_t capacity, const std::string& shared_name)
+    : _interval(std::max(interval, std::chrono::nanoseconds(1))), _capacity(round_up_to_power_of_two(capacity)) {
+  start(shared_name);
+}
+
+// _____________________________________________________________________________________________________________________
+void Sampler::start(const std::string& shared_name) {
+  auto cpus = getAllCPUs();
+  if (!cpus.empty()) {
+    _cpu.emplace(std::move(cpus.front()));
+    // querying with capacity 0 only returns the number of threads
+    _num_threads = std::max({0, _cpu->threadsUtilisation(nullptr, 0), _cpu->currentClockSpeed_MHz(nullptr, 0)});
+  }
+  _batteries = getAllBatteries();
+  _num_disks = static_cast<int>(_disks.size());
+  _num_networks = static_cast<int>(_networks.size());
+  _num_gpus = static_cast<int>(_gpus.size());
+  if (!shared_name.empty()) {
+    _publisher = std::make_unique<SharedFramePublisher>(shared_name, _interval, _num_threads, _disks.device_names(),
+                                                        _networks.interface_indices(), _gpus.pci_bus_ids());
+    if (!_publisher->valid()) {
+      _publisher.reset();
+    }
+  }
+
+  const size_t slots = _capacity + (_publisher ? 1 : 0);
+  _frames.resize(slots);
+  _thread_utilisation.resize(slots * _num_threads, -1.0);
+  _thread_speed_MHz.resize(slots * _num_threads, -1);
+  _disk_stats.resize(slots * _num_disks);
+  _network_stats.resize(slots * _num_networks);
+  _gpu_stats.resize(slots * _num_gpus);
+
+  _running = true;
+  _thread = std::thread(&Sampler::run, this);
+}
+
+// _____________________________________________________________________________________________________________________
+Sampler::~Sampler() { stop(); }
+
+// _____________________________________________________________________________________________________________________
+void Sampler::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_stop_mutex);
+    _stop = true;
+  }
+  _stop_cv.notify_all();
+  std::call_once(_join_once, [this] {
+    if (_thread.joinable()) {
+      _thread.join();
+    }
+  });
+  _running = false;
+}
+
+// _____________________________________________________________________________________________________________________
+bool Sampler::running() const { return _running; }
+
+// _____________________________________________________________________________________________________________________
+bool Sampler::publishing() const { return _publisher != nullptr; }
+
+// _____________________________________________________________________________________________________________________
+uint64_t Sampler::dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+// _____________________________________________________________________________________________________________________
+size_t Sampler::drain(MetricFrame* frames, size_t max_frames, double* thread_utilisation, int64_t* thread_speed_MHz,
+                      DiskIOStats* disk_stats, NetworkIOStats* network_stats, GPUStats* gpu_stats) {
+  std::lock_guard<std::mutex> lock(_drain_mutex);
+  const uint64_t head = _head.load(std::memory_order_relaxed);
+  const uint64_t tail = _tail.load(std::memory_order_acquire);
+  const auto count = static_cast<size_t>(std::min<uint64_t>(tail - head, max_frames));
+  const auto num_threads = static_cast<size_t>(_num_threads);
+  const auto num_disks = static_cast<size_t>(_num_disks);
+  const auto num_networks = static_cast<size_t>(_num_networks);
+  const auto num_gpus = static_cast<size_t>(_num_gpus);
+  for (size_t i = 0; i < count; ++i) {
+    const size_t slot = (head + i) & (_capacity - 1);
+    frames[i] = _frames[slot];
+    if (thread_utilisation != nullptr) {
+      std::copy_n(_thread_utilisation.data() + slot * num_threads, num_threads, thread_utilisation + i * num_threads);
+    }
+    if (thread_speed_MHz != nullptr) {
+      std::copy_n(_thread_speed_MHz.data() + slot * num_threads, num_threads, thread_speed_MHz + i * num_threads);
+    }
+    if (disk_stats != nullptr) {
+      std::copy_n(_disk_stats.data() + slot * num_disks, num_disks, disk_stats + i * num_disks);
+    }
+    if (network_stats != nullptr) {
+      std::copy_n(_network_stats.data() + slot * num_networks, num_networks, network_stats + i * num_networks);
+    }
+    if (gpu_stats != nullptr) {
+      std::copy_n(_gpu_stats.data() + slot * num_gpus, num_gpus, gpu_stats + i * num_gpus);
+    }
+  }
+  // hands the slots back to the sampler thread
+  _head.store(head + count, std::memory_order_release);
+  return count;
+}
+
+// _____________________________________________________________________________________________________________________
+size_t Sampler::drain(std::vector<MetricFrame>& frames, std::vector<double>* thread_utilisation,
+                      std::vector<int64_t>* thread_speed_MHz, std::vector<DiskIOStats>* disk_stats,
+                      std::vector<NetworkIOStats>* network_stats, std::vector<GPUStats>* gpu_stats) {
+  // the buffer never holds more than _capacity frames
+  const size_t offset = frames.size();
+  const auto num_threads = static_cast<size_t>(_num_threads);
+  const auto num_disks = static_cast<size_t>(_num_disks);
+  const auto num_networks = static_cast<size_t>(_num_networks);
+  const auto num_gpus = static_cast<size_t>(_num_gpus);
+  frames.resize(offset + _capacity);
+  double* utilisation_out = nullptr;
+  if (thread_utilisation != nullptr) {
+    thread_utilisation->resize((offset + _capacity) * num_threads);
+    utilisation_out = thread_utilisation->data() + offset * num_threads;
+  }
+  int64_t* speed_out = nullptr;
+  if (thread_speed_MHz != nullptr) {
+    thread_speed_MHz->resize((offset + _capacity) * num_threads);
+    speed_out = thread_speed_MHz->data() + offset * num_threads;
+  }
+  DiskIOStats* disk_out = nullptr;
+  if (disk_stats != nullptr) {
+    disk_stats->resize((offset + _capacity) * num_disks);
+    disk_out = disk_stats->data() + offset * num_disks;
+  }
+  NetworkIOStats* network_out = nullptr;
+  if (network_stats != nullptr) {
+    network_stats->resize((offset + _capacity) * num_networks);
+    network_out = network_stats->data() + offset * num_networks;
+  }
+  GPUStats* gpu_out = nullptr;
+  if (gpu_stats != nullptr) {
+    gpu_stats->resize((offset + _capacity) * num_gpus);
+    gpu_out = gpu_stats->data() + offset * num_gpus;
+  }
+  const size_t count =
+      drain(frames.data() + offset, _capacity, utilisation_out, speed_out, disk_out, network_out, gpu_out);
+  frames.resize(offset + count);
+  if (thread_utilisation != nullptr) {
+    thread_utilisation->resize((offset + count) * num_threads);
+  }
+  if (thread_speed_MHz != nullptr) {
+    thread_speed_MHz->resize((offset + count) * num_threads);
+  }
+  if (disk_stats != nullptr) {
+    disk_stats->resize((offset + count) * num_disks);
+  }
+  if (network_stats != nullptr) {
+    network_stats->resize((offset + count) * num_networks);
+  }
+  if (gpu_stats != nullptr) {
+    gpu_stats->resize((offset + count) * num_gpus);
+  }
+  return count;
+}
+
+// _____________________________________________________________________________________________________________________
+void Sampler::run() {
+  if (_cpu) {
+    // baselines for the utilisation of the first tick
+    _cpu->currentUtilisation();
+    _cpu->threadsUtilisation(nullptr, 0);
+  }
+  _disks.update();
+  _networks.update();
+  _gpus.update();
+  auto last_sample = std::chrono::steady_clock::now();
+  auto deadline = last_sample + _interval;
+  uint64_t sequence = 0;
+
+  std::unique_lock<std::mutex> lock(_stop_mutex);
+  while (!_stop_cv.wait_until(lock, deadline, [this] { return _stop; })) {
+    lock.unlock();
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t tail = _tail.load(std::memory_order_relaxed);
+    const bool full = tail - _head.load(std::memory_order_acquire) >= _capacity;
+    if (full) {
+      // the tick is skipped (the next frame covers the skipped period), or only read into the spare slot to publish it
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!full || _publisher) {
+      const size_t slot = full ? _capacity : tail & (_capacity - 1);
+      tick(slot, now, now - last_sample);
+      _frames[slot].sequence = sequence;
+      last_sample = now;
+      if (_publisher) {
+        _publisher->publish(_frames[slot], _thread_utilisation.data() + slot * _num_threads,
+                            _thread_speed_MHz.data() + slot * _num_threads, _disk_stats.data() + slot * _num_disks,
+                            _network_stats.data() + slot * _num_networks, _gpu_stats.data() + slot * _num_gpus);
+      }
+      if (!full) {
+        // publishes the slot to the consumers
+        _tail.store(tail + 1, std::memory_order_release);
+      }
+    }
+    ++sequence;
+
+    // next deadline on the fixed grid, ticks that were missed entirely are skipped
+    deadline += _interval;
+    const auto after = std::chrono::steady_clock::now();
+    if (deadline <= after) {
+      const auto missed = (after - deadline) / _interval + 1;
+      deadline += missed * _interval;
+    }
+    lock.lock();
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void Sampler::tick(size_t slot, std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration period) {
+  MetricFrame& frame = _frames[slot];
+  frame = MetricFrame();
+  frame.timestamp_ns = to_ns(now.time_since_epoch());
+  frame.period_ns = to_ns(period);
+  frame.num_threads = _num_threads;
+  frame.num_disks = _num_disks;
+  frame.num_networks = _num_networks;
+  frame.num_gpus = _num_gpus;
+
+  double* utilisation = _thread_utilisation.data() + slot * _num_threads;
+  int64_t* speed = _thread_speed_MHz.data() + slot * _num_threads;
+  std::fill_n(utilisation, _num_threads, -1.0);
+  std::fill_n(speed, _num_threads, -1);
+  if (_cpu) {
+    frame.cpu_utilisation = _cpu->currentUtilisation();
+    _cpu->threadsUtilisation(utilisation, _num_threads);
+    bool effective = false;
+    if (_frequencies.update()) {
+      // -1 on the first tick (no baseline yet) and for cpus with only a cycle counter
+      const FrequencyStats* frequencies = _frequencies.stats();
+      const size_t count = std::min(_frequencies.size(), static_cast<size_t>(_num_threads));
+      for (size_t i = 0; i < count; ++i) {
+        if (frequencies[i].busy_MHz >= 0) {
+          speed[i] = std::llround(frequencies[i].busy_MHz);
+          effective = true;
+        }
+      }
+    }
+    if (!effective) {
+      _cpu->currentClockSpeed_MHz(speed, _num_threads);
+    }
+  }
+
+  if (_memory.update()) {
+    frame.memory_free_Bytes = _memory.free_Bytes;
+    frame.memory_available_Bytes = _memory.available_Bytes;
+  }
+
+  // all -1 if the counters could not be read
+  _disks.update();
+  std::copy_n(_disks.stats(), _num_disks, _disk_stats.data() + slot * _num_disks);
+  _networks.update();
+  std::copy_n(_networks.stats(), _num_networks, _network_stats.data() + slot * _num_networks);
+  _gpus.update();
+  std::copy_n(_gpus.stats(), _num_gpus, _gpu_stats.data() + slot * _num_gpus);
+
+  if (!_batteries.empty()) {
+    frame.battery_energy_now = 0;
+    frame.battery_charging = 0;
+    for (const auto& battery : _batteries) {
+      // one read for both values
+      const BatteryStatus status = battery.status();
+      frame.battery_energy_now += std::max<int64_t>(status.energyNow, 0);
+      if (status.charging) {
+        frame.battery_charging = 1;
+      }
+    }
+  }
+}
+
+}  // namespace hwinfo
@@ -0,0 +1,25 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/sensors.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+bool SensorSampler::update() {
+  HWINFO_TRACE_SCOPE(Sensors);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+  std::fill(_values.begin(), _values.end(), std::numeric_limits<double>::quiet_NaN());
+  const bool success = read_values(now);
+  _timestamp_ns = now;
+  return success;
+}
+
+}  // namespace hwinfo
@@ -0,0 +1,467 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/shared_frame.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef HWINFO_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace hwinfo {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x46535748;  // "HWSF"
+constexpr uint32_t kVersion = 1;
+// bound of every dimension of a segment, guards the layout computation against corrupt headers
+constexpr int32_t kMaxValues = 1 << 16;
+// attempts of a read() while the publisher keeps writing, the first ones without yielding
+constexpr int kMaxAttempts = 1024;
+constexpr int kSpinAttempts = 64;
+
+// The segment starts with the header, followed by the names of the disks and GPUs (each terminated by '\0'), the
+// network interface indices (int32_t) and the frame: MetricFrame, thread utilisation, thread speed, DiskIOStats,
+// NetworkIOStats and GPUStats. The header is written once before magic, only the frame changes afterwards.
+struct Header {
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  uint64_t size;
+  int64_t interval_ns;
+  int32_t num_threads;
+  int32_t num_disks;
+  int32_t num_networks;
+  int32_t num_gpus;
+  uint64_t names_size;
+  std::atomic<uint32_t> closed;
+  // seqlock of the frame: odd while the publisher writes, twice the number of published frames otherwise
+  alignas(64) std::atomic<uint64_t> sequence;
+};
+
+// the atomics are shared between processes
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared atomics must be lock free");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock free");
+static_assert(std::is_trivially_copyable<MetricFrame>::value, "MetricFrame must be trivially copyable");
+
+struct Layout {
+  size_t names_offset{0};
+  size_t indices_offset{0};
+  size_t frame_offset{0};
+  size_t utilisation_offset{0};
+  size_t speed_offset{0};
+  size_t disks_offset{0};
+  size_t networks_offset{0};
+  size_t gpus_offset{0};
+  size_t size{0};
+};
+
+// _____________________________________________________________________________________________________________________
+size_t align_up(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+// _____________________________________________________________________________________________________________________
+Layout layout_of(size_t num_threads, size_t num_disks, size_t num_networks, size_t num_gpus, size_t names_size) {
+  Layout layout;
+  layout.names_offset = align_up(sizeof(Header), 64);
+  layout.indices_offset = align_up(layout.names_offset + names_size, alignof(int32_t));
+  // the frame gets its own cache lines
+  layout.frame_offset = align_up(layout.indices_offset + num_networks * sizeof(int32_t), 64);
+  layout.utilisation_offset = layout.frame_offset + sizeof(MetricFrame);
+  layout.speed_offset = layout.utilisation_offset + num_threads * sizeof(double);
+  layout.disks_offset = layout.speed_offset + num_threads * sizeof(int64_t);
+  layout.networks_offset = layout.disks_offset + num_disks * sizeof(DiskIOStats);
+  layout.gpus_offset = layout.networks_offset + num_networks * sizeof(NetworkIOStats);
+  layout.size = layout.gpus_offset + num_gpus * sizeof(GPUStats);
+  return layout;
+}
+
+// _____________________________________________________________________________________________________________________
+bool is_valid_name(const std::string& name) {
+  return !name.empty() && name.size() <= 200 && name.find_first_of("/\\") == std::string::npos;
+}
+
+// A mapping of a segment, unmapped by the destructor.
+struct Segment {
+  void* data{nullptr};
+  size_t size{0};
+#ifdef HWINFO_WINDOWS
+  HANDLE handle{nullptr};
+#else
+  // kept open by the publisher to recognise its segment when removing the name
+  int fd{-1};
+#endif
+
+  Segment() = default;
+  Segment(const Segment&) = delete;
+  Segment& operator=(const Segment&) = delete;
+
+  ~Segment() {
+#ifdef HWINFO_WINDOWS
+    if (data != nullptr) {
+      UnmapViewOfFile(data);
+    }
+    if (handle != nullptr) {
+      CloseHandle(handle);
+    }
+#else
+    if (data != nullptr) {
+      munmap(data, size);
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+#endif
+  }
+};
+
+#ifdef HWINFO_WINDOWS
+// _____________________________________________________________________________________________________________________
+std::string segment_path(const std::string& name) { return "Local\\" + name; }
+
+// _____________________________________________________________________________________________________________________
+bool create_segment(const std::string& name, size_t size, Segment& segment) {
+  const auto size64 = static_cast<uint64_t>(size);
+  segment.handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                      static_cast<DWORD>(size64 & 0xffffffff), segment_path(name).c_str());
+  if (segment.handle == nullptr || GetLastError() == ERROR_ALREADY_EXISTS) {
+    // the mapping of a running publisher (maybe of another size) cannot be replaced
+    return false;
+  }
+  segment.data = MapViewOfFile(segment.handle, FILE_MAP_WRITE, 0, 0, size);
+  segment.size = size;
+  return segment.data != nullptr;
+}
+
+// _____________________________________________________________________________________________________________________
+bool open_segment(const std::string& name, Segment& segment) {
+  segment.handle = OpenFileMappingA(FILE_MAP_READ, FALSE, segment_path(name).c_str());
+  if (segment.handle == nullptr) {
+    return false;
+  }
+  segment.data = MapViewOfFile(segment.handle, FILE_MAP_READ, 0, 0, 0);
+  MEMORY_BASIC_INFORMATION info{};
+  if (segment.data == nullptr || VirtualQuery(segment.data, &info, sizeof(info)) == 0) {
+    return false;
+  }
+  // whole pages, the header tells the actual size
+  segment.size = info.RegionSize;
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+// The mapping disappears with the last handle.
+void remove_segment(const std::string& /*name*/, const Segment& /*segment*/) {}
+#else
+// _____________________________________________________________________________________________________________________
+std::string segment_path(const std::string& name) { return "/" + name; }
+
+// _____________________________________________________________________________________________________________________
+bool create_segment(const std::string& name, size_t size, Segment& segment) {
+  const std::string path = segment_path(name);
+  // a segment left behind by a publisher that was killed, or the segment of a publisher that is replaced
+  shm_unlink(path.c_str());
+  segment.fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (segment.fd < 0) {
+    return false;
+  }
+  if (ftruncate(segment.fd, static_cast<off_t>(size)) != 0) {
+    shm_unlink(path.c_str());
+    return false;
+  }
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+  if (data == MAP_FAILED) {
+    shm_unlink(path.c_str());
+    return false;
+  }
+  segment.data = data;
+  segment.size = size;
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+bool open_segment(const std::string& name, Segment& segment) {
+  const int fd = shm_open(segment_path(name).c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st {};
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header))) {
+    data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  // the mapping keeps the segment alive
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  segment.data = data;
+  segment.size = static_cast<size_t>(st.st_size);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+// Removes the name unless a newer publisher already replaced the segment.
+void remove_segment(const std::string& name, const Segment& segment) {
+  const std::string path = segment_path(name);
+  const int fd = shm_open(path.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return;
+  }
+  struct stat current {};
+  struct stat own {};
+  if (fstat(fd, &current) == 0 && fstat(segment.fd, &own) == 0 && current.st_dev == own.st_dev &&
+      current.st_ino == own.st_ino) {
+    shm_unlink(path.c_str());
+  }
+  close(fd);
+}
+#endif
+
+// _____________________________________________________________________________________________________________________
+// Copies count values into the segment, fallback for all of them without values.
+template <typename T>
+void write_values(const T* values, size_t count, const T& fallback, char* out) {
+  if (values != nullptr) {
+    std::memcpy(out, values, count * sizeof(T));
+  } else {
+    std::fill_n(reinterpret_cast<T*>(out), count, fallback);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename T>
+void read_values(const char* in, size_t count, T* values) {
+  if (values != nullptr) {
+    std::memcpy(values, in, count * sizeof(T));
+  }
+}
+
+}  // namespace
+
+struct SharedFramePublisher::Source {
+  Segment segment;
+  Header* header{nullptr};
+  Layout layout;
+  size_t num_threads{0};
+  size_t num_disks{0};
+  size_t num_networks{0};
+  size_t num_gpus{0};
+};
+
+// _____________________________________________________________________________________________________________________
+SharedFramePublisher::SharedFramePublisher(const std::string& name, std::chrono::nanoseconds interval, int num_threads,
+                                           const std::vector<std::string>& disk_names,
+                                           const std::vector<int>& network_indices,
+                                           const std::vector<std::string>& gpu_pci_bus_ids)
+    : _name(name) {
+  if (!is_valid_name(name) || num_threads < 0 || num_threads > kMaxValues || disk_names.size() > kMaxValues ||
+      network_indices.size() > kMaxValues || gpu_pci_bus_ids.size() > kMaxValues) {
+    return;
+  }
+  std::string names;
+  for (const auto* list : {&disk_names, &gpu_pci_bus_ids}) {
+    for (const std::string& value : *list) {
+      // a name must not end early
+      names.append(value.c_str());
+      names.push_back('\0');
+    }
+  }
+  auto source = std::make_unique<Source>();
+  source->num_threads = static_cast<size_t>(num_threads);
+  source->num_disks = disk_names.size();
+  source->num_networks = network_indices.size();
+  source->num_gpus = gpu_pci_bus_ids.size();
+  source->layout =
+      layout_of(source->num_threads, source->num_disks, source->num_networks, source->num_gpus, names.size());
+  if (!create_segment(name, source->layout.size, source->segment)) {
+    return;
+  }
+
+  char* base = static_cast<char*>(source->segment.data);
+  // the new mapping is zeroed: sequence 0, nothing published yet
+  auto* header = new (base) Header{};
+  header->version = kVersion;
+  header->size = source->layout.size;
+  header->interval_ns = interval.count();
+  header->num_threads = num_threads;
+  header->num_disks = static_cast<int32_t>(source->num_disks);
+  header->num_networks = static_cast<int32_t>(source->num_networks);
+  header->num_gpus = static_cast<int32_t>(source->num_gpus);
+  header->names_size = names.size();
+  std::memcpy(base + source->layout.names_offset, names.data(), names.size());
+  for (size_t i = 0; i < network_indices.size(); ++i) {
+    const auto index = static_cast<int32_t>(network_indices[i]);
+    std::memcpy(base + source->layout.indices_offset + i * sizeof(int32_t), &index, sizeof(index));
+  }
+  // readers check the magic first: the rest of the header is complete once it is visible
+  header->magic.store(kMagic, std::memory_order_release);
+  source->header = header;
+  _source = std::move(source);
+}
+
+// _____________________________________________________________________________________________________________________
+SharedFramePublisher::~SharedFramePublisher() {
+  if (_source) {
+    _source->header->closed.store(1, std::memory_order_release);
+    remove_segment(_name, _source->segment);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+bool SharedFramePublisher::valid() const { return _source != nullptr; }
+
+// _____________________________________________________________________________________________________________________
+void SharedFramePublisher::publish(const MetricFrame& frame, const double* thread_utilisation,
+                                   const int64_t* thread_speed_MHz, const DiskIOStats* disk_stats,
+                                   const NetworkIOStats* network_stats, const GPUStats* gpu_stats) {
+  if (!_source) {
+    return;
+  }
+  Source& source = *_source;
+  char* base = static_cast<char*>(source.segment.data);
+  const Layout& layout = source.layout;
+  const uint64_t sequence = source.header->sequence.load(std::memory_order_relaxed);
+  source.header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  // the odd sequence is visible before any value of the frame changes
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(base + layout.frame_offset, &frame, sizeof(MetricFrame));
+  write_values(thread_utilisation, source.num_threads, -1.0, base + layout.utilisation_offset);
+  write_values(thread_speed_MHz, source.num_threads, int64_t{-1}, base + layout.speed_offset);
+  write_values(disk_stats, source.num_disks, DiskIOStats(), base + layout.disks_offset);
+  write_values(network_stats, source.num_networks, NetworkIOStats(), base + layout.networks_offset);
+  write_values(gpu_stats, source.num_gpus, GPUStats(), base + layout.gpus_offset);
+  source.header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+struct SharedFrameReader::Source {
+  Segment segment;
+  const Header* header{nullptr};
+  Layout layout;
+};
+
+// _____________________________________________________________________________________________________________________
+SharedFrameReader::SharedFrameReader(const std::string& name) {
+  auto source = std::make_unique<Source>();
+  if (!is_valid_name(name) || !open_segment(name, source->segment) || source->segment.size < sizeof(Header)) {
+    return;
+  }
+  const char* base = static_cast<const char*>(source->segment.data);
+  const auto* header = reinterpret_cast<const Header*>(base);
+  if (header->magic.load(std::memory_order_acquire) != kMagic || header->version != kVersion) {
+    return;
+  }
+  for (int32_t count : {header->num_threads, header->num_disks, header->num_networks, header->num_gpus}) {
+    if (count < 0 || count > kMaxValues) {
+      return;
+    }
+  }
+  if (header->names_size > source->segment.size) {
+    return;
+  }
+  const auto names_size = static_cast<size_t>(header->names_size);
+  source->layout =
+      layout_of(header->num_threads, header->num_disks, header->num_networks, header->num_gpus, names_size);
+  if (header->size != source->layout.size || source->layout.size > source->segment.size) {
+    return;
+  }
+
+  // the names of the disks, then those of the GPUs
+  std::vector<std::string> names;
+  const char* names_begin = base + source->layout.names_offset;
+  const char* names_end = names_begin + names_size;
+  for (const char* name_begin = names_begin; name_begin < names_end;) {
+    const char* name_end = std::find(name_begin, names_end, '\0');
+    if (name_end == names_end) {
+      return;
+    }
+    names.emplace_back(name_begin, name_end);
+    name_begin = name_end + 1;
+  }
+  if (names.size() != static_cast<size_t>(header->num_disks) + static_cast<size_t>(header->num_gpus)) {
+    return;
+  }
+  _disk_names.assign(names.begin(), names.begin() + header->num_disks);
+  _gpu_pci_bus_ids.assign(names.begin() + header->num_disks, names.end());
+  _network_indices.resize(static_cast<size_t>(header->num_networks));
+  for (size_t i = 0; i < _network_indices.size(); ++i) {
+    int32_t index = 0;
+    std::memcpy(&index, base + source->layout.indices_offset + i * sizeof(int32_t), sizeof(index));
+    _network_indices[i] = index;
+  }
+  _num_threads = header->num_threads;
+  _interval = std::chrono::nanoseconds(header->interval_ns);
+  source->header = header;
+  _source = std::move(source);
+}
+
+// _____________________________________________________________________________________________________________________
+SharedFrameReader::~SharedFrameReader() = default;
+
+// _____________________________________________________________________________________________________________________
+bool SharedFrameReader::valid() const { return _source != nullptr; }
+
+// _____________________________________________________________________________________________________________________
+uint64_t SharedFrameReader::published() const {
+  return _source ? _source->header->sequence.load(std::memory_order_acquire) / 2 : 0;
+}
+
+// _____________________________________________________________________________________________________________________
+bool SharedFrameReader::closed() const {
+  return !_source || _source->header->closed.load(std::memory_order_acquire) != 0;
+}
+
+// _____________________________________________________________________________________________________________________
+bool SharedFrameReader::read(MetricFrame& frame, double* thread_utilisation, int64_t* thread_speed_MHz,
+                             DiskIOStats* disk_stats, NetworkIOStats* network_stats, GPUStats* gpu_stats) const {
+  if (!_source) {
+    return false;
+  }
+  const Header& header = *_source->header;
+  const char* base = static_cast<const char*>(_source->segment.data);
+  const Layout& layout = _source->layout;
+  const auto num_threads = static_cast<size_t>(_num_threads);
+  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+    const uint64_t before = header.sequence.load(std::memory_order_acquire);
+    if (before == 0 || header.closed.load(std::memory_order_relaxed) != 0) {
+      return false;
+    }
+    if ((before & 1) != 0) {
+      // the publisher is writing, which takes well below a microsecond
+      if (attempt >= kSpinAttempts) {
+        std::this_thread::yield();
+      }
+      continue;
+    }
+    MetricFrame copy;
+    std::memcpy(&copy, base + layout.frame_offset, sizeof(MetricFrame));
+    read_values(base + layout.utilisation_offset, num_threads, thread_utilisation);
+    read_values(base + layout.speed_offset, num_threads, thread_speed_MHz);
+    read_values(base + layout.disks_offset, _disk_names.size(), disk_stats);
+    read_values(base + layout.networks_offset, _network_indices.size(), network_stats);
+    read_values(base + layout.gpus_offset, _gpu_pci_bus_ids.size(), gpu_stats);
+    // the copies are complete before the sequence is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header.sequence.load(std::memory_order_relaxed) == before) {
+      frame = copy;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace hwinfo
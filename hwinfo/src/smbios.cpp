@@ -0,0 +1,143 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/utils/smbios.h>
+#include <hwinfo/utils/trace.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hwinfo {
+namespace smbios {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+std::string string_or_unknown(std::string_view value) {
+  // vendors fill unset fields with blanks
+  while (!value.empty() && value.back() == ' ') {
+    value.remove_suffix(1);
+  }
+  return value.empty() ? "<unknown>" : std::string(value);
+}
+
+// _____________________________________________________________________________________________________________________
+// First structure of the type, one without data (and hence without fields and strings) if there is none.
+Structure find_first(const Table& table, uint8_t type) {
+  for (const Structure& structure : table) {
+    if (structure.type == type) {
+      return structure;
+    }
+  }
+  return {};
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+const Table& system_table() {
+  static const std::string blob = [] {
+    HWINFO_TRACE_SCOPE(SMBIOS);
+    std::string result;
+    if (!read_system_table(result)) {
+      result.clear();
+    }
+    return result;
+  }();
+  static const Table table(blob.data(), blob.size());
+  return table;
+}
+
+// _____________________________________________________________________________________________________________________
+bool bios(const Table& table, BiosInfo& info) {
+  const Structure s = find_first(table, BIOS);
+  info.vendor = string_or_unknown(s.string(0x04));
+  info.version = string_or_unknown(s.string(0x05));
+  info.release_date = string_or_unknown(s.string(0x08));
+  return s.data != nullptr;
+}
+
+// _____________________________________________________________________________________________________________________
+bool baseboard(const Table& table, BoardInfo& info) {
+  const Structure s = find_first(table, Baseboard);
+  info.vendor = string_or_unknown(s.string(0x04));
+  info.name = string_or_unknown(s.string(0x05));
+  info.version = string_or_unknown(s.string(0x06));
+  info.serial_number = string_or_unknown(s.string(0x07));
+  return s.data != nullptr;
+}
+
+// _____________________________________________________________________________________________________________________
+bool chassis(const Table& table, ChassisInfo& info) {
+  const Structure s = find_first(table, Chassis);
+  info.vendor = string_or_unknown(s.string(0x04));
+  // bit 7 is the chassis lock flag
+  const int type = s.get<uint8_t>(0x05) & 0x7F;
+  // 2 is "unknown"
+  info.type = (type == 0 || type == 2) ? -1 : type;
+  info.version = string_or_unknown(s.string(0x06));
+  info.serial_number = string_or_unknown(s.string(0x07));
+  return s.data != nullptr;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<Memory::Module> memory_devices(const Table& table) {
+  // offsets of the Memory Device structure (SMBIOS 3.x, 7.18)
+  constexpr size_t size_offset = 0x0C;
+  constexpr size_t speed_offset = 0x15;
+  constexpr size_t manufacturer_offset = 0x17;
+  constexpr size_t serial_number_offset = 0x18;
+  constexpr size_t part_number_offset = 0x1A;
+  constexpr size_t extended_size_offset = 0x1C;
+  constexpr size_t configured_speed_offset = 0x20;
+  constexpr size_t extended_speed_offset = 0x54;
+  constexpr size_t extended_configured_speed_offset = 0x58;
+
+  std::vector<Memory::Module> modules;
+  for (const Structure& structure : table) {
+    if (structure.type != MemoryDevice) {
+      continue;
+    }
+    const auto size = structure.get<uint16_t>(size_offset);
+    // 0: empty slot
+    if (size == 0) {
+      continue;
+    }
+    Memory::Module module;
+    module.id = static_cast<int>(modules.size());
+    if (size == 0xFFFF) {
+      module.total_Bytes = -1;
+    } else if (size == 0x7FFF) {
+      // the size in MiB is in the extended size field (bits 0-30)
+      module.total_Bytes = static_cast<int64_t>(structure.get<uint32_t>(extended_size_offset) & 0x7FFFFFFF) << 20;
+    } else {
+      // bit 15 selects KiB instead of MiB
+      const int64_t value = size & 0x7FFF;
+      module.total_Bytes = (size & 0x8000) ? value << 10 : value << 20;
+    }
+    // speeds are in MT/s, 0 is unknown and 0xFFFF refers to the 32 bit extended field
+    const auto speed = [&](size_t offset, size_t extended_offset) -> int64_t {
+      const auto value = structure.get<uint16_t>(offset);
+      if (value == 0xFFFF) {
+        return structure.get<uint32_t>(extended_offset) & 0x7FFFFFFF;
+      }
+      return value;
+    };
+    int64_t speed_MTs = speed(configured_speed_offset, extended_configured_speed_offset);
+    if (speed_MTs == 0) {
+      speed_MTs = speed(speed_offset, extended_speed_offset);
+    }
+    module.frequency_Hz = speed_MTs > 0 ? speed_MTs * 1000 * 1000 : -1;
+    module.vendor = string_or_unknown(structure.string(manufacturer_offset));
+    module.model = string_or_unknown(structure.string(part_number_offset));
+    module.serial_number = string_or_unknown(structure.string(serial_number_offset));
+    // like on Windows: there is no marketing name of a module, vendor and part number are the closest thing
+    module.name = module.vendor.str() + " " + module.model.str();
+    modules.push_back(std::move(module));
+  }
+  return modules;
+}
+
+}  // namespace smbios
+}  // namespace hwinfo
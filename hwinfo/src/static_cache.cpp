@@ -0,0 +1,482 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/cpu.h>
+#include <hwinfo/gpu.h>
+#include <hwinfo/hwinfo.h>
+#include <hwinfo/inventory.h>
+#include <hwinfo/mainboard.h>
+#include <hwinfo/ram.h>
+#include <hwinfo/static_cache.h>
+#include <hwinfo/utils/filesystem.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef HWINFO_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef HWINFO_APPLE
+#include <sys/sysctl.h>
+#include <sys/time.h>
+#endif
+
+namespace hwinfo {
+namespace static_cache {
+
+namespace {
+
+struct State {
+  std::mutex mutex;
+  bool enabled{false};
+  std::string directory;
+};
+
+// _____________________________________________________________________________________________________________________
+bool is_directory(const std::string& path) {
+#ifdef HWINFO_WINDOWS
+  const DWORD attributes = GetFileAttributesA(path.c_str());
+  return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+  struct stat st {};
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+// The state, enabled by HWINFO_STATIC_CACHE on first use.
+State& state() {
+  static State instance;
+  static std::once_flag from_environment;
+  std::call_once(from_environment, [] {
+    const char* value = std::getenv("HWINFO_STATIC_CACHE");
+    if (value == nullptr || value[0] == '\0') {
+      return;
+    }
+    instance.directory = std::strcmp(value, "1") == 0 ? default_directory() : std::string(value);
+    instance.enabled = is_directory(instance.directory);
+  });
+  return instance;
+}
+
+// _____________________________________________________________________________________________________________________
+// Identifies the current boot, empty if unknown.
+std::string read_boot_key() {
+#if defined(HWINFO_APPLE)
+  struct timeval boot_time {};
+  size_t size = sizeof(boot_time);
+  if (sysctlbyname("kern.boottime", &boot_time, &size, nullptr, 0) != 0) {
+    return {};
+  }
+  return std::to_string(boot_time.tv_sec) + "." + std::to_string(boot_time.tv_usec);
+#elif defined(HWINFO_WINDOWS)
+  // boot time from the uptime in 10 s steps, which absorbs the jitter between both clocks (a step boundary between
+  // two processes only costs a miss)
+  FILETIME now;
+  GetSystemTimeAsFileTime(&now);
+  const uint64_t now_ms = ((static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime) / 10000;
+  return std::to_string((now_ms - GetTickCount64()) / 10000);
+#else
+  std::ifstream file("/proc/sys/kernel/random/boot_id");
+  std::string boot_id;
+  if (!std::getline(file, boot_id)) {
+    return {};
+  }
+  // a uuid, anything else would not be safe in a file name
+  for (char c : boot_id) {
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || c == '-')) {
+      return {};
+    }
+  }
+  return boot_id;
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+const std::string& boot_key() {
+  static const std::string key = read_boot_key();
+  return key;
+}
+
+// _____________________________________________________________________________________________________________________
+// Calls read with the content of the file, memory mapped where possible. False if the file is missing or not
+// trustworthy.
+template <typename Read>
+bool read_file(const std::string& path, const Read& read) {
+#ifdef HWINFO_WINDOWS
+  std::ifstream file(path, std::ios::binary);
+  const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return !data.empty() && read(std::string_view(data));
+#else
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+  if (fd < 0) {
+    return false;
+  }
+  bool result = false;
+  struct stat st {};
+  // written by this user and by nobody else (the default directory may be a shared /tmp)
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == geteuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0 &&
+      st.st_size > 0) {
+    const auto size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      result = read(std::string_view(static_cast<const char*>(data), size));
+      munmap(data, size);
+    }
+  }
+  close(fd);
+  return result;
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+// Writes a temporary file next to path and renames it, so that concurrent readers never see a partial file.
+void write_file(const std::string& path, const std::string& data) {
+#ifdef HWINFO_WINDOWS
+  const std::string tmp_path = path + "." + std::to_string(GetCurrentProcessId());
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+      file.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (!MoveFileExA(tmp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    std::remove(tmp_path.c_str());
+  }
+#else
+  const std::string tmp_path = path + "." + std::to_string(getpid());
+  const int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    return;
+  }
+  size_t written = 0;
+  while (written < data.size()) {
+    const ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n <= 0) {
+      break;
+    }
+    written += static_cast<size_t>(n);
+  }
+  if (close(fd) != 0 || written != data.size() || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+  }
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+bool load_records(const char* component, std::vector<inventory::Record>& records) {
+  const std::string file = path(component);
+  return !file.empty() &&
+         read_file(file, [&records](std::string_view data) { return inventory::deserialize(data, records); });
+}
+
+// _____________________________________________________________________________________________________________________
+void store_records(const char* component, const SystemInfo& info) {
+  const std::string file = path(component);
+  if (!file.empty()) {
+    write_file(file, inventory::serialize(info));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Field>
+bool has_fields(const inventory::Record& record, inventory::RecordType type, Field last) {
+  return record.type == type && record.fields.size() > static_cast<size_t>(last);
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Field>
+int64_t integer(const inventory::Record& record, Field field) {
+  return record.fields[static_cast<size_t>(field)].integer;
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Field>
+std::string take_string(inventory::Record& record, Field field) {
+  return std::move(record.fields[static_cast<size_t>(field)].string);
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Field>
+std::vector<std::string> take_strings(const inventory::Record& record, Field field) {
+  std::vector<std::string> strings;
+  for (std::string_view item : inventory::split(record.fields[static_cast<size_t>(field)].string)) {
+    strings.emplace_back(item);
+  }
+  return strings;
+}
+
+}  // namespace
+
+struct Access {
+  static bool restore(inventory::Record& record, std::vector<CPU>& cpus) {
+    using Field = inventory::CPUField;
+    static_assert(FeatureSet::num_words == 4, "the cpu record has four feature words");
+    if (!has_fields(record, inventory::RecordType::CPU, Field::Features3)) {
+      return false;
+    }
+    CPU cpu;
+    cpu._id = static_cast<int>(integer(record, Field::Id));
+    cpu._vendor = take_string(record, Field::Vendor);
+    cpu._modelName = take_string(record, Field::Model);
+    cpu._numPhysicalCores = static_cast<int>(integer(record, Field::PhysicalCores));
+    cpu._numLogicalCores = static_cast<int>(integer(record, Field::LogicalCores));
+    cpu._maxClockSpeed_MHz = integer(record, Field::MaxClockSpeed_MHz);
+    cpu._regularClockSpeed_MHz = integer(record, Field::RegularClockSpeed_MHz);
+    cpu._L1CacheSize_Bytes = integer(record, Field::L1CacheSize_Bytes);
+    cpu._L2CacheSize_Bytes = integer(record, Field::L2CacheSize_Bytes);
+    cpu._L3CacheSize_Bytes = integer(record, Field::L3CacheSize_Bytes);
+    cpu._flags = take_strings(record, Field::Flags);
+    uint64_t words[FeatureSet::num_words];
+    for (size_t i = 0; i < FeatureSet::num_words; ++i) {
+      words[i] = static_cast<uint64_t>(integer(record, static_cast<size_t>(Field::Features0) + i));
+    }
+    cpu._features = FeatureSet(words);
+    cpus.push_back(std::move(cpu));
+    return true;
+  }
+
+  static bool restore(inventory::Record& record, std::vector<GPU>& gpus) {
+    using Field = inventory::GPUField;
+    if (!has_fields(record, inventory::RecordType::GPU, Field::PciBusId)) {
+      return false;
+    }
+    GPU gpu;
+    gpu._id = static_cast<int>(integer(record, Field::Id));
+    gpu._vendor = take_string(record, Field::Vendor);
+    gpu._name = take_string(record, Field::Name);
+    gpu._driverVersion = take_string(record, Field::DriverVersion);
+    gpu._memory_Bytes = integer(record, Field::Memory_Bytes);
+    gpu._frequency_MHz = integer(record, Field::Frequency_MHz);
+    gpu._num_cores = static_cast<int>(integer(record, Field::NumCores));
+    gpu._vendor_id = take_string(record, Field::VendorId);
+    gpu._device_id = take_string(record, Field::DeviceId);
+    gpu._pci_bus_id = take_string(record, Field::PciBusId);
+    gpus.push_back(std::move(gpu));
+    return true;
+  }
+
+  static bool restore(inventory::Record& record, MainBoard& mainboard) {
+    using Field = inventory::MainBoardField;
+    if (!has_fields(record, inventory::RecordType::MainBoard, Field::SerialNumber)) {
+      return false;
+    }
+    mainboard._vendor = take_string(record, Field::Vendor);
+    mainboard._name = take_string(record, Field::Name);
+    mainboard._version = take_string(record, Field::Version);
+    mainboard._serialNumber = take_string(record, Field::SerialNumber);
+    return true;
+  }
+
+  static bool restore(std::vector<inventory::Record>& records, Memory& memory) {
+    using Field = inventory::MemoryModuleField;
+    std::vector<Memory::Module> modules;
+    for (auto& record : records) {
+      // the Memory record only has dynamic values
+      if (record.type == inventory::RecordType::Memory) {
+        continue;
+      }
+      if (!has_fields(record, inventory::RecordType::MemoryModule, Field::Frequency_Hz)) {
+        return false;
+      }
+      Memory::Module module;
+      module.id = static_cast<int>(integer(record, Field::Id));
+      module.vendor = take_string(record, Field::Vendor);
+      module.name = take_string(record, Field::Name);
+      module.model = take_string(record, Field::Model);
+      module.serial_number = take_string(record, Field::SerialNumber);
+      module.total_Bytes = integer(record, Field::Total_Bytes);
+      module.frequency_Hz = integer(record, Field::Frequency_Hz);
+      modules.push_back(std::move(module));
+    }
+    if (modules.empty()) {
+      return false;
+    }
+    memory._modules = std::move(modules);
+    return true;
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+std::string default_directory() {
+#ifdef HWINFO_WINDOWS
+  char buffer[MAX_PATH + 1];
+  const DWORD size = GetTempPathA(sizeof(buffer), buffer);
+  if (size == 0 || size > sizeof(buffer)) {
+    return {};
+  }
+  return std::string(buffer, size);
+#else
+  for (const char* name : {"XDG_RUNTIME_DIR", "TMPDIR"}) {
+    if (const char* value = std::getenv(name); value != nullptr && value[0] == '/') {
+      return value;
+    }
+  }
+  return "/tmp";
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+bool enable(const std::string& directory) {
+  const std::string dir = directory.empty() ? default_directory() : directory;
+  if (!is_directory(dir)) {
+    return false;
+  }
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.directory = dir;
+  s.enabled = true;
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+void disable() {
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.enabled = false;
+}
+
+// _____________________________________________________________________________________________________________________
+bool enabled() {
+  State& s = state();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  return s.enabled;
+}
+
+// _____________________________________________________________________________________________________________________
+std::string path(const std::string& component) {
+  std::string directory;
+  {
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.enabled) {
+      return {};
+    }
+    directory = s.directory;
+  }
+#if defined(HWINFO_UNIX) && !defined(HWINFO_APPLE)
+  // the cache describes this system, not a fixture tree or the host of a container
+  if (filesystem::root() != "/") {
+    return {};
+  }
+#endif
+  if (boot_key().empty()) {
+    return {};
+  }
+  if (directory.back() != '/' && directory.back() != '\\') {
+    directory.push_back('/');
+  }
+  return directory + "hwinfo-" + component + "-" + std::to_string(kVersion) + "-" + boot_key() + ".bin";
+}
+
+// _____________________________________________________________________________________________________________________
+void clear() {
+  for (const char* component : {"cpu", "gpu", "mainboard", "memory"}) {
+    const std::string file = path(component);
+    if (!file.empty()) {
+      std::remove(file.c_str());
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+bool load(std::vector<CPU>& cpus) {
+  std::vector<inventory::Record> records;
+  if (!load_records("cpu", records)) {
+    return false;
+  }
+  std::vector<CPU> result;
+  for (auto& record : records) {
+    if (!Access::restore(record, result)) {
+      return false;
+    }
+  }
+  cpus = std::move(result);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+void store(const std::vector<CPU>& cpus) {
+  if (!enabled()) {
+    return;
+  }
+  SystemInfo info;
+  info.cpus = cpus;
+  store_records("cpu", info);
+}
+
+// _____________________________________________________________________________________________________________________
+bool load(std::vector<GPU>& gpus) {
+  std::vector<inventory::Record> records;
+  if (!load_records("gpu", records)) {
+    return false;
+  }
+  std::vector<GPU> result;
+  for (auto& record : records) {
+    if (!Access::restore(record, result)) {
+      return false;
+    }
+  }
+  gpus = std::move(result);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+void store(const std::vector<GPU>& gpus) {
+  if (!enabled()) {
+    return;
+  }
+  SystemInfo info;
+  info.gpus = gpus;
+  store_records("gpu", info);
+}
+
+// _____________________________________________________________________________________________________________________
+bool load(MainBoard& mainboard) {
+  std::vector<inventory::Record> records;
+  return load_records("mainboard", records) && records.size() == 1 && Access::restore(records[0], mainboard);
+}
+
+// _____________________________________________________________________________________________________________________
+void store(const MainBoard& mainboard) {
+  if (!enabled()) {
+    return;
+  }
+  SystemInfo info;
+  info.mainboard = mainboard;
+  store_records("mainboard", info);
+}
+
+// _____________________________________________________________________________________________________________________
+bool load(Memory& memory) {
+  std::vector<inventory::Record> records;
+  return load_records("memory", records) && Access::restore(records, memory);
+}
+
+// _____________________________________________________________________________________________________________________
+void store(const Memory& memory) {
+  if (!enabled()) {
+    return;
+  }
+  SystemInfo info;
+  info.memory = memory;
+  store_records("memory", info);
+}
+
+}  // namespace static_cache
+}  // namespace hwinfo
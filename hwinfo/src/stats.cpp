@@ -0,0 +1,468 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/stats.h>
+#include <hwinfo/utils/trace.h>
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef HWINFO_TRACE
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#endif
+
+namespace hwinfo {
+namespace trace {
+
+namespace {
+
+constexpr size_t kNumCollectors = static_cast<size_t>(Collector::Count);
+
+constexpr const char* kNames[] = {"battery", "cpu", "disk", "gpu", "mainboard", "memory", "network", "os", "topology",
+                                  "cgroup", "smbios", "mounts", "wmi_connect", "utilisation", "thread_metrics",
+                                  "memory_snapshot", "disk_stats", "frequency_stats", "gpu_stats", "network_stats",
+                                  "process_stats", "sensors", "pressure", "interrupts", "nvme"};
+static_assert(std::size(kNames) == kNumCollectors, "one name per collector");
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+const char* name(Collector collector) {
+  const auto index = static_cast<size_t>(collector);
+  return index < kNumCollectors ? kNames[index] : "unknown";
+}
+
+#ifdef HWINFO_TRACE
+namespace {
+
+struct Counters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> wall_ns{0};
+  std::atomic<uint64_t> files_opened{0};
+  std::atomic<uint64_t> bytes_read{0};
+  std::atomic<uint64_t> wmi_queries{0};
+  std::atomic<uint64_t> allocations{0};
+};
+
+// Counters of one thread. Only the owning thread writes them (load and store, no read-modify-write), stats() reads the
+// blocks of all threads. The block of an exited thread keeps its counts and is reused by the next new thread.
+struct ThreadBlock {
+  Counters collectors[kNumCollectors];
+  // all operator new calls of the thread, also outside of scopes
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<bool> in_use{true};
+  // tid of the trace events
+  uint32_t id{0};
+  ThreadBlock* next{nullptr};
+  // collector of the innermost scope, Collector::Count outside of scopes. Only accessed by the owner.
+  Collector current{Collector::Count};
+};
+
+// list of all blocks, only ever prepended to
+std::atomic<ThreadBlock*> blocks{nullptr};
+std::atomic<uint32_t> num_blocks{0};
+
+thread_local ThreadBlock* thread_block = nullptr;
+// set once the thread's block was released, so that allocations of later thread_local destructors do not take another
+thread_local bool thread_exited = false;
+
+struct ThreadExit {
+  ~ThreadExit() {
+    if (thread_block != nullptr) {
+      thread_block->current = Collector::Count;
+      thread_block->in_use.store(false, std::memory_order_release);
+      thread_block = nullptr;
+    }
+    thread_exited = true;
+  }
+};
+
+struct Event {
+  Collector collector;
+  uint32_t thread;
+  int64_t start_ns;
+  int64_t duration_ns;
+  uint64_t files_opened;
+  uint64_t bytes_read;
+  uint64_t wmi_queries;
+  uint64_t allocations;
+};
+
+constexpr size_t kMaxEvents = size_t(1) << 20;
+
+struct Recording {
+  std::mutex mutex;
+  std::vector<Event> events;
+  std::string path;
+  int64_t epoch_ns{0};
+};
+
+std::atomic<bool> recording{false};
+
+// _____________________________________________________________________________________________________________________
+Recording& recording_state() {
+  static Recording state;
+  return state;
+}
+
+// _____________________________________________________________________________________________________________________
+void add(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// _____________________________________________________________________________________________________________________
+// Block of the calling thread, nullptr once the thread is exiting. Allocates with std::malloc, since it also runs
+// inside of operator new.
+ThreadBlock* acquire() {
+  if (thread_block != nullptr || thread_exited) {
+    return thread_block;
+  }
+  ThreadBlock* block = nullptr;
+  for (ThreadBlock* candidate = blocks.load(std::memory_order_acquire); candidate != nullptr;
+       candidate = candidate->next) {
+    bool in_use = false;
+    if (!candidate->in_use.load(std::memory_order_relaxed) &&
+        candidate->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+      block = candidate;
+      break;
+    }
+  }
+  if (block == nullptr) {
+    void* memory = std::malloc(sizeof(ThreadBlock));
+    if (memory == nullptr) {
+      return nullptr;
+    }
+    block = new (memory) ThreadBlock();
+    block->id = num_blocks.fetch_add(1, std::memory_order_relaxed) + 1;
+    ThreadBlock* head = blocks.load(std::memory_order_relaxed);
+    do {
+      block->next = head;
+    } while (!blocks.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+  }
+  thread_block = block;
+  static thread_local ThreadExit thread_exit;
+  static_cast<void>(thread_exit);
+  return block;
+}
+
+// _____________________________________________________________________________________________________________________
+Counters* current_counters() {
+  ThreadBlock* block = thread_block;
+  if (block == nullptr || block->current == Collector::Count) {
+    return nullptr;
+  }
+  return &block->collectors[static_cast<size_t>(block->current)];
+}
+
+// _____________________________________________________________________________________________________________________
+void count_allocation() {
+  if (ThreadBlock* block = acquire()) {
+    add(block->allocations, 1);
+    if (Counters* counters = current_counters()) {
+      add(counters->allocations, 1);
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void record(const Event& event) {
+  Recording& state = recording_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (recording.load(std::memory_order_relaxed) && state.events.size() < kMaxEvents) {
+    state.events.push_back(event);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+std::array<CollectorStats, kNumCollectors> totals() {
+  std::array<CollectorStats, kNumCollectors> result;
+  for (ThreadBlock* block = blocks.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+    for (size_t i = 0; i < kNumCollectors; ++i) {
+      const Counters& counters = block->collectors[i];
+      result[i].calls += counters.calls.load(std::memory_order_relaxed);
+      result[i].wall_ns += counters.wall_ns.load(std::memory_order_relaxed);
+      result[i].files_opened += counters.files_opened.load(std::memory_order_relaxed);
+      result[i].bytes_read += counters.bytes_read.load(std::memory_order_relaxed);
+      result[i].wmi_queries += counters.wmi_queries.load(std::memory_order_relaxed);
+      result[i].allocations += counters.allocations.load(std::memory_order_relaxed);
+    }
+  }
+  return result;
+}
+
+// totals() at the last reset_stats()
+std::mutex baseline_mutex;
+std::array<CollectorStats, kNumCollectors> baseline;
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+Scope::Scope(Collector collector)
+    : _collector(collector),
+      _previous(Collector::Count),
+      _start_ns(0),
+      _files_opened(0),
+      _bytes_read(0),
+      _wmi_queries(0),
+      _allocations(0) {
+  ThreadBlock* block = acquire();
+  if (block == nullptr) {
+    return;
+  }
+  _previous = block->current;
+  block->current = collector;
+  const Counters& counters = block->collectors[static_cast<size_t>(collector)];
+  _files_opened = counters.files_opened.load(std::memory_order_relaxed);
+  _bytes_read = counters.bytes_read.load(std::memory_order_relaxed);
+  _wmi_queries = counters.wmi_queries.load(std::memory_order_relaxed);
+  _allocations = counters.allocations.load(std::memory_order_relaxed);
+  _start_ns = now_ns();
+}
+
+// _____________________________________________________________________________________________________________________
+Scope::~Scope() {
+  ThreadBlock* block = thread_block;
+  if (block == nullptr) {
+    return;
+  }
+  const int64_t duration_ns = now_ns() - _start_ns;
+  Counters& counters = block->collectors[static_cast<size_t>(_collector)];
+  add(counters.calls, 1);
+  add(counters.wall_ns, static_cast<uint64_t>(duration_ns));
+  // the event buffer's own allocations are not accounted to any collector
+  block->current = Collector::Count;
+  if (recording.load(std::memory_order_relaxed)) {
+    record({_collector, block->id, _start_ns, duration_ns,
+            counters.files_opened.load(std::memory_order_relaxed) - _files_opened,
+            counters.bytes_read.load(std::memory_order_relaxed) - _bytes_read,
+            counters.wmi_queries.load(std::memory_order_relaxed) - _wmi_queries,
+            counters.allocations.load(std::memory_order_relaxed) - _allocations});
+  }
+  block->current = _previous;
+}
+
+// _____________________________________________________________________________________________________________________
+void count_file_opened() {
+  if (Counters* counters = current_counters()) {
+    add(counters->files_opened, 1);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void count_bytes_read(int64_t bytes) {
+  Counters* counters = current_counters();
+  if (counters != nullptr && bytes > 0) {
+    add(counters->bytes_read, static_cast<uint64_t>(bytes));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+void count_wmi_query() {
+  if (Counters* counters = current_counters()) {
+    add(counters->wmi_queries, 1);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+uint64_t allocations() {
+  uint64_t result = 0;
+  for (ThreadBlock* block = blocks.load(std::memory_order_acquire); block != nullptr; block = block->next) {
+    result += block->allocations.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+#endif  // HWINFO_TRACE
+
+}  // namespace trace
+
+#ifdef HWINFO_TRACE
+// _____________________________________________________________________________________________________________________
+bool stats_enabled() { return true; }
+
+// _____________________________________________________________________________________________________________________
+std::vector<CollectorStats> stats() {
+  const auto current = trace::totals();
+  std::lock_guard<std::mutex> lock(trace::baseline_mutex);
+  std::vector<CollectorStats> result(current.begin(), current.end());
+  for (size_t i = 0; i < result.size(); ++i) {
+    const CollectorStats& base = trace::baseline[i];
+    CollectorStats& entry = result[i];
+    entry.name = trace::name(static_cast<trace::Collector>(i));
+    entry.calls -= base.calls;
+    entry.wall_ns -= base.wall_ns;
+    entry.files_opened -= base.files_opened;
+    entry.bytes_read -= base.bytes_read;
+    entry.wmi_queries -= base.wmi_queries;
+    entry.allocations -= base.allocations;
+  }
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+void reset_stats() {
+  auto current = trace::totals();
+  std::lock_guard<std::mutex> lock(trace::baseline_mutex);
+  trace::baseline = current;
+}
+
+// _____________________________________________________________________________________________________________________
+bool start_trace(const std::string& path) {
+  trace::Recording& state = trace::recording_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (trace::recording.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  state.events.clear();
+  state.path = path;
+  state.epoch_ns = trace::now_ns();
+  trace::recording.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+bool stop_trace() {
+  trace::Recording& state = trace::recording_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!trace::recording.exchange(false, std::memory_order_relaxed)) {
+    return false;
+  }
+  std::FILE* file = std::fopen(state.path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+  std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+  const char* separator = "\n";
+  for (const trace::Event& event : state.events) {
+    // timestamps and durations are in microseconds
+    std::fprintf(file,
+                 "%s{\"name\":\"%s\",\"cat\":\"hwinfo\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                 "\"args\":{\"files_opened\":%llu,\"bytes_read\":%llu,\"wmi_queries\":%llu,\"allocations\":%llu}}",
+                 separator, trace::name(event.collector), event.thread,
+                 static_cast<double>(event.start_ns - state.epoch_ns) / 1e3,
+                 static_cast<double>(event.duration_ns) / 1e3, static_cast<unsigned long long>(event.files_opened),
+                 static_cast<unsigned long long>(event.bytes_read), static_cast<unsigned long long>(event.wmi_queries),
+                 static_cast<unsigned long long>(event.allocations));
+    separator = ",\n";
+  }
+  std::fputs("\n]}\n", file);
+  const bool success = std::ferror(file) == 0;
+  state.events.clear();
+  state.events.shrink_to_fit();
+  return std::fclose(file) == 0 && success;
+}
+#else
+// _____________________________________________________________________________________________________________________
+bool stats_enabled() { return false; }
+
+// _____________________________________________________________________________________________________________________
+std::vector<CollectorStats> stats() { return {}; }
+
+// _____________________________________________________________________________________________________________________
+void reset_stats() {}
+
+// _____________________________________________________________________________________________________________________
+bool start_trace(const std::string&) { return false; }
+
+// _____________________________________________________________________________________________________________________
+bool stop_trace() { return false; }
+#endif  // HWINFO_TRACE
+
+}  // namespace hwinfo
+
+#ifdef HWINFO_TRACE
+namespace {
+
+// _____________________________________________________________________________________________________________________
+void* allocate_aligned(size_t size, std::align_val_t alignment) {
+  const auto align = static_cast<size_t>(alignment);
+#ifdef HWINFO_WINDOWS
+  return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+  // aligned_alloc requires a multiple of the alignment
+  return std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align);
+#endif
+}
+
+// _____________________________________________________________________________________________________________________
+void aligned_free(void* ptr) noexcept {
+#ifdef HWINFO_WINDOWS
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+}  // namespace
+
+// Replacements of the global allocation functions of the program: they count the calls for CollectorStats.
+// _____________________________________________________________________________________________________________________
+void* operator new(size_t size) {
+  hwinfo::trace::count_allocation();
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// _____________________________________________________________________________________________________________________
+void* operator new[](size_t size) { return ::operator new(size); }
+
+// _____________________________________________________________________________________________________________________
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  hwinfo::trace::count_allocation();
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+// _____________________________________________________________________________________________________________________
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); }
+
+// _____________________________________________________________________________________________________________________
+void* operator new(size_t size, std::align_val_t alignment) {
+  hwinfo::trace::count_allocation();
+  if (void* ptr = allocate_aligned(size, alignment)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// _____________________________________________________________________________________________________________________
+void* operator new[](size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr, std::align_val_t) noexcept { aligned_free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr, std::align_val_t) noexcept { aligned_free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { aligned_free(ptr); }
+
+// _____________________________________________________________________________________________________________________
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { aligned_free(ptr); }
+#endif  // HWINFO_TRACE
@@ -0,0 +1,181 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/thread_metrics.h>
+#include <hwinfo/topology.h>
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef HWINFO_UNIX
+#include <hwinfo/utils/filesystem.h>
+#include <hwinfo/utils/proc_stat.h>
+#include <hwinfo/utils/trace.h>
+#endif  // HWINFO_UNIX
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+void ThreadMetrics::resize(size_t num_threads) {
+  _user.resize(num_threads);
+  _system.resize(num_threads);
+  _idle.resize(num_threads);
+  _iowait.resize(num_threads);
+  _irq.resize(num_threads);
+  _frequency_MHz.resize(num_threads);
+  const size_t known_nodes = _node.size();
+  _node.resize(num_threads);
+  // the node of a thread does not change: only threads that were not seen before are looked up
+  const Topology& topology = Topology::get();
+  for (size_t i = known_nodes; i < num_threads; ++i) {
+    _node[i] = i < topology.size() && topology.node()[i] >= 0 ? topology.node()[i] : 0;
+    _num_nodes = std::max(_num_nodes, _node[i] + 1);
+  }
+}
+
+#ifdef HWINFO_UNIX
+// _____________________________________________________________________________________________________________________
+bool ThreadMetrics::update() {
+  HWINFO_TRACE_SCOPE(ThreadMetrics);
+  // one snapshot per thread, so that its buffer is reused without synchronization
+  thread_local utils::StatSnapshot snapshot;
+  if (!snapshot.update()) {
+    resize(0);
+    _timestamp_ns = -1;
+    return false;
+  }
+  _timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+  const size_t num_threads = snapshot.num_threads();
+  resize(num_threads);
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    const CpuTimes& times = snapshot.times(static_cast<int>(i));
+    if (!times.valid()) {
+      // offline cpu
+      _user[i] = _system[i] = _idle[i] = _iowait[i] = _irq[i] = -1;
+      continue;
+    }
+    _user[i] = times.user + times.nice;
+    _system[i] = times.system;
+    _idle[i] = times.idle;
+    _iowait[i] = times.iowait;
+    _irq[i] = times.irq + times.softirq;
+  }
+
+  const auto& frequency_files = filesystem::cpu_frequency_files();
+  for (size_t i = 0; i < num_threads; ++i) {
+    int64_t frequency_kHz = -1;
+    _frequency_MHz[i] = i < frequency_files.size() && frequency_files[i].read_int64(frequency_kHz)
+                            ? frequency_kHz / 1000
+                            : -1;
+  }
+  return true;
+}
+#else
+// _____________________________________________________________________________________________________________________
+bool ThreadMetrics::update() {
+  resize(0);
+  _timestamp_ns = -1;
+  return false;
+}
+#endif  // HWINFO_UNIX
+
+namespace reduce {
+
+// _____________________________________________________________________________________________________________________
+int64_t sum(const int64_t* values, size_t count) {
+  int64_t result = 0;
+  for (size_t i = 0; i < count; ++i) {
+    result += values[i];
+  }
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+double sum(const double* values, size_t count) {
+  // floating point addition is not associative: without independent accumulators the loop cannot be vectorized
+  double acc[4]{};
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    acc[0] += values[i];
+    acc[1] += values[i + 1];
+    acc[2] += values[i + 2];
+    acc[3] += values[i + 3];
+  }
+  for (; i < count; ++i) {
+    acc[0] += values[i];
+  }
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// _____________________________________________________________________________________________________________________
+std::pair<int64_t, int64_t> minmax(const int64_t* values, size_t count) {
+  if (count == 0) {
+    return {0, 0};
+  }
+  int64_t min = values[0];
+  int64_t max = values[0];
+  for (size_t i = 1; i < count; ++i) {
+    min = values[i] < min ? values[i] : min;
+    max = values[i] > max ? values[i] : max;
+  }
+  return {min, max};
+}
+
+// _____________________________________________________________________________________________________________________
+std::pair<double, double> minmax(const double* values, size_t count) {
+  if (count == 0) {
+    return {0.0, 0.0};
+  }
+  double min = values[0];
+  double max = values[0];
+  for (size_t i = 1; i < count; ++i) {
+    min = values[i] < min ? values[i] : min;
+    max = values[i] > max ? values[i] : max;
+  }
+  return {min, max};
+}
+
+// _____________________________________________________________________________________________________________________
+size_t utilisation(const ThreadMetrics& previous, const ThreadMetrics& current, double* out) {
+  const size_t count = std::min(previous.size(), current.size());
+  const int64_t* user0 = previous.user();
+  const int64_t* system0 = previous.system();
+  const int64_t* irq0 = previous.irq();
+  const int64_t* idle0 = previous.idle();
+  const int64_t* iowait0 = previous.iowait();
+  const int64_t* user1 = current.user();
+  const int64_t* system1 = current.system();
+  const int64_t* irq1 = current.irq();
+  const int64_t* idle1 = current.idle();
+  const int64_t* iowait1 = current.iowait();
+  for (size_t i = 0; i < count; ++i) {
+    const auto busy = static_cast<double>((user1[i] + system1[i] + irq1[i]) - (user0[i] + system0[i] + irq0[i]));
+    const auto all = busy + static_cast<double>((idle1[i] + iowait1[i]) - (idle0[i] + iowait0[i]));
+    // offline threads are -1 in every column
+    const bool valid = all > 0 && busy >= 0 && user0[i] >= 0 && user1[i] >= 0;
+    out[i] = valid ? busy / all : -1.0;
+  }
+  return count;
+}
+
+// _____________________________________________________________________________________________________________________
+void group_sum(const double* values, const int32_t* groups, size_t count, double* sums, int64_t* counts,
+               size_t num_groups) {
+  std::fill(sums, sums + num_groups, 0.0);
+  std::fill(counts, counts + num_groups, 0);
+  for (size_t i = 0; i < count; ++i) {
+    const int32_t group = groups[i];
+    if (values[i] < 0 || group < 0 || static_cast<size_t>(group) >= num_groups) {
+      continue;
+    }
+    sums[group] += values[i];
+    ++counts[group];
+  }
+}
+
+}  // namespace reduce
+
+}  // namespace hwinfo
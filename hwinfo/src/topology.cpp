@@ -0,0 +1,78 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/topology.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace hwinfo {
+
+// _____________________________________________________________________________________________________________________
+const Topology& Topology::get() {
+  static const Topology topology = read();
+  return topology;
+}
+
+// _____________________________________________________________________________________________________________________
+int32_t Topology::find_socket(int32_t cpu_id) const {
+  auto it = std::find(_package_ids.begin(), _package_ids.end(), cpu_id);
+  return it == _package_ids.end() ? -1 : static_cast<int32_t>(it - _package_ids.begin());
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<int> Topology::cpus_of_socket(int32_t socket) const {
+  std::vector<int> cpus;
+  for (size_t i = 0; i < _socket.size(); ++i) {
+    if (socket >= 0 && _socket[i] == socket) {
+      cpus.push_back(static_cast<int>(i));
+    }
+  }
+  return cpus;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<int> Topology::cpus_of_core(int32_t core) const {
+  std::vector<int> cpus;
+  for (size_t i = 0; i < _core.size(); ++i) {
+    if (core >= 0 && _core[i] == core) {
+      cpus.push_back(static_cast<int>(i));
+    }
+  }
+  return cpus;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<int> Topology::cpus_of_node(int32_t node) const {
+  std::vector<int> cpus;
+  for (size_t i = 0; i < _node.size(); ++i) {
+    if (node >= 0 && _node[i] == node) {
+      cpus.push_back(static_cast<int>(i));
+    }
+  }
+  return cpus;
+}
+
+// _____________________________________________________________________________________________________________________
+void Topology::resize(size_t num_cpus) {
+  if (num_cpus <= _socket.size()) {
+    return;
+  }
+  _core.resize(num_cpus, -1);
+  _cache_domain.resize(num_cpus, -1);
+  _node.resize(num_cpus, -1);
+  _socket.resize(num_cpus, -1);
+  _efficiency_class.resize(num_cpus, -1);
+}
+
+// _____________________________________________________________________________________________________________________
+int32_t Topology::index_of(std::vector<int64_t>& keys, int64_t key) {
+  auto it = std::find(keys.begin(), keys.end(), key);
+  if (it != keys.end()) {
+    return static_cast<int32_t>(it - keys.begin());
+  }
+  keys.push_back(key);
+  return static_cast<int32_t>(keys.size() - 1);
+}
+
+}  // namespace hwinfo
@@ -9,22 +9,23 @@
 
 #include <hwinfo/battery.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
 namespace hwinfo {
 
 // =====================================================================================================================
 // _____________________________________________________________________________________________________________________
-std::string Battery::getVendor() const { return "<unknwon>"; }
+InternedString Battery::getVendor() const { return "<unknwon>"; }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getModel() const { return _model; }
+InternedString Battery::getModel() const { return _model; }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getSerialNumber() const { return "<unknwon>"; }
+InternedString Battery::getSerialNumber() const { return "<unknwon>"; }
 
 // _____________________________________________________________________________________________________________________
-std::string Battery::getTechnology() const { return "<unknwon>"; }
+InternedString Battery::getTechnology() const { return "<unknwon>"; }
 
 // _____________________________________________________________________________________________________________________
 uint32_t Battery::getEnergyFull() const { return 1; }
@@ -38,9 +39,17 @@ bool Battery::charging() const { return false; }
 // _____________________________________________________________________________________________________________________
 bool Battery::discharging() const { return false; }
 
+// _____________________________________________________________________________________________________________________
+BatteryStatus Battery::status() const {
+  BatteryStatus status;
+  status.charging = charging();
+  return status;
+}
+
 // =====================================================================================================================
 // _____________________________________________________________________________________________________________________
 std::vector<Battery> getAllBatteries() {
+  HWINFO_TRACE_SCOPE(Battery);
   utils::WMI::_WMI wmi;
   const std::wstring query_string(L"SELECT DeviceID, FullChargeCapacity, Name FROM Win32_Battery");
   bool success = wmi.execute_query(query_string);
@@ -49,14 +58,9 @@ std::vector<Battery> getAllBatteries() {
   }
   std::vector<Battery> batteries;
 
-  ULONG u_return = 0;
   IWbemClassObject* obj = nullptr;
   int battery_id = 0;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
+  while (wmi.next(&obj)) {
     Battery battery;
     battery._id = battery_id++;
     VARIANT vt_prop;
@@ -0,0 +1,38 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <hwinfo/bench.h>
+
+namespace hwinfo {
+namespace bench {
+
+// _____________________________________________________________________________________________________________________
+// The OS cpu id counts the cpus in (group, number) order, as in Topology.
+bool pinCurrentThread(int cpu) {
+  if (cpu < 0) {
+    return false;
+  }
+  DWORD remaining = static_cast<DWORD>(cpu);
+  const WORD num_groups = GetActiveProcessorGroupCount();
+  for (WORD group = 0; group < num_groups; ++group) {
+    const DWORD num_cpus = GetActiveProcessorCount(group);
+    if (remaining < num_cpus) {
+      GROUP_AFFINITY affinity{};
+      affinity.Group = group;
+      affinity.Mask = static_cast<KAFFINITY>(1) << remaining;
+      return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+    }
+    remaining -= num_cpus;
+  }
+  return false;
+}
+
+}  // namespace bench
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -5,151 +5,297 @@
 
 #ifdef HWINFO_WINDOWS
 
+#include <Windows.h>
 #include <hwinfo/cpu.h>
+#include <hwinfo/cpu_times.h>
 #include <hwinfo/cpuid.h>
+#include <hwinfo/topology.h>
+#include <hwinfo/utils/jiffies.h>
+#include <hwinfo/utils/ntdll.h>
+#include <hwinfo/utils/pdh.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
+#include <winternl.h>
 
 #include <algorithm>
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace hwinfo {
 
 // =====================================================================================================================
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// Latest "Processor Information" counters, copied into a per thread buffer that is reused between calls.
+const utils::ProcessorCounterSample* processor_counters() {
+  thread_local utils::ProcessorCounterSample sample;
+  if (!utils::ProcessorCounters::get().sample(sample)) {
+    return nullptr;
+  }
+  return &sample;
+}
+
+// _____________________________________________________________________________________________________________________
+// "% Processor Utility" is relative to the base frequency and exceeds 100 while boosting.
+double to_utilisation(double utility_percent) {
+  if (utility_percent < 0) {
+    return -1.0;
+  }
+  return std::min(utility_percent / 100.0, 1.0);
+}
+
+// _____________________________________________________________________________________________________________________
+int64_t to_clock_speed_MHz(double performance_percent, int64_t base_clock_speed_MHz) {
+  if (performance_percent < 0 || base_clock_speed_MHz < 0) {
+    return -1;
+  }
+  return static_cast<int64_t>(static_cast<double>(base_clock_speed_MHz) * performance_percent / 100.0);
+}
+
+}  // namespace
+
 // _____________________________________________________________________________________________________________________
 int64_t CPU::currentClockSpeed_MHz(int thread_id) const {
-  auto data = utils::WMI::query<std::string>(L"Win32_PerfFormattedData_Counters_ProcessorInformation",
-                                             L"PercentProcessorPerformance");
-  if (data.empty()) {
+  const auto* counters = processor_counters();
+  if (counters == nullptr || thread_id < 0 || static_cast<size_t>(thread_id) >= counters->performance.size()) {
     return -1;
   }
-  double performance = std::stod(data[thread_id]) / 100;
-  return static_cast<int64_t>(static_cast<double>(_maxClockSpeed_MHz) * performance);
+  return to_clock_speed_MHz(counters->performance[thread_id], _maxClockSpeed_MHz);
 }
 
 // _____________________________________________________________________________________________________________________
 std::vector<int64_t> CPU::currentClockSpeed_MHz() const {
-  std::vector<int64_t> result;
-  result.reserve(_numLogicalCores);
-  auto data = utils::WMI::query<std::string>(L"Win32_PerfFormattedData_Counters_ProcessorInformation",
-                                             L"PercentProcessorPerformance");
-  if (data.empty()) {
-    result.resize(_numLogicalCores, -1);
+  std::vector<int64_t> result(_numLogicalCores > 0 ? _numLogicalCores : 0, -1);
+  const auto* counters = processor_counters();
+  if (counters == nullptr) {
     return result;
   }
-  for (auto& v : data) {
-    double performance = std::stod(v) / 100;
-    result.push_back(static_cast<int64_t>(static_cast<double>(_maxClockSpeed_MHz) * performance));
+  if (result.empty()) {
+    result.resize(counters->performance.size(), -1);
   }
+  currentClockSpeed_MHz(result.data(), static_cast<int>(result.size()));
   return result;
 }
 
+// _____________________________________________________________________________________________________________________
+int CPU::currentClockSpeed_MHz(int64_t* out, int capacity) const {
+  const auto* counters = processor_counters();
+  if (counters == nullptr) {
+    return -1;
+  }
+  const size_t num_threads = _numLogicalCores > 0 ? _numLogicalCores : counters->performance.size();
+  for (size_t i = 0; i < num_threads && i < static_cast<size_t>(capacity); ++i) {
+    out[i] = i < counters->performance.size() ? to_clock_speed_MHz(counters->performance[i], _maxClockSpeed_MHz) : -1;
+  }
+  return static_cast<int>(num_threads);
+}
+
+// _____________________________________________________________________________________________________________________
 double CPU::currentUtilisation() const {
-  auto res = utils::WMI::query<std::string>(L"Win32_PerfFormattedData_Counters_ProcessorInformation",
-                                            L"PercentProcessorUtility", L"Name=" + std::to_wstring(0) + L",_Total");
-  if (res.empty()) {
-    return -1.f;
+  const auto* counters = processor_counters();
+  if (counters == nullptr) {
+    return -1.0;
   }
-  return std::stod(res[0]);
+  return to_utilisation(counters->utility_total);
 }
 
+// _____________________________________________________________________________________________________________________
 double CPU::threadUtilisation(int thread_id) const {
-  auto data = utils::WMI::query<std::string>(L"Win32_PerfFormattedData_Counters_ProcessorInformation",
-                                             L"PercentProcessorUtility");
-  if (data.empty()) {
-    return -1.f;
-  }
-  std::string thread_value = data[thread_id];
-  if (thread_value.empty()) {
-    return -1.f;
+  const auto* counters = processor_counters();
+  if (counters == nullptr || thread_id < 0 || static_cast<size_t>(thread_id) >= counters->utility.size()) {
+    return -1.0;
   }
-  return std::stod(thread_value);
+  return to_utilisation(counters->utility[thread_id]);
 }
 
+// _____________________________________________________________________________________________________________________
 std::vector<double> CPU::threadsUtilisation() const {
-  std::vector<double> thread_utility;
-  thread_utility.reserve(_numLogicalCores);
-  auto data = utils::WMI::query<std::string>(L"Win32_PerfFormattedData_Counters_ProcessorInformation",
-                                             L"PercentProcessorUtility");
-  if (data.empty()) {
-    thread_utility.resize(_numLogicalCores, -1.f);
+  std::vector<double> thread_utility(_numLogicalCores > 0 ? _numLogicalCores : 0, -1.0);
+  const auto* counters = processor_counters();
+  if (counters == nullptr) {
     return thread_utility;
   }
-  for (const auto& v : data) {
-    if (v.empty()) {
-      thread_utility.push_back(-1.f);
-    } else {
-      thread_utility.push_back(std::stod(v) / 100.f);
-    }
+  if (thread_utility.empty()) {
+    thread_utility.resize(counters->utility.size(), -1.0);
   }
+  threadsUtilisation(thread_utility.data(), static_cast<int>(thread_utility.size()));
   return thread_utility;
 }
 
+// _____________________________________________________________________________________________________________________
+int CPU::threadsUtilisation(double* out, int capacity) const {
+  if (capacity <= 0 && _numLogicalCores > 0) {
+    return _numLogicalCores;
+  }
+  const auto* counters = processor_counters();
+  if (counters == nullptr) {
+    return -1;
+  }
+  const size_t num_threads = _numLogicalCores > 0 ? _numLogicalCores : counters->utility.size();
+  for (size_t i = 0; i < num_threads && i < static_cast<size_t>(capacity); ++i) {
+    out[i] = i < counters->utility.size() ? to_utilisation(counters->utility[i]) : -1.0;
+  }
+  return static_cast<int>(num_threads);
+}
+
+// _____________________________________________________________________________________________________________________
+double CPU::socketUtilisation() const {
+  const Topology& topology = Topology::get();
+  const int32_t socket = topology.find_socket(_id);
+  const auto* counters = processor_counters();
+  if (socket < 0 || counters == nullptr) {
+    return -1.0;
+  }
+  // every thread covers the same period, so the mean over the threads is the utilisation of the socket
+  double sum = 0.0;
+  int count = 0;
+  for (size_t i = 0; i < topology.size() && i < counters->utility.size(); ++i) {
+    const double utilisation = to_utilisation(counters->utility[i]);
+    if (topology.socket()[i] == socket && utilisation >= 0) {
+      sum += utilisation;
+      count++;
+    }
+  }
+  return count > 0 ? sum / count : -1.0;
+}
+
 // =====================================================================================================================
+namespace utils {
+
+namespace {
+
 // _____________________________________________________________________________________________________________________
-std::vector<CPU> getAllCPUs() {
-  utils::WMI::_WMI wmi;
-  const std::wstring query_string(
-      L"SELECT Name, Manufacturer, NumberOfCores, NumberOfLogicalProcessors, MaxClockSpeed, L2CacheSize, L3CacheSize "
-      L"FROM Win32_Processor");
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
+// Counters of every logical processor (thread local buffer), nullptr if they could not be read.
+const std::vector<SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION>* processor_performance() {
+  const auto query_system_information = utils::nt_query_system_information();
+  if (query_system_information == nullptr) {
+    return nullptr;
   }
-  std::vector<CPU> cpus;
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  thread_local std::vector<SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION> info;
+  info.resize(system_info.dwNumberOfProcessors);
+  ULONG size = 0;
+  const auto capacity = static_cast<ULONG>(info.size() * sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION));
+  NTSTATUS status = query_system_information(SystemProcessorPerformanceInformation, info.data(), capacity, &size);
+  if (status < 0) {
+    return nullptr;
+  }
+  info.resize(size / sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION));
+  return &info;
+}
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+bool read_jiffies(Jiffies& total, std::vector<Jiffies>& threads) {
+  const auto* performance = processor_performance();
+  if (performance == nullptr) {
+    return false;
+  }
+  const auto& info = *performance;
+  threads.resize(info.size());
+  int64_t all_sum = 0;
+  int64_t working_sum = 0;
+  for (size_t i = 0; i < threads.size(); ++i) {
+    // KernelTime includes IdleTime (100ns units)
+    int64_t all = info[i].KernelTime.QuadPart + info[i].UserTime.QuadPart;
+    int64_t working = all - info[i].IdleTime.QuadPart;
+    threads[i] = Jiffies(all, working);
+    all_sum += all;
+    working_sum += working;
+  }
+  total = Jiffies(all_sum, working_sum);
+  return true;
+}
+
+}  // namespace utils
+
+// _____________________________________________________________________________________________________________________
+bool readCpuTimes(CpuTimes& total, std::vector<CpuTimes>& threads) {
+  const auto* performance = utils::processor_performance();
+  if (performance == nullptr) {
+    return false;
+  }
+  const auto& info = *performance;
+  threads.resize(info.size());
+  total = CpuTimes{0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  for (size_t i = 0; i < threads.size(); ++i) {
+    // 100ns units. KernelTime includes IdleTime and the DPC and interrupt time (Reserved1: DpcTime, InterruptTime).
+    const int64_t dpc = info[i].Reserved1[0].QuadPart;
+    const int64_t interrupt = info[i].Reserved1[1].QuadPart;
+    const int64_t idle = info[i].IdleTime.QuadPart;
+    CpuTimes& times = threads[i];
+    times = CpuTimes{0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    times.user = info[i].UserTime.QuadPart;
+    times.system = std::max<int64_t>(info[i].KernelTime.QuadPart - idle - dpc - interrupt, 0);
+    times.idle = idle;
+    times.irq = interrupt;
+    times.softirq = dpc;
+    total.user += times.user;
+    total.system += times.system;
+    total.idle += times.idle;
+    total.irq += times.irq;
+    total.softirq += times.softirq;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+std::vector<CPU> getAllCPUs(CPUFields fields) {
+  HWINFO_TRACE_SCOPE(CPU);
+  if (std::vector<CPU> cached; static_cache::load(cached)) {
+    return cached;
+  }
+  auto rows = utils::WMI::query_rows<std::string, std::string, std::optional<int>, std::optional<int>,
+                                     std::optional<unsigned>>(
+      L"Win32_Processor", {L"Name", L"Manufacturer", L"NumberOfCores", L"NumberOfLogicalProcessors", L"MaxClockSpeed"});
+  bool complete = fields == CPUFields::All && utils::WMI::last_status() == utils::WMI::Status::Complete;
+  // L1, L2, L3 (WMI does not report them per socket, so one query serves all sockets)
+  std::vector<std::optional<unsigned>> cache_sizes;
+  if (contains(fields, CPUFields::Caches)) {
+    cache_sizes = utils::WMI::query<std::optional<unsigned>>(L"Win32_CacheMemory", L"MaxCacheSize");
+    complete = complete && utils::WMI::last_status() == utils::WMI::Status::Complete;
+  }
+  // record the baseline of the rate counters, so that the first utilisation/frequency read covers a real period
+  utils::ProcessorCounters::get();
+#if defined(HWINFO_X86)
+  const FeatureSet features = contains(fields, CPUFields::Features) ? cpuid::read_features() : FeatureSet();
+#endif
+  std::vector<CPU> cpus;
+  cpus.reserve(rows.size());
   int cpu_id = 0;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
+  for (auto& [name, manufacturer, cores, logical_processors, max_clock_speed] : rows) {
     CPU cpu;
     cpu._id = cpu_id++;
-    VARIANT vt_prop;
-    HRESULT hr;
-    hr = obj->Get(L"Name", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      cpu._modelName = utils::wstring_to_std_string(vt_prop.bstrVal);
-    }
-    hr = obj->Get(L"Manufacturer", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      cpu._vendor = utils::wstring_to_std_string(vt_prop.bstrVal);
+    cpu._modelName = std::move(name);
+    cpu._vendor = std::move(manufacturer);
+#if defined(HWINFO_X86)
+    cpu._features = features;
+#endif
+    if (cores) {
+      cpu._numPhysicalCores = *cores;
     }
-    hr = obj->Get(L"NumberOfCores", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_I4)) {
-      cpu._numPhysicalCores = vt_prop.intVal;
+    if (logical_processors) {
+      cpu._numLogicalCores = *logical_processors;
     }
-    hr = obj->Get(L"NumberOfLogicalProcessors", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_I4)) {
-      cpu._numLogicalCores = vt_prop.intVal;
+    if (max_clock_speed && contains(fields, CPUFields::Clocks)) {
+      cpu._maxClockSpeed_MHz = *max_clock_speed;
+      cpu._regularClockSpeed_MHz = *max_clock_speed;
     }
-    hr = obj->Get(L"MaxClockSpeed", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_I4)) {
-      cpu._maxClockSpeed_MHz = vt_prop.uintVal;
-      cpu._regularClockSpeed_MHz = vt_prop.uintVal;
+    int64_t* caches[] = {&cpu._L1CacheSize_Bytes, &cpu._L2CacheSize_Bytes, &cpu._L3CacheSize_Bytes};
+    for (size_t i = 0; i < 3 && i < cache_sizes.size(); ++i) {
+      *caches[i] = cache_sizes[i] ? static_cast<int64_t>(*cache_sizes[i]) : -1;
     }
-    VariantClear(&vt_prop);
-    obj->Release();
-    auto cache{[&]() -> void {
-      auto data = utils::WMI::query<std::uint32_t>(L"Win32_CacheMemory", L"MaxCacheSize");
-      if (data.empty()) {
-        cpu._L1CacheSize_Bytes = cpu._L2CacheSize_Bytes = cpu._L3CacheSize_Bytes = -1;
-      }
-      try {
-        cpu._L1CacheSize_Bytes = data.at(0);
-        cpu._L2CacheSize_Bytes = data.at(1);
-        cpu._L3CacheSize_Bytes = data.at(2);
-      } catch (const std::exception& e) {
-        std::cout << "Exception in CPU Cache: " << e.what() << '\n';
-      }
-    }};
-    cache();
     cpus.push_back(std::move(cpu));
   }
+  // partial results (of a WMI timeout or a field mask) are returned but not cached
+  if (complete) {
+    static_cache::store(cpus);
+  }
   return cpus;
 }
 
@@ -0,0 +1,172 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <dbt.h>
+#include <hwinfo/device_monitor.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace hwinfo {
+
+namespace {
+
+// device interface classes (defined here instead of pulling in the DDK headers with INITGUID)
+constexpr GUID disk_interface = {0x53f56307, 0xb6bf, 0x11d0, {0x94, 0xf2, 0x00, 0xa0, 0xc9, 0x1e, 0xfb, 0x8b}};
+constexpr GUID volume_interface = {0x53f5630d, 0xb6bf, 0x11d0, {0x94, 0xf2, 0x00, 0xa0, 0xc9, 0x1e, 0xfb, 0x8b}};
+constexpr GUID network_interface = {0xcac88484, 0x7515, 0x4c03, {0x82, 0xe6, 0x71, 0xa8, 0x7a, 0xba, 0xc3, 0x61}};
+constexpr GUID battery_interface = {0x72631e54, 0x78a4, 0x11d0, {0xbc, 0xf7, 0x00, 0xaa, 0x00, 0xb7, 0xb3, 0x2a}};
+constexpr GUID display_interface = {0x5b45201d, 0xf2f2, 0x4f3b, {0x85, 0xbb, 0x30, 0xff, 0x1f, 0x95, 0x35, 0x99}};
+
+// _____________________________________________________________________________________________________________________
+bool equal(const GUID& a, const GUID& b) { return std::memcmp(&a, &b, sizeof(GUID)) == 0; }
+
+// _____________________________________________________________________________________________________________________
+Component classify(const DEV_BROADCAST_HDR* header) {
+  if (header == nullptr) {
+    return Component::None;
+  }
+  if (header->dbch_devicetype == DBT_DEVTYP_VOLUME) {
+    return Component::Disk;
+  }
+  if (header->dbch_devicetype != DBT_DEVTYP_DEVICEINTERFACE) {
+    return Component::None;
+  }
+  const GUID& guid = reinterpret_cast<const DEV_BROADCAST_DEVICEINTERFACE_W*>(header)->dbcc_classguid;
+  if (equal(guid, disk_interface) || equal(guid, volume_interface)) return Component::Disk;
+  if (equal(guid, network_interface)) return Component::Network;
+  if (equal(guid, battery_interface)) return Component::Battery;
+  if (equal(guid, display_interface)) return Component::GPU;
+  return Component::None;
+}
+
+}  // namespace
+
+struct DeviceMonitor::Source {
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t pending{0};
+  bool interrupted{false};
+  // set once the thread created its window (or failed to)
+  bool started{false};
+  bool valid{false};
+  DWORD thread_id{0};
+  std::thread thread;
+
+  static LRESULT CALLBACK windowProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam) {
+    if (message == WM_NCCREATE) {
+      SetWindowLongPtrW(window, GWLP_USERDATA,
+                        reinterpret_cast<LONG_PTR>(reinterpret_cast<CREATESTRUCTW*>(lparam)->lpCreateParams));
+    } else if (message == WM_DEVICECHANGE && (wparam == DBT_DEVICEARRIVAL || wparam == DBT_DEVICEREMOVECOMPLETE)) {
+      auto* source = reinterpret_cast<Source*>(GetWindowLongPtrW(window, GWLP_USERDATA));
+      const Component changed = classify(reinterpret_cast<const DEV_BROADCAST_HDR*>(lparam));
+      if (source != nullptr && changed != Component::None) {
+        {
+          std::lock_guard<std::mutex> lock(source->mutex);
+          source->pending |= static_cast<uint32_t>(changed);
+        }
+        source->cv.notify_all();
+      }
+      return TRUE;
+    }
+    return DefWindowProcW(window, message, wparam, lparam);
+  }
+
+  // Owns a message-only window: device notifications are only delivered to windows (or services).
+  void run() {
+    const wchar_t* class_name = L"hwinfo_device_monitor";
+    WNDCLASSEXW window_class{};
+    window_class.cbSize = sizeof(window_class);
+    window_class.lpfnWndProc = &Source::windowProc;
+    window_class.hInstance = GetModuleHandleW(nullptr);
+    window_class.lpszClassName = class_name;
+    // fails harmlessly if another monitor registered the class already
+    RegisterClassExW(&window_class);
+    HWND window = CreateWindowExW(0, class_name, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, nullptr, window_class.hInstance,
+                                  this);
+    HDEVNOTIFY notification = nullptr;
+    if (window != nullptr) {
+      DEV_BROADCAST_DEVICEINTERFACE_W filter{};
+      filter.dbcc_size = sizeof(filter);
+      filter.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
+      notification = RegisterDeviceNotificationW(window, &filter,
+                                                 DEVICE_NOTIFY_WINDOW_HANDLE | DEVICE_NOTIFY_ALL_INTERFACE_CLASSES);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      valid = notification != nullptr;
+      thread_id = GetCurrentThreadId();
+      started = true;
+    }
+    cv.notify_all();
+
+    MSG message;
+    while (valid && GetMessageW(&message, nullptr, 0, 0) > 0) {
+      TranslateMessage(&message);
+      DispatchMessageW(&message);
+    }
+    if (notification != nullptr) {
+      UnregisterDeviceNotification(notification);
+    }
+    if (window != nullptr) {
+      DestroyWindow(window);
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+DeviceMonitor::DeviceMonitor() : _source(new Source()) {
+  _source->thread = std::thread(&Source::run, _source.get());
+  std::unique_lock<std::mutex> lock(_source->mutex);
+  _source->cv.wait(lock, [this] { return _source->started; });
+}
+
+// _____________________________________________________________________________________________________________________
+DeviceMonitor::~DeviceMonitor() {
+  // creating the window gave the thread its message queue; without notifications the thread already returned
+  if (_source->valid) {
+    PostThreadMessageW(_source->thread_id, WM_QUIT, 0, 0);
+  }
+  _source->thread.join();
+}
+
+// _____________________________________________________________________________________________________________________
+bool DeviceMonitor::valid() const { return _source->valid; }
+
+// _____________________________________________________________________________________________________________________
+int DeviceMonitor::fd() const { return -1; }
+
+// _____________________________________________________________________________________________________________________
+Component DeviceMonitor::wait(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(_source->mutex);
+  const auto ready = [this] { return _source->pending != 0 || _source->interrupted; };
+  if (timeout.count() < 0) {
+    _source->cv.wait(lock, ready);
+  } else {
+    _source->cv.wait_for(lock, timeout, ready);
+  }
+  const auto changed = static_cast<Component>(_source->pending);
+  _source->pending = 0;
+  _source->interrupted = false;
+  return changed;
+}
+
+// _____________________________________________________________________________________________________________________
+void DeviceMonitor::interrupt() {
+  {
+    std::lock_guard<std::mutex> lock(_source->mutex);
+    _source->interrupted = true;
+  }
+  _source->cv.notify_all();
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
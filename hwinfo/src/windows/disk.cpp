@@ -5,10 +5,21 @@
 
 #ifdef HWINFO_WINDOWS
 
+#include <Windows.h>
+#include <SetupAPI.h>
+#include <winioctl.h>
 #include <hwinfo/disk.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <map>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -16,6 +27,222 @@
 
 namespace hwinfo {
 
+namespace {
+
+// GUID_DEVINTERFACE_DISK, spelled out so that no translation unit has to instantiate it via initguid.h
+constexpr GUID kDiskInterface = {0x53f56307, 0xb6bf, 0x11d0, {0x94, 0xf2, 0x00, 0xa0, 0xc9, 0x1e, 0xfb, 0x8b}};
+
+// Handle of a device that is opened without access rights: enough for the query ioctls used here, so no elevation is
+// needed.
+class DeviceHandle {
+ public:
+  explicit DeviceHandle(const wchar_t* path)
+      : _handle(CreateFileW(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr)) {}
+  ~DeviceHandle() {
+    if (valid()) CloseHandle(_handle);
+  }
+  DeviceHandle(const DeviceHandle&) = delete;
+  DeviceHandle& operator=(const DeviceHandle&) = delete;
+
+  HWI_NODISCARD bool valid() const { return _handle != INVALID_HANDLE_VALUE; }
+
+  bool ioctl(DWORD code, const void* in, DWORD in_size, void* out, DWORD out_size) const {
+    DWORD size = 0;
+    return DeviceIoControl(_handle, code, const_cast<void*>(in), in_size, out, out_size, &size, nullptr) != 0;
+  }
+
+ private:
+  HANDLE _handle;
+};
+
+// _____________________________________________________________________________________________________________________
+// String at offset of a STORAGE_DEVICE_DESCRIPTOR (0: not reported), without the padding spaces.
+std::string descriptor_string(const std::vector<char>& buffer, DWORD offset) {
+  if (offset == 0 || offset >= buffer.size()) {
+    return {};
+  }
+  const char* begin = buffer.data() + offset;
+  std::string value(begin, strnlen(begin, buffer.size() - offset));
+  utils::strip(value);
+  return value;
+}
+
+// A disk of the native path.
+struct NativeDisk {
+  DWORD number{0};
+  std::string vendor;
+  std::string model;
+  std::string serial_number;
+  int64_t size_Bytes{-1};
+};
+
+// _____________________________________________________________________________________________________________________
+// Vendor, product and serial number from IOCTL_STORAGE_QUERY_PROPERTY(StorageDeviceProperty).
+void read_descriptor(const DeviceHandle& device, NativeDisk& disk) {
+  STORAGE_PROPERTY_QUERY query{};
+  query.PropertyId = StorageDeviceProperty;
+  query.QueryType = PropertyStandardQuery;
+  STORAGE_DESCRIPTOR_HEADER header{};
+  if (!device.ioctl(IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query), &header, sizeof(header)) ||
+      header.Size < sizeof(STORAGE_DEVICE_DESCRIPTOR)) {
+    return;
+  }
+  std::vector<char> buffer(header.Size);
+  if (!device.ioctl(IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query), buffer.data(),
+                    static_cast<DWORD>(buffer.size()))) {
+    return;
+  }
+  const auto* descriptor = reinterpret_cast<const STORAGE_DEVICE_DESCRIPTOR*>(buffer.data());
+  disk.vendor = descriptor_string(buffer, descriptor->VendorIdOffset);
+  disk.model = descriptor_string(buffer, descriptor->ProductIdOffset);
+  disk.serial_number = descriptor_string(buffer, descriptor->SerialNumberOffset);
+}
+
+// _____________________________________________________________________________________________________________________
+// Disk numbers (the N of \\.\PHYSICALDRIVEN) that a volume has extents on. Spanned and striped volumes (dynamic
+// disks, Storage Spaces) return more than one.
+std::vector<DWORD> volume_disks(const DeviceHandle& volume) {
+  std::vector<char> buffer(sizeof(VOLUME_DISK_EXTENTS));
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    auto* extents = reinterpret_cast<VOLUME_DISK_EXTENTS*>(buffer.data());
+    if (volume.ioctl(IOCTL_VOLUME_GET_VOLUME_DISK_EXTENTS, nullptr, 0, buffer.data(),
+                     static_cast<DWORD>(buffer.size()))) {
+      std::vector<DWORD> disks;
+      for (DWORD i = 0; i < extents->NumberOfDiskExtents; ++i) {
+        disks.push_back(extents->Extents[i].DiskNumber);
+      }
+      return disks;
+    }
+    if (GetLastError() != ERROR_MORE_DATA) {
+      break;
+    }
+    // the first call reported the number of extents
+    buffer.resize(offsetof(VOLUME_DISK_EXTENTS, Extents) + extents->NumberOfDiskExtents * sizeof(DISK_EXTENT));
+  }
+  return {};
+}
+
+// _____________________________________________________________________________________________________________________
+// Mount points of a volume ("C:", "D:\mnt\data") from GetVolumePathNamesForVolumeNameW().
+std::vector<std::string> mount_points(const wchar_t* volume_name) {
+  std::vector<wchar_t> names(MAX_PATH + 1);
+  DWORD size = 0;
+  if (!GetVolumePathNamesForVolumeNameW(volume_name, names.data(), static_cast<DWORD>(names.size()), &size)) {
+    if (GetLastError() != ERROR_MORE_DATA) {
+      return {};
+    }
+    names.resize(size);
+    if (!GetVolumePathNamesForVolumeNameW(volume_name, names.data(), static_cast<DWORD>(names.size()), &size)) {
+      return {};
+    }
+  }
+  std::vector<std::string> result;
+  // double zero terminated list of paths with a trailing backslash
+  for (const wchar_t* name = names.data(); *name != L'\0'; name += wcslen(name) + 1) {
+    std::wstring path(name);
+    if (path.size() > 1 && path.back() == L'\\') {
+      path.pop_back();
+    }
+    result.push_back(utils::wstring_to_std_string(path));
+  }
+  return result;
+}
+
+// Volumes on a disk, keyed by its disk number.
+struct DiskVolumes {
+  std::vector<std::string> volumes;
+  int64_t free_Bytes{-1};
+};
+
+// _____________________________________________________________________________________________________________________
+// One pass over all volumes: their disk extents, mount points and free space. Each volume counts towards the free space
+// of its first disk only, so that spanned volumes are not counted twice.
+std::map<DWORD, DiskVolumes> read_volumes() {
+  std::map<DWORD, DiskVolumes> result;
+  wchar_t volume_name[MAX_PATH];
+  HANDLE find = FindFirstVolumeW(volume_name, MAX_PATH);
+  if (find == INVALID_HANDLE_VALUE) {
+    return result;
+  }
+  do {
+    std::vector<std::string> mounts = mount_points(volume_name);
+    if (mounts.empty()) {
+      // recovery and EFI partitions, the WMI path does not report them either
+      continue;
+    }
+    // "\\?\Volume{...}\": the volume device is opened without the trailing backslash
+    std::wstring device(volume_name);
+    if (!device.empty() && device.back() == L'\\') {
+      device.pop_back();
+    }
+    std::vector<DWORD> disks = volume_disks(DeviceHandle(device.c_str()));
+    if (disks.empty()) {
+      continue;
+    }
+    for (DWORD disk : disks) {
+      auto& volumes = result[disk].volumes;
+      volumes.insert(volumes.end(), mounts.begin(), mounts.end());
+    }
+    ULARGE_INTEGER free_Bytes;
+    if (GetDiskFreeSpaceExW(volume_name, nullptr, nullptr, &free_Bytes)) {
+      int64_t& total = result[disks.front()].free_Bytes;
+      total = std::max<int64_t>(total, 0) + static_cast<int64_t>(free_Bytes.QuadPart);
+    }
+  } while (FindNextVolumeW(find, volume_name, MAX_PATH));
+  FindVolumeClose(find);
+  return result;
+}
+
+// _____________________________________________________________________________________________________________________
+// Disks from the disk device interfaces (SetupAPI) and storage ioctls, in the order of their disk numbers (like
+// Win32_DiskDrive.Index). nullopt if SetupAPI is not usable or finds no disk, so that the WMI path runs instead.
+std::optional<std::vector<NativeDisk>> native_disks(DiskFields fields) {
+  HDEVINFO set = SetupDiGetClassDevsW(&kDiskInterface, nullptr, nullptr, DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
+  if (set == INVALID_HANDLE_VALUE) {
+    return std::nullopt;
+  }
+  std::vector<NativeDisk> disks;
+  SP_DEVICE_INTERFACE_DATA interface_data{};
+  interface_data.cbSize = sizeof(interface_data);
+  for (DWORD i = 0; SetupDiEnumDeviceInterfaces(set, nullptr, &kDiskInterface, i, &interface_data); ++i) {
+    DWORD size = 0;
+    SetupDiGetDeviceInterfaceDetailW(set, &interface_data, nullptr, 0, &size, nullptr);
+    if (size < sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W)) {
+      continue;
+    }
+    std::vector<char> buffer(size);
+    auto* detail = reinterpret_cast<SP_DEVICE_INTERFACE_DETAIL_DATA_W*>(buffer.data());
+    detail->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W);
+    if (!SetupDiGetDeviceInterfaceDetailW(set, &interface_data, detail, size, nullptr, nullptr)) {
+      continue;
+    }
+    const DeviceHandle device(detail->DevicePath);
+    STORAGE_DEVICE_NUMBER number{};
+    if (!device.valid() || !device.ioctl(IOCTL_STORAGE_GET_DEVICE_NUMBER, nullptr, 0, &number, sizeof(number))) {
+      continue;
+    }
+    NativeDisk disk;
+    disk.number = number.DeviceNumber;
+    if (contains(fields, DiskFields::Identity)) {
+      read_descriptor(device, disk);
+    }
+    DISK_GEOMETRY_EX geometry{};
+    if (contains(fields, DiskFields::Size) &&
+        device.ioctl(IOCTL_DISK_GET_DRIVE_GEOMETRY_EX, nullptr, 0, &geometry, sizeof(geometry))) {
+      disk.size_Bytes = geometry.DiskSize.QuadPart;
+    }
+    disks.push_back(std::move(disk));
+  }
+  SetupDiDestroyDeviceInfoList(set);
+  if (disks.empty()) {
+    return std::nullopt;
+  }
+  std::sort(disks.begin(), disks.end(), [](const NativeDisk& a, const NativeDisk& b) { return a.number < b.number; });
+  return disks;
+}
+
+}  // namespace
+
 // -----------------------------------------------------------------------------
 // Extracts the actual device path from a WMI reference string
 // Example: "Win32_DiskDrive=\"\\\\.\\PHYSICALDRIVE0\"" → "\\\\.\\PHYSICALDRIVE0"
@@ -55,41 +282,22 @@ std::wstring normalizeBackslashes(const std::wstring& path) {
 };
 
 std::unordered_map<std::wstring, std::wstring> getPartitionToLogicalMapping() {
-  utils::WMI::_WMI wmi;
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-
   std::unordered_map<std::wstring, std::wstring> partitionToLogical;
 
   // -------------------------------------------------------------------------
   // Map logical drives to partitions
   // -------------------------------------------------------------------------
-  if (wmi.execute_query(L"SELECT Antecedent, Dependent FROM Win32_LogicalDiskToPartition")) {
-    while (wmi.enumerator) {
-      wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-      if (!u_return || obj == nullptr) {
-        break;
-      }
-
-      VARIANT vtPartition, vtLogical;
-      VariantInit(&vtPartition);
-      VariantInit(&vtLogical);
-
-      if (SUCCEEDED(obj->Get(L"Antecedent", 0, &vtPartition, nullptr, nullptr)) &&
-          SUCCEEDED(obj->Get(L"Dependent", 0, &vtLogical, nullptr, nullptr))) {
-        if (V_VT(&vtPartition) == VT_BSTR && V_VT(&vtLogical) == VT_BSTR) {
-          std::wstring logicalDrive = vtLogical.bstrVal;
-          size_t startPos = logicalDrive.find(L"\"");
-          size_t endPos = logicalDrive.rfind(L"\"");
+  for (const auto& [partition, logicalDrive] :
+       utils::WMI::query_rows<std::optional<std::wstring>, std::optional<std::wstring>>(
+           L"Win32_LogicalDiskToPartition", {L"Antecedent", L"Dependent"})) {
+    if (!partition || !logicalDrive) {
+      continue;
+    }
+    size_t startPos = logicalDrive->find(L"\"");
+    size_t endPos = logicalDrive->rfind(L"\"");
 
-          if (startPos != std::wstring::npos && endPos > startPos) {
-            partitionToLogical[vtPartition.bstrVal] = logicalDrive.substr(startPos + 1, endPos - startPos - 1);
-          }
-        }
-      }
-      VariantClear(&vtPartition);
-      VariantClear(&vtLogical);
-      obj->Release();
+    if (startPos != std::wstring::npos && endPos > startPos) {
+      partitionToLogical[*partition] = logicalDrive->substr(startPos + 1, endPos - startPos - 1);
     }
   }
 
@@ -97,35 +305,16 @@ std::unordered_map<std::wstring, std::wstring> getPartitionToLogicalMapping() {
 }
 
 std::unordered_map<std::wstring, std::wstring> getDiskToPartitionMapping() {
-  utils::WMI::_WMI wmi;
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-
   std::unordered_map<std::wstring, std::wstring> partitionToDisk;
 
   // -------------------------------------------------------------------------
   // Map partitions to physical disks
   // -------------------------------------------------------------------------
-  if (wmi.execute_query(L"SELECT Antecedent, Dependent FROM Win32_DiskDriveToDiskPartition")) {
-    while (wmi.enumerator) {
-      wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-      if (!u_return || obj == nullptr) {
-        break;
-      }
-
-      VARIANT vtDisk, vtPartition;
-      VariantInit(&vtDisk);
-      VariantInit(&vtPartition);
-
-      if (SUCCEEDED(obj->Get(L"Antecedent", 0, &vtDisk, nullptr, nullptr)) &&
-          SUCCEEDED(obj->Get(L"Dependent", 0, &vtPartition, nullptr, nullptr))) {
-        if (V_VT(&vtDisk) == VT_BSTR && V_VT(&vtPartition) == VT_BSTR) {
-          partitionToDisk[vtPartition.bstrVal] = extractDevicePath(vtDisk.bstrVal);
-        }
-      }
-      VariantClear(&vtDisk);
-      VariantClear(&vtPartition);
-      obj->Release();
+  for (const auto& [disk, partition] :
+       utils::WMI::query_rows<std::optional<std::wstring>, std::optional<std::wstring>>(
+           L"Win32_DiskDriveToDiskPartition", {L"Antecedent", L"Dependent"})) {
+    if (disk && partition) {
+      partitionToDisk[*partition] = extractDevicePath(*disk);
     }
   }
 
@@ -139,36 +328,17 @@ std::unordered_map<std::wstring, std::wstring> getDiskToPartitionMapping() {
 std::unordered_map<std::wstring, uint64_t> computePhysicalFreeSpace(
     const std::unordered_map<std::wstring, std::wstring>& partitionToLogical,
     const std::unordered_map<std::wstring, std::wstring>& partitionToDisk) {
-  utils::WMI::_WMI wmi;
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-
   // Maps for tracking relationships
   std::unordered_map<std::wstring, uint64_t> logicalDriveToFree;
 
   // -------------------------------------------------------------------------
   // Read logical disk free space
   // -------------------------------------------------------------------------
-  if (wmi.execute_query(L"SELECT DeviceID, FreeSpace FROM Win32_LogicalDisk")) {
-    while (wmi.enumerator) {
-      wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-      if (!u_return || obj == nullptr) {
-        break;
-      }
-
-      VARIANT vtDeviceID, vtFreeSpace;
-      VariantInit(&vtDeviceID);
-      VariantInit(&vtFreeSpace);
-
-      if (SUCCEEDED(obj->Get(L"DeviceID", 0, &vtDeviceID, nullptr, nullptr)) &&
-          SUCCEEDED(obj->Get(L"FreeSpace", 0, &vtFreeSpace, nullptr, nullptr))) {
-        if (V_VT(&vtDeviceID) == VT_BSTR && V_VT(&vtFreeSpace) == VT_BSTR) {
-          logicalDriveToFree[vtDeviceID.bstrVal] = std::stoll(utils::wstring_to_std_string(vtFreeSpace.bstrVal));
-        }
-      }
-      VariantClear(&vtDeviceID);
-      VariantClear(&vtFreeSpace);
-      obj->Release();
+  for (const auto& [deviceId, freeSpace] :
+       utils::WMI::query_rows<std::optional<std::wstring>, std::optional<unsigned long long>>(
+           L"Win32_LogicalDisk", {L"DeviceID", L"FreeSpace"})) {
+    if (deviceId && freeSpace) {
+      logicalDriveToFree[*deviceId] = *freeSpace;
     }
   }
 
@@ -209,68 +379,71 @@ std::unordered_map<std::wstring, std::vector<std::string>> getDiskToLogicalDrive
 }
 
 // _____________________________________________________________________________________________________________________
-std::vector<Disk> getAllDisks() {
-  utils::WMI::_WMI wmi;
-  const std::wstring query_string(L"SELECT Model, Manufacturer, SerialNumber, Size, DeviceID FROM Win32_DiskDrive");
-
-  if (!wmi.execute_query(query_string)) {
+std::vector<Disk> getAllDisks(DiskFields fields) {
+  HWINFO_TRACE_SCOPE(Disk);
+  // native path: one pass over the disk interfaces and one over the volumes, no WMI association classes (which take
+  // seconds on servers with many volumes)
+  if (auto native = native_disks(fields)) {
+    std::map<DWORD, DiskVolumes> volumes;
+    if (contains(fields, DiskFields::Volumes)) {
+      volumes = read_volumes();
+    }
+    std::vector<Disk> disks;
+    disks.reserve(native->size());
+    for (auto& entry : *native) {
+      Disk disk;
+      disk._id = static_cast<int>(disks.size());
+      disk._vendor = std::move(entry.vendor);
+      disk._model = std::move(entry.model);
+      disk._serialNumber = std::move(entry.serial_number);
+      disk._size_Bytes = entry.size_Bytes;
+      disk._device_name = "\\\\.\\PHYSICALDRIVE" + std::to_string(entry.number);
+      if (auto it = volumes.find(entry.number); it != volumes.end()) {
+        disk._volumes = std::move(it->second.volumes);
+        disk._free_size_Bytes = it->second.free_Bytes;
+      }
+      disks.push_back(std::move(disk));
+    }
+    return disks;
+  }
+  // WMI fallback: three association queries and the matching of their reference strings. Reads every field, only the
+  // volume associations are skipped if not requested.
+  auto rows = utils::WMI::query_rows<std::string, std::string, std::string, std::optional<long long>,
+                                     std::optional<std::wstring>>(
+      L"Win32_DiskDrive", {L"Model", L"Manufacturer", L"SerialNumber", L"Size", L"DeviceID"});
+  if (rows.empty()) {
     return {};
   }
 
   std::vector<Disk> disks;
+  disks.reserve(rows.size());
 
   // Get all mappings upfront
-  auto partitionToLogical = getPartitionToLogicalMapping();
-  auto partitionToDisk = getDiskToPartitionMapping();
-  auto physicalFreeSize = computePhysicalFreeSpace(partitionToLogical, partitionToDisk);
-  auto diskToLogicalDrives = getDiskToLogicalDrivesMapping(partitionToLogical, partitionToDisk);
+  std::unordered_map<std::wstring, uint64_t> physicalFreeSize;
+  std::unordered_map<std::wstring, std::vector<std::string>> diskToLogicalDrives;
+  if (contains(fields, DiskFields::Volumes)) {
+    auto partitionToLogical = getPartitionToLogicalMapping();
+    auto partitionToDisk = getDiskToPartitionMapping();
+    physicalFreeSize = computePhysicalFreeSpace(partitionToLogical, partitionToDisk);
+    diskToLogicalDrives = getDiskToLogicalDrivesMapping(partitionToLogical, partitionToDisk);
+  }
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
   int disk_id = 0;
 
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return || obj == nullptr) {
-      break;
-    }
-
+  for (auto& [model, manufacturer, serialNumber, size, deviceId] : rows) {
     Disk disk;
     disk._id = disk_id++;
-
-    VARIANT vt_prop;
-    HRESULT hr;
-
-    hr = obj->Get(L"Model", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      disk._model = utils::wstring_to_std_string(vt_prop.bstrVal);
-    }
-    VariantClear(&vt_prop);
-
-    hr = obj->Get(L"Manufacturer", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      disk._vendor = utils::wstring_to_std_string(vt_prop.bstrVal);
-    }
-    VariantClear(&vt_prop);
-
-    hr = obj->Get(L"SerialNumber", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      disk._serialNumber = utils::wstring_to_std_string(vt_prop.bstrVal);
-    }
-    VariantClear(&vt_prop);
-
-    hr = obj->Get(L"Size", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      disk._size_Bytes = std::stoll(utils::wstring_to_std_string(vt_prop.bstrVal));
+    disk._model = std::move(model);
+    disk._vendor = std::move(manufacturer);
+    disk._serialNumber = std::move(serialNumber);
+    if (size) {
+      disk._size_Bytes = *size;
     }
-    VariantClear(&vt_prop);
 
     // Get device ID and match with pre-computed mappings
-    hr = obj->Get(L"DeviceID", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      auto deviceIdW = vt_prop.bstrVal;
-      auto normalizedDeviceId = normalizeBackslashes(deviceIdW);
-      VariantClear(&vt_prop);
+    if (deviceId) {
+      auto normalizedDeviceId = normalizeBackslashes(*deviceId);
+      disk._device_name = utils::wstring_to_std_string(normalizedDeviceId);
 
       // Look up logical drives for this disk
       auto logicalDrivesIter = diskToLogicalDrives.find(normalizedDeviceId);
@@ -289,7 +462,6 @@ std::vector<Disk> getAllDisks() {
       }
     }
 
-    obj->Release();
     disks.push_back(std::move(disk));
   }
 
@@ -0,0 +1,80 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <winioctl.h>
+#include <hwinfo/disk_stats.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+struct DiskStatsSampler::Source {
+  // one handle per disk, INVALID_HANDLE_VALUE if it could not be opened
+  std::vector<HANDLE> handles;
+
+  ~Source() {
+    for (HANDLE handle : handles) {
+      if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+      }
+    }
+  }
+};
+
+// _____________________________________________________________________________________________________________________
+DiskStatsSampler::DiskStatsSampler(std::vector<std::string> device_names)
+    : _device_names(std::move(device_names)),
+      _source(new Source()),
+      _previous(_device_names.size()),
+      _current(_device_names.size()),
+      _stats(_device_names.size()) {
+  for (const auto& name : _device_names) {
+    // "\\.\PHYSICALDRIVE0": querying the performance counters needs no access rights
+    _source->handles.push_back(CreateFileA(name.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                                           0, nullptr));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+DiskStatsSampler::~DiskStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool DiskStatsSampler::read_counters() {
+  bool any = false;
+  for (size_t i = 0; i < _source->handles.size(); ++i) {
+    DISK_PERFORMANCE performance{};
+    DWORD size = 0;
+    if (_source->handles[i] == INVALID_HANDLE_VALUE ||
+        !DeviceIoControl(_source->handles[i], IOCTL_DISK_PERFORMANCE, nullptr, 0, &performance, sizeof(performance),
+                         &size, nullptr)) {
+      continue;
+    }
+    // times are in 100 ns units
+    constexpr int64_t ticks_per_ms = 10000;
+    Counters& counters = _current[i];
+    counters.reads = performance.ReadCount;
+    counters.writes = performance.WriteCount;
+    counters.read_Bytes = performance.BytesRead.QuadPart;
+    counters.written_Bytes = performance.BytesWritten.QuadPart;
+    counters.read_time_ms = performance.ReadTime.QuadPart / ticks_per_ms;
+    counters.write_time_ms = performance.WriteTime.QuadPart / ticks_per_ms;
+    counters.in_flight = performance.QueueDepth;
+    // QueryTime is the time stamp of the query: everything that was not idle was busy
+    counters.busy_time_ms = (performance.QueryTime.QuadPart - performance.IdleTime.QuadPart) / ticks_per_ms;
+    // not reported as such: the summed request time over the period yields the same mean queue depth
+    counters.weighted_time_ms = counters.read_time_ms + counters.write_time_ms;
+    any = true;
+  }
+  return any;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -0,0 +1,70 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <powrprof.h>
+#include <hwinfo/frequency_stats.h>
+
+#include <algorithm>
+#include <vector>
+#pragma comment(lib, "PowrProf.lib")
+
+namespace hwinfo {
+
+namespace {
+
+// Documented for CallNtPowerInformation(ProcessorInformation), but not declared by the SDK.
+struct ProcessorPowerInformation {
+  ULONG Number;
+  ULONG MaxMhz;
+  ULONG CurrentMhz;
+  ULONG MhzLimit;
+  ULONG MaxIdleState;
+  ULONG CurrentIdleState;
+};
+
+}  // namespace
+
+struct FrequencySampler::Source {
+  // one entry per cpu, reused by every update
+  std::vector<ProcessorPowerInformation> buffer;
+};
+
+// _____________________________________________________________________________________________________________________
+FrequencySampler::FrequencySampler(int num_threads)
+    : _source(new Source()),
+      _previous(static_cast<size_t>(std::max(num_threads, 0))),
+      _current(_previous.size()),
+      _stats(_previous.size()) {
+  _source->buffer.resize(_stats.size());
+}
+
+// _____________________________________________________________________________________________________________________
+FrequencySampler::~FrequencySampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool FrequencySampler::available() const { return !_source->buffer.empty(); }
+
+// _____________________________________________________________________________________________________________________
+bool FrequencySampler::read_counters() {
+  auto& buffer = _source->buffer;
+  // one call for all cpus (of the processor group of the calling thread)
+  const auto size = static_cast<ULONG>(buffer.size() * sizeof(ProcessorPowerInformation));
+  if (buffer.empty() || CallNtPowerInformation(ProcessorInformation, nullptr, 0, buffer.data(), size) != 0) {
+    return false;
+  }
+  for (const auto& info : buffer) {
+    if (info.Number < _stats.size()) {
+      _stats[info.Number].busy_MHz = static_cast<double>(info.CurrentMhz);
+    }
+  }
+  return true;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
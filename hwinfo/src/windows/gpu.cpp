@@ -7,92 +7,61 @@
 
 #include <hwinfo/gpu.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
 #include <algorithm>
+#include <optional>
 #include <string>
 #include <vector>
 #pragma comment(lib, "wbemuuid.lib")
 
-#ifdef USE_OCL
-#include <hwinfo/opencl/device.h>
-#endif
-
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
-std::vector<GPU> getAllGPUs() {
-  utils::WMI::_WMI wmi;
-  const std::wstring query_string(
-      L"SELECT Name, AdapterCompatibility, DriverVersion, AdapterRam, PNPDeviceID "
-      L"FROM WIN32_VideoController");
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
+std::vector<GPU> getAllGPUs(GPUFields fields) {
+  HWINFO_TRACE_SCOPE(GPU);
+  if (std::vector<GPU> cached; static_cache::load(cached)) {
+    return cached;
   }
+  auto rows = utils::WMI::query_rows<std::string, std::string, std::string, std::optional<unsigned>,
+                                     std::optional<std::string>>(
+      L"WIN32_VideoController", {L"Name", L"AdapterCompatibility", L"DriverVersion", L"AdapterRam", L"PNPDeviceID"});
+  // one query serves all fields, the mask only decides what is kept
+  const bool complete = fields == GPUFields::All && utils::WMI::last_status() == utils::WMI::Status::Complete;
   std::vector<GPU> gpus;
-
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
+  gpus.reserve(rows.size());
   int gpu_id = 0;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
+  for (auto& [name, vendor, driver_version, adapter_ram, pnp_device_id] : rows) {
     GPU gpu;
     gpu._id = gpu_id++;
-    VARIANT vt_prop;
-    HRESULT hr;
-    hr = obj->Get(L"Name", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      gpu._name = utils::wstring_to_std_string(vt_prop.bstrVal);
-    }
-    hr = obj->Get(L"AdapterCompatibility", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      gpu._vendor = utils::wstring_to_std_string(vt_prop.bstrVal);
+    if (contains(fields, GPUFields::Names)) {
+      gpu._name = std::move(name);
+      gpu._vendor = std::move(vendor);
+      gpu._driverVersion = std::move(driver_version);
     }
-    hr = obj->Get(L"DriverVersion", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      gpu._driverVersion = utils::wstring_to_std_string(vt_prop.bstrVal);
+    if (adapter_ram && contains(fields, GPUFields::Memory)) {
+      gpu._memory_Bytes = *adapter_ram;
     }
-    hr = obj->Get(L"AdapterRam", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_I4)) {
-      gpu._memory_Bytes = vt_prop.uintVal;
-    }
-    hr = obj->Get(L"PNPDeviceID", 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      std::string ret = utils::wstring_to_std_string(vt_prop.bstrVal);
+    if (pnp_device_id) {
+      std::string& ret = *pnp_device_id;
       if (utils::starts_with(ret, "PCI\\")) {
         utils::replaceOnce(ret, "PCI\\", "");
         std::vector<std::string> ids = utils::split(ret, "&");
+        utils::replaceOnce(ids[0], "VEN_", "");
         gpu._vendor_id = ids[0];
-        utils::replaceOnce(gpu._vendor_id, "VEN_", "");
+        utils::replaceOnce(ids[1], "DEV_", "");
         gpu._device_id = ids[1];
-        utils::replaceOnce(gpu._device_id, "DEV_", "");
       } else {
         gpu._vendor_id = "0";
         gpu._device_id = "0";
       }
     }
-    VariantClear(&vt_prop);
-    obj->Release();
     gpus.push_back(std::move(gpu));
   }
-#ifdef USE_OCL
-  auto cl_gpus = opencl_::DeviceManager::get_list<opencl_::Filter::GPU>();
-  for (auto& gpu : gpus) {
-    for (auto* cl_gpu : cl_gpus) {
-      if (cl_gpu->name() == gpu.name()) {
-        gpu._driverVersion = cl_gpu->driver_version();
-        gpu._frequency_MHz = static_cast<int64_t>(cl_gpu->clock_frequency_MHz());
-        gpu._num_cores = static_cast<int>(cl_gpu->cores());
-        gpu._memory_Bytes = static_cast<int64_t>(cl_gpu->memory_Bytes());
-        break;
-      }
-    }
+  if (complete) {
+    static_cache::store(gpus);
   }
-#endif  // USE_OCL
   return gpus;
 }
 
@@ -6,25 +6,39 @@
 #ifdef HWINFO_WINDOWS
 
 #include <hwinfo/mainboard.h>
+#include <hwinfo/utils/smbios.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
 #include <string>
+#include <utility>
 
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
 MainBoard::MainBoard() {
+  HWINFO_TRACE_SCOPE(MainBoard);
+  if (static_cache::load(*this)) {
+    return;
+  }
+  smbios::BoardInfo board;
+  if (smbios::baseboard(smbios::system_table(), board)) {
+    _vendor = std::move(board.vendor);
+    _name = std::move(board.name);
+    _version = std::move(board.version);
+    _serialNumber = std::move(board.serial_number);
+    static_cache::store(*this);
+    return;
+  }
   utils::WMI::_WMI wmi;
   const std::wstring query_string(L"SELECT Manufacturer, Product, Version, SerialNumber FROM Win32_BaseBoard");
   bool success = wmi.execute_query(query_string);
   if (!success) {
     return;
   }
-  ULONG u_return = 0;
   IWbemClassObject* obj = nullptr;
-  wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-  if (!u_return) {
+  if (!wmi.next(&obj)) {
     return;
   }
   VARIANT vt_prop;
@@ -47,6 +61,7 @@ MainBoard::MainBoard() {
   }
   VariantClear(&vt_prop);
   obj->Release();
+  static_cache::store(*this);
 }
 
 }  // namespace hwinfo
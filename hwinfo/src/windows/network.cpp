@@ -4,30 +4,33 @@
 
 #include <hwinfo/network.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
-std::vector<Network> getAllNetworks() {
+std::vector<Network> getAllNetworks(NetworkFields fields) {
+  HWINFO_TRACE_SCOPE(Network);
   utils::WMI::_WMI wmi;
-  const std::wstring query_string(
-      L"SELECT InterfaceIndex, IPAddress, Description, MACAddress "
-      L"FROM Win32_NetworkAdapterConfiguration");
+  // the provider only fills the selected properties
+  std::wstring query_string(L"SELECT InterfaceIndex, Description");
+  if (contains(fields, NetworkFields::Addresses)) {
+    query_string += L", IPAddress";
+  }
+  if (contains(fields, NetworkFields::Mac)) {
+    query_string += L", MACAddress";
+  }
+  query_string += L" FROM Win32_NetworkAdapterConfiguration";
   bool success = wmi.execute_query(query_string);
   if (!success) {
     return {};
   }
   std::vector<Network> networks;
 
-  ULONG u_return = 0;
   IWbemClassObject* obj = nullptr;
   int network_id = 0;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
+  while (wmi.next(&obj)) {
     Network network;
     VARIANT vt_prop;
     HRESULT hr;
@@ -35,7 +38,7 @@ std::vector<Network> getAllNetworks() {
     if (SUCCEEDED(hr)) {
       network._index = std::to_string(vt_prop.uintVal);
     }
-    hr = obj->Get(L"IPAddress", 0, &vt_prop, nullptr, nullptr);
+    hr = contains(fields, NetworkFields::Addresses) ? obj->Get(L"IPAddress", 0, &vt_prop, nullptr, nullptr) : E_FAIL;
     if (SUCCEEDED(hr)) {
       if (vt_prop.vt == (VT_ARRAY | VT_BSTR)) {
         LONG lbound, ubound;
@@ -48,12 +51,14 @@ std::vector<Network> getAllNetworks() {
           std::wstring ws(bstr, SysStringLen(bstr));
           std::string ip = utils::wstring_to_std_string(ws);
           if (ip.find(':') != std::string::npos) {
+            network._ip6s.push_back(ip);
             if (ip.find("fe80::") == 0) {
               ipv6 = ip;
             } else {
               ipv6 = "";
             }
           } else {
+            network._ip4s.push_back(ip);
             ipv4 = ip;
           }
           SysFreeString(bstr);
@@ -68,7 +73,7 @@ std::vector<Network> getAllNetworks() {
         network._description = utils::wstring_to_std_string(vt_prop.bstrVal);
       }
     }
-    hr = obj->Get(L"MACAddress", 0, &vt_prop, nullptr, nullptr);
+    hr = contains(fields, NetworkFields::Mac) ? obj->Get(L"MACAddress", 0, &vt_prop, nullptr, nullptr) : E_FAIL;
     if (SUCCEEDED(hr)) {
       if (vt_prop.vt == VT_BSTR) {
         network._mac = utils::wstring_to_std_string(vt_prop.bstrVal);
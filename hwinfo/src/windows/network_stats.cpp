@@ -0,0 +1,73 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+// clang-format off
+#include <winsock2.h>
+#include <ws2ipdef.h>
+#include <iphlpapi.h>
+#include <netioapi.h>
+// clang-format on
+#include <hwinfo/network_stats.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+struct NetworkStatsSampler::Source {
+  // interface index -> index into the sampled interfaces
+  std::unordered_map<NET_IFINDEX, size_t> index;
+};
+
+// _____________________________________________________________________________________________________________________
+NetworkStatsSampler::NetworkStatsSampler(std::vector<int> interface_indices)
+    : _interface_indices(std::move(interface_indices)),
+      _source(new Source()),
+      _previous(_interface_indices.size()),
+      _current(_interface_indices.size()),
+      _stats(_interface_indices.size()) {
+  for (size_t i = 0; i < _interface_indices.size(); ++i) {
+    if (_interface_indices[i] > 0) {
+      _source->index.emplace(static_cast<NET_IFINDEX>(_interface_indices[i]), i);
+    }
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+NetworkStatsSampler::~NetworkStatsSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool NetworkStatsSampler::read_counters() {
+  // one call for all interfaces, the 64 bit counters do not wrap
+  MIB_IF_TABLE2* table = nullptr;
+  if (GetIfTable2(&table) != NO_ERROR || table == nullptr) {
+    return false;
+  }
+  for (ULONG i = 0; i < table->NumEntries; ++i) {
+    const MIB_IF_ROW2& row = table->Table[i];
+    const auto it = _source->index.find(row.InterfaceIndex);
+    if (it == _source->index.end()) {
+      continue;
+    }
+    Counters& counters = _current[it->second];
+    counters.rx_Bytes = static_cast<int64_t>(row.InOctets);
+    counters.tx_Bytes = static_cast<int64_t>(row.OutOctets);
+    counters.rx_packets = static_cast<int64_t>(row.InUcastPkts + row.InNUcastPkts);
+    counters.tx_packets = static_cast<int64_t>(row.OutUcastPkts + row.OutNUcastPkts);
+    counters.rx_errors = static_cast<int64_t>(row.InErrors);
+    counters.tx_errors = static_cast<int64_t>(row.OutErrors);
+    counters.rx_drops = static_cast<int64_t>(row.InDiscards);
+    counters.tx_drops = static_cast<int64_t>(row.OutDiscards);
+  }
+  FreeMibTable(table);
+  return true;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -12,12 +12,14 @@
 
 #include <hwinfo/os.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
 namespace hwinfo {
 
 // _____________________________________________________________________________________________________________________
 OS::OS() {
+  HWINFO_TRACE_SCOPE(OS);
   {
     // Get endian. This is platform independent...
     char16_t dummy = 0x0102;
@@ -30,10 +32,8 @@ OS::OS() {
   if (!success) {
     return;
   }
-  ULONG u_return = 0;
   IWbemClassObject* obj = nullptr;
-  wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-  if (!u_return) {
+  if (!wmi.next(&obj)) {
     return;
   }
   VARIANT vt_prop;
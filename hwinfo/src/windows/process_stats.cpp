@@ -0,0 +1,148 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <hwinfo/process_stats.h>
+#include <hwinfo/utils/ntdll.h>
+#include <winternl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// SYSTEM_PROCESS_INFORMATION as returned by the kernel; winternl.h hides the times and I/O counters in reserved fields.
+struct ProcessInformation {
+  ULONG NextEntryOffset;
+  ULONG NumberOfThreads;
+  LARGE_INTEGER WorkingSetPrivateSize;
+  ULONG HardFaultCount;
+  ULONG NumberOfThreadsHighWatermark;
+  ULONGLONG CycleTime;
+  LARGE_INTEGER CreateTime;
+  LARGE_INTEGER UserTime;
+  LARGE_INTEGER KernelTime;
+  UNICODE_STRING ImageName;
+  LONG BasePriority;
+  HANDLE UniqueProcessId;
+  HANDLE InheritedFromUniqueProcessId;
+  ULONG HandleCount;
+  ULONG SessionId;
+  ULONG_PTR UniqueProcessKey;
+  SIZE_T PeakVirtualSize;
+  SIZE_T VirtualSize;
+  ULONG PageFaultCount;
+  SIZE_T PeakWorkingSetSize;
+  SIZE_T WorkingSetSize;
+  SIZE_T QuotaPeakPagedPoolUsage;
+  SIZE_T QuotaPagedPoolUsage;
+  SIZE_T QuotaPeakNonPagedPoolUsage;
+  SIZE_T QuotaNonPagedPoolUsage;
+  SIZE_T PagefileUsage;
+  SIZE_T PeakPagefileUsage;
+  SIZE_T PrivatePageCount;
+  LARGE_INTEGER ReadOperationCount;
+  LARGE_INTEGER WriteOperationCount;
+  LARGE_INTEGER OtherOperationCount;
+  LARGE_INTEGER ReadTransferCount;
+  LARGE_INTEGER WriteTransferCount;
+  LARGE_INTEGER OtherTransferCount;
+};
+
+constexpr NTSTATUS STATUS_INFO_LENGTH_MISMATCH_ = static_cast<NTSTATUS>(0xC0000004L);
+
+}  // namespace
+
+struct ProcessSampler::Source {
+  utils::NtQuerySystemInformation_t query_system_information{utils::nt_query_system_information()};
+  // grown to the size of the process list and kept between updates
+  std::vector<uint8_t> buffer;
+  // pid -> index into the sampled processes
+  std::unordered_map<uint64_t, size_t> index;
+  // CreateTime of every process at its first update, a pid that was reused by another process has a different one
+  std::vector<int64_t> create_time;
+};
+
+// _____________________________________________________________________________________________________________________
+ProcessSampler::ProcessSampler(std::vector<int64_t> pids)
+    : _pids(std::move(pids)),
+      _source(new Source()),
+      _previous(_pids.size()),
+      _current(_pids.size()),
+      _cpu_utilisation(_pids.size(), -1.0),
+      _rss_Bytes(_pids.size(), -1),
+      _read_Bytes_per_s(_pids.size(), -1.0),
+      _written_Bytes_per_s(_pids.size(), -1.0) {
+  // KernelTime, UserTime and the processor times of utils::read_jiffies() are in 100 ns units
+  _jiffy_ns = 100.0;
+  _source->create_time.assign(_pids.size(), -1);
+  for (size_t i = 0; i < _pids.size(); ++i) {
+    _source->index.emplace(static_cast<uint64_t>(_pids[i]), i);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+ProcessSampler::~ProcessSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool ProcessSampler::read_counters() {
+  if (_source->query_system_information == nullptr) {
+    return false;
+  }
+  std::vector<uint8_t>& buffer = _source->buffer;
+  if (buffer.empty()) {
+    buffer.resize(256 * 1024);
+  }
+  ULONG size = 0;
+  NTSTATUS status = STATUS_INFO_LENGTH_MISMATCH_;
+  // processes may start between the calls, so the reported size gets some headroom
+  for (int attempt = 0; attempt < 4 && status == STATUS_INFO_LENGTH_MISMATCH_; ++attempt) {
+    status = _source->query_system_information(SystemProcessInformation, buffer.data(),
+                                               static_cast<ULONG>(buffer.size()), &size);
+    if (status == STATUS_INFO_LENGTH_MISMATCH_) {
+      buffer.resize(static_cast<size_t>(size) + 64 * 1024);
+    }
+  }
+  if (status < 0) {
+    return false;
+  }
+  bool success = false;
+  size_t offset = 0;
+  while (offset + sizeof(ProcessInformation) <= buffer.size()) {
+    const auto* process = reinterpret_cast<const ProcessInformation*>(buffer.data() + offset);
+    const auto it = _source->index.find(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(process->UniqueProcessId)));
+    if (it != _source->index.end()) {
+      const size_t i = it->second;
+      int64_t& create_time = _source->create_time[i];
+      if (create_time < 0) {
+        create_time = process->CreateTime.QuadPart;
+      }
+      if (create_time == process->CreateTime.QuadPart) {
+        Counters& counters = _current[i];
+        counters.cpu_time_ns = (process->KernelTime.QuadPart + process->UserTime.QuadPart) * 100;
+        counters.rss_Bytes = static_cast<int64_t>(process->WorkingSetSize);
+        counters.read_Bytes = process->ReadTransferCount.QuadPart;
+        counters.written_Bytes = process->WriteTransferCount.QuadPart;
+        success = true;
+      }
+    }
+    if (process->NextEntryOffset == 0) {
+      break;
+    }
+    offset += process->NextEntryOffset;
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -5,17 +5,52 @@
 
 #ifdef HWINFO_WINDOWS
 #include <Windows.h>
+#include <Psapi.h>
 #include <hwinfo/ram.h>
+#include <hwinfo/utils/parse.h>
+#include <hwinfo/utils/ntdll.h>
+#include <hwinfo/utils/smbios.h>
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 #include <hwinfo/utils/wmi_wrapper.h>
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace hwinfo {
 
+namespace {
+
+// SYSTEM_MEMORY_LIST_INFORMATION as returned by the kernel (not declared in winternl.h), counts are pages.
+constexpr auto SystemMemoryListInformation_ = static_cast<SYSTEM_INFORMATION_CLASS>(80);
+struct MemoryListInformation {
+  ULONG_PTR ZeroPageCount;
+  ULONG_PTR FreePageCount;
+  ULONG_PTR ModifiedPageCount;
+  ULONG_PTR ModifiedNoWritePageCount;
+  ULONG_PTR BadPageCount;
+  ULONG_PTR PageCountByPriority[8];
+  ULONG_PTR RepurposedPagesByPriority[8];
+  ULONG_PTR ModifiedPageCountPageFile;
+};
+
+}  // namespace
+
 // _____________________________________________________________________________________________________________________
 Memory::Memory() {
+  HWINFO_TRACE_SCOPE(Memory);
+  if (static_cache::load(*this)) {
+    return;
+  }
+  // the firmware table needs no WMI round trip, Win32_PhysicalMemory is only the fallback
+  _modules = smbios::memory_devices(smbios::system_table());
+  if (!_modules.empty()) {
+    static_cache::store(*this);
+    return;
+  }
   utils::WMI::_WMI wmi;
   const std::wstring query_string(
       L"SELECT Capacity, ConfiguredClockSpeed, Manufacturer, SerialNumber, PartNumber FROM Win32_PhysicalMemory");
@@ -23,15 +58,10 @@ Memory::Memory() {
   if (!success) {
     return;
   }
-  ULONG u_return = 0;
   IWbemClassObject* obj = nullptr;
   std::vector<Memory> rams;
   int id = 0;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
+  while (wmi.next(&obj)) {
     VARIANT vt_prop;
     HRESULT hr;
     Memory::Module module;
@@ -45,11 +75,11 @@ Memory::Memory() {
       module.model = utils::wstring_to_std_string(vt_prop.bstrVal);
       // TODO: One expects an actual name of the RAM but wmi does not provide such a property...
       //       The "Name"-property of WMI returns "PhysicalMemory".
-      module.name = std::string(module.vendor + " " + module.model);
+      module.name = module.vendor.str() + " " + module.model.str();
     }
     hr = obj->Get(L"Capacity", 0, &vt_prop, nullptr, nullptr);
     if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_BSTR)) {
-      module.total_Bytes = std::stoll(utils::wstring_to_std_string(vt_prop.bstrVal));
+      module.total_Bytes = utils::parse_int_or<int64_t>(utils::wstring_to_std_string(vt_prop.bstrVal), -1);
     }
     hr = obj->Get(L"ConfiguredClockSpeed", 0, &vt_prop, nullptr, nullptr);
     if (SUCCEEDED(hr) && (V_VT(&vt_prop) == VT_I4)) {
@@ -63,21 +93,102 @@ Memory::Memory() {
     obj->Release();
     _modules.push_back(std::move(module));
   }
+  // a partial list (timeout) is not cached
+  if (!_modules.empty() && wmi.status == utils::WMI::Status::Complete) {
+    static_cache::store(*this);
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+bool MemorySnapshot::update() {
+  HWINFO_TRACE_SCOPE(MemorySnapshot);
+  *this = MemorySnapshot();
+  timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  if (!GlobalMemoryStatusEx(&status)) {
+    return false;
+  }
+  total_Bytes = static_cast<int64_t>(status.ullTotalPhys);
+  available_Bytes = static_cast<int64_t>(status.ullAvailPhys);
+  // the page file limits include the physical memory
+  if (status.ullTotalPageFile >= status.ullTotalPhys) {
+    swap_total_Bytes = static_cast<int64_t>(status.ullTotalPageFile - status.ullTotalPhys);
+    swap_free_Bytes = status.ullAvailPageFile >= status.ullAvailPhys
+                          ? std::min(static_cast<int64_t>(status.ullAvailPageFile - status.ullAvailPhys),
+                                     swap_total_Bytes)
+                          : 0;
+  }
+  PERFORMANCE_INFORMATION performance;
+  if (!K32GetPerformanceInfo(&performance, sizeof(performance))) {
+    return true;
+  }
+  cached_Bytes = static_cast<int64_t>(performance.SystemCache) * static_cast<int64_t>(performance.PageSize);
+  // the zeroed and free page lists; the kernel requires SeProfileSingleProcessPrivilege, free_Bytes stays -1 without
+  const auto query_system_information = utils::nt_query_system_information();
+  MemoryListInformation lists;
+  if (query_system_information != nullptr &&
+      query_system_information(SystemMemoryListInformation_, &lists, sizeof(lists), nullptr) >= 0) {
+    free_Bytes = static_cast<int64_t>(lists.ZeroPageCount + lists.FreePageCount) *
+                 static_cast<int64_t>(performance.PageSize);
+  }
+  return true;
 }
 
+struct NumaMemorySampler::Source {
+  std::vector<USHORT> nodes;
+};
+
 // _____________________________________________________________________________________________________________________
-int64_t Memory::free_Bytes() const {
-  auto res = utils::WMI::query<std::string>(L"Win32_OperatingSystem", L"FreePhysicalMemory");
-  if (res.empty()) {
-    return -1;
+NumaMemorySampler::NumaMemorySampler() : _source(std::make_unique<Source>()) {
+  ULONG highest = 0;
+  if (!GetNumaHighestNodeNumber(&highest)) {
+    return;
+  }
+  // node numbers may have gaps, the ones without memory fail GetNumaAvailableMemoryNodeEx
+  for (ULONG node = 0; node <= highest && node <= 0xFFFF; ++node) {
+    ULONGLONG available = 0;
+    if (GetNumaAvailableMemoryNodeEx(static_cast<USHORT>(node), &available)) {
+      _source->nodes.push_back(static_cast<USHORT>(node));
+    }
   }
-  return std::stoll(res.front()) * 1024;
+  _nodes.resize(_source->nodes.size());
 }
 
 // _____________________________________________________________________________________________________________________
-int64_t Memory::available_Bytes() const {
-  // TODO: Get actual available memory size...
-  return free_Bytes();
+NumaMemorySampler::~NumaMemorySampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool NumaMemorySampler::update() {
+  HWINFO_TRACE_SCOPE(MemorySnapshot);
+  _timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+  bool success = false;
+  for (size_t i = 0; i < _nodes.size(); ++i) {
+    NodeMemory& node = _nodes[i];
+    node = NodeMemory();
+    node.node = _source->nodes[i];
+    ULONGLONG available = 0;
+    if (GetNumaAvailableMemoryNodeEx(_source->nodes[i], &available)) {
+      node.free_Bytes = static_cast<int64_t>(available);
+      success = true;
+    }
+  }
+  // the size of a node is not exposed, except that a single node holds all memory
+  if (_nodes.size() == 1) {
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status)) {
+      _nodes[0].total_Bytes = static_cast<int64_t>(status.ullTotalPhys);
+      if (_nodes[0].free_Bytes >= 0) {
+        _nodes[0].used_Bytes = std::max<int64_t>(_nodes[0].total_Bytes - _nodes[0].free_Bytes, 0);
+      }
+    }
+  }
+  return success;
 }
 
 }  // namespace hwinfo
@@ -0,0 +1,77 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <hwinfo/sensors.h>
+#include <hwinfo/utils/wmi_wrapper.h>
+
+#include <limits>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+const std::wstring thermal_zone_class = L"Win32_PerfFormattedData_Counters_ThermalZoneInformation";
+
+// _____________________________________________________________________________________________________________________
+// Name and temperature (K) of every ACPI thermal zone, one query for all.
+std::vector<std::tuple<std::string, std::optional<int64_t>>> query_thermal_zones() {
+  return utils::WMI::query_rows<std::string, std::optional<int64_t>>(thermal_zone_class, {L"Name", L"Temperature"});
+}
+
+}  // namespace
+
+struct SensorSampler::Source {
+  // thermal zone name -> sensor index
+  std::unordered_map<std::string, size_t> index;
+};
+
+// _____________________________________________________________________________________________________________________
+SensorSampler::SensorSampler() : _source(new Source()) {
+  for (auto& [name, temperature] : query_thermal_zones()) {
+    if (name.empty() || _source->index.count(name) != 0) {
+      continue;
+    }
+    _source->index.emplace(name, _sensors.size());
+    Sensor sensor;
+    sensor.kind = SensorKind::Temperature;
+    sensor.chip = "thermal";
+    sensor.label = std::move(name);
+    _sensors.push_back(std::move(sensor));
+  }
+  _values.assign(_sensors.size(), std::numeric_limits<double>::quiet_NaN());
+}
+
+// _____________________________________________________________________________________________________________________
+SensorSampler::~SensorSampler() = default;
+
+// _____________________________________________________________________________________________________________________
+bool SensorSampler::read_values(int64_t /*now_ns*/) {
+  if (_sensors.empty()) {
+    return false;
+  }
+  bool success = false;
+  for (const auto& [name, temperature] : query_thermal_zones()) {
+    const auto it = _source->index.find(name);
+    if (it == _source->index.end() || !temperature) {
+      continue;
+    }
+    // K
+    _values[it->second] = static_cast<double>(*temperature) - 273.15;
+    success = true;
+  }
+  return success;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -0,0 +1,42 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <hwinfo/utils/smbios.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace hwinfo {
+namespace smbios {
+
+// _____________________________________________________________________________________________________________________
+bool read_system_table(std::string& blob) {
+  // 'RSMB' returns a RawSMBIOSData header (calling method, major, minor and DMI revision, DWORD length) followed by the
+  // structure table. No elevation is required.
+  constexpr DWORD provider = ('R' << 24) | ('S' << 16) | ('M' << 8) | 'B';
+  constexpr size_t header_size = 8;
+  const UINT size = GetSystemFirmwareTable(provider, 0, nullptr, 0);
+  if (size <= header_size) {
+    return false;
+  }
+  std::string raw(size, '\0');
+  if (GetSystemFirmwareTable(provider, 0, &raw[0], size) != size) {
+    return false;
+  }
+  uint32_t length = 0;
+  std::memcpy(&length, raw.data() + 4, sizeof(length));
+  blob = raw.substr(header_size, std::min<size_t>(length, size - header_size));
+  return !blob.empty();
+}
+
+}  // namespace smbios
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -0,0 +1,133 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <hwinfo/topology.h>
+#include <hwinfo/utils/trace.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace hwinfo {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// The OS cpu id is the index in (group, number) order, which is also the order of the PDH "Processor Information"
+// instances and of NtQuerySystemInformation.
+std::vector<size_t> group_offsets() {
+  std::vector<size_t> offsets;
+  size_t offset = 0;
+  const WORD num_groups = GetActiveProcessorGroupCount();
+  for (WORD group = 0; group < num_groups; ++group) {
+    offsets.push_back(offset);
+    offset += GetActiveProcessorCount(group);
+  }
+  offsets.push_back(offset);
+  return offsets;
+}
+
+// _____________________________________________________________________________________________________________________
+template <typename Callback>
+void for_each_cpu(const GROUP_AFFINITY& affinity, const std::vector<size_t>& offsets, Callback callback) {
+  if (affinity.Group + 1u >= offsets.size()) {
+    return;
+  }
+  for (unsigned bit = 0; bit < sizeof(KAFFINITY) * 8; ++bit) {
+    if ((affinity.Mask >> bit) & 1) {
+      callback(offsets[affinity.Group] + bit);
+    }
+  }
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+Topology Topology::read() {
+  HWINFO_TRACE_SCOPE(Topology);
+  Topology topology;
+  DWORD size = 0;
+  GetLogicalProcessorInformationEx(RelationAll, nullptr, &size);
+  if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+    return topology;
+  }
+  std::vector<char> buffer(size);
+  if (!GetLogicalProcessorInformationEx(RelationAll,
+                                        reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()),
+                                        &size)) {
+    return topology;
+  }
+  const std::vector<size_t> offsets = group_offsets();
+  topology.resize(offsets.back());
+
+  // the last level cache is the highest level that is reported
+  BYTE max_level = 0;
+  for (DWORD pos = 0; pos < size;) {
+    const auto* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + pos);
+    pos += info->Size;
+    if (info->Relationship == RelationCache && info->Cache.Type != CacheInstruction) {
+      max_level = std::max(max_level, info->Cache.Level);
+    }
+  }
+
+  int32_t num_sockets = 0;
+  for (DWORD pos = 0; pos < size;) {
+    const auto* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + pos);
+    pos += info->Size;
+    const auto in_range = [&](size_t cpu) { return cpu < topology.size(); };
+    switch (info->Relationship) {
+      case RelationProcessorPackage: {
+        const int32_t socket = num_sockets++;
+        for (WORD i = 0; i < info->Processor.GroupCount; ++i) {
+          for_each_cpu(info->Processor.GroupMask[i], offsets, [&](size_t cpu) {
+            if (in_range(cpu)) topology._socket[cpu] = socket;
+          });
+        }
+        break;
+      }
+      case RelationProcessorCore: {
+        const int32_t core = topology._num_cores++;
+        for (WORD i = 0; i < info->Processor.GroupCount; ++i) {
+          for_each_cpu(info->Processor.GroupMask[i], offsets, [&](size_t cpu) {
+            if (!in_range(cpu)) return;
+            topology._core[cpu] = core;
+            topology._efficiency_class[cpu] = info->Processor.EfficiencyClass;
+          });
+        }
+        break;
+      }
+      case RelationNumaNode: {
+        const auto node = static_cast<int32_t>(info->NumaNode.NodeNumber);
+        topology._num_nodes = std::max(topology._num_nodes, node + 1);
+        for_each_cpu(info->NumaNode.GroupMask, offsets, [&](size_t cpu) {
+          if (in_range(cpu)) topology._node[cpu] = node;
+        });
+        break;
+      }
+      case RelationCache:
+        if (info->Cache.Type != CacheInstruction && info->Cache.Level == max_level) {
+          const int32_t domain = topology._num_cache_domains++;
+          for_each_cpu(info->Cache.GroupMask, offsets, [&](size_t cpu) {
+            if (in_range(cpu)) topology._cache_domain[cpu] = domain;
+          });
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  // one Win32_Processor row per socket: CPU::id() is the socket index
+  for (int32_t socket = 0; socket < num_sockets; ++socket) {
+    topology._package_ids.push_back(socket);
+  }
+  return topology;
+}
+
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -0,0 +1,23 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <hwinfo/utils/ntdll.h>
+
+namespace hwinfo {
+namespace utils {
+
+// _____________________________________________________________________________________________________________________
+NtQuerySystemInformation_t nt_query_system_information() {
+  static const auto function = reinterpret_cast<NtQuerySystemInformation_t>(
+      GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "NtQuerySystemInformation"));
+  return function;
+}
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -0,0 +1,151 @@
+// Copyright Leon Freist
+// Author Leon Freist <freist@informatik.uni-freiburg.de>
+
+#include <hwinfo/platform.h>
+
+#ifdef HWINFO_WINDOWS
+
+#include <Windows.h>
+#include <hwinfo/utils/pdh.h>
+#include <pdh.h>
+#include <pdhmsg.h>
+
+#include <algorithm>
+#include <cwchar>
+#pragma comment(lib, "pdh.lib")
+
+namespace hwinfo {
+namespace utils {
+
+namespace {
+
+// _____________________________________________________________________________________________________________________
+// Parses "<group>,<number>" instance names. "_Total" and "<group>,_Total" are reported as not a processor.
+bool parse_instance(const wchar_t* name, uint64_t& key) {
+  wchar_t* end = nullptr;
+  unsigned long group = std::wcstoul(name, &end, 10);
+  if (end == name || *end != L',') {
+    return false;
+  }
+  const wchar_t* number_start = end + 1;
+  unsigned long number = std::wcstoul(number_start, &end, 10);
+  if (end == number_start || *end != L'\0') {
+    return false;
+  }
+  key = (static_cast<uint64_t>(group) << 32) | number;
+  return true;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+ProcessorCounters& ProcessorCounters::get() {
+  static ProcessorCounters counters;
+  return counters;
+}
+
+// _____________________________________________________________________________________________________________________
+ProcessorCounters::ProcessorCounters() {
+  PDH_HQUERY query = nullptr;
+  if (PdhOpenQueryW(nullptr, 0, &query) != ERROR_SUCCESS) {
+    return;
+  }
+  _query = query;
+  // English names, so that the counters are found on localized systems as well
+  PDH_HCOUNTER counter = nullptr;
+  if (PdhAddEnglishCounterW(query, L"\\Processor Information(*)\\% Processor Utility", 0, &counter) == ERROR_SUCCESS) {
+    _utility = counter;
+  }
+  counter = nullptr;
+  if (PdhAddEnglishCounterW(query, L"\\Processor Information(*)\\% Processor Performance", 0, &counter) ==
+      ERROR_SUCCESS) {
+    _performance = counter;
+  }
+  // rate counters need a first collection as baseline
+  PdhCollectQueryData(query);
+  _last_collect = std::chrono::steady_clock::now();
+}
+
+// _____________________________________________________________________________________________________________________
+ProcessorCounters::~ProcessorCounters() {
+  if (_query) {
+    PdhCloseQuery(static_cast<PDH_HQUERY>(_query));
+  }
+}
+
+// _____________________________________________________________________________________________________________________
+bool ProcessorCounters::read_counter(void* counter, std::vector<double>& values, double* total) {
+  values.clear();
+  if (counter == nullptr) {
+    return false;
+  }
+  DWORD size = static_cast<DWORD>(_buffer.size());
+  DWORD count = 0;
+  auto* items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(_buffer.data());
+  PDH_STATUS status =
+      PdhGetFormattedCounterArrayW(static_cast<PDH_HCOUNTER>(counter), PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, &size,
+                                   &count, _buffer.empty() ? nullptr : items);
+  if (status == PDH_MORE_DATA) {
+    _buffer.resize(size);
+    items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(_buffer.data());
+    status = PdhGetFormattedCounterArrayW(static_cast<PDH_HCOUNTER>(counter), PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, &size,
+                                          &count, items);
+  }
+  if (status != ERROR_SUCCESS) {
+    return false;
+  }
+  _ordered.clear();
+  for (DWORD i = 0; i < count; ++i) {
+    const bool valid = items[i].FmtValue.CStatus == PDH_CSTATUS_VALID_DATA ||
+                       items[i].FmtValue.CStatus == PDH_CSTATUS_NEW_DATA;
+    const double value = valid ? items[i].FmtValue.doubleValue : -1.0;
+    uint64_t key = 0;
+    if (parse_instance(items[i].szName, key)) {
+      _ordered.emplace_back(key, value);
+    } else if (total != nullptr && std::wcscmp(items[i].szName, L"_Total") == 0) {
+      *total = value;
+    }
+  }
+  std::sort(_ordered.begin(), _ordered.end());
+  values.reserve(_ordered.size());
+  for (const auto& entry : _ordered) {
+    values.push_back(entry.second);
+  }
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+bool ProcessorCounters::collect() {
+  if (PdhCollectQueryData(static_cast<PDH_HQUERY>(_query)) != ERROR_SUCCESS) {
+    return false;
+  }
+  _last_collect = std::chrono::steady_clock::now();
+  _last.utility_total = -1.0;
+  read_counter(_utility, _last.utility, &_last.utility_total);
+  read_counter(_performance, _last.performance, nullptr);
+  return true;
+}
+
+// _____________________________________________________________________________________________________________________
+bool ProcessorCounters::sample(ProcessorCounterSample& out) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_query == nullptr) {
+    return false;
+  }
+  // within min_interval of the baseline recorded by the constructor, _last is still empty and the values are -1: a
+  // collection right after the baseline would cover a near empty period
+  if (std::chrono::steady_clock::now() - _last_collect >= min_interval) {
+    if (!collect()) {
+      return false;
+    }
+  }
+  out.utility_total = _last.utility_total;
+  out.utility.assign(_last.utility.begin(), _last.utility.end());
+  out.performance.assign(_last.performance.begin(), _last.performance.end());
+  return true;
+}
+
+}  // namespace utils
+}  // namespace hwinfo
+
+#endif  // HWINFO_WINDOWS
@@ -3,274 +3,282 @@
 #ifdef HWINFO_WINDOWS
 
 #include <hwinfo/utils/stringutils.h>
+#include <hwinfo/utils/trace.h>
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace hwinfo {
 namespace utils {
 namespace WMI {
 
-_WMI::_WMI() {
-  auto res = CoInitializeSecurity(nullptr, -1, nullptr, nullptr, RPC_C_AUTHN_LEVEL_DEFAULT, RPC_C_IMP_LEVEL_IMPERSONATE,
-                                  nullptr, EOAC_NONE, nullptr);
-  res &= CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
-  res &= CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER, IID_IWbemLocator, (LPVOID*)&locator);
-  if (locator) {
-    res &= locator->ConnectServer(_bstr_t("ROOT\\CIMV2"), nullptr, nullptr, nullptr, 0, nullptr, nullptr, &service);
-    if (service)
-      res &= CoSetProxyBlanket(service, RPC_C_AUTHN_WINNT, RPC_C_AUTHZ_NONE, nullptr, RPC_C_AUTHN_LEVEL_CALL,
-                               RPC_C_IMP_LEVEL_IMPERSONATE, nullptr, EOAC_NONE);
-  }
-  if (!SUCCEEDED(res)) {
-    throw std::runtime_error("error initializing WMI");
-  }
+namespace {
+
+thread_local std::unique_ptr<Session> thread_session;
+thread_local std::optional<Options> thread_options;
+thread_local Status thread_status = Status::Complete;
+
+std::mutex default_options_mutex;
+Options default_options_value;
+
+// _____________________________________________________________________________________________________________________
+Options current_options() { return thread_options ? *thread_options : default_options(); }
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+Options default_options() {
+  std::lock_guard<std::mutex> lock(default_options_mutex);
+  return default_options_value;
 }
 
-_WMI::~_WMI() {
-  if (locator) locator->Release();
-  if (service) service->Release();
-  CoUninitialize();
+// _____________________________________________________________________________________________________________________
+void set_default_options(const Options& options) {
+  std::lock_guard<std::mutex> lock(default_options_mutex);
+  default_options_value = options;
 }
 
-bool _WMI::execute_query(const std::wstring& query) {
-  if (service == nullptr) return false;
-  return SUCCEEDED(service->ExecQuery(bstr_t(L"WQL"), bstr_t(std::wstring(query.begin(), query.end()).c_str()),
-                                      WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, nullptr, &enumerator));
+// _____________________________________________________________________________________________________________________
+ScopedOptions::ScopedOptions(Options options) : _previous(std::move(thread_options)) {
+  thread_options = std::move(options);
 }
 
-template <>
-std::vector<long> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter) {
-  std::vector<long> result;
-  _WMI wmi;
-  std::wstring filter_string;
-  if (!filter.empty()) {
-    filter_string.append(L" WHERE " + filter);
-  }
-  std::wstring query_string(L"SELECT " + field + L" FROM " + wmi_class + filter_string);
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
-  }
+// _____________________________________________________________________________________________________________________
+ScopedOptions::~ScopedOptions() { thread_options = std::move(_previous); }
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
-    VARIANT vt_prop;
-    HRESULT hr = obj->Get(field.c_str(), 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr)) {
-      result.push_back(vt_prop.intVal);
-    }
-    VariantClear(&vt_prop);
-    obj->Release();
-  }
-  return result;
-}
+// _____________________________________________________________________________________________________________________
+Status last_status() { return thread_status; }
 
-template <>
-std::vector<int> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter) {
-  std::vector<int> result;
-  for (const auto& v : query<long>(wmi_class, field, filter)) {
-    result.push_back(static_cast<int>(v));
+// _____________________________________________________________________________________________________________________
+Session& Session::get() {
+  // a failed connection is retried by the next query
+  if (!thread_session || thread_session->_service == nullptr) {
+    thread_session.reset(new Session());
   }
-  return result;
+  return *thread_session;
 }
 
-template <>
-std::vector<bool> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter) {
-  std::vector<bool> result;
-  _WMI wmi;
-  std::wstring filter_string;
-  if (!filter.empty()) {
-    filter_string.append(L" WHERE " + filter);
+// _____________________________________________________________________________________________________________________
+void Session::shutdown() { thread_session.reset(); }
+
+// _____________________________________________________________________________________________________________________
+Session::Session() {
+  HWINFO_TRACE_SCOPE(WMIConnect);
+  // RPC_E_CHANGED_MODE: the application initialized COM with another concurrency model on this thread, which is fine
+  // for our calls. Only balance what we initialized ourselves.
+  _com_initialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED));
+  // CoInitializeSecurity can only be called once per process. Later calls (or calls after the application has set up
+  // security itself) fail with RPC_E_TOO_LATE, which is not an error for us.
+  static std::once_flag security_initialized;
+  std::call_once(security_initialized, [] {
+    CoInitializeSecurity(nullptr, -1, nullptr, nullptr, RPC_C_AUTHN_LEVEL_DEFAULT, RPC_C_IMP_LEVEL_IMPERSONATE, nullptr,
+                         EOAC_NONE, nullptr);
+  });
+  HRESULT res =
+      CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER, IID_IWbemLocator, (LPVOID*)&_locator);
+  if (FAILED(res) || _locator == nullptr) {
+    return;
   }
-  std::wstring query_string(L"SELECT " + field + L" FROM " + wmi_class + filter_string);
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
+  res = _locator->ConnectServer(_bstr_t("ROOT\\CIMV2"), nullptr, nullptr, nullptr, 0, nullptr, nullptr, &_service);
+  if (FAILED(res) || _service == nullptr) {
+    _service = nullptr;
+    return;
   }
+  CoSetProxyBlanket(_service, RPC_C_AUTHN_WINNT, RPC_C_AUTHZ_NONE, nullptr, RPC_C_AUTHN_LEVEL_CALL,
+                    RPC_C_IMP_LEVEL_IMPERSONATE, nullptr, EOAC_NONE);
+}
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
-    VARIANT vt_prop;
-    HRESULT hr = obj->Get(field.c_str(), 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr)) {
-      result.push_back(vt_prop.boolVal);
-    }
-    VariantClear(&vt_prop);
-    obj->Release();
-  }
-  return result;
+// _____________________________________________________________________________________________________________________
+Session::~Session() {
+  if (_service) _service->Release();
+  if (_locator) _locator->Release();
+  if (_com_initialized) CoUninitialize();
 }
 
-template <>
-std::vector<unsigned> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter) {
-  std::vector<unsigned> result;
-  _WMI wmi;
-  std::wstring filter_string;
-  if (!filter.empty()) {
-    filter_string.append(L" WHERE " + filter);
-  }
-  std::wstring query_string(L"SELECT " + field + L" FROM " + wmi_class + filter_string);
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
+// _____________________________________________________________________________________________________________________
+_WMI::_WMI() : _options(current_options()) {
+  service = Session::get().service();
+  if (service == nullptr) {
+    thread_status = Status::Failed;
+    throw std::runtime_error("error initializing WMI");
   }
+}
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
-    VARIANT vt_prop;
-    HRESULT hr = obj->Get(field.c_str(), 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr)) {
-      result.push_back(vt_prop.uintVal);
-    }
-    VariantClear(&vt_prop);
-    obj->Release();
-  }
-  return result;
+// _____________________________________________________________________________________________________________________
+_WMI::~_WMI() {
+  if (enumerator) enumerator->Release();
 }
 
-template <>
-std::vector<unsigned short> query(const std::wstring& wmi_class, const std::wstring& field,
-                                  const std::wstring& filter) {
-  std::vector<unsigned short> result;
-  _WMI wmi;
-  std::wstring filter_string;
-  if (!filter.empty()) {
-    filter_string.append(L" WHERE " + filter);
+// _____________________________________________________________________________________________________________________
+bool _WMI::execute_query(const std::wstring& query) {
+  if (enumerator) {
+    enumerator->Release();
+    enumerator = nullptr;
   }
-  std::wstring query_string(L"SELECT " + field + L" FROM " + wmi_class + filter_string);
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
+  if (service == nullptr || (_options.cancel && _options.cancel->cancelled())) {
+    finish(service == nullptr ? Status::Failed : Status::Cancelled);
+    return false;
   }
+  HWINFO_TRACE_WMI_QUERY();
+  _deadline = std::chrono::steady_clock::now() + _options.timeout;
+  // WBEM_FLAG_RETURN_IMMEDIATELY: semi-synchronous, the results are waited for in next_batch()
+  if (FAILED(service->ExecQuery(bstr_t(L"WQL"), bstr_t(query.c_str()),
+                                WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, nullptr, &enumerator))) {
+    enumerator = nullptr;
+    finish(Status::Failed);
+    return false;
+  }
+  status = thread_status = Status::Complete;
+  return true;
+}
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
+// _____________________________________________________________________________________________________________________
+bool _WMI::next_batch(IWbemClassObject** objs, ULONG count, ULONG& n) {
+  n = 0;
+  while (enumerator) {
+    if (_options.cancel && _options.cancel->cancelled()) {
+      finish(Status::Cancelled);
+      break;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= _deadline) {
+      finish(Status::TimedOut);
       break;
     }
-    VARIANT vt_prop;
-    HRESULT hr = obj->Get(field.c_str(), 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr)) {
-      result.push_back(vt_prop.uiVal);
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(_deadline - now);
+    const auto wait = std::max<std::chrono::milliseconds::rep>(std::min(left, _options.poll_interval).count(), 1);
+    const HRESULT hr = enumerator->Next(static_cast<long>(wait), count, objs, &n);
+    if (hr == WBEM_S_TIMEDOUT) {
+      // the provider is still working, hand out what arrived and check the limits again
+      if (n > 0) {
+        return true;
+      }
+      continue;
     }
-    VariantClear(&vt_prop);
-    obj->Release();
+    if (FAILED(hr)) {
+      n = 0;
+      finish(Status::Failed);
+      break;
+    }
+    // WBEM_S_FALSE: fewer than count objects were left
+    if (hr != WBEM_S_NO_ERROR || n == 0) {
+      finish(Status::Complete);
+    }
+    return n > 0;
   }
-  return result;
+  return false;
 }
 
-template <>
-std::vector<long long> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter) {
-  std::vector<long long> result;
-  _WMI wmi;
-  std::wstring filter_string;
-  if (!filter.empty()) {
-    filter_string.append(L" WHERE " + filter);
-  }
-  std::wstring query_string(L"SELECT " + field + L" FROM " + wmi_class + filter_string);
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
-  }
+// _____________________________________________________________________________________________________________________
+bool _WMI::next(IWbemClassObject** obj) {
+  ULONG n = 0;
+  return next_batch(obj, 1, n);
+}
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
-    VARIANT vt_prop;
-    HRESULT hr = obj->Get(field.c_str(), 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr)) {
-      result.push_back(vt_prop.llVal);
-    }
-    VariantClear(&vt_prop);
-    obj->Release();
+// _____________________________________________________________________________________________________________________
+void _WMI::finish(Status result) {
+  status = thread_status = result;
+  if (enumerator) {
+    enumerator->Release();
+    enumerator = nullptr;
   }
-  return result;
 }
 
-template <>
-std::vector<unsigned long long> query(const std::wstring& wmi_class, const std::wstring& field,
-                                      const std::wstring& filter) {
-  std::vector<unsigned long long> result;
-  _WMI wmi;
-  std::wstring filter_string;
-  if (!filter.empty()) {
-    filter_string.append(L" WHERE " + filter);
+namespace {
+
+// _____________________________________________________________________________________________________________________
+bool is_empty(const VARIANT& v) { return V_VT(&v) == VT_EMPTY || V_VT(&v) == VT_NULL; }
+
+// _____________________________________________________________________________________________________________________
+template <typename T, typename Get>
+bool convert(const VARIANT& v, VARTYPE type, T& out, Get get) {
+  if (is_empty(v)) {
+    return false;
   }
-  std::wstring query_string(L"SELECT " + field + L" FROM " + wmi_class + filter_string);
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
+  if (V_VT(&v) == type) {
+    out = static_cast<T>(get(v));
+    return true;
   }
-
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
-    VARIANT vt_prop;
-    HRESULT hr = obj->Get(field.c_str(), 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr)) {
-      result.push_back(vt_prop.ullVal);
-    }
-    VariantClear(&vt_prop);
-    obj->Release();
+  VARIANT converted;
+  VariantInit(&converted);
+  bool success = SUCCEEDED(VariantChangeType(&converted, const_cast<VARIANT*>(&v), 0, type));
+  if (success) {
+    out = static_cast<T>(get(converted));
   }
-  return result;
+  VariantClear(&converted);
+  return success;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, bool& out) {
+  return convert(v, VT_BOOL, out, [](const VARIANT& c) { return V_BOOL(&c) != VARIANT_FALSE; });
 }
 
-template <>
-std::vector<std::string> query(const std::wstring& wmi_class, const std::wstring& field, const std::wstring& filter) {
-  _WMI wmi;
-  std::wstring filter_string;
-  if (!filter.empty()) {
-    filter_string.append(L" WHERE " + filter);
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, int& out) {
+  return convert(v, VT_I4, out, [](const VARIANT& c) { return V_I4(&c); });
+}
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, unsigned& out) {
+  return convert(v, VT_UI4, out, [](const VARIANT& c) { return V_UI4(&c); });
+}
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, long& out) {
+  return convert(v, VT_I4, out, [](const VARIANT& c) { return V_I4(&c); });
+}
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, unsigned long& out) {
+  return convert(v, VT_UI4, out, [](const VARIANT& c) { return V_UI4(&c); });
+}
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, long long& out) {
+  return convert(v, VT_I8, out, [](const VARIANT& c) { return V_I8(&c); });
+}
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, unsigned long long& out) {
+  return convert(v, VT_UI8, out, [](const VARIANT& c) { return V_UI8(&c); });
+}
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, double& out) {
+  return convert(v, VT_R8, out, [](const VARIANT& c) { return V_R8(&c); });
+}
+
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, std::string& out) {
+  if (V_VT(&v) != VT_BSTR || V_BSTR(&v) == nullptr) {
+    return false;
   }
-  std::wstring query_string(L"SELECT " + field + L" FROM " + wmi_class + filter_string);
-  bool success = wmi.execute_query(query_string);
-  if (!success) {
-    return {};
+  const BSTR bstr = V_BSTR(&v);
+  const int length = static_cast<int>(SysStringLen(bstr));
+  const int size = WideCharToMultiByte(CP_UTF8, 0, bstr, length, nullptr, 0, nullptr, nullptr);
+  out.resize(static_cast<size_t>(size));
+  if (size > 0) {
+    WideCharToMultiByte(CP_UTF8, 0, bstr, length, &out[0], size, nullptr, nullptr);
   }
-  std::vector<std::string> result;
+  return true;
+}
 
-  ULONG u_return = 0;
-  IWbemClassObject* obj = nullptr;
-  while (wmi.enumerator) {
-    wmi.enumerator->Next(WBEM_INFINITE, 1, &obj, &u_return);
-    if (!u_return) {
-      break;
-    }
-    VARIANT vt_prop;
-    HRESULT hr = obj->Get(field.c_str(), 0, &vt_prop, nullptr, nullptr);
-    if (SUCCEEDED(hr)) {
-      result.push_back(wstring_to_std_string(vt_prop.bstrVal));
-    }
-    VariantClear(&vt_prop);
-    obj->Release();
+// _____________________________________________________________________________________________________________________
+bool from_variant(const VARIANT& v, std::wstring& out) {
+  if (V_VT(&v) != VT_BSTR || V_BSTR(&v) == nullptr) {
+    return false;
   }
-  return result;
+  out.assign(V_BSTR(&v), SysStringLen(V_BSTR(&v)));
+  return true;
 }
 
 }  // namespace WMI
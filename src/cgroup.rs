@@ -0,0 +1,68 @@
+//! Cpu and memory limits of the cgroup of the calling process (Linux containers).
+//!
+//! [`Cgroup::read`] copies the current limits and usage of the process wide resolver, which reads
+//! `/proc/self/cgroup` once and keeps the control files (cgroup v2, or the v1 controllers) open.
+//! [`set_apply_limits`] makes the cpu and memory functions of the crate report container rather
+//! than host values.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result};
+
+/// Limits and usage of the cgroup at the time of [`Cgroup::read`].
+#[derive(Debug, Clone, PartialEq)]
+pub struct Cgroup {
+    /// 2 for the unified hierarchy, 1 if any controller is bound to a v1 hierarchy.
+    pub version: u32,
+    /// Cpu bandwidth limit in cpus (`cpu.max`), `None` if unlimited.
+    pub cpu_quota: Option<f64>,
+    /// OS cpu ids of `cpuset.cpus.effective` in ascending order, empty if unknown.
+    pub effective_cpus: Vec<u32>,
+    /// Number of cpus the cgroup can keep busy: the smaller of the cpuset size and the quota.
+    pub effective_cpu_count: Option<f64>,
+    /// `memory.max`, `None` if unlimited.
+    pub memory_max_bytes: Option<u64>,
+    /// `memory.current`.
+    pub memory_current_bytes: Option<u64>,
+    /// Cumulative cpu time of all tasks of the cgroup (`usage_usec` of `cpu.stat`).
+    pub cpu_usage_ns: Option<u64>,
+}
+
+impl Cgroup {
+    /// Fails if the process is in no cgroup (or not on Linux).
+    pub fn read() -> Result<Cgroup> {
+        let ptr = unsafe { bindings::get_cgroup() };
+        if ptr.is_null() {
+            return Err(HwinfoError::DataUnavailable("get_cgroup".into()));
+        }
+        let cgroup = unsafe {
+            let raw = &*ptr;
+            let cpus = if raw.cpus.is_null() || raw.num_cpus <= 0 {
+                &[][..]
+            } else {
+                std::slice::from_raw_parts(raw.cpus, raw.num_cpus as usize)
+            };
+            Cgroup {
+                version: raw.version.max(0) as u32,
+                cpu_quota: (raw.cpu_quota > 0.0).then_some(raw.cpu_quota),
+                effective_cpus: cpus
+                    .iter()
+                    .filter_map(|&cpu| u32::try_from(cpu).ok())
+                    .collect(),
+                effective_cpu_count: (raw.effective_cpu_count > 0.0)
+                    .then_some(raw.effective_cpu_count),
+                memory_max_bytes: u64::try_from(raw.memory_max_Bytes).ok(),
+                memory_current_bytes: u64::try_from(raw.memory_current_Bytes).ok(),
+                cpu_usage_ns: u64::try_from(raw.cpu_usage_ns).ok(),
+            }
+        };
+        unsafe { bindings::free_cgroup(ptr) };
+        Ok(cgroup)
+    }
+}
+
+/// Process wide opt-in (off by default): cpu counts and per-thread utilisation are limited to the
+/// cpuset and quota of the cgroup, memory totals to `memory.max` and free/available memory to
+/// `memory.max - memory.current`.
+pub fn set_apply_limits(enabled: bool) {
+    unsafe { bindings::hwinfo_set_cgroup_limits(i32::from(enabled)) };
+}
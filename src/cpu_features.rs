@@ -0,0 +1,232 @@
+//! Cpu feature bitmask.
+//!
+//! [`CpuFeatures`] mirrors `C_CPU::features`: feature `f` is bit `f % 64` of word `f / 64`, so a
+//! lookup is a shift and a mask instead of a scan over flag strings.
+
+use crate::bindings;
+use std::ffi::CStr;
+use std::fmt;
+
+/// Canonical cpu features, in the order of `hwinfo::Feature` (values are bit positions).
+#[repr(u16)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub enum CpuFeature {
+    // x86: leaf 1
+    Mmx = 0,
+    Sse = 1,
+    Sse2 = 2,
+    Sse3 = 3,
+    Ssse3 = 4,
+    Sse41 = 5,
+    Sse42 = 6,
+    Popcnt = 7,
+    Aes = 8,
+    Pclmulqdq = 9,
+    Cx16 = 10,
+    Movbe = 11,
+    Xsave = 12,
+    Osxsave = 13,
+    Avx = 14,
+    F16c = 15,
+    Fma = 16,
+    Rdrand = 17,
+    Ht = 18,
+    // x86: leaf 7
+    Bmi1 = 19,
+    Bmi2 = 20,
+    Avx2 = 21,
+    Erms = 22,
+    Fsrm = 23,
+    Adx = 24,
+    Rdseed = 25,
+    Sha = 26,
+    Clflushopt = 27,
+    Clwb = 28,
+    Gfni = 29,
+    Vaes = 30,
+    Vpclmulqdq = 31,
+    Avx512f = 32,
+    Avx512dq = 33,
+    Avx512cd = 34,
+    Avx512bw = 35,
+    Avx512vl = 36,
+    Avx512ifma = 37,
+    Avx512vbmi = 38,
+    Avx512Vbmi2 = 39,
+    Avx512Vnni = 40,
+    Avx512Bitalg = 41,
+    Avx512Vpopcntdq = 42,
+    Avx512Bf16 = 43,
+    Avx512Fp16 = 44,
+    Avx512Vp2intersect = 45,
+    AvxVnni = 46,
+    AmxTile = 47,
+    AmxInt8 = 48,
+    AmxBf16 = 49,
+    Hybrid = 50,
+    Serialize = 51,
+    Waitpkg = 52,
+    Rdpid = 53,
+    Rtm = 54,
+    // x86: extended leaves
+    LahfLm = 55,
+    Abm = 56,
+    Sse4a = 57,
+    Prefetchw = 58,
+    Fma4 = 59,
+    Xop = 60,
+    Tbm = 61,
+    Topoext = 62,
+    Rdtscp = 63,
+    Lm = 64,
+    Pdpe1gb = 65,
+    Nx = 66,
+    // ARM (hwcaps)
+    Fp = 67,
+    Asimd = 68,
+    Asimdhp = 69,
+    Asimddp = 70,
+    Asimdfhm = 71,
+    ArmAes = 72,
+    Pmull = 73,
+    Sha1 = 74,
+    Sha2 = 75,
+    Sha3 = 76,
+    Sha512 = 77,
+    Sm4 = 78,
+    Crc32 = 79,
+    Atomics = 80,
+    Sve = 81,
+    Sve2 = 82,
+    ArmBf16 = 83,
+    I8mm = 84,
+}
+
+const WORDS: usize = 4;
+
+const _: () =
+    assert!(CpuFeature::COUNT == bindings::C_CpuFeatureLimits_C_CPU_FEATURE_COUNT as usize);
+const _: () = assert!(WORDS == bindings::C_CpuFeatureLimits_C_CPU_FEATURE_WORDS as usize);
+
+impl CpuFeature {
+    pub const COUNT: usize = 85;
+
+    /// Feature of bit `index`, `None` if it is out of range.
+    pub fn from_index(index: usize) -> Option<CpuFeature> {
+        if index < Self::COUNT {
+            // the enum is dense and repr(u16)
+            Some(unsafe { std::mem::transmute::<u16, CpuFeature>(index as u16) })
+        } else {
+            None
+        }
+    }
+
+    /// Canonical (/proc/cpuinfo) name, e.g. `"avx512f"`.
+    pub fn name(self) -> &'static str {
+        let name = unsafe { bindings::get_cpu_feature_name(self as i32) };
+        if name.is_null() {
+            return "";
+        }
+        // static storage in the C library
+        unsafe { CStr::from_ptr(name) }.to_str().unwrap_or("")
+    }
+}
+
+/// Fixed size set of [`CpuFeature`]s.
+#[derive(Clone, Copy, PartialEq, Eq, Hash, Default)]
+pub struct CpuFeatures([u64; WORDS]);
+
+impl CpuFeatures {
+    pub const fn empty() -> CpuFeatures {
+        CpuFeatures([0; WORDS])
+    }
+
+    pub const fn from_bits(words: [u64; WORDS]) -> CpuFeatures {
+        CpuFeatures(words)
+    }
+
+    pub const fn bits(&self) -> [u64; WORDS] {
+        self.0
+    }
+
+    pub const fn contains(&self, feature: CpuFeature) -> bool {
+        let bit = feature as usize;
+        (self.0[bit / 64] >> (bit % 64)) & 1 != 0
+    }
+
+    /// True if every feature of `required` is set.
+    pub fn contains_all(&self, required: &CpuFeatures) -> bool {
+        self.0
+            .iter()
+            .zip(required.0.iter())
+            .all(|(have, need)| have & need == *need)
+    }
+
+    pub fn insert(&mut self, feature: CpuFeature) {
+        let bit = feature as usize;
+        self.0[bit / 64] |= 1 << (bit % 64);
+    }
+
+    pub fn remove(&mut self, feature: CpuFeature) {
+        let bit = feature as usize;
+        self.0[bit / 64] &= !(1 << (bit % 64));
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.0.iter().all(|&word| word == 0)
+    }
+
+    pub fn len(&self) -> usize {
+        self.0.iter().map(|word| word.count_ones() as usize).sum()
+    }
+
+    /// Set features in ascending order.
+    pub fn iter(&self) -> impl Iterator<Item = CpuFeature> + '_ {
+        (0..CpuFeature::COUNT)
+            .filter_map(CpuFeature::from_index)
+            .filter(|&feature| self.contains(feature))
+    }
+
+    /// Canonical names of the set features, materialized on demand.
+    pub fn names(&self) -> impl Iterator<Item = &'static str> + '_ {
+        self.iter().map(CpuFeature::name)
+    }
+}
+
+impl FromIterator<CpuFeature> for CpuFeatures {
+    fn from_iter<I: IntoIterator<Item = CpuFeature>>(iter: I) -> CpuFeatures {
+        let mut features = CpuFeatures::empty();
+        for feature in iter {
+            features.insert(feature);
+        }
+        features
+    }
+}
+
+impl std::ops::BitOr for CpuFeatures {
+    type Output = CpuFeatures;
+    fn bitor(self, rhs: CpuFeatures) -> CpuFeatures {
+        let mut words = self.0;
+        for (word, other) in words.iter_mut().zip(rhs.0) {
+            *word |= other;
+        }
+        CpuFeatures(words)
+    }
+}
+
+impl std::ops::BitAnd for CpuFeatures {
+    type Output = CpuFeatures;
+    fn bitand(self, rhs: CpuFeatures) -> CpuFeatures {
+        let mut words = self.0;
+        for (word, other) in words.iter_mut().zip(rhs.0) {
+            *word &= other;
+        }
+        CpuFeatures(words)
+    }
+}
+
+impl fmt::Debug for CpuFeatures {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_set().entries(self.names()).finish()
+    }
+}
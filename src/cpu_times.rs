@@ -0,0 +1,165 @@
+//! Cumulative cpu time of every state (`/proc/stat` columns) and the rates derived from them.
+//!
+//! [`read_into`] fills a reused buffer with one record per logical cpu in a single FFI call, the
+//! records have the layout of `C_CpuTimes`, so rates are computed over the same contiguous arrays.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result};
+
+/// Cumulative time of one cpu (or of the whole system) in every state, USER_HZ ticks on Linux.
+/// `guest` and `guest_nice` are included in `user` and `nice`. States a platform does not report
+/// are 0; all values are -1 for cpus that are not listed (offline).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct CpuTimes {
+    pub user: i64,
+    pub nice: i64,
+    pub system: i64,
+    pub idle: i64,
+    pub iowait: i64,
+    pub irq: i64,
+    pub softirq: i64,
+    pub steal: i64,
+    pub guest: i64,
+    pub guest_nice: i64,
+}
+
+const _: () =
+    assert!(std::mem::size_of::<CpuTimes>() == std::mem::size_of::<bindings::C_CpuTimes>());
+
+impl Default for CpuTimes {
+    fn default() -> Self {
+        CpuTimes {
+            user: -1,
+            nice: -1,
+            system: -1,
+            idle: -1,
+            iowait: -1,
+            irq: -1,
+            softirq: -1,
+            steal: -1,
+            guest: -1,
+            guest_nice: -1,
+        }
+    }
+}
+
+impl CpuTimes {
+    pub fn is_valid(&self) -> bool {
+        self.user >= 0
+    }
+
+    /// Every state once (the guest time is part of `user` and `nice`).
+    pub fn total(&self) -> i64 {
+        self.user
+            + self.nice
+            + self.system
+            + self.idle
+            + self.iowait
+            + self.irq
+            + self.softirq
+            + self.steal
+    }
+
+    /// [`CpuTimes::total`] without idle and iowait.
+    pub fn busy(&self) -> i64 {
+        self.user + self.nice + self.system + self.irq + self.softirq + self.steal
+    }
+}
+
+/// Shares (`[0, 1]`) of the period between two [`CpuTimes`] of the same cpu; -1 if they cannot be
+/// computed. `steal` is the part the hypervisor ran another guest on the cpu.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct CpuTimeRates {
+    /// user, nice, system, irq, softirq and steal
+    pub busy: f64,
+    /// user and nice
+    pub user: f64,
+    pub system: f64,
+    pub iowait: f64,
+    /// irq and softirq
+    pub irq: f64,
+    pub steal: f64,
+    /// guest and guest_nice
+    pub guest: f64,
+}
+
+const _: () =
+    assert!(std::mem::size_of::<CpuTimeRates>() == std::mem::size_of::<bindings::C_CpuTimeRates>());
+
+impl Default for CpuTimeRates {
+    fn default() -> Self {
+        CpuTimeRates {
+            busy: -1.0,
+            user: -1.0,
+            system: -1.0,
+            iowait: -1.0,
+            irq: -1.0,
+            steal: -1.0,
+            guest: -1.0,
+        }
+    }
+}
+
+/// Reads the counters of the whole system and of every thread (indexed by the OS cpu id) into
+/// `threads`, which keeps its capacity between calls.
+pub fn read_into(threads: &mut Vec<CpuTimes>) -> Result<CpuTimes> {
+    let mut total = CpuTimes::default();
+    loop {
+        let capacity = threads.capacity().max(1);
+        threads.resize(capacity, CpuTimes::default());
+        let count = unsafe {
+            bindings::get_cpu_times_into(
+                (&mut total as *mut CpuTimes).cast(),
+                threads.as_mut_ptr().cast(),
+                capacity as i32,
+            )
+        };
+        if count < 0 {
+            threads.clear();
+            return Err(HwinfoError::DataUnavailable("get_cpu_times_into".into()));
+        }
+        if count as usize <= capacity {
+            threads.truncate(count as usize);
+            return Ok(total);
+        }
+        // more threads than room: grow and read again, so that all records stem from one read
+        threads.reserve(count as usize - threads.len());
+    }
+}
+
+/// Allocating variant of [`read_into`]: the aggregate counters and those of every thread.
+pub fn read() -> Result<(CpuTimes, Vec<CpuTimes>)> {
+    let mut threads = Vec::new();
+    let total = read_into(&mut threads)?;
+    Ok((total, threads))
+}
+
+/// Rates between two samples of one cpu; `previous` `None` for the rates since boot.
+pub fn rates(previous: Option<&CpuTimes>, current: &CpuTimes) -> CpuTimeRates {
+    let mut out = CpuTimeRates::default();
+    rates_into(
+        previous.map(std::slice::from_ref),
+        std::slice::from_ref(current),
+        std::slice::from_mut(&mut out),
+    );
+    out
+}
+
+/// Rates of every cpu between `previous[i]` and `current[i]`, written to `out[i]`. Only the common
+/// length of the slices is processed.
+pub fn rates_into(previous: Option<&[CpuTimes]>, current: &[CpuTimes], out: &mut [CpuTimeRates]) {
+    let mut count = current.len().min(out.len());
+    if let Some(previous) = previous {
+        count = count.min(previous.len());
+    }
+    unsafe {
+        bindings::get_cpu_time_rates_into(
+            previous.map_or(std::ptr::null(), |p| p.as_ptr().cast()),
+            current.as_ptr().cast(),
+            count as i32,
+            out.as_mut_ptr().cast(),
+        );
+    }
+}
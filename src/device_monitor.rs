@@ -0,0 +1,96 @@
+//! Hotplug notifications.
+//!
+//! [`DeviceMonitor`] reports which components changed (disks, network interfaces, batteries,
+//! GPUs, ...) without re-enumerating anything, so consumers only refresh what changed. The lists
+//! returned by [`crate::hwinfo::disks`] and friends are enumerated again after a reported change.
+
+use crate::bindings;
+use crate::hwinfo::{Components, HwinfoError, Result};
+use std::ffi::c_void;
+use std::ptr::NonNull;
+use std::time::Duration;
+
+/// Listens for hotplug changes; poll it with [`DeviceMonitor::wait`].
+pub struct DeviceMonitor {
+    ptr: NonNull<bindings::C_DeviceMonitor>,
+}
+
+// The monitor is not tied to the creating thread; `wait` takes `&mut self`.
+unsafe impl Send for DeviceMonitor {}
+
+impl DeviceMonitor {
+    /// Starts listening. Changes that happened before are not reported.
+    pub fn new() -> Result<DeviceMonitor> {
+        let ptr = unsafe { bindings::get_device_monitor() };
+        NonNull::new(ptr)
+            .map(|ptr| DeviceMonitor { ptr })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_device_monitor".into()))
+    }
+
+    /// Linux: a descriptor that becomes readable when changes are pending, for an external
+    /// poll/epoll loop. `None` on other platforms.
+    pub fn fd(&self) -> Option<i32> {
+        let fd = unsafe { bindings::get_device_monitor_fd(self.ptr.as_ptr()) };
+        (fd >= 0).then_some(fd)
+    }
+
+    /// Waits up to `timeout` (indefinitely if `None`) and returns the components that changed
+    /// since the previous call, empty on timeout.
+    pub fn wait(&mut self, timeout: Option<Duration>) -> Components {
+        let timeout_ms = timeout.map_or(-1, |t| t.as_millis().min(i32::MAX as u128) as i32);
+        Components::from_bits(unsafe {
+            bindings::get_device_changes(self.ptr.as_ptr(), timeout_ms)
+        })
+    }
+}
+
+impl Drop for DeviceMonitor {
+    fn drop(&mut self) {
+        unsafe { bindings::free_device_monitor(self.ptr.as_ptr()) };
+    }
+}
+
+type Callback = Box<dyn Fn(Components) + Send + Sync>;
+
+unsafe extern "C" fn call(changed: u32, user_data: *mut c_void) {
+    let callback = unsafe { &*(user_data as *const Callback) };
+    // unwinding into C++ is undefined behaviour
+    let _ = std::panic::catch_unwind(std::panic::AssertUnwindSafe(|| {
+        callback(Components::from_bits(changed))
+    }));
+}
+
+/// Calls a closure on a background thread for every batch of hotplug changes. Dropping it stops
+/// the thread.
+pub struct DeviceWatcher {
+    ptr: NonNull<bindings::C_DeviceWatcher>,
+    // referenced by the C++ thread until it is stopped in drop
+    _callback: Box<Callback>,
+}
+
+unsafe impl Send for DeviceWatcher {}
+unsafe impl Sync for DeviceWatcher {}
+
+impl DeviceWatcher {
+    pub fn new<F>(callback: F) -> Result<DeviceWatcher>
+    where
+        F: Fn(Components) + Send + Sync + 'static,
+    {
+        let callback: Box<Callback> = Box::new(Box::new(callback));
+        let user_data = &*callback as *const Callback as *mut c_void;
+        let ptr = unsafe { bindings::get_device_watcher(Some(call), user_data) };
+        NonNull::new(ptr)
+            .map(|ptr| DeviceWatcher {
+                ptr,
+                _callback: callback,
+            })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_device_watcher".into()))
+    }
+}
+
+impl Drop for DeviceWatcher {
+    fn drop(&mut self) {
+        // joins the thread before the callback is freed
+        unsafe { bindings::free_device_watcher(self.ptr.as_ptr()) };
+    }
+}
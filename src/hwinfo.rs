@@ -1,8 +1,11 @@
 use crate::bindings;
+use crate::cpu_features::CpuFeatures;
 use std::convert::TryFrom;
 use std::ffi::CStr;
 use std::fmt;
+use std::mem::MaybeUninit;
 use std::os::raw::c_char;
+use std::ptr::NonNull;
 use std::str::Utf8Error;
 
 /// A type alias for `Result<T, HwinfoError>`.
@@ -38,7 +41,7 @@ impl std::error::Error for HwinfoError {
 }
 
 /// Safely converts a C string (`*mut c_char`) to a Rust `Result<String>`.
-unsafe fn c_char_to_string(s: *mut c_char) -> Result<String> {
+pub(crate) unsafe fn c_char_to_string(s: *mut c_char) -> Result<String> {
     if s.is_null() {
         Ok(String::new())
     } else {
@@ -54,7 +57,7 @@ unsafe fn c_char_to_string(s: *mut c_char) -> Result<String> {
 /// Safely converts a `C_StringArray` to a `Result<Vec<String>>`.
 /// Does not free the array, as it's part of a larger struct
 /// that will be freed all at once.
-unsafe fn c_string_array_to_vec(arr: &bindings::C_StringArray) -> Result<Vec<String>> {
+pub(crate) unsafe fn c_string_array_to_vec(arr: &bindings::C_StringArray) -> Result<Vec<String>> {
     if arr.strings.is_null() || arr.count <= 0 {
         return Ok(Vec::new());
     }
@@ -76,7 +79,8 @@ pub struct Cpu {
     pub l1_cache_size_bytes: i64,
     pub l2_cache_size_bytes: i64,
     pub l3_cache_size_bytes: i64,
-    pub flags: Vec<String>,
+    /// Decoded features. The raw flag strings are available through [`cpu_flags`].
+    pub features: CpuFeatures,
 }
 
 impl TryFrom<&bindings::C_CPU> for Cpu {
@@ -94,7 +98,7 @@ impl TryFrom<&bindings::C_CPU> for Cpu {
                 l1_cache_size_bytes: c_cpu.L1CacheSize_Bytes,
                 l2_cache_size_bytes: c_cpu.L2CacheSize_Bytes,
                 l3_cache_size_bytes: c_cpu.L3CacheSize_Bytes,
-                flags: c_string_array_to_vec(&c_cpu.flags)?,
+                features: CpuFeatures::from_bits(c_cpu.features),
             })
         }
     }
@@ -121,6 +125,22 @@ pub fn cpus() -> Result<Vec<Cpu>> {
     }
 }
 
+/// Raw flag strings of a cpu (including flags without a [`crate::cpu_features::CpuFeature`]).
+pub fn cpu_flags(cpu_id: i32) -> Result<Vec<String>> {
+    unsafe {
+        let arr_ptr = bindings::get_cpu_flags(cpu_id);
+        if arr_ptr.is_null() {
+            return Err(HwinfoError::DataUnavailable(format!(
+                "get_cpu_flags for cpu_id {}",
+                cpu_id
+            )));
+        }
+        let result = c_string_array_to_vec(&*arr_ptr);
+        bindings::free_string_array(arr_ptr);
+        result
+    }
+}
+
 pub fn cpu_utilization(cpu_id: i32) -> f64 {
     unsafe { bindings::get_cpu_utilization(cpu_id) }
 }
@@ -165,6 +185,64 @@ pub fn cpu_thread_speeds_mhz(cpu_id: i32) -> Result<Vec<i64>> {
     }
 }
 
+/// Calls a C fill function (`get_*_into`) with the spare capacity of `out` and sets its length to
+/// the number of written values. The capacity is kept between calls, so reusing the same `Vec`
+/// does not allocate once it is large enough.
+unsafe fn fill_vec<T>(
+    out: &mut Vec<T>,
+    cpu_id: i32,
+    fill: unsafe extern "C" fn(i32, *mut T, i32) -> i32,
+    name: &str,
+) -> Result<()> {
+    out.clear();
+    if out.capacity() == 0 {
+        // a null buffer of capacity 0 only queries the count, without sampling: a second sample
+        // right after the first would cover no time (utilizations of -1)
+        let count = unsafe { fill(cpu_id, std::ptr::null_mut(), 0) };
+        out.reserve(count.max(1) as usize);
+    }
+    let capacity = out.capacity().min(i32::MAX as usize) as i32;
+    let mut count = unsafe { fill(cpu_id, out.as_mut_ptr(), capacity) };
+    if count > capacity {
+        // only if the number of threads grew since the buffer was sized; the values are read again
+        out.reserve(count as usize);
+        let capacity = out.capacity().min(i32::MAX as usize) as i32;
+        count = unsafe { fill(cpu_id, out.as_mut_ptr(), capacity) }.min(capacity);
+    }
+    if count < 0 {
+        return Err(HwinfoError::DataUnavailable(format!(
+            "{} for cpu_id {}",
+            name, cpu_id
+        )));
+    }
+    unsafe { out.set_len(count as usize) };
+    Ok(())
+}
+
+/// Like [`cpu_thread_utilizations`], but writes into `out` and reuses its allocation.
+pub fn cpu_thread_utilizations_into(cpu_id: i32, out: &mut Vec<f64>) -> Result<()> {
+    unsafe {
+        fill_vec(
+            out,
+            cpu_id,
+            bindings::get_cpu_thread_utilizations_into,
+            "get_cpu_thread_utilizations_into",
+        )
+    }
+}
+
+/// Like [`cpu_thread_speeds_mhz`], but writes into `out` and reuses its allocation.
+pub fn cpu_thread_speeds_mhz_into(cpu_id: i32, out: &mut Vec<i64>) -> Result<()> {
+    unsafe {
+        fill_vec(
+            out,
+            cpu_id,
+            bindings::get_cpu_thread_speeds_mhz_into,
+            "get_cpu_thread_speeds_mhz_into",
+        )
+    }
+}
+
 #[derive(Debug, Clone)]
 pub struct Os {
     pub name: String,
@@ -214,6 +292,8 @@ pub struct Gpu {
     pub num_cores: i32,
     pub vendor_id: String,
     pub device_id: String,
+    /// PCI address ("0000:01:00.0"), empty where unknown (only Linux reports it).
+    pub pci_bus_id: String,
 }
 
 impl TryFrom<&bindings::C_GPU> for Gpu {
@@ -230,6 +310,7 @@ impl TryFrom<&bindings::C_GPU> for Gpu {
                 num_cores: c_gpu.num_cores,
                 vendor_id: c_char_to_string(c_gpu.vendor_id)?,
                 device_id: c_char_to_string(c_gpu.device_id)?,
+                pci_bus_id: c_char_to_string(c_gpu.pciBusId)?,
             })
         }
     }
@@ -324,6 +405,147 @@ pub fn memory_info() -> Result<MemoryInfo> {
     }
 }
 
+/// Memory counters of a single read, cheap enough to be polled at a high rate. Huge page values
+/// are page counts, all others are bytes; -1 if not available on the platform.
+#[derive(Debug, Clone, Copy)]
+pub struct MemorySnapshot {
+    /// `std::chrono::steady_clock` time of the read.
+    pub timestamp_ns: i64,
+    pub total_bytes: i64,
+    pub free_bytes: i64,
+    pub available_bytes: i64,
+    pub buffers_bytes: i64,
+    pub cached_bytes: i64,
+    pub shmem_bytes: i64,
+    pub dirty_bytes: i64,
+    pub writeback_bytes: i64,
+    pub swap_total_bytes: i64,
+    pub swap_free_bytes: i64,
+    pub hugepages_total: i64,
+    pub hugepages_free: i64,
+    pub hugepages_reserved: i64,
+    pub hugepages_surplus: i64,
+    pub hugepage_size_bytes: i64,
+}
+
+impl From<&bindings::C_MemorySnapshot> for MemorySnapshot {
+    fn from(c_snap: &bindings::C_MemorySnapshot) -> Self {
+        MemorySnapshot {
+            timestamp_ns: c_snap.timestamp_ns,
+            total_bytes: c_snap.total_Bytes,
+            free_bytes: c_snap.free_Bytes,
+            available_bytes: c_snap.available_Bytes,
+            buffers_bytes: c_snap.buffers_Bytes,
+            cached_bytes: c_snap.cached_Bytes,
+            shmem_bytes: c_snap.shmem_Bytes,
+            dirty_bytes: c_snap.dirty_Bytes,
+            writeback_bytes: c_snap.writeback_Bytes,
+            swap_total_bytes: c_snap.swap_total_Bytes,
+            swap_free_bytes: c_snap.swap_free_Bytes,
+            hugepages_total: c_snap.hugepages_total,
+            hugepages_free: c_snap.hugepages_free,
+            hugepages_reserved: c_snap.hugepages_reserved,
+            hugepages_surplus: c_snap.hugepages_surplus,
+            hugepage_size_bytes: c_snap.hugepage_size_Bytes,
+        }
+    }
+}
+
+pub fn memory_snapshot() -> Result<MemorySnapshot> {
+    let mut c_snap = std::mem::MaybeUninit::<bindings::C_MemorySnapshot>::uninit();
+    if unsafe { bindings::get_memory_snapshot_into(c_snap.as_mut_ptr()) } != 0 {
+        return Err(HwinfoError::DataUnavailable(
+            "get_memory_snapshot_into".into(),
+        ));
+    }
+    Ok(MemorySnapshot::from(unsafe { c_snap.assume_init_ref() }))
+}
+
+/// Memory of one NUMA node. Huge page values and the allocation counters are page counts since
+/// boot, the sizes are bytes; -1 if not available on the platform. The cpus local to the node are
+/// [`crate::topology::Topology::cpus_of_node`].
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct NodeMemory {
+    /// OS node id, as used by numactl.
+    pub node: i32,
+    pub total_bytes: i64,
+    pub free_bytes: i64,
+    pub used_bytes: i64,
+    pub file_bytes: i64,
+    pub anon_bytes: i64,
+    pub hugepages_total: i64,
+    pub hugepages_free: i64,
+    /// Allocations served from this node as intended.
+    pub numa_hit: i64,
+    /// Allocations served from this node although another node was preferred.
+    pub numa_miss: i64,
+    /// Allocations served from another node although this node was preferred.
+    pub numa_foreign: i64,
+    pub interleave_hit: i64,
+    /// Allocations on this node by a process running on this node.
+    pub local_node: i64,
+    /// Allocations on this node by a process running on another node.
+    pub other_node: i64,
+    /// Pages migrated to this node by NUMA balancing or memory tiering.
+    pub promoted_pages: i64,
+    /// Pages demoted from this node to a slower tier.
+    pub demoted_pages: i64,
+}
+
+const _: () =
+    assert!(std::mem::size_of::<NodeMemory>() == std::mem::size_of::<bindings::C_NodeMemory>());
+
+impl Default for NodeMemory {
+    fn default() -> Self {
+        NodeMemory {
+            node: -1,
+            total_bytes: -1,
+            free_bytes: -1,
+            used_bytes: -1,
+            file_bytes: -1,
+            anon_bytes: -1,
+            hugepages_total: -1,
+            hugepages_free: -1,
+            numa_hit: -1,
+            numa_miss: -1,
+            numa_foreign: -1,
+            interleave_hit: -1,
+            local_node: -1,
+            other_node: -1,
+            promoted_pages: -1,
+            demoted_pages: -1,
+        }
+    }
+}
+
+/// Reads the memory of every NUMA node into `nodes` (ascending node order), which keeps its
+/// capacity between calls.
+pub fn numa_memory_into(nodes: &mut Vec<NodeMemory>) -> Result<()> {
+    loop {
+        let capacity = nodes.capacity().max(1);
+        nodes.resize(capacity, NodeMemory::default());
+        let count =
+            unsafe { bindings::get_numa_memory_into(nodes.as_mut_ptr().cast(), capacity as i32) };
+        if count < 0 {
+            nodes.clear();
+            return Err(HwinfoError::DataUnavailable("get_numa_memory_into".into()));
+        }
+        if count as usize <= capacity {
+            nodes.truncate(count as usize);
+            return Ok(());
+        }
+        nodes.reserve(count as usize - nodes.len());
+    }
+}
+
+/// Allocating variant of [`numa_memory_into`].
+pub fn numa_memory() -> Result<Vec<NodeMemory>> {
+    let mut nodes = Vec::new();
+    numa_memory_into(&mut nodes)?;
+    Ok(nodes)
+}
+
 #[derive(Debug, Clone)]
 pub struct MainBoard {
     pub vendor: String,
@@ -415,6 +637,14 @@ pub struct Battery {
     pub energy_full_mwh: u32,
     pub energy_now_mwh: u32,
     pub is_charging: bool,
+    /// -1 if not reported.
+    pub power_now: i64,
+    /// -1 if not reported.
+    pub voltage_now: i64,
+    /// Charge in percent of `energy_full_mwh`, -1 if not reported.
+    pub capacity_percent: i32,
+    /// -1 if not reported.
+    pub cycle_count: i64,
 }
 
 impl TryFrom<&bindings::C_Battery> for Battery {
@@ -430,6 +660,10 @@ impl TryFrom<&bindings::C_Battery> for Battery {
                 energy_full_mwh: c_bat.energyFull,
                 energy_now_mwh: c_bat.energyNow,
                 is_charging: c_bat.charging,
+                power_now: c_bat.powerNow,
+                voltage_now: c_bat.voltageNow,
+                capacity_percent: c_bat.capacity,
+                cycle_count: c_bat.cycleCount,
             })
         }
     }
@@ -461,6 +695,10 @@ pub struct Network {
     pub mac_address: String,
     pub ipv4_address: String,
     pub ipv6_address: String,
+    /// All IPv4 addresses; `ipv4_address` is the first of them.
+    pub ipv4_addresses: Vec<String>,
+    /// All IPv6 addresses; `ipv6_address` is the link-local one (or the first).
+    pub ipv6_addresses: Vec<String>,
 }
 
 impl TryFrom<&bindings::C_Network> for Network {
@@ -473,6 +711,8 @@ impl TryFrom<&bindings::C_Network> for Network {
                 mac_address: c_char_to_string(c_net.mac)?,
                 ipv4_address: c_char_to_string(c_net.ip4)?,
                 ipv6_address: c_char_to_string(c_net.ip6)?,
+                ipv4_addresses: c_string_array_to_vec(&c_net.ip4s)?,
+                ipv6_addresses: c_string_array_to_vec(&c_net.ip6s)?,
             })
         }
     }
@@ -496,3 +736,388 @@ pub fn networks() -> Result<Vec<Network>> {
         result
     }
 }
+
+/// Components gathered by [`system_snapshot`] (or reported by a
+/// [`crate::device_monitor::DeviceMonitor`]). Combine with `|`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Components(u32);
+
+impl Components {
+    pub const CPU: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_CPU as u32);
+    pub const OS: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_OS as u32);
+    pub const GPU: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_GPU as u32);
+    pub const MEMORY: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_MEMORY as u32);
+    pub const MAINBOARD: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_MAINBOARD as u32);
+    pub const DISK: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_DISK as u32);
+    pub const BATTERY: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_BATTERY as u32);
+    pub const NETWORK: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_NETWORK as u32);
+    pub const ALL: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_ALL as u32);
+    /// Gather the selected components concurrently.
+    pub const PARALLEL: Components = Components(bindings::C_SnapshotFlags_C_SNAPSHOT_PARALLEL as u32);
+
+    /// Components of C_SnapshotFlags bits; unknown bits are kept.
+    pub fn from_bits(bits: u32) -> Components {
+        Components(bits)
+    }
+
+    pub fn bits(self) -> u32 {
+        self.0
+    }
+
+    pub fn is_empty(self) -> bool {
+        self.0 == 0
+    }
+
+    pub fn contains(self, other: Components) -> bool {
+        self.0 & other.0 == other.0
+    }
+}
+
+impl std::ops::BitOr for Components {
+    type Output = Components;
+    fn bitor(self, rhs: Components) -> Components {
+        Components(self.0 | rhs.0)
+    }
+}
+
+/// Defines a mask of the attributes a collector reads (see `hwinfo/fields.h`). Combine with `|`.
+macro_rules! field_mask {
+    ($(#[$meta:meta])* $name:ident { $($(#[$field_meta:meta])* $field:ident = $bit:ident,)* }) => {
+        $(#[$meta])*
+        #[derive(Debug, Clone, Copy, PartialEq, Eq)]
+        pub struct $name(u32);
+
+        impl $name {
+            pub const NONE: $name = $name(0);
+            $($(#[$field_meta])* pub const $field: $name = $name(bindings::$bit as u32);)*
+
+            pub fn bits(self) -> u32 {
+                self.0
+            }
+
+            pub fn contains(self, other: $name) -> bool {
+                self.0 & other.0 == other.0
+            }
+        }
+
+        impl std::ops::BitOr for $name {
+            type Output = $name;
+            fn bitor(self, rhs: $name) -> $name {
+                $name(self.0 | rhs.0)
+            }
+        }
+    };
+}
+
+field_mask!(
+    /// Attributes read by [`cpus_with`]; vendor, model and core counts are always read.
+    CpuFields {
+        /// Max and regular clock speed.
+        CLOCKS = C_FieldFlags_C_CPU_FIELD_CLOCKS,
+        CACHES = C_FieldFlags_C_CPU_FIELD_CACHES,
+        /// Flags and [`CpuFeatures`].
+        FEATURES = C_FieldFlags_C_CPU_FIELD_FEATURES,
+        ALL = C_FieldFlags_C_CPU_FIELD_ALL,
+    }
+);
+
+field_mask!(
+    /// Attributes read by [`gpus_with`]; the PCI ids are always read.
+    GpuFields {
+        /// Vendor and device name, driver version.
+        NAMES = C_FieldFlags_C_GPU_FIELD_NAMES,
+        MEMORY = C_FieldFlags_C_GPU_FIELD_MEMORY,
+        FREQUENCY = C_FieldFlags_C_GPU_FIELD_FREQUENCY,
+        ALL = C_FieldFlags_C_GPU_FIELD_ALL,
+    }
+);
+
+field_mask!(
+    /// Attributes read by [`disks_with`].
+    DiskFields {
+        /// Vendor, model and serial number.
+        IDENTITY = C_FieldFlags_C_DISK_FIELD_IDENTITY,
+        SIZE = C_FieldFlags_C_DISK_FIELD_SIZE,
+        /// Mount points and free space.
+        VOLUMES = C_FieldFlags_C_DISK_FIELD_VOLUMES,
+        ALL = C_FieldFlags_C_DISK_FIELD_ALL,
+    }
+);
+
+field_mask!(
+    /// Attributes read by [`networks_with`]; the interface index and name are always read.
+    NetworkFields {
+        MAC = C_FieldFlags_C_NETWORK_FIELD_MAC,
+        /// IPv4 and IPv6 addresses.
+        ADDRESSES = C_FieldFlags_C_NETWORK_FIELD_ADDRESSES,
+        ALL = C_FieldFlags_C_NETWORK_FIELD_ALL,
+    }
+);
+
+/// Enumerates the cpus again and reads only `fields`; the others keep their defaults
+/// (`"<unknown>"`, empty, -1). Unlike [`cpus`] this skips the cached list.
+pub fn cpus_with(fields: CpuFields) -> Result<Vec<Cpu>> {
+    unsafe {
+        let mut count = 0;
+        let cpus_ptr = bindings::get_cpus_with_fields(fields.bits(), &mut count);
+        let result = c_array_to_vec(cpus_ptr, count);
+        bindings::free_cpu_info(cpus_ptr, count);
+        result
+    }
+}
+
+/// Like [`cpus_with`] for the gpus.
+pub fn gpus_with(fields: GpuFields) -> Result<Vec<Gpu>> {
+    unsafe {
+        let mut count = 0;
+        let gpus_ptr = bindings::get_gpus_with_fields(fields.bits(), &mut count);
+        let result = c_array_to_vec(gpus_ptr, count);
+        bindings::free_gpu_info(gpus_ptr, count);
+        result
+    }
+}
+
+/// Like [`cpus_with`] for the disks, e.g. `disks_with(DiskFields::SIZE | DiskFields::VOLUMES)`.
+pub fn disks_with(fields: DiskFields) -> Result<Vec<Disk>> {
+    unsafe {
+        let mut count = 0;
+        let disks_ptr = bindings::get_disks_with_fields(fields.bits(), &mut count);
+        let result = c_array_to_vec(disks_ptr, count);
+        bindings::free_disk_info(disks_ptr, count);
+        result
+    }
+}
+
+/// Like [`cpus_with`] for the networks. `NetworkFields::NONE` only lists the interfaces.
+pub fn networks_with(fields: NetworkFields) -> Result<Vec<Network>> {
+    unsafe {
+        let mut count = 0;
+        let networks_ptr = bindings::get_networks_with_fields(fields.bits(), &mut count);
+        let result = c_array_to_vec(networks_ptr, count);
+        bindings::free_network_info(networks_ptr, count);
+        result
+    }
+}
+
+/// Streams the disks one at a time, reading only `fields` like [`disks_with`]. Every item is
+/// converted when the iterator is advanced, so filtering and stopping early never builds the full
+/// list, e.g. `iter_disks(DiskFields::IDENTITY)?.find(|d| ...)`.
+pub fn iter_disks(fields: DiskFields) -> Result<Enumeration<Disk>> {
+    Enumeration::open(
+        bindings::C_SnapshotFlags_C_SNAPSHOT_DISK as u32,
+        fields.bits(),
+        next_item::<bindings::C_Disk, Disk>,
+    )
+}
+
+/// Like [`iter_disks`] for the network interfaces, e.g. to find one interface among thousands of
+/// veth devices.
+pub fn iter_networks(fields: NetworkFields) -> Result<Enumeration<Network>> {
+    Enumeration::open(
+        bindings::C_SnapshotFlags_C_SNAPSHOT_NETWORK as u32,
+        fields.bits(),
+        next_item::<bindings::C_Network, Network>,
+    )
+}
+
+/// Iterator over the items of a streaming enumeration, see [`iter_disks`] and [`iter_networks`].
+/// Items that fail to convert are yielded as errors; the enumeration ends after an error of the
+/// C library.
+pub struct Enumeration<T> {
+    ptr: NonNull<bindings::C_Iterator>,
+    next: unsafe fn(*mut bindings::C_Iterator) -> Option<Result<T>>,
+    done: bool,
+}
+
+// The C iterator is only used through &mut self.
+unsafe impl<T: Send> Send for Enumeration<T> {}
+
+impl<T> Enumeration<T> {
+    fn open(
+        component: u32,
+        fields: u32,
+        next: unsafe fn(*mut bindings::C_Iterator) -> Option<Result<T>>,
+    ) -> Result<Enumeration<T>> {
+        let ptr = unsafe { bindings::hwinfo_iter_open(component, fields) };
+        let ptr = NonNull::new(ptr)
+            .ok_or_else(|| HwinfoError::DataUnavailable("hwinfo_iter_open".into()))?;
+        Ok(Enumeration {
+            ptr,
+            next,
+            done: false,
+        })
+    }
+}
+
+impl<T> Iterator for Enumeration<T> {
+    type Item = Result<T>;
+
+    fn next(&mut self) -> Option<Result<T>> {
+        if self.done {
+            return None;
+        }
+        let item = unsafe { (self.next)(self.ptr.as_ptr()) };
+        if !matches!(item, Some(Ok(_))) {
+            self.done = true;
+        }
+        item
+    }
+}
+
+impl<T> Drop for Enumeration<T> {
+    fn drop(&mut self) {
+        unsafe { bindings::hwinfo_iter_close(self.ptr.as_ptr()) };
+    }
+}
+
+/// Converts the next item of `it`; its strings are owned by the iterator and copied here.
+unsafe fn next_item<C, T>(it: *mut bindings::C_Iterator) -> Option<Result<T>>
+where
+    T: for<'a> TryFrom<&'a C, Error = HwinfoError>,
+{
+    // plain pointers and integers, overwritten by a successful call
+    let mut raw = MaybeUninit::<C>::zeroed();
+    match unsafe { bindings::hwinfo_iter_next(it, raw.as_mut_ptr().cast()) } {
+        1 => Some(T::try_from(unsafe { raw.assume_init_ref() })),
+        0 => None,
+        _ => Some(Err(HwinfoError::DataUnavailable("hwinfo_iter_next".into()))),
+    }
+}
+
+/// Converts a C array of `count` elements into owned values.
+unsafe fn c_array_to_vec<C, T>(ptr: *const C, count: i32) -> Result<Vec<T>>
+where
+    T: for<'a> TryFrom<&'a C, Error = HwinfoError>,
+{
+    if ptr.is_null() || count <= 0 {
+        return Ok(Vec::new());
+    }
+    unsafe {
+        std::slice::from_raw_parts(ptr, count as usize)
+            .iter()
+            .map(T::try_from)
+            .collect()
+    }
+}
+
+/// All components gathered by a single [`system_snapshot`] call. Components that were not
+/// requested are empty (`Vec`) or `None`.
+#[derive(Debug, Clone)]
+pub struct SystemSnapshot {
+    pub cpus: Vec<Cpu>,
+    pub os: Option<Os>,
+    pub gpus: Vec<Gpu>,
+    pub memory: Option<MemoryInfo>,
+    pub mainboard: Option<MainBoard>,
+    pub disks: Vec<Disk>,
+    pub batteries: Vec<Battery>,
+    pub networks: Vec<Network>,
+}
+
+impl TryFrom<&bindings::C_SystemSnapshot> for SystemSnapshot {
+    type Error = HwinfoError;
+    fn try_from(c_snap: &bindings::C_SystemSnapshot) -> Result<Self> {
+        unsafe {
+            Ok(SystemSnapshot {
+                cpus: c_array_to_vec(c_snap.cpus, c_snap.cpu_count)?,
+                os: c_snap.os.as_ref().map(Os::try_from).transpose()?,
+                gpus: c_array_to_vec(c_snap.gpus, c_snap.gpu_count)?,
+                memory: c_snap
+                    .memory
+                    .as_ref()
+                    .map(MemoryInfo::try_from)
+                    .transpose()?,
+                mainboard: c_snap
+                    .mainboard
+                    .as_ref()
+                    .map(MainBoard::try_from)
+                    .transpose()?,
+                disks: c_array_to_vec(c_snap.disks, c_snap.disk_count)?,
+                batteries: c_array_to_vec(c_snap.batteries, c_snap.battery_count)?,
+                networks: c_array_to_vec(c_snap.networks, c_snap.network_count)?,
+            })
+        }
+    }
+}
+
+/// Gathers all selected components with one FFI call and one allocation on the C side.
+pub fn system_snapshot(components: Components) -> Result<SystemSnapshot> {
+    unsafe {
+        let snap_ptr = bindings::get_system_snapshot(components.bits());
+        if snap_ptr.is_null() {
+            return Err(HwinfoError::DataUnavailable("get_system_snapshot".into()));
+        }
+        let result = SystemSnapshot::try_from(&*snap_ptr);
+        bindings::free_system_snapshot(snap_ptr);
+        result
+    }
+}
+
+/// Makes the next [`cpus`], [`gpus`], [`disks`], [`batteries`] or [`networks`] call enumerate
+/// the selected components again instead of returning the cached list.
+pub fn invalidate(components: Components) {
+    unsafe { bindings::hwinfo_invalidate(components.bits()) }
+}
+
+/// Sets how long the cached lists of the selected components are reused. `None` keeps them until
+/// [`invalidate`] (the default for cpus, gpus and batteries, whose dynamic values are read on
+/// access), `Some(Duration::ZERO)` enumerates on every call. Disks and networks default to one
+/// second. Memory, OS and mainboard are not cached.
+pub fn set_ttl(components: Components, ttl: Option<std::time::Duration>) {
+    let ttl_ms = ttl.map_or(-1, |ttl| i64::try_from(ttl.as_millis()).unwrap_or(i64::MAX));
+    unsafe { bindings::hwinfo_set_ttl(components.bits(), ttl_ms) }
+}
+
+/// Makes the Linux collectors read `/proc`, `/sys`, `/dev` and `/etc` below `path`, e.g. `/host`
+/// inside a container that mounts the host's trees there, or a captured fixture tree. `/` restores
+/// the real root (the default unless `HWINFO_ROOT` is set). Drops the cached component lists.
+/// Files that are kept open for the process lifetime are bound to the root of their first use, so
+/// set the root before collecting. Fails if `path` is no directory, and on other platforms.
+pub fn set_root(path: &std::path::Path) -> Result<()> {
+    let path = path
+        .to_str()
+        .and_then(|path| std::ffi::CString::new(path).ok())
+        .ok_or_else(|| HwinfoError::DataUnavailable("hwinfo_set_root".into()))?;
+    if unsafe { bindings::hwinfo_set_root(path.as_ptr()) } != 0 {
+        return Err(HwinfoError::DataUnavailable("hwinfo_set_root".into()));
+    }
+    Ok(())
+}
+
+/// Caches the cpus, gpus, mainboard and memory modules for the current boot in `directory`
+/// (`$XDG_RUNTIME_DIR` if `None`), so that later processes load them from a memory mapped file
+/// instead of enumerating them; clock speeds, utilisation and free memory are still read live. The
+/// environment variable `HWINFO_STATIC_CACHE` (`1` or a directory) enables it as well. Fails if
+/// `directory` is no directory.
+pub fn enable_static_cache(directory: Option<&std::path::Path>) -> Result<()> {
+    let directory = match directory {
+        Some(directory) => directory
+            .to_str()
+            .and_then(|directory| std::ffi::CString::new(directory).ok())
+            .ok_or_else(|| HwinfoError::DataUnavailable("hwinfo_enable_static_cache".into()))?,
+        None => std::ffi::CString::default(),
+    };
+    if unsafe { bindings::hwinfo_enable_static_cache(directory.as_ptr()) } != 0 {
+        return Err(HwinfoError::DataUnavailable(
+            "hwinfo_enable_static_cache".into(),
+        ));
+    }
+    Ok(())
+}
+
+pub fn disable_static_cache() {
+    unsafe { bindings::hwinfo_disable_static_cache() };
+}
+
+/// Removes the cache files of the current boot, e.g. after hot-plugging a gpu.
+pub fn clear_static_cache() {
+    unsafe { bindings::hwinfo_clear_static_cache() };
+}
+
+/// Limits every WMI enumeration (Windows only, no effect elsewhere): a provider that does not
+/// answer within `timeout` ends the enumeration with the objects received so far. The provider
+/// is polled every `poll_interval`. A zero duration keeps the current setting.
+pub fn set_wmi_timeout(timeout: std::time::Duration, poll_interval: std::time::Duration) {
+    let millis = |d: std::time::Duration| d.as_millis().min(i64::MAX as u128) as i64;
+    unsafe { bindings::hwinfo_set_wmi_timeout(millis(timeout), millis(poll_interval)) };
+}
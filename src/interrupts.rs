@@ -0,0 +1,175 @@
+//! Interrupts and softirqs serviced by every cpu, for IRQ affinity tuning.
+//!
+//! [`InterruptSampler`] reads `/proc/interrupts` and `/proc/softirqs` (Linux only) into dense
+//! row-major `lines × cpus` matrices of the counts since the previous update; column `c` is the
+//! cpu with OS id `c`, as in [`crate::topology::Topology`]. Lines are mapped to the network
+//! interface or disk that raises them.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result, c_char_to_string, c_string_array_to_vec};
+use std::ptr::NonNull;
+
+/// Kind of device an interrupt line was raised for.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum InterruptOwner {
+    None,
+    Network,
+    Disk,
+}
+
+impl InterruptOwner {
+    fn from_raw(owner: i32) -> InterruptOwner {
+        // bindgen emits the C enum as u32, or as i32 on MSVC targets
+        const NETWORK: i32 = bindings::C_InterruptOwner_C_INTERRUPT_OWNER_NETWORK as i32;
+        const DISK: i32 = bindings::C_InterruptOwner_C_INTERRUPT_OWNER_DISK as i32;
+        match owner {
+            NETWORK => InterruptOwner::Network,
+            DISK => InterruptOwner::Disk,
+            _ => InterruptOwner::None,
+        }
+    }
+}
+
+/// A row of `/proc/interrupts`.
+#[derive(Debug, Clone)]
+pub struct InterruptLine {
+    /// IRQ number, `None` for architecture interrupts.
+    pub irq: Option<u32>,
+    /// The IRQ number or the name of an architecture interrupt ("LOC", "NMI", ...).
+    pub name: String,
+    /// Interrupt chip, hardware irq, trigger and handlers, e.g. "PCI-MSIX-0000:00:04.0 1-edge eth0".
+    pub description: String,
+    pub owner: InterruptOwner,
+    /// Interface names or disk device names (e.g. "nvme0n1") that share the line.
+    pub devices: Vec<String>,
+}
+
+/// Delta based sampler of the interrupt and softirq counts of every cpu.
+pub struct InterruptSampler {
+    ptr: NonNull<bindings::C_InterruptSampler>,
+    lines: Vec<InterruptLine>,
+    softirq_names: Vec<String>,
+    num_cpus: usize,
+    deltas: Vec<i64>,
+    softirq_deltas: Vec<i64>,
+}
+
+// The sampler is not tied to the creating thread; `update` takes `&mut self`.
+unsafe impl Send for InterruptSampler {}
+
+impl InterruptSampler {
+    pub fn new() -> Result<InterruptSampler> {
+        let ptr = unsafe { bindings::get_interrupt_sampler() };
+        NonNull::new(ptr)
+            .map(|ptr| InterruptSampler {
+                ptr,
+                lines: Vec::new(),
+                softirq_names: Vec::new(),
+                num_cpus: 0,
+                deltas: Vec::new(),
+                softirq_deltas: Vec::new(),
+            })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_interrupt_sampler".into()))
+    }
+
+    /// Reads the counters. The deltas of the first update, and of an update after the lines or
+    /// cpus changed, are -1. The buffers are reused, only a changed layout allocates.
+    pub fn update(&mut self) -> Result<()> {
+        let changed = unsafe { bindings::get_interrupt_update(self.ptr.as_ptr()) };
+        if changed < 0 {
+            return Err(HwinfoError::DataUnavailable("get_interrupt_update".into()));
+        }
+        if changed > 0 {
+            self.read_layout()?;
+        }
+        unsafe {
+            let n = self.lines.len() * self.num_cpus;
+            self.deltas.resize(n, -1);
+            bindings::get_interrupt_deltas(self.ptr.as_ptr(), self.deltas.as_mut_ptr(), n as i32);
+            let n = self.softirq_names.len() * self.num_cpus;
+            self.softirq_deltas.resize(n, -1);
+            bindings::get_softirq_deltas(
+                self.ptr.as_ptr(),
+                self.softirq_deltas.as_mut_ptr(),
+                n as i32,
+            );
+        }
+        Ok(())
+    }
+
+    fn read_layout(&mut self) -> Result<()> {
+        let ptr = self.ptr.as_ptr();
+        self.num_cpus = unsafe { bindings::get_interrupt_num_cpus(ptr) }.max(0) as usize;
+        self.lines.clear();
+        unsafe {
+            let lines_ptr = bindings::get_interrupt_lines(ptr);
+            if !lines_ptr.is_null() {
+                let array = &*lines_ptr;
+                let result = (0..array.count.max(0) as usize)
+                    .map(|i| {
+                        let line = &*array.lines.add(i);
+                        Ok(InterruptLine {
+                            irq: u32::try_from(line.irq).ok(),
+                            name: c_char_to_string(line.name)?,
+                            description: c_char_to_string(line.description)?,
+                            owner: InterruptOwner::from_raw(line.owner),
+                            devices: c_string_array_to_vec(&line.devices)?,
+                        })
+                    })
+                    .collect::<Result<Vec<_>>>();
+                bindings::free_interrupt_line_array(lines_ptr);
+                self.lines = result?;
+            }
+            let names_ptr = bindings::get_softirq_names(ptr);
+            if names_ptr.is_null() {
+                return Err(HwinfoError::DataUnavailable("get_softirq_names".into()));
+            }
+            let result = c_string_array_to_vec(&*names_ptr);
+            bindings::free_string_array(names_ptr);
+            self.softirq_names = result?;
+        }
+        Ok(())
+    }
+
+    /// Columns of the matrices: one past the largest OS cpu id.
+    pub fn num_cpus(&self) -> usize {
+        self.num_cpus
+    }
+
+    pub fn lines(&self) -> &[InterruptLine] {
+        &self.lines
+    }
+
+    /// "HI", "TIMER", "NET_TX", "NET_RX", "BLOCK", ...
+    pub fn softirq_names(&self) -> &[String] {
+        &self.softirq_names
+    }
+
+    /// `lines().len() × num_cpus()` counts since the previous update, row-major.
+    pub fn deltas(&self) -> &[i64] {
+        &self.deltas
+    }
+
+    /// Counts of `lines()[line]` on every cpu.
+    pub fn line_deltas(&self, line: usize) -> &[i64] {
+        &self.deltas[line * self.num_cpus..(line + 1) * self.num_cpus]
+    }
+
+    /// `softirq_names().len() × num_cpus()` counts since the previous update, row-major.
+    pub fn softirq_deltas(&self) -> &[i64] {
+        &self.softirq_deltas
+    }
+
+    /// Indices into [`InterruptSampler::lines`] of the lines of an interface or disk.
+    pub fn lines_of(&self, device: &str) -> Vec<usize> {
+        (0..self.lines.len())
+            .filter(|&i| self.lines[i].devices.iter().any(|d| d == device))
+            .collect()
+    }
+}
+
+impl Drop for InterruptSampler {
+    fn drop(&mut self) {
+        unsafe { bindings::free_interrupt_sampler(self.ptr.as_ptr()) };
+    }
+}
@@ -0,0 +1,547 @@
+//! Compact binary inventories of the system and deltas between them.
+//!
+//! [`collect`] encodes the collected components in the versioned format of
+//! `hwinfo/inventory.h`: a string table in which every distinct string (vendor, model, flag list,
+//! ...) is stored once, followed by records of varint-encoded fields. [`Inventory`] reads such a
+//! buffer without copying, e.g. from a memory mapped file or a network message: all strings are
+//! `&str` borrowed from it. [`delta`] encodes the changes against a previous inventory, which are a
+//! few bytes for an unchanged system, and [`apply_delta`] restores the new inventory from them.
+
+use crate::bindings;
+use crate::hwinfo::{Components, HwinfoError, Result};
+
+/// Version of the format written by this library; [`Inventory::new`] rejects other versions.
+pub const VERSION: u8 = 1;
+
+const MAGIC: &[u8; 4] = b"HWIV";
+const HEADER_SIZE: usize = 20;
+const KIND_INVENTORY: u8 = 0;
+
+/// Copies a `C_Bytes` result and frees it.
+fn take_bytes(ptr: *mut bindings::C_Bytes, function: &str) -> Result<Vec<u8>> {
+    if ptr.is_null() {
+        return Err(HwinfoError::DataUnavailable(function.into()));
+    }
+    let bytes = unsafe {
+        let bytes = &*ptr;
+        if bytes.data.is_null() || bytes.size <= 0 {
+            Vec::new()
+        } else {
+            std::slice::from_raw_parts(bytes.data, bytes.size as usize).to_vec()
+        }
+    };
+    unsafe { bindings::free_bytes(ptr) };
+    Ok(bytes)
+}
+
+/// Collects the selected components (concurrently with [`Components::PARALLEL`]) and encodes them.
+pub fn collect(components: Components) -> Result<Vec<u8>> {
+    take_bytes(
+        unsafe { bindings::get_inventory(components.bits()) },
+        "get_inventory",
+    )
+}
+
+/// Delta that turns the inventory `base` into `inventory`. Fails if either is no valid inventory.
+pub fn delta(base: &[u8], inventory: &[u8]) -> Result<Vec<u8>> {
+    take_bytes(
+        unsafe {
+            bindings::get_inventory_delta(
+                base.as_ptr(),
+                base.len() as i64,
+                inventory.as_ptr(),
+                inventory.len() as i64,
+            )
+        },
+        "get_inventory_delta",
+    )
+}
+
+/// The inventory encoded by a [`delta`] against `base`. Fails if the delta is invalid or was
+/// computed against another base.
+pub fn apply_delta(base: &[u8], delta: &[u8]) -> Result<Vec<u8>> {
+    take_bytes(
+        unsafe {
+            bindings::get_inventory_from_delta(
+                base.as_ptr(),
+                base.len() as i64,
+                delta.as_ptr(),
+                delta.len() as i64,
+            )
+        },
+        "get_inventory_from_delta",
+    )
+}
+
+/// Kind of component a record describes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum RecordType {
+    Cpu,
+    Os,
+    Gpu,
+    Memory,
+    /// One per memory module, following the `Memory` record.
+    MemoryModule,
+    MainBoard,
+    Disk,
+    Battery,
+    Network,
+    /// Results of the hardware micro-benchmarks (`hwinfo/bench.h`, the `hwinfo_hwbench` CLI).
+    Bandwidth,
+    Latency,
+    CoreToCore,
+    /// Written by a newer library.
+    Unknown(u8),
+}
+
+impl From<u8> for RecordType {
+    fn from(value: u8) -> RecordType {
+        match value {
+            1 => RecordType::Cpu,
+            2 => RecordType::Os,
+            3 => RecordType::Gpu,
+            4 => RecordType::Memory,
+            5 => RecordType::MemoryModule,
+            6 => RecordType::MainBoard,
+            7 => RecordType::Disk,
+            8 => RecordType::Battery,
+            9 => RecordType::Network,
+            10 => RecordType::Bandwidth,
+            11 => RecordType::Latency,
+            12 => RecordType::CoreToCore,
+            other => RecordType::Unknown(other),
+        }
+    }
+}
+
+/// Field indices of the record types, see [`Record::get`]. Fields are only ever appended.
+pub mod fields {
+    pub mod cpu {
+        pub const ID: usize = 0;
+        pub const VENDOR: usize = 1;
+        pub const MODEL: usize = 2;
+        pub const PHYSICAL_CORES: usize = 3;
+        pub const LOGICAL_CORES: usize = 4;
+        pub const MAX_CLOCK_SPEED_MHZ: usize = 5;
+        pub const REGULAR_CLOCK_SPEED_MHZ: usize = 6;
+        pub const L1_CACHE_SIZE_BYTES: usize = 7;
+        pub const L2_CACHE_SIZE_BYTES: usize = 8;
+        pub const L3_CACHE_SIZE_BYTES: usize = 9;
+        pub const FLAGS: usize = 10;
+        /// The four words of the decoded feature set, as `u64` bits.
+        pub const FEATURES_0: usize = 11;
+        pub const FEATURES_1: usize = 12;
+        pub const FEATURES_2: usize = 13;
+        pub const FEATURES_3: usize = 14;
+    }
+    pub mod os {
+        pub const NAME: usize = 0;
+        pub const VERSION: usize = 1;
+        pub const KERNEL: usize = 2;
+        pub const IS_32BIT: usize = 3;
+        pub const IS_64BIT: usize = 4;
+        pub const IS_LITTLE_ENDIAN: usize = 5;
+    }
+    pub mod gpu {
+        pub const ID: usize = 0;
+        pub const VENDOR: usize = 1;
+        pub const NAME: usize = 2;
+        pub const DRIVER_VERSION: usize = 3;
+        pub const MEMORY_BYTES: usize = 4;
+        pub const FREQUENCY_MHZ: usize = 5;
+        pub const NUM_CORES: usize = 6;
+        pub const VENDOR_ID: usize = 7;
+        pub const DEVICE_ID: usize = 8;
+        pub const PCI_BUS_ID: usize = 9;
+    }
+    pub mod memory {
+        pub const TOTAL_BYTES: usize = 0;
+        pub const FREE_BYTES: usize = 1;
+        pub const AVAILABLE_BYTES: usize = 2;
+    }
+    pub mod memory_module {
+        pub const ID: usize = 0;
+        pub const VENDOR: usize = 1;
+        pub const NAME: usize = 2;
+        pub const MODEL: usize = 3;
+        pub const SERIAL_NUMBER: usize = 4;
+        pub const TOTAL_BYTES: usize = 5;
+        pub const FREQUENCY_HZ: usize = 6;
+    }
+    pub mod mainboard {
+        pub const VENDOR: usize = 0;
+        pub const NAME: usize = 1;
+        pub const VERSION: usize = 2;
+        pub const SERIAL_NUMBER: usize = 3;
+    }
+    pub mod disk {
+        pub const ID: usize = 0;
+        pub const VENDOR: usize = 1;
+        pub const MODEL: usize = 2;
+        pub const SERIAL_NUMBER: usize = 3;
+        pub const SIZE_BYTES: usize = 4;
+        pub const FREE_SIZE_BYTES: usize = 5;
+        pub const VOLUMES: usize = 6;
+    }
+    pub mod battery {
+        pub const ID: usize = 0;
+        pub const VENDOR: usize = 1;
+        pub const MODEL: usize = 2;
+        pub const SERIAL_NUMBER: usize = 3;
+        pub const TECHNOLOGY: usize = 4;
+        pub const ENERGY_FULL: usize = 5;
+        pub const ENERGY_NOW: usize = 6;
+        pub const CHARGING: usize = 7;
+        pub const POWER_NOW: usize = 8;
+        pub const VOLTAGE_NOW: usize = 9;
+        pub const CAPACITY: usize = 10;
+        pub const CYCLE_COUNT: usize = 11;
+    }
+    pub mod network {
+        pub const INTERFACE_INDEX: usize = 0;
+        pub const DESCRIPTION: usize = 1;
+        pub const MAC: usize = 2;
+        pub const IP4: usize = 3;
+        pub const IP6: usize = 4;
+        pub const IP4S: usize = 5;
+        pub const IP6S: usize = 6;
+    }
+    /// `PINNED` is 0 or 1, the throughputs and latencies are doubles.
+    pub mod bandwidth {
+        pub const NODE: usize = 0;
+        pub const THREADS: usize = 1;
+        pub const PINNED: usize = 2;
+        pub const ARRAY_BYTES: usize = 3;
+        pub const COPY_BYTES_PER_S: usize = 4;
+        pub const SCALE_BYTES_PER_S: usize = 5;
+        pub const ADD_BYTES_PER_S: usize = 6;
+        pub const TRIAD_BYTES_PER_S: usize = 7;
+    }
+    pub mod latency {
+        pub const CPU: usize = 0;
+        pub const THREADS: usize = 1;
+        pub const PINNED: usize = 2;
+        pub const SIZE_BYTES: usize = 3;
+        /// 1 - 3, 0 if the working set exceeds the detected caches.
+        pub const CACHE_LEVEL: usize = 4;
+        pub const LATENCY_NS: usize = 5;
+    }
+    pub mod core_to_core {
+        pub const CPU_A: usize = 0;
+        pub const CPU_B: usize = 1;
+        /// 0 SMT sibling, 1 same cache domain, 2 same node, 3 same socket, 4 remote.
+        pub const DISTANCE: usize = 2;
+        pub const PINNED: usize = 3;
+        pub const LATENCY_NS: usize = 4;
+    }
+}
+
+/// A list of strings (cpu flags, disk volumes, ip addresses), borrowed from the inventory.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Strings<'a>(&'a str);
+
+impl<'a> Strings<'a> {
+    pub fn iter(&self) -> impl Iterator<Item = &'a str> + 'a {
+        // every item is terminated by '\0'
+        self.0.split_terminator('\0')
+    }
+}
+
+/// A field of a record.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Value<'a> {
+    /// Also returned for fields a record does not have, e.g. those appended by newer versions.
+    Null,
+    Int(i64),
+    Double(f64),
+    Str(&'a str),
+    Strings(Strings<'a>),
+}
+
+impl<'a> Value<'a> {
+    pub fn as_i64(&self) -> Option<i64> {
+        match *self {
+            Value::Int(value) => Some(value),
+            _ => None,
+        }
+    }
+
+    pub fn as_f64(&self) -> Option<f64> {
+        match *self {
+            Value::Double(value) => Some(value),
+            _ => None,
+        }
+    }
+
+    pub fn as_str(&self) -> Option<&'a str> {
+        match *self {
+            Value::Str(value) => Some(value),
+            _ => None,
+        }
+    }
+
+    pub fn as_strings(&self) -> Option<Strings<'a>> {
+        match *self {
+            Value::Strings(value) => Some(value),
+            _ => None,
+        }
+    }
+}
+
+fn le(bytes: &[u8]) -> u64 {
+    bytes
+        .iter()
+        .rev()
+        .fold(0, |value, &byte| (value << 8) | u64::from(byte))
+}
+
+fn fnv1a(data: &[u8]) -> u64 {
+    data.iter().fold(0xcbf29ce484222325, |hash, &byte| {
+        (hash ^ u64::from(byte)).wrapping_mul(0x100000001b3)
+    })
+}
+
+/// The string table: `count` u32 end offsets and the string bytes.
+#[derive(Clone, Copy)]
+struct StringTable<'a> {
+    ends: &'a [u8],
+    data: &'a [u8],
+}
+
+impl<'a> StringTable<'a> {
+    fn len(&self) -> usize {
+        self.ends.len() / 4
+    }
+
+    fn bytes(&self, index: usize) -> Option<&'a [u8]> {
+        if index >= self.len() {
+            return None;
+        }
+        let begin = match index {
+            0 => 0,
+            _ => le(&self.ends[4 * (index - 1)..4 * index]) as usize,
+        };
+        let end = le(&self.ends[4 * index..4 * index + 4]) as usize;
+        self.data.get(begin..end)
+    }
+
+    fn get(&self, index: usize) -> Option<&'a str> {
+        // validated by Inventory::new()
+        self.bytes(index)
+            .map(|bytes| unsafe { std::str::from_utf8_unchecked(bytes) })
+    }
+}
+
+/// Bounds checked decoding of the records.
+#[derive(Clone, Copy)]
+struct Decoder<'a> {
+    data: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Decoder<'a> {
+    fn varint(&mut self) -> Option<u64> {
+        let mut value = 0u64;
+        for shift in (0..64).step_by(7) {
+            let byte = *self.data.get(self.pos)?;
+            self.pos += 1;
+            value |= u64::from(byte & 0x7f) << shift;
+            if byte & 0x80 == 0 {
+                return Some(value);
+            }
+        }
+        None
+    }
+
+    fn varint32(&mut self) -> Option<u32> {
+        self.varint().and_then(|value| u32::try_from(value).ok())
+    }
+
+    fn fixed(&mut self, size: usize) -> Option<u64> {
+        let bytes = self.data.get(self.pos..self.pos.checked_add(size)?)?;
+        self.pos += size;
+        Some(le(bytes))
+    }
+
+    fn value(&mut self, strings: &StringTable<'a>) -> Option<Value<'a>> {
+        Some(match self.fixed(1)? {
+            0 => Value::Null,
+            1 => {
+                let raw = self.varint()?;
+                Value::Int((raw >> 1) as i64 ^ -((raw & 1) as i64))
+            }
+            2 => Value::Double(f64::from_bits(self.fixed(8)?)),
+            3 => Value::Str(strings.get(self.varint()? as usize)?),
+            4 => Value::Strings(Strings(strings.get(self.varint()? as usize)?)),
+            // value types of a newer version cannot be skipped
+            _ => return None,
+        })
+    }
+}
+
+/// Zero-copy view of an encoded inventory. [`Inventory::new`] checks the whole buffer, so the
+/// records can be read without further errors.
+#[derive(Clone, Copy)]
+pub struct Inventory<'a> {
+    strings: StringTable<'a>,
+    records: Decoder<'a>,
+    num_records: u32,
+}
+
+impl<'a> Inventory<'a> {
+    /// Validates the header, the checksum, the string table (including UTF-8) and every record.
+    pub fn new(data: &'a [u8]) -> Result<Inventory<'a>> {
+        Inventory::parse(data).ok_or_else(|| HwinfoError::DataUnavailable("inventory".into()))
+    }
+
+    fn parse(data: &'a [u8]) -> Option<Inventory<'a>> {
+        let header = data.get(..HEADER_SIZE)?;
+        if &header[..4] != MAGIC
+            || header[4] != VERSION
+            || header[5] != KIND_INVENTORY
+            || header[6..8] != [0, 0]
+        {
+            return None;
+        }
+        let size = le(&header[8..12]) as usize;
+        let body = data.get(HEADER_SIZE..size)?;
+        if fnv1a(body) != le(&header[12..20]) {
+            return None;
+        }
+
+        let mut decoder = Decoder {
+            data,
+            pos: HEADER_SIZE,
+        };
+        let count = decoder.fixed(4)? as usize;
+        let ends = data.get(decoder.pos..decoder.pos.checked_add(count.checked_mul(4)?)?)?;
+        decoder.pos += ends.len();
+        let data_len = if count == 0 {
+            0
+        } else {
+            le(&ends[ends.len() - 4..]) as usize
+        };
+        let strings = StringTable {
+            ends,
+            data: data.get(decoder.pos..decoder.pos.checked_add(data_len)?)?,
+        };
+        decoder.pos += data_len;
+        let mut previous = 0;
+        for index in 0..count {
+            let end = le(&ends[4 * index..4 * index + 4]);
+            if end < previous {
+                return None;
+            }
+            previous = end;
+            std::str::from_utf8(strings.bytes(index)?).ok()?;
+        }
+
+        let num_records = decoder.varint32()?;
+        let inventory = Inventory {
+            strings,
+            records: Decoder {
+                data: &data[..size],
+                pos: decoder.pos,
+            },
+            num_records,
+        };
+        let mut check = inventory.records;
+        for _ in 0..num_records {
+            check.varint()?;
+            for _ in 0..check.varint32()? {
+                check.value(&strings)?;
+            }
+        }
+        Some(inventory)
+    }
+
+    pub fn len(&self) -> usize {
+        self.num_records as usize
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.num_records == 0
+    }
+
+    /// Number of distinct strings of the inventory.
+    pub fn num_strings(&self) -> usize {
+        self.strings.len()
+    }
+
+    pub fn records(&self) -> Records<'a> {
+        Records {
+            strings: self.strings,
+            decoder: self.records,
+            left: self.num_records,
+        }
+    }
+}
+
+/// Iterator over the records of an [`Inventory`].
+pub struct Records<'a> {
+    strings: StringTable<'a>,
+    decoder: Decoder<'a>,
+    left: u32,
+}
+
+impl<'a> Iterator for Records<'a> {
+    type Item = Record<'a>;
+
+    fn next(&mut self) -> Option<Record<'a>> {
+        if self.left == 0 {
+            return None;
+        }
+        self.left -= 1;
+        let kind = RecordType::from(u8::try_from(self.decoder.varint()?).ok()?);
+        let num_fields = self.decoder.varint32()?;
+        let record = Record {
+            kind,
+            num_fields,
+            strings: self.strings,
+            fields: self.decoder,
+        };
+        for _ in 0..num_fields {
+            self.decoder.value(&self.strings)?;
+        }
+        Some(record)
+    }
+}
+
+/// One record of an [`Inventory`]: a component and its fields in the order of [`fields`].
+#[derive(Clone, Copy)]
+pub struct Record<'a> {
+    kind: RecordType,
+    num_fields: u32,
+    strings: StringTable<'a>,
+    fields: Decoder<'a>,
+}
+
+impl<'a> Record<'a> {
+    pub fn kind(&self) -> RecordType {
+        self.kind
+    }
+
+    pub fn num_fields(&self) -> usize {
+        self.num_fields as usize
+    }
+
+    pub fn fields(&self) -> impl Iterator<Item = Value<'a>> + 'a {
+        let strings = self.strings;
+        let mut decoder = self.fields;
+        (0..self.num_fields).map_while(move |_| decoder.value(&strings))
+    }
+
+    /// The field at `index` (see [`fields`]), `Value::Null` if the record has no such field.
+    pub fn get(&self, index: usize) -> Value<'a> {
+        self.fields().nth(index).unwrap_or(Value::Null)
+    }
+}
+
+impl std::fmt::Debug for Record<'_> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("Record")
+            .field("kind", &self.kind)
+            .field("fields", &self.fields().collect::<Vec<_>>())
+            .finish()
+    }
+}
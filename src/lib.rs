@@ -6,4 +6,20 @@ pub mod bindings {
     include!(concat!(env!("OUT_DIR"), "/bindings.rs"));
 }
 
+pub mod cgroup;
+pub mod cpu_features;
+pub mod cpu_times;
+pub mod device_monitor;
 pub mod hwinfo;
+pub mod interrupts;
+pub mod inventory;
+pub mod nvme;
+pub mod pressure;
+pub mod process_stats;
+pub mod sampler;
+pub mod sensors;
+pub mod shared_frame;
+pub mod snapshot;
+pub mod stats;
+pub mod thread_metrics;
+pub mod topology;
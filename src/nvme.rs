@@ -0,0 +1,129 @@
+//! NVMe controllers and their SMART / Health logs, for tracking drive wear.
+//!
+//! [`NvmeSampler`] identifies the controllers once (Linux only: one Identify Controller admin
+//! command per controller, the sysfs attributes without `CAP_SYS_ADMIN`) and caches the health
+//! log of every controller, reading it again only once it is older than the refresh interval.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result, c_char_to_string, c_string_array_to_vec};
+use std::ptr::NonNull;
+use std::time::Duration;
+
+/// SMART / Health log of a controller. Values that could not be read are -1, the temperature
+/// NaN; `timestamp_ns` is -1 until the log was read.
+pub type NvmeHealth = bindings::C_NvmeHealth;
+
+/// Identity of an NVMe controller.
+#[derive(Debug, Clone)]
+pub struct NvmeController {
+    /// "nvme0"
+    pub name: String,
+    /// PCI vendor id ("0x144d"), as in [`crate::hwinfo::Disk::vendor`].
+    pub vendor: String,
+    pub model: String,
+    pub serial_number: String,
+    pub firmware_version: String,
+    /// `None` if not reported or the controller could not be identified.
+    pub total_capacity_bytes: Option<u64>,
+    pub unallocated_capacity_bytes: Option<u64>,
+    /// Block devices of the namespaces ("nvme0n1").
+    pub namespaces: Vec<String>,
+    /// `false` if the Identify Controller command failed (it needs `CAP_SYS_ADMIN`) and the
+    /// strings stem from sysfs.
+    pub identified: bool,
+}
+
+/// Controllers with cached health logs; refresh them with [`NvmeSampler::read`].
+pub struct NvmeSampler {
+    ptr: NonNull<bindings::C_NvmeSampler>,
+    controllers: Vec<NvmeController>,
+}
+
+// The sampler is not tied to the creating thread; `read` takes `&mut self`.
+unsafe impl Send for NvmeSampler {}
+
+impl NvmeSampler {
+    /// Discovers and identifies the controllers. Health logs are read again once older than
+    /// `refresh`.
+    pub fn new(refresh: Duration) -> Result<NvmeSampler> {
+        let ptr = unsafe { bindings::get_nvme_sampler(refresh.as_millis() as i64) };
+        let ptr = NonNull::new(ptr)
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_nvme_sampler".into()))?;
+        // freed by Drop if the controllers cannot be read
+        let mut result = NvmeSampler {
+            ptr,
+            controllers: Vec::new(),
+        };
+        unsafe {
+            let arr_ptr = bindings::get_nvme_controllers(ptr.as_ptr());
+            if arr_ptr.is_null() {
+                return Err(HwinfoError::DataUnavailable("get_nvme_controllers".into()));
+            }
+            let arr = &*arr_ptr;
+            let controllers: Result<Vec<NvmeController>> = if arr.controllers.is_null()
+                || arr.count <= 0
+            {
+                Ok(Vec::new())
+            } else {
+                std::slice::from_raw_parts(arr.controllers, arr.count as usize)
+                    .iter()
+                    .map(|c| {
+                        Ok(NvmeController {
+                            name: c_char_to_string(c.name)?,
+                            vendor: c_char_to_string(c.vendor)?,
+                            model: c_char_to_string(c.model)?,
+                            serial_number: c_char_to_string(c.serial_number)?,
+                            firmware_version: c_char_to_string(c.firmware_version)?,
+                            total_capacity_bytes: u64::try_from(c.total_capacity_Bytes).ok(),
+                            unallocated_capacity_bytes: u64::try_from(c.unallocated_capacity_Bytes)
+                                .ok(),
+                            namespaces: c_string_array_to_vec(&c.namespaces)?,
+                            identified: c.identified != 0,
+                        })
+                    })
+                    .collect()
+            };
+            bindings::free_nvme_controller_array(arr_ptr);
+            result.controllers = controllers?;
+        }
+        Ok(result)
+    }
+
+    /// Takes effect with the next [`NvmeSampler::read`].
+    pub fn set_refresh(&mut self, refresh: Duration) {
+        unsafe { bindings::hwinfo_set_nvme_refresh(self.ptr.as_ptr(), refresh.as_millis() as i64) };
+    }
+
+    /// The controllers, in the order of the logs of [`NvmeSampler::read`].
+    pub fn controllers(&self) -> &[NvmeController] {
+        &self.controllers
+    }
+
+    pub fn len(&self) -> usize {
+        self.controllers.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.controllers.is_empty()
+    }
+
+    /// Reads the logs that are older than the refresh interval into `health` (resized to
+    /// [`NvmeSampler::len`]); the others are the cached logs.
+    pub fn read(&mut self, health: &mut Vec<NvmeHealth>) -> Result<()> {
+        // the C side overwrites every entry
+        health.resize(self.controllers.len(), unsafe { std::mem::zeroed() });
+        let count = unsafe {
+            bindings::get_nvme_health(self.ptr.as_ptr(), health.as_mut_ptr(), health.len() as i32)
+        };
+        if count < 0 {
+            return Err(HwinfoError::DataUnavailable("get_nvme_health".into()));
+        }
+        Ok(())
+    }
+}
+
+impl Drop for NvmeSampler {
+    fn drop(&mut self) {
+        unsafe { bindings::free_nvme_sampler(self.ptr.as_ptr()) };
+    }
+}
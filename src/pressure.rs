@@ -0,0 +1,176 @@
+//! Linux pressure stall information (PSI).
+//!
+//! [`pressure`] reads `/proc/pressure/<resource>` (or the `<resource>.pressure` file of the
+//! cgroup of the process) from a descriptor that is opened once and kept open.
+//! [`PressureTrigger`] registers a kernel trigger instead, so a consumer sleeps until the stall
+//! time of a window exceeds a threshold rather than polling the averages.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result};
+use std::ptr::NonNull;
+use std::time::Duration;
+
+/// Resources tracked by PSI.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum PressureResource {
+    Cpu,
+    Memory,
+    Io,
+}
+
+impl PressureResource {
+    fn to_raw(self) -> i32 {
+        (match self {
+            PressureResource::Cpu => bindings::C_PressureResource_C_PRESSURE_CPU,
+            PressureResource::Memory => bindings::C_PressureResource_C_PRESSURE_MEMORY,
+            PressureResource::Io => bindings::C_PressureResource_C_PRESSURE_IO,
+        }) as i32
+    }
+}
+
+/// One line of a pressure file. Lines the kernel does not report are -1.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct PressureLine {
+    /// Share of wall time (in percent) in which tasks stalled, averaged over 10, 60 and 300 s.
+    pub avg10: f64,
+    pub avg60: f64,
+    pub avg300: f64,
+    /// Cumulative stall time.
+    pub total_us: i64,
+}
+
+impl Default for PressureLine {
+    fn default() -> Self {
+        PressureLine {
+            avg10: -1.0,
+            avg60: -1.0,
+            avg300: -1.0,
+            total_us: -1,
+        }
+    }
+}
+
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct PressureStats {
+    /// At least one task stalled.
+    pub some: PressureLine,
+    /// All non-idle tasks stalled at once. Zeros for the cpu of the whole system.
+    pub full: PressureLine,
+}
+
+const _: () = assert!(
+    std::mem::size_of::<PressureStats>() == std::mem::size_of::<bindings::C_PressureStats>()
+);
+
+fn read(resource: PressureResource, cgroup: bool) -> Result<PressureStats> {
+    let mut stats = PressureStats::default();
+    let rc = unsafe {
+        bindings::get_pressure_into(
+            resource.to_raw(),
+            cgroup as i32,
+            (&mut stats as *mut PressureStats).cast(),
+        )
+    };
+    if rc < 0 {
+        return Err(HwinfoError::DataUnavailable("get_pressure_into".into()));
+    }
+    Ok(stats)
+}
+
+/// Pressure of `resource` on the whole system. Linux 4.20+ with `CONFIG_PSI` only.
+pub fn pressure(resource: PressureResource) -> Result<PressureStats> {
+    read(resource, false)
+}
+
+/// Pressure of `resource` within the cgroup of the process (unified hierarchy only).
+pub fn cgroup_pressure(resource: PressureResource) -> Result<PressureStats> {
+    read(resource, true)
+}
+
+/// Which line of the pressure file a [`PressureTrigger`] watches.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum PressureKind {
+    Some,
+    Full,
+}
+
+/// Kernel PSI trigger: fires once the stall time within a window exceeds a threshold, e.g. 150 ms
+/// of "some" cpu stall within 1 s. At most one event is reported per window.
+pub struct PressureTrigger {
+    ptr: NonNull<bindings::C_PressureTrigger>,
+}
+
+// The trigger is not tied to the creating thread, and `interrupt` may be called from any thread
+// while another one waits.
+unsafe impl Send for PressureTrigger {}
+unsafe impl Sync for PressureTrigger {}
+
+impl PressureTrigger {
+    /// Registers a trigger on the pressure of the whole system. `window` must be between 500 ms
+    /// and 10 s; unprivileged processes may only use multiples of 2 s.
+    pub fn new(
+        resource: PressureResource,
+        kind: PressureKind,
+        stall: Duration,
+        window: Duration,
+    ) -> Result<PressureTrigger> {
+        Self::create(resource, false, kind, stall, window)
+    }
+
+    /// Registers a trigger on the pressure of the cgroup of the process.
+    pub fn cgroup(
+        resource: PressureResource,
+        kind: PressureKind,
+        stall: Duration,
+        window: Duration,
+    ) -> Result<PressureTrigger> {
+        Self::create(resource, true, kind, stall, window)
+    }
+
+    fn create(
+        resource: PressureResource,
+        cgroup: bool,
+        kind: PressureKind,
+        stall: Duration,
+        window: Duration,
+    ) -> Result<PressureTrigger> {
+        let ptr = unsafe {
+            bindings::get_pressure_trigger(
+                resource.to_raw(),
+                cgroup as i32,
+                (kind == PressureKind::Full) as i32,
+                stall.as_micros().min(i64::MAX as u128) as i64,
+                window.as_micros().min(i64::MAX as u128) as i64,
+            )
+        };
+        NonNull::new(ptr)
+            .map(|ptr| PressureTrigger { ptr })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_pressure_trigger".into()))
+    }
+
+    /// A descriptor that reports `POLLPRI` on an event, for an external poll/epoll loop.
+    pub fn fd(&self) -> Option<i32> {
+        let fd = unsafe { bindings::get_pressure_trigger_fd(self.ptr.as_ptr()) };
+        (fd >= 0).then_some(fd)
+    }
+
+    /// Waits up to `timeout` (indefinitely if `None`). Returns true on an event, false on
+    /// timeout, after [`PressureTrigger::interrupt`] and if the monitored cgroup was removed.
+    pub fn wait(&self, timeout: Option<Duration>) -> bool {
+        let timeout_ms = timeout.map_or(-1, |t| t.as_millis().min(i32::MAX as u128) as i32);
+        unsafe { bindings::get_pressure_event(self.ptr.as_ptr(), timeout_ms) > 0 }
+    }
+
+    /// Makes a concurrent (or the next) [`PressureTrigger::wait`] return false.
+    pub fn interrupt(&self) {
+        unsafe { bindings::hwinfo_interrupt_pressure_trigger(self.ptr.as_ptr()) };
+    }
+}
+
+impl Drop for PressureTrigger {
+    fn drop(&mut self) {
+        unsafe { bindings::free_pressure_trigger(self.ptr.as_ptr()) };
+    }
+}
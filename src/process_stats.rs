@@ -0,0 +1,88 @@
+//! Resource usage of a fixed set of processes.
+//!
+//! [`Processes`] keeps the per-process counters open (Linux: `/proc/<pid>/stat`, `statm` and `io`;
+//! macOS: `proc_pid_rusage`; Windows: one `NtQuerySystemInformation` call for all processes) and
+//! reads them together with the cpu time of the whole system, so a process share and the system
+//! utilisation cover the same period. Results are written in structure-of-arrays layout.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result};
+use std::ptr::NonNull;
+
+/// Columns of one [`Processes::read`], every one indexed like [`Processes::pids`]. Values that
+/// could not be read (exited processes, `/proc/<pid>/io` of other users) and the rates of the first
+/// read are -1.
+#[derive(Debug, Clone, Default)]
+pub struct ProcessStats {
+    /// Share of the cpu time of all logical cpus (`[0, 1]`) since the previous read.
+    pub cpu_utilisation: Vec<f64>,
+    pub rss_bytes: Vec<i64>,
+    pub read_bytes_per_s: Vec<f64>,
+    pub written_bytes_per_s: Vec<f64>,
+}
+
+/// Sampler of the watched processes; read them with [`Processes::read`].
+pub struct Processes {
+    ptr: NonNull<bindings::C_ProcessSampler>,
+    pids: Vec<i64>,
+}
+
+// The sampler is not tied to the creating thread; `read` takes `&mut self`.
+unsafe impl Send for Processes {}
+
+impl Processes {
+    /// Watches the given processes. A pid that is reused by another process after the original one
+    /// exited is not attributed to it.
+    pub fn new(pids: &[u32]) -> Result<Processes> {
+        let pids: Vec<i64> = pids.iter().map(|&pid| i64::from(pid)).collect();
+        let ptr = unsafe { bindings::get_process_sampler(pids.as_ptr(), pids.len() as i32) };
+        NonNull::new(ptr)
+            .map(|ptr| Processes { ptr, pids })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_process_sampler".into()))
+    }
+
+    /// The watched pids, in the order of the columns.
+    pub fn pids(&self) -> &[i64] {
+        &self.pids
+    }
+
+    pub fn len(&self) -> usize {
+        self.pids.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.pids.is_empty()
+    }
+
+    /// Reads all processes into `stats` (every column resized to [`Processes::len`]).
+    pub fn read(&mut self, stats: &mut ProcessStats) -> Result<()> {
+        let len = self.pids.len();
+        stats.cpu_utilisation.resize(len, -1.0);
+        stats.rss_bytes.resize(len, -1);
+        stats.read_bytes_per_s.resize(len, -1.0);
+        stats.written_bytes_per_s.resize(len, -1.0);
+        if len == 0 {
+            return Ok(());
+        }
+        let count = unsafe {
+            bindings::get_process_stats(
+                self.ptr.as_ptr(),
+                stats.cpu_utilisation.as_mut_ptr(),
+                stats.rss_bytes.as_mut_ptr(),
+                stats.read_bytes_per_s.as_mut_ptr(),
+                stats.written_bytes_per_s.as_mut_ptr(),
+                len as i32,
+            )
+        };
+        if count < 0 {
+            return Err(HwinfoError::DataUnavailable("get_process_stats".into()));
+        }
+        Ok(())
+    }
+}
+
+impl Drop for Processes {
+    fn drop(&mut self) {
+        unsafe { bindings::free_process_sampler(self.ptr.as_ptr()) };
+    }
+}
@@ -0,0 +1,298 @@
+//! Background sampling of the dynamic metrics.
+//!
+//! [`Sampler`] wraps a C++ sampler thread that reads cpu utilisation, per-thread utilisation and
+//! clock speed, free memory, battery charge, per-disk I/O rates, per-interface network traffic
+//! and per-GPU telemetry at a fixed interval into a ring buffer. Consumers
+//! drain whole batches of frames with one FFI call instead of polling the per-call APIs.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result, c_string_array_to_vec};
+use std::ffi::CString;
+use std::ptr::NonNull;
+use std::time::Duration;
+
+/// Metrics of one sampler tick. Values that could not be read are -1.
+pub type MetricFrame = bindings::C_MetricFrame;
+
+/// I/O activity of one disk over the period of a frame. Values that could not be read are -1.
+pub type DiskIoStats = bindings::C_DiskIOStats;
+
+/// Traffic of one network interface over the period of a frame. Values that could not be read
+/// are -1.
+pub type NetworkIoStats = bindings::C_NetworkIOStats;
+
+/// Telemetry of one GPU as of a frame. Values that could not be read are -1.
+pub type GpuStats = bindings::C_GPUStats;
+
+/// Drained frames and their per-thread, per-disk, per-interface and per-GPU values. Reuse a batch (and [`FrameBatch::clear`] it) to
+/// drain without allocating. A batch holds frames of one sampler only.
+#[derive(Debug, Default, Clone)]
+pub struct FrameBatch {
+    pub frames: Vec<MetricFrame>,
+    /// `num_threads` values per frame, in frame order.
+    pub thread_utilizations: Vec<f64>,
+    /// `num_threads` values per frame, in frame order.
+    pub thread_speeds_mhz: Vec<i64>,
+    /// `num_disks` values per frame, in frame order.
+    pub disk_stats: Vec<DiskIoStats>,
+    /// `num_networks` values per frame, in frame order.
+    pub network_stats: Vec<NetworkIoStats>,
+    /// `num_gpus` values per frame, in frame order.
+    pub gpu_stats: Vec<GpuStats>,
+    num_threads: usize,
+    num_disks: usize,
+    num_networks: usize,
+    num_gpus: usize,
+}
+
+impl FrameBatch {
+    pub fn new() -> FrameBatch {
+        FrameBatch::default()
+    }
+
+    pub fn len(&self) -> usize {
+        self.frames.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.frames.is_empty()
+    }
+
+    pub fn clear(&mut self) {
+        self.frames.clear();
+        self.thread_utilizations.clear();
+        self.thread_speeds_mhz.clear();
+        self.disk_stats.clear();
+        self.network_stats.clear();
+        self.gpu_stats.clear();
+    }
+
+    /// Per-thread utilisations of frame `index`.
+    pub fn thread_utilizations_of(&self, index: usize) -> &[f64] {
+        let start = index * self.num_threads;
+        &self.thread_utilizations[start..start + self.num_threads]
+    }
+
+    /// Per-thread clock speeds of frame `index`.
+    pub fn thread_speeds_mhz_of(&self, index: usize) -> &[i64] {
+        let start = index * self.num_threads;
+        &self.thread_speeds_mhz[start..start + self.num_threads]
+    }
+
+    /// Per-disk I/O stats of frame `index`, in the order of [`Sampler::disk_names`].
+    pub fn disk_stats_of(&self, index: usize) -> &[DiskIoStats] {
+        let start = index * self.num_disks;
+        &self.disk_stats[start..start + self.num_disks]
+    }
+
+    /// Per-interface traffic of frame `index`, in the order of [`Sampler::network_indices`].
+    pub fn network_stats_of(&self, index: usize) -> &[NetworkIoStats] {
+        let start = index * self.num_networks;
+        &self.network_stats[start..start + self.num_networks]
+    }
+
+    /// Per-GPU telemetry of frame `index`, in the order of [`Sampler::gpu_bus_ids`].
+    pub fn gpu_stats_of(&self, index: usize) -> &[GpuStats] {
+        let start = index * self.num_gpus;
+        &self.gpu_stats[start..start + self.num_gpus]
+    }
+}
+
+/// A running background sampler. Dropping it stops the sampler thread.
+pub struct Sampler {
+    ptr: NonNull<bindings::C_Sampler>,
+    capacity: usize,
+    num_threads: usize,
+    num_disks: usize,
+    num_networks: usize,
+    num_gpus: usize,
+}
+
+// The C++ sampler serializes concurrent drains and owns its thread.
+unsafe impl Send for Sampler {}
+unsafe impl Sync for Sampler {}
+
+impl Sampler {
+    /// Starts sampling every `interval` into a ring buffer of (at least) `capacity` frames.
+    pub fn new(interval: Duration, capacity: usize) -> Result<Sampler> {
+        let interval_ns = interval.as_nanos().min(i64::MAX as u128) as i64;
+        let capacity = capacity.clamp(2, i32::MAX as usize);
+        let ptr = unsafe { bindings::get_sampler(interval_ns, capacity as i32) };
+        Sampler::from_ptr(ptr, capacity, "get_sampler")
+    }
+
+    /// Like [`Sampler::new`], but also publishes every frame into the shared memory segment
+    /// `name` (a plain identifier), from which other processes read the latest frame with a
+    /// [`crate::shared_frame::SharedFrameReader`]. Frames are published even while the ring
+    /// buffer is full, so a process that only publishes does not need to drain.
+    pub fn publishing(interval: Duration, capacity: usize, name: &str) -> Result<Sampler> {
+        let interval_ns = interval.as_nanos().min(i64::MAX as u128) as i64;
+        let capacity = capacity.clamp(2, i32::MAX as usize);
+        let name = CString::new(name)
+            .map_err(|_| HwinfoError::DataUnavailable("get_publishing_sampler".into()))?;
+        let ptr = unsafe {
+            bindings::get_publishing_sampler(interval_ns, capacity as i32, name.as_ptr())
+        };
+        Sampler::from_ptr(ptr, capacity, "get_publishing_sampler")
+    }
+
+    fn from_ptr(ptr: *mut bindings::C_Sampler, capacity: usize, function: &str) -> Result<Sampler> {
+        let ptr = NonNull::new(ptr).ok_or_else(|| HwinfoError::DataUnavailable(function.into()))?;
+        let num_threads =
+            unsafe { bindings::get_sampler_num_threads(ptr.as_ptr()) }.max(0) as usize;
+        let num_disks = unsafe { bindings::get_sampler_num_disks(ptr.as_ptr()) }.max(0) as usize;
+        let num_networks =
+            unsafe { bindings::get_sampler_num_networks(ptr.as_ptr()) }.max(0) as usize;
+        let num_gpus = unsafe { bindings::get_sampler_num_gpus(ptr.as_ptr()) }.max(0) as usize;
+        Ok(Sampler {
+            ptr,
+            capacity,
+            num_threads,
+            num_disks,
+            num_networks,
+            num_gpus,
+        })
+    }
+
+    /// Number of per-thread values stored for every frame.
+    pub fn num_threads(&self) -> usize {
+        self.num_threads
+    }
+
+    /// Number of per-disk values stored for every frame.
+    pub fn num_disks(&self) -> usize {
+        self.num_disks
+    }
+
+    /// Device names of the sampled disks (e.g. "nvme0n1"), in the order of the per-disk values.
+    pub fn disk_names(&self) -> Result<Vec<String>> {
+        unsafe {
+            let arr_ptr = bindings::get_sampler_disk_names(self.ptr.as_ptr());
+            if arr_ptr.is_null() {
+                return Err(HwinfoError::DataUnavailable(
+                    "get_sampler_disk_names".into(),
+                ));
+            }
+            let result = c_string_array_to_vec(&*arr_ptr);
+            bindings::free_string_array(arr_ptr);
+            result
+        }
+    }
+
+    /// Number of per-interface values stored for every frame.
+    pub fn num_networks(&self) -> usize {
+        self.num_networks
+    }
+
+    /// Interface indices (see [`crate::hwinfo::Network::interface_index`]) of the sampled
+    /// interfaces, in the order of the per-interface values.
+    pub fn network_indices(&self) -> Result<Vec<i32>> {
+        let mut indices = vec![0; self.num_networks];
+        let count = unsafe {
+            bindings::get_sampler_network_indices(
+                self.ptr.as_ptr(),
+                indices.as_mut_ptr(),
+                indices.len() as i32,
+            )
+        };
+        if count < 0 {
+            return Err(HwinfoError::DataUnavailable(
+                "get_sampler_network_indices".into(),
+            ));
+        }
+        indices.truncate(count as usize);
+        Ok(indices)
+    }
+
+    /// Number of per-GPU values stored for every frame.
+    pub fn num_gpus(&self) -> usize {
+        self.num_gpus
+    }
+
+    /// PCI addresses (see [`crate::hwinfo::Gpu::pci_bus_id`]) of the sampled GPUs, in the order
+    /// of the per-GPU values.
+    pub fn gpu_bus_ids(&self) -> Result<Vec<String>> {
+        unsafe {
+            let arr_ptr = bindings::get_sampler_gpu_bus_ids(self.ptr.as_ptr());
+            if arr_ptr.is_null() {
+                return Err(HwinfoError::DataUnavailable(
+                    "get_sampler_gpu_bus_ids".into(),
+                ));
+            }
+            let result = c_string_array_to_vec(&*arr_ptr);
+            bindings::free_string_array(arr_ptr);
+            result
+        }
+    }
+
+    /// Frames discarded because the ring buffer was full.
+    pub fn dropped(&self) -> u64 {
+        unsafe { bindings::get_sampler_dropped(self.ptr.as_ptr()) }
+    }
+
+    /// Appends all buffered frames to `batch` and returns their number.
+    pub fn drain(&self, batch: &mut FrameBatch) -> Result<usize> {
+        batch.num_threads = self.num_threads;
+        batch.num_disks = self.num_disks;
+        batch.num_networks = self.num_networks;
+        batch.num_gpus = self.num_gpus;
+        let mut total = 0;
+        loop {
+            // grows the batch by one ring buffer worth of frames at most
+            let chunk = self.capacity;
+            batch.frames.reserve(chunk);
+            batch.thread_utilizations.reserve(chunk * self.num_threads);
+            batch.thread_speeds_mhz.reserve(chunk * self.num_threads);
+            batch.disk_stats.reserve(chunk * self.num_disks);
+            batch.network_stats.reserve(chunk * self.num_networks);
+            batch.gpu_stats.reserve(chunk * self.num_gpus);
+            let frames = batch.frames.len();
+            let values = frames * self.num_threads;
+            let disk_values = frames * self.num_disks;
+            let network_values = frames * self.num_networks;
+            let gpu_values = frames * self.num_gpus;
+            let count = unsafe {
+                bindings::get_sampler_frames(
+                    self.ptr.as_ptr(),
+                    batch.frames.as_mut_ptr().add(frames),
+                    chunk as i32,
+                    batch.thread_utilizations.as_mut_ptr().add(values),
+                    batch.thread_speeds_mhz.as_mut_ptr().add(values),
+                    batch.disk_stats.as_mut_ptr().add(disk_values),
+                    batch.network_stats.as_mut_ptr().add(network_values),
+                    batch.gpu_stats.as_mut_ptr().add(gpu_values),
+                )
+            };
+            if count < 0 {
+                return Err(HwinfoError::DataUnavailable("get_sampler_frames".into()));
+            }
+            let count = count as usize;
+            unsafe {
+                batch.frames.set_len(frames + count);
+                batch
+                    .thread_utilizations
+                    .set_len(values + count * self.num_threads);
+                batch
+                    .thread_speeds_mhz
+                    .set_len(values + count * self.num_threads);
+                batch
+                    .disk_stats
+                    .set_len(disk_values + count * self.num_disks);
+                batch
+                    .network_stats
+                    .set_len(network_values + count * self.num_networks);
+                batch.gpu_stats.set_len(gpu_values + count * self.num_gpus);
+            }
+            total += count;
+            if count < chunk {
+                return Ok(total);
+            }
+        }
+    }
+}
+
+impl Drop for Sampler {
+    fn drop(&mut self) {
+        unsafe { bindings::free_sampler(self.ptr.as_ptr()) };
+    }
+}
@@ -0,0 +1,131 @@
+//! Temperature, power, fan and voltage sensors.
+//!
+//! [`Sensors`] discovers the sensors once (Linux: hwmon, thermal zones and RAPL; macOS: the SMC;
+//! Windows: ACPI thermal zones) and keeps them open, so reading all of them is one FFI call with
+//! one `pread` per sensor and no processes spawned.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result, c_char_to_string};
+use std::ptr::NonNull;
+
+/// Physical quantity of a sensor and the unit of its values.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum SensorKind {
+    /// °C
+    Temperature,
+    /// W
+    Power,
+    /// RPM
+    Fan,
+    /// V
+    Voltage,
+}
+
+impl SensorKind {
+    fn from_raw(kind: i32) -> SensorKind {
+        // bindgen emits the C enum as u32, or as i32 on MSVC targets
+        const POWER: i32 = bindings::C_SensorKind_C_SENSOR_POWER as i32;
+        const FAN: i32 = bindings::C_SensorKind_C_SENSOR_FAN as i32;
+        const VOLTAGE: i32 = bindings::C_SensorKind_C_SENSOR_VOLTAGE as i32;
+        match kind {
+            POWER => SensorKind::Power,
+            FAN => SensorKind::Fan,
+            VOLTAGE => SensorKind::Voltage,
+            _ => SensorKind::Temperature,
+        }
+    }
+}
+
+/// Static description of a sensor.
+#[derive(Debug, Clone)]
+pub struct Sensor {
+    pub kind: SensorKind,
+    /// Driver of the value: "coretemp", "k10temp", "thermal", "rapl", "smc", ...
+    pub chip: String,
+    /// Channel label as reported by the driver ("Package id 0", "package-0/dram"), the SMC key on
+    /// macOS.
+    pub label: String,
+    /// CPU package the sensor belongs to, `None` if unknown or not a cpu sensor.
+    pub socket: Option<u32>,
+}
+
+/// Opened sensors; read them with [`Sensors::read`].
+pub struct Sensors {
+    ptr: NonNull<bindings::C_SensorSampler>,
+    sensors: Vec<Sensor>,
+}
+
+// The sampler is not tied to the creating thread; `read` takes `&mut self`.
+unsafe impl Send for Sensors {}
+
+impl Sensors {
+    /// Discovers all sensors.
+    pub fn new() -> Result<Sensors> {
+        let ptr = unsafe { bindings::get_sensor_sampler() };
+        let ptr = NonNull::new(ptr)
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_sensor_sampler".into()))?;
+        // freed by Drop if the description cannot be read
+        let mut result = Sensors {
+            ptr,
+            sensors: Vec::new(),
+        };
+        unsafe {
+            let arr_ptr = bindings::get_sensors(ptr.as_ptr());
+            if arr_ptr.is_null() {
+                return Err(HwinfoError::DataUnavailable("get_sensors".into()));
+            }
+            let arr = &*arr_ptr;
+            let sensors: Result<Vec<Sensor>> = if arr.sensors.is_null() || arr.count <= 0 {
+                Ok(Vec::new())
+            } else {
+                std::slice::from_raw_parts(arr.sensors, arr.count as usize)
+                    .iter()
+                    .map(|s| {
+                        Ok(Sensor {
+                            kind: SensorKind::from_raw(s.kind),
+                            chip: c_char_to_string(s.chip)?,
+                            label: c_char_to_string(s.label)?,
+                            socket: u32::try_from(s.socket).ok(),
+                        })
+                    })
+                    .collect()
+            };
+            bindings::free_sensor_array(arr_ptr);
+            result.sensors = sensors?;
+        }
+        Ok(result)
+    }
+
+    /// The sensors, in the order of the values of [`Sensors::read`].
+    pub fn sensors(&self) -> &[Sensor] {
+        &self.sensors
+    }
+
+    pub fn len(&self) -> usize {
+        self.sensors.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.sensors.is_empty()
+    }
+
+    /// Reads all sensors into `values` (resized to [`Sensors::len`]), in the unit of their kind.
+    /// Sensors that could not be read are NaN, as is the power of energy counters (RAPL) on the
+    /// first read: it is the mean since the previous read.
+    pub fn read(&mut self, values: &mut Vec<f64>) -> Result<()> {
+        values.resize(self.sensors.len(), f64::NAN);
+        let count = unsafe {
+            bindings::get_sensor_values(self.ptr.as_ptr(), values.as_mut_ptr(), values.len() as i32)
+        };
+        if count < 0 {
+            return Err(HwinfoError::DataUnavailable("get_sensor_values".into()));
+        }
+        Ok(())
+    }
+}
+
+impl Drop for Sensors {
+    fn drop(&mut self) {
+        unsafe { bindings::free_sensor_sampler(self.ptr.as_ptr()) };
+    }
+}
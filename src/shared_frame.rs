@@ -0,0 +1,188 @@
+//! Frames of a sampler in another process, read from shared memory.
+//!
+//! A [`crate::sampler::Sampler::publishing`] sampler writes its latest frame into a named shared
+//! memory segment protected by a seqlock. [`SharedFrameReader`] maps the segment read-only, and
+//! [`SharedFrameReader::read`] copies the latest consistent frame without a system call, so many
+//! local processes share one sampler instead of each polling `/proc` and sysfs.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result, c_string_array_to_vec};
+use crate::sampler::{DiskIoStats, GpuStats, MetricFrame, NetworkIoStats};
+use std::ffi::CString;
+use std::ptr::NonNull;
+
+/// The latest frame of a publisher and its per-thread, per-disk, per-interface and per-GPU
+/// values. Create it with [`SharedFrameReader::frame`] and reuse it for every read.
+#[derive(Debug, Clone)]
+pub struct SharedFrame {
+    pub frame: MetricFrame,
+    /// `num_threads` values.
+    pub thread_utilizations: Vec<f64>,
+    /// `num_threads` values.
+    pub thread_speeds_mhz: Vec<i64>,
+    /// In the order of [`SharedFrameReader::disk_names`].
+    pub disk_stats: Vec<DiskIoStats>,
+    /// In the order of [`SharedFrameReader::network_indices`].
+    pub network_stats: Vec<NetworkIoStats>,
+    /// In the order of [`SharedFrameReader::gpu_bus_ids`].
+    pub gpu_stats: Vec<GpuStats>,
+}
+
+/// Read-only mapping of the segment of a publishing sampler.
+pub struct SharedFrameReader {
+    ptr: NonNull<bindings::C_SharedFrameReader>,
+    num_threads: usize,
+    num_disks: usize,
+    num_networks: usize,
+    num_gpus: usize,
+}
+
+// Reads are lock-free copies out of the read-only mapping.
+unsafe impl Send for SharedFrameReader {}
+unsafe impl Sync for SharedFrameReader {}
+
+impl SharedFrameReader {
+    /// Maps the segment `name`. Fails if no sampler publishes under that name.
+    pub fn new(name: &str) -> Result<SharedFrameReader> {
+        let name = CString::new(name)
+            .map_err(|_| HwinfoError::DataUnavailable("get_shared_frame_reader".into()))?;
+        let ptr = unsafe { bindings::get_shared_frame_reader(name.as_ptr()) };
+        let ptr = NonNull::new(ptr)
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_shared_frame_reader".into()))?;
+        unsafe {
+            Ok(SharedFrameReader {
+                num_threads: bindings::get_shared_frame_num_threads(ptr.as_ptr()).max(0) as usize,
+                num_disks: bindings::get_shared_frame_num_disks(ptr.as_ptr()).max(0) as usize,
+                num_networks: bindings::get_shared_frame_num_networks(ptr.as_ptr()).max(0) as usize,
+                num_gpus: bindings::get_shared_frame_num_gpus(ptr.as_ptr()).max(0) as usize,
+                ptr,
+            })
+        }
+    }
+
+    pub fn num_threads(&self) -> usize {
+        self.num_threads
+    }
+
+    pub fn num_disks(&self) -> usize {
+        self.num_disks
+    }
+
+    /// Device names of the published disks, in the order of the per-disk values.
+    pub fn disk_names(&self) -> Result<Vec<String>> {
+        unsafe {
+            let arr_ptr = bindings::get_shared_frame_disk_names(self.ptr.as_ptr());
+            if arr_ptr.is_null() {
+                return Err(HwinfoError::DataUnavailable(
+                    "get_shared_frame_disk_names".into(),
+                ));
+            }
+            let result = c_string_array_to_vec(&*arr_ptr);
+            bindings::free_string_array(arr_ptr);
+            result
+        }
+    }
+
+    pub fn num_networks(&self) -> usize {
+        self.num_networks
+    }
+
+    /// Interface indices of the published interfaces, in the order of the per-interface values.
+    pub fn network_indices(&self) -> Result<Vec<i32>> {
+        let mut indices = vec![0; self.num_networks];
+        let count = unsafe {
+            bindings::get_shared_frame_network_indices(
+                self.ptr.as_ptr(),
+                indices.as_mut_ptr(),
+                indices.len() as i32,
+            )
+        };
+        if count < 0 {
+            return Err(HwinfoError::DataUnavailable(
+                "get_shared_frame_network_indices".into(),
+            ));
+        }
+        indices.truncate(count as usize);
+        Ok(indices)
+    }
+
+    pub fn num_gpus(&self) -> usize {
+        self.num_gpus
+    }
+
+    /// PCI addresses of the published GPUs, in the order of the per-GPU values.
+    pub fn gpu_bus_ids(&self) -> Result<Vec<String>> {
+        unsafe {
+            let arr_ptr = bindings::get_shared_frame_gpu_bus_ids(self.ptr.as_ptr());
+            if arr_ptr.is_null() {
+                return Err(HwinfoError::DataUnavailable(
+                    "get_shared_frame_gpu_bus_ids".into(),
+                ));
+            }
+            let result = c_string_array_to_vec(&*arr_ptr);
+            bindings::free_string_array(arr_ptr);
+            result
+        }
+    }
+
+    /// Number of frames published so far; [`SharedFrameReader::read`] only finds a new frame if
+    /// this changed.
+    pub fn published(&self) -> u64 {
+        unsafe { bindings::get_shared_frame_published(self.ptr.as_ptr()) }
+    }
+
+    /// A frame with buffers of the layout of this segment, for [`SharedFrameReader::read`].
+    pub fn frame(&self) -> SharedFrame {
+        SharedFrame {
+            // plain integers and floats, overwritten by the first successful read
+            frame: unsafe { std::mem::zeroed() },
+            thread_utilizations: vec![-1.0; self.num_threads],
+            thread_speeds_mhz: vec![-1; self.num_threads],
+            disk_stats: Vec::with_capacity(self.num_disks),
+            network_stats: Vec::with_capacity(self.num_networks),
+            gpu_stats: Vec::with_capacity(self.num_gpus),
+        }
+    }
+
+    /// Copies the latest frame into `out`. Returns `Ok(false)` if nothing was published yet or
+    /// the frame kept changing while it was copied, and an error once the publisher exited
+    /// (create a new reader to follow its successor).
+    pub fn read(&self, out: &mut SharedFrame) -> Result<bool> {
+        out.thread_utilizations.resize(self.num_threads, -1.0);
+        out.thread_speeds_mhz.resize(self.num_threads, -1);
+        out.disk_stats
+            .reserve(self.num_disks.saturating_sub(out.disk_stats.len()));
+        out.network_stats
+            .reserve(self.num_networks.saturating_sub(out.network_stats.len()));
+        out.gpu_stats
+            .reserve(self.num_gpus.saturating_sub(out.gpu_stats.len()));
+        let result = unsafe {
+            bindings::get_shared_frame(
+                self.ptr.as_ptr(),
+                &mut out.frame,
+                out.thread_utilizations.as_mut_ptr(),
+                out.thread_speeds_mhz.as_mut_ptr(),
+                out.disk_stats.as_mut_ptr(),
+                out.network_stats.as_mut_ptr(),
+                out.gpu_stats.as_mut_ptr(),
+            )
+        };
+        if result < 0 {
+            return Err(HwinfoError::DataUnavailable("get_shared_frame".into()));
+        }
+        if result > 0 {
+            unsafe {
+                out.disk_stats.set_len(self.num_disks);
+                out.network_stats.set_len(self.num_networks);
+                out.gpu_stats.set_len(self.num_gpus);
+            }
+        }
+        Ok(result > 0)
+    }
+}
+
+impl Drop for SharedFrameReader {
+    fn drop(&mut self) {
+        unsafe { bindings::free_shared_frame_reader(self.ptr.as_ptr()) };
+    }
+}
@@ -0,0 +1,584 @@
+//! Borrowed, zero-copy access to a system snapshot.
+//!
+//! [`Snapshot`] owns the single allocation returned by `get_system_snapshot` and hands out views
+//! whose strings are `&str` borrowed from that allocation. Nothing is copied until a view is
+//! converted with `into_owned()`.
+//!
+//! [`Snapshot::new_async`] collects on the worker pool of the C library instead and returns a
+//! [`SnapshotFuture`] that can be awaited on any executor.
+
+use crate::bindings;
+use crate::cpu_features::CpuFeatures;
+use crate::hwinfo::{
+    Battery, Components, Cpu, Disk, Gpu, HwinfoError, MainBoard, MemoryInfo, Network, Os,
+    RamModule, Result,
+};
+use std::convert::TryFrom;
+use std::ffi::CStr;
+use std::fmt;
+use std::future::Future;
+use std::marker::PhantomData;
+use std::os::raw::{c_char, c_void};
+use std::pin::Pin;
+use std::ptr::NonNull;
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Waker};
+use std::time::Duration;
+
+/// Borrows a C string for the lifetime `'a`.
+unsafe fn c_char_to_str<'a>(s: *const c_char) -> Result<&'a str> {
+    if s.is_null() {
+        Ok("")
+    } else {
+        unsafe {
+            CStr::from_ptr(s)
+                .to_str()
+                .map_err(HwinfoError::InvalidString)
+        }
+    }
+}
+
+/// Borrows a C array of `count` elements for the lifetime `'a`.
+unsafe fn c_array<'a, T>(ptr: *const T, count: i32) -> &'a [T] {
+    if ptr.is_null() || count <= 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(ptr, count as usize) }
+    }
+}
+
+/// Owns a `C_SystemSnapshot` and frees it on drop. All views borrow from it.
+pub struct Snapshot {
+    ptr: NonNull<bindings::C_SystemSnapshot>,
+}
+
+// The snapshot is immutable after creation and not tied to the creating thread.
+unsafe impl Send for Snapshot {}
+unsafe impl Sync for Snapshot {}
+
+impl Snapshot {
+    /// Gathers the selected components with one FFI call.
+    pub fn new(components: Components) -> Result<Snapshot> {
+        let ptr = unsafe { bindings::get_system_snapshot(components.bits()) };
+        NonNull::new(ptr)
+            .map(|ptr| Snapshot { ptr })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_system_snapshot".into()))
+    }
+
+    /// Gathers the selected components without blocking the calling thread. The future resolves
+    /// to an error if the collection fails or takes longer than `timeout`.
+    pub fn new_async(components: Components, timeout: Option<Duration>) -> SnapshotFuture {
+        let state = Arc::new(Mutex::new(AsyncState::default()));
+        let timeout_ms = timeout.map_or(0, |timeout| {
+            timeout.as_millis().clamp(1, i64::MAX as u128) as i64
+        });
+        let user_data = Arc::into_raw(state.clone()) as *mut c_void;
+        let started = unsafe {
+            bindings::get_system_snapshot_async(
+                components.bits(),
+                timeout_ms,
+                Some(snapshot_ready),
+                user_data,
+            )
+        };
+        if started != 0 {
+            // the callback is never called, take back its reference
+            drop(unsafe { Arc::from_raw(user_data as *const Mutex<AsyncState>) });
+            lock(&state).result = Some(Err(HwinfoError::DataUnavailable(
+                "get_system_snapshot_async".into(),
+            )));
+        }
+        SnapshotFuture { state }
+    }
+
+    fn raw(&self) -> &bindings::C_SystemSnapshot {
+        unsafe { self.ptr.as_ref() }
+    }
+
+    pub fn cpus(&self) -> impl ExactSizeIterator<Item = CpuRef<'_>> {
+        let raw = self.raw();
+        unsafe { c_array(raw.cpus, raw.cpu_count) }
+            .iter()
+            .map(|raw| CpuRef { raw })
+    }
+
+    pub fn os(&self) -> Option<OsRef<'_>> {
+        unsafe { self.raw().os.as_ref() }.map(|raw| OsRef { raw })
+    }
+
+    pub fn gpus(&self) -> impl ExactSizeIterator<Item = GpuRef<'_>> {
+        let raw = self.raw();
+        unsafe { c_array(raw.gpus, raw.gpu_count) }
+            .iter()
+            .map(|raw| GpuRef { raw })
+    }
+
+    pub fn memory(&self) -> Option<MemoryInfoRef<'_>> {
+        unsafe { self.raw().memory.as_ref() }.map(|raw| MemoryInfoRef { raw })
+    }
+
+    pub fn mainboard(&self) -> Option<MainBoardRef<'_>> {
+        unsafe { self.raw().mainboard.as_ref() }.map(|raw| MainBoardRef { raw })
+    }
+
+    pub fn disks(&self) -> impl ExactSizeIterator<Item = DiskRef<'_>> {
+        let raw = self.raw();
+        unsafe { c_array(raw.disks, raw.disk_count) }
+            .iter()
+            .map(|raw| DiskRef { raw })
+    }
+
+    pub fn batteries(&self) -> impl ExactSizeIterator<Item = BatteryRef<'_>> {
+        let raw = self.raw();
+        unsafe { c_array(raw.batteries, raw.battery_count) }
+            .iter()
+            .map(|raw| BatteryRef { raw })
+    }
+
+    pub fn networks(&self) -> impl ExactSizeIterator<Item = NetworkRef<'_>> {
+        let raw = self.raw();
+        unsafe { c_array(raw.networks, raw.network_count) }
+            .iter()
+            .map(|raw| NetworkRef { raw })
+    }
+
+    /// Copies everything into an owned [`SystemSnapshot`](crate::hwinfo::SystemSnapshot).
+    pub fn to_owned_snapshot(&self) -> Result<crate::hwinfo::SystemSnapshot> {
+        crate::hwinfo::SystemSnapshot::try_from(self.raw())
+    }
+}
+
+impl Drop for Snapshot {
+    fn drop(&mut self) {
+        unsafe { bindings::free_system_snapshot(self.ptr.as_ptr()) }
+    }
+}
+
+impl fmt::Debug for Snapshot {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("Snapshot")
+            .field("flags", &self.raw().flags)
+            .finish()
+    }
+}
+
+#[derive(Default)]
+struct AsyncState {
+    result: Option<Result<Snapshot>>,
+    waker: Option<Waker>,
+}
+
+fn lock(state: &Mutex<AsyncState>) -> std::sync::MutexGuard<'_, AsyncState> {
+    // never panics, the callback runs on a C++ thread
+    state
+        .lock()
+        .unwrap_or_else(|poisoned| poisoned.into_inner())
+}
+
+/// Completion callback of `get_system_snapshot_async`, owns one reference of the state.
+unsafe extern "C" fn snapshot_ready(
+    snapshot: *mut bindings::C_SystemSnapshot,
+    user_data: *mut c_void,
+) {
+    let state = unsafe { Arc::from_raw(user_data as *const Mutex<AsyncState>) };
+    let result = NonNull::new(snapshot)
+        .map(|ptr| Snapshot { ptr })
+        .ok_or_else(|| HwinfoError::DataUnavailable("get_system_snapshot_async".into()));
+    let waker = {
+        let mut state = lock(&state);
+        state.result = Some(result);
+        state.waker.take()
+    };
+    if let Some(waker) = waker {
+        waker.wake();
+    }
+}
+
+/// Pending [`Snapshot::new_async`]. The collection runs whether or not the future is polled;
+/// dropping it discards the result.
+pub struct SnapshotFuture {
+    state: Arc<Mutex<AsyncState>>,
+}
+
+impl Future for SnapshotFuture {
+    type Output = Result<Snapshot>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let mut state = lock(&self.state);
+        match state.result.take() {
+            Some(result) => Poll::Ready(result),
+            None => {
+                state.waker = Some(cx.waker().clone());
+                Poll::Pending
+            }
+        }
+    }
+}
+
+impl fmt::Debug for SnapshotFuture {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("SnapshotFuture")
+            .field("ready", &lock(&self.state).result.is_some())
+            .finish()
+    }
+}
+
+/// Borrowed view of a `C_StringArray` (CPU flags, disk volumes).
+#[derive(Clone, Copy)]
+pub struct StrArray<'a> {
+    strings: &'a [*mut c_char],
+    _snapshot: PhantomData<&'a Snapshot>,
+}
+
+impl<'a> StrArray<'a> {
+    unsafe fn new(arr: &'a bindings::C_StringArray) -> StrArray<'a> {
+        StrArray {
+            strings: unsafe { c_array(arr.strings, arr.count) },
+            _snapshot: PhantomData,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.strings.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.strings.is_empty()
+    }
+
+    pub fn get(&self, index: usize) -> Option<Result<&'a str>> {
+        self.strings
+            .get(index)
+            .map(|&s| unsafe { c_char_to_str(s) })
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = Result<&'a str>> + 'a {
+        self.strings.iter().map(|&s| unsafe { c_char_to_str(s) })
+    }
+
+    /// Collects the borrowed strings, e.g. to pass them on as `&[&str]`.
+    pub fn to_vec(&self) -> Result<Vec<&'a str>> {
+        self.iter().collect()
+    }
+}
+
+impl fmt::Debug for StrArray<'_> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_list().entries(self.iter()).finish()
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct CpuRef<'a> {
+    raw: &'a bindings::C_CPU,
+}
+
+impl<'a> CpuRef<'a> {
+    pub fn id(&self) -> i32 {
+        self.raw.id
+    }
+    pub fn vendor(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.vendor) }
+    }
+    pub fn model_name(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.modelName) }
+    }
+    pub fn num_physical_cores(&self) -> i32 {
+        self.raw.numPhysicalCores
+    }
+    pub fn num_logical_cores(&self) -> i32 {
+        self.raw.numLogicalCores
+    }
+    pub fn max_clock_speed_mhz(&self) -> i64 {
+        self.raw.maxClockSpeed_MHz
+    }
+    pub fn regular_clock_speed_mhz(&self) -> i64 {
+        self.raw.regularClockSpeed_MHz
+    }
+    pub fn l1_cache_size_bytes(&self) -> i64 {
+        self.raw.L1CacheSize_Bytes
+    }
+    pub fn l2_cache_size_bytes(&self) -> i64 {
+        self.raw.L2CacheSize_Bytes
+    }
+    pub fn l3_cache_size_bytes(&self) -> i64 {
+        self.raw.L3CacheSize_Bytes
+    }
+    pub fn flags(&self) -> StrArray<'a> {
+        unsafe { StrArray::new(&self.raw.flags) }
+    }
+    pub fn features(&self) -> CpuFeatures {
+        CpuFeatures::from_bits(self.raw.features)
+    }
+    pub fn into_owned(self) -> Result<Cpu> {
+        Cpu::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct OsRef<'a> {
+    raw: &'a bindings::C_OS,
+}
+
+impl<'a> OsRef<'a> {
+    pub fn name(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.name) }
+    }
+    pub fn version(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.version) }
+    }
+    pub fn kernel(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.kernel) }
+    }
+    pub fn is_32bit(&self) -> bool {
+        self.raw.is32bit
+    }
+    pub fn is_64bit(&self) -> bool {
+        self.raw.is64bit
+    }
+    pub fn is_little_endian(&self) -> bool {
+        self.raw.isLittleEndian
+    }
+    pub fn into_owned(self) -> Result<Os> {
+        Os::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct GpuRef<'a> {
+    raw: &'a bindings::C_GPU,
+}
+
+impl<'a> GpuRef<'a> {
+    pub fn id(&self) -> i32 {
+        self.raw.id
+    }
+    pub fn vendor(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.vendor) }
+    }
+    pub fn name(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.name) }
+    }
+    pub fn driver_version(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.driverVersion) }
+    }
+    pub fn memory_bytes(&self) -> i64 {
+        self.raw.memory_Bytes
+    }
+    pub fn frequency_mhz(&self) -> i64 {
+        self.raw.frequency_MHz
+    }
+    pub fn num_cores(&self) -> i32 {
+        self.raw.num_cores
+    }
+    pub fn vendor_id(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.vendor_id) }
+    }
+    pub fn device_id(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.device_id) }
+    }
+    /// PCI address ("0000:01:00.0"), empty where unknown (only Linux reports it).
+    pub fn pci_bus_id(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.pciBusId) }
+    }
+    pub fn into_owned(self) -> Result<Gpu> {
+        Gpu::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct RamModuleRef<'a> {
+    raw: &'a bindings::C_RAM_Module,
+}
+
+impl<'a> RamModuleRef<'a> {
+    pub fn id(&self) -> i32 {
+        self.raw.id
+    }
+    pub fn vendor(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.vendor) }
+    }
+    pub fn name(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.name) }
+    }
+    pub fn model(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.model) }
+    }
+    pub fn serial_number(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.serial_number) }
+    }
+    pub fn total_bytes(&self) -> i64 {
+        self.raw.total_Bytes
+    }
+    pub fn frequency_hz(&self) -> i64 {
+        self.raw.frequency_Hz
+    }
+    pub fn into_owned(self) -> Result<RamModule> {
+        RamModule::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct MemoryInfoRef<'a> {
+    raw: &'a bindings::C_MemoryInfo,
+}
+
+impl<'a> MemoryInfoRef<'a> {
+    pub fn total_bytes(&self) -> i64 {
+        self.raw.total_Bytes
+    }
+    pub fn free_bytes(&self) -> i64 {
+        self.raw.free_Bytes
+    }
+    pub fn available_bytes(&self) -> i64 {
+        self.raw.available_Bytes
+    }
+    pub fn modules(&self) -> impl ExactSizeIterator<Item = RamModuleRef<'a>> + 'a {
+        unsafe { c_array(self.raw.modules, self.raw.module_count) }
+            .iter()
+            .map(|raw| RamModuleRef { raw })
+    }
+    pub fn into_owned(self) -> Result<MemoryInfo> {
+        MemoryInfo::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct MainBoardRef<'a> {
+    raw: &'a bindings::C_MainBoard,
+}
+
+impl<'a> MainBoardRef<'a> {
+    pub fn vendor(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.vendor) }
+    }
+    pub fn name(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.name) }
+    }
+    pub fn version(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.version) }
+    }
+    pub fn serial_number(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.serialNumber) }
+    }
+    pub fn into_owned(self) -> Result<MainBoard> {
+        MainBoard::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct DiskRef<'a> {
+    raw: &'a bindings::C_Disk,
+}
+
+impl<'a> DiskRef<'a> {
+    pub fn id(&self) -> i32 {
+        self.raw.id
+    }
+    pub fn vendor(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.vendor) }
+    }
+    pub fn model(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.model) }
+    }
+    pub fn serial_number(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.serialNumber) }
+    }
+    pub fn size_bytes(&self) -> i64 {
+        self.raw.size_Bytes
+    }
+    pub fn free_size_bytes(&self) -> i64 {
+        self.raw.free_size_Bytes
+    }
+    pub fn volumes(&self) -> StrArray<'a> {
+        unsafe { StrArray::new(&self.raw.volumes) }
+    }
+    pub fn into_owned(self) -> Result<Disk> {
+        Disk::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct BatteryRef<'a> {
+    raw: &'a bindings::C_Battery,
+}
+
+impl<'a> BatteryRef<'a> {
+    pub fn id(&self) -> i32 {
+        self.raw.id
+    }
+    pub fn vendor(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.vendor) }
+    }
+    pub fn model(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.model) }
+    }
+    pub fn serial_number(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.serialNumber) }
+    }
+    pub fn technology(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.technology) }
+    }
+    pub fn energy_full(&self) -> u32 {
+        self.raw.energyFull
+    }
+    pub fn energy_now(&self) -> u32 {
+        self.raw.energyNow
+    }
+    pub fn charging(&self) -> bool {
+        self.raw.charging
+    }
+    /// -1 if not reported.
+    pub fn power_now(&self) -> i64 {
+        self.raw.powerNow
+    }
+    /// -1 if not reported.
+    pub fn voltage_now(&self) -> i64 {
+        self.raw.voltageNow
+    }
+    /// Charge in percent of [`energy_full`](Self::energy_full), -1 if not reported.
+    pub fn capacity_percent(&self) -> i32 {
+        self.raw.capacity
+    }
+    /// -1 if not reported.
+    pub fn cycle_count(&self) -> i64 {
+        self.raw.cycleCount
+    }
+    pub fn into_owned(self) -> Result<Battery> {
+        Battery::try_from(self.raw)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct NetworkRef<'a> {
+    raw: &'a bindings::C_Network,
+}
+
+impl<'a> NetworkRef<'a> {
+    pub fn interface_index(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.interfaceIndex) }
+    }
+    pub fn description(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.description) }
+    }
+    pub fn mac(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.mac) }
+    }
+    pub fn ip4(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.ip4) }
+    }
+    pub fn ip6(&self) -> Result<&'a str> {
+        unsafe { c_char_to_str(self.raw.ip6) }
+    }
+    /// All IPv4 addresses; [`ip4`](Self::ip4) is the first of them.
+    pub fn ip4s(&self) -> StrArray<'a> {
+        unsafe { StrArray::new(&self.raw.ip4s) }
+    }
+    /// All IPv6 addresses; [`ip6`](Self::ip6) is the link-local one (or the first).
+    pub fn ip6s(&self) -> StrArray<'a> {
+        unsafe { StrArray::new(&self.raw.ip6s) }
+    }
+    pub fn into_owned(self) -> Result<Network> {
+        Network::try_from(self.raw)
+    }
+}
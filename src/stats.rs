@@ -0,0 +1,86 @@
+//! Per-collector latency and I/O counters of the library.
+//!
+//! Only recorded when the crate is built with the `trace` feature (the `HWINFO_TRACE` option of the
+//! C++ library); without it the hooks are compiled out and [`stats`] fails. Every thread counts into
+//! a block of its own without locks, [`stats`] sums them.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result, c_char_to_string};
+
+/// Counters of one collector (an enumeration like `get_all_cpus` or a sampler read) since the start
+/// of the process or the last [`reset_stats`], summed over all threads.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct CollectorStats {
+    /// e.g. "cpu", "disk_stats"
+    pub name: String,
+    pub calls: u64,
+    /// Includes nested collectors, e.g. the topology read of the first cpu enumeration.
+    pub wall_ns: u64,
+    /// Files and directories opened (Linux).
+    pub files_opened: u64,
+    /// Bytes returned by read syscalls of the opened files (Linux).
+    pub bytes_read: u64,
+    /// WMI queries executed (Windows).
+    pub wmi_queries: u64,
+    /// C++ `operator new` calls.
+    pub allocations: u64,
+}
+
+/// One entry per collector, also for the ones that were not called. Fails without the `trace`
+/// feature.
+pub fn stats() -> Result<Vec<CollectorStats>> {
+    let ptr = unsafe { bindings::get_collector_stats() };
+    if ptr.is_null() {
+        return Err(HwinfoError::DataUnavailable("get_collector_stats".into()));
+    }
+    let stats: Result<Vec<CollectorStats>> = unsafe {
+        let arr = &*ptr;
+        if arr.collectors.is_null() || arr.count <= 0 {
+            Ok(Vec::new())
+        } else {
+            std::slice::from_raw_parts(arr.collectors, arr.count as usize)
+                .iter()
+                .map(|c| {
+                    Ok(CollectorStats {
+                        name: c_char_to_string(c.name)?,
+                        calls: c.calls.max(0) as u64,
+                        wall_ns: c.wall_ns.max(0) as u64,
+                        files_opened: c.files_opened.max(0) as u64,
+                        bytes_read: c.bytes_read.max(0) as u64,
+                        wmi_queries: c.wmi_queries.max(0) as u64,
+                        allocations: c.allocations.max(0) as u64,
+                    })
+                })
+                .collect()
+        }
+    };
+    unsafe { bindings::free_collector_stats(ptr) };
+    stats
+}
+
+/// Starts the counters of [`stats`] from zero.
+pub fn reset_stats() {
+    unsafe { bindings::hwinfo_reset_stats() };
+}
+
+/// Records a Chrome trace event (opens in Perfetto and `chrome://tracing`) for every collector call
+/// until [`stop_trace`] writes them to `path`. Fails without the `trace` feature or if a trace is
+/// already being recorded.
+pub fn start_trace(path: &std::path::Path) -> Result<()> {
+    let path = path
+        .to_str()
+        .and_then(|path| std::ffi::CString::new(path).ok())
+        .ok_or_else(|| HwinfoError::DataUnavailable("hwinfo_start_trace".into()))?;
+    if unsafe { bindings::hwinfo_start_trace(path.as_ptr()) } != 0 {
+        return Err(HwinfoError::DataUnavailable("hwinfo_start_trace".into()));
+    }
+    Ok(())
+}
+
+/// Writes the trace started by [`start_trace`].
+pub fn stop_trace() -> Result<()> {
+    if unsafe { bindings::hwinfo_stop_trace() } != 0 {
+        return Err(HwinfoError::DataUnavailable("hwinfo_stop_trace".into()));
+    }
+    Ok(())
+}
@@ -0,0 +1,115 @@
+//! Per-thread cpu counters in structure-of-arrays layout.
+//!
+//! [`ThreadMetrics`] owns one `get_thread_metrics` block: every metric is a contiguous, aligned
+//! column indexed by the OS cpu id, so aggregations run over plain slices with a single FFI call
+//! per sample.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result};
+use std::ptr::NonNull;
+
+/// Borrows a C column of `count` values.
+unsafe fn column<'a, T>(ptr: *const T, count: i32) -> &'a [T] {
+    if ptr.is_null() || count <= 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(ptr, count as usize) }
+    }
+}
+
+/// Counters of all threads at one point in time. Jiffies are cumulative; `user` includes nice and
+/// `irq` includes softirq. Values that could not be read are -1.
+pub struct ThreadMetrics {
+    ptr: NonNull<bindings::C_ThreadMetrics>,
+}
+
+// The block is immutable after creation and not tied to the creating thread.
+unsafe impl Send for ThreadMetrics {}
+unsafe impl Sync for ThreadMetrics {}
+
+impl ThreadMetrics {
+    /// Reads all columns. Only supported on Linux.
+    pub fn new() -> Result<ThreadMetrics> {
+        let ptr = unsafe { bindings::get_thread_metrics() };
+        NonNull::new(ptr)
+            .map(|ptr| ThreadMetrics { ptr })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_thread_metrics".into()))
+    }
+
+    fn raw(&self) -> &bindings::C_ThreadMetrics {
+        unsafe { self.ptr.as_ref() }
+    }
+
+    pub fn len(&self) -> usize {
+        self.raw().count.max(0) as usize
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// `std::chrono::steady_clock` time of the read.
+    pub fn timestamp_ns(&self) -> i64 {
+        self.raw().timestamp_ns
+    }
+
+    /// One past the largest NUMA node id in [`ThreadMetrics::node`].
+    pub fn num_nodes(&self) -> usize {
+        self.raw().num_nodes.max(0) as usize
+    }
+
+    pub fn user(&self) -> &[i64] {
+        unsafe { column(self.raw().user, self.raw().count) }
+    }
+
+    pub fn system(&self) -> &[i64] {
+        unsafe { column(self.raw().system, self.raw().count) }
+    }
+
+    pub fn idle(&self) -> &[i64] {
+        unsafe { column(self.raw().idle, self.raw().count) }
+    }
+
+    pub fn iowait(&self) -> &[i64] {
+        unsafe { column(self.raw().iowait, self.raw().count) }
+    }
+
+    pub fn irq(&self) -> &[i64] {
+        unsafe { column(self.raw().irq, self.raw().count) }
+    }
+
+    pub fn frequency_mhz(&self) -> &[i64] {
+        unsafe { column(self.raw().frequency_MHz, self.raw().count) }
+    }
+
+    pub fn node(&self) -> &[i32] {
+        unsafe { column(self.raw().node, self.raw().count) }
+    }
+
+    /// Busy share ([0, 1]) of every thread since `previous`, -1 for threads without a valid
+    /// period. Writes into `out` and reuses its allocation.
+    pub fn utilizations_since(&self, previous: &ThreadMetrics, out: &mut Vec<f64>) {
+        let (user0, system0, irq0) = (previous.user(), previous.system(), previous.irq());
+        let (idle0, iowait0) = (previous.idle(), previous.iowait());
+        let (user1, system1, irq1) = (self.user(), self.system(), self.irq());
+        let (idle1, iowait1) = (self.idle(), self.iowait());
+        let count = previous.len().min(self.len());
+        out.clear();
+        out.extend((0..count).map(|i| {
+            let busy =
+                ((user1[i] + system1[i] + irq1[i]) - (user0[i] + system0[i] + irq0[i])) as f64;
+            let all = busy + ((idle1[i] + iowait1[i]) - (idle0[i] + iowait0[i])) as f64;
+            if all > 0.0 && busy >= 0.0 && user0[i] >= 0 && user1[i] >= 0 {
+                busy / all
+            } else {
+                -1.0
+            }
+        }));
+    }
+}
+
+impl Drop for ThreadMetrics {
+    fn drop(&mut self) {
+        unsafe { bindings::free_thread_metrics(self.ptr.as_ptr()) }
+    }
+}
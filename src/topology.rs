@@ -0,0 +1,135 @@
+//! Processor topology: logical cpu -> core -> last level cache domain -> NUMA node -> socket.
+//!
+//! [`Topology`] copies the process wide index of `get_topology` once. Every column is indexed by
+//! the OS cpu id (the id used by `sched_setaffinity` and `/proc/stat`); cpus that are not online
+//! are -1.
+
+use crate::bindings;
+use crate::hwinfo::{HwinfoError, Result};
+use std::ptr::NonNull;
+
+/// Borrows a C column of `count` values.
+unsafe fn column<'a>(ptr: *const i32, count: i32) -> &'a [i32] {
+    if ptr.is_null() || count <= 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(ptr, count as usize) }
+    }
+}
+
+/// Cores, cache domains and sockets are numbered densely from 0, nodes keep the OS node id.
+pub struct Topology {
+    ptr: NonNull<bindings::C_Topology>,
+}
+
+// The block is immutable after creation and not tied to the creating thread.
+unsafe impl Send for Topology {}
+unsafe impl Sync for Topology {}
+
+impl Topology {
+    pub fn new() -> Result<Topology> {
+        let ptr = unsafe { bindings::get_topology() };
+        NonNull::new(ptr)
+            .map(|ptr| Topology { ptr })
+            .ok_or_else(|| HwinfoError::DataUnavailable("get_topology".into()))
+    }
+
+    fn raw(&self) -> &bindings::C_Topology {
+        unsafe { self.ptr.as_ref() }
+    }
+
+    /// One past the largest OS cpu id.
+    pub fn len(&self) -> usize {
+        self.raw().count.max(0) as usize
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    pub fn num_sockets(&self) -> usize {
+        self.raw().num_sockets.max(0) as usize
+    }
+
+    pub fn num_cores(&self) -> usize {
+        self.raw().num_cores.max(0) as usize
+    }
+
+    pub fn num_cache_domains(&self) -> usize {
+        self.raw().num_cache_domains.max(0) as usize
+    }
+
+    /// One past the largest node id.
+    pub fn num_nodes(&self) -> usize {
+        self.raw().num_nodes.max(0) as usize
+    }
+
+    pub fn core(&self) -> &[i32] {
+        unsafe { column(self.raw().core, self.raw().count) }
+    }
+
+    /// Domain of the last level cache (L3 on most x86 systems, L2 clusters on ARM).
+    pub fn cache_domain(&self) -> &[i32] {
+        unsafe { column(self.raw().cache_domain, self.raw().count) }
+    }
+
+    pub fn node(&self) -> &[i32] {
+        unsafe { column(self.raw().node, self.raw().count) }
+    }
+
+    pub fn socket(&self) -> &[i32] {
+        unsafe { column(self.raw().socket, self.raw().count) }
+    }
+
+    /// Relative performance of the core: higher is faster, equal on systems without hybrid cores.
+    pub fn efficiency_class(&self) -> &[i32] {
+        unsafe { column(self.raw().efficiency_class, self.raw().count) }
+    }
+
+    /// OS cpu ids whose entry in `group` (one of the columns) equals `id`.
+    pub fn cpus_where(group: &[i32], id: i32) -> Vec<usize> {
+        group
+            .iter()
+            .enumerate()
+            .filter(|&(_, &value)| value >= 0 && value == id)
+            .map(|(cpu, _)| cpu)
+            .collect()
+    }
+
+    pub fn cpus_of_socket(&self, socket: i32) -> Vec<usize> {
+        Self::cpus_where(self.socket(), socket)
+    }
+
+    pub fn cpus_of_node(&self, node: i32) -> Vec<usize> {
+        Self::cpus_where(self.node(), node)
+    }
+
+    /// All cpus of the core of `cpu`, including `cpu` itself.
+    pub fn smt_siblings(&self, cpu: usize) -> Vec<usize> {
+        match self.core().get(cpu) {
+            Some(&core) if core >= 0 => Self::cpus_where(self.core(), core),
+            _ => Vec::new(),
+        }
+    }
+
+    /// Mean of the per-thread `values` (e.g. utilizations indexed by the OS cpu id) for every
+    /// group of `group`. Negative values are skipped; groups without values are -1.
+    pub fn group_means(group: &[i32], num_groups: usize, values: &[f64]) -> Vec<f64> {
+        let mut sums = vec![(0.0, 0usize); num_groups];
+        for (&g, &value) in group.iter().zip(values) {
+            if g >= 0 && (g as usize) < num_groups && value >= 0.0 {
+                sums[g as usize].0 += value;
+                sums[g as usize].1 += 1;
+            }
+        }
+        sums.into_iter()
+            .map(|(sum, count)| if count > 0 { sum / count as f64 } else { -1.0 })
+            .collect()
+    }
+}
+
+impl Drop for Topology {
+    fn drop(&mut self) {
+        unsafe { bindings::free_topology(self.ptr.as_ptr()) }
+    }
+}